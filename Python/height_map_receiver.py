@@ -0,0 +1,142 @@
+"""
+ Copyright (c) Microsoft. All rights reserved.
+
+ This code is licensed under the MIT License (MIT).
+ THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+ ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+ IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+ PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+"""
+
+""" Receives the height map updates streamed for a depth sensor and displays the map """
+# pylint: disable=C0103
+
+from __future__ import print_function
+
+import argparse
+import socket
+import struct
+import sys
+import cv2
+import numpy as np
+
+# Ports of the depth sensors, when the streamer sends height map updates
+SHORT_THROW_DEPTH_PORT = 10081
+LONG_THROW_DEPTH_PORT = 10082
+
+# Cookie VersionNumber UpdateIndex SinceUpdate CellSize FloorHeight TileSize NumberOfTiles
+HEIGHT_MAP_UPDATE_HEADER_FORMAT = "<IIQQffII"
+HEIGHT_MAP_UPDATE_COOKIE = 0x4d484c48
+HEIGHT_MAP_TILE_HEADER_FORMAT = "<ii"
+HEIGHT_MAP_CELL_DTYPE = np.dtype([('log_odds', '<i1'), ('height', '<i2')])
+
+UNKNOWN_LOG_ODDS = -128
+UNKNOWN_HEIGHT = -32768
+
+
+def recv_exactly(s, size):
+    """Receives exactly size bytes"""
+    data = b''
+    while len(data) < size:
+        chunk = s.recv(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def apply_updates(tiles, data):
+    """Applies serialized updates to a dictionary of (log odds, heights) tiles"""
+    header_size = struct.calcsize(HEIGHT_MAP_UPDATE_HEADER_FORMAT)
+    cookie, version, update_index, _, cell_size, floor_height, tile_size, num_tiles = \
+        struct.unpack_from(HEIGHT_MAP_UPDATE_HEADER_FORMAT, data)
+    if cookie != HEIGHT_MAP_UPDATE_COOKIE or version != 1:
+        raise ValueError('unexpected height map update header')
+
+    cells_per_tile = tile_size * tile_size
+    offset = header_size
+    for _ in range(num_tiles):
+        key = struct.unpack_from(HEIGHT_MAP_TILE_HEADER_FORMAT, data, offset)
+        offset += struct.calcsize(HEIGHT_MAP_TILE_HEADER_FORMAT)
+
+        mask = np.unpackbits(
+            np.frombuffer(data, np.uint8, cells_per_tile // 8, offset),
+            bitorder='little').astype(bool)
+        offset += cells_per_tile // 8
+
+        num_cells = int(mask.sum())
+        cells = np.frombuffer(data, HEIGHT_MAP_CELL_DTYPE, num_cells, offset)
+        offset += num_cells * HEIGHT_MAP_CELL_DTYPE.itemsize
+
+        if key not in tiles:
+            tiles[key] = (
+                np.full(cells_per_tile, UNKNOWN_LOG_ODDS, np.int8),
+                np.full(cells_per_tile, UNKNOWN_HEIGHT, np.int16))
+        tiles[key][0][mask] = cells['log_odds']
+        tiles[key][1][mask] = cells['height']
+
+    return update_index, cell_size, floor_height, tile_size
+
+
+def render_occupancy(tiles, tile_size):
+    """Renders the occupancy probabilities as an image (gray where unknown)"""
+    min_x = min(x for x, _ in tiles)
+    min_z = min(z for _, z in tiles)
+    max_x = max(x for x, _ in tiles)
+    max_z = max(z for _, z in tiles)
+    image = np.full(((max_z - min_z + 1) * tile_size, (max_x - min_x + 1) * tile_size),
+                    128, np.uint8)
+    for (x, z), (log_odds, _) in tiles.items():
+        probability = 1.0 / (1.0 + np.exp(-log_odds.astype(np.float32) / 16.0))
+        tile = np.where(log_odds == UNKNOWN_LOG_ODDS, 128, 255 * (1.0 - probability))
+        row, col = (z - min_z) * tile_size, (x - min_x) * tile_size
+        image[row:row + tile_size, col:col + tile_size] = \
+            tile.reshape(tile_size, tile_size).astype(np.uint8)
+    return image
+
+
+def main(argv):
+    """Receiver main"""
+    parser = argparse.ArgumentParser()
+    required_named_group = parser.add_argument_group('named arguments')
+
+    required_named_group.add_argument("-a", "--host",
+                                      help="Host address to connect", required=True)
+    parser.add_argument("--long_throw", action="store_true",
+                        help="Receive the long throw depth sensor map")
+    args = parser.parse_args(argv)
+
+    port = LONG_THROW_DEPTH_PORT if args.long_throw else SHORT_THROW_DEPTH_PORT
+
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.connect((args.host, port))
+
+    print('INFO: Socket Connected to ' + args.host + ' on port ' + str(port))
+
+    tiles = {}
+    received_bytes = 0
+    while True:
+        length = recv_exactly(s, 4)
+        if length is None:
+            break
+        data = recv_exactly(s, struct.unpack('<I', length)[0])
+        if data is None:
+            break
+        received_bytes += 4 + len(data)
+
+        update_index, _, _, tile_size = apply_updates(tiles, data)
+        if not tiles:
+            continue
+
+        print('INFO: update %d, %d tiles, %.1f KB received' %
+              (update_index, len(tiles), received_bytes / 1024.0))
+
+        cv2.imshow('Height map occupancy', render_occupancy(tiles, tile_size))
+        if cv2.waitKey(1) & 0xFF == ord('q'):
+            break
+
+    s.close()
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,110 @@
+"""
+ Copyright (c) Microsoft. All rights reserved.
+
+ This code is licensed under the MIT License (MIT).
+ THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+ ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+ IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+ PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+"""
+
+""" Receives the marker poses streamed for the photo video camera and prints them """
+# pylint: disable=C0103
+
+from __future__ import print_function
+
+import argparse
+import socket
+import struct
+import sys
+import numpy as np
+
+# Port of the photo video camera, when the streamer sends marker poses
+PHOTO_VIDEO_PORT = 10080
+
+# Cookie VersionNumber Timestamp NumberOfMarkers
+MARKER_MESSAGE_HEADER_FORMAT = "<IIqI"
+MARKER_MESSAGE_COOKIE = 0x4b524d48
+# Id Flags Corners MarkerToCamera MarkerToWorld
+MARKER_FORMAT = "<iI8f12f12f"
+
+HAS_CAMERA_POSE = 1
+HAS_WORLD_POSE = 2
+
+
+def recv_exactly(s, size):
+    """Receives exactly size bytes"""
+    data = b''
+    while len(data) < size:
+        chunk = s.recv(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def parse_markers(data):
+    """Parses a marker message into a timestamp and a list of markers"""
+    cookie, version, timestamp, num_markers = \
+        struct.unpack_from(MARKER_MESSAGE_HEADER_FORMAT, data)
+    if cookie != MARKER_MESSAGE_COOKIE or version != 1:
+        raise ValueError('unexpected marker message header')
+
+    markers = []
+    offset = struct.calcsize(MARKER_MESSAGE_HEADER_FORMAT)
+    for _ in range(num_markers):
+        values = struct.unpack_from(MARKER_FORMAT, data, offset)
+        offset += struct.calcsize(MARKER_FORMAT)
+
+        marker_id, flags = values[0], values[1]
+        markers.append({
+            'id': marker_id,
+            'corners': np.array(values[2:10], np.float32).reshape(4, 2),
+            'marker_to_camera': np.array(values[10:22], np.float32).reshape(3, 4)
+                                if flags & HAS_CAMERA_POSE else None,
+            'marker_to_world': np.array(values[22:34], np.float32).reshape(3, 4)
+                               if flags & HAS_WORLD_POSE else None})
+
+    return timestamp, markers
+
+
+def main(argv):
+    """Receiver main"""
+    parser = argparse.ArgumentParser()
+    required_named_group = parser.add_argument_group('named arguments')
+
+    required_named_group.add_argument("-a", "--host",
+                                      help="Host address to connect", required=True)
+    args = parser.parse_args(argv)
+
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.connect((args.host, PHOTO_VIDEO_PORT))
+
+    print('INFO: Socket Connected to ' + args.host + ' on port ' + str(PHOTO_VIDEO_PORT))
+
+    while True:
+        length = recv_exactly(s, 4)
+        if length is None:
+            break
+        data = recv_exactly(s, struct.unpack('<I', length)[0])
+        if data is None:
+            break
+
+        timestamp, markers = parse_markers(data)
+        for marker in markers:
+            pose = marker['marker_to_world']
+            if pose is None:
+                pose = marker['marker_to_camera']
+            if pose is None:
+                print('%d: marker %d at %s' %
+                      (timestamp, marker['id'], marker['corners'].mean(axis=0)))
+            else:
+                print('%d: marker %d at %s (%s)' %
+                      (timestamp, marker['id'], pose[:, 3],
+                       'world' if marker['marker_to_world'] is not None else 'camera'))
+
+    s.close()
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -21,6 +21,55 @@ def save_obj(output_path, points):
         for v in points:
             f.write("v %.4f %.4f %.4f\n" % (v[0], v[1], v[2]))
 
+def save_ply(output_path, points):
+    points = np.asarray(points, dtype='<f4').reshape(-1, 3)
+    with open(output_path, 'wb') as f:
+        f.write(("ply\n"
+                 "format binary_little_endian 1.0\n"
+                 "element vertex %d\n"
+                 "property float x\n"
+                 "property float y\n"
+                 "property float z\n"
+                 "end_header\n" % len(points)).encode('ascii'))
+        f.write(points.tobytes())
+
+
+class VoxelGrid:
+    """Merges points on a voxel grid, averaging the points falling in the same voxel."""
+
+    def __init__(self, voxel_size):
+        self.voxel_size = voxel_size
+        self.keys = np.zeros((0, 3), dtype=np.int64)
+        self.sums = np.zeros((0, 3))
+        self.counts = np.zeros(0, dtype=np.int64)
+        self.pending = []
+
+    def add(self, points):
+        if len(points):
+            self.pending.append(np.asarray(points).reshape(-1, 3))
+        # Merge in batches to bound memory without paying for a merge per frame
+        if len(self.pending) >= 32:
+            self.merge()
+
+    def merge(self):
+        if not self.pending:
+            return
+        points = np.vstack(self.pending)
+        self.pending = []
+        keys = np.vstack([self.keys, np.floor(points / self.voxel_size).astype(np.int64)])
+        sums = np.vstack([self.sums, points])
+        counts = np.concatenate([self.counts, np.ones(len(points), dtype=np.int64)])
+        self.keys, inverse = np.unique(keys, axis=0, return_inverse=True)
+        inverse = inverse.reshape(-1)
+        self.sums = np.zeros((len(self.keys), 3))
+        np.add.at(self.sums, inverse, sums)
+        self.counts = np.bincount(inverse, weights=counts, minlength=len(self.keys)).astype(np.int64)
+
+    def points(self):
+        self.merge()
+        return self.sums / self.counts[:, np.newaxis]
+
+
 def read_obj(path):
     with open(path, 'r') as f:        
         # get lines
@@ -57,15 +106,80 @@ def parse_projection_bin(path, w, h):
     # See repo issue #63
     # Read binary file
     projection = np.fromfile(path, dtype=np.float32)
-    x_list = [ projection[i] for i in range(0, len(projection), 2) ]
-    y_list = [ projection[i] for i in range(1, len(projection), 2) ]
-    
-    u = np.asarray(x_list).reshape(w, h).T
-    v = np.asarray(y_list).reshape(w, h).T
+
+    u = projection[0::2].reshape(w, h).T
+    v = projection[1::2].reshape(w, h).T
 
     return [u, v]
 
 
+def _grid_cell(coords, grid):
+    # All grid cells but the last one have the same size (see CameraProjectionModel.cpp)
+    step = grid[1] - grid[0]
+    cell = np.minimum((np.maximum(coords, 0.) / step).astype(np.int64), len(grid) - 2)
+    alpha = (coords - grid[cell]) / (grid[cell + 1] - grid[cell])
+    return cell, alpha
+
+
+def parse_projection_model(path):
+    # Reads a '<sensor>_camera_projection_model.bin' file and evaluates it on every pixel.
+    header = np.fromfile(path, dtype=np.uint32, count=12)
+    cookie, version, w, h, degree, within_tolerance = [int(x) for x in header[:6]]
+    assert(cookie == 0x4d434c48 and version == 1)
+    grid_cols, grid_rows = int(header[10]), int(header[11])
+
+    with open(path, 'rb') as f:
+        f.seek(12 * 4)
+        grid_u = np.fromfile(f, dtype=np.float32, count=grid_cols)
+        grid_v = np.fromfile(f, dtype=np.float32, count=grid_rows)
+        num_terms = (degree + 1) * (degree + 2) // 2 if degree > 0 else 0
+        coeffs_x = np.fromfile(f, dtype=np.float64, count=num_terms)
+        coeffs_y = np.fromfile(f, dtype=np.float64, count=num_terms)
+        samples = np.fromfile(f, dtype=np.float32, count=grid_rows * grid_cols * 2)
+    samples = samples.reshape(grid_rows, grid_cols, 2)
+
+    cols, alphas = _grid_cell(np.arange(w, dtype=np.float64), grid_u.astype(np.float64))
+    rows, betas = _grid_cell(np.arange(h, dtype=np.float64), grid_v.astype(np.float64))
+
+    if within_tolerance:
+        s = (np.arange(w) - 0.5 * (w - 1)) / (0.5 * (w - 1))
+        t = (np.arange(h) - 0.5 * (h - 1)) / (0.5 * (h - 1))
+        S, T = np.meshgrid(s, t)
+        u = np.zeros((h, w))
+        v = np.zeros((h, w))
+        k = 0
+        for j in range(degree + 1):
+            for i in range(degree + 1 - j):
+                term = S**i * T**j
+                u += coeffs_x[k] * term
+                v += coeffs_y[k] * term
+                k += 1
+
+        # Validity comes from the nearest grid sample
+        nearest_cols = cols + (alphas > 0.5)
+        nearest_rows = rows + (betas > 0.5)
+        invalid = np.isinf(samples[nearest_rows][:, nearest_cols, 0])
+    else:
+        A, B = np.meshgrid(alphas, betas)
+        A, B = A[..., None], B[..., None]
+        p00 = samples[rows][:, cols]
+        p01 = samples[rows][:, cols + 1]
+        p10 = samples[rows + 1][:, cols]
+        p11 = samples[rows + 1][:, cols + 1]
+        with np.errstate(invalid='ignore'):
+            top = p00 + (p01 - p00) * A
+            bottom = p10 + (p11 - p10) * A
+            uv = top + (bottom - top) * B
+        u, v = uv[..., 0].astype(np.float64), uv[..., 1].astype(np.float64)
+        invalid = np.isinf(p00[..., 0]) | np.isinf(p01[..., 0]) | \
+                  np.isinf(p10[..., 0]) | np.isinf(p11[..., 0])
+
+    u[invalid] = np.inf
+    v[invalid] = np.inf
+
+    return [u.astype(np.float32), v.astype(np.float32)]
+
+
 def pgm2distance(img, encoded=False):
     # See repo issue #19
     img.byteswap(inplace=True)
@@ -81,31 +195,21 @@ def get_points(img, us, vs, cam2world, depth_range):
     else:
         R, t = np.eye(3), np.zeros(3)
 
-    points = []
-    for i in np.arange(distance_img.shape[0]):
-        for j in np.arange(distance_img.shape[1]):
-            x = us[i, j]
-            y = vs[i, j]
-            
-            # Compute Z values as described in issue #63
-            # https://github.com/Microsoft/HoloLensForCV/issues/63#issuecomment-429469425
-            D = distance_img[i, j]
-            z = - float(D) / np.sqrt(x*x + y*y + 1)
-            
-            if np.isinf(x) or np.isinf(y) or \
-               D < depth_range[0] or D > depth_range[1]:
-                continue
-            
-            # 3D point in camera coordinate system
-            point = np.array([x, y, 1.]) * z
-            
-            # Camera to World
-            point = np.dot(R, point) + t
+    # Compute Z values as described in issue #63
+    # https://github.com/Microsoft/HoloLensForCV/issues/63#issuecomment-429469425
+    D = distance_img.astype(np.float64)
+    valid = np.isfinite(us) & np.isfinite(vs) & \
+        (D >= depth_range[0]) & (D <= depth_range[1])
+
+    x = us[valid]
+    y = vs[valid]
+    z = - D[valid] / np.sqrt(x*x + y*y + 1)
+
+    # 3D points in camera coordinate system
+    points = np.stack([x * z, y * z, z], axis=1)
 
-            # Append point
-            points.append(point)
-   
-    return np.vstack(points) if points else np.array(points)
+    # Camera to World
+    return points.dot(R.T) + t
 
 
 def get_cam2world(path, sensor_poses):
@@ -128,8 +232,9 @@ def process_folder(args, cam):
     if not os.path.exists(output_folder):
         os.makedirs(output_folder)
 
-    # Get camera projection info
+    # Get camera projection info (recordings may only contain the compact model)
     bin_path = os.path.join(args.workspace_path, "%s_camera_space_projection.bin" % cam)
+    model_path = os.path.join(args.workspace_path, "%s_camera_projection_model.bin" % cam)
     
     # From frame to world coordinate system
     sensor_poses = None
@@ -149,7 +254,7 @@ def process_folder(args, cam):
     merge_points = args.merge_points
     overwrite    = args.overwrite
     use_cache    = args.use_cache
-    points_merged = []
+    points_merged = VoxelGrid(args.merge_voxel_size) if args.merge_voxel_size > 0 else []
     us = vs = None
     for i_path, path in enumerate(depth_paths):
         output_suffix = "_%s" % args.output_suffix if len(args.output_suffix) else ""
@@ -164,16 +269,24 @@ def process_folder(args, cam):
         else:
             img = cv2.imread(path, -1)
             if us is None or vs is None:
-                us, vs = parse_projection_bin(bin_path, img.shape[1], img.shape[0])
+                if os.path.exists(bin_path):
+                    us, vs = parse_projection_bin(bin_path, img.shape[1], img.shape[0])
+                else:
+                    us, vs = parse_projection_model(model_path)
             cam2world = get_cam2world(path, sensor_poses) if sensor_poses is not None else None
             points = get_points(img, us, vs, cam2world, depth_range)  
             
         if merge_points:
-            points_merged.extend(points)
+            if isinstance(points_merged, VoxelGrid):
+                points_merged.add(points)
+            else:
+                points_merged.extend(points)
         
         if not output_file_exist or overwrite:
             save_obj(pcloud_output_path, points)
         
+    if isinstance(points_merged, VoxelGrid):
+        return points_merged.points()
     return points_merged
 
 
@@ -188,6 +301,7 @@ def parse_args():
     parser.add_argument("--start_frame", type=int, default=0)
     parser.add_argument("--max_num_frames", type=int, default=-1)
     parser.add_argument("--merge_points",  action='store_true', default=False, help="Save file with all the points (in world coordinate system)") 
+    parser.add_argument("--merge_voxel_size", type=float, default=0.01, help="Merged points falling in the same voxel (of this size, in meters) are averaged. Set to 0 to keep all the points")
     parser.add_argument("--use_cache", action='store_true', default=False, help="Load already existing files") 
     parser.add_argument("--overwrite", action='store_true', default=False, help="Write output files (overwrite if exist).")
 
@@ -221,9 +335,9 @@ def main():
     # save output
     if args.merge_points:
         output_folder = os.path.join(args.output_path, camera)
-        output_filename = output_folder + ".obj"
+        output_filename = output_folder + ".ply"
         print("Saving file with all points: %s" % output_filename)
-        save_obj(output_filename, points)
+        save_ply(output_filename, points)
         
     print("Done.")
 
@@ -18,6 +18,7 @@ import argparse
 import sqlite3
 import shutil
 import json
+import struct
 import subprocess
 import urllib.request
 import numpy as np
@@ -36,12 +37,20 @@ def parse_args():
                         help="Path to workspace folder used for downloading "
                              "recordings and reconstruction using COLMAP")
     parser.add_argument("--colmap_path", help="Path to COLMAP.bat executable")
+    parser.add_argument("--recording_converter_path",
+                        help="Path to the RecordingConverter executable, "
+                             "used to extract and synchronize recordings "
+                             "without copying the frames twice")
 
     parser.add_argument("--ref_camera_name", default="vlc_ll")
     parser.add_argument("--frame_rate", type=int, default=5)
     parser.add_argument("--start_frame", type=int, default=-1)
     parser.add_argument("--max_num_frames", type=int, default=-1)
     parser.add_argument("--num_refinements", type=int, default=3)
+    parser.add_argument("--feature_match_window", type=int, default=10,
+                        help="Number of following frames the recorded "
+                             "features of a frame are matched with, "
+                             "0 to match all frames")
 
     args = parser.parse_args()
 
@@ -337,6 +346,12 @@ def synchronize_sensor_frames(args, recording_path, output_path, camera_names):
                     output_path, camera_name, image_basename)
                 if not os.path.exists(new_image_path):
                     shutil.copyfile(image_path, new_image_path)
+                features_path = os.path.splitext(image_path)[0] + ".orb"
+                new_features_path = \
+                    os.path.splitext(new_image_path)[0] + ".orb"
+                if os.path.exists(features_path) and \
+                        not os.path.exists(new_features_path):
+                    shutil.copyfile(features_path, new_features_path)
                 new_image_name = os.path.join(camera_name, image_basename)
                 frame_images.append(new_image_name.replace("\\", "/"))
                 frame_poses.append(image_pose)
@@ -346,67 +361,142 @@ def synchronize_sensor_frames(args, recording_path, output_path, camera_names):
     return sync_frames, sync_poses
 
 
-def extract_recording(recording_path):
-    print("Extracting recording data...")
-    for file_name in glob.glob(os.path.join(recording_path, "*.tar")):
-        print("=> Extracting tarfile:", file_name)
-        tar = tarfile.open(file_name)
-        tar.extractall(path=recording_path)
-        tar.close()
-
-
-def reconstruct_recording(args, recording_path, dense=True):
-    reconstruction_path = os.path.join(recording_path, "reconstruction")
-    database_path = os.path.join(reconstruction_path, "database.db")
-    image_path = os.path.join(reconstruction_path, "images")
-    image_list_path = os.path.join(reconstruction_path, "image_list.txt")
-    sparse_colmap_path = os.path.join(reconstruction_path, "sparse_colmap")
-    sparse_hololens_path = \
-        os.path.join(reconstruction_path, "sparse_hololens")
-    dense_path = os.path.join(reconstruction_path, "dense")
-    rig_config_path = os.path.join(reconstruction_path, "rig_config.json")
+def export_colmap_native(args, recording_path, reconstruction_path,
+                         camera_names):
+    # Synchronizes the frames like synchronize_sensor_frames, extracting them
+    # from the recording's archives directly (or hard-linking them if they
+    # already were), and writes the image list, the recorded features and
+    # their matches (if features were recorded for all the images), and the
+    # sparse_hololens model with the recorded poses.
+
+    command = [
+        args.recording_converter_path, "colmap",
+        recording_path, reconstruction_path,
+        "--sensors", ",".join(camera_names),
+        "--reference", args.ref_camera_name,
+        "--frame-rate", str(args.frame_rate),
+        "--match-window", str(args.feature_match_window),
+    ]
+    if args.max_num_frames > 0:
+        command += ["--start-frame", str(max(args.start_frame, 0)),
+                    "--max-frames", str(args.max_num_frames)]
+    subprocess.check_call(command)
+
+    matches_path = os.path.join(reconstruction_path, "matches.txt")
+    if not os.path.exists(matches_path):
+        return None
+    return matches_path
+
+
+def read_orb_features(path):
+    # See SerializeImageFeatures (Shared/Playback/ImageFeatures.cpp) for the format of the file.
+    with open(path, "rb") as fid:
+        data = fid.read()
+    assert data[:4] == b"ORB1"
+    num_keypoints, descriptor_size = struct.unpack_from("<II", data, 4)
+    keypoints_dtype = np.dtype([("x", "<f4"), ("y", "<f4"), ("size", "<f4"),
+                                ("angle", "<f4"), ("response", "<f4"),
+                                ("octave", "<i4")])
+    keypoints = np.frombuffer(data, dtype=keypoints_dtype,
+                              count=num_keypoints, offset=12)
+    descriptors = np.frombuffer(
+        data, dtype=np.uint8, count=num_keypoints * descriptor_size,
+        offset=12 + num_keypoints * keypoints_dtype.itemsize)
+    return keypoints, descriptors.reshape(num_keypoints, descriptor_size)
+
+
+def write_colmap_features(path, keypoints):
+    # COLMAP only imports SIFT-like features, the recorded binary descriptors
+    # are matched by match_orb_features instead and replaced by zeros here.
+    with open(path, "w") as fid:
+        fid.write("{} 128\n".format(len(keypoints)))
+        zeros = " ".join(["0"] * 128)
+        for keypoint in keypoints:
+            # COLMAP places the center of the first pixel at (0.5, 0.5).
+            fid.write("{} {} {} {} {}\n".format(
+                keypoint["x"] + 0.5, keypoint["y"] + 0.5,
+                keypoint["size"] / 31.0, np.deg2rad(keypoint["angle"]),
+                zeros))
+
+
+def match_orb_features(descriptors1, descriptors2,
+                       max_ratio=0.8, max_distance=64):
+    if len(descriptors1) == 0 or len(descriptors2) == 0:
+        return np.zeros((0, 2), dtype=np.int64)
+
+    # The Hamming distance of two descriptors of bits mapped to +1 and -1 is
+    # (num_bits - dot product) / 2.
+    bits1 = np.unpackbits(descriptors1, axis=1).astype(np.float32) * 2 - 1
+    bits2 = np.unpackbits(descriptors2, axis=1).astype(np.float32) * 2 - 1
+    dists = (bits1.shape[1] - bits1.dot(bits2.T)) / 2
+
+    idxs12 = np.argmin(dists, axis=1)
+    idxs21 = np.argmin(dists, axis=0)
+    idxs1 = np.arange(len(descriptors1))
+    best_dists = dists[idxs1, idxs12]
+    if dists.shape[1] > 1:
+        second_best_dists = np.partition(dists, 1, axis=1)[:, 1]
+    else:
+        second_best_dists = np.full(len(descriptors1), np.inf)
 
-    mkdir_if_not_exists(reconstruction_path)
+    mask = (idxs21[idxs12] == idxs1) & (best_dists <= max_distance) & \
+        (best_dists < max_ratio * second_best_dists)
 
-    extract_recording(recording_path)
+    return np.column_stack((idxs1[mask], idxs12[mask]))
 
-    camera_names = ("vlc_ll", "vlc_lf", "vlc_rf", "vlc_rr")
 
-    print("Syncrhonizing sensor frames...")
-    frames, poses = synchronize_sensor_frames(
-        args, recording_path, image_path, camera_names)
+def import_orb_features(args, image_path, database_path, image_list_path,
+                        frames):
+    features_import_path = os.path.join(
+        os.path.dirname(image_path), "features")
+    matches_path = os.path.join(os.path.dirname(image_path), "matches.txt")
 
-    with open(image_list_path, "w") as fid:
-        for frame in frames:
-            for image_name in frame:
-                fid.write("{}\n".format(image_name))
+    image_names = [image_name for frame in frames for image_name in frame]
+    descriptors = {}
+    for image_name in image_names:
+        keypoints, descriptors[image_name] = read_orb_features(
+            os.path.splitext(os.path.join(image_path, image_name))[0] + ".orb")
+        features_path = os.path.join(features_import_path, image_name + ".txt")
+        mkdir_if_not_exists(os.path.dirname(features_path))
+        write_colmap_features(features_path, keypoints)
 
     subprocess.call([
-        args.colmap_path, "feature_extractor",
+        args.colmap_path, "feature_importer",
         "--image_path", image_path,
+        "--import_path", features_import_path,
         "--database_path", database_path,
         "--image_list_path", image_list_path,
     ])
 
-    # These OpenCV camera model parameters were determined for a specific
-    # HoloLens using the self-calibration capabilities of COLMAP.
-    # The parameters should be sufficiently accurate as an initialization and
-    # the parameters will be refined during the COLMAP reconstruction process.
-    camera_model_id = 4
-    camera_model_name = "OPENCV"
-    camera_width = 640
-    camera_height = 480
-    camera_params = {
-        "vlc_ll": "450.072070 450.274345 320 240 "
-                  "-0.013211 0.012778 -0.002714 -0.003603",
-        "vlc_lf": "448.189452 452.478090 320 240 "
-                  "-0.009463 0.003013 -0.006169 -0.008975",
-        "vlc_rf": "449.435779 453.332057 320 240 "
-                  "-0.000305 -0.013207 0.003258 0.001051",
-        "vlc_rr": "450.301002 450.244147 320 240 "
-                  "-0.010926 0.008377 -0.003105 -0.004976",
-    }
+    # Match the images of each frame with each other, and with the images of
+    # the following frames.
 
+    with open(matches_path, "w") as fid:
+        for frame_idx, frame in enumerate(frames):
+            if args.feature_match_window > 0:
+                end_frame_idx = min(len(frames),
+                                    frame_idx + args.feature_match_window + 1)
+            else:
+                end_frame_idx = len(frames)
+            for image_idx1, image_name1 in enumerate(frame):
+                image_names2 = frame[image_idx1 + 1:]
+                for other_frame in frames[frame_idx + 1:end_frame_idx]:
+                    image_names2 = image_names2 + other_frame
+                for image_name2 in image_names2:
+                    matches = match_orb_features(descriptors[image_name1],
+                                                 descriptors[image_name2])
+                    fid.write("{} {}\n".format(image_name1, image_name2))
+                    for idx1, idx2 in matches:
+                        fid.write("{} {}\n".format(idx1, idx2))
+                    fid.write("\n")
+
+    return matches_path
+
+
+def write_sparse_hololens_model(database_path, sparse_hololens_path, frames,
+                                poses, camera_names, camera_model_id,
+                                camera_model_name, camera_width, camera_height,
+                                camera_params):
     mkdir_if_not_exists(sparse_hololens_path)
 
     cameras_file = open(os.path.join(sparse_hololens_path, "cameras.txt"), "w")
@@ -461,11 +551,171 @@ def reconstruct_recording(args, recording_path, dense=True):
     images_file.close()
     points_file.close()
 
-    subprocess.call([
-        args.colmap_path, "exhaustive_matcher",
-        "--database_path", database_path,
-        "--SiftMatching.guided_matching", "true",
-    ])
+    return camera_ids
+
+
+def update_database_cameras(database_path, image_list_path, camera_names,
+                            camera_model_id, camera_width, camera_height,
+                            camera_params):
+    # The model written by the RecordingConverter numbers the cameras from 1
+    # in the order of camera_names, and the images from 1 in the order of the
+    # image list, like feature_importer does for a new database. Replace the
+    # camera it created for each image by those.
+
+    connection = sqlite3.connect(database_path)
+    cursor = connection.cursor()
+
+    cursor.execute("DELETE FROM cameras;")
+
+    camera_ids = {}
+    for camera_id, camera_name in enumerate(camera_names, 1):
+        camera_params_float = np.array(
+            list(map(float, camera_params[camera_name].split())),
+            dtype=np.double)
+
+        cursor.execute("INSERT INTO cameras"
+            "(camera_id, model, width, height, params, prior_focal_length) "
+            "VALUES(?, ?, ?, ?, ?, ?);",
+            (camera_id, camera_model_id, camera_width,
+             camera_height, camera_params_float, 1))
+
+        cursor.execute("UPDATE images SET camera_id=? "
+                       "WHERE name LIKE '{}%';".format(camera_name),
+                       (camera_id,))
+
+        camera_ids[camera_name] = camera_id
+
+    connection.commit()
+
+    with open(image_list_path, "r") as fid:
+        image_names = [line.strip() for line in fid if line.strip()]
+
+    cursor.execute("SELECT image_id, name FROM images ORDER BY image_id;")
+    if cursor.fetchall() != list(enumerate(image_names, 1)):
+        connection.close()
+        raise RuntimeError(
+            "The images of {} are not numbered in the order of {}, delete "
+            "the database and reconstruct again".format(
+                database_path, image_list_path))
+
+    connection.close()
+
+    return camera_ids
+
+
+def extract_recording(recording_path, recording_converter_path=None):
+    print("Extracting recording data...")
+    if recording_converter_path:
+        subprocess.check_call(
+            [recording_converter_path, "extract", recording_path])
+        return
+    for file_name in glob.glob(os.path.join(recording_path, "*.tar")):
+        print("=> Extracting tarfile:", file_name)
+        tar = tarfile.open(file_name)
+        tar.extractall(path=recording_path)
+        tar.close()
+
+
+def reconstruct_recording(args, recording_path, dense=True):
+    reconstruction_path = os.path.join(recording_path, "reconstruction")
+    database_path = os.path.join(reconstruction_path, "database.db")
+    image_path = os.path.join(reconstruction_path, "images")
+    image_list_path = os.path.join(reconstruction_path, "image_list.txt")
+    sparse_colmap_path = os.path.join(reconstruction_path, "sparse_colmap")
+    sparse_hololens_path = \
+        os.path.join(reconstruction_path, "sparse_hololens")
+    dense_path = os.path.join(reconstruction_path, "dense")
+    rig_config_path = os.path.join(reconstruction_path, "rig_config.json")
+
+    mkdir_if_not_exists(reconstruction_path)
+
+    camera_names = ("vlc_ll", "vlc_lf", "vlc_rf", "vlc_rr")
+
+    print("Syncrhonizing sensor frames...")
+    if args.recording_converter_path:
+        matches_path = export_colmap_native(
+            args, recording_path, reconstruction_path, camera_names)
+        has_recorded_features = matches_path is not None
+    else:
+        extract_recording(recording_path)
+        frames, poses = synchronize_sensor_frames(
+            args, recording_path, image_path, camera_names)
+
+        with open(image_list_path, "w") as fid:
+            for frame in frames:
+                for image_name in frame:
+                    fid.write("{}\n".format(image_name))
+
+        # Reuse the features extracted on the device, if they were recorded
+        # for all the images.
+        has_recorded_features = all(
+            os.path.exists(os.path.splitext(
+                os.path.join(image_path, image_name))[0] + ".orb")
+            for frame in frames for image_name in frame)
+
+    if has_recorded_features and args.recording_converter_path:
+        print("Importing recorded features...")
+        subprocess.call([
+            args.colmap_path, "feature_importer",
+            "--image_path", image_path,
+            "--import_path", os.path.join(reconstruction_path, "features"),
+            "--database_path", database_path,
+            "--image_list_path", image_list_path,
+        ])
+    elif has_recorded_features:
+        print("Importing recorded features...")
+        matches_path = import_orb_features(
+            args, image_path, database_path, image_list_path, frames)
+    else:
+        subprocess.call([
+            args.colmap_path, "feature_extractor",
+            "--image_path", image_path,
+            "--database_path", database_path,
+            "--image_list_path", image_list_path,
+        ])
+
+    # These OpenCV camera model parameters were determined for a specific
+    # HoloLens using the self-calibration capabilities of COLMAP.
+    # The parameters should be sufficiently accurate as an initialization and
+    # the parameters will be refined during the COLMAP reconstruction process.
+    camera_model_id = 4
+    camera_model_name = "OPENCV"
+    camera_width = 640
+    camera_height = 480
+    camera_params = {
+        "vlc_ll": "450.072070 450.274345 320 240 "
+                  "-0.013211 0.012778 -0.002714 -0.003603",
+        "vlc_lf": "448.189452 452.478090 320 240 "
+                  "-0.009463 0.003013 -0.006169 -0.008975",
+        "vlc_rf": "449.435779 453.332057 320 240 "
+                  "-0.000305 -0.013207 0.003258 0.001051",
+        "vlc_rr": "450.301002 450.244147 320 240 "
+                  "-0.010926 0.008377 -0.003105 -0.004976",
+    }
+
+    if args.recording_converter_path:
+        camera_ids = update_database_cameras(
+            database_path, image_list_path, camera_names, camera_model_id,
+            camera_width, camera_height, camera_params)
+    else:
+        camera_ids = write_sparse_hololens_model(
+            database_path, sparse_hololens_path, frames, poses, camera_names,
+            camera_model_id, camera_model_name, camera_width, camera_height,
+            camera_params)
+
+    if has_recorded_features:
+        subprocess.call([
+            args.colmap_path, "matches_importer",
+            "--database_path", database_path,
+            "--match_list_path", matches_path,
+            "--match_type", "raw",
+        ])
+    else:
+        subprocess.call([
+            args.colmap_path, "exhaustive_matcher",
+            "--database_path", database_path,
+            "--SiftMatching.guided_matching", "true",
+        ])
 
     with open(rig_config_path, "w") as fid:
         fid.write("""[
@@ -647,7 +897,8 @@ def main():
                     print("=> Recording does not exist")
                 else:
                     extract_recording(
-                        os.path.join(args.workspace_path, recording_name))
+                        os.path.join(args.workspace_path, recording_name),
+                        args.recording_converter_path)
         elif command.startswith("reconstruct"):
             if not args.colmap_path:
                 print("=> Cannot reconstruct, "
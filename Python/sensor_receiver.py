@@ -36,11 +36,48 @@ SENSOR_FRAME_STREAM_HEADER = namedtuple(
     'Cookie VersionMajor VersionMinor FrameType Timestamp ImageWidth ImageHeight PixelStride RowStride'
 )
 
+# Headers of protocol version 0.2 are followed by the frame trace: the number of
+# stages after the exposure, followed by the time from the exposure to each of them
+# in microseconds (0xffffffff if not reached)
+FRAME_TRACE_MINOR_VERSION = 2
+FRAME_TRACE_COUNT_FORMAT = "<I"
+FRAME_TRACE_STAGE_NAMES = ['Arrival', 'SinkDequeue', 'EncodeStart', 'EncodeEnd',
+                           'SendComplete', 'WriteComplete']
+FRAME_TRACE_NOT_REACHED = 0xffffffff
+
 # Each port corresponds to a single stream type
 # Port for obtaining Photo Video Camera stream
 PV_STREAM_PORT = 23940
 
 
+def receive_exactly(s, size):
+    """Receives exactly size bytes from the socket"""
+    data = b''
+    while len(data) < size:
+        chunk = s.recv(size - len(data))
+        if not chunk:
+            print('ERROR: Failed to receive data')
+            sys.exit()
+        data += chunk
+    return data
+
+
+def receive_frame_trace(s):
+    """Receives the frame trace following a header, as a dict of stage name to
+    microseconds since exposure"""
+    count, = struct.unpack(FRAME_TRACE_COUNT_FORMAT,
+                           receive_exactly(s, struct.calcsize(FRAME_TRACE_COUNT_FORMAT)))
+    offsets = struct.unpack('<%dI' % count, receive_exactly(s, 4 * count))
+    trace = {}
+    for index, offset in enumerate(offsets):
+        if offset == FRAME_TRACE_NOT_REACHED:
+            continue
+        name = FRAME_TRACE_STAGE_NAMES[index] \
+            if index < len(FRAME_TRACE_STAGE_NAMES) else 'Stage%d' % (index + 1)
+        trace[name] = offset
+    return trace
+
+
 def main(argv):
     """Receiver main"""
     parser = argparse.ArgumentParser()
@@ -78,6 +115,12 @@ def main(argv):
             # Parse the header
             header = SENSOR_FRAME_STREAM_HEADER(*data)
 
+            if header.VersionMinor >= FRAME_TRACE_MINOR_VERSION:
+                trace = receive_frame_trace(s)
+                print('INFO: frame trace (us since exposure): ' +
+                      ', '.join('%s=%d' % (name, trace[name])
+                                for name in FRAME_TRACE_STAGE_NAMES if name in trace))
+
             # read the image in chunks
             image_size_bytes = header.ImageHeight * header.RowStride
             image_data = ''
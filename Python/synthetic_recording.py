@@ -0,0 +1,146 @@
+"""
+ Copyright (c) Microsoft. All rights reserved.
+
+ This code is licensed under the MIT License (MIT).
+ THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+ ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+ IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+ PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+"""
+
+""" Writes a synthetic recording in the layout of the Recorder, to benchmark tools on """
+# pylint: disable=C0103
+
+import argparse
+import io
+import math
+import os
+import random
+import struct
+import tarfile
+
+# Timestamps are in 100 ns units; the visible light cameras run at 30 Hz
+FIRST_TIMESTAMP = 131571592373545123
+FRAME_INTERVAL = 333333
+
+# Magic NumberOfKeypoints DescriptorSize, then x y size angle response octave
+# per keypoint (see Shared/Playback/ImageFeatures.cpp)
+FEATURES_HEADER_FORMAT = "<4sII"
+KEYPOINT_FORMAT = "<5fi"
+DESCRIPTOR_SIZE = 32
+
+TRANSFORM_NAMES = ["FrameToOrigin", "CameraViewTransform",
+                   "CameraProjectionTransform"]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--output_path", required=True,
+                        help="Folder to write the recording to")
+    parser.add_argument("--sensors", default="vlc_ll,vlc_lf,vlc_rf,vlc_rr")
+    parser.add_argument("--num_frames", type=int, default=2000,
+                        help="Frames per sensor")
+    parser.add_argument("--width", type=int, default=640)
+    parser.add_argument("--height", type=int, default=480)
+    parser.add_argument("--num_features", type=int, default=0,
+                        help="ORB features stored with each frame, "
+                             "none by default")
+    parser.add_argument("--seed", type=int, default=1)
+    return parser.parse_args()
+
+
+def format_transform(angle, translation):
+    """ A rotation about the Y axis followed by a translation, in the row-major
+        layout the Recorder writes the Numerics float4x4 in """
+    c = math.cos(angle)
+    s = math.sin(angle)
+    values = [c, 0, -s, 0,
+              0, 1, 0, 0,
+              s, 0, c, 0,
+              translation[0], translation[1], translation[2], 1]
+    return ",".join(repr(float(v)) for v in values)
+
+
+def make_features(rng, descriptor_pool, num_features, width, height):
+    data = [struct.pack(FEATURES_HEADER_FORMAT, b"ORB1", num_features,
+                        DESCRIPTOR_SIZE)]
+    for _ in range(num_features):
+        data.append(struct.pack(KEYPOINT_FORMAT, rng.uniform(0, width),
+                                rng.uniform(0, height), 31.0,
+                                rng.uniform(0, 360), 1.0, 0))
+    # Frames share descriptors, with a few bits flipped, so that they match
+    for descriptor in rng.sample(descriptor_pool, num_features):
+        data.append(bytes(b ^ (1 << rng.randrange(8))
+                          if rng.random() < 0.05 else b
+                          for b in descriptor))
+    return b"".join(data)
+
+
+def add_file(archive, name, data):
+    info = tarfile.TarInfo(name)
+    info.size = len(data)
+    archive.addfile(info, io.BytesIO(data))
+
+
+def write_sensor(args, rng, sensor_index, sensor_name, descriptor_pool):
+    header = b"P5\n%d %d\n255\n" % (args.width, args.height)
+    csv_path = os.path.join(args.output_path, sensor_name + ".csv")
+    tar_path = os.path.join(args.output_path, sensor_name + ".tar")
+
+    with open(csv_path, "w") as csv_file, \
+            tarfile.open(tar_path, "w", format=tarfile.USTAR_FORMAT) as archive:
+        columns = ["Timestamp", "ImageFileName"]
+        for transform_name in TRANSFORM_NAMES:
+            columns += ["%s.m%d%d" % (transform_name, row, column)
+                        for row in range(1, 5) for column in range(1, 5)]
+        csv_file.write(",".join(columns) + "\n")
+
+        camera_view = format_transform(0.5 * sensor_index, (0.05, 0, 0))
+        for i in range(args.num_frames):
+            # The cameras are not triggered together
+            timestamp = FIRST_TIMESTAMP + i * FRAME_INTERVAL + \
+                sensor_index * 1000 + rng.randrange(300)
+            image_name = "%s\\%020d.pgm" % (sensor_name, timestamp)
+
+            # Poses are missing now and then, as with tracking losses
+            if i % 50 == 7:
+                frame_to_origin = ",".join(["0"] * 16)
+            else:
+                frame_to_origin = format_transform(
+                    0.001 * i, (0.0001 * i, 1.6, -0.001 * i))
+
+            csv_file.write("%d,%s,%s,%s,%s\n" % (
+                timestamp, image_name, frame_to_origin, camera_view,
+                format_transform(0, (0, 0, 0))))
+
+            # Random pixels, so that the archive does not compress
+            add_file(archive, image_name,
+                     header + os.urandom(args.width * args.height))
+            if args.num_features > 0:
+                add_file(archive, image_name[:-4] + ".orb",
+                         make_features(rng, descriptor_pool,
+                                       args.num_features, args.width,
+                                       args.height))
+
+
+def main():
+    args = parse_args()
+
+    rng = random.Random(args.seed)
+    if not os.path.exists(args.output_path):
+        os.makedirs(args.output_path)
+
+    with open(os.path.join(args.output_path,
+                           "recording_version_information.csv"), "w") as f:
+        f.write("VersionMajor,VersionMinor\n0,1\n")
+
+    descriptor_pool = [bytes(rng.randrange(256) for _ in range(DESCRIPTOR_SIZE))
+                       for _ in range(4 * args.num_features)]
+
+    for sensor_index, sensor_name in enumerate(args.sensors.split(",")):
+        print("Writing", sensor_name)
+        write_sensor(args, rng, sensor_index, sensor_name, descriptor_pool)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,7 +11,12 @@
 
 #pragma once
 
+#include <Debugging/Sal.h>
+
+#include <Debugging/Logger.h>
 #include <Debugging/Trace.h>
 #include <Debugging/Timer.h>
 #include <Debugging/TimerGuard.h>
+#include <Debugging/Profiler.h>
+#include <Debugging/Metrics.h>
 #include <Debugging/CodeContracts.h>
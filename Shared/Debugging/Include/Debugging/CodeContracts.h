@@ -11,10 +11,22 @@
 
 #pragma once
 
+//
+// Reports a contract failure before the exception is thrown. The message is logged at
+// the Error level without checking whether the level is enabled, so that no level
+// setting can suppress it.
+//
+#define DBG_CONTRACT_FAILED(...) \
+    do { \
+        static dbg::LogSite _contractSite("Contracts", dbg::LogLevel::Error); \
+        dbg::log(_contractSite, __VA_ARGS__); \
+        dbg::Logger::Flush(); \
+    } while (0, 0)
+
 #define ASSERT(expr) \
     do { \
         if (!(expr)) { \
-            dbg::trace(L"ERROR: %S:%i: ASSERT(%S) check failed", __FILE__, __LINE__, #expr); \
+            DBG_CONTRACT_FAILED(L"ERROR: %S:%i: ASSERT(%S) check failed", __FILE__, __LINE__, #expr); \
             throw std::logic_error("assertion failure"); \
         } \
     } while (0, 0)
@@ -23,7 +35,7 @@
     do { \
         const HRESULT _expr_hr = (expr); \
         if (FAILED(_expr_hr)) { \
-            dbg::trace(L"ERROR: %S:%i: ASSERT_SUCCEEDED(%S) check failed with HRESULT 0x%08x", __FILE__, __LINE__, #expr, _expr_hr); \
+            DBG_CONTRACT_FAILED(L"ERROR: %S:%i: ASSERT_SUCCEEDED(%S) check failed with HRESULT 0x%08x", __FILE__, __LINE__, #expr, _expr_hr); \
             throw std::logic_error("assertion failure"); \
         } \
     } while (0, 0)
@@ -31,7 +43,7 @@
 #define REQUIRES(expr) \
     do { \
         if (!(expr)) { \
-            dbg::trace(L"ERROR: %S:%i: REQUIRES(%S) check failed", __FILE__, __LINE__, #expr); \
+            DBG_CONTRACT_FAILED(L"ERROR: %S:%i: REQUIRES(%S) check failed", __FILE__, __LINE__, #expr); \
             throw std::logic_error("assertion failure"); \
         } \
     } while (0, 0)
@@ -39,7 +51,7 @@
 #define ENSURES(expr) \
     do { \
         if (!(expr)) { \
-            dbg::trace(L"ERROR: %S:%i: ENSURES(%S) check failed", __FILE__, __LINE__, #expr); \
+            DBG_CONTRACT_FAILED(L"ERROR: %S:%i: ENSURES(%S) check failed", __FILE__, __LINE__, #expr); \
             throw std::logic_error("assertion failure"); \
         } \
     } while (0, 0)
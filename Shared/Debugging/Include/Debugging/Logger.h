@@ -0,0 +1,284 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace dbg
+{
+    enum class LogLevel : int32_t
+    {
+        Off,
+        Error,
+        Warning,
+        Information,
+        Verbose
+    };
+
+    //
+    // Destination of the formatted log messages. Outputs are only called from the
+    // logger thread.
+    //
+    class ILogOutput
+    {
+    public:
+        virtual ~ILogOutput()
+        {
+        }
+
+        virtual void Write(
+            _In_ LogLevel level,
+            _In_z_ const char* component,
+            _In_ uint32_t threadId,
+            _In_ double millisecondsSinceStart,
+            _In_z_ const wchar_t* message) = 0;
+
+        virtual void Flush()
+        {
+        }
+    };
+
+    //
+    // Sends the messages to the debugger using the OutputDebugString API.
+    //
+    class DebuggerLogOutput
+        : public ILogOutput
+    {
+    public:
+        virtual void Write(
+            _In_ LogLevel level,
+            _In_z_ const char* component,
+            _In_ uint32_t threadId,
+            _In_ double millisecondsSinceStart,
+            _In_z_ const wchar_t* message) override;
+    };
+
+    //
+    // Appends the messages to a UTF-8 text file, one per line.
+    //
+    class FileLogOutput
+        : public ILogOutput
+    {
+    public:
+        explicit FileLogOutput(
+            _In_ const std::wstring& filePath);
+
+        virtual ~FileLogOutput();
+
+        virtual void Write(
+            _In_ LogLevel level,
+            _In_z_ const char* component,
+            _In_ uint32_t threadId,
+            _In_ double millisecondsSinceStart,
+            _In_z_ const wchar_t* message) override;
+
+        virtual void Flush() override;
+
+    private:
+        FILE* _file;
+    };
+
+    //
+    // Sends each message as a UTF-8 UDP datagram, e.g. to netcat or a syslog collector
+    // on the development machine.
+    //
+    class SocketLogOutput
+        : public ILogOutput
+    {
+    public:
+        SocketLogOutput(
+            _In_z_ const char* host,
+            _In_z_ const char* port);
+
+        virtual ~SocketLogOutput();
+
+        virtual void Write(
+            _In_ LogLevel level,
+            _In_z_ const char* component,
+            _In_ uint32_t threadId,
+            _In_ double millisecondsSinceStart,
+            _In_z_ const wchar_t* message) override;
+
+    private:
+        bool _initialized;
+        uintptr_t _socket;
+    };
+
+    //
+    // Asynchronous logger. Logging calls capture the arguments referenced by the format
+    // string in binary form (strings are copied) into a bounded, lock-free multiple
+    // producer queue; a background thread formats the messages and writes them to the
+    // outputs. Messages are dropped, and counted, when the queue is full.
+    //
+    // The format uses the wide printf conventions of the CRT: %s is a wide string, %S a
+    // narrow string. It is copied along with the arguments, truncated to 255 characters.
+    //
+    class Logger
+    {
+    public:
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            // Per-call cost on the logging thread, for a message with three arguments.
+            double EnabledCallTimeInNanoseconds;
+            double DisabledCallTimeInNanoseconds;
+            double RateLimitedCallTimeInNanoseconds;
+
+            // Cost of formatting the same message on the calling thread, as dbg::trace
+            // did before calling OutputDebugString.
+            double SynchronousFormattingTimeInNanoseconds;
+
+            // Messages per second accepted from the given number of threads logging at
+            // once, and the fraction of them that was dropped because the queue was full.
+            uint32_t NumberOfThreads;
+            double ContendedMessagesPerSecond;
+            double ContendedDroppedFraction;
+        };
+
+        //
+        // Sets the level of a component, or of all the components without a level of
+        // their own if the component is null. The default level is Information.
+        //
+        static void SetLevel(
+            _In_opt_z_ const char* component,
+            _In_ LogLevel level);
+
+        static LogLevel GetLevel(
+            _In_z_ const char* component);
+
+        //
+        // Adds an output. The debugger output is installed until the first output is
+        // added.
+        //
+        static void AddOutput(
+            _In_ const std::shared_ptr<ILogOutput>& output);
+
+        static void RemoveAllOutputs();
+
+        //
+        // Waits until the messages logged so far have been written to the outputs.
+        //
+        static void Flush();
+
+        static uint64_t GetNumberOfDroppedMessages();
+
+        //
+        // Measures the cost of logging on the calling thread and the throughput of the
+        // given number of threads logging at once. The outputs are disconnected during
+        // the benchmark; messages logged by other threads meanwhile are discarded.
+        //
+        static void Benchmark(
+            _In_ uint32_t numberOfThreads,
+            _In_ uint32_t numberOfMessagesPerThread,
+            _Out_ BenchmarkStatistics& statistics);
+
+        static uint32_t GetConfigurationGeneration()
+        {
+            return s_configurationGeneration.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static std::atomic<uint32_t> s_configurationGeneration;
+    };
+
+    //
+    // A logging call site: its component, level and rate limit. Call sites are static
+    // objects created by the DBG_LOG macros; they cache whether their level is enabled
+    // for their component, so that a disabled call costs two relaxed atomic loads.
+    //
+    class LogSite
+    {
+    public:
+        LogSite(
+            _In_z_ const char* component,
+            _In_ LogLevel level,
+            _In_ double minimumIntervalInMilliseconds = 0.0);
+
+        bool IsEnabled() const
+        {
+            const uint32_t generation =
+                Logger::GetConfigurationGeneration();
+
+            if (generation != _generation.load(std::memory_order_relaxed))
+            {
+                Refresh(
+                    generation);
+            }
+
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        //
+        // Returns false if the message must be suppressed by the rate limit; otherwise
+        // returns the number of messages suppressed since the last one.
+        //
+        bool TryAcquire(
+            _Out_ uint32_t& numberOfSuppressedMessages);
+
+        const char* GetComponent() const;
+
+        LogLevel GetLevel() const;
+
+    private:
+        void Refresh(
+            _In_ uint32_t generation) const;
+
+    private:
+        const char* const _component;
+        const LogLevel _level;
+        const int64_t _minimumIntervalInTicks;
+
+        mutable std::atomic<uint32_t> _generation;
+        mutable std::atomic<bool> _enabled;
+
+        std::atomic<int64_t> _nextMessageTicks;
+        std::atomic<uint32_t> _numberOfSuppressedMessages;
+    };
+
+    //
+    // Logs a message from the given call site.
+    //
+    void log(
+        _Inout_ LogSite& site,
+        _In_z_ _Printf_format_string_ const wchar_t* format,
+        ...);
+
+    void vlog(
+        _Inout_ LogSite& site,
+        _In_z_ const wchar_t* format,
+        _In_ va_list args);
+}
+
+#define DBG_LOG(component, level, ...) \
+    do { \
+        static dbg::LogSite _logSite(component, level); \
+        if (_logSite.IsEnabled()) { \
+            dbg::log(_logSite, __VA_ARGS__); \
+        } \
+    } while (0, 0)
+
+//
+// Logs at most one message every given number of milliseconds from the call site; the
+// next message reports how many were suppressed.
+//
+#define DBG_LOG_RATE_LIMITED(component, level, minimumIntervalInMilliseconds, ...) \
+    do { \
+        static dbg::LogSite _logSite(component, level, minimumIntervalInMilliseconds); \
+        if (_logSite.IsEnabled()) { \
+            dbg::log(_logSite, __VA_ARGS__); \
+        } \
+    } while (0, 0)
@@ -0,0 +1,212 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+
+namespace dbg
+{
+    //
+    // A monotonically increasing count, e.g. of frames or bytes.
+    //
+    class MetricCounter
+    {
+    public:
+        MetricCounter();
+
+        void Increment(
+            _In_ const uint64_t value = 1)
+        {
+            _value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        uint64_t GetValue() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> _value;
+    };
+
+    //
+    // A value that goes up and down, e.g. a queue depth.
+    //
+    class MetricGauge
+    {
+    public:
+        MetricGauge();
+
+        void Set(
+            _In_ const int64_t value)
+        {
+            _value.store(value, std::memory_order_relaxed);
+        }
+
+        void Add(
+            _In_ const int64_t value)
+        {
+            _value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        int64_t GetValue() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<int64_t> _value;
+    };
+
+    //
+    // HDR-style histogram of non-negative integer values, e.g. latencies in
+    // microseconds. Values below 32 are counted exactly; above that, every power of two
+    // is split into 16 linear buckets, so a reported percentile is within 6.25% of the
+    // recorded value over the whole 64-bit range. Recording a value costs a few relaxed
+    // atomic increments and takes no lock.
+    //
+    class LatencyHistogram
+    {
+    public:
+        static const uint32_t NumberOfSubBuckets = 16;
+        static const uint32_t NumberOfBuckets = 976;
+
+        struct Snapshot
+        {
+            Snapshot();
+
+            uint64_t Count;
+            uint64_t Sum;
+            uint64_t Maximum;
+
+            uint64_t Percentile50;
+            uint64_t Percentile90;
+            uint64_t Percentile99;
+            uint64_t Percentile999;
+        };
+
+        LatencyHistogram();
+
+        void Record(
+            _In_ const uint64_t value)
+        {
+            _buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t maximum = _maximum.load(std::memory_order_relaxed);
+
+            while (value > maximum &&
+                !_maximum.compare_exchange_weak(maximum, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        //
+        // Returns the counts and percentiles of the values recorded so far. Values recorded
+        // concurrently may or may not be included.
+        //
+        Snapshot GetSnapshot() const;
+
+        static uint32_t GetBucketIndex(
+            _In_ const uint64_t value);
+
+        //
+        // Returns the highest value counted by a bucket.
+        //
+        static uint64_t GetBucketUpperBound(
+            _In_ const uint32_t bucketIndex);
+
+    private:
+        std::array<std::atomic<uint64_t>, NumberOfBuckets> _buckets;
+        std::atomic<uint64_t> _count;
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _maximum;
+    };
+
+    //
+    // Process-wide registry of named counters, gauges and histograms. Names follow the
+    // Prometheus conventions and may carry labels, e.g.
+    //
+    //   hololensforcv_frames_arrived_total{sensor="PhotoVideo"}
+    //
+    // Looking a metric up takes a lock; call sites should do it once and keep the
+    // returned reference, which stays valid for the lifetime of the process. Updating a
+    // metric is lock-free.
+    //
+    class Metrics
+    {
+    public:
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            // Per-update cost on the calling thread.
+            double CounterIncrementTimeInNanoseconds;
+            double GaugeSetTimeInNanoseconds;
+            double HistogramRecordTimeInNanoseconds;
+
+            // Per-update cost of a histogram shared by the given number of threads
+            // recording at once.
+            uint32_t NumberOfThreads;
+            double ContendedHistogramRecordTimeInNanoseconds;
+
+            // Cost of formatting the registry for the endpoint.
+            double TextFormattingTimeInMilliseconds;
+            double JsonFormattingTimeInMilliseconds;
+        };
+
+        static MetricCounter& GetCounter(
+            _In_ const std::string& name);
+
+        static MetricGauge& GetGauge(
+            _In_ const std::string& name);
+
+        static LatencyHistogram& GetHistogram(
+            _In_ const std::string& name);
+
+        //
+        // Returns all the metrics in the Prometheus text exposition format; histograms
+        // are reported as summaries with 0.5, 0.9, 0.99 and 0.999 quantiles.
+        //
+        static std::string GetMetricsAsText();
+
+        static std::string GetMetricsAsJson();
+
+        //
+        // Measures the cost of updating metrics on the calling thread, of the given number
+        // of threads recording into one histogram at once, and of formatting the current
+        // contents of the registry. The metrics updated by the benchmark are not
+        // registered.
+        //
+        static void Benchmark(
+            _In_ uint32_t numberOfThreads,
+            _In_ uint32_t numberOfUpdatesPerThread,
+            _Out_ BenchmarkStatistics& statistics);
+    };
+
+    //
+    // Builds a metric name with a single label, e.g.
+    // MakeMetricName("hololensforcv_frames_arrived_total", "sensor", "PhotoVideo").
+    //
+    std::string MakeMetricName(
+        _In_z_ const char* name,
+        _In_z_ const char* labelName,
+        _In_ const std::string& labelValue);
+
+    std::string MakeMetricName(
+        _In_z_ const char* name,
+        _In_z_ const char* labelName,
+        _In_z_ const wchar_t* labelValue);
+}
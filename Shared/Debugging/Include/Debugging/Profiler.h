@@ -0,0 +1,122 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+
+//
+// Profiling spans are compiled in unless DBG_ENABLE_PROFILING is set to 0 before
+// including this header; they are only recorded while the profiler is enabled.
+//
+#if !defined(DBG_ENABLE_PROFILING)
+#define DBG_ENABLE_PROFILING 1
+#endif /* !defined(DBG_ENABLE_PROFILING) */
+
+namespace dbg
+{
+    //
+    // Records the begin and end times of nested spans of code, identified by static
+    // strings, and exports them as a Chrome trace (the JSON format loaded by
+    // chrome://tracing and ui.perfetto.dev).
+    //
+    // Each thread records its spans into its own fixed-size ring buffer, without
+    // locking; a background thread periodically drains the buffers to the trace file.
+    // Spans are dropped (and counted) when a ring buffer is full. While the profiler is
+    // disabled, a span costs a single relaxed atomic load.
+    //
+    class Profiler
+    {
+    public:
+        static bool IsEnabled()
+        {
+            return s_enabled.load(std::memory_order_relaxed);
+        }
+
+        //
+        // Enables the profiler and starts the thread that appends the recorded spans to
+        // the given trace file every flush interval.
+        //
+        static void StartFlushing(
+            _In_ const std::wstring& traceFilePath,
+            _In_ const uint32_t flushIntervalInMilliseconds = 500);
+
+        //
+        // Disables the profiler, drains the remaining spans and completes the trace file.
+        //
+        static void StopFlushing();
+
+        //
+        // Records a span of the calling thread. The name must have static storage
+        // duration, e.g. be a string literal.
+        //
+        static void RecordSpan(
+            _In_z_ const char* name,
+            _In_ const int64_t beginTicks,
+            _In_ const int64_t endTicks,
+            _In_ const uint32_t depth);
+
+        //
+        // Tracks the nesting depth of the calling thread's spans.
+        //
+        static uint32_t EnterSpan();
+
+        static void LeaveSpan();
+
+        static uint64_t GetNumberOfRecordedSpans();
+
+        static uint64_t GetNumberOfDroppedSpans();
+
+    private:
+        static std::atomic<bool> s_enabled;
+    };
+
+    //
+    // Records the lifetime of the object as a profiler span. If a threshold is
+    // specified, also emits a debug trace when the span lasts longer than that, like
+    // the TimerGuard did, whether or not the profiler is enabled.
+    //
+    class ProfilerSpan
+    {
+    public:
+        explicit ProfilerSpan(
+            _In_z_ const char* name,
+            _In_ const double maximumTimeElapsedInMillisecondsAllowed = 0.0);
+
+        ~ProfilerSpan();
+
+        ProfilerSpan(const ProfilerSpan&) = delete;
+        ProfilerSpan& operator=(const ProfilerSpan&) = delete;
+
+    private:
+        const char* const _name;
+        const double _maximumTimeElapsedInMillisecondsAllowed;
+
+        int64_t _beginTicks;
+        uint32_t _depth;
+        bool _recording;
+    };
+}
+
+#define DBG_PROFILE_CONCATENATE_(a, b) a##b
+#define DBG_PROFILE_CONCATENATE(a, b) DBG_PROFILE_CONCATENATE_(a, b)
+
+#if DBG_ENABLE_PROFILING
+#define DBG_PROFILE_SPAN(name) \
+    dbg::ProfilerSpan DBG_PROFILE_CONCATENATE(_profilerSpan, __LINE__)(name)
+#define DBG_PROFILE_SPAN_REPORT_OVER(name, milliseconds) \
+    dbg::ProfilerSpan DBG_PROFILE_CONCATENATE(_profilerSpan, __LINE__)(name, milliseconds)
+#else
+#define DBG_PROFILE_SPAN(name) \
+    do { } while (0, 0)
+#define DBG_PROFILE_SPAN_REPORT_OVER(name, milliseconds) \
+    do { } while (0, 0)
+#endif /* DBG_ENABLE_PROFILING */
@@ -14,7 +14,8 @@
 namespace dbg
 {
     //
-    // QueryPerformanceCounter-based timer / stop-watch.
+    // QueryPerformanceCounter-based timer / stop-watch (CLOCK_MONOTONIC-based on other
+    // platforms).
     //
     class Timer
     {
@@ -29,10 +30,18 @@ namespace dbg
 
         double GetMillisecondsFromLastEvent() const;
 
+        //
+        // Returns the current QueryPerformanceCounter value, and the number of counter
+        // ticks per millisecond.
+        //
+        static int64_t GetCurrentTicks();
+
+        static double GetTicksPerMillisecond();
+
     private:
         double _ticksPerMilisecond;
 
-        LARGE_INTEGER _startTime;
-        LARGE_INTEGER _lastEventTime;
+        int64_t _startTime;
+        int64_t _lastEventTime;
     };
 }
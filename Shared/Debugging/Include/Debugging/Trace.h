@@ -14,7 +14,8 @@
 namespace dbg
 {
     //
-    // Formats a message and sends it to the debugger using the OutputDebugString API.
+    // Formats a message and sends it to the debugger using the OutputDebugString API,
+    // asynchronously (see Logger).
     //
     void trace(
         _In_z_ const wchar_t* msg,
@@ -0,0 +1,303 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#if defined(_WIN32)
+#pragma comment(lib, "ws2_32.lib")
+#endif /* defined(_WIN32) */
+
+namespace dbg
+{
+    namespace
+    {
+#if defined(_WIN32)
+        typedef SOCKET NativeSocket;
+
+        const NativeSocket c_invalidNativeSocket = INVALID_SOCKET;
+
+        void CloseSocket(
+            _In_ NativeSocket socketToClose)
+        {
+            closesocket(socketToClose);
+        }
+#else
+        typedef int NativeSocket;
+
+        const NativeSocket c_invalidNativeSocket = -1;
+
+        void CloseSocket(
+            _In_ NativeSocket socketToClose)
+        {
+            close(socketToClose);
+        }
+#endif /* defined(_WIN32) */
+
+        const uintptr_t c_invalidSocket = static_cast<uintptr_t>(c_invalidNativeSocket);
+
+        const char* GetLevelName(
+            _In_ LogLevel level)
+        {
+            switch (level)
+            {
+            case LogLevel::Error:
+                return "ERROR";
+
+            case LogLevel::Warning:
+                return "WARNING";
+
+            case LogLevel::Information:
+                return "INFO";
+
+            case LogLevel::Verbose:
+                return "VERBOSE";
+
+            default:
+                return "";
+            }
+        }
+
+        //
+        // Formats a message as a line of text: time in milliseconds, thread, level,
+        // component and message.
+        //
+        void FormatLine(
+            _In_ LogLevel level,
+            _In_z_ const char* component,
+            _In_ uint32_t threadId,
+            _In_ double millisecondsSinceStart,
+            _In_z_ const wchar_t* message,
+            _Inout_ std::string& line)
+        {
+            char prefix[128];
+
+            snprintf(
+                prefix,
+                sizeof(prefix),
+                "%12.3f %6u %-7s %s: ",
+                millisecondsSinceStart,
+                threadId,
+                GetLevelName(level),
+                component);
+
+            line.assign(prefix);
+
+            AppendUtf8(
+                message,
+                line);
+
+            line.push_back('\n');
+        }
+    }
+
+    void DebuggerLogOutput::Write(
+        _In_ LogLevel /* level */,
+        _In_z_ const char* /* component */,
+        _In_ uint32_t /* threadId */,
+        _In_ double /* millisecondsSinceStart */,
+        _In_z_ const wchar_t* message)
+    {
+#if defined(_WIN32)
+        //
+        // Same output as the synchronous dbg::trace used to produce.
+        //
+        std::wstring line(message);
+
+        line.push_back(L'\n');
+
+        OutputDebugStringW(
+            line.c_str());
+#else
+        //
+        // There is no debugger output; use the standard error stream.
+        //
+        std::string line;
+
+        AppendUtf8(
+            message,
+            line);
+
+        line.push_back('\n');
+
+        fwrite(
+            line.data(),
+            1 /* _ElementSize */,
+            line.size(),
+            stderr);
+#endif /* defined(_WIN32) */
+    }
+
+    FileLogOutput::FileLogOutput(
+        _In_ const std::wstring& filePath)
+        : _file(nullptr)
+    {
+#if defined(_WIN32)
+        if (0 != _wfopen_s(&_file, filePath.c_str(), L"ab"))
+        {
+            _file = nullptr;
+        }
+#else
+        std::string utf8FilePath;
+
+        AppendUtf8(
+            filePath.c_str(),
+            utf8FilePath);
+
+        _file = fopen(
+            utf8FilePath.c_str(),
+            "ab");
+#endif /* defined(_WIN32) */
+    }
+
+    FileLogOutput::~FileLogOutput()
+    {
+        if (nullptr != _file)
+        {
+            fclose(_file);
+        }
+    }
+
+    void FileLogOutput::Write(
+        _In_ LogLevel level,
+        _In_z_ const char* component,
+        _In_ uint32_t threadId,
+        _In_ double millisecondsSinceStart,
+        _In_z_ const wchar_t* message)
+    {
+        if (nullptr == _file)
+        {
+            return;
+        }
+
+        std::string line;
+
+        FormatLine(
+            level,
+            component,
+            threadId,
+            millisecondsSinceStart,
+            message,
+            line);
+
+        fwrite(
+            line.data(),
+            1 /* _ElementSize */,
+            line.size(),
+            _file);
+    }
+
+    void FileLogOutput::Flush()
+    {
+        if (nullptr != _file)
+        {
+            fflush(_file);
+        }
+    }
+
+    SocketLogOutput::SocketLogOutput(
+        _In_z_ const char* host,
+        _In_z_ const char* port)
+        : _initialized(false)
+        , _socket(c_invalidSocket)
+    {
+#if defined(_WIN32)
+        WSADATA data;
+
+        if (0 != WSAStartup(MAKEWORD(2, 2), &data))
+        {
+            return;
+        }
+#endif /* defined(_WIN32) */
+
+        _initialized = true;
+
+        addrinfo hints = {};
+
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_protocol = IPPROTO_UDP;
+
+        addrinfo* addresses = nullptr;
+
+        if (0 != getaddrinfo(host, port, &hints, &addresses))
+        {
+            return;
+        }
+
+        for (addrinfo* address = addresses; nullptr != address; address = address->ai_next)
+        {
+            const NativeSocket datagramSocket =
+                socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+
+            if (c_invalidNativeSocket == datagramSocket)
+            {
+                continue;
+            }
+
+            if (0 == connect(datagramSocket, address->ai_addr, static_cast<int>(address->ai_addrlen)))
+            {
+                _socket = static_cast<uintptr_t>(datagramSocket);
+                break;
+            }
+
+            CloseSocket(datagramSocket);
+        }
+
+        freeaddrinfo(addresses);
+    }
+
+    SocketLogOutput::~SocketLogOutput()
+    {
+        if (c_invalidSocket != _socket)
+        {
+            CloseSocket(static_cast<NativeSocket>(_socket));
+        }
+
+#if defined(_WIN32)
+        if (_initialized)
+        {
+            WSACleanup();
+        }
+#endif /* defined(_WIN32) */
+    }
+
+    void SocketLogOutput::Write(
+        _In_ LogLevel level,
+        _In_z_ const char* component,
+        _In_ uint32_t threadId,
+        _In_ double millisecondsSinceStart,
+        _In_z_ const wchar_t* message)
+    {
+        if (c_invalidSocket == _socket)
+        {
+            return;
+        }
+
+        std::string line;
+
+        FormatLine(
+            level,
+            component,
+            threadId,
+            millisecondsSinceStart,
+            message,
+            line);
+
+        //
+        // Datagrams are best effort: a failed send only loses this message.
+        //
+        send(
+            static_cast<NativeSocket>(_socket),
+            line.data(),
+            static_cast<int>(line.size()),
+            0 /* flags */);
+    }
+}
@@ -0,0 +1,1194 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace dbg
+{
+    namespace
+    {
+        // Must be a power of two.
+        const uint32_t c_queueCapacity = 1024;
+
+        const uint32_t c_maximumNumberOfArguments = 12;
+        const uint32_t c_stringStorageLength = 256;
+        const uint32_t c_formatLength = 256;
+        const uint32_t c_messageLength = 1024;
+
+        enum class LogArgumentType : uint8_t
+        {
+            Int32,
+            Int64,
+            Double,
+            Pointer,
+            String
+        };
+
+        struct LogArgument
+        {
+            LogArgumentType Type;
+
+            union
+            {
+                int64_t Integer;
+                double Real;
+                const void* Pointer;
+                uint32_t StringOffset;
+            };
+        };
+
+        struct LogRecord
+        {
+            // Vyukov's bounded queue: equal to the enqueue position when the slot is free,
+            // and to the position plus one once the record is published.
+            std::atomic<uint32_t> Sequence;
+
+            const LogSite* Site;
+            int64_t Ticks;
+            uint32_t ThreadId;
+            uint32_t NumberOfSuppressedMessages;
+
+            uint32_t NumberOfArguments;
+            LogArgument Arguments[c_maximumNumberOfArguments];
+
+            uint32_t StringLength;
+            wchar_t Strings[c_stringStorageLength];
+
+            //
+            // Copied, as the caller's format may be gone by the time the record is
+            // formatted; longer formats are truncated.
+            //
+            wchar_t Format[c_formatLength];
+        };
+
+        enum class LengthModifier
+        {
+            None,
+            Short,
+            Long,
+            LongLong,
+            Size
+        };
+
+        //
+        // A printf conversion specification, e.g. %-08.3f.
+        //
+        struct ConversionSpecification
+        {
+            const wchar_t* Begin;
+            const wchar_t* End;
+
+            bool WidthFromArgument;
+            bool PrecisionFromArgument;
+            LengthModifier Length;
+            wchar_t Conversion;
+        };
+
+        //
+        // Parses the conversion specification starting after a '%'. Returns false at the
+        // end of the format string.
+        //
+        bool ParseConversionSpecification(
+            _In_z_ const wchar_t* begin,
+            _Out_ ConversionSpecification& specification)
+        {
+            const wchar_t* position = begin;
+
+            specification.Begin = begin - 1;
+            specification.WidthFromArgument = false;
+            specification.PrecisionFromArgument = false;
+            specification.Length = LengthModifier::None;
+
+            while (L'-' == *position || L'+' == *position || L' ' == *position || L'#' == *position || L'0' == *position)
+            {
+                ++position;
+            }
+
+            if (L'*' == *position)
+            {
+                specification.WidthFromArgument = true;
+                ++position;
+            }
+
+            while (*position >= L'0' && *position <= L'9')
+            {
+                ++position;
+            }
+
+            if (L'.' == *position)
+            {
+                ++position;
+
+                if (L'*' == *position)
+                {
+                    specification.PrecisionFromArgument = true;
+                    ++position;
+                }
+
+                while (*position >= L'0' && *position <= L'9')
+                {
+                    ++position;
+                }
+            }
+
+            if (L'h' == position[0])
+            {
+                specification.Length = LengthModifier::Short;
+                position += (L'h' == position[1]) ? 2 : 1;
+            }
+            else if (L'l' == position[0] && L'l' == position[1])
+            {
+                specification.Length = LengthModifier::LongLong;
+                position += 2;
+            }
+            else if (L'l' == position[0] || L'w' == position[0] || L'L' == position[0])
+            {
+                specification.Length = (sizeof(long) == 8) ? LengthModifier::LongLong : LengthModifier::Long;
+                ++position;
+            }
+            else if (L'I' == position[0] && L'6' == position[1] && L'4' == position[2])
+            {
+                specification.Length = LengthModifier::LongLong;
+                position += 3;
+            }
+            else if (L'I' == position[0] && L'3' == position[1] && L'2' == position[2])
+            {
+                specification.Length = LengthModifier::Long;
+                position += 3;
+            }
+            else if (L'I' == position[0] || L'z' == position[0] || L'j' == position[0] || L't' == position[0])
+            {
+                specification.Length = (L'j' == position[0]) ? LengthModifier::LongLong : LengthModifier::Size;
+                ++position;
+            }
+
+            specification.Conversion = *position;
+            specification.End = position + 1;
+
+            return L'\0' != specification.Conversion;
+        }
+
+        bool IsIntegerConversion(
+            _In_ wchar_t conversion)
+        {
+            return nullptr != wcschr(L"diouxXcC", conversion);
+        }
+
+        bool IsRealConversion(
+            _In_ wchar_t conversion)
+        {
+            return nullptr != wcschr(L"eEfFgGaA", conversion);
+        }
+
+        bool IsStringConversion(
+            _In_ wchar_t conversion)
+        {
+            return L's' == conversion || L'S' == conversion || L'Z' == conversion;
+        }
+
+        //
+        // Whether a string conversion takes a wide string, following the conventions of
+        // the CRT's wide printf functions.
+        //
+        bool IsWideStringConversion(
+            _In_ const ConversionSpecification& specification)
+        {
+            if (LengthModifier::Short == specification.Length)
+            {
+                return false;
+            }
+            else if (LengthModifier::Long == specification.Length || LengthModifier::LongLong == specification.Length)
+            {
+                return true;
+            }
+
+            return L's' == specification.Conversion;
+        }
+
+        void CaptureString(
+            _In_opt_ const void* value,
+            _In_ bool wide,
+            _Inout_ LogRecord& record,
+            _Inout_ LogArgument& argument)
+        {
+            argument.Type = LogArgumentType::String;
+            argument.StringOffset = record.StringLength;
+
+            const uint32_t available =
+                c_stringStorageLength - 1 - record.StringLength;
+
+            wchar_t* destination =
+                record.Strings + record.StringLength;
+
+            uint32_t length = 0;
+
+            if (nullptr == value)
+            {
+                static const wchar_t c_null[] = L"(null)";
+
+                for (; length < available && L'\0' != c_null[length]; ++length)
+                {
+                    destination[length] = c_null[length];
+                }
+            }
+            else if (wide)
+            {
+                const wchar_t* source =
+                    static_cast<const wchar_t*>(value);
+
+                for (; length < available && L'\0' != source[length]; ++length)
+                {
+                    destination[length] = source[length];
+                }
+            }
+            else
+            {
+                const unsigned char* source =
+                    static_cast<const unsigned char*>(value);
+
+                for (; length < available && '\0' != source[length]; ++length)
+                {
+                    destination[length] = static_cast<wchar_t>(source[length]);
+                }
+            }
+
+            destination[length] = L'\0';
+            record.StringLength += length + 1;
+        }
+
+        //
+        // Copies the arguments referenced by the format string into the record, without
+        // formatting them.
+        //
+        void CaptureArguments(
+            _In_z_ const wchar_t* format,
+            _In_ va_list args,
+            _Inout_ LogRecord& record)
+        {
+            record.NumberOfArguments = 0;
+            record.StringLength = 0;
+
+            ConversionSpecification specification;
+
+            for (const wchar_t* position = format; L'\0' != *position; ++position)
+            {
+                if (L'%' != *position)
+                {
+                    continue;
+                }
+                else if (L'%' == position[1])
+                {
+                    ++position;
+                    continue;
+                }
+                else if (!ParseConversionSpecification(position + 1, specification))
+                {
+                    break;
+                }
+
+                position = specification.End - 1;
+
+                //
+                // Stop at the first argument that does not fit: it and the following ones
+                // are formatted as '?'.
+                //
+                const uint32_t numberOfArguments =
+                    (specification.WidthFromArgument ? 1 : 0) +
+                    (specification.PrecisionFromArgument ? 1 : 0) +
+                    1;
+
+                if (record.NumberOfArguments + numberOfArguments > c_maximumNumberOfArguments ||
+                    record.StringLength >= c_stringStorageLength - 1)
+                {
+                    break;
+                }
+
+                if (specification.WidthFromArgument)
+                {
+                    LogArgument& argument = record.Arguments[record.NumberOfArguments++];
+
+                    argument.Type = LogArgumentType::Int32;
+                    argument.Integer = va_arg(args, int);
+                }
+
+                if (specification.PrecisionFromArgument)
+                {
+                    LogArgument& argument = record.Arguments[record.NumberOfArguments++];
+
+                    argument.Type = LogArgumentType::Int32;
+                    argument.Integer = va_arg(args, int);
+                }
+
+                LogArgument& argument = record.Arguments[record.NumberOfArguments++];
+
+                if (IsIntegerConversion(specification.Conversion))
+                {
+                    const bool is64Bit =
+                        (LengthModifier::LongLong == specification.Length) ||
+                        (LengthModifier::Size == specification.Length && sizeof(size_t) == 8);
+
+                    if (is64Bit)
+                    {
+                        argument.Type = LogArgumentType::Int64;
+                        argument.Integer = va_arg(args, long long);
+                    }
+                    else
+                    {
+                        argument.Type = LogArgumentType::Int32;
+                        argument.Integer = va_arg(args, int);
+                    }
+                }
+                else if (IsRealConversion(specification.Conversion))
+                {
+                    argument.Type = LogArgumentType::Double;
+                    argument.Real = va_arg(args, double);
+                }
+                else if (IsStringConversion(specification.Conversion))
+                {
+                    CaptureString(
+                        va_arg(args, const void*),
+                        IsWideStringConversion(specification),
+                        record,
+                        argument);
+                }
+                else if (L'p' == specification.Conversion || L'n' == specification.Conversion)
+                {
+                    argument.Type = LogArgumentType::Pointer;
+                    argument.Pointer = va_arg(args, const void*);
+                }
+                else
+                {
+                    --record.NumberOfArguments;
+                    break;
+                }
+            }
+        }
+
+        //
+        // Formats a single captured value with the given conversion, replacing the length
+        // modifier of the original specification by one that matches the captured type.
+        //
+        int FormatArgument(
+            _In_ const ConversionSpecification& specification,
+            _In_reads_(numberOfArguments) const LogArgument* arguments,
+            _In_ uint32_t numberOfArguments,
+            _In_ const LogRecord& record,
+            _Out_writes_(destinationLength) wchar_t* destination,
+            _In_ size_t destinationLength)
+        {
+            wchar_t formatted[64] = {};
+            size_t formattedLength = 0;
+            uint32_t argumentIndex = 0;
+
+            const wchar_t* position = specification.Begin;
+
+            // '%', flags, width and precision.
+            for (; position < specification.End - 1; ++position)
+            {
+                const wchar_t character = *position;
+
+                if (nullptr != wcschr(L"hlwLIzjt", character))
+                {
+                    break;
+                }
+
+                if (L'*' == character)
+                {
+                    if (argumentIndex >= numberOfArguments)
+                    {
+                        return -1;
+                    }
+
+                    formattedLength += swprintf(
+                        formatted + formattedLength,
+                        _countof(formatted) - formattedLength,
+                        L"%d",
+                        static_cast<int>(arguments[argumentIndex++].Integer));
+                }
+                else if (formattedLength + 1 < _countof(formatted))
+                {
+                    formatted[formattedLength++] = character;
+                }
+            }
+
+            if (argumentIndex >= numberOfArguments || formattedLength + 4 >= _countof(formatted))
+            {
+                return -1;
+            }
+
+            const LogArgument& argument = arguments[argumentIndex];
+            const wchar_t conversion = specification.Conversion;
+
+            switch (argument.Type)
+            {
+            case LogArgumentType::Int32:
+                if (L'c' == conversion || L'C' == conversion)
+                {
+                    formatted[formattedLength++] = L'l';
+                    formatted[formattedLength++] = L'c';
+                    formatted[formattedLength] = L'\0';
+
+                    return swprintf(destination, destinationLength, formatted, static_cast<wchar_t>(argument.Integer));
+                }
+
+                formatted[formattedLength++] = conversion;
+                formatted[formattedLength] = L'\0';
+
+                return swprintf(destination, destinationLength, formatted, static_cast<int>(argument.Integer));
+
+            case LogArgumentType::Int64:
+                formatted[formattedLength++] = L'l';
+                formatted[formattedLength++] = L'l';
+                formatted[formattedLength++] = conversion;
+                formatted[formattedLength] = L'\0';
+
+                return swprintf(destination, destinationLength, formatted, static_cast<long long>(argument.Integer));
+
+            case LogArgumentType::Double:
+                formatted[formattedLength++] = conversion;
+                formatted[formattedLength] = L'\0';
+
+                return swprintf(destination, destinationLength, formatted, argument.Real);
+
+            case LogArgumentType::Pointer:
+                if (L'n' == conversion)
+                {
+                    return 0;
+                }
+
+                formatted[formattedLength++] = L'p';
+                formatted[formattedLength] = L'\0';
+
+                return swprintf(destination, destinationLength, formatted, argument.Pointer);
+
+            case LogArgumentType::String:
+                formatted[formattedLength++] = L'l';
+                formatted[formattedLength++] = L's';
+                formatted[formattedLength] = L'\0';
+
+                return swprintf(destination, destinationLength, formatted, record.Strings + argument.StringOffset);
+            }
+
+            return -1;
+        }
+
+        //
+        // Formats the message of a record. Returns the length of the message.
+        //
+        size_t FormatRecord(
+            _In_ const LogRecord& record,
+            _Out_writes_(messageLength) wchar_t* message,
+            _In_ size_t messageLength)
+        {
+            size_t length = 0;
+            uint32_t argumentIndex = 0;
+
+            ConversionSpecification specification;
+
+            for (const wchar_t* position = record.Format; L'\0' != *position && length + 1 < messageLength; ++position)
+            {
+                if (L'%' != *position)
+                {
+                    message[length++] = *position;
+                    continue;
+                }
+                else if (L'%' == position[1])
+                {
+                    message[length++] = L'%';
+                    ++position;
+                    continue;
+                }
+                else if (!ParseConversionSpecification(position + 1, specification))
+                {
+                    break;
+                }
+
+                position = specification.End - 1;
+
+                const uint32_t numberOfArguments =
+                    (specification.WidthFromArgument ? 1 : 0) +
+                    (specification.PrecisionFromArgument ? 1 : 0) +
+                    1;
+
+                int written = -1;
+
+                if (argumentIndex + numberOfArguments <= record.NumberOfArguments)
+                {
+                    written = FormatArgument(
+                        specification,
+                        record.Arguments + argumentIndex,
+                        numberOfArguments,
+                        record,
+                        message + length,
+                        messageLength - length);
+                }
+
+                argumentIndex += numberOfArguments;
+
+                if (written < 0)
+                {
+                    message[length++] = L'?';
+                }
+                else
+                {
+                    length += written;
+                }
+            }
+
+            if (record.NumberOfSuppressedMessages > 0 && length + 1 < messageLength)
+            {
+                const int written =
+                    swprintf(
+                        message + length,
+                        messageLength - length,
+                        L" (%u similar messages suppressed)",
+                        record.NumberOfSuppressedMessages);
+
+                if (written > 0)
+                {
+                    length += written;
+                }
+            }
+
+            length = std::min(length, messageLength - 1);
+            message[length] = L'\0';
+
+            return length;
+        }
+
+        struct LoggerState
+        {
+            LoggerState()
+                : Records(c_queueCapacity)
+                , EnqueuePosition(0)
+                , DequeuePosition(0)
+                , NumberOfDroppedMessages(0)
+                , DefaultLevel(LogLevel::Information)
+                , UseDefaultOutput(true)
+                , DiscardMessages(false)
+                , StartTicks(Timer::GetCurrentTicks())
+            {
+                for (uint32_t index = 0; index < c_queueCapacity; ++index)
+                {
+                    Records[index].Sequence.store(index, std::memory_order_relaxed);
+                }
+
+                //
+                // The thread is never joined: the state lives until the process exits.
+                //
+                Consumer = std::thread(
+                    [this]()
+                    {
+                        Consume();
+                    });
+
+                ConsumerThreadId = Consumer.get_id();
+            }
+
+            LogRecord* TryClaim()
+            {
+                uint32_t position =
+                    EnqueuePosition.load(std::memory_order_relaxed);
+
+                for (;;)
+                {
+                    LogRecord& record =
+                        Records[position & (c_queueCapacity - 1)];
+
+                    const int32_t difference =
+                        static_cast<int32_t>(record.Sequence.load(std::memory_order_acquire) - position);
+
+                    if (0 == difference)
+                    {
+                        if (EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        {
+                            return &record;
+                        }
+                    }
+                    else if (difference < 0)
+                    {
+                        NumberOfDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+
+                        return nullptr;
+                    }
+                    else
+                    {
+                        position = EnqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            //
+            // Formats and writes the published records. Returns the number of records.
+            //
+            uint32_t Drain()
+            {
+                uint32_t numberOfRecords = 0;
+                uint32_t position = DequeuePosition.load(std::memory_order_relaxed);
+
+                for (;; ++position, ++numberOfRecords)
+                {
+                    LogRecord& record =
+                        Records[position & (c_queueCapacity - 1)];
+
+                    if (record.Sequence.load(std::memory_order_acquire) != position + 1)
+                    {
+                        break;
+                    }
+
+                    if (!DiscardMessages.load(std::memory_order_relaxed))
+                    {
+                        FormatRecord(
+                            record,
+                            Message,
+                            _countof(Message));
+
+                        const double millisecondsSinceStart =
+                            (record.Ticks - StartTicks) / Timer::GetTicksPerMillisecond();
+
+                        std::lock_guard<std::mutex> guard(
+                            OutputsMutex);
+
+                        if (UseDefaultOutput)
+                        {
+                            DefaultOutput.Write(
+                                record.Site->GetLevel(),
+                                record.Site->GetComponent(),
+                                record.ThreadId,
+                                millisecondsSinceStart,
+                                Message);
+                        }
+
+                        for (const std::shared_ptr<ILogOutput>& output : Outputs)
+                        {
+                            output->Write(
+                                record.Site->GetLevel(),
+                                record.Site->GetComponent(),
+                                record.ThreadId,
+                                millisecondsSinceStart,
+                                Message);
+                        }
+                    }
+
+                    record.Sequence.store(
+                        position + c_queueCapacity,
+                        std::memory_order_release);
+                }
+
+                if (numberOfRecords > 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> guard(
+                            OutputsMutex);
+
+                        for (const std::shared_ptr<ILogOutput>& output : Outputs)
+                        {
+                            output->Flush();
+                        }
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> guard(
+                            ConsumerMutex);
+
+                        DequeuePosition.store(position, std::memory_order_release);
+                    }
+
+                    FlushedCondition.notify_all();
+                }
+
+                return numberOfRecords;
+            }
+
+            void Consume()
+            {
+                for (;;)
+                {
+                    if (0 != Drain())
+                    {
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> lock(
+                        ConsumerMutex);
+
+                    ConsumerCondition.wait_for(
+                        lock,
+                        std::chrono::milliseconds(10));
+                }
+            }
+
+            std::vector<LogRecord> Records;
+            std::atomic<uint32_t> EnqueuePosition;
+            std::atomic<uint32_t> DequeuePosition;
+            std::atomic<uint64_t> NumberOfDroppedMessages;
+
+            std::mutex ConfigurationMutex;
+            std::map<std::string, LogLevel> ComponentLevels;
+            LogLevel DefaultLevel;
+
+            std::mutex OutputsMutex;
+            DebuggerLogOutput DefaultOutput;
+            std::vector<std::shared_ptr<ILogOutput>> Outputs;
+            bool UseDefaultOutput;
+            std::atomic<bool> DiscardMessages;
+
+            std::mutex ConsumerMutex;
+            std::condition_variable ConsumerCondition;
+            std::condition_variable FlushedCondition;
+            std::thread Consumer;
+            std::thread::id ConsumerThreadId;
+
+            const int64_t StartTicks;
+
+            // Only used by the consumer.
+            wchar_t Message[c_messageLength];
+        };
+
+        LoggerState& GetLoggerState()
+        {
+            //
+            // Intentionally leaked, so that the consumer thread is not torn down while
+            // other threads may still log during process shutdown.
+            //
+            static LoggerState* state = new LoggerState();
+
+            return *state;
+        }
+    }
+
+    std::atomic<uint32_t> Logger::s_configurationGeneration(1);
+
+    LogSite::LogSite(
+        _In_z_ const char* component,
+        _In_ LogLevel level,
+        _In_ double minimumIntervalInMilliseconds)
+        : _component(component)
+        , _level(level)
+        , _minimumIntervalInTicks(static_cast<int64_t>(minimumIntervalInMilliseconds * Timer::GetTicksPerMillisecond()))
+        , _generation(0)
+        , _enabled(false)
+        , _nextMessageTicks(0)
+        , _numberOfSuppressedMessages(0)
+    {
+    }
+
+    void LogSite::Refresh(
+        _In_ uint32_t generation) const
+    {
+        const LogLevel componentLevel =
+            Logger::GetLevel(_component);
+
+        _enabled.store(
+            LogLevel::Off != _level && static_cast<int32_t>(_level) <= static_cast<int32_t>(componentLevel),
+            std::memory_order_relaxed);
+
+        _generation.store(
+            generation,
+            std::memory_order_relaxed);
+    }
+
+    bool LogSite::TryAcquire(
+        _Out_ uint32_t& numberOfSuppressedMessages)
+    {
+        numberOfSuppressedMessages = 0;
+
+        if (_minimumIntervalInTicks <= 0)
+        {
+            return true;
+        }
+
+        const int64_t ticks =
+            Timer::GetCurrentTicks();
+
+        int64_t nextMessageTicks =
+            _nextMessageTicks.load(std::memory_order_relaxed);
+
+        if (ticks < nextMessageTicks ||
+            !_nextMessageTicks.compare_exchange_strong(
+                nextMessageTicks,
+                ticks + _minimumIntervalInTicks,
+                std::memory_order_relaxed))
+        {
+            _numberOfSuppressedMessages.fetch_add(1, std::memory_order_relaxed);
+
+            return false;
+        }
+
+        numberOfSuppressedMessages =
+            _numberOfSuppressedMessages.exchange(0, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    const char* LogSite::GetComponent() const
+    {
+        return _component;
+    }
+
+    LogLevel LogSite::GetLevel() const
+    {
+        return _level;
+    }
+
+    Logger::BenchmarkStatistics::BenchmarkStatistics()
+        : EnabledCallTimeInNanoseconds(0.0)
+        , DisabledCallTimeInNanoseconds(0.0)
+        , RateLimitedCallTimeInNanoseconds(0.0)
+        , SynchronousFormattingTimeInNanoseconds(0.0)
+        , NumberOfThreads(0)
+        , ContendedMessagesPerSecond(0.0)
+        , ContendedDroppedFraction(0.0)
+    {
+    }
+
+    void Logger::SetLevel(
+        _In_opt_z_ const char* component,
+        _In_ LogLevel level)
+    {
+        LoggerState& state =
+            GetLoggerState();
+
+        {
+            std::lock_guard<std::mutex> guard(
+                state.ConfigurationMutex);
+
+            if (nullptr == component)
+            {
+                state.DefaultLevel = level;
+            }
+            else
+            {
+                state.ComponentLevels[component] = level;
+            }
+        }
+
+        s_configurationGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LogLevel Logger::GetLevel(
+        _In_z_ const char* component)
+    {
+        LoggerState& state =
+            GetLoggerState();
+
+        std::lock_guard<std::mutex> guard(
+            state.ConfigurationMutex);
+
+        const auto componentLevel =
+            state.ComponentLevels.find(component);
+
+        return (state.ComponentLevels.end() != componentLevel) ? componentLevel->second : state.DefaultLevel;
+    }
+
+    void Logger::AddOutput(
+        _In_ const std::shared_ptr<ILogOutput>& output)
+    {
+        LoggerState& state =
+            GetLoggerState();
+
+        std::lock_guard<std::mutex> guard(
+            state.OutputsMutex);
+
+        state.Outputs.push_back(output);
+        state.UseDefaultOutput = false;
+    }
+
+    void Logger::RemoveAllOutputs()
+    {
+        LoggerState& state =
+            GetLoggerState();
+
+        std::lock_guard<std::mutex> guard(
+            state.OutputsMutex);
+
+        state.Outputs.clear();
+    }
+
+    void Logger::Flush()
+    {
+        LoggerState& state =
+            GetLoggerState();
+
+        if (std::this_thread::get_id() == state.ConsumerThreadId)
+        {
+            return;
+        }
+
+        const uint32_t position =
+            state.EnqueuePosition.load(std::memory_order_acquire);
+
+        std::unique_lock<std::mutex> lock(
+            state.ConsumerMutex);
+
+        state.ConsumerCondition.notify_one();
+
+        //
+        // Bounded, so that a stuck output cannot hang the caller (e.g. a failing ASSERT).
+        //
+        state.FlushedCondition.wait_for(
+            lock,
+            std::chrono::seconds(1),
+            [&state, position]()
+            {
+                return static_cast<int32_t>(state.DequeuePosition.load(std::memory_order_acquire) - position) >= 0;
+            });
+    }
+
+    uint64_t Logger::GetNumberOfDroppedMessages()
+    {
+        return GetLoggerState().NumberOfDroppedMessages.load(std::memory_order_relaxed);
+    }
+
+    void Logger::Benchmark(
+        _In_ uint32_t numberOfThreads,
+        _In_ uint32_t numberOfMessagesPerThread,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        static const char* c_component = "LoggerBenchmark";
+        static const uint32_t c_batchSize = c_queueCapacity / 2;
+
+        LoggerState& state =
+            GetLoggerState();
+
+        statistics = BenchmarkStatistics();
+        statistics.NumberOfThreads = numberOfThreads;
+
+        const LogLevel previousLevel =
+            GetLevel(c_component);
+
+        SetLevel(c_component, LogLevel::Information);
+
+        Flush();
+
+        state.DiscardMessages.store(true, std::memory_order_relaxed);
+
+        static LogSite enabledSite(c_component, LogLevel::Information);
+        static LogSite disabledSite(c_component, LogLevel::Verbose);
+        static LogSite rateLimitedSite(c_component, LogLevel::Information, 60.0 * 1000.0);
+
+        const wchar_t* const c_sensorName = L"VisibleLightLeftFront";
+
+        //
+        // Time the calls in batches that fit in the queue, waiting for the consumer in
+        // between, so that no message is dropped.
+        //
+        double enabledTime = 0.0;
+        uint32_t numberOfEnabledCalls = 0;
+
+        for (uint32_t batch = 0; batch < 16; ++batch)
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_batchSize; ++index)
+            {
+                if (enabledSite.IsEnabled())
+                {
+                    log(enabledSite, L"Logger::Benchmark: %s frame %i took %.3fms", c_sensorName, index, 1.5);
+                }
+            }
+
+            enabledTime +=
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+
+            numberOfEnabledCalls += c_batchSize;
+
+            Flush();
+        }
+
+        statistics.EnabledCallTimeInNanoseconds =
+            enabledTime / numberOfEnabledCalls;
+
+        const uint32_t c_numberOfCalls = 1024 * 1024;
+
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_numberOfCalls; ++index)
+            {
+                if (disabledSite.IsEnabled())
+                {
+                    log(disabledSite, L"Logger::Benchmark: %s frame %i took %.3fms", c_sensorName, index, 1.5);
+                }
+            }
+
+            statistics.DisabledCallTimeInNanoseconds =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / c_numberOfCalls;
+        }
+
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_numberOfCalls; ++index)
+            {
+                if (rateLimitedSite.IsEnabled())
+                {
+                    log(rateLimitedSite, L"Logger::Benchmark: %s frame %i took %.3fms", c_sensorName, index, 1.5);
+                }
+            }
+
+            statistics.RateLimitedCallTimeInNanoseconds =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / c_numberOfCalls;
+        }
+
+        {
+            wchar_t buffer[c_messageLength];
+
+            const uint32_t c_numberOfFormattingCalls = 64 * 1024;
+
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_numberOfFormattingCalls; ++index)
+            {
+                swprintf(buffer, _countof(buffer), L"Logger::Benchmark: %ls frame %i took %.3fms", c_sensorName, index, 1.5);
+            }
+
+            statistics.SynchronousFormattingTimeInNanoseconds =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / c_numberOfFormattingCalls;
+        }
+
+        Flush();
+
+        {
+            const uint64_t numberOfDroppedMessages =
+                GetNumberOfDroppedMessages();
+
+            std::vector<std::thread> threads;
+
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t thread = 0; thread < numberOfThreads; ++thread)
+            {
+                threads.emplace_back(
+                    [numberOfMessagesPerThread, c_sensorName]()
+                    {
+                        for (uint32_t index = 0; index < numberOfMessagesPerThread; ++index)
+                        {
+                            if (enabledSite.IsEnabled())
+                            {
+                                log(enabledSite, L"Logger::Benchmark: %s frame %i took %.3fms", c_sensorName, index, 1.5);
+                            }
+                        }
+                    });
+            }
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            const double elapsedTimeInSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            const double numberOfMessages =
+                static_cast<double>(numberOfThreads) * numberOfMessagesPerThread;
+
+            const double numberOfDroppedContendedMessages =
+                static_cast<double>(GetNumberOfDroppedMessages() - numberOfDroppedMessages);
+
+            if (numberOfMessages > 0.0)
+            {
+                statistics.ContendedMessagesPerSecond =
+                    (numberOfMessages - numberOfDroppedContendedMessages) / elapsedTimeInSeconds;
+
+                statistics.ContendedDroppedFraction =
+                    numberOfDroppedContendedMessages / numberOfMessages;
+            }
+        }
+
+        Flush();
+
+        state.DiscardMessages.store(false, std::memory_order_relaxed);
+
+        SetLevel(c_component, previousLevel);
+    }
+
+    void log(
+        _Inout_ LogSite& site,
+        _In_z_ _Printf_format_string_ const wchar_t* format,
+        ...)
+    {
+        va_list args;
+
+        va_start(args, format);
+        vlog(site, format, args);
+        va_end(args);
+    }
+
+    void vlog(
+        _Inout_ LogSite& site,
+        _In_z_ const wchar_t* format,
+        _In_ va_list args)
+    {
+        uint32_t numberOfSuppressedMessages = 0;
+
+        if (!site.TryAcquire(numberOfSuppressedMessages))
+        {
+            return;
+        }
+
+        LoggerState& state =
+            GetLoggerState();
+
+        LogRecord* record =
+            state.TryClaim();
+
+        if (nullptr == record)
+        {
+            return;
+        }
+
+        record->Site = &site;
+        record->Ticks = Timer::GetCurrentTicks();
+#if defined(_WIN32)
+        record->ThreadId = GetCurrentThreadId();
+#else
+        record->ThreadId = static_cast<uint32_t>(syscall(SYS_gettid));
+#endif /* defined(_WIN32) */
+        record->NumberOfSuppressedMessages = numberOfSuppressedMessages;
+
+        const size_t formatLength =
+            std::min<size_t>(wcslen(format), c_formatLength - 1);
+
+        wmemcpy(
+            record->Format,
+            format,
+            formatLength);
+
+        record->Format[formatLength] = L'\0';
+
+        CaptureArguments(
+            format,
+            args,
+            *record);
+
+        const uint32_t position =
+            record->Sequence.load(std::memory_order_relaxed);
+
+        record->Sequence.store(
+            position + 1,
+            std::memory_order_release);
+
+        //
+        // Errors are written right away; other messages within the consumer's polling
+        // interval.
+        //
+        if (LogLevel::Error == site.GetLevel())
+        {
+            state.ConsumerCondition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,646 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace dbg
+{
+    namespace
+    {
+        //
+        // Values below this are counted exactly, one per bucket.
+        //
+        const uint64_t c_numberOfLinearValues =
+            2 * LatencyHistogram::NumberOfSubBuckets;
+
+        //
+        // log2(LatencyHistogram::NumberOfSubBuckets).
+        //
+        const uint32_t c_subBucketBits = 4;
+
+        static_assert(
+            (1u << c_subBucketBits) == LatencyHistogram::NumberOfSubBuckets,
+            "c_subBucketBits must match NumberOfSubBuckets");
+
+        static_assert(
+            LatencyHistogram::NumberOfBuckets == LatencyHistogram::NumberOfSubBuckets * (63 - c_subBucketBits) + c_numberOfLinearValues,
+            "NumberOfBuckets must cover the 64-bit range");
+
+        uint32_t GetMostSignificantBit(
+            _In_ const uint64_t value)
+        {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+
+            //
+            // _BitScanReverse64 is not available on 32-bit targets.
+            //
+            if (0 != (value >> 32))
+            {
+                _BitScanReverse(&index, static_cast<unsigned long>(value >> 32));
+
+                return index + 32;
+            }
+
+            _BitScanReverse(&index, static_cast<unsigned long>(value));
+
+            return index;
+#else
+            return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif /* defined(_MSC_VER) */
+        }
+
+        struct MetricsState
+        {
+            std::mutex Mutex;
+
+            std::map<std::string, std::unique_ptr<MetricCounter>> Counters;
+            std::map<std::string, std::unique_ptr<MetricGauge>> Gauges;
+            std::map<std::string, std::unique_ptr<LatencyHistogram>> Histograms;
+        };
+
+        MetricsState& GetMetricsState()
+        {
+            //
+            // Intentionally leaked, so that the metrics stay valid for threads that still
+            // update them during process shutdown.
+            //
+            static MetricsState* state = new MetricsState();
+
+            return *state;
+        }
+
+        template <typename TMetric>
+        TMetric& GetOrCreateMetric(
+            _Inout_ std::map<std::string, std::unique_ptr<TMetric>>& metrics,
+            _In_ const std::string& name)
+        {
+            REQUIRES(!name.empty());
+
+            std::unique_ptr<TMetric>& metric =
+                metrics[name];
+
+            if (nullptr == metric)
+            {
+                metric.reset(
+                    new TMetric());
+            }
+
+            return *metric;
+        }
+
+        //
+        // Splits "name{labels}" into "name" and "labels".
+        //
+        void SplitMetricName(
+            _In_ const std::string& name,
+            _Out_ std::string& baseName,
+            _Out_ std::string& labels)
+        {
+            const size_t labelsBegin =
+                name.find('{');
+
+            if (std::string::npos == labelsBegin || '}' != name.back())
+            {
+                baseName = name;
+                labels.clear();
+
+                return;
+            }
+
+            baseName = name.substr(0, labelsBegin);
+            labels = name.substr(labelsBegin + 1, name.size() - labelsBegin - 2);
+        }
+
+        void AppendTypeLine(
+            _In_ const std::string& baseName,
+            _In_z_ const char* type,
+            _Inout_ std::string& lastBaseName,
+            _Inout_ std::ostringstream& stream)
+        {
+            if (baseName == lastBaseName)
+            {
+                return;
+            }
+
+            stream << "# TYPE " << baseName << " " << type << "\n";
+
+            lastBaseName = baseName;
+        }
+
+        void AppendJsonString(
+            _In_ const std::string& text,
+            _Inout_ std::ostringstream& stream)
+        {
+            stream << '"';
+
+            for (const char character : text)
+            {
+                if ('"' == character || '\\' == character)
+                {
+                    stream << '\\';
+                }
+
+                stream << character;
+            }
+
+            stream << '"';
+        }
+
+        std::string EscapeLabelValue(
+            _In_ const std::string& value)
+        {
+            std::string escapedValue;
+
+            escapedValue.reserve(
+                value.size());
+
+            for (const char character : value)
+            {
+                if ('"' == character || '\\' == character)
+                {
+                    escapedValue.push_back('\\');
+                }
+
+                escapedValue.push_back(character);
+            }
+
+            return escapedValue;
+        }
+    }
+
+    MetricCounter::MetricCounter()
+        : _value(0)
+    {
+    }
+
+    MetricGauge::MetricGauge()
+        : _value(0)
+    {
+    }
+
+    LatencyHistogram::Snapshot::Snapshot()
+        : Count(0)
+        , Sum(0)
+        , Maximum(0)
+        , Percentile50(0)
+        , Percentile90(0)
+        , Percentile99(0)
+        , Percentile999(0)
+    {
+    }
+
+    LatencyHistogram::LatencyHistogram()
+        : _count(0)
+        , _sum(0)
+        , _maximum(0)
+    {
+        for (std::atomic<uint64_t>& bucket : _buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /* static */ uint32_t LatencyHistogram::GetBucketIndex(
+        _In_ const uint64_t value)
+    {
+        if (value < c_numberOfLinearValues)
+        {
+            return static_cast<uint32_t>(value);
+        }
+
+        //
+        // Keep the five most significant bits of the value: the leading one selects
+        // the power of two, the next four the sub-bucket.
+        //
+        const uint32_t shift =
+            GetMostSignificantBit(value) - c_subBucketBits;
+
+        return NumberOfSubBuckets * shift + static_cast<uint32_t>(value >> shift);
+    }
+
+    /* static */ uint64_t LatencyHistogram::GetBucketUpperBound(
+        _In_ const uint32_t bucketIndex)
+    {
+        REQUIRES(bucketIndex < NumberOfBuckets);
+
+        if (bucketIndex < c_numberOfLinearValues)
+        {
+            return bucketIndex;
+        }
+
+        const uint32_t shift =
+            bucketIndex / NumberOfSubBuckets - 1;
+
+        const uint64_t subBucket =
+            bucketIndex - NumberOfSubBuckets * shift;
+
+        //
+        // Wraps around to the largest 64-bit value for the last bucket.
+        //
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const
+    {
+        std::array<uint64_t, NumberOfBuckets> counts;
+
+        uint64_t count = 0;
+
+        for (uint32_t index = 0; index < NumberOfBuckets; ++index)
+        {
+            counts[index] = _buckets[index].load(std::memory_order_relaxed);
+            count += counts[index];
+        }
+
+        Snapshot snapshot;
+
+        snapshot.Count = count;
+        snapshot.Sum = _sum.load(std::memory_order_relaxed);
+        snapshot.Maximum = _maximum.load(std::memory_order_relaxed);
+
+        if (0 == count)
+        {
+            return snapshot;
+        }
+
+        const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+        uint64_t* const percentiles[] = { &snapshot.Percentile50, &snapshot.Percentile90, &snapshot.Percentile99, &snapshot.Percentile999 };
+
+        uint32_t bucketIndex = 0;
+        uint64_t cumulativeCount = counts[0];
+
+        for (size_t quantileIndex = 0; quantileIndex < _countof(quantiles); ++quantileIndex)
+        {
+            const uint64_t rank =
+                std::max<uint64_t>(
+                    1,
+                    static_cast<uint64_t>(std::ceil(quantiles[quantileIndex] * count)));
+
+            while (cumulativeCount < rank && bucketIndex + 1 < NumberOfBuckets)
+            {
+                ++bucketIndex;
+                cumulativeCount += counts[bucketIndex];
+            }
+
+            //
+            // Report the top of the bucket, but never more than the largest value seen.
+            //
+            *percentiles[quantileIndex] =
+                std::min(
+                    GetBucketUpperBound(bucketIndex),
+                    snapshot.Maximum);
+        }
+
+        return snapshot;
+    }
+
+    Metrics::BenchmarkStatistics::BenchmarkStatistics()
+        : CounterIncrementTimeInNanoseconds(0.0)
+        , GaugeSetTimeInNanoseconds(0.0)
+        , HistogramRecordTimeInNanoseconds(0.0)
+        , NumberOfThreads(0)
+        , ContendedHistogramRecordTimeInNanoseconds(0.0)
+        , TextFormattingTimeInMilliseconds(0.0)
+        , JsonFormattingTimeInMilliseconds(0.0)
+    {
+    }
+
+    /* static */ MetricCounter& Metrics::GetCounter(
+        _In_ const std::string& name)
+    {
+        MetricsState& state =
+            GetMetricsState();
+
+        std::lock_guard<std::mutex> guard(state.Mutex);
+
+        return GetOrCreateMetric(
+            state.Counters,
+            name);
+    }
+
+    /* static */ MetricGauge& Metrics::GetGauge(
+        _In_ const std::string& name)
+    {
+        MetricsState& state =
+            GetMetricsState();
+
+        std::lock_guard<std::mutex> guard(state.Mutex);
+
+        return GetOrCreateMetric(
+            state.Gauges,
+            name);
+    }
+
+    /* static */ LatencyHistogram& Metrics::GetHistogram(
+        _In_ const std::string& name)
+    {
+        MetricsState& state =
+            GetMetricsState();
+
+        std::lock_guard<std::mutex> guard(state.Mutex);
+
+        return GetOrCreateMetric(
+            state.Histograms,
+            name);
+    }
+
+    /* static */ std::string Metrics::GetMetricsAsText()
+    {
+        MetricsState& state =
+            GetMetricsState();
+
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+
+        std::string baseName;
+        std::string labels;
+        std::string lastBaseName;
+
+        std::lock_guard<std::mutex> guard(state.Mutex);
+
+        for (const auto& counter : state.Counters)
+        {
+            SplitMetricName(counter.first, baseName, labels);
+            AppendTypeLine(baseName, "counter", lastBaseName, stream);
+
+            stream << counter.first << " " << counter.second->GetValue() << "\n";
+        }
+
+        for (const auto& gauge : state.Gauges)
+        {
+            SplitMetricName(gauge.first, baseName, labels);
+            AppendTypeLine(baseName, "gauge", lastBaseName, stream);
+
+            stream << gauge.first << " " << gauge.second->GetValue() << "\n";
+        }
+
+        for (const auto& histogram : state.Histograms)
+        {
+            SplitMetricName(histogram.first, baseName, labels);
+            AppendTypeLine(baseName, "summary", lastBaseName, stream);
+
+            const LatencyHistogram::Snapshot snapshot =
+                histogram.second->GetSnapshot();
+
+            const std::string labelPrefix =
+                labels.empty() ? std::string() : labels + ",";
+
+            const std::string labelSuffix =
+                labels.empty() ? std::string() : "{" + labels + "}";
+
+            stream
+                << baseName << "{" << labelPrefix << "quantile=\"0.5\"} " << snapshot.Percentile50 << "\n"
+                << baseName << "{" << labelPrefix << "quantile=\"0.9\"} " << snapshot.Percentile90 << "\n"
+                << baseName << "{" << labelPrefix << "quantile=\"0.99\"} " << snapshot.Percentile99 << "\n"
+                << baseName << "{" << labelPrefix << "quantile=\"0.999\"} " << snapshot.Percentile999 << "\n"
+                << baseName << "_sum" << labelSuffix << " " << snapshot.Sum << "\n"
+                << baseName << "_count" << labelSuffix << " " << snapshot.Count << "\n";
+        }
+
+        return stream.str();
+    }
+
+    /* static */ std::string Metrics::GetMetricsAsJson()
+    {
+        MetricsState& state =
+            GetMetricsState();
+
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+
+        std::lock_guard<std::mutex> guard(state.Mutex);
+
+        stream << "{\"counters\":{";
+
+        bool writeComma = false;
+
+        for (const auto& counter : state.Counters)
+        {
+            stream << (writeComma ? "," : "");
+            AppendJsonString(counter.first, stream);
+            stream << ":" << counter.second->GetValue();
+
+            writeComma = true;
+        }
+
+        stream << "},\"gauges\":{";
+
+        writeComma = false;
+
+        for (const auto& gauge : state.Gauges)
+        {
+            stream << (writeComma ? "," : "");
+            AppendJsonString(gauge.first, stream);
+            stream << ":" << gauge.second->GetValue();
+
+            writeComma = true;
+        }
+
+        stream << "},\"histograms\":{";
+
+        writeComma = false;
+
+        for (const auto& histogram : state.Histograms)
+        {
+            const LatencyHistogram::Snapshot snapshot =
+                histogram.second->GetSnapshot();
+
+            stream << (writeComma ? "," : "");
+            AppendJsonString(histogram.first, stream);
+
+            stream
+                << ":{\"count\":" << snapshot.Count
+                << ",\"sum\":" << snapshot.Sum
+                << ",\"max\":" << snapshot.Maximum
+                << ",\"p50\":" << snapshot.Percentile50
+                << ",\"p90\":" << snapshot.Percentile90
+                << ",\"p99\":" << snapshot.Percentile99
+                << ",\"p999\":" << snapshot.Percentile999
+                << "}";
+
+            writeComma = true;
+        }
+
+        stream << "}}";
+
+        return stream.str();
+    }
+
+    /* static */ void Metrics::Benchmark(
+        _In_ uint32_t numberOfThreads,
+        _In_ uint32_t numberOfUpdatesPerThread,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        const uint32_t c_numberOfUpdates = 1024 * 1024;
+
+        statistics = BenchmarkStatistics();
+        statistics.NumberOfThreads = numberOfThreads;
+
+        {
+            MetricCounter counter;
+
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_numberOfUpdates; ++index)
+            {
+                counter.Increment();
+            }
+
+            statistics.CounterIncrementTimeInNanoseconds =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / c_numberOfUpdates;
+        }
+
+        {
+            MetricGauge gauge;
+
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_numberOfUpdates; ++index)
+            {
+                gauge.Set(index);
+            }
+
+            statistics.GaugeSetTimeInNanoseconds =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / c_numberOfUpdates;
+        }
+
+        //
+        // Latencies between 1 and 64 milliseconds, in microseconds, spread over many
+        // buckets like a real capture-to-send latency.
+        //
+        const auto getLatency =
+            [](_In_ uint32_t index)
+            {
+                return static_cast<uint64_t>(1000 + (index * 2654435761u) % 63000);
+            };
+
+        {
+            std::unique_ptr<LatencyHistogram> histogram(
+                new LatencyHistogram());
+
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t index = 0; index < c_numberOfUpdates; ++index)
+            {
+                histogram->Record(getLatency(index));
+            }
+
+            statistics.HistogramRecordTimeInNanoseconds =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / c_numberOfUpdates;
+        }
+
+        {
+            std::unique_ptr<LatencyHistogram> histogram(
+                new LatencyHistogram());
+
+            std::vector<double> threadTimesInNanoseconds(
+                numberOfThreads,
+                0.0);
+
+            std::vector<std::thread> threads;
+
+            for (uint32_t thread = 0; thread < numberOfThreads; ++thread)
+            {
+                threads.emplace_back(
+                    [&histogram, &threadTimesInNanoseconds, &getLatency, thread, numberOfUpdatesPerThread]()
+                    {
+                        const std::chrono::steady_clock::time_point startTime =
+                            std::chrono::steady_clock::now();
+
+                        for (uint32_t index = 0; index < numberOfUpdatesPerThread; ++index)
+                        {
+                            histogram->Record(getLatency(index));
+                        }
+
+                        threadTimesInNanoseconds[thread] =
+                            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+                    });
+            }
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            if (numberOfThreads > 0 && numberOfUpdatesPerThread > 0)
+            {
+                double totalTimeInNanoseconds = 0.0;
+
+                for (const double threadTimeInNanoseconds : threadTimesInNanoseconds)
+                {
+                    totalTimeInNanoseconds += threadTimeInNanoseconds;
+                }
+
+                statistics.ContendedHistogramRecordTimeInNanoseconds =
+                    totalTimeInNanoseconds / (static_cast<double>(numberOfThreads) * numberOfUpdatesPerThread);
+            }
+        }
+
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            GetMetricsAsText();
+
+            statistics.TextFormattingTimeInMilliseconds =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            GetMetricsAsJson();
+
+            statistics.JsonFormattingTimeInMilliseconds =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        }
+    }
+
+    std::string MakeMetricName(
+        _In_z_ const char* name,
+        _In_z_ const char* labelName,
+        _In_ const std::string& labelValue)
+    {
+        std::string metricName(name);
+
+        metricName += "{";
+        metricName += labelName;
+        metricName += "=\"";
+        metricName += EscapeLabelValue(labelValue);
+        metricName += "\"}";
+
+        return metricName;
+    }
+
+    std::string MakeMetricName(
+        _In_z_ const char* name,
+        _In_z_ const char* labelName,
+        _In_z_ const wchar_t* labelValue)
+    {
+        std::string utf8LabelValue;
+
+        AppendUtf8(
+            labelValue,
+            utf8LabelValue);
+
+        return MakeMetricName(
+            name,
+            labelName,
+            utf8LabelValue);
+    }
+}
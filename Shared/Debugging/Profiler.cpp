@@ -0,0 +1,519 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace dbg
+{
+    namespace
+    {
+        struct SpanEvent
+        {
+            const char* Name;
+            int64_t BeginTicks;
+            int64_t EndTicks;
+            uint32_t Depth;
+        };
+
+        // Must be a power of two.
+        const uint32_t c_ringBufferCapacity = 16384;
+
+        //
+        // The identifier shown by debuggers and by the logger.
+        //
+        uint32_t GetCurrentOsThreadId()
+        {
+#if defined(_WIN32)
+            return GetCurrentThreadId();
+#else
+            return static_cast<uint32_t>(syscall(SYS_gettid));
+#endif /* defined(_WIN32) */
+        }
+
+        //
+        // Single producer (the owning thread), single consumer (the flusher) ring buffer.
+        //
+        struct ThreadRingBuffer
+        {
+            ThreadRingBuffer()
+                : ThreadId(GetCurrentOsThreadId())
+                , Events(c_ringBufferCapacity)
+                , Head(0)
+                , Tail(0)
+                , NumberOfRecordedSpans(0)
+                , NumberOfDroppedSpans(0)
+                , Retired(false)
+            {
+            }
+
+            const uint32_t ThreadId;
+
+            std::vector<SpanEvent> Events;
+
+            // Only written by the owning thread.
+            std::atomic<uint32_t> Head;
+
+            // Only written by the flusher.
+            std::atomic<uint32_t> Tail;
+
+            // Only written by the owning thread.
+            std::atomic<uint64_t> NumberOfRecordedSpans;
+            std::atomic<uint64_t> NumberOfDroppedSpans;
+
+            // Set when the owning thread exits.
+            std::atomic<bool> Retired;
+        };
+
+        struct ProfilerState
+        {
+            ProfilerState()
+                : NumberOfRetiredRecordedSpans(0)
+                , NumberOfRetiredDroppedSpans(0)
+                , StopRequested(false)
+                , NumberOfWrittenSpans(0)
+                , OriginTicks(0)
+            {
+            }
+
+            std::mutex BuffersMutex;
+            std::vector<std::shared_ptr<ThreadRingBuffer>> Buffers;
+            uint64_t NumberOfRetiredRecordedSpans;
+            uint64_t NumberOfRetiredDroppedSpans;
+
+            std::mutex FlusherMutex;
+            std::condition_variable FlusherCondition;
+            std::thread Flusher;
+            bool StopRequested;
+
+            std::ofstream TraceFile;
+            uint64_t NumberOfWrittenSpans;
+            int64_t OriginTicks;
+        };
+
+        ProfilerState& GetProfilerState()
+        {
+            //
+            // Intentionally leaked: a capture still running at process exit must not
+            // destroy a joinable flusher thread.
+            //
+            static ProfilerState* state = new ProfilerState();
+
+            return *state;
+        }
+
+        struct ThreadProfilerContext
+        {
+            ThreadProfilerContext()
+                : Depth(0)
+            {
+            }
+
+            ~ThreadProfilerContext()
+            {
+                if (nullptr != Buffer)
+                {
+                    Buffer->Retired.store(true, std::memory_order_release);
+                }
+            }
+
+            std::shared_ptr<ThreadRingBuffer> Buffer;
+            uint32_t Depth;
+        };
+
+        thread_local ThreadProfilerContext t_threadProfilerContext;
+
+        ThreadRingBuffer& GetThreadRingBuffer()
+        {
+            if (nullptr == t_threadProfilerContext.Buffer)
+            {
+                t_threadProfilerContext.Buffer =
+                    std::make_shared<ThreadRingBuffer>();
+
+                ProfilerState& state =
+                    GetProfilerState();
+
+                std::lock_guard<std::mutex> guard(
+                    state.BuffersMutex);
+
+                state.Buffers.push_back(
+                    t_threadProfilerContext.Buffer);
+            }
+
+            return *t_threadProfilerContext.Buffer;
+        }
+
+        //
+        // Appends the spans recorded since the last call to the trace file, and forgets the
+        // buffers of the threads that exited. Must be called with the flusher mutex held.
+        //
+        void DrainRingBuffers(
+            _Inout_ ProfilerState& state)
+        {
+            std::vector<std::shared_ptr<ThreadRingBuffer>> buffers;
+
+            {
+                std::lock_guard<std::mutex> guard(
+                    state.BuffersMutex);
+
+                buffers = state.Buffers;
+            }
+
+            const double ticksPerMicrosecond =
+                Timer::GetTicksPerMillisecond() / 1000.0;
+
+#if defined(_WIN32)
+            const uint32_t processId =
+                GetCurrentProcessId();
+#else
+            const uint32_t processId =
+                static_cast<uint32_t>(getpid());
+#endif /* defined(_WIN32) */
+
+            char event[256];
+
+            for (const std::shared_ptr<ThreadRingBuffer>& buffer : buffers)
+            {
+                //
+                // Read the retired flag first: a retired buffer that is drained below will
+                // not receive any more spans.
+                //
+                const bool retired =
+                    buffer->Retired.load(std::memory_order_acquire);
+
+                const uint32_t tail =
+                    buffer->Tail.load(std::memory_order_relaxed);
+
+                const uint32_t head =
+                    buffer->Head.load(std::memory_order_acquire);
+
+                for (uint32_t index = tail; index != head; ++index)
+                {
+                    const SpanEvent& span =
+                        buffer->Events[index & (c_ringBufferCapacity - 1)];
+
+                    if (!state.TraceFile.is_open())
+                    {
+                        continue;
+                    }
+
+                    const int length =
+                        snprintf(
+                            event,
+                            sizeof(event),
+                            "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+                            (0 == state.NumberOfWrittenSpans) ? "" : ",",
+                            span.Name,
+                            processId,
+                            buffer->ThreadId,
+                            (span.BeginTicks - state.OriginTicks) / ticksPerMicrosecond,
+                            (span.EndTicks - span.BeginTicks) / ticksPerMicrosecond,
+                            span.Depth);
+
+                    if (length > 0 && length < static_cast<int>(sizeof(event)))
+                    {
+                        state.TraceFile.write(
+                            event,
+                            length);
+
+                        ++state.NumberOfWrittenSpans;
+                    }
+                }
+
+                buffer->Tail.store(
+                    head,
+                    std::memory_order_release);
+
+                if (retired)
+                {
+                    std::lock_guard<std::mutex> guard(
+                        state.BuffersMutex);
+
+                    state.NumberOfRetiredRecordedSpans +=
+                        buffer->NumberOfRecordedSpans.load(std::memory_order_relaxed);
+
+                    state.NumberOfRetiredDroppedSpans +=
+                        buffer->NumberOfDroppedSpans.load(std::memory_order_relaxed);
+
+                    state.Buffers.erase(
+                        std::remove(
+                            state.Buffers.begin(),
+                            state.Buffers.end(),
+                            buffer),
+                        state.Buffers.end());
+                }
+            }
+
+            state.TraceFile.flush();
+        }
+    }
+
+    std::atomic<bool> Profiler::s_enabled(false);
+
+    void Profiler::StartFlushing(
+        _In_ const std::wstring& traceFilePath,
+        _In_ const uint32_t flushIntervalInMilliseconds)
+    {
+        ProfilerState& state =
+            GetProfilerState();
+
+        std::lock_guard<std::mutex> guard(
+            state.FlusherMutex);
+
+        if (state.Flusher.joinable())
+        {
+            dbg::trace(
+                L"Profiler::StartFlushing: already flushing, ignoring %s",
+                traceFilePath.c_str());
+
+            return;
+        }
+
+        //
+        // Spans recorded before the capture started are discarded.
+        //
+        DrainRingBuffers(
+            state);
+
+#if defined(_WIN32)
+        state.TraceFile.open(
+            traceFilePath.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+#else
+        std::string utf8TraceFilePath;
+
+        AppendUtf8(
+            traceFilePath.c_str(),
+            utf8TraceFilePath);
+
+        state.TraceFile.open(
+            utf8TraceFilePath.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+#endif /* defined(_WIN32) */
+
+        if (!state.TraceFile.is_open())
+        {
+            dbg::trace(
+                L"Profiler::StartFlushing: failed to open %s",
+                traceFilePath.c_str());
+
+            return;
+        }
+
+        state.TraceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        state.NumberOfWrittenSpans = 0;
+        state.OriginTicks = Timer::GetCurrentTicks();
+        state.StopRequested = false;
+
+        s_enabled.store(true, std::memory_order_relaxed);
+
+        state.Flusher = std::thread(
+            [&state, flushIntervalInMilliseconds]()
+            {
+                std::unique_lock<std::mutex> lock(
+                    state.FlusherMutex);
+
+                while (!state.FlusherCondition.wait_for(
+                    lock,
+                    std::chrono::milliseconds(flushIntervalInMilliseconds),
+                    [&state]() { return state.StopRequested; }))
+                {
+                    DrainRingBuffers(
+                        state);
+                }
+            });
+    }
+
+    void Profiler::StopFlushing()
+    {
+        ProfilerState& state =
+            GetProfilerState();
+
+        {
+            std::lock_guard<std::mutex> guard(
+                state.FlusherMutex);
+
+            if (!state.Flusher.joinable())
+            {
+                return;
+            }
+
+            s_enabled.store(false, std::memory_order_relaxed);
+
+            state.StopRequested = true;
+        }
+
+        state.FlusherCondition.notify_all();
+        state.Flusher.join();
+
+        std::lock_guard<std::mutex> guard(
+            state.FlusherMutex);
+
+        DrainRingBuffers(
+            state);
+
+        state.TraceFile << "\n]}\n";
+        state.TraceFile.close();
+
+        dbg::trace(
+            L"Profiler::StopFlushing: %llu spans written, %llu spans dropped so far",
+            state.NumberOfWrittenSpans,
+            GetNumberOfDroppedSpans());
+    }
+
+    void Profiler::RecordSpan(
+        _In_z_ const char* name,
+        _In_ const int64_t beginTicks,
+        _In_ const int64_t endTicks,
+        _In_ const uint32_t depth)
+    {
+        ThreadRingBuffer& buffer =
+            GetThreadRingBuffer();
+
+        const uint32_t head =
+            buffer.Head.load(std::memory_order_relaxed);
+
+        const uint32_t tail =
+            buffer.Tail.load(std::memory_order_acquire);
+
+        if (head - tail >= c_ringBufferCapacity)
+        {
+            buffer.NumberOfDroppedSpans.store(
+                buffer.NumberOfDroppedSpans.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+
+            return;
+        }
+
+        SpanEvent& span =
+            buffer.Events[head & (c_ringBufferCapacity - 1)];
+
+        span.Name = name;
+        span.BeginTicks = beginTicks;
+        span.EndTicks = endTicks;
+        span.Depth = depth;
+
+        buffer.Head.store(
+            head + 1,
+            std::memory_order_release);
+
+        buffer.NumberOfRecordedSpans.store(
+            buffer.NumberOfRecordedSpans.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+    }
+
+    uint32_t Profiler::EnterSpan()
+    {
+        return t_threadProfilerContext.Depth++;
+    }
+
+    void Profiler::LeaveSpan()
+    {
+        --t_threadProfilerContext.Depth;
+    }
+
+    uint64_t Profiler::GetNumberOfRecordedSpans()
+    {
+        ProfilerState& state =
+            GetProfilerState();
+
+        std::lock_guard<std::mutex> guard(
+            state.BuffersMutex);
+
+        uint64_t numberOfRecordedSpans =
+            state.NumberOfRetiredRecordedSpans;
+
+        for (const std::shared_ptr<ThreadRingBuffer>& buffer : state.Buffers)
+        {
+            numberOfRecordedSpans +=
+                buffer->NumberOfRecordedSpans.load(std::memory_order_relaxed);
+        }
+
+        return numberOfRecordedSpans;
+    }
+
+    uint64_t Profiler::GetNumberOfDroppedSpans()
+    {
+        ProfilerState& state =
+            GetProfilerState();
+
+        std::lock_guard<std::mutex> guard(
+            state.BuffersMutex);
+
+        uint64_t numberOfDroppedSpans =
+            state.NumberOfRetiredDroppedSpans;
+
+        for (const std::shared_ptr<ThreadRingBuffer>& buffer : state.Buffers)
+        {
+            numberOfDroppedSpans +=
+                buffer->NumberOfDroppedSpans.load(std::memory_order_relaxed);
+        }
+
+        return numberOfDroppedSpans;
+    }
+
+    ProfilerSpan::ProfilerSpan(
+        _In_z_ const char* name,
+        _In_ const double maximumTimeElapsedInMillisecondsAllowed)
+        : _name(name)
+        , _maximumTimeElapsedInMillisecondsAllowed(maximumTimeElapsedInMillisecondsAllowed)
+        , _beginTicks(0)
+        , _depth(0)
+        , _recording(Profiler::IsEnabled())
+    {
+        if (_recording)
+        {
+            _depth = Profiler::EnterSpan();
+        }
+
+        if (_recording || _maximumTimeElapsedInMillisecondsAllowed > 0.0)
+        {
+            _beginTicks = Timer::GetCurrentTicks();
+        }
+    }
+
+    ProfilerSpan::~ProfilerSpan()
+    {
+        if (!_recording && _maximumTimeElapsedInMillisecondsAllowed <= 0.0)
+        {
+            return;
+        }
+
+        const int64_t endTicks =
+            Timer::GetCurrentTicks();
+
+        if (_recording)
+        {
+            Profiler::LeaveSpan();
+
+            Profiler::RecordSpan(
+                _name,
+                _beginTicks,
+                endTicks,
+                _depth);
+        }
+
+        if (_maximumTimeElapsedInMillisecondsAllowed > 0.0)
+        {
+            const double millisecondsElapsed =
+                (endTicks - _beginTicks) / Timer::GetTicksPerMillisecond();
+
+            if (millisecondsElapsed >= _maximumTimeElapsedInMillisecondsAllowed)
+            {
+                dbg::trace(
+                    L"[ProfilerSpan] %S elapsed %.02fms (only reporting if over %.02fms)",
+                    _name,
+                    millisecondsElapsed,
+                    _maximumTimeElapsedInMillisecondsAllowed);
+            }
+        }
+    }
+}
@@ -15,11 +15,7 @@ namespace dbg
 {
     Timer::Timer()
     {
-        LARGE_INTEGER ticks_per_second;
-
-        QueryPerformanceFrequency(&ticks_per_second);
-
-        _ticksPerMilisecond = static_cast<double>(ticks_per_second.QuadPart) / 1000.0;
+        _ticksPerMilisecond = GetTicksPerMillisecond();
 
         Reset();
     }
@@ -33,24 +29,56 @@ namespace dbg
 
     void Timer::MarkEvent()
     {
-        QueryPerformanceCounter(&_lastEventTime);
+        _lastEventTime = GetCurrentTicks();
     }
 
     double Timer::GetMillisecondsFromStart() const
     {
+        return static_cast<double>(GetCurrentTicks() - _startTime) / _ticksPerMilisecond;
+    }
+
+    double Timer::GetMillisecondsFromLastEvent() const
+    {
+        return static_cast<double>(GetCurrentTicks() - _lastEventTime) / _ticksPerMilisecond;
+    }
+
+    int64_t Timer::GetCurrentTicks()
+    {
+#if defined(_WIN32)
         LARGE_INTEGER current_time;
 
         QueryPerformanceCounter(&current_time);
 
-        return static_cast<double>(current_time.QuadPart - _startTime.QuadPart) / _ticksPerMilisecond;
+        return current_time.QuadPart;
+#else
+        timespec current_time;
+
+        clock_gettime(CLOCK_MONOTONIC, &current_time);
+
+        return static_cast<int64_t>(current_time.tv_sec) * 1'000'000'000 + current_time.tv_nsec;
+#endif /* defined(_WIN32) */
     }
 
-    double Timer::GetMillisecondsFromLastEvent() const
+    double Timer::GetTicksPerMillisecond()
     {
-        LARGE_INTEGER current_time;
+        //
+        // The performance counter frequency is fixed at system boot.
+        //
+#if defined(_WIN32)
+        static const double ticksPerMillisecond =
+            []()
+            {
+                LARGE_INTEGER ticks_per_second;
 
-        QueryPerformanceCounter(&current_time);
+                QueryPerformanceFrequency(&ticks_per_second);
+
+                return static_cast<double>(ticks_per_second.QuadPart) / 1000.0;
+            }();
+#else
+        // CLOCK_MONOTONIC ticks are nanoseconds.
+        static const double ticksPerMillisecond = 1'000'000.0;
+#endif /* defined(_WIN32) */
 
-        return static_cast<double>(current_time.QuadPart - _lastEventTime.QuadPart) / _ticksPerMilisecond;
+        return ticksPerMillisecond;
     }
 }
@@ -11,8 +11,6 @@
 
 #include "pch.h"
 
-#define TRACE_BUFFER_SIZE 512
-
 namespace dbg
 {
     void trace(
@@ -20,19 +18,20 @@ namespace dbg
         ...)
     {
         //
-        // Keep two extra characters for the line terminator
-        // and the null terminator.
+        // Messages are formatted and sent to the debugger by the logger thread (see
+        // dbg::Logger), so that tracing does not stall the calling thread.
         //
-        wchar_t buffer[TRACE_BUFFER_SIZE + 2] = {};
+        static LogSite traceSite("Trace", LogLevel::Information);
+
+        if (!traceSite.IsEnabled())
+        {
+            return;
+        }
+
         va_list args;
 
         va_start(args, msg);
-        _vsnwprintf_s(buffer, _countof(buffer) - 2, _TRUNCATE, msg, args);
+        vlog(traceSite, msg, args);
         va_end(args);
-
-        buffer[wcslen(buffer) + 1] = L'\0';
-        buffer[wcslen(buffer)] = L'\n';
-
-        OutputDebugString(buffer);
     }
 }
@@ -0,0 +1,58 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace dbg
+{
+    void AppendUtf8(
+        _In_z_ const wchar_t* text,
+        _Inout_ std::string& utf8)
+    {
+        for (const wchar_t* position = text; L'\0' != *position; ++position)
+        {
+            uint32_t codePoint = static_cast<uint32_t>(*position);
+
+            //
+            // Combine UTF-16 surrogate pairs; wchar_t holds UTF-16 code units on Windows.
+            //
+            if (codePoint >= 0xd800 && codePoint < 0xdc00 &&
+                position[1] >= 0xdc00 && position[1] < 0xe000)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (static_cast<uint32_t>(position[1]) - 0xdc00);
+                ++position;
+            }
+
+            if (codePoint < 0x80)
+            {
+                utf8.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                utf8.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+                utf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                utf8.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+                utf8.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                utf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            else
+            {
+                utf8.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+                utf8.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+                utf8.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                utf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+        }
+    }
+}
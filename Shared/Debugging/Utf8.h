@@ -0,0 +1,22 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace dbg
+{
+    //
+    // Appends the UTF-8 encoding of a wide string (UTF-16 on Windows, UTF-32 elsewhere).
+    //
+    void AppendUtf8(
+        _In_z_ const wchar_t* text,
+        _Inout_ std::string& utf8);
+}
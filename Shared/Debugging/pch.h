@@ -11,11 +11,28 @@
 
 #pragma once
 
+#if defined(_WIN32)
 #include "targetver.h"
+#endif /* defined(_WIN32) */
 
 #include <string>
 #include <stdexcept>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <array>
+#include <sstream>
+#include <cmath>
+#include <cwctype>
 
+#if defined(_WIN32)
 #if !defined(WIN32_LEAN_AND_MEAN)
 #define WIN32_LEAN_AND_MEAN
 #endif /* !defined(WIN32_LEAN_AND_MEAN) */
@@ -25,5 +42,21 @@
 #endif /* !defined(NOMINMAX) */
 
 #include <Windows.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cstring>
+#include <cwchar>
+#include <ctime>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+#endif /* defined(_WIN32) */
 
 #include <Debugging/All.h>
+
+#include "Utf8.h"
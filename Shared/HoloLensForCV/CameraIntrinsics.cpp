@@ -62,4 +62,45 @@ namespace HoloLensForCV
 
         return true;
     }
+
+    bool CameraIntrinsics::ComputeUnitPlaneMap(
+        _Out_ cv::Mat& unitPlaneMap)
+    {
+        const CameraProjectionModel::ImagePointMapper mapper =
+            [this](float u, float v, float* x, float* y)
+        {
+            Windows::Foundation::Point uv = { u, v }, xy;
+
+            if (!MapImagePointToCameraUnitPlane(uv, &xy))
+            {
+                return false;
+            }
+
+            *x = xy.X;
+            *y = xy.Y;
+
+            return true;
+        };
+
+        //
+        // The model is used even if it is not within tolerance: the residual error is a
+        // small fraction of a pixel.
+        //
+        CameraProjectionModel cameraProjectionModel;
+
+        cameraProjectionModel.Fit(
+            ImageWidth,
+            ImageHeight,
+            mapper);
+
+        if (!cameraProjectionModel.IsValid())
+        {
+            return false;
+        }
+
+        cameraProjectionModel.ComputeUnitPlaneMap(
+            unitPlaneMap);
+
+        return true;
+    }
 }
@@ -51,6 +51,15 @@ namespace HoloLensForCV
 
         property unsigned int ImageHeight;
 
+    internal:
+        /// <summary>
+        /// Fits a CameraProjectionModel to the image-to-unit-plane mapping and evaluates
+        /// it for every pixel: the result is a CV_32FC2 image holding the (x, y) unit
+        /// plane coordinates of each pixel, +infinity for pixels without a valid mapping.
+        /// </summary>
+        bool ComputeUnitPlaneMap(
+            _Out_ cv::Mat& unitPlaneMap);
+
     private:
         Microsoft::WRL::ComPtr<SensorStreaming::ICameraIntrinsics> _sensorStreamingCameraIntrinsics;
     };
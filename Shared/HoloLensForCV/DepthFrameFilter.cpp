@@ -0,0 +1,606 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Spatial weights of the bilateral filter: exp(-d^2 / 2) for the distance d to the
+        // center pixel.
+        //
+        const float c_orthogonalWeight = 0.60653066f;
+        const float c_diagonalWeight = 0.36787944f;
+
+        typedef std::chrono::steady_clock Clock;
+
+        double GetMillisecondsSince(
+            _In_ const Clock::time_point& startTime)
+        {
+            return std::chrono::duration<double, std::milli>(
+                Clock::now() - startTime).count();
+        }
+
+        //
+        // Range weight of a neighbor: decreases linearly from 1 (same depth) to 0 (depth
+        // difference equal to the tolerance).
+        //
+        float GetRangeWeight(
+            _In_ float center,
+            _In_ float neighbor,
+            _In_ float inverseTolerance)
+        {
+            if (0.0f == neighbor)
+            {
+                return 0.0f;
+            }
+
+            return std::max(
+                0.0f,
+                1.0f - std::abs(neighbor - center) * inverseTolerance);
+        }
+
+#if CV_SIMD128
+        cv::v_float32x4 LoadAsFloat(
+            _In_ const uint16_t* values)
+        {
+            return cv::v_cvt_f32(
+                cv::v_reinterpret_as_s32(
+                    cv::v_load_expand(values)));
+        }
+
+        void AccumulateNeighbor(
+            _In_ const cv::v_float32x4& center,
+            _In_ const cv::v_float32x4& neighbor,
+            _In_ const cv::v_float32x4& inverseTolerance,
+            _In_ const cv::v_float32x4& spatialWeight,
+            _Inout_ cv::v_float32x4& weightedSum,
+            _Inout_ cv::v_float32x4& sumOfWeights)
+        {
+            const cv::v_float32x4 zero = cv::v_setzero_f32();
+            const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+
+            cv::v_float32x4 weight =
+                cv::v_max(
+                    zero,
+                    one - cv::v_abs(neighbor - center) * inverseTolerance);
+
+            weight =
+                cv::v_select(
+                    neighbor == zero,
+                    zero,
+                    weight * spatialWeight);
+
+            weightedSum = cv::v_muladd(weight, neighbor, weightedSum);
+            sumOfWeights += weight;
+        }
+
+        //
+        // Bilateral filter of four pixels, starting at column x.
+        //
+        cv::v_int32x4 FilterFourPixels(
+            _In_ const uint16_t* previous,
+            _In_ const uint16_t* current,
+            _In_ const uint16_t* next,
+            _In_ int32_t x,
+            _In_ float rangeThreshold)
+        {
+            const cv::v_float32x4 zero = cv::v_setzero_f32();
+            const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+            const cv::v_float32x4 orthogonalWeight = cv::v_setall_f32(c_orthogonalWeight);
+            const cv::v_float32x4 diagonalWeight = cv::v_setall_f32(c_diagonalWeight);
+
+            const cv::v_float32x4 center = LoadAsFloat(current + x);
+
+            const cv::v_float32x4 inverseTolerance =
+                one / (cv::v_max(center, one) * cv::v_setall_f32(rangeThreshold));
+
+            cv::v_float32x4 weightedSum = center;
+            cv::v_float32x4 sumOfWeights = one;
+
+            AccumulateNeighbor(center, LoadAsFloat(current + x - 1), inverseTolerance, orthogonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(current + x + 1), inverseTolerance, orthogonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(previous + x), inverseTolerance, orthogonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(next + x), inverseTolerance, orthogonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(previous + x - 1), inverseTolerance, diagonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(previous + x + 1), inverseTolerance, diagonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(next + x - 1), inverseTolerance, diagonalWeight, weightedSum, sumOfWeights);
+            AccumulateNeighbor(center, LoadAsFloat(next + x + 1), inverseTolerance, diagonalWeight, weightedSum, sumOfWeights);
+
+            //
+            // Invalid pixels stay invalid.
+            //
+            const cv::v_float32x4 filtered =
+                cv::v_select(
+                    center == zero,
+                    zero,
+                    weightedSum / sumOfWeights);
+
+            return cv::v_round(filtered);
+        }
+#endif /* CV_SIMD128 */
+    }
+
+    DepthFrameFilter::Options::Options()
+        : EnableRangeGating(true)
+        , MinimumDepth(20)
+        , MaximumDepth(3000)
+        , EnableFlyingPixelRemoval(true)
+        , FlyingPixelThreshold(0.05f)
+        , EnableSpatialFilter(true)
+        , SpatialFilterRangeThreshold(0.03f)
+        , EnableTemporalFilter(true)
+        , TemporalFilterAlpha(0.4f)
+        , TemporalFilterResetThreshold(0.05f)
+    {
+    }
+
+    DepthFrameFilter::StageTimings::StageTimings()
+        : NumberOfFrames(0)
+        , RangeGatingInMilliseconds(0.0)
+        , FlyingPixelRemovalInMilliseconds(0.0)
+        , SpatialFilterInMilliseconds(0.0)
+        , TemporalFilterInMilliseconds(0.0)
+        , TotalInMilliseconds(0.0)
+    {
+    }
+
+    /* static */ DepthFrameFilter::Options DepthFrameFilter::GetDefaultOptions(
+        _In_ const std::string& sensorName)
+    {
+        Options options;
+
+        if (std::string::npos != sensorName.find("long"))
+        {
+            options.MinimumDepth = 1000;
+            options.MaximumDepth = 4000;
+        }
+
+        return options;
+    }
+
+    DepthFrameFilter::DepthFrameFilter(
+        _In_ const Options& options)
+        : _options(options)
+    {
+    }
+
+    const DepthFrameFilter::Options& DepthFrameFilter::GetOptions() const
+    {
+        return _options;
+    }
+
+    void DepthFrameFilter::SetOptions(
+        _In_ const Options& options)
+    {
+        _options = options;
+    }
+
+    void DepthFrameFilter::Apply(
+        _Inout_ cv::Mat& depth)
+    {
+        REQUIRES(CV_16UC1 == depth.type());
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        Clock::time_point stageStartTime =
+            startTime;
+
+        if (_options.EnableRangeGating)
+        {
+            ApplyRangeGating(
+                depth);
+
+            _timings.RangeGatingInMilliseconds +=
+                GetMillisecondsSince(stageStartTime);
+
+            stageStartTime = Clock::now();
+        }
+
+        if (_options.EnableFlyingPixelRemoval)
+        {
+            ApplyFlyingPixelRemoval(
+                depth);
+
+            _timings.FlyingPixelRemovalInMilliseconds +=
+                GetMillisecondsSince(stageStartTime);
+
+            stageStartTime = Clock::now();
+        }
+
+        if (_options.EnableSpatialFilter)
+        {
+            ApplySpatialFilter(
+                depth);
+
+            _timings.SpatialFilterInMilliseconds +=
+                GetMillisecondsSince(stageStartTime);
+
+            stageStartTime = Clock::now();
+        }
+
+        if (_options.EnableTemporalFilter)
+        {
+            ApplyTemporalFilter(
+                depth);
+
+            _timings.TemporalFilterInMilliseconds +=
+                GetMillisecondsSince(stageStartTime);
+        }
+        else
+        {
+            ResetTemporalState();
+        }
+
+        _timings.TotalInMilliseconds +=
+            GetMillisecondsSince(startTime);
+
+        ++_timings.NumberOfFrames;
+    }
+
+    void DepthFrameFilter::ResetTemporalState()
+    {
+        _temporalState.release();
+    }
+
+    const DepthFrameFilter::StageTimings& DepthFrameFilter::GetTimings() const
+    {
+        return _timings;
+    }
+
+    void DepthFrameFilter::ResetTimings()
+    {
+        _timings = StageTimings();
+    }
+
+    std::string DepthFrameFilter::GetTimingsAsJson() const
+    {
+        const double scale =
+            (_timings.NumberOfFrames > 0) ? 1.0 / _timings.NumberOfFrames : 0.0;
+
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        stream
+            << "{\"frames\":" << _timings.NumberOfFrames
+            << ",\"range_gating_ms\":" << _timings.RangeGatingInMilliseconds * scale
+            << ",\"flying_pixel_removal_ms\":" << _timings.FlyingPixelRemovalInMilliseconds * scale
+            << ",\"spatial_filter_ms\":" << _timings.SpatialFilterInMilliseconds * scale
+            << ",\"temporal_filter_ms\":" << _timings.TemporalFilterInMilliseconds * scale
+            << ",\"total_ms\":" << _timings.TotalInMilliseconds * scale
+            << "}";
+
+        return stream.str();
+    }
+
+    void DepthFrameFilter::ApplyRangeGating(
+        _Inout_ cv::Mat& depth) const
+    {
+        const uint16_t minimumDepth = _options.MinimumDepth;
+        const uint16_t maximumDepth = _options.MaximumDepth;
+
+        for (int32_t v = 0; v < depth.rows; ++v)
+        {
+            uint16_t* row = depth.ptr<uint16_t>(v);
+
+            int32_t x = 0;
+
+#if CV_SIMD128
+            const cv::v_uint16x8 minimum = cv::v_setall_u16(minimumDepth);
+            const cv::v_uint16x8 maximum = cv::v_setall_u16(maximumDepth);
+
+            for (; x + 8 <= depth.cols; x += 8)
+            {
+                const cv::v_uint16x8 d = cv::v_load(row + x);
+
+                cv::v_store(
+                    row + x,
+                    d & ((d >= minimum) & (d <= maximum)));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; x < depth.cols; ++x)
+            {
+                if (row[x] < minimumDepth || row[x] > maximumDepth)
+                {
+                    row[x] = 0;
+                }
+            }
+        }
+    }
+
+    void DepthFrameFilter::ApplyFlyingPixelRemoval(
+        _Inout_ cv::Mat& depth)
+    {
+        if (depth.rows < 3 || depth.cols < 3)
+        {
+            return;
+        }
+
+        const int32_t width = depth.cols;
+
+        //
+        // The threshold is computed in 16.16 fixed point.
+        //
+        const uint16_t thresholdFactor =
+            cv::saturate_cast<uint16_t>(
+                _options.FlyingPixelThreshold * 65536.0f);
+
+        _previousRow.assign(
+            depth.ptr<uint16_t>(0),
+            depth.ptr<uint16_t>(0) + width);
+
+        _currentRow.resize(width);
+
+        for (int32_t v = 1; v < depth.rows - 1; ++v)
+        {
+            uint16_t* row = depth.ptr<uint16_t>(v);
+
+            std::copy(
+                row,
+                row + width,
+                _currentRow.begin());
+
+            const uint16_t* previous = _previousRow.data();
+            const uint16_t* current = _currentRow.data();
+            const uint16_t* next = depth.ptr<uint16_t>(v + 1);
+
+            int32_t x = 1;
+
+#if CV_SIMD128
+            const cv::v_uint16x8 factor = cv::v_setall_u16(thresholdFactor);
+
+            for (; x + 9 <= width; x += 8)
+            {
+                const cv::v_uint16x8 c = cv::v_load(current + x);
+
+                cv::v_uint32x4 thresholdLow, thresholdHigh;
+
+                cv::v_mul_expand(
+                    c,
+                    factor,
+                    thresholdLow,
+                    thresholdHigh);
+
+                const cv::v_uint16x8 threshold =
+                    cv::v_pack(
+                        thresholdLow >> 16,
+                        thresholdHigh >> 16);
+
+                const cv::v_uint16x8 horizontal =
+                    (cv::v_absdiff(c, cv::v_load(current + x - 1)) > threshold) &
+                    (cv::v_absdiff(c, cv::v_load(current + x + 1)) > threshold);
+
+                const cv::v_uint16x8 vertical =
+                    (cv::v_absdiff(c, cv::v_load(previous + x)) > threshold) &
+                    (cv::v_absdiff(c, cv::v_load(next + x)) > threshold);
+
+                cv::v_store(
+                    row + x,
+                    cv::v_select(
+                        horizontal | vertical,
+                        cv::v_setzero_u16(),
+                        c));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; x < width - 1; ++x)
+            {
+                const int32_t c = current[x];
+
+                const int32_t threshold =
+                    (c * thresholdFactor) >> 16;
+
+                const bool horizontal =
+                    std::abs(c - current[x - 1]) > threshold &&
+                    std::abs(c - current[x + 1]) > threshold;
+
+                const bool vertical =
+                    std::abs(c - previous[x]) > threshold &&
+                    std::abs(c - next[x]) > threshold;
+
+                if (horizontal || vertical)
+                {
+                    row[x] = 0;
+                }
+            }
+
+            std::swap(
+                _previousRow,
+                _currentRow);
+        }
+    }
+
+    void DepthFrameFilter::ApplySpatialFilter(
+        _Inout_ cv::Mat& depth)
+    {
+        if (depth.rows < 3 || depth.cols < 3)
+        {
+            return;
+        }
+
+        const int32_t width = depth.cols;
+        const float rangeThreshold = _options.SpatialFilterRangeThreshold;
+
+        _previousRow.assign(
+            depth.ptr<uint16_t>(0),
+            depth.ptr<uint16_t>(0) + width);
+
+        _currentRow.resize(width);
+
+        for (int32_t v = 1; v < depth.rows - 1; ++v)
+        {
+            uint16_t* row = depth.ptr<uint16_t>(v);
+
+            std::copy(
+                row,
+                row + width,
+                _currentRow.begin());
+
+            const uint16_t* previous = _previousRow.data();
+            const uint16_t* current = _currentRow.data();
+            const uint16_t* next = depth.ptr<uint16_t>(v + 1);
+
+            int32_t x = 1;
+
+#if CV_SIMD128
+            for (; x + 9 <= width; x += 8)
+            {
+                cv::v_store(
+                    row + x,
+                    cv::v_pack_u(
+                        FilterFourPixels(previous, current, next, x, rangeThreshold),
+                        FilterFourPixels(previous, current, next, x + 4, rangeThreshold)));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; x < width - 1; ++x)
+            {
+                const float center = current[x];
+
+                if (0.0f == center)
+                {
+                    continue;
+                }
+
+                const float inverseTolerance =
+                    1.0f / (center * rangeThreshold);
+
+                float weightedSum = center;
+                float sumOfWeights = 1.0f;
+
+                const uint16_t neighbors[8] =
+                {
+                    current[x - 1], current[x + 1], previous[x], next[x],
+                    previous[x - 1], previous[x + 1], next[x - 1], next[x + 1]
+                };
+
+                for (int32_t i = 0; i < 8; ++i)
+                {
+                    const float neighbor = neighbors[i];
+
+                    const float weight =
+                        GetRangeWeight(center, neighbor, inverseTolerance) *
+                        (i < 4 ? c_orthogonalWeight : c_diagonalWeight);
+
+                    weightedSum += weight * neighbor;
+                    sumOfWeights += weight;
+                }
+
+                row[x] = cv::saturate_cast<uint16_t>(
+                    weightedSum / sumOfWeights);
+            }
+
+            std::swap(
+                _previousRow,
+                _currentRow);
+        }
+    }
+
+    void DepthFrameFilter::ApplyTemporalFilter(
+        _Inout_ cv::Mat& depth)
+    {
+        if (_temporalState.size() != depth.size())
+        {
+            _temporalState = cv::Mat::zeros(depth.size(), CV_32F);
+        }
+
+        const float alpha = _options.TemporalFilterAlpha;
+        const float resetThreshold = _options.TemporalFilterResetThreshold;
+
+        for (int32_t v = 0; v < depth.rows; ++v)
+        {
+            uint16_t* row = depth.ptr<uint16_t>(v);
+            float* state = _temporalState.ptr<float>(v);
+
+            int32_t x = 0;
+
+#if CV_SIMD128
+            const cv::v_float32x4 zero = cv::v_setzero_f32();
+            const cv::v_float32x4 alphas = cv::v_setall_f32(alpha);
+            const cv::v_float32x4 resetThresholds = cv::v_setall_f32(resetThreshold);
+
+            for (; x + 8 <= depth.cols; x += 8)
+            {
+                cv::v_int32x4 filtered[2];
+
+                for (int32_t half = 0; half < 2; ++half)
+                {
+                    const int32_t i = x + 4 * half;
+
+                    const cv::v_float32x4 d = LoadAsFloat(row + i);
+                    const cv::v_float32x4 s = cv::v_load(state + i);
+                    const cv::v_float32x4 difference = d - s;
+
+                    const cv::v_float32x4 reset =
+                        (s == zero) |
+                        (cv::v_abs(difference) > d * resetThresholds);
+
+                    cv::v_float32x4 updated =
+                        cv::v_select(
+                            reset,
+                            d,
+                            cv::v_muladd(alphas, difference, s));
+
+                    //
+                    // Invalid pixels keep their state, so that a dropout does not
+                    // restart the average.
+                    //
+                    const cv::v_float32x4 invalid = (d == zero);
+
+                    cv::v_store(
+                        state + i,
+                        cv::v_select(invalid, s, updated));
+
+                    filtered[half] =
+                        cv::v_round(
+                            cv::v_select(invalid, zero, updated));
+                }
+
+                cv::v_store(
+                    row + x,
+                    cv::v_pack_u(
+                        filtered[0],
+                        filtered[1]));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; x < depth.cols; ++x)
+            {
+                const float d = row[x];
+
+                if (0.0f == d)
+                {
+                    continue;
+                }
+
+                const float difference = d - state[x];
+
+                if (0.0f == state[x] || std::abs(difference) > d * resetThreshold)
+                {
+                    state[x] = d;
+                }
+                else
+                {
+                    state[x] += alpha * difference;
+                }
+
+                row[x] = cv::saturate_cast<uint16_t>(
+                    state[x]);
+            }
+        }
+    }
+}
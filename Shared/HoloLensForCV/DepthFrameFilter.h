@@ -0,0 +1,141 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Cleans up depth frames (Gray16) in place, in up to four stages:
+    //
+    //  - range gating: depth values outside of the valid range are cleared;
+    //
+    //  - flying pixel removal: pixels that differ from both of their horizontal or both
+    //    of their vertical neighbors by more than a fraction of their depth are cleared.
+    //    These are the mixed pixels found along depth discontinuities;
+    //
+    //  - spatial filtering: a 3x3 bilateral filter, whose range weights decrease linearly
+    //    with the depth difference so that discontinuities are preserved;
+    //
+    //  - temporal filtering: a per-pixel exponential moving average, reset wherever the
+    //    depth changes by more than a fraction of its value, so that motion does not
+    //    leave trails.
+    //
+    // Cleared pixels are set to zero, the value used by the sensors for invalid pixels.
+    // All the stages are vectorized and run on the calling thread. The time spent in each
+    // stage is accumulated.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class DepthFrameFilter
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Valid depth range, in the units of the depth frames (millimeters).
+            bool EnableRangeGating;
+            uint16_t MinimumDepth;
+            uint16_t MaximumDepth;
+
+            // Depth differences above this fraction of the pixel's depth are treated as
+            // discontinuities.
+            bool EnableFlyingPixelRemoval;
+            float FlyingPixelThreshold;
+
+            // Neighbors whose depth differs by more than this fraction of the pixel's
+            // depth do not contribute to the spatial filter.
+            bool EnableSpatialFilter;
+            float SpatialFilterRangeThreshold;
+
+            // Weight of the new frame in the moving average, and depth change (as a
+            // fraction of the depth) above which the average is reset.
+            bool EnableTemporalFilter;
+            float TemporalFilterAlpha;
+            float TemporalFilterResetThreshold;
+        };
+
+        struct StageTimings
+        {
+            StageTimings();
+
+            uint64_t NumberOfFrames;
+
+            double RangeGatingInMilliseconds;
+            double FlyingPixelRemovalInMilliseconds;
+            double SpatialFilterInMilliseconds;
+            double TemporalFilterInMilliseconds;
+            double TotalInMilliseconds;
+        };
+
+        //
+        // Returns the approximate valid ranges for 'short_throw_depth' (20mm to 3000mm)
+        // and 'long_throw_depth' (1000mm to 4000mm).
+        //
+        static Options GetDefaultOptions(
+            _In_ const std::string& sensorName);
+
+        explicit DepthFrameFilter(
+            _In_ const Options& options = Options());
+
+        const Options& GetOptions() const;
+
+        void SetOptions(
+            _In_ const Options& options);
+
+        //
+        // Filters a CV_16UC1 depth frame in place.
+        //
+        void Apply(
+            _Inout_ cv::Mat& depth);
+
+        //
+        // Forgets the previous frames, e.g. after a gap in the stream.
+        //
+        void ResetTemporalState();
+
+        const StageTimings& GetTimings() const;
+
+        void ResetTimings();
+
+        //
+        // Serializes the average per-frame timings as JSON.
+        //
+        std::string GetTimingsAsJson() const;
+
+    private:
+        void ApplyRangeGating(
+            _Inout_ cv::Mat& depth) const;
+
+        void ApplyFlyingPixelRemoval(
+            _Inout_ cv::Mat& depth);
+
+        void ApplySpatialFilter(
+            _Inout_ cv::Mat& depth);
+
+        void ApplyTemporalFilter(
+            _Inout_ cv::Mat& depth);
+
+    private:
+        Options _options;
+
+        // Unmodified copies of the previous and current rows, which the in-place 3x3
+        // stages need.
+        std::vector<uint16_t> _previousRow;
+        std::vector<uint16_t> _currentRow;
+
+        // Moving average of each pixel (CV_32F), zero where unknown.
+        cv::Mat _temporalState;
+
+        StageTimings _timings;
+    };
+}
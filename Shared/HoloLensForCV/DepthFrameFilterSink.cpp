@@ -0,0 +1,161 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        DepthFrameFilter::Options GetDefaultFilterOptions(
+            _In_ SensorType sensorType)
+        {
+            const std::wstring sensorName =
+                GetSensorTypeName(sensorType);
+
+            return DepthFrameFilter::GetDefaultOptions(
+                std::string(sensorName.begin(), sensorName.end()));
+        }
+    }
+
+    DepthFrameFilterSink::DepthFrameFilterSink(
+        _In_ SensorType sensorType,
+        _In_ ISensorFrameSink^ downstreamSink)
+        : _sensorType(sensorType)
+        , _downstreamSink(downstreamSink)
+        , _filter(GetDefaultFilterOptions(sensorType))
+    {
+        REQUIRES(nullptr != downstreamSink);
+
+        const DepthFrameFilter::Options& options =
+            _filter.GetOptions();
+
+        RangeGating = options.EnableRangeGating;
+        FlyingPixelRemoval = options.EnableFlyingPixelRemoval;
+        SpatialFilter = options.EnableSpatialFilter;
+        TemporalFilter = options.EnableTemporalFilter;
+    }
+
+    DepthFrameFilterSink::~DepthFrameFilterSink()
+    {
+    }
+
+    void DepthFrameFilterSink::Send(
+        _In_ SensorFrame^ sensorFrame)
+    {
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            sensorFrame->SoftwareBitmap;
+
+        if (nullptr == softwareBitmap ||
+            Windows::Graphics::Imaging::BitmapPixelFormat::Gray16 != softwareBitmap->BitmapPixelFormat)
+        {
+            _downstreamSink->Send(
+                sensorFrame);
+
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(_filterMutex);
+
+            //
+            // The same frame may be delivered more than once; filter it only once.
+            //
+            if (!_prevFrameTimestamp.Equals(sensorFrame->Timestamp))
+            {
+                _prevFrameTimestamp = sensorFrame->Timestamp;
+
+                DepthFrameFilter::Options options =
+                    _filter.GetOptions();
+
+                options.EnableRangeGating = RangeGating;
+                options.EnableFlyingPixelRemoval = FlyingPixelRemoval;
+                options.EnableSpatialFilter = SpatialFilter;
+                options.EnableTemporalFilter = TemporalFilter;
+
+                _filter.SetOptions(
+                    options);
+
+                //
+                // Bitmaps that are backed by the media frame reader's buffers may be
+                // read-only, in which case the frame gets a filtered copy.
+                //
+                if (softwareBitmap->IsReadOnly)
+                {
+                    softwareBitmap =
+                        Windows::Graphics::Imaging::SoftwareBitmap::Copy(
+                            softwareBitmap);
+
+                    sensorFrame->SoftwareBitmap =
+                        softwareBitmap;
+                }
+
+                Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+                    softwareBitmap->LockBuffer(
+                        Windows::Graphics::Imaging::BitmapBufferAccessMode::ReadWrite);
+
+                const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+                    bitmapBuffer->GetPlaneDescription(0);
+
+                Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+                    bitmapBuffer->CreateReference();
+
+                uint32_t pixelBufferDataLength = 0;
+
+                uint8_t* pixelBufferData =
+                    Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                        bitmapBufferReference,
+                        pixelBufferDataLength);
+
+                cv::Mat depth(
+                    softwareBitmap->PixelHeight,
+                    softwareBitmap->PixelWidth,
+                    CV_16UC1,
+                    pixelBufferData + bitmapPlaneDescription.StartIndex,
+                    bitmapPlaneDescription.Stride);
+
+                _filter.Apply(
+                    depth);
+
+                delete bitmapBufferReference;
+                delete bitmapBuffer;
+            }
+        }
+
+        _downstreamSink->Send(
+            sensorFrame);
+    }
+
+    Platform::String^ DepthFrameFilterSink::GetStageTimingsAsJson()
+    {
+        std::string json;
+
+        {
+            std::lock_guard<std::mutex> guard(_filterMutex);
+
+            json = _filter.GetTimingsAsJson();
+        }
+
+        const std::wstring wideJson(
+            json.begin(),
+            json.end());
+
+        return ref new Platform::String(
+            wideJson.c_str());
+    }
+
+    void DepthFrameFilterSink::ResetStageTimings()
+    {
+        std::lock_guard<std::mutex> guard(_filterMutex);
+
+        _filter.ResetTimings();
+    }
+}
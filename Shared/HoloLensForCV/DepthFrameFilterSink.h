@@ -0,0 +1,60 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Filters depth frames in place (see DepthFrameFilter) before passing them on to
+    // another sink, e.g. a recorder or a streamer sink. Frames of other formats are
+    // passed on unmodified.
+    //
+    // The stages can be switched on and off while streaming.
+    //
+    public ref class DepthFrameFilterSink sealed
+        : public ISensorFrameSink
+    {
+    public:
+        DepthFrameFilterSink(
+            _In_ SensorType sensorType,
+            _In_ ISensorFrameSink^ downstreamSink);
+
+        property bool RangeGating;
+        property bool FlyingPixelRemoval;
+        property bool SpatialFilter;
+        property bool TemporalFilter;
+
+        virtual void Send(
+            _In_ SensorFrame^ sensorFrame);
+
+        //
+        // Returns the average per-frame time spent in each stage, as JSON.
+        //
+        Platform::String^ GetStageTimingsAsJson();
+
+        void ResetStageTimings();
+
+    private:
+        ~DepthFrameFilterSink();
+
+    private:
+        SensorType _sensorType;
+
+        ISensorFrameSink^ _downstreamSink;
+
+        std::mutex _filterMutex;
+
+        DepthFrameFilter _filter;
+
+        Windows::Foundation::DateTime _prevFrameTimestamp;
+    };
+}
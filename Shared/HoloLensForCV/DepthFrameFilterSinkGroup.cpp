@@ -0,0 +1,64 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    DepthFrameFilterSinkGroup::DepthFrameFilterSinkGroup(
+        _In_ ISensorFrameSinkGroup^ downstreamSinkGroup)
+        : _downstreamSinkGroup(downstreamSinkGroup)
+    {
+        REQUIRES(nullptr != downstreamSinkGroup);
+    }
+
+    DepthFrameFilterSinkGroup::~DepthFrameFilterSinkGroup()
+    {
+    }
+
+    ISensorFrameSink^ DepthFrameFilterSinkGroup::GetSensorFrameSink(
+        _In_ SensorType sensorType)
+    {
+        ISensorFrameSink^ downstreamSink =
+            _downstreamSinkGroup->GetSensorFrameSink(
+                sensorType);
+
+        if (nullptr == downstreamSink ||
+            (SensorType::ShortThrowToFDepth != sensorType &&
+             SensorType::LongThrowToFDepth != sensorType))
+        {
+            return downstreamSink;
+        }
+
+        std::lock_guard<std::mutex> guard(_sinkGroupMutex);
+
+        const int32_t sensorTypeAsIndex =
+            static_cast<int32_t>(sensorType);
+
+        if (nullptr == _sensorFrameSinks[sensorTypeAsIndex])
+        {
+            _sensorFrameSinks[sensorTypeAsIndex] =
+                ref new DepthFrameFilterSink(
+                    sensorType,
+                    downstreamSink);
+        }
+
+        return _sensorFrameSinks[sensorTypeAsIndex];
+    }
+
+    DepthFrameFilterSink^ DepthFrameFilterSinkGroup::GetDepthFrameFilterSink(
+        _In_ SensorType sensorType)
+    {
+        std::lock_guard<std::mutex> guard(_sinkGroupMutex);
+
+        return _sensorFrameSinks[static_cast<int32_t>(sensorType)];
+    }
+}
@@ -0,0 +1,50 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Puts a DepthFrameFilterSink in front of the depth sinks of another sink group, so
+    // that e.g. a SensorFrameRecorder or a SensorFrameStreamer receives filtered depth:
+    //
+    //     ref new MediaFrameSourceGroup(
+    //         ...,
+    //         ref new DepthFrameFilterSinkGroup(sensorFrameRecorder));
+    //
+    public ref class DepthFrameFilterSinkGroup sealed
+        : public ISensorFrameSinkGroup
+    {
+    public:
+        DepthFrameFilterSinkGroup(
+            _In_ ISensorFrameSinkGroup^ downstreamSinkGroup);
+
+        virtual ISensorFrameSink^ GetSensorFrameSink(
+            _In_ SensorType sensorType);
+
+        //
+        // Returns the filter sink for a depth sensor, or null.
+        //
+        DepthFrameFilterSink^ GetDepthFrameFilterSink(
+            _In_ SensorType sensorType);
+
+    private:
+        ~DepthFrameFilterSinkGroup();
+
+    private:
+        std::mutex _sinkGroupMutex;
+
+        ISensorFrameSinkGroup^ _downstreamSinkGroup;
+
+        std::array<DepthFrameFilterSink^, (size_t)SensorType::NumberOfSensorTypes> _sensorFrameSinks;
+    };
+}
@@ -0,0 +1,643 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        size_t FindClosestTimestamp(
+            _In_ const std::vector<uint64_t>& timestamps,
+            _In_ uint64_t timestamp)
+        {
+            const auto next =
+                std::lower_bound(
+                    timestamps.begin(),
+                    timestamps.end(),
+                    timestamp);
+
+            if (timestamps.end() == next)
+            {
+                return timestamps.size() - 1;
+            }
+
+            if (timestamps.begin() == next ||
+                *next - timestamp < timestamp - *(next - 1))
+            {
+                return static_cast<size_t>(next - timestamps.begin());
+            }
+
+            return static_cast<size_t>(next - timestamps.begin()) - 1;
+        }
+    }
+
+    DepthToColorRegistration::Options::Options()
+        : OutputScale(0.5f)
+        , SplatRadius(1)
+        , OcclusionToleranceInMeters(0.05f)
+        , MaximumTimeOffset(500000)
+    {
+    }
+
+    DepthToColorRegistration::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfDepthFrames(0)
+        , NumberOfRegisteredFrames(0)
+        , NumberOfFramesWithoutColor(0)
+        , NumberOfFramesWithoutPose(0)
+        , ElapsedTimeInMilliseconds(0.0)
+        , RegistrationTimeInMilliseconds(0.0)
+        , MaximumRegistrationTimeInMilliseconds(0.0)
+    {
+    }
+
+    DepthToColorRegistration::DepthToColorRegistration(
+        _In_ const cv::Mat& depthUnitPlaneMap,
+        _In_ int32_t colorImageWidth,
+        _In_ int32_t colorImageHeight,
+        _In_ const Options& options)
+        : _options(options)
+        , _colorImageWidth(colorImageWidth)
+        , _colorImageHeight(colorImageHeight)
+    {
+        REQUIRES(
+            colorImageWidth > 0 &&
+            colorImageHeight > 0 &&
+            options.OutputScale > 0.0f &&
+            options.SplatRadius >= 0);
+
+        PointCloudGenerator(depthUnitPlaneMap).GetRays(
+            _rayX,
+            _rayY,
+            _rayZ);
+
+        _outputWidth = std::max(1, cvRound(colorImageWidth * options.OutputScale));
+        _outputHeight = std::max(1, cvRound(colorImageHeight * options.OutputScale));
+
+        _projectedU.create(depthUnitPlaneMap.size(), CV_32F);
+        _projectedV.create(depthUnitPlaneMap.size(), CV_32F);
+        _projectedDepth.create(depthUnitPlaneMap.size(), CV_32F);
+
+        _numberOfDepthBands =
+            std::max(1, std::min(depthUnitPlaneMap.rows, cv::getNumThreads() * 2));
+
+        _outputBandHeight =
+            std::max(1, (_outputHeight + cv::getNumThreads() * 2 - 1) / (cv::getNumThreads() * 2));
+
+        _numberOfOutputBands =
+            (_outputHeight + _outputBandHeight - 1) / _outputBandHeight;
+
+        _buckets.resize(
+            static_cast<size_t>(_numberOfDepthBands) * _numberOfOutputBands);
+
+        _zBuffer.create(
+            _outputHeight,
+            _outputWidth,
+            CV_32F);
+    }
+
+    int32_t DepthToColorRegistration::GetOutputWidth() const
+    {
+        return _outputWidth;
+    }
+
+    int32_t DepthToColorRegistration::GetOutputHeight() const
+    {
+        return _outputHeight;
+    }
+
+    /* static */ cv::Matx44f DepthToColorRegistration::ComputeColorProjection(
+        _In_ const std::array<float, 16>& cameraProjectionTransform)
+    {
+        cv::Matx44f projection;
+
+        std::copy(
+            cameraProjectionTransform.begin(),
+            cameraProjectionTransform.end(),
+            projection.val);
+
+        return projection.t();
+    }
+
+    void DepthToColorRegistration::Register(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& depthToColorCamera,
+        _In_ const cv::Matx44f& colorProjection,
+        _Out_opt_ cv::Mat* colorAlignedDepth,
+        _In_opt_ const cv::Mat* color,
+        _Out_opt_ cv::Mat* depthAlignedColor)
+    {
+        REQUIRES(
+            CV_16UC1 == depth.type() &&
+            depth.size() == _rayX.size());
+
+        REQUIRES(
+            nullptr == depthAlignedColor ||
+            (nullptr != color &&
+             (CV_8UC3 == color->type() || CV_8UC4 == color->type()) &&
+             color->cols == _colorImageWidth &&
+             color->rows == _colorImageHeight));
+
+        const cv::Matx44f depthToClip =
+            colorProjection * depthToColorCamera;
+
+        //
+        // Project the depth pixels, bucketing them by band of output rows.
+        //
+        cv::parallel_for_(
+            cv::Range(0, _numberOfDepthBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                ProjectBand(
+                    depth,
+                    depthToColorCamera,
+                    depthToClip,
+                    band);
+            }
+        });
+
+        //
+        // Fill the z-buffer, one band of output rows per task.
+        //
+        cv::parallel_for_(
+            cv::Range(0, _numberOfOutputBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                SplatBand(
+                    band);
+            }
+        });
+
+        if (nullptr != colorAlignedDepth)
+        {
+            colorAlignedDepth->create(
+                _outputHeight,
+                _outputWidth,
+                CV_16UC1);
+
+            const float inverseDepthScale =
+                1.0f / _options.Depth.DepthScale;
+
+            cv::parallel_for_(
+                cv::Range(0, _outputHeight),
+                [&](const cv::Range& range)
+            {
+                for (int32_t v = range.start; v < range.end; ++v)
+                {
+                    const float* zBuffer = _zBuffer.ptr<float>(v);
+                    uint16_t* output = colorAlignedDepth->ptr<uint16_t>(v);
+
+                    for (int32_t u = 0; u < _outputWidth; ++u)
+                    {
+                        output[u] =
+                            std::isfinite(zBuffer[u]) ?
+                                cv::saturate_cast<uint16_t>(zBuffer[u] * inverseDepthScale) :
+                                static_cast<uint16_t>(0);
+                    }
+                }
+            });
+        }
+
+        if (nullptr != depthAlignedColor)
+        {
+            const int32_t channels =
+                color->channels();
+
+            depthAlignedColor->create(
+                depth.size(),
+                color->type());
+
+            cv::parallel_for_(
+                cv::Range(0, depth.rows),
+                [&](const cv::Range& range)
+            {
+                for (int32_t v = range.start; v < range.end; ++v)
+                {
+                    const float* projectedU = _projectedU.ptr<float>(v);
+                    const float* projectedV = _projectedV.ptr<float>(v);
+                    const float* projectedDepth = _projectedDepth.ptr<float>(v);
+
+                    uint8_t* output = depthAlignedColor->ptr<uint8_t>(v);
+
+                    for (int32_t u = 0; u < depth.cols; ++u, output += channels)
+                    {
+                        std::fill(output, output + channels, static_cast<uint8_t>(0));
+
+                        if (std::isnan(projectedDepth[u]))
+                        {
+                            continue;
+                        }
+
+                        const int32_t outputU = static_cast<int32_t>(projectedU[u] * _options.OutputScale);
+                        const int32_t outputV = static_cast<int32_t>(projectedV[u] * _options.OutputScale);
+
+                        if (outputU >= _outputWidth || outputV >= _outputHeight ||
+                            projectedDepth[u] > _zBuffer.at<float>(outputV, outputU) + _options.OcclusionToleranceInMeters)
+                        {
+                            continue;
+                        }
+
+                        const uint8_t* source =
+                            color->ptr<uint8_t>(static_cast<int32_t>(projectedV[u])) +
+                            static_cast<int32_t>(projectedU[u]) * channels;
+
+                        std::copy(source, source + channels, output);
+                    }
+                }
+            });
+        }
+    }
+
+    void DepthToColorRegistration::ProjectBand(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& depthToColorCamera,
+        _In_ const cv::Matx44f& depthToClip,
+        _In_ int32_t depthBand)
+    {
+        const int32_t beginRow = depth.rows * depthBand / _numberOfDepthBands;
+        const int32_t endRow = depth.rows * (depthBand + 1) / _numberOfDepthBands;
+
+        std::vector<int32_t>* buckets =
+            &_buckets[static_cast<size_t>(depthBand) * _numberOfOutputBands];
+
+        for (int32_t bucket = 0; bucket < _numberOfOutputBands; ++bucket)
+        {
+            buckets[bucket].clear();
+        }
+
+        const cv::Matx44f& t = depthToColorCamera;
+        const cv::Matx44f& m = depthToClip;
+
+        const float halfWidth = 0.5f * _colorImageWidth;
+        const float halfHeight = 0.5f * _colorImageHeight;
+
+        const float notANumber =
+            std::numeric_limits<float>::quiet_NaN();
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            const uint16_t* depthRow = depth.ptr<uint16_t>(v);
+            const float* rayX = _rayX.ptr<float>(v);
+            const float* rayY = _rayY.ptr<float>(v);
+            const float* rayZ = _rayZ.ptr<float>(v);
+
+            float* projectedU = _projectedU.ptr<float>(v);
+            float* projectedV = _projectedV.ptr<float>(v);
+            float* projectedDepth = _projectedDepth.ptr<float>(v);
+
+            int32_t u = 0;
+
+#if CV_SIMD128
+            const cv::v_float32x4 scale = cv::v_setall_f32(_options.Depth.DepthScale);
+            const cv::v_float32x4 minimumDepth = cv::v_setall_f32(_options.Depth.MinimumDepthInMeters);
+            const cv::v_float32x4 maximumDepth = cv::v_setall_f32(_options.Depth.MaximumDepthInMeters);
+            const cv::v_float32x4 zero = cv::v_setzero_f32();
+            const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+            const cv::v_float32x4 nan = cv::v_setall_f32(notANumber);
+            const cv::v_float32x4 halfWidthVector = cv::v_setall_f32(halfWidth);
+            const cv::v_float32x4 halfHeightVector = cv::v_setall_f32(halfHeight);
+
+            const cv::v_float32x4 t20 = cv::v_setall_f32(t(2, 0)), t21 = cv::v_setall_f32(t(2, 1)), t22 = cv::v_setall_f32(t(2, 2)), t23 = cv::v_setall_f32(t(2, 3));
+            const cv::v_float32x4 m00 = cv::v_setall_f32(m(0, 0)), m01 = cv::v_setall_f32(m(0, 1)), m02 = cv::v_setall_f32(m(0, 2)), m03 = cv::v_setall_f32(m(0, 3));
+            const cv::v_float32x4 m10 = cv::v_setall_f32(m(1, 0)), m11 = cv::v_setall_f32(m(1, 1)), m12 = cv::v_setall_f32(m(1, 2)), m13 = cv::v_setall_f32(m(1, 3));
+            const cv::v_float32x4 m30 = cv::v_setall_f32(m(3, 0)), m31 = cv::v_setall_f32(m(3, 1)), m32 = cv::v_setall_f32(m(3, 2)), m33 = cv::v_setall_f32(m(3, 3));
+
+            for (; u + 4 <= depth.cols; u += 4)
+            {
+                const cv::v_float32x4 distance =
+                    cv::v_cvt_f32(cv::v_reinterpret_as_s32(cv::v_load_expand(depthRow + u))) * scale;
+
+                const cv::v_float32x4 rz = cv::v_load(rayZ + u);
+
+                const cv::v_float32x4 x = distance * cv::v_load(rayX + u);
+                const cv::v_float32x4 y = distance * cv::v_load(rayY + u);
+                const cv::v_float32x4 z = distance * rz;
+
+                const cv::v_float32x4 colorZ = cv::v_muladd(t20, x, cv::v_muladd(t21, y, cv::v_muladd(t22, z, t23)));
+                const cv::v_float32x4 clipX = cv::v_muladd(m00, x, cv::v_muladd(m01, y, cv::v_muladd(m02, z, m03)));
+                const cv::v_float32x4 clipY = cv::v_muladd(m10, x, cv::v_muladd(m11, y, cv::v_muladd(m12, z, m13)));
+                const cv::v_float32x4 clipW = cv::v_muladd(m30, x, cv::v_muladd(m31, y, cv::v_muladd(m32, z, m33)));
+
+                //
+                // The color camera also looks down the negative Z axis.
+                //
+                const cv::v_float32x4 valid =
+                    (distance >= minimumDepth) &
+                    (distance <= maximumDepth) &
+                    (rz != zero) &
+                    (colorZ < zero) &
+                    (clipW > zero);
+
+                const cv::v_float32x4 inverseW =
+                    one / cv::v_select(valid, clipW, one);
+
+                cv::v_store(projectedU + u, cv::v_select(valid, (one + clipX * inverseW) * halfWidthVector, nan));
+                cv::v_store(projectedV + u, cv::v_select(valid, (one - clipY * inverseW) * halfHeightVector, nan));
+                cv::v_store(projectedDepth + u, cv::v_select(valid, zero - colorZ, nan));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; u < depth.cols; ++u)
+            {
+                const float distance =
+                    depthRow[u] * _options.Depth.DepthScale;
+
+                const float x = distance * rayX[u];
+                const float y = distance * rayY[u];
+                const float z = distance * rayZ[u];
+
+                const float colorZ = t(2, 0) * x + t(2, 1) * y + t(2, 2) * z + t(2, 3);
+                const float clipX = m(0, 0) * x + m(0, 1) * y + m(0, 2) * z + m(0, 3);
+                const float clipY = m(1, 0) * x + m(1, 1) * y + m(1, 2) * z + m(1, 3);
+                const float clipW = m(3, 0) * x + m(3, 1) * y + m(3, 2) * z + m(3, 3);
+
+                if (distance < _options.Depth.MinimumDepthInMeters ||
+                    distance > _options.Depth.MaximumDepthInMeters ||
+                    0.0f == rayZ[u] ||
+                    colorZ >= 0.0f ||
+                    clipW <= 0.0f)
+                {
+                    projectedU[u] = projectedV[u] = projectedDepth[u] = notANumber;
+                    continue;
+                }
+
+                projectedU[u] = (1.0f + clipX / clipW) * halfWidth;
+                projectedV[u] = (1.0f - clipY / clipW) * halfHeight;
+                projectedDepth[u] = -colorZ;
+            }
+
+            //
+            // Discard the pixels falling outside of the color image, and bucket the others
+            // by the bands of output rows their splats cover.
+            //
+            for (u = 0; u < depth.cols; ++u)
+            {
+                if (std::isnan(projectedDepth[u]))
+                {
+                    continue;
+                }
+
+                if (!(projectedU[u] >= 0.0f && projectedU[u] < _colorImageWidth &&
+                      projectedV[u] >= 0.0f && projectedV[u] < _colorImageHeight))
+                {
+                    projectedDepth[u] = notANumber;
+                    continue;
+                }
+
+                const int32_t outputV =
+                    static_cast<int32_t>(projectedV[u] * _options.OutputScale);
+
+                const int32_t firstBand =
+                    std::max(0, outputV - _options.SplatRadius) / _outputBandHeight;
+
+                const int32_t lastBand =
+                    std::min(_outputHeight - 1, outputV + _options.SplatRadius) / _outputBandHeight;
+
+                for (int32_t bucket = firstBand; bucket <= lastBand; ++bucket)
+                {
+                    buckets[bucket].push_back(
+                        v * depth.cols + u);
+                }
+            }
+        }
+    }
+
+    void DepthToColorRegistration::SplatBand(
+        _In_ int32_t outputBand)
+    {
+        const int32_t beginRow = outputBand * _outputBandHeight;
+        const int32_t endRow = std::min(_outputHeight, beginRow + _outputBandHeight);
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            float* zBuffer = _zBuffer.ptr<float>(v);
+
+            std::fill(
+                zBuffer,
+                zBuffer + _outputWidth,
+                std::numeric_limits<float>::infinity());
+        }
+
+        const float* projectedU = _projectedU.ptr<float>();
+        const float* projectedV = _projectedV.ptr<float>();
+        const float* projectedDepth = _projectedDepth.ptr<float>();
+
+        const int32_t radius = _options.SplatRadius;
+
+        for (int32_t depthBand = 0; depthBand < _numberOfDepthBands; ++depthBand)
+        {
+            const std::vector<int32_t>& bucket =
+                _buckets[static_cast<size_t>(depthBand) * _numberOfOutputBands + outputBand];
+
+            for (const int32_t pixel : bucket)
+            {
+                const int32_t outputU = static_cast<int32_t>(projectedU[pixel] * _options.OutputScale);
+                const int32_t outputV = static_cast<int32_t>(projectedV[pixel] * _options.OutputScale);
+
+                const float z = projectedDepth[pixel];
+
+                const int32_t firstRow = std::max(beginRow, outputV - radius);
+                const int32_t lastRow = std::min(endRow - 1, outputV + radius);
+                const int32_t firstColumn = std::max(0, outputU - radius);
+                const int32_t lastColumn = std::min(_outputWidth - 1, outputU + radius);
+
+                for (int32_t row = firstRow; row <= lastRow; ++row)
+                {
+                    float* zBuffer = _zBuffer.ptr<float>(row);
+
+                    for (int32_t column = firstColumn; column <= lastColumn; ++column)
+                    {
+                        zBuffer[column] = std::min(zBuffer[column], z);
+                    }
+                }
+            }
+        }
+    }
+
+    /* static */ bool DepthToColorRegistration::BenchmarkRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& depthSensorName,
+        _In_ const std::string& colorSensorName,
+        _In_ const Options& options,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        statistics = BenchmarkStatistics();
+
+        SensorFrameRecordingReader depthReader, colorReader;
+
+        if (!depthReader.Open(recordingFolder, depthSensorName) ||
+            !colorReader.Open(recordingFolder, colorSensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> depthArchive = depthReader.OpenArchive();
+        std::unique_ptr<std::istream> colorArchive = colorReader.OpenArchive();
+
+        RecordedSensorFrame depthFrame, colorFrame;
+
+        if (!depthReader.ReadFrame(0, depthArchive.get(), depthFrame) ||
+            !colorReader.ReadFrame(0, colorArchive.get(), colorFrame))
+        {
+            return false;
+        }
+
+        size_t colorFrameIndex = 0;
+
+        cv::Mat unitPlaneMap;
+
+        if (!PointCloudGenerator::LoadUnitPlaneMap(
+                recordingFolder,
+                depthSensorName,
+                depthFrame.Image.cols,
+                depthFrame.Image.rows,
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        DepthToColorRegistration registration(
+            unitPlaneMap,
+            colorFrame.Image.cols,
+            colorFrame.Image.rows,
+            options);
+
+        SensorPoseTrack depthPoses, colorPoses;
+
+        depthPoses.Add(depthReader);
+        colorPoses.Add(colorReader);
+
+        std::vector<uint64_t> colorTimestamps;
+
+        for (size_t i = 0; i < colorReader.GetNumberOfFrames(); ++i)
+        {
+            colorTimestamps.push_back(
+                colorReader.GetFrameIndexEntry(i).Timestamp);
+        }
+
+        cv::Mat colorAlignedDepth, depthAlignedColor;
+
+        for (size_t i = 0; i < depthReader.GetNumberOfFrames(); ++i)
+        {
+            if (!depthReader.ReadFrame(i, depthArchive.get(), depthFrame) ||
+                CV_16UC1 != depthFrame.Image.type())
+            {
+                continue;
+            }
+
+            ++statistics.NumberOfDepthFrames;
+
+            const size_t closestColorFrameIndex =
+                FindClosestTimestamp(
+                    colorTimestamps,
+                    depthFrame.Timestamp);
+
+            const uint64_t colorTimestamp =
+                colorTimestamps[closestColorFrameIndex];
+
+            const uint64_t timeOffset =
+                (colorTimestamp > depthFrame.Timestamp) ?
+                    colorTimestamp - depthFrame.Timestamp :
+                    depthFrame.Timestamp - colorTimestamp;
+
+            if (timeOffset > options.MaximumTimeOffset)
+            {
+                ++statistics.NumberOfFramesWithoutColor;
+                continue;
+            }
+
+            //
+            // Each sensor's pose is taken at its own capture time, interpolated from the
+            // neighboring frames if the frame itself has no valid pose.
+            //
+            cv::Matx44f depthCameraToWorld, colorCameraToWorld;
+
+            if (!depthPoses.Interpolate(depthFrame.Timestamp, options.MaximumTimeOffset, depthCameraToWorld) ||
+                !colorPoses.Interpolate(colorTimestamp, options.MaximumTimeOffset, colorCameraToWorld))
+            {
+                ++statistics.NumberOfFramesWithoutPose;
+                continue;
+            }
+
+            if (closestColorFrameIndex != colorFrameIndex)
+            {
+                if (!colorReader.ReadFrame(closestColorFrameIndex, colorArchive.get(), colorFrame))
+                {
+                    ++statistics.NumberOfFramesWithoutColor;
+                    continue;
+                }
+
+                colorFrameIndex = closestColorFrameIndex;
+            }
+
+            if ((CV_8UC3 != colorFrame.Image.type() && CV_8UC4 != colorFrame.Image.type()) ||
+                colorFrame.Image.cols != registration._colorImageWidth ||
+                colorFrame.Image.rows != registration._colorImageHeight)
+            {
+                ++statistics.NumberOfFramesWithoutColor;
+                continue;
+            }
+
+            const Clock::time_point registrationStartTime =
+                Clock::now();
+
+            registration.Register(
+                depthFrame.Image,
+                colorCameraToWorld.inv() * depthCameraToWorld,
+                ComputeColorProjection(colorFrame.CameraProjectionTransform),
+                &colorAlignedDepth,
+                &colorFrame.Image,
+                &depthAlignedColor);
+
+            const double registrationTimeInMilliseconds =
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - registrationStartTime).count();
+
+            ++statistics.NumberOfRegisteredFrames;
+
+            statistics.RegistrationTimeInMilliseconds +=
+                registrationTimeInMilliseconds;
+
+            statistics.MaximumRegistrationTimeInMilliseconds =
+                std::max(
+                    statistics.MaximumRegistrationTimeInMilliseconds,
+                    registrationTimeInMilliseconds);
+        }
+
+        statistics.ElapsedTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(
+                Clock::now() - startTime).count();
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "DepthToColorRegistration",
+            dbg::LogLevel::Information,
+            L"DepthToColorRegistration::BenchmarkRecording: %S to %S: %llu of %llu frames registered, %.3f ms/frame (max %.3f ms)",
+            depthSensorName.c_str(),
+            colorSensorName.c_str(),
+            statistics.NumberOfRegisteredFrames,
+            statistics.NumberOfDepthFrames,
+            statistics.NumberOfRegisteredFrames ? statistics.RegistrationTimeInMilliseconds / statistics.NumberOfRegisteredFrames : 0.0,
+            statistics.MaximumRegistrationTimeInMilliseconds);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return true;
+    }
+}
@@ -0,0 +1,158 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Registers depth frames with photo-video (color) frames.
+    //
+    // Depth pixels are unprojected with precomputed rays, transformed into the color
+    // camera and projected with the color camera's CameraProjectionTransform, in a single
+    // vectorized pass parallelized over rows. The projected points are then splatted into
+    // a z-buffer at (a fraction of) the color resolution, which yields a color-aligned
+    // depth map and the visibility needed to build a depth-aligned color image.
+    //
+    // An instance keeps scratch buffers between calls, so it must not be used by several
+    // threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class DepthToColorRegistration
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Resolution of the color-aligned depth map, relative to the color image.
+            float OutputScale;
+
+            // Each depth pixel covers a square of (2 * SplatRadius + 1) output pixels.
+            int32_t SplatRadius;
+
+            // A depth pixel is considered visible from the color camera if it is at most
+            // this much farther than the closest surface in the z-buffer.
+            float OcclusionToleranceInMeters;
+
+            // Depth range and scale.
+            PointCloudGenerator::Options Depth;
+
+            // Depth frames are only paired with color frames captured within this time
+            // (in 100ns ticks), and poses are not interpolated over larger gaps.
+            uint64_t MaximumTimeOffset;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfDepthFrames;
+            uint64_t NumberOfRegisteredFrames;
+            uint64_t NumberOfFramesWithoutColor;
+            uint64_t NumberOfFramesWithoutPose;
+
+            double ElapsedTimeInMilliseconds;
+            double RegistrationTimeInMilliseconds;
+            double MaximumRegistrationTimeInMilliseconds;
+        };
+
+        //
+        // The depth unit plane map is a CV_32FC2 image holding the (x, y) unit plane
+        // coordinates of each depth pixel, +infinity for pixels without a valid mapping.
+        //
+        DepthToColorRegistration(
+            _In_ const cv::Mat& depthUnitPlaneMap,
+            _In_ int32_t colorImageWidth,
+            _In_ int32_t colorImageHeight,
+            _In_ const Options& options);
+
+        int32_t GetOutputWidth() const;
+
+        int32_t GetOutputHeight() const;
+
+        //
+        // Converts a CameraProjectionTransform (row-major, for row vectors) to a matrix
+        // for column vectors.
+        //
+        static cv::Matx44f ComputeColorProjection(
+            _In_ const std::array<float, 16>& cameraProjectionTransform);
+
+        //
+        // Registers a depth frame (Gray16) with a color frame.
+        //
+        // The depth to color camera transform is inverse(colorCameraToWorld) *
+        // depthCameraToWorld. The color-aligned depth map (CV_16UC1, output resolution)
+        // holds the Z distance to the color camera, in the units of the depth frame, or
+        // zero. The depth-aligned color image has the type of the color image and the
+        // resolution of the depth frame, and is black where the depth pixel is invalid or
+        // occluded from the color camera. Either output can be null.
+        //
+        void Register(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& depthToColorCamera,
+            _In_ const cv::Matx44f& colorProjection,
+            _Out_opt_ cv::Mat* colorAlignedDepth,
+            _In_opt_ const cv::Mat* color,
+            _Out_opt_ cv::Mat* depthAlignedColor);
+
+        //
+        // Registers all the frames recorded for a depth sensor with the closest frames of
+        // a color sensor, interpolating the sensor poses at the frames' timestamps, and
+        // reports the registration times.
+        //
+        static bool BenchmarkRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& depthSensorName,
+            _In_ const std::string& colorSensorName,
+            _In_ const Options& options,
+            _Out_ BenchmarkStatistics& statistics);
+
+    private:
+        void ProjectBand(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& depthToColorCamera,
+            _In_ const cv::Matx44f& depthToClip,
+            _In_ int32_t depthBand);
+
+        void SplatBand(
+            _In_ int32_t outputBand);
+
+    private:
+        Options _options;
+
+        int32_t _colorImageWidth;
+        int32_t _colorImageHeight;
+
+        int32_t _outputWidth;
+        int32_t _outputHeight;
+
+        cv::Mat _rayX;
+        cv::Mat _rayY;
+        cv::Mat _rayZ;
+
+        // Per depth pixel: projection in the color image (in color pixels) and Z distance
+        // to the color camera (in meters), NaN if the pixel does not project.
+        cv::Mat _projectedU;
+        cv::Mat _projectedV;
+        cv::Mat _projectedDepth;
+
+        // Depth pixels to splat, bucketed by band of output rows, for each band of depth
+        // rows. Lets the z-buffer be filled in parallel without synchronization.
+        int32_t _numberOfDepthBands;
+        int32_t _numberOfOutputBands;
+        int32_t _outputBandHeight;
+        std::vector<std::vector<int32_t>> _buckets;
+
+        cv::Mat _zBuffer;
+    };
+}
@@ -0,0 +1,140 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        Platform::String^ ToPlatformString(
+            _In_ const std::string& value)
+        {
+            const std::wstring wideValue(
+                value.begin(),
+                value.end());
+
+            return ref new Platform::String(
+                wideValue.c_str());
+        }
+    }
+
+    FeatureExtractionSink::FeatureExtractionSink(
+        _In_ SensorType sensorType,
+        _In_ ISensorFrameSink^ downstreamSink)
+        : _sensorType(sensorType)
+        , _downstreamSink(downstreamSink)
+    {
+        REQUIRES(nullptr != downstreamSink);
+    }
+
+    FeatureExtractionSink::~FeatureExtractionSink()
+    {
+    }
+
+    void FeatureExtractionSink::Send(
+        _In_ SensorFrame^ sensorFrame)
+    {
+        //
+        // The same frame may be delivered more than once; extract its features only once.
+        //
+        if (nullptr != sensorFrame->Features)
+        {
+            _downstreamSink->Send(
+                sensorFrame);
+
+            return;
+        }
+
+        //
+        // The pyramid of the frame is shared with the other sinks, which may already have
+        // computed some of its levels.
+        //
+        const std::shared_ptr<ImagePyramid> imagePyramid =
+            sensorFrame->GetImagePyramid();
+
+        if (nullptr == imagePyramid)
+        {
+            _downstreamSink->Send(
+                sensorFrame);
+
+            return;
+        }
+
+        ImageFeatures features;
+
+        {
+            std::lock_guard<std::mutex> guard(_extractorMutex);
+
+            _extractor.Extract(
+                *imagePyramid,
+                features);
+
+            const FeatureExtractor::FrameTimings& timings =
+                _extractor.GetLastFrameTimings();
+
+            ++_timings.NumberOfFrames;
+
+            _timings.NumberOfFeatures += features.Keypoints.size();
+            _timings.PyramidTimeInMilliseconds += timings.PyramidTimeInMilliseconds;
+            _timings.DetectionTimeInMilliseconds += timings.DetectionTimeInMilliseconds;
+            _timings.DescriptionTimeInMilliseconds += timings.DescriptionTimeInMilliseconds;
+            _timings.TotalTimeInMilliseconds += timings.TotalTimeInMilliseconds;
+
+            _timings.MaximumTotalTimeInMilliseconds =
+                std::max(
+                    _timings.MaximumTotalTimeInMilliseconds,
+                    timings.TotalTimeInMilliseconds);
+        }
+
+        sensorFrame->Features =
+            ref new SensorFrameFeatures(
+                std::move(features));
+
+        _downstreamSink->Send(
+            sensorFrame);
+    }
+
+    Platform::String^ FeatureExtractionSink::GetStageTimingsAsJson()
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        {
+            std::lock_guard<std::mutex> guard(_extractorMutex);
+
+            const double scale =
+                (_timings.NumberOfFrames > 0) ? 1.0 / _timings.NumberOfFrames : 0.0;
+
+            stream
+                << "{\"frames\":" << _timings.NumberOfFrames
+                << ",\"features\":" << _timings.NumberOfFeatures * scale
+                << ",\"pyramid_ms\":" << _timings.PyramidTimeInMilliseconds * scale
+                << ",\"detection_ms\":" << _timings.DetectionTimeInMilliseconds * scale
+                << ",\"description_ms\":" << _timings.DescriptionTimeInMilliseconds * scale
+                << ",\"total_ms\":" << _timings.TotalTimeInMilliseconds * scale
+                << ",\"max_total_ms\":" << _timings.MaximumTotalTimeInMilliseconds
+                << "}";
+        }
+
+        return ToPlatformString(
+            stream.str());
+    }
+
+    void FeatureExtractionSink::ResetStageTimings()
+    {
+        std::lock_guard<std::mutex> guard(_extractorMutex);
+
+        _timings = FeatureExtractor::BenchmarkStatistics();
+    }
+}
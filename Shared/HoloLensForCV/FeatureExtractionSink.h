@@ -0,0 +1,58 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Extracts the features of visible light camera and photo video frames (see
+    // FeatureExtractor), attaches them to the frames and passes the frames on to another
+    // sink, e.g. a recorder sink, which then stores the features next to the images.
+    // Frames of other formats are passed on unmodified.
+    //
+    // Extraction runs on the thread that delivers the frames: as each camera has its own
+    // media frame reader, the cameras are processed in parallel.
+    //
+    public ref class FeatureExtractionSink sealed
+        : public ISensorFrameSink
+    {
+    public:
+        FeatureExtractionSink(
+            _In_ SensorType sensorType,
+            _In_ ISensorFrameSink^ downstreamSink);
+
+        virtual void Send(
+            _In_ SensorFrame^ sensorFrame);
+
+        //
+        // Returns the average number of features and per-frame time spent in each stage,
+        // as JSON.
+        //
+        Platform::String^ GetStageTimingsAsJson();
+
+        void ResetStageTimings();
+
+    private:
+        ~FeatureExtractionSink();
+
+    private:
+        SensorType _sensorType;
+
+        ISensorFrameSink^ _downstreamSink;
+
+        std::mutex _extractorMutex;
+
+        FeatureExtractor _extractor;
+
+        FeatureExtractor::BenchmarkStatistics _timings;
+    };
+}
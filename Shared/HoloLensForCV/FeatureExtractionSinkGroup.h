@@ -0,0 +1,51 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Puts a FeatureExtractionSink in front of the visible light camera and photo video
+    // sinks of another sink group, so that e.g. a SensorFrameRecorder receives frames with
+    // their features, and records them:
+    //
+    //     ref new MediaFrameSourceGroup(
+    //         ...,
+    //         ref new FeatureExtractionSinkGroup(sensorFrameRecorder));
+    //
+    public ref class FeatureExtractionSinkGroup sealed
+        : public ISensorFrameSinkGroup
+    {
+    public:
+        FeatureExtractionSinkGroup(
+            _In_ ISensorFrameSinkGroup^ downstreamSinkGroup);
+
+        virtual ISensorFrameSink^ GetSensorFrameSink(
+            _In_ SensorType sensorType);
+
+        //
+        // Returns the feature extraction sink for a camera, or null.
+        //
+        FeatureExtractionSink^ GetFeatureExtractionSink(
+            _In_ SensorType sensorType);
+
+    private:
+        ~FeatureExtractionSinkGroup();
+
+    private:
+        std::mutex _sinkGroupMutex;
+
+        ISensorFrameSinkGroup^ _downstreamSinkGroup;
+
+        std::array<FeatureExtractionSink^, (size_t)SensorType::NumberOfSensorTypes> _sensorFrameSinks;
+    };
+}
@@ -0,0 +1,1129 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // The segment test looks for an arc of 9 contiguous pixels, out of the 16 pixels of
+        // a circle of radius 3, that are all brighter or all darker than the center.
+        //
+        const int32_t c_circleSize = 16;
+        const int32_t c_arcLength = 9;
+
+        // The circle is walked once and then up to the end of an arc starting on its last
+        // pixel.
+        const int32_t c_circleWalkLength = c_circleSize + c_arcLength;
+
+        const std::array<cv::Point, c_circleSize> c_circle =
+        {
+            cv::Point(0, 3), cv::Point(1, 3), cv::Point(2, 2), cv::Point(3, 1),
+            cv::Point(3, 0), cv::Point(3, -1), cv::Point(2, -2), cv::Point(1, -3),
+            cv::Point(0, -3), cv::Point(-1, -3), cv::Point(-2, -2), cv::Point(-3, -1),
+            cv::Point(-3, 0), cv::Point(-3, 1), cv::Point(-2, 2), cv::Point(-1, 3)
+        };
+
+        const int32_t c_descriptorBits = FeatureExtractor::DescriptorSize * 8;
+
+        // Descriptors are computed with the comparison pattern rotated by the closest of
+        // these many angles.
+        const int32_t c_numberOfAngleSteps = 30;
+
+        // Comparisons are drawn from a Gaussian of standard deviation PatchSize / 5 (as
+        // for BRIEF), clipped to a disk that stays within the patch whatever the rotation.
+        const double c_patternStandardDeviation = FeatureExtractor::PatchSize / 5.0;
+        const int32_t c_patternRadius = FeatureExtractor::PatchSize / 2 - 2;
+        const uint32_t c_patternSeed = 0x4f524231;
+
+        //
+        // Generates the comparison pattern as (x1, y1, x2, y2) values. The standard only
+        // specifies the sequence of std::mt19937, not that of the distributions, so the
+        // Gaussian is approximated from uniform values directly to get the same pattern
+        // everywhere.
+        //
+        std::vector<int8_t> GenerateComparisonPattern()
+        {
+            std::mt19937 generator(
+                c_patternSeed);
+
+            const auto drawPoint = [&generator]()
+            {
+                for (;;)
+                {
+                    cv::Point point;
+
+                    for (int32_t* coordinate : { &point.x, &point.y })
+                    {
+                        //
+                        // The sum of four uniform values in [0, 1) has a mean of 2 and a
+                        // variance of 1/3.
+                        //
+                        double sum = 0.0;
+
+                        for (int32_t i = 0; i < 4; ++i)
+                        {
+                            sum += generator() / 4294967296.0;
+                        }
+
+                        *coordinate = cvRound(
+                            (sum - 2.0) * std::sqrt(3.0) * c_patternStandardDeviation);
+                    }
+
+                    if (point.dot(point) <= c_patternRadius * c_patternRadius)
+                    {
+                        return point;
+                    }
+                }
+            };
+
+            std::vector<int8_t> pattern;
+
+            pattern.reserve(c_descriptorBits * 4);
+
+            while (pattern.size() < static_cast<size_t>(c_descriptorBits * 4))
+            {
+                const cv::Point first = drawPoint();
+                const cv::Point second = drawPoint();
+
+                if (first == second)
+                {
+                    continue;
+                }
+
+                pattern.push_back(static_cast<int8_t>(first.x));
+                pattern.push_back(static_cast<int8_t>(first.y));
+                pattern.push_back(static_cast<int8_t>(second.x));
+                pattern.push_back(static_cast<int8_t>(second.y));
+            }
+
+            return pattern;
+        }
+
+        //
+        // Segment test of one pixel: returns true if 9 contiguous pixels of the circle are
+        // all brighter than center + threshold, or all darker than center - threshold.
+        //
+        bool IsCorner(
+            _In_ const uint8_t* center,
+            _In_reads_(c_circleWalkLength) const int32_t* offsets,
+            _In_ int32_t threshold)
+        {
+            const int32_t brighter = center[0] + threshold;
+            const int32_t darker = center[0] - threshold;
+
+            int32_t brighterCount = 0;
+            int32_t darkerCount = 0;
+
+            for (int32_t k = 0; k < c_circleWalkLength; ++k)
+            {
+                const int32_t value = center[offsets[k]];
+
+                brighterCount = (value > brighter) ? brighterCount + 1 : 0;
+                darkerCount = (value < darker) ? darkerCount + 1 : 0;
+
+                if (brighterCount >= c_arcLength ||
+                    darkerCount >= c_arcLength)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        //
+        // Score of a corner: the largest threshold for which it still passes the segment
+        // test. The differences along each arc of 9 pixels are reduced to their minimum
+        // (darker arcs) or maximum (brighter arcs); arcs are visited in pairs sharing 8
+        // pixels.
+        //
+        int32_t ComputeCornerScore(
+            _In_ const uint8_t* center,
+            _In_reads_(c_circleWalkLength) const int32_t* offsets,
+            _In_ int32_t threshold)
+        {
+            std::array<int32_t, c_circleWalkLength> differences;
+
+            for (int32_t k = 0; k < c_circleWalkLength; ++k)
+            {
+                differences[k] = center[0] - center[offsets[k]];
+            }
+
+            int32_t darkerScore = threshold;
+
+            for (int32_t k = 0; k < c_circleSize; k += 2)
+            {
+                int32_t minimum = std::min(differences[k + 1], differences[k + 2]);
+
+                minimum = std::min(minimum, differences[k + 3]);
+
+                if (minimum <= darkerScore)
+                {
+                    continue;
+                }
+
+                for (int32_t i = 4; i < c_arcLength; ++i)
+                {
+                    minimum = std::min(minimum, differences[k + i]);
+                }
+
+                darkerScore = std::max(darkerScore, std::min(minimum, differences[k]));
+                darkerScore = std::max(darkerScore, std::min(minimum, differences[k + c_arcLength]));
+            }
+
+            int32_t brighterScore = -darkerScore;
+
+            for (int32_t k = 0; k < c_circleSize; k += 2)
+            {
+                int32_t maximum = std::max(differences[k + 1], differences[k + 2]);
+
+                maximum = std::max(maximum, differences[k + 3]);
+
+                if (maximum >= brighterScore)
+                {
+                    continue;
+                }
+
+                for (int32_t i = 4; i < c_arcLength; ++i)
+                {
+                    maximum = std::max(maximum, differences[k + i]);
+                }
+
+                brighterScore = std::min(brighterScore, std::max(maximum, differences[k]));
+                brighterScore = std::min(brighterScore, std::max(maximum, differences[k + c_arcLength]));
+            }
+
+            return -brighterScore - 1;
+        }
+
+        uint64_t CountBits(
+            _In_ uint64_t value)
+        {
+            value = value - ((value >> 1) & 0x5555555555555555ull);
+            value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+            value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+
+            return (value * 0x0101010101010101ull) >> 56;
+        }
+
+        template <typename T>
+        T ReadValue(
+            _In_reads_bytes_(sizeof(T)) const uint8_t* data)
+        {
+            T value;
+
+            memcpy(&value, data, sizeof(T));
+
+            return value;
+        }
+    }
+
+    FeatureExtractor::Options::Options()
+        : FastThreshold(20)
+        , NonMaximumSuppression(true)
+        , MaximumNumberOfFeatures(1000)
+        , NumberOfLevels(3)
+        , GridCellSize(32)
+        , ColorDownscaleFactor(2)
+    {
+    }
+
+    FeatureExtractor::FrameTimings::FrameTimings()
+        : PyramidTimeInMilliseconds(0.0)
+        , DetectionTimeInMilliseconds(0.0)
+        , DescriptionTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , NumberOfCorners(0)
+    {
+    }
+
+    FeatureExtractor::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfFrames(0)
+        , NumberOfFeatures(0)
+        , PyramidTimeInMilliseconds(0.0)
+        , DetectionTimeInMilliseconds(0.0)
+        , DescriptionTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , MaximumTotalTimeInMilliseconds(0.0)
+        , FramesPerSecond(0.0)
+    {
+    }
+
+    FeatureExtractor::FeatureExtractor(
+        _In_ const Options& options)
+        : _options(options)
+    {
+        REQUIRES(options.FastThreshold > 0 && options.FastThreshold < 255);
+        REQUIRES(options.MaximumNumberOfFeatures > 0);
+        REQUIRES(options.NumberOfLevels > 0);
+        REQUIRES(options.GridCellSize > 0);
+        REQUIRES(options.ColorDownscaleFactor > 0);
+
+        const int32_t halfPatchSize = PatchSize / 2;
+
+        for (int32_t v = 0; v <= halfPatchSize; ++v)
+        {
+            _patchRowHalfWidths[v] = cvRound(
+                std::sqrt(static_cast<double>(halfPatchSize * halfPatchSize - v * v)));
+        }
+
+        const std::vector<int8_t> pattern =
+            GenerateComparisonPattern();
+
+        _rotatedPatterns.resize(c_numberOfAngleSteps);
+
+        for (int32_t step = 0; step < c_numberOfAngleSteps; ++step)
+        {
+            const double angle =
+                step * 2.0 * CV_PI / c_numberOfAngleSteps;
+
+            const double cosine = std::cos(angle);
+            const double sine = std::sin(angle);
+
+            std::vector<int8_t>& rotatedPattern =
+                _rotatedPatterns[step];
+
+            rotatedPattern.resize(pattern.size());
+
+            for (size_t i = 0; i < pattern.size(); i += 2)
+            {
+                const double x = pattern[i];
+                const double y = pattern[i + 1];
+
+                rotatedPattern[i] = static_cast<int8_t>(cvRound(x * cosine - y * sine));
+                rotatedPattern[i + 1] = static_cast<int8_t>(cvRound(x * sine + y * cosine));
+            }
+        }
+    }
+
+    const FeatureExtractor::Options& FeatureExtractor::GetOptions() const
+    {
+        return _options;
+    }
+
+    const FeatureExtractor::FrameTimings& FeatureExtractor::GetLastFrameTimings() const
+    {
+        return _lastFrameTimings;
+    }
+
+    void FeatureExtractor::Extract(
+        _In_ const cv::Mat& image,
+        _Out_ ImageFeatures& features)
+    {
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        //
+        // Color images are reduced to their luminance, at a lower resolution.
+        //
+        float imageScale = 1.0f;
+
+        _pyramid.resize(_options.NumberOfLevels);
+
+        if (CV_8UC3 == image.type() || CV_8UC4 == image.type())
+        {
+            ComputeLuminance(
+                image,
+                _options.ColorDownscaleFactor,
+                _luminance);
+
+            _pyramid[0] = _luminance;
+
+            imageScale = static_cast<float>(_options.ColorDownscaleFactor);
+        }
+        else
+        {
+            REQUIRES(CV_8UC1 == image.type());
+
+            _pyramid[0] = image;
+        }
+
+        for (int32_t level = 1; level < _options.NumberOfLevels; ++level)
+        {
+            ImagePyramid::Downsample(
+                _pyramid[level - 1],
+                _pyramid[level]);
+        }
+
+        ExtractFromPyramid(
+            imageScale,
+            startTime,
+            features);
+
+        // The first level may wrap the caller's image, which must not be referenced
+        // beyond this call.
+        _pyramid[0] = cv::Mat();
+    }
+
+    void FeatureExtractor::Extract(
+        _In_ ImagePyramid& imagePyramid,
+        _Out_ ImageFeatures& features)
+    {
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        const cv::Mat& image =
+            imagePyramid.GetLevel(0);
+
+        float imageScale = 1.0f;
+
+        _pyramid.resize(_options.NumberOfLevels);
+
+        if (CV_8UC1 == image.type())
+        {
+            //
+            // The levels are shared with the other users of the pyramid; levels too small
+            // for any keypoint are left empty.
+            //
+            for (int32_t level = 0; level < _options.NumberOfLevels; ++level)
+            {
+                _pyramid[level] =
+                    (level < imagePyramid.GetNumberOfLevels())
+                        ? imagePyramid.GetLevel(level)
+                        : cv::Mat();
+            }
+        }
+        else
+        {
+            REQUIRES(CV_8UC3 == image.type() || CV_8UC4 == image.type());
+
+            //
+            // The luminance is computed from the color level of the downscaled size, if
+            // the downscale factor is a power of two, rather than from the full image.
+            //
+            int32_t colorLevel = 0;
+
+            while ((2 << colorLevel) <= _options.ColorDownscaleFactor)
+            {
+                ++colorLevel;
+            }
+
+            if ((1 << colorLevel) == _options.ColorDownscaleFactor &&
+                colorLevel < imagePyramid.GetNumberOfLevels())
+            {
+                cv::cvtColor(
+                    imagePyramid.GetLevel(colorLevel),
+                    _luminance,
+                    (CV_8UC3 == image.type()) ? cv::COLOR_BGR2GRAY : cv::COLOR_BGRA2GRAY);
+            }
+            else
+            {
+                ComputeLuminance(
+                    image,
+                    _options.ColorDownscaleFactor,
+                    _luminance);
+            }
+
+            _pyramid[0] = _luminance;
+
+            for (int32_t level = 1; level < _options.NumberOfLevels; ++level)
+            {
+                ImagePyramid::Downsample(
+                    _pyramid[level - 1],
+                    _pyramid[level]);
+            }
+
+            imageScale = static_cast<float>(_options.ColorDownscaleFactor);
+        }
+
+        ExtractFromPyramid(
+            imageScale,
+            startTime,
+            features);
+
+        // Levels shared with the pyramid must not be referenced beyond this call.
+        if (CV_8UC1 == image.type())
+        {
+            for (cv::Mat& level : _pyramid)
+            {
+                level = cv::Mat();
+            }
+        }
+    }
+
+    void FeatureExtractor::ExtractFromPyramid(
+        _In_ float imageScale,
+        _In_ const std::chrono::steady_clock::time_point& startTime,
+        _Out_ ImageFeatures& features)
+    {
+        _lastFrameTimings = FrameTimings();
+
+        features.Keypoints.clear();
+
+        const std::chrono::steady_clock::time_point pyramidTime =
+            std::chrono::steady_clock::now();
+
+        _lastFrameTimings.PyramidTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(pyramidTime - startTime).count();
+
+        //
+        // The features are spread over the levels in proportion to their area.
+        //
+        double totalArea = 0.0;
+
+        for (int32_t level = 0; level < _options.NumberOfLevels; ++level)
+        {
+            totalArea += std::ldexp(1.0, -2 * level);
+        }
+
+        features.Descriptors.create(
+            _options.MaximumNumberOfFeatures,
+            DescriptorSize,
+            CV_8UC1);
+
+        int32_t numberOfFeatures = 0;
+
+        // Keypoints must be far enough from the border for their patch to be inside the
+        // image.
+        const int32_t border = PatchSize / 2 + 1;
+
+        for (int32_t level = 0; level < _options.NumberOfLevels; ++level)
+        {
+            const cv::Mat& levelImage =
+                _pyramid[level];
+
+            const int32_t maximumNumberOfCorners =
+                (level + 1 == _options.NumberOfLevels)
+                    ? _options.MaximumNumberOfFeatures - numberOfFeatures
+                    : std::min(
+                        _options.MaximumNumberOfFeatures - numberOfFeatures,
+                        cvRound(_options.MaximumNumberOfFeatures * std::ldexp(1.0, -2 * level) / totalArea));
+
+            if (maximumNumberOfCorners <= 0 ||
+                levelImage.cols <= 2 * border ||
+                levelImage.rows <= 2 * border)
+            {
+                continue;
+            }
+
+            const std::chrono::steady_clock::time_point detectionStartTime =
+                std::chrono::steady_clock::now();
+
+            DetectCorners(
+                levelImage,
+                border,
+                _corners);
+
+            _lastFrameTimings.NumberOfCorners += _corners.size();
+
+            SelectCorners(
+                maximumNumberOfCorners,
+                _corners);
+
+            const size_t firstKeypoint =
+                features.Keypoints.size();
+
+            //
+            // Keypoints are expressed in the pixels of the input image: the center of a
+            // pixel of a level downscaled by s is at s * (x + 0.5) - 0.5.
+            //
+            const float scale =
+                imageScale * static_cast<float>(1 << level);
+
+            for (const Corner& corner : _corners)
+            {
+                features.Keypoints.emplace_back(
+                    scale * (corner.X + 0.5f) - 0.5f,
+                    scale * (corner.Y + 0.5f) - 0.5f,
+                    scale * PatchSize,
+                    ComputeOrientation(levelImage, corner.X, corner.Y),
+                    static_cast<float>(corner.Score),
+                    level);
+            }
+
+            const std::chrono::steady_clock::time_point descriptionStartTime =
+                std::chrono::steady_clock::now();
+
+            _lastFrameTimings.DetectionTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(descriptionStartTime - detectionStartTime).count();
+
+            //
+            // The comparisons are made on the smoothed image, which makes them less
+            // sensitive to noise.
+            //
+            cv::GaussianBlur(
+                levelImage,
+                _smoothedLevel,
+                cv::Size(7, 7),
+                2.0,
+                2.0,
+                cv::BORDER_REFLECT_101);
+
+            for (size_t i = 0; i < _corners.size(); ++i)
+            {
+                ComputeDescriptor(
+                    _smoothedLevel,
+                    _corners[i].X,
+                    _corners[i].Y,
+                    features.Keypoints[firstKeypoint + i].angle,
+                    features.Descriptors.ptr<uint8_t>(numberOfFeatures + static_cast<int32_t>(i)));
+            }
+
+            numberOfFeatures += static_cast<int32_t>(_corners.size());
+
+            _lastFrameTimings.DescriptionTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - descriptionStartTime).count();
+        }
+
+        features.Descriptors.pop_back(
+            _options.MaximumNumberOfFeatures - numberOfFeatures);
+
+        _lastFrameTimings.TotalTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    /* static */ void FeatureExtractor::ComputeLuminance(
+        _In_ const cv::Mat& image,
+        _In_ int32_t downscaleFactor,
+        _Out_ cv::Mat& luminance)
+    {
+        REQUIRES(CV_8UC3 == image.type() || CV_8UC4 == image.type());
+        REQUIRES(downscaleFactor > 0);
+
+        //
+        // Converting first leaves a quarter of the data to downscale; both are linear, so
+        // the order does not matter.
+        //
+        if (1 == downscaleFactor)
+        {
+            cv::cvtColor(
+                image,
+                luminance,
+                (CV_8UC3 == image.type()) ? cv::COLOR_BGR2GRAY : cv::COLOR_BGRA2GRAY);
+
+            return;
+        }
+
+        cv::Mat fullResolutionLuminance;
+
+        cv::cvtColor(
+            image,
+            fullResolutionLuminance,
+            (CV_8UC3 == image.type()) ? cv::COLOR_BGR2GRAY : cv::COLOR_BGRA2GRAY);
+
+        cv::resize(
+            fullResolutionLuminance,
+            luminance,
+            cv::Size(image.cols / downscaleFactor, image.rows / downscaleFactor),
+            0.0,
+            0.0,
+            cv::INTER_AREA);
+    }
+
+    /* static */ uint32_t FeatureExtractor::ComputeHammingDistance(
+        _In_reads_(DescriptorSize) const uint8_t* a,
+        _In_reads_(DescriptorSize) const uint8_t* b)
+    {
+        uint64_t distance = 0;
+
+        for (int32_t i = 0; i < DescriptorSize; i += sizeof(uint64_t))
+        {
+            distance += CountBits(
+                ReadValue<uint64_t>(a + i) ^ ReadValue<uint64_t>(b + i));
+        }
+
+        return static_cast<uint32_t>(distance);
+    }
+
+    void FeatureExtractor::DetectCorners(
+        _In_ const cv::Mat& image,
+        _In_ int32_t border,
+        _Out_ std::vector<Corner>& corners)
+    {
+        corners.clear();
+
+        const int32_t width = image.cols;
+        const int32_t height = image.rows;
+        const int32_t threshold = _options.FastThreshold;
+
+        border = std::max(border, 3);
+
+        if (width <= 2 * border || height <= 2 * border)
+        {
+            return;
+        }
+
+        std::array<int32_t, c_circleWalkLength> offsets;
+
+        for (int32_t k = 0; k < c_circleWalkLength; ++k)
+        {
+            const cv::Point& point =
+                c_circle[k % c_circleSize];
+
+            offsets[k] = point.y * static_cast<int32_t>(image.step) + point.x;
+        }
+
+        //
+        // Scores (zero for non-corners) and corner columns of the last three rows, so that
+        // the corners of a row can be compared with their 8 neighbors once the next row
+        // is scored.
+        //
+        _scoreRows.assign(3 * width, 0);
+        _rowCorners.resize(3 * (width + 1));
+
+        for (int32_t slot = 0; slot < 3; ++slot)
+        {
+            _rowCorners[slot * (width + 1)] = 0;
+        }
+
+        const int32_t endColumn = width - border;
+
+        for (int32_t v = border; v <= height - border; ++v)
+        {
+            uint8_t* scores = &_scoreRows[(v % 3) * width];
+            int32_t* rowCorners = &_rowCorners[(v % 3) * (width + 1)];
+
+            memset(scores, 0, width);
+            rowCorners[0] = 0;
+
+            if (v < height - border)
+            {
+                const uint8_t* row =
+                    image.ptr<uint8_t>(v);
+
+                int32_t u = border;
+
+#if CV_SIMD128
+                if (endColumn - border >= 16)
+                {
+                    const cv::v_uint8x16 signFlip = cv::v_setall_u8(0x80);
+                    const cv::v_uint8x16 thresholds = cv::v_setall_u8(static_cast<uint8_t>(threshold));
+                    const cv::v_int8x16 arcLengthMinusOne = cv::v_setall_s8(c_arcLength - 1);
+
+                    for (; u < endColumn; u += 16)
+                    {
+                        //
+                        // The last block is moved left to end on the last column; only
+                        // the columns that were not tested yet are reported.
+                        //
+                        const int32_t blockStart =
+                            std::min(u, endColumn - 16);
+
+                        const uint8_t* center =
+                            row + blockStart;
+
+                        //
+                        // Unsigned values are compared as signed ones, once offset by 128.
+                        //
+                        const cv::v_uint8x16 centers = cv::v_load(center);
+
+                        const cv::v_int8x16 brighter =
+                            cv::v_reinterpret_as_s8((centers + thresholds) ^ signFlip);
+
+                        const cv::v_int8x16 darker =
+                            cv::v_reinterpret_as_s8((centers - thresholds) ^ signFlip);
+
+                        //
+                        // An arc of 9 pixels contains two consecutive pixels out of 0, 4,
+                        // 8 and 12: most pixels are rejected by testing those only.
+                        //
+                        const cv::v_int8x16 x0 = cv::v_reinterpret_as_s8(cv::v_load(center + offsets[0]) ^ signFlip);
+                        const cv::v_int8x16 x4 = cv::v_reinterpret_as_s8(cv::v_load(center + offsets[4]) ^ signFlip);
+                        const cv::v_int8x16 x8 = cv::v_reinterpret_as_s8(cv::v_load(center + offsets[8]) ^ signFlip);
+                        const cv::v_int8x16 x12 = cv::v_reinterpret_as_s8(cv::v_load(center + offsets[12]) ^ signFlip);
+
+                        const cv::v_int8x16 brighter0 = x0 > brighter;
+                        const cv::v_int8x16 brighter4 = x4 > brighter;
+                        const cv::v_int8x16 brighter8 = x8 > brighter;
+                        const cv::v_int8x16 brighter12 = x12 > brighter;
+
+                        const cv::v_int8x16 darker0 = darker > x0;
+                        const cv::v_int8x16 darker4 = darker > x4;
+                        const cv::v_int8x16 darker8 = darker > x8;
+                        const cv::v_int8x16 darker12 = darker > x12;
+
+                        const cv::v_int8x16 candidates =
+                            (brighter0 & brighter4) | (brighter4 & brighter8) | (brighter8 & brighter12) | (brighter12 & brighter0) |
+                            (darker0 & darker4) | (darker4 & darker8) | (darker8 & darker12) | (darker12 & darker0);
+
+                        if (!cv::v_check_any(candidates))
+                        {
+                            continue;
+                        }
+
+                        //
+                        // Longest runs of brighter and darker pixels along the circle: the
+                        // comparison masks are -1 where true, so subtracting them counts.
+                        //
+                        cv::v_int8x16 brighterRun = cv::v_setzero_s8();
+                        cv::v_int8x16 darkerRun = cv::v_setzero_s8();
+                        cv::v_int8x16 longestBrighterRun = cv::v_setzero_s8();
+                        cv::v_int8x16 longestDarkerRun = cv::v_setzero_s8();
+
+                        for (int32_t k = 0; k < c_circleWalkLength; ++k)
+                        {
+                            const cv::v_int8x16 x =
+                                cv::v_reinterpret_as_s8(cv::v_load(center + offsets[k]) ^ signFlip);
+
+                            const cv::v_int8x16 isBrighter = x > brighter;
+                            const cv::v_int8x16 isDarker = darker > x;
+
+                            brighterRun = (brighterRun - isBrighter) & isBrighter;
+                            darkerRun = (darkerRun - isDarker) & isDarker;
+
+                            longestBrighterRun = cv::v_max(longestBrighterRun, brighterRun);
+                            longestDarkerRun = cv::v_max(longestDarkerRun, darkerRun);
+                        }
+
+                        const int32_t cornerMask =
+                            cv::v_signmask(
+                                (longestBrighterRun > arcLengthMinusOne) |
+                                (longestDarkerRun > arcLengthMinusOne));
+
+                        if (0 == cornerMask)
+                        {
+                            continue;
+                        }
+
+                        for (int32_t i = 0; i < 16; ++i)
+                        {
+                            if (0 == (cornerMask & (1 << i)) ||
+                                blockStart + i < u)
+                            {
+                                continue;
+                            }
+
+                            const int32_t score =
+                                ComputeCornerScore(center + i, offsets.data(), threshold);
+
+                            scores[blockStart + i] =
+                                static_cast<uint8_t>(std::min(std::max(score, 1), 255));
+
+                            rowCorners[++rowCorners[0]] = blockStart + i;
+                        }
+                    }
+                }
+#endif /* CV_SIMD128 */
+
+                for (; u < endColumn; ++u)
+                {
+                    if (!IsCorner(row + u, offsets.data(), threshold))
+                    {
+                        continue;
+                    }
+
+                    const int32_t score =
+                        ComputeCornerScore(row + u, offsets.data(), threshold);
+
+                    scores[u] =
+                        static_cast<uint8_t>(std::min(std::max(score, 1), 255));
+
+                    rowCorners[++rowCorners[0]] = u;
+                }
+            }
+
+            //
+            // The corners of the previous row are kept if their score is higher than that
+            // of all their neighbors.
+            //
+            if (v == border)
+            {
+                continue;
+            }
+
+            const uint8_t* previousScores = &_scoreRows[((v - 1) % 3) * width];
+            const uint8_t* scoresAbove = &_scoreRows[((v - 2) % 3) * width];
+            const int32_t* previousRowCorners = &_rowCorners[((v - 1) % 3) * (width + 1)];
+
+            for (int32_t i = 1; i <= previousRowCorners[0]; ++i)
+            {
+                const int32_t u = previousRowCorners[i];
+                const uint8_t score = previousScores[u];
+
+                if (_options.NonMaximumSuppression &&
+                    (score <= previousScores[u - 1] || score <= previousScores[u + 1] ||
+                     score <= scoresAbove[u - 1] || score <= scoresAbove[u] || score <= scoresAbove[u + 1] ||
+                     score <= scores[u - 1] || score <= scores[u] || score <= scores[u + 1]))
+                {
+                    continue;
+                }
+
+                Corner corner;
+
+                corner.X = u;
+                corner.Y = v - 1;
+                corner.Score = score;
+                corner.Cell = 0;
+                corner.Rank = 0;
+
+                corners.push_back(corner);
+            }
+        }
+    }
+
+    void FeatureExtractor::SelectCorners(
+        _In_ int32_t maximumNumberOfCorners,
+        _Inout_ std::vector<Corner>& corners) const
+    {
+        if (corners.size() <= static_cast<size_t>(maximumNumberOfCorners))
+        {
+            return;
+        }
+
+        //
+        // Ranks the corners of each cell by decreasing score, then keeps the corners of
+        // lowest rank (the best corner of every cell first), the strongest ones first.
+        //
+        int32_t numberOfColumns = 0;
+
+        for (const Corner& corner : corners)
+        {
+            numberOfColumns = std::max(numberOfColumns, corner.X / _options.GridCellSize + 1);
+        }
+
+        for (Corner& corner : corners)
+        {
+            corner.Cell =
+                (corner.Y / _options.GridCellSize) * numberOfColumns + corner.X / _options.GridCellSize;
+        }
+
+        std::sort(
+            corners.begin(),
+            corners.end(),
+            [](const Corner& a, const Corner& b)
+        {
+            return (a.Cell != b.Cell) ? (a.Cell < b.Cell) : (a.Score > b.Score);
+        });
+
+        for (size_t i = 0; i < corners.size(); ++i)
+        {
+            corners[i].Rank =
+                (i > 0 && corners[i].Cell == corners[i - 1].Cell) ? corners[i - 1].Rank + 1 : 0;
+        }
+
+        std::nth_element(
+            corners.begin(),
+            corners.begin() + maximumNumberOfCorners,
+            corners.end(),
+            [](const Corner& a, const Corner& b)
+        {
+            return (a.Rank != b.Rank) ? (a.Rank < b.Rank) : (a.Score > b.Score);
+        });
+
+        corners.resize(
+            maximumNumberOfCorners);
+    }
+
+    float FeatureExtractor::ComputeOrientation(
+        _In_ const cv::Mat& image,
+        _In_ int32_t x,
+        _In_ int32_t y) const
+    {
+        const int32_t halfPatchSize = PatchSize / 2;
+        const int32_t step = static_cast<int32_t>(image.step);
+
+        const uint8_t* center =
+            image.ptr<uint8_t>(y) + x;
+
+        //
+        // First order moments of the circular patch, summing the rows above and below
+        // the center together.
+        //
+        int32_t m10 = 0;
+        int32_t m01 = 0;
+
+        for (int32_t u = -halfPatchSize; u <= halfPatchSize; ++u)
+        {
+            m10 += u * center[u];
+        }
+
+        for (int32_t v = 1; v <= halfPatchSize; ++v)
+        {
+            const int32_t halfWidth = _patchRowHalfWidths[v];
+
+            const uint8_t* below = center + v * step;
+            const uint8_t* above = center - v * step;
+
+            int32_t rowDifference = 0;
+
+            for (int32_t u = -halfWidth; u <= halfWidth; ++u)
+            {
+                rowDifference += below[u] - above[u];
+                m10 += u * (below[u] + above[u]);
+            }
+
+            m01 += v * rowDifference;
+        }
+
+        return cv::fastAtan2(
+            static_cast<float>(m01),
+            static_cast<float>(m10));
+    }
+
+    void FeatureExtractor::ComputeDescriptor(
+        _In_ const cv::Mat& smoothedImage,
+        _In_ int32_t x,
+        _In_ int32_t y,
+        _In_ float angle,
+        _Out_writes_(DescriptorSize) uint8_t* descriptor) const
+    {
+        const int32_t step = static_cast<int32_t>(smoothedImage.step);
+
+        const uint8_t* center =
+            smoothedImage.ptr<uint8_t>(y) + x;
+
+        const int32_t angleStep =
+            cvRound(angle * c_numberOfAngleSteps / 360.0f) % c_numberOfAngleSteps;
+
+        const int8_t* pattern =
+            _rotatedPatterns[angleStep].data();
+
+        for (int32_t i = 0; i < DescriptorSize; ++i)
+        {
+            uint32_t value = 0;
+
+            for (int32_t bit = 0; bit < 8; ++bit, pattern += 4)
+            {
+                const uint8_t first = center[pattern[1] * step + pattern[0]];
+                const uint8_t second = center[pattern[3] * step + pattern[2]];
+
+                value |= static_cast<uint32_t>(first < second) << bit;
+            }
+
+            descriptor[i] = static_cast<uint8_t>(value);
+        }
+    }
+
+    /* static */ bool FeatureExtractor::BenchmarkRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const Options& options,
+        _In_ size_t maximumNumberOfFramesPerCamera,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        statistics = BenchmarkStatistics();
+
+        const std::array<std::string, 4> sensorNames =
+        {
+            "vlc_ll", "vlc_lf", "vlc_rf", "vlc_rr"
+        };
+
+        std::array<BenchmarkStatistics, 4> cameraStatistics;
+
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        //
+        // The cameras are independent: each one is processed on its own thread, with its
+        // own extractor, as the sinks do on device.
+        //
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(sensorNames.size())),
+            [&](const cv::Range& range)
+        {
+            for (int32_t camera = range.start; camera < range.end; ++camera)
+            {
+                BenchmarkStatistics& cameraStatistic =
+                    cameraStatistics[camera];
+
+                SensorFrameRecordingReader reader;
+
+                if (!reader.Open(recordingFolder, sensorNames[camera]))
+                {
+                    continue;
+                }
+
+                std::unique_ptr<std::istream> archive =
+                    reader.OpenArchive();
+
+                FeatureExtractor extractor(options);
+
+                RecordedSensorFrame frame;
+                ImageFeatures features;
+
+                for (size_t frameIndex = 0; frameIndex < reader.GetNumberOfFrames(); ++frameIndex)
+                {
+                    if (0 != maximumNumberOfFramesPerCamera &&
+                        cameraStatistic.NumberOfFrames >= maximumNumberOfFramesPerCamera)
+                    {
+                        break;
+                    }
+
+                    if (!reader.ReadFrame(frameIndex, archive.get(), frame) ||
+                        CV_8UC1 != frame.Image.type())
+                    {
+                        continue;
+                    }
+
+                    extractor.Extract(
+                        frame.Image,
+                        features);
+
+                    const FrameTimings& timings =
+                        extractor.GetLastFrameTimings();
+
+                    ++cameraStatistic.NumberOfFrames;
+
+                    cameraStatistic.NumberOfFeatures += features.Keypoints.size();
+                    cameraStatistic.PyramidTimeInMilliseconds += timings.PyramidTimeInMilliseconds;
+                    cameraStatistic.DetectionTimeInMilliseconds += timings.DetectionTimeInMilliseconds;
+                    cameraStatistic.DescriptionTimeInMilliseconds += timings.DescriptionTimeInMilliseconds;
+                    cameraStatistic.TotalTimeInMilliseconds += timings.TotalTimeInMilliseconds;
+
+                    cameraStatistic.MaximumTotalTimeInMilliseconds =
+                        std::max(
+                            cameraStatistic.MaximumTotalTimeInMilliseconds,
+                            timings.TotalTimeInMilliseconds);
+                }
+            }
+        });
+
+        const double elapsedTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        for (const BenchmarkStatistics& cameraStatistic : cameraStatistics)
+        {
+            statistics.NumberOfFrames += cameraStatistic.NumberOfFrames;
+            statistics.NumberOfFeatures += cameraStatistic.NumberOfFeatures;
+            statistics.PyramidTimeInMilliseconds += cameraStatistic.PyramidTimeInMilliseconds;
+            statistics.DetectionTimeInMilliseconds += cameraStatistic.DetectionTimeInMilliseconds;
+            statistics.DescriptionTimeInMilliseconds += cameraStatistic.DescriptionTimeInMilliseconds;
+            statistics.TotalTimeInMilliseconds += cameraStatistic.TotalTimeInMilliseconds;
+
+            statistics.MaximumTotalTimeInMilliseconds =
+                std::max(
+                    statistics.MaximumTotalTimeInMilliseconds,
+                    cameraStatistic.MaximumTotalTimeInMilliseconds);
+        }
+
+        if (statistics.NumberOfFrames > 0)
+        {
+            const double scale = 1.0 / statistics.NumberOfFrames;
+
+            statistics.PyramidTimeInMilliseconds *= scale;
+            statistics.DetectionTimeInMilliseconds *= scale;
+            statistics.DescriptionTimeInMilliseconds *= scale;
+            statistics.TotalTimeInMilliseconds *= scale;
+
+            statistics.FramesPerSecond =
+                1000.0 * statistics.NumberOfFrames / std::max(elapsedTimeInMilliseconds, 1e-6);
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "FeatureExtractor",
+            dbg::LogLevel::Information,
+            L"FeatureExtractor::BenchmarkRecording: %llu frames, %.1f features/frame, %.3f ms/frame (pyramid %.3f, detection %.3f, description %.3f), max %.3f ms, %.1f frames/s",
+            statistics.NumberOfFrames,
+            (statistics.NumberOfFrames > 0) ? static_cast<double>(statistics.NumberOfFeatures) / statistics.NumberOfFrames : 0.0,
+            statistics.TotalTimeInMilliseconds,
+            statistics.PyramidTimeInMilliseconds,
+            statistics.DetectionTimeInMilliseconds,
+            statistics.DescriptionTimeInMilliseconds,
+            statistics.MaximumTotalTimeInMilliseconds,
+            statistics.FramesPerSecond);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return statistics.NumberOfFrames > 0;
+    }
+}
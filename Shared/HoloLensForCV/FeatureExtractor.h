@@ -0,0 +1,220 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Extracts ORB features (oriented FAST corners and rotated BRIEF descriptors) from
+    // 8-bit images.
+    //
+    // Corners are detected with the FAST-9 segment test, sixteen pixels at a time with
+    // SIMD instructions, on each level of a pyramid of half-size images, and are thinned
+    // by 3x3 non-maximum suppression on their score. The strongest corners are kept,
+    // spread over the image with a grid so that textured areas do not take them all. Each
+    // keypoint is oriented by the intensity centroid of its patch, and described by 256
+    // intensity comparisons on the smoothed image, rotated with the keypoint. The
+    // comparison pattern is drawn from a Gaussian around the keypoint with a fixed seed
+    // (as for BRIEF), so descriptors only compare with descriptors of this class.
+    //
+    // Color images (the photo video frames) are converted to a downscaled luminance
+    // image first; their keypoints are scaled back to the color image.
+    //
+    // An instance keeps scratch buffers between calls, so it must not be used by several
+    // threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class FeatureExtractor
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Minimum intensity difference between the center and the contiguous arc of
+            // the segment test.
+            int32_t FastThreshold;
+
+            bool NonMaximumSuppression;
+
+            // Spread over the pyramid levels in proportion to their area.
+            int32_t MaximumNumberOfFeatures;
+
+            // Each level is half the size of the previous one.
+            int32_t NumberOfLevels;
+
+            // Size, in pixels of each level, of the cells the strongest corners are
+            // selected from in turn.
+            int32_t GridCellSize;
+
+            // Downscaling of the luminance of color images.
+            int32_t ColorDownscaleFactor;
+        };
+
+        struct FrameTimings
+        {
+            FrameTimings();
+
+            double PyramidTimeInMilliseconds;
+            double DetectionTimeInMilliseconds;
+            double DescriptionTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+
+            // Corners found, before the selection of the strongest ones.
+            uint64_t NumberOfCorners;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfFeatures;
+
+            // Per-frame averages of each stage, and maximum total per-frame latency.
+            double PyramidTimeInMilliseconds;
+            double DetectionTimeInMilliseconds;
+            double DescriptionTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+            double MaximumTotalTimeInMilliseconds;
+
+            // Frames processed per second, all cameras together.
+            double FramesPerSecond;
+        };
+
+        static const int32_t DescriptorSize = ImageFeatures::DescriptorSize;
+
+        // Side of the square patch around a keypoint (at its pyramid level) that the
+        // orientation and the descriptor are computed from.
+        static const int32_t PatchSize = 31;
+
+        explicit FeatureExtractor(
+            _In_ const Options& options = Options());
+
+        const Options& GetOptions() const;
+
+        //
+        // Extracts the features of a CV_8UC1 image, or of the luminance of a CV_8UC3 (BGR)
+        // or CV_8UC4 (BGRA) image.
+        //
+        void Extract(
+            _In_ const cv::Mat& image,
+            _Out_ ImageFeatures& features);
+
+        //
+        // Extracts the features of the first level of an image pyramid, e.g. a sensor
+        // frame's, reusing its levels rather than downsampling the image again.
+        //
+        void Extract(
+            _In_ ImagePyramid& imagePyramid,
+            _Out_ ImageFeatures& features);
+
+        const FrameTimings& GetLastFrameTimings() const;
+
+        //
+        // Computes the luminance of a CV_8UC3 (BGR) or CV_8UC4 (BGRA) image, downscaled
+        // by the given factor.
+        //
+        static void ComputeLuminance(
+            _In_ const cv::Mat& image,
+            _In_ int32_t downscaleFactor,
+            _Out_ cv::Mat& luminance);
+
+        //
+        // Number of differing bits between two descriptors.
+        //
+        static uint32_t ComputeHammingDistance(
+            _In_reads_(DescriptorSize) const uint8_t* a,
+            _In_reads_(DescriptorSize) const uint8_t* b);
+
+        //
+        // Extracts the features of all the frames recorded for the four visible light
+        // cameras, one thread per camera. At most the given number of frames is processed
+        // per camera, zero to process them all.
+        //
+        static bool BenchmarkRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const Options& options,
+            _In_ size_t maximumNumberOfFramesPerCamera,
+            _Out_ BenchmarkStatistics& statistics);
+
+    private:
+        struct Corner
+        {
+            int32_t X;
+            int32_t Y;
+            int32_t Score;
+
+            // Index of the grid cell, and rank of the corner in its cell by score.
+            int32_t Cell;
+            int32_t Rank;
+        };
+
+        //
+        // Extracts the features of the levels of _pyramid, which are downscaled by the
+        // given factor relative to the input image.
+        //
+        void ExtractFromPyramid(
+            _In_ float imageScale,
+            _In_ const std::chrono::steady_clock::time_point& startTime,
+            _Out_ ImageFeatures& features);
+
+        //
+        // Finds the FAST corners of an image, ignoring a border of the given width.
+        //
+        void DetectCorners(
+            _In_ const cv::Mat& image,
+            _In_ int32_t border,
+            _Out_ std::vector<Corner>& corners);
+
+        //
+        // Keeps at most the given number of corners, taking the strongest corner of each
+        // grid cell in turn.
+        //
+        void SelectCorners(
+            _In_ int32_t maximumNumberOfCorners,
+            _Inout_ std::vector<Corner>& corners) const;
+
+        float ComputeOrientation(
+            _In_ const cv::Mat& image,
+            _In_ int32_t x,
+            _In_ int32_t y) const;
+
+        void ComputeDescriptor(
+            _In_ const cv::Mat& smoothedImage,
+            _In_ int32_t x,
+            _In_ int32_t y,
+            _In_ float angle,
+            _Out_writes_(DescriptorSize) uint8_t* descriptor) const;
+
+    private:
+        Options _options;
+
+        // Half-widths of the rows of the circular patch.
+        std::array<int32_t, PatchSize / 2 + 1> _patchRowHalfWidths;
+
+        // Comparison pattern, rotated by each multiple of the angle step, as (x, y)
+        // pairs: four values per comparison.
+        std::vector<std::vector<int8_t>> _rotatedPatterns;
+
+        // Scratch buffers.
+        cv::Mat _luminance;
+        std::vector<cv::Mat> _pyramid;
+        cv::Mat _smoothedLevel;
+        std::vector<uint8_t> _scoreRows;
+        std::vector<int32_t> _rowCorners;
+        std::vector<Corner> _corners;
+
+        FrameTimings _lastFrameTimings;
+    };
+}
@@ -0,0 +1,845 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Size of the header the ROSSensorFrameStreamingServer sends with each frame:
+        // timestamp, width, height, stride, pixel format and three 4x4 matrices.
+        //
+        const size_t c_rosSensorFrameHeaderSize = 8 + 4 * 4 + 3 * 16 * 4;
+
+        const size_t c_changedCellMaskSize = HeightMap::TileSize * HeightMap::TileSize / 8;
+
+        int32_t FloorDivide(
+            _In_ int32_t value,
+            _In_ int32_t divisor)
+        {
+            return (value >= 0) ? value / divisor : -((-value - 1) / divisor) - 1;
+        }
+
+        int32_t ToCell(
+            _In_ float coordinate,
+            _In_ float inverseCellSize)
+        {
+            return static_cast<int32_t>(std::floor(coordinate * inverseCellSize));
+        }
+
+        template <typename T>
+        void AppendValue(
+            _Inout_ std::vector<uint8_t>& buffer,
+            _In_ T value)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+
+            buffer.insert(
+                buffer.end(),
+                bytes,
+                bytes + sizeof(T));
+        }
+
+        template <typename T>
+        bool ReadValue(
+            _In_reads_bytes_(size) const uint8_t* data,
+            _In_ size_t size,
+            _Inout_ size_t& offset,
+            _Out_ T& value)
+        {
+            if (offset + sizeof(T) > size)
+            {
+                return false;
+            }
+
+            memcpy(&value, data + offset, sizeof(T));
+
+            offset += sizeof(T);
+
+            return true;
+        }
+    }
+
+    HeightMap::Options::Options()
+        : CellSizeInMeters(0.05f)
+        , FloorHeightInMeters(std::numeric_limits<float>::quiet_NaN())
+        , SensorHeightAboveFloorInMeters(1.6f)
+        , ObstacleMinimumHeightInMeters(0.1f)
+        , ObstacleMaximumHeightInMeters(2.0f)
+        , HitLogOdds(12)
+        , MissLogOdds(-6)
+        , MinimumLogOdds(-40)
+        , MaximumLogOdds(56)
+    {
+        Depth.MaximumDepthInMeters = 4.0f;
+    }
+
+    HeightMap::ReplayStatistics::ReplayStatistics()
+        : NumberOfFrames(0)
+        , NumberOfFramesWithoutPose(0)
+        , NumberOfTiles(0)
+        , ElapsedTimeInMilliseconds(0.0)
+        , PointCloudTimeInMilliseconds(0.0)
+        , IntegrationTimeInMilliseconds(0.0)
+        , SerializationTimeInMilliseconds(0.0)
+        , NumberOfUpdateBytes(0)
+        , NumberOfRawDepthBytes(0)
+    {
+    }
+
+    HeightMap::Tile::Tile()
+        : ModifiedUpdate(0)
+    {
+        LogOdds.fill(UnknownLogOdds);
+        Heights.fill(UnknownHeight);
+        ModifiedUpdates.fill(0);
+        ObservedUpdates.fill(0);
+    }
+
+    HeightMap::HeightMap(
+        _In_ const Options& options)
+        : _options(options)
+        , _floorHeight(options.FloorHeightInMeters)
+        , _updateIndex(0)
+    {
+        REQUIRES(
+            options.CellSizeInMeters > 0.0f &&
+            options.MinimumLogOdds > UnknownLogOdds &&
+            options.MinimumLogOdds <= 0 &&
+            options.MaximumLogOdds >= 0);
+    }
+
+    const HeightMap::Options& HeightMap::GetOptions() const
+    {
+        return _options;
+    }
+
+    float HeightMap::GetFloorHeight() const
+    {
+        return _floorHeight;
+    }
+
+    uint64_t HeightMap::Integrate(
+        _In_ const std::vector<cv::Point3f>& points,
+        _In_ const cv::Point3f& sensorPosition)
+    {
+        ++_updateIndex;
+
+        if (std::isnan(_floorHeight))
+        {
+            _floorHeight =
+                sensorPosition.y - _options.SensorHeightAboveFloorInMeters;
+        }
+
+        const float inverseCellSize = 1.0f / _options.CellSizeInMeters;
+        const float obstacleMinimumHeight = _floorHeight + _options.ObstacleMinimumHeightInMeters;
+        const float obstacleMaximumHeight = _floorHeight + _options.ObstacleMaximumHeightInMeters;
+
+        //
+        // Bin the points by cell. Consecutive points usually fall into the same cell, so
+        // the last cell is remembered to skip most of the hash map lookups.
+        //
+        _observations.clear();
+
+        uint64_t lastKey = 0;
+        CellObservation* lastObservation = nullptr;
+
+        for (const cv::Point3f& point : points)
+        {
+            if (point.y > obstacleMaximumHeight)
+            {
+                continue;
+            }
+
+            const uint64_t key =
+                PackCoordinates(
+                    ToCell(point.x, inverseCellSize),
+                    ToCell(point.z, inverseCellSize));
+
+            if (nullptr == lastObservation || key != lastKey)
+            {
+                const auto inserted =
+                    _observations.emplace(
+                        key,
+                        CellObservation{ point.y, false });
+
+                lastKey = key;
+                lastObservation = &inserted.first->second;
+            }
+
+            lastObservation->MaximumHeight =
+                std::max(lastObservation->MaximumHeight, point.y);
+
+            lastObservation->IsObstacle |=
+                point.y >= obstacleMinimumHeight;
+        }
+
+        //
+        // Update the observed cells first, so that the free space rays do not clear them.
+        //
+        const uint32_t observedUpdate =
+            static_cast<uint32_t>(_updateIndex);
+
+        for (const auto& observation : _observations)
+        {
+            int32_t cellX, cellZ;
+
+            UnpackCoordinates(
+                observation.first,
+                cellX,
+                cellZ);
+
+            const int32_t tileX = FloorDivide(cellX, TileSize);
+            const int32_t tileZ = FloorDivide(cellZ, TileSize);
+
+            Tile& tile =
+                *FindOrCreateTile(tileX, tileZ);
+
+            const int32_t cellIndex =
+                (cellZ - tileZ * TileSize) * TileSize + (cellX - tileX * TileSize);
+
+            tile.ObservedUpdates[cellIndex] = observedUpdate;
+
+            const float heightAboveFloor =
+                observation.second.MaximumHeight - _floorHeight;
+
+            UpdateCell(
+                tile,
+                cellIndex,
+                observation.second.IsObstacle ? _options.HitLogOdds : _options.MissLogOdds,
+                &heightAboveFloor);
+        }
+
+        for (const auto& observation : _observations)
+        {
+            int32_t cellX, cellZ;
+
+            UnpackCoordinates(
+                observation.first,
+                cellX,
+                cellZ);
+
+            CastFreeSpaceRay(
+                sensorPosition.x * inverseCellSize,
+                sensorPosition.z * inverseCellSize,
+                cellX,
+                cellZ);
+        }
+
+        return _updateIndex;
+    }
+
+    uint64_t HeightMap::GetUpdateIndex() const
+    {
+        return _updateIndex;
+    }
+
+    size_t HeightMap::GetNumberOfTiles() const
+    {
+        return _tiles.size();
+    }
+
+    bool HeightMap::GetCell(
+        _In_ float x,
+        _In_ float z,
+        _Out_ float& heightInMeters,
+        _Out_ float& occupancyProbability) const
+    {
+        heightInMeters = std::numeric_limits<float>::quiet_NaN();
+        occupancyProbability = 0.5f;
+
+        const float inverseCellSize = 1.0f / _options.CellSizeInMeters;
+
+        const int32_t cellX = ToCell(x, inverseCellSize);
+        const int32_t cellZ = ToCell(z, inverseCellSize);
+
+        const int32_t tileX = FloorDivide(cellX, TileSize);
+        const int32_t tileZ = FloorDivide(cellZ, TileSize);
+
+        const Tile* tile =
+            FindTile(tileX, tileZ);
+
+        if (nullptr == tile)
+        {
+            return false;
+        }
+
+        const int32_t cellIndex =
+            (cellZ - tileZ * TileSize) * TileSize + (cellX - tileX * TileSize);
+
+        if (UnknownLogOdds == tile->LogOdds[cellIndex])
+        {
+            return false;
+        }
+
+        if (UnknownHeight != tile->Heights[cellIndex])
+        {
+            heightInMeters = tile->Heights[cellIndex] * 0.001f;
+        }
+
+        occupancyProbability =
+            1.0f / (1.0f + std::exp(-tile->LogOdds[cellIndex] / 16.0f));
+
+        return true;
+    }
+
+    void HeightMap::RenderGrids(
+        _Out_ cv::Mat& heights,
+        _Out_ cv::Mat& occupancy,
+        _Out_ cv::Point& originCell) const
+    {
+        if (_tiles.empty())
+        {
+            heights.release();
+            occupancy.release();
+            originCell = cv::Point(0, 0);
+
+            return;
+        }
+
+        int32_t minimumTileX = INT32_MAX, minimumTileZ = INT32_MAX;
+        int32_t maximumTileX = INT32_MIN, maximumTileZ = INT32_MIN;
+
+        for (const auto& tile : _tiles)
+        {
+            int32_t tileX, tileZ;
+
+            UnpackCoordinates(
+                tile.first,
+                tileX,
+                tileZ);
+
+            minimumTileX = std::min(minimumTileX, tileX);
+            minimumTileZ = std::min(minimumTileZ, tileZ);
+            maximumTileX = std::max(maximumTileX, tileX);
+            maximumTileZ = std::max(maximumTileZ, tileZ);
+        }
+
+        originCell = cv::Point(
+            minimumTileX * TileSize,
+            minimumTileZ * TileSize);
+
+        heights.create(
+            (maximumTileZ - minimumTileZ + 1) * TileSize,
+            (maximumTileX - minimumTileX + 1) * TileSize,
+            CV_32FC1);
+
+        occupancy.create(
+            heights.size(),
+            CV_8SC1);
+
+        heights = std::numeric_limits<float>::quiet_NaN();
+        occupancy = -1;
+
+        //
+        // Occupancy probabilities, in percent, for all the possible log-odds.
+        //
+        std::array<int8_t, 256> percentages;
+
+        for (int32_t logOdds = INT8_MIN; logOdds <= INT8_MAX; ++logOdds)
+        {
+            percentages[static_cast<uint8_t>(logOdds)] =
+                static_cast<int8_t>(std::lround(100.0 / (1.0 + std::exp(-logOdds / 16.0))));
+        }
+
+        percentages[static_cast<uint8_t>(UnknownLogOdds)] = -1;
+
+        for (const auto& entry : _tiles)
+        {
+            int32_t tileX, tileZ;
+
+            UnpackCoordinates(
+                entry.first,
+                tileX,
+                tileZ);
+
+            const Tile& tile = *entry.second;
+
+            for (int32_t row = 0; row < TileSize; ++row)
+            {
+                float* heightRow =
+                    heights.ptr<float>((tileZ - minimumTileZ) * TileSize + row) + (tileX - minimumTileX) * TileSize;
+
+                int8_t* occupancyRow =
+                    occupancy.ptr<int8_t>((tileZ - minimumTileZ) * TileSize + row) + (tileX - minimumTileX) * TileSize;
+
+                for (int32_t column = 0; column < TileSize; ++column)
+                {
+                    const int32_t cellIndex = row * TileSize + column;
+
+                    if (UnknownHeight != tile.Heights[cellIndex])
+                    {
+                        heightRow[column] = tile.Heights[cellIndex] * 0.001f;
+                    }
+
+                    occupancyRow[column] =
+                        percentages[static_cast<uint8_t>(tile.LogOdds[cellIndex])];
+                }
+            }
+        }
+    }
+
+    size_t HeightMap::SerializeUpdates(
+        _In_ uint64_t sinceUpdate,
+        _Out_ std::vector<uint8_t>& buffer) const
+    {
+        buffer.clear();
+
+        AppendValue(buffer, UpdateCookie);
+        AppendValue(buffer, UpdateVersion);
+        AppendValue(buffer, _updateIndex);
+        AppendValue(buffer, sinceUpdate);
+        AppendValue(buffer, _options.CellSizeInMeters);
+        AppendValue(buffer, _floorHeight);
+        AppendValue(buffer, static_cast<uint32_t>(TileSize));
+
+        const size_t numberOfTilesOffset = buffer.size();
+
+        AppendValue(buffer, static_cast<uint32_t>(0));
+
+        const uint32_t sinceCellUpdate =
+            static_cast<uint32_t>(sinceUpdate);
+
+        uint32_t numberOfTiles = 0;
+
+        for (const auto& entry : _tiles)
+        {
+            const Tile& tile = *entry.second;
+
+            if (tile.ModifiedUpdate <= sinceUpdate)
+            {
+                continue;
+            }
+
+            int32_t tileX, tileZ;
+
+            UnpackCoordinates(
+                entry.first,
+                tileX,
+                tileZ);
+
+            AppendValue(buffer, tileX);
+            AppendValue(buffer, tileZ);
+
+            const size_t maskOffset = buffer.size();
+
+            buffer.resize(
+                buffer.size() + c_changedCellMaskSize,
+                0);
+
+            for (int32_t cellIndex = 0; cellIndex < CellsPerTile; ++cellIndex)
+            {
+                if (tile.ModifiedUpdates[cellIndex] <= sinceCellUpdate)
+                {
+                    continue;
+                }
+
+                buffer[maskOffset + cellIndex / 8] |=
+                    static_cast<uint8_t>(1 << (cellIndex % 8));
+
+                AppendValue(buffer, tile.LogOdds[cellIndex]);
+                AppendValue(buffer, tile.Heights[cellIndex]);
+            }
+
+            ++numberOfTiles;
+        }
+
+        memcpy(
+            buffer.data() + numberOfTilesOffset,
+            &numberOfTiles,
+            sizeof(numberOfTiles));
+
+        return numberOfTiles;
+    }
+
+    bool HeightMap::ApplyUpdates(
+        _In_reads_bytes_(size) const uint8_t* data,
+        _In_ size_t size)
+    {
+        size_t offset = 0;
+
+        uint32_t cookie = 0, version = 0, tileSize = 0, numberOfTiles = 0;
+        uint64_t updateIndex = 0, sinceUpdate = 0;
+        float cellSize = 0.0f, floorHeight = 0.0f;
+
+        if (!ReadValue(data, size, offset, cookie) ||
+            !ReadValue(data, size, offset, version) ||
+            !ReadValue(data, size, offset, updateIndex) ||
+            !ReadValue(data, size, offset, sinceUpdate) ||
+            !ReadValue(data, size, offset, cellSize) ||
+            !ReadValue(data, size, offset, floorHeight) ||
+            !ReadValue(data, size, offset, tileSize) ||
+            !ReadValue(data, size, offset, numberOfTiles) ||
+            UpdateCookie != cookie ||
+            UpdateVersion != version ||
+            static_cast<uint32_t>(TileSize) != tileSize ||
+            cellSize != _options.CellSizeInMeters)
+        {
+            return false;
+        }
+
+        _floorHeight = floorHeight;
+        _updateIndex = std::max(_updateIndex, updateIndex);
+
+        const uint32_t modifiedUpdate =
+            static_cast<uint32_t>(_updateIndex);
+
+        for (uint32_t i = 0; i < numberOfTiles; ++i)
+        {
+            int32_t tileX = 0, tileZ = 0;
+
+            if (!ReadValue(data, size, offset, tileX) ||
+                !ReadValue(data, size, offset, tileZ) ||
+                offset + c_changedCellMaskSize > size)
+            {
+                return false;
+            }
+
+            const uint8_t* mask = data + offset;
+
+            offset += c_changedCellMaskSize;
+
+            Tile& tile =
+                *FindOrCreateTile(tileX, tileZ);
+
+            tile.ModifiedUpdate = _updateIndex;
+
+            for (int32_t cellIndex = 0; cellIndex < CellsPerTile; ++cellIndex)
+            {
+                if (0 == (mask[cellIndex / 8] & (1 << (cellIndex % 8))))
+                {
+                    continue;
+                }
+
+                if (!ReadValue(data, size, offset, tile.LogOdds[cellIndex]) ||
+                    !ReadValue(data, size, offset, tile.Heights[cellIndex]))
+                {
+                    return false;
+                }
+
+                tile.ModifiedUpdates[cellIndex] = modifiedUpdate;
+            }
+        }
+
+        return offset == size;
+    }
+
+    /* static */ bool HeightMap::ReplayRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName,
+        _In_ const Options& options,
+        _Out_ ReplayStatistics& statistics)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        statistics = ReplayStatistics();
+
+        SensorFrameRecordingReader reader;
+
+        if (!reader.Open(recordingFolder, sensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> archive =
+            reader.OpenArchive();
+
+        RecordedSensorFrame frame;
+
+        if (!reader.ReadFrame(0, archive.get(), frame))
+        {
+            return false;
+        }
+
+        cv::Mat unitPlaneMap;
+
+        if (!PointCloudGenerator::LoadUnitPlaneMap(
+                recordingFolder,
+                sensorName,
+                frame.Image.cols,
+                frame.Image.rows,
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        const PointCloudGenerator generator(
+            unitPlaneMap);
+
+        HeightMap heightMap(
+            options);
+
+        std::vector<cv::Point3f> points;
+        std::vector<uint8_t> updates;
+
+        for (size_t i = 0; i < reader.GetNumberOfFrames(); ++i)
+        {
+            if (!reader.ReadFrame(i, archive.get(), frame) ||
+                CV_16UC1 != frame.Image.type() ||
+                frame.Image.size() != unitPlaneMap.size())
+            {
+                continue;
+            }
+
+            cv::Matx44f cameraToWorld;
+
+            if (!PointCloudGenerator::ComputeCameraToWorld(
+                    frame.FrameToOrigin,
+                    frame.CameraViewTransform,
+                    cameraToWorld))
+            {
+                ++statistics.NumberOfFramesWithoutPose;
+                continue;
+            }
+
+            ++statistics.NumberOfFrames;
+
+            Clock::time_point stageStartTime =
+                Clock::now();
+
+            generator.Compute(
+                frame.Image,
+                cameraToWorld,
+                options.Depth,
+                points);
+
+            statistics.PointCloudTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - stageStartTime).count();
+
+            stageStartTime = Clock::now();
+
+            const uint64_t previousUpdate =
+                heightMap.GetUpdateIndex();
+
+            heightMap.Integrate(
+                points,
+                cv::Point3f(
+                    cameraToWorld(0, 3),
+                    cameraToWorld(1, 3),
+                    cameraToWorld(2, 3)));
+
+            statistics.IntegrationTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - stageStartTime).count();
+
+            stageStartTime = Clock::now();
+
+            heightMap.SerializeUpdates(
+                previousUpdate,
+                updates);
+
+            statistics.SerializationTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - stageStartTime).count();
+
+            statistics.NumberOfUpdateBytes += updates.size();
+
+            statistics.NumberOfRawDepthBytes +=
+                c_rosSensorFrameHeaderSize + frame.Image.total() * frame.Image.elemSize();
+        }
+
+        statistics.NumberOfTiles =
+            heightMap.GetNumberOfTiles();
+
+        statistics.ElapsedTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(
+                Clock::now() - startTime).count();
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "HeightMap",
+            dbg::LogLevel::Information,
+            L"HeightMap::ReplayRecording: %S: %llu frames, %.3f ms/frame integration, %llu tiles, %.1f KB of updates vs %.1f KB of depth frames",
+            sensorName.c_str(),
+            statistics.NumberOfFrames,
+            statistics.NumberOfFrames ? statistics.IntegrationTimeInMilliseconds / statistics.NumberOfFrames : 0.0,
+            statistics.NumberOfTiles,
+            statistics.NumberOfUpdateBytes / 1024.0,
+            statistics.NumberOfRawDepthBytes / 1024.0);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return statistics.NumberOfFrames > 0;
+    }
+
+    /* static */ uint64_t HeightMap::PackCoordinates(
+        _In_ int32_t x,
+        _In_ int32_t z)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+            static_cast<uint64_t>(static_cast<uint32_t>(z));
+    }
+
+    /* static */ void HeightMap::UnpackCoordinates(
+        _In_ uint64_t key,
+        _Out_ int32_t& x,
+        _Out_ int32_t& z)
+    {
+        x = static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+        z = static_cast<int32_t>(static_cast<uint32_t>(key));
+    }
+
+    HeightMap::Tile* HeightMap::FindTile(
+        _In_ int32_t tileX,
+        _In_ int32_t tileZ) const
+    {
+        const auto tile =
+            _tiles.find(
+                PackCoordinates(tileX, tileZ));
+
+        return (_tiles.end() != tile) ? tile->second.get() : nullptr;
+    }
+
+    HeightMap::Tile* HeightMap::FindOrCreateTile(
+        _In_ int32_t tileX,
+        _In_ int32_t tileZ)
+    {
+        std::unique_ptr<Tile>& tile =
+            _tiles[PackCoordinates(tileX, tileZ)];
+
+        if (nullptr == tile)
+        {
+            tile.reset(new Tile());
+        }
+
+        return tile.get();
+    }
+
+    void HeightMap::UpdateCell(
+        _Inout_ Tile& tile,
+        _In_ int32_t cellIndex,
+        _In_ int32_t logOddsChange,
+        _In_ const float* heightInMeters)
+    {
+        const int8_t previousLogOdds =
+            tile.LogOdds[cellIndex];
+
+        const int8_t logOdds =
+            static_cast<int8_t>(
+                std::max<int32_t>(
+                    _options.MinimumLogOdds,
+                    std::min<int32_t>(
+                        _options.MaximumLogOdds,
+                        ((UnknownLogOdds == previousLogOdds) ? 0 : previousLogOdds) + logOddsChange)));
+
+        int16_t height =
+            tile.Heights[cellIndex];
+
+        if (nullptr != heightInMeters)
+        {
+            height =
+                static_cast<int16_t>(
+                    std::max<long>(
+                        UnknownHeight + 1,
+                        std::min<long>(
+                            INT16_MAX,
+                            std::lround(*heightInMeters * 1000.0f))));
+        }
+
+        if (logOdds == previousLogOdds && height == tile.Heights[cellIndex])
+        {
+            return;
+        }
+
+        tile.LogOdds[cellIndex] = logOdds;
+        tile.Heights[cellIndex] = height;
+        tile.ModifiedUpdates[cellIndex] = static_cast<uint32_t>(_updateIndex);
+        tile.ModifiedUpdate = _updateIndex;
+    }
+
+    void HeightMap::CastFreeSpaceRay(
+        _In_ float startX,
+        _In_ float startZ,
+        _In_ int32_t endCellX,
+        _In_ int32_t endCellZ)
+    {
+        //
+        // Walk the cells from the sensor to the center of the end cell (excluded), one
+        // cell boundary at a time.
+        //
+        const float deltaX = (endCellX + 0.5f) - startX;
+        const float deltaZ = (endCellZ + 0.5f) - startZ;
+
+        int32_t cellX = static_cast<int32_t>(std::floor(startX));
+        int32_t cellZ = static_cast<int32_t>(std::floor(startZ));
+
+        const int32_t stepX = (deltaX > 0.0f) ? 1 : -1;
+        const int32_t stepZ = (deltaZ > 0.0f) ? 1 : -1;
+
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        const float tDeltaX = (0.0f != deltaX) ? std::abs(1.0f / deltaX) : infinity;
+        const float tDeltaZ = (0.0f != deltaZ) ? std::abs(1.0f / deltaZ) : infinity;
+
+        float tMaxX =
+            (deltaX > 0.0f) ? (cellX + 1 - startX) * tDeltaX :
+            (deltaX < 0.0f) ? (startX - cellX) * tDeltaX : infinity;
+
+        float tMaxZ =
+            (deltaZ > 0.0f) ? (cellZ + 1 - startZ) * tDeltaZ :
+            (deltaZ < 0.0f) ? (startZ - cellZ) * tDeltaZ : infinity;
+
+        const uint32_t observedUpdate =
+            static_cast<uint32_t>(_updateIndex);
+
+        int32_t maximumNumberOfSteps =
+            std::abs(endCellX - cellX) + std::abs(endCellZ - cellZ);
+
+        int32_t tileX = INT32_MIN, tileZ = INT32_MIN;
+        Tile* tile = nullptr;
+
+        while ((cellX != endCellX || cellZ != endCellZ) && maximumNumberOfSteps-- > 0)
+        {
+            const int32_t cellTileX = FloorDivide(cellX, TileSize);
+            const int32_t cellTileZ = FloorDivide(cellZ, TileSize);
+
+            if (cellTileX != tileX || cellTileZ != tileZ)
+            {
+                tileX = cellTileX;
+                tileZ = cellTileZ;
+                tile = FindOrCreateTile(tileX, tileZ);
+            }
+
+            const int32_t cellIndex =
+                (cellZ - tileZ * TileSize) * TileSize + (cellX - tileX * TileSize);
+
+            //
+            // Each cell is updated at most once per frame.
+            //
+            if (observedUpdate != tile->ObservedUpdates[cellIndex])
+            {
+                tile->ObservedUpdates[cellIndex] = observedUpdate;
+
+                UpdateCell(
+                    *tile,
+                    cellIndex,
+                    _options.MissLogOdds,
+                    nullptr);
+            }
+
+            if (tMaxX < tMaxZ)
+            {
+                tMaxX += tDeltaX;
+                cellX += stepX;
+            }
+            else
+            {
+                tMaxZ += tDeltaZ;
+                cellZ += stepZ;
+            }
+        }
+    }
+}
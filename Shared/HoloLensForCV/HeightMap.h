@@ -0,0 +1,234 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Incremental 2.5D map of the surroundings, built from world-space depth points: a grid
+    // over the horizontal (X, Z) plane of the world coordinate system, whose cells hold the
+    // height of the highest surface observed in them and an occupancy log-odds.
+    //
+    // Cells are grouped in square tiles, allocated on demand and stored in a hash map, so
+    // that the cells of a tile are contiguous in memory. Cells holding points above the
+    // floor are marked as occupied; the cells crossed by the (horizontal projection of the)
+    // rays from the sensor to the observed cells are marked as free.
+    //
+    // Every integration increments the update index, and cells remember the last update
+    // that changed them. SerializeUpdates packs the cells changed since a given update,
+    // which is much smaller than the depth frames they were computed from:
+    //
+    //   uint32 cookie ('HLHM'), uint32 version, uint64 update index, uint64 since update,
+    //   float cell size (m), float floor height (m), uint32 tile size, uint32 tile count,
+    //
+    // followed for each tile by:
+    //
+    //   int32 tile x, int32 tile z, uint8[tile size^2 / 8] changed cell mask (row-major,
+    //   least significant bit first), then for each changed cell: int8 log-odds, int16
+    //   height above the floor (mm).
+    //
+    // All values are little-endian. Cells that were never observed have a log-odds of
+    // -128 and a height of -32768.
+    //
+    // An instance must not be used by several threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class HeightMap
+    {
+    public:
+        // Cells per tile side.
+        static const int32_t TileSize = 32;
+
+        static const int8_t UnknownLogOdds = INT8_MIN;
+        static const int16_t UnknownHeight = INT16_MIN;
+
+        static const uint32_t UpdateCookie = 0x4d484c48; // 'HLHM'
+        static const uint32_t UpdateVersion = 1;
+
+        struct Options
+        {
+            Options();
+
+            float CellSizeInMeters;
+
+            // Height of the floor in the world coordinate system. If NaN, it is estimated
+            // from the first sensor position, assuming the sensor is worn at the given
+            // height above the floor.
+            float FloorHeightInMeters;
+            float SensorHeightAboveFloorInMeters;
+
+            // Points between these heights above the floor are obstacles. Points below are
+            // floor, and points above (e.g. the ceiling) are ignored.
+            float ObstacleMinimumHeightInMeters;
+            float ObstacleMaximumHeightInMeters;
+
+            // Occupancy log-odds, in 1/16 nats: added for each frame in which a cell is seen
+            // occupied (or free), and saturated to the given range.
+            int8_t HitLogOdds;
+            int8_t MissLogOdds;
+            int8_t MinimumLogOdds;
+            int8_t MaximumLogOdds;
+
+            // Depth range and scale, used when building the map from depth frames.
+            PointCloudGenerator::Options Depth;
+        };
+
+        struct ReplayStatistics
+        {
+            ReplayStatistics();
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfFramesWithoutPose;
+            uint64_t NumberOfTiles;
+
+            double ElapsedTimeInMilliseconds;
+            double PointCloudTimeInMilliseconds;
+            double IntegrationTimeInMilliseconds;
+            double SerializationTimeInMilliseconds;
+
+            // Sum of the per-frame updates, and of the depth frames as sent by the
+            // ROSSensorFrameStreamingServer.
+            uint64_t NumberOfUpdateBytes;
+            uint64_t NumberOfRawDepthBytes;
+        };
+
+        explicit HeightMap(
+            _In_ const Options& options = Options());
+
+        const Options& GetOptions() const;
+
+        float GetFloorHeight() const;
+
+        //
+        // Integrates the world-space points of a frame, observed from the given sensor
+        // position. Returns the new update index.
+        //
+        uint64_t Integrate(
+            _In_ const std::vector<cv::Point3f>& points,
+            _In_ const cv::Point3f& sensorPosition);
+
+        uint64_t GetUpdateIndex() const;
+
+        size_t GetNumberOfTiles() const;
+
+        //
+        // Looks up the cell containing a world position: height above the floor and
+        // probability of being occupied. Returns false if the cell has never been observed.
+        //
+        bool GetCell(
+            _In_ float x,
+            _In_ float z,
+            _Out_ float& heightInMeters,
+            _Out_ float& occupancyProbability) const;
+
+        //
+        // Renders the map as images covering all the tiles: heights above the floor in
+        // meters (CV_32FC1, NaN if unknown) and occupancy in the ROS convention (CV_8SC1,
+        // 0 to 100, -1 if unknown). Row r, column c is the cell (origin.x + c, origin.y + r).
+        //
+        void RenderGrids(
+            _Out_ cv::Mat& heights,
+            _Out_ cv::Mat& occupancy,
+            _Out_ cv::Point& originCell) const;
+
+        //
+        // Serializes the cells changed since the given update (0 for the whole map).
+        // Returns the number of tiles written.
+        //
+        size_t SerializeUpdates(
+            _In_ uint64_t sinceUpdate,
+            _Out_ std::vector<uint8_t>& buffer) const;
+
+        //
+        // Applies serialized updates, e.g. to mirror a remote map. Fails if the buffer is
+        // malformed or was produced with a different cell or tile size.
+        //
+        bool ApplyUpdates(
+            _In_reads_bytes_(size) const uint8_t* data,
+            _In_ size_t size);
+
+        //
+        // Builds the map from all the frames recorded for a depth sensor, serializing the
+        // updates after each frame, and compares their size with the depth frames.
+        //
+        static bool ReplayRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName,
+            _In_ const Options& options,
+            _Out_ ReplayStatistics& statistics);
+
+    private:
+        static const int32_t CellsPerTile = TileSize * TileSize;
+
+        struct Tile
+        {
+            Tile();
+
+            std::array<int8_t, CellsPerTile> LogOdds;
+            std::array<int16_t, CellsPerTile> Heights;
+
+            // Last update that changed each cell, and last update that observed it.
+            std::array<uint32_t, CellsPerTile> ModifiedUpdates;
+            std::array<uint32_t, CellsPerTile> ObservedUpdates;
+
+            uint64_t ModifiedUpdate;
+        };
+
+        struct CellObservation
+        {
+            float MaximumHeight;
+            bool IsObstacle;
+        };
+
+        static uint64_t PackCoordinates(
+            _In_ int32_t x,
+            _In_ int32_t z);
+
+        static void UnpackCoordinates(
+            _In_ uint64_t key,
+            _Out_ int32_t& x,
+            _Out_ int32_t& z);
+
+        Tile* FindTile(
+            _In_ int32_t tileX,
+            _In_ int32_t tileZ) const;
+
+        Tile* FindOrCreateTile(
+            _In_ int32_t tileX,
+            _In_ int32_t tileZ);
+
+        void UpdateCell(
+            _Inout_ Tile& tile,
+            _In_ int32_t cellIndex,
+            _In_ int32_t logOddsChange,
+            _In_ const float* heightInMeters);
+
+        void CastFreeSpaceRay(
+            _In_ float startX,
+            _In_ float startZ,
+            _In_ int32_t endCellX,
+            _In_ int32_t endCellZ);
+
+    private:
+        Options _options;
+
+        float _floorHeight;
+
+        uint64_t _updateIndex;
+
+        std::unordered_map<uint64_t, std::unique_ptr<Tile>> _tiles;
+
+        // Scratch: the cells observed in the current frame.
+        std::unordered_map<uint64_t, CellObservation> _observations;
+    };
+}
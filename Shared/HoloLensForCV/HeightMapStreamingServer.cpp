@@ -0,0 +1,268 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        HeightMap::Options GetHeightMapOptions(
+            _In_ SensorType sensorType)
+        {
+            HeightMap::Options options;
+
+            options.Depth =
+                PointCloudGenerator::GetDefaultOptions(
+                    (SensorType::LongThrowToFDepth == sensorType) ?
+                        "long_throw_depth" :
+                        "short_throw_depth");
+
+            return options;
+        }
+
+        std::array<float, 16> ToArray(
+            _In_ const Windows::Foundation::Numerics::float4x4& matrix)
+        {
+            std::array<float, 16> values;
+
+            static_assert(
+                sizeof(values) == sizeof(matrix),
+                "float4x4 must hold 16 contiguous floats");
+
+            memcpy(
+                values.data(),
+                &matrix,
+                sizeof(values));
+
+            return values;
+        }
+    }
+
+    HeightMapStreamingServer::HeightMapStreamingServer(
+        _In_ Platform::String^ serviceName,
+        _In_ SensorType sensorType)
+        : _writeInProgress(false)
+        , _heightMap(GetHeightMapOptions(sensorType))
+        , _lastSentUpdate(0)
+    {
+        _listener = ref new Windows::Networking::Sockets::StreamSocketListener();
+
+        _listener->ConnectionReceived +=
+            ref new Windows::Foundation::TypedEventHandler<
+            Windows::Networking::Sockets::StreamSocketListener^,
+            Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^>(
+                this,
+                &HeightMapStreamingServer::OnConnection);
+
+        _listener->Control->KeepAlive = true;
+
+        Concurrency::create_task(_listener->BindServiceNameAsync(serviceName)).then(
+            [this](Concurrency::task<void> previousTask)
+            {
+                try
+                {
+                    previousTask.get();
+                }
+                catch (Platform::Exception^ exception)
+                {
+#if DBG_ENABLE_ERROR_LOGGING
+                    DBG_LOG(
+                        "HeightMapStreamingServer",
+                        dbg::LogLevel::Error,
+                        L"HeightMapStreamingServer::HeightMapStreamingServer: %s",
+                        exception->Message->Data());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+                }
+            });
+    }
+
+    HeightMapStreamingServer::~HeightMapStreamingServer()
+    {
+        delete _listener;
+        _listener = nullptr;
+    }
+
+    void HeightMapStreamingServer::OnConnection(
+        Windows::Networking::Sockets::StreamSocketListener^ listener,
+        Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^ object)
+    {
+        _socket = object->Socket;
+
+        _writer = ref new Windows::Storage::Streams::DataWriter(_socket->OutputStream);
+        _writer->ByteOrder = Windows::Storage::Streams::ByteOrder::LittleEndian;
+        _writeInProgress = false;
+
+        //
+        // A new client starts from an empty map: send it everything.
+        //
+        _lastSentUpdate = 0;
+    }
+
+    void HeightMapStreamingServer::Send(
+        SensorFrame^ sensorFrame)
+    {
+        if (_previousTimestamp.UniversalTime.Equals(sensorFrame->Timestamp.UniversalTime))
+        {
+            return;
+        }
+
+        _previousTimestamp = sensorFrame->Timestamp;
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ bitmap =
+            sensorFrame->SoftwareBitmap;
+
+        if (nullptr == bitmap ||
+            Windows::Graphics::Imaging::BitmapPixelFormat::Gray16 != bitmap->BitmapPixelFormat)
+        {
+            return;
+        }
+
+        if (nullptr == _pointCloudGenerator &&
+            !CreatePointCloudGenerator(sensorFrame->SensorStreamingCameraIntrinsics))
+        {
+            return;
+        }
+
+        cv::Matx44f cameraToWorld;
+
+        if (!PointCloudGenerator::ComputeCameraToWorld(
+                ToArray(sensorFrame->FrameToOrigin),
+                ToArray(sensorFrame->CameraViewTransform),
+                cameraToWorld))
+        {
+            return;
+        }
+
+        DBG_PROFILE_SPAN_REPORT_OVER(
+            "HeightMapStreamingServer::Send: height map update",
+            10.0 /* minimum_time_elapsed_in_milliseconds */);
+
+        {
+            Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+                bitmap->LockBuffer(
+                    Windows::Graphics::Imaging::BitmapBufferAccessMode::Read);
+
+            const Windows::Graphics::Imaging::BitmapPlaneDescription planeDescription =
+                bitmapBuffer->GetPlaneDescription(0);
+
+            Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+                bitmapBuffer->CreateReference();
+
+            uint32_t bitmapBufferSize = 0;
+
+            uint8_t* bitmapBufferData =
+                Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                    bitmapBufferReference,
+                    bitmapBufferSize);
+
+            const cv::Mat depth(
+                planeDescription.Height,
+                planeDescription.Width,
+                CV_16UC1,
+                bitmapBufferData + planeDescription.StartIndex,
+                planeDescription.Stride);
+
+            if (depth.cols == _pointCloudGenerator->GetImageWidth() &&
+                depth.rows == _pointCloudGenerator->GetImageHeight())
+            {
+                _pointCloudGenerator->Compute(
+                    depth,
+                    cameraToWorld,
+                    _heightMap.GetOptions().Depth,
+                    _points);
+            }
+            else
+            {
+                _points.clear();
+            }
+
+            delete bitmapBufferReference;
+            delete bitmapBuffer;
+        }
+
+        _heightMap.Integrate(
+            _points,
+            cv::Point3f(
+                cameraToWorld(0, 3),
+                cameraToWorld(1, 3),
+                cameraToWorld(2, 3)));
+
+        if (nullptr == _socket || _writeInProgress)
+        {
+            //
+            // The next message will include the changes of this frame.
+            //
+            return;
+        }
+
+        _heightMap.SerializeUpdates(
+            _lastSentUpdate,
+            _updates);
+
+        _lastSentUpdate =
+            _heightMap.GetUpdateIndex();
+
+        _writeInProgress = true;
+
+        _writer->WriteUInt32(
+            static_cast<uint32_t>(_updates.size()));
+
+        _writer->WriteBytes(
+            Platform::ArrayReference<uint8_t>(
+                _updates.data(),
+                static_cast<unsigned int>(_updates.size())));
+
+        Concurrency::create_task(_writer->StoreAsync()).then(
+            [&](Concurrency::task<unsigned int> writeTask)
+            {
+                try
+                {
+                    writeTask.get();
+                    _writeInProgress = false;
+                }
+                catch (Platform::Exception^ exception)
+                {
+#if DBG_ENABLE_ERROR_LOGGING
+                    DBG_LOG(
+                        "HeightMapStreamingServer",
+                        dbg::LogLevel::Error,
+                        L"HeightMapStreamingServer::Send: StoreAsync call failed with error: %s",
+                        exception->Message->Data());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+                    _socket = nullptr;
+                }
+            });
+    }
+
+    bool HeightMapStreamingServer::CreatePointCloudGenerator(
+        _In_ CameraIntrinsics^ cameraIntrinsics)
+    {
+        if (nullptr == cameraIntrinsics)
+        {
+            return false;
+        }
+
+        cv::Mat unitPlaneMap;
+
+        if (!cameraIntrinsics->ComputeUnitPlaneMap(
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        _pointCloudGenerator.reset(
+            new PointCloudGenerator(
+                unitPlaneMap));
+
+        return true;
+    }
+}
@@ -0,0 +1,57 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Integrates the frames of a depth sensor into a HeightMap and streams the changed
+    // tiles to the connected client instead of the depth frames. Each message is a
+    // uint32 length followed by the output of HeightMap::SerializeUpdates; the first
+    // message after a connection holds the whole map.
+    //
+    public ref class HeightMapStreamingServer sealed
+        : public ISensorFrameSink
+    {
+    public:
+        HeightMapStreamingServer(
+            _In_ Platform::String^ serviceName,
+            _In_ SensorType sensorType);
+
+        virtual void Send(
+            SensorFrame^ sensorFrame);
+
+    private:
+        ~HeightMapStreamingServer();
+
+        void OnConnection(
+            Windows::Networking::Sockets::StreamSocketListener^ listener,
+            Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^ object);
+
+        bool CreatePointCloudGenerator(
+            _In_ CameraIntrinsics^ cameraIntrinsics);
+
+    private:
+        Windows::Networking::Sockets::StreamSocketListener^ _listener;
+        Windows::Networking::Sockets::StreamSocket^ _socket;
+        Windows::Storage::Streams::DataWriter^ _writer;
+        bool _writeInProgress;
+        Windows::Foundation::DateTime _previousTimestamp;
+
+        std::unique_ptr<PointCloudGenerator> _pointCloudGenerator;
+        HeightMap _heightMap;
+        uint64_t _lastSentUpdate;
+
+        std::vector<cv::Point3f> _points;
+        std::vector<uint8_t> _updates;
+    };
+}
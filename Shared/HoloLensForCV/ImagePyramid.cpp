@@ -0,0 +1,410 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Averages the 2x2 blocks of two rows of single channel pixels.
+        //
+        void DownsampleRows1(
+            _In_ const uint8_t* row0,
+            _In_ const uint8_t* row1,
+            _In_ int32_t width,
+            _Out_writes_(width) uint8_t* destination)
+        {
+            int32_t x = 0;
+
+#if CV_SIMD128
+            for (; x + 16 <= width; x += 16)
+            {
+                cv::v_uint8x16 even0, odd0, even1, odd1;
+
+                cv::v_load_deinterleave(row0 + 2 * x, even0, odd0);
+                cv::v_load_deinterleave(row1 + 2 * x, even1, odd1);
+
+                cv::v_uint16x8 evenLow0, evenHigh0, oddLow0, oddHigh0;
+                cv::v_uint16x8 evenLow1, evenHigh1, oddLow1, oddHigh1;
+
+                cv::v_expand(even0, evenLow0, evenHigh0);
+                cv::v_expand(odd0, oddLow0, oddHigh0);
+                cv::v_expand(even1, evenLow1, evenHigh1);
+                cv::v_expand(odd1, oddLow1, oddHigh1);
+
+                cv::v_store(
+                    destination + x,
+                    cv::v_rshr_pack<2>(
+                        evenLow0 + oddLow0 + evenLow1 + oddLow1,
+                        evenHigh0 + oddHigh0 + evenHigh1 + oddHigh1));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; x < width; ++x)
+            {
+                destination[x] = static_cast<uint8_t>(
+                    (row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2);
+            }
+        }
+
+        //
+        // Averages the 2x2 blocks of two rows of four channel pixels.
+        //
+        void DownsampleRows4(
+            _In_ const uint8_t* row0,
+            _In_ const uint8_t* row1,
+            _In_ int32_t width,
+            _Out_writes_(4 * width) uint8_t* destination)
+        {
+            int32_t x = 0;
+
+#if CV_SIMD128
+            //
+            // Expanding 16 bytes gives two pixels in each half; the low halves of two
+            // expanded vectors hold the even pixels, their high halves the odd ones.
+            //
+            for (; x + 4 <= width; x += 4)
+            {
+                cv::v_uint16x8 sums[4];
+
+                for (int32_t i = 0; i < 2; ++i)
+                {
+                    cv::v_uint16x8 low0, high0, low1, high1;
+
+                    cv::v_expand(cv::v_load(row0 + 8 * x + 16 * i), low0, high0);
+                    cv::v_expand(cv::v_load(row1 + 8 * x + 16 * i), low1, high1);
+
+                    sums[2 * i] = low0 + low1;
+                    sums[2 * i + 1] = high0 + high1;
+                }
+
+                cv::v_store(
+                    destination + 4 * x,
+                    cv::v_rshr_pack<2>(
+                        cv::v_combine_low(sums[0], sums[1]) + cv::v_combine_high(sums[0], sums[1]),
+                        cv::v_combine_low(sums[2], sums[3]) + cv::v_combine_high(sums[2], sums[3])));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; x < width; ++x)
+            {
+                for (int32_t c = 0; c < 4; ++c)
+                {
+                    destination[4 * x + c] = static_cast<uint8_t>(
+                        (row0[8 * x + c] + row0[8 * x + 4 + c] + row1[8 * x + c] + row1[8 * x + 4 + c] + 2) >> 2);
+                }
+            }
+        }
+
+        void DownsampleRows(
+            _In_ const uint8_t* row0,
+            _In_ const uint8_t* row1,
+            _In_ int32_t width,
+            _In_ int32_t numberOfChannels,
+            _Out_writes_(numberOfChannels * width) uint8_t* destination)
+        {
+            for (int32_t x = 0; x < width; ++x)
+            {
+                for (int32_t c = 0; c < numberOfChannels; ++c)
+                {
+                    const int32_t left = 2 * numberOfChannels * x + c;
+                    const int32_t right = left + numberOfChannels;
+
+                    destination[numberOfChannels * x + c] = static_cast<uint8_t>(
+                        (row0[left] + row0[right] + row1[left] + row1[right] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    ImagePyramidPool::Statistics::Statistics()
+        : NumberOfPyramids(0)
+        , NumberOfLevelRequests(0)
+        , NumberOfSharedLevelRequests(0)
+        , NumberOfDownsamples(0)
+        , DownsampleTimeInMilliseconds(0.0)
+        , NumberOfBufferAllocations(0)
+        , NumberOfBufferReuses(0)
+    {
+    }
+
+    ImagePyramidPool::ImagePyramidPool(
+        _In_ size_t maximumNumberOfFreeBuffers)
+        : _maximumNumberOfFreeBuffers(maximumNumberOfFreeBuffers)
+    {
+    }
+
+    ImagePyramidPool::~ImagePyramidPool()
+    {
+        for (const auto& freeBuffer : _freeBuffers)
+        {
+            cv::fastFree(
+                freeBuffer.second);
+        }
+    }
+
+    /* static */ std::shared_ptr<ImagePyramidPool> ImagePyramidPool::GetDefault()
+    {
+        static const std::shared_ptr<ImagePyramidPool> defaultPool =
+            std::make_shared<ImagePyramidPool>();
+
+        return defaultPool;
+    }
+
+    uint8_t* ImagePyramidPool::AcquireBuffer(
+        _In_ size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+
+            const auto freeBuffer =
+                _freeBuffers.find(size);
+
+            if (_freeBuffers.end() != freeBuffer)
+            {
+                uint8_t* buffer =
+                    freeBuffer->second;
+
+                _freeBuffers.erase(
+                    freeBuffer);
+
+                ++_statistics.NumberOfBufferReuses;
+
+                return buffer;
+            }
+
+            ++_statistics.NumberOfBufferAllocations;
+        }
+
+        return static_cast<uint8_t*>(
+            cv::fastMalloc(size));
+    }
+
+    void ImagePyramidPool::ReleaseBuffer(
+        _In_ uint8_t* buffer,
+        _In_ size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+
+            if (_freeBuffers.size() < _maximumNumberOfFreeBuffers)
+            {
+                _freeBuffers.emplace(
+                    size,
+                    buffer);
+
+                return;
+            }
+        }
+
+        cv::fastFree(
+            buffer);
+    }
+
+    void ImagePyramidPool::RecordPyramid()
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        ++_statistics.NumberOfPyramids;
+    }
+
+    void ImagePyramidPool::RecordLevelRequest(
+        _In_ bool shared)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        ++_statistics.NumberOfLevelRequests;
+
+        if (shared)
+        {
+            ++_statistics.NumberOfSharedLevelRequests;
+        }
+    }
+
+    void ImagePyramidPool::RecordDownsample(
+        _In_ double timeInMilliseconds)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        ++_statistics.NumberOfDownsamples;
+
+        _statistics.DownsampleTimeInMilliseconds += timeInMilliseconds;
+    }
+
+    ImagePyramidPool::Statistics ImagePyramidPool::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        return _statistics;
+    }
+
+    std::string ImagePyramidPool::GetStatisticsAsJson() const
+    {
+        const Statistics statistics =
+            GetStatistics();
+
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        stream
+            << "{\"pyramids\":" << statistics.NumberOfPyramids
+            << ",\"level_requests\":" << statistics.NumberOfLevelRequests
+            << ",\"shared_level_requests\":" << statistics.NumberOfSharedLevelRequests
+            << ",\"downsamples\":" << statistics.NumberOfDownsamples
+            << ",\"downsample_ms\":"
+            << ((statistics.NumberOfDownsamples > 0) ? statistics.DownsampleTimeInMilliseconds / statistics.NumberOfDownsamples : 0.0)
+            << ",\"buffer_allocations\":" << statistics.NumberOfBufferAllocations
+            << ",\"buffer_reuses\":" << statistics.NumberOfBufferReuses
+            << "}";
+
+        return stream.str();
+    }
+
+    void ImagePyramidPool::ResetStatistics()
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        _statistics = Statistics();
+    }
+
+    ImagePyramid::ImagePyramid(
+        _In_ const cv::Mat& image,
+        _In_ const std::shared_ptr<ImagePyramidPool>& pool,
+        _In_opt_ const std::shared_ptr<void>& imageOwner)
+        : _pool(pool)
+        , _imageOwner(imageOwner)
+        , _numberOfLevels(1)
+        , _numberOfComputedLevels(1)
+    {
+        REQUIRES(CV_8U == image.depth() && !image.empty());
+        REQUIRES(nullptr != pool);
+
+        _levels[0] = image;
+        _levelBufferSizes.fill(0);
+
+        while (_numberOfLevels < MaximumNumberOfLevels &&
+            (image.cols >> _numberOfLevels) > 0 &&
+            (image.rows >> _numberOfLevels) > 0)
+        {
+            ++_numberOfLevels;
+        }
+
+        _pool->RecordPyramid();
+    }
+
+    ImagePyramid::~ImagePyramid()
+    {
+        for (int32_t level = 1; level < _numberOfComputedLevels; ++level)
+        {
+            _pool->ReleaseBuffer(
+                _levels[level].data,
+                _levelBufferSizes[level]);
+        }
+    }
+
+    int32_t ImagePyramid::GetNumberOfLevels() const
+    {
+        return _numberOfLevels;
+    }
+
+    const cv::Mat& ImagePyramid::GetLevel(
+        _In_ int32_t level)
+    {
+        REQUIRES(level >= 0 && level < _numberOfLevels);
+
+        if (0 == level)
+        {
+            return _levels[0];
+        }
+
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        _pool->RecordLevelRequest(
+            level < _numberOfComputedLevels /* shared */);
+
+        for (; _numberOfComputedLevels <= level; ++_numberOfComputedLevels)
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            const cv::Mat& previousLevel =
+                _levels[_numberOfComputedLevels - 1];
+
+            const int32_t width = previousLevel.cols / 2;
+            const int32_t height = previousLevel.rows / 2;
+
+            const size_t bufferSize =
+                static_cast<size_t>(width) * height * previousLevel.elemSize();
+
+            _levels[_numberOfComputedLevels] =
+                cv::Mat(
+                    height,
+                    width,
+                    previousLevel.type(),
+                    _pool->AcquireBuffer(bufferSize));
+
+            _levelBufferSizes[_numberOfComputedLevels] = bufferSize;
+
+            Downsample(
+                previousLevel,
+                _levels[_numberOfComputedLevels]);
+
+            _pool->RecordDownsample(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+        }
+
+        return _levels[level];
+    }
+
+    /* static */ void ImagePyramid::Downsample(
+        _In_ const cv::Mat& source,
+        _Out_ cv::Mat& destination)
+    {
+        REQUIRES(CV_8U == source.depth());
+        REQUIRES(source.cols >= 2 && source.rows >= 2);
+
+        // A no-op for a destination of the right size and type, e.g. wrapping a pool
+        // buffer.
+        destination.create(
+            source.rows / 2,
+            source.cols / 2,
+            source.type());
+
+        const int32_t numberOfChannels = source.channels();
+
+        for (int32_t y = 0; y < destination.rows; ++y)
+        {
+            const uint8_t* row0 = source.ptr<uint8_t>(2 * y);
+            const uint8_t* row1 = source.ptr<uint8_t>(2 * y + 1);
+
+            uint8_t* destinationRow = destination.ptr<uint8_t>(y);
+
+            switch (numberOfChannels)
+            {
+            case 1:
+                DownsampleRows1(row0, row1, destination.cols, destinationRow);
+                break;
+
+            case 4:
+                DownsampleRows4(row0, row1, destination.cols, destinationRow);
+                break;
+
+            default:
+                DownsampleRows(row0, row1, destination.cols, numberOfChannels, destinationRow);
+                break;
+            }
+        }
+    }
+}
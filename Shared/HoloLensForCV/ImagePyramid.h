@@ -0,0 +1,164 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Recycles the memory of the levels of image pyramids, and counts the work the
+    // pyramids sharing it did and avoided.
+    //
+    // Sensor frames of a camera all have the same size, so the levels of a pyramid are
+    // almost always served from the buffers released by the pyramid of an earlier frame.
+    //
+    // This class is thread-safe, and does not depend on any Windows API.
+    //
+    class ImagePyramidPool
+    {
+    public:
+        struct Statistics
+        {
+            Statistics();
+
+            uint64_t NumberOfPyramids;
+
+            // Requests for levels other than the first one, and how many of them were
+            // served by a level computed for an earlier request, i.e. downsamples that
+            // sharing the pyramid eliminated.
+            uint64_t NumberOfLevelRequests;
+            uint64_t NumberOfSharedLevelRequests;
+
+            uint64_t NumberOfDownsamples;
+            double DownsampleTimeInMilliseconds;
+
+            uint64_t NumberOfBufferAllocations;
+            uint64_t NumberOfBufferReuses;
+        };
+
+        //
+        // At most the given number of released buffers are kept for reuse.
+        //
+        explicit ImagePyramidPool(
+            _In_ size_t maximumNumberOfFreeBuffers = 64);
+
+        ~ImagePyramidPool();
+
+        //
+        // The pool used by the pyramids of the sensor frames.
+        //
+        static std::shared_ptr<ImagePyramidPool> GetDefault();
+
+        //
+        // Returns a buffer of at least the given size, aligned for SIMD instructions.
+        //
+        uint8_t* AcquireBuffer(
+            _In_ size_t size);
+
+        //
+        // Returns a buffer obtained from AcquireBuffer, of the same size, to the pool.
+        //
+        void ReleaseBuffer(
+            _In_ uint8_t* buffer,
+            _In_ size_t size);
+
+        void RecordPyramid();
+
+        void RecordLevelRequest(
+            _In_ bool shared);
+
+        void RecordDownsample(
+            _In_ double timeInMilliseconds);
+
+        Statistics GetStatistics() const;
+
+        //
+        // Returns the statistics as JSON.
+        //
+        std::string GetStatisticsAsJson() const;
+
+        void ResetStatistics();
+
+    private:
+        size_t _maximumNumberOfFreeBuffers;
+
+        mutable std::mutex _mutex;
+
+        // Free buffers, by size.
+        std::multimap<size_t, uint8_t*> _freeBuffers;
+
+        Statistics _statistics;
+    };
+
+    //
+    // Pyramid of half-size images of an 8-bit image, computed level by level on first
+    // request and shared by the consumers of the image.
+    //
+    // Each level is obtained by averaging 2x2 blocks of pixels of the previous level with
+    // SIMD instructions (odd last rows and columns are dropped), into memory taken from an
+    // ImagePyramidPool. A pyramid is usually held through a std::shared_ptr: the levels
+    // are valid as long as the pyramid is, and so is the image it was built from.
+    //
+    // This class is thread-safe, and does not depend on any Windows API.
+    //
+    class ImagePyramid
+    {
+    public:
+        static const int32_t MaximumNumberOfLevels = 8;
+
+        //
+        // Creates the pyramid of a CV_8UC1 to CV_8UC4 image. The image is not copied: the
+        // image owner, if any, is kept alive until the pyramid is destroyed.
+        //
+        ImagePyramid(
+            _In_ const cv::Mat& image,
+            _In_ const std::shared_ptr<ImagePyramidPool>& pool,
+            _In_opt_ const std::shared_ptr<void>& imageOwner = nullptr);
+
+        ~ImagePyramid();
+
+        //
+        // Number of levels, the last one being at least one pixel wide and high.
+        //
+        int32_t GetNumberOfLevels() const;
+
+        //
+        // Returns the given level, the first one being the image itself, computing it and
+        // the levels it is downsampled from if needed.
+        //
+        const cv::Mat& GetLevel(
+            _In_ int32_t level);
+
+        //
+        // Downsamples an 8-bit image by averaging 2x2 blocks of pixels.
+        //
+        static void Downsample(
+            _In_ const cv::Mat& source,
+            _Out_ cv::Mat& destination);
+
+    private:
+        ImagePyramid(const ImagePyramid&) = delete;
+        ImagePyramid& operator=(const ImagePyramid&) = delete;
+
+    private:
+        std::shared_ptr<ImagePyramidPool> _pool;
+        std::shared_ptr<void> _imageOwner;
+
+        int32_t _numberOfLevels;
+
+        std::mutex _mutex;
+
+        // Levels computed so far; the levels after the first one wrap pool buffers.
+        int32_t _numberOfComputedLevels;
+        std::array<cv::Mat, MaximumNumberOfLevels> _levels;
+        std::array<size_t, MaximumNumberOfLevels> _levelBufferSizes;
+    };
+}
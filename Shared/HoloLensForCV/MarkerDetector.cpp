@@ -0,0 +1,823 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        template <typename T>
+        void AppendValue(
+            _Inout_ std::vector<uint8_t>& buffer,
+            _In_ T value)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+
+            buffer.insert(
+                buffer.end(),
+                bytes,
+                bytes + sizeof(T));
+        }
+
+        void AppendTransform(
+            _Inout_ std::vector<uint8_t>& buffer,
+            _In_ bool isValid,
+            _In_ const cv::Matx44f& transform)
+        {
+            for (int32_t row = 0; row < 3; ++row)
+            {
+                for (int32_t column = 0; column < 4; ++column)
+                {
+                    AppendValue(buffer, isValid ? transform(row, column) : 0.0f);
+                }
+            }
+        }
+
+        void WriteTransform(
+            _Inout_ std::ostringstream& stream,
+            _In_ const cv::Matx44f& transform)
+        {
+            stream << "[";
+
+            for (int32_t i = 0; i < 16; ++i)
+            {
+                stream << (i > 0 ? "," : "") << transform.val[i];
+            }
+
+            stream << "]";
+        }
+
+        cv::Point2f ComputeCenter(
+            _In_ const std::array<cv::Point2f, 4>& corners)
+        {
+            return (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f;
+        }
+
+        //
+        // Approximates the pinhole camera of a unit plane map by its derivatives at the
+        // center of the image, ignoring the distortion.
+        //
+        bool ApproximateCameraCalibration(
+            _In_ const cv::Mat& unitPlaneMap,
+            _Out_ MarkerDetector::CameraCalibration& calibration)
+        {
+            const int32_t u = unitPlaneMap.cols / 2;
+            const int32_t v = unitPlaneMap.rows / 2;
+
+            const cv::Vec2f center = unitPlaneMap.at<cv::Vec2f>(v, u);
+            const cv::Vec2f right = unitPlaneMap.at<cv::Vec2f>(v, u + 1);
+            const cv::Vec2f below = unitPlaneMap.at<cv::Vec2f>(v + 1, u);
+
+            //
+            // The unit plane map's Y axis points up, the image's down.
+            //
+            const double fx = 1.0 / (right[0] - center[0]);
+            const double fy = -1.0 / (below[1] - center[1]);
+
+            if (!std::isfinite(fx) || !std::isfinite(fy) || fx <= 0.0 || fy <= 0.0)
+            {
+                return false;
+            }
+
+            calibration.CameraMatrix =
+                cv::Matx33d(
+                    fx, 0.0, u - center[0] * fx,
+                    0.0, fy, v + center[1] * fy,
+                    0.0, 0.0, 1.0);
+
+            calibration.DistortionCoefficients = cv::Vec<double, 5>::all(0.0);
+
+            return true;
+        }
+    }
+
+    DetectedMarker::DetectedMarker()
+        : Id(-1)
+        , HasPose(false)
+        , MarkerToCamera(cv::Matx44f::eye())
+        , HasWorldPose(false)
+        , MarkerToWorld(cv::Matx44f::eye())
+    {
+    }
+
+    MarkerDetector::Options::Options()
+        : Dictionary(cv::aruco::DICT_4X4_50)
+        , MarkerLengthInMeters(0.1f)
+        , PyramidLevel(1)
+        , EnableRegionOfInterestTracking(true)
+        , RegionOfInterestMargin(0.5f)
+        , FullFrameSearchInterval(30)
+    {
+    }
+
+    MarkerDetector::CameraCalibration::CameraCalibration()
+        : CameraMatrix(cv::Matx33d::eye())
+        , DistortionCoefficients(cv::Vec<double, 5>::all(0.0))
+    {
+    }
+
+    MarkerDetector::FrameTimings::FrameTimings()
+        : DetectionTimeInMilliseconds(0.0)
+        , PoseTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , RegionOfInterestSearch(false)
+        , SearchedAreaFraction(0.0)
+    {
+    }
+
+    MarkerDetector::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfFrames(0)
+        , FullFrameTimeInMilliseconds(0.0)
+        , FullFrameMarkersPerFrame(0.0)
+        , TrackingTimeInMilliseconds(0.0)
+        , RegionOfInterestTimeInMilliseconds(0.0)
+        , TrackingMarkersPerFrame(0.0)
+        , RegionOfInterestFrameFraction(0.0)
+        , SearchedAreaFraction(0.0)
+    {
+    }
+
+    MarkerDetector::MarkerDetector(
+        _In_ const Options& options)
+        : _options(options)
+        , _framesSinceFullFrameSearch(0)
+    {
+        REQUIRES(options.MarkerLengthInMeters > 0.0f);
+        REQUIRES(options.PyramidLevel >= 0);
+        REQUIRES(options.RegionOfInterestMargin >= 0.0f);
+        REQUIRES(options.FullFrameSearchInterval > 0);
+
+        _dictionary =
+            cv::aruco::getPredefinedDictionary(
+                options.Dictionary);
+
+        _parameters =
+            cv::aruco::DetectorParameters::create();
+
+        _parameters->cornerRefinementMethod =
+            cv::aruco::CORNER_REFINE_SUBPIX;
+
+        _regionParameters =
+            cv::makePtr<cv::aruco::DetectorParameters>(
+                *_parameters);
+    }
+
+    const MarkerDetector::Options& MarkerDetector::GetOptions() const
+    {
+        return _options;
+    }
+
+    const MarkerDetector::FrameTimings& MarkerDetector::GetLastFrameTimings() const
+    {
+        return _lastFrameTimings;
+    }
+
+    void MarkerDetector::ResetTracking()
+    {
+        _trackedMarkers.clear();
+        _framesSinceFullFrameSearch = 0;
+    }
+
+    void MarkerDetector::Detect(
+        _In_ const cv::Mat& image,
+        _In_ float imageScale,
+        _In_opt_ const CameraCalibration* calibration,
+        _Out_ std::vector<DetectedMarker>& markers)
+    {
+        REQUIRES(CV_8UC1 == image.type());
+        REQUIRES(imageScale > 0.0f);
+
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        _lastFrameTimings = FrameTimings();
+
+        markers.clear();
+
+        _ids.clear();
+        _corners.clear();
+
+        const double imageArea =
+            static_cast<double>(image.cols) * image.rows;
+
+        //
+        // Search the regions around the tracked markers, unless a full frame search is
+        // due. If any tracked marker is missing, it may have moved faster than predicted:
+        // the whole frame is searched instead.
+        //
+        bool isFullFrameSearchNeeded = true;
+
+        if (_options.EnableRegionOfInterestTracking &&
+            !_trackedMarkers.empty() &&
+            _framesSinceFullFrameSearch + 1 < _options.FullFrameSearchInterval)
+        {
+            PredictRegionsOfInterest(
+                image.size(),
+                _regions);
+
+            double searchedArea = 0.0;
+
+            for (const cv::Rect& region : _regions)
+            {
+                DetectInRegion(
+                    image,
+                    region,
+                    _ids,
+                    _corners);
+
+                searchedArea += region.area();
+            }
+
+            isFullFrameSearchNeeded = false;
+
+            for (const TrackedMarker& trackedMarker : _trackedMarkers)
+            {
+                if (_ids.end() == std::find(_ids.begin(), _ids.end(), trackedMarker.Id))
+                {
+                    isFullFrameSearchNeeded = true;
+                    break;
+                }
+            }
+
+            if (!isFullFrameSearchNeeded)
+            {
+                ++_framesSinceFullFrameSearch;
+
+                _lastFrameTimings.RegionOfInterestSearch = true;
+                _lastFrameTimings.SearchedAreaFraction = searchedArea / imageArea;
+            }
+        }
+
+        if (isFullFrameSearchNeeded)
+        {
+            _ids.clear();
+            _corners.clear();
+
+            cv::aruco::detectMarkers(
+                image,
+                _dictionary,
+                _corners,
+                _ids,
+                _parameters);
+
+            _framesSinceFullFrameSearch = 0;
+
+            _lastFrameTimings.SearchedAreaFraction = 1.0;
+        }
+
+        //
+        // Update the tracked markers; the velocity of a marker is the displacement of
+        // its center since its last detection.
+        //
+        std::vector<TrackedMarker> trackedMarkers;
+
+        trackedMarkers.reserve(
+            _ids.size());
+
+        for (size_t i = 0; i < _ids.size(); ++i)
+        {
+            TrackedMarker trackedMarker;
+
+            trackedMarker.Id = _ids[i];
+            trackedMarker.Velocity = cv::Point2f(0.0f, 0.0f);
+
+            std::copy(
+                _corners[i].begin(),
+                _corners[i].end(),
+                trackedMarker.Corners.begin());
+
+            for (const TrackedMarker& previousTrackedMarker : _trackedMarkers)
+            {
+                if (previousTrackedMarker.Id == trackedMarker.Id)
+                {
+                    trackedMarker.Velocity =
+                        ComputeCenter(trackedMarker.Corners) -
+                        ComputeCenter(previousTrackedMarker.Corners);
+
+                    break;
+                }
+            }
+
+            trackedMarkers.push_back(
+                trackedMarker);
+        }
+
+        _trackedMarkers.swap(
+            trackedMarkers);
+
+        //
+        // The corners are expressed in the pixels of the full resolution image: the center
+        // of a pixel of an image downscaled by s is at s * (x + 0.5) - 0.5.
+        //
+        markers.resize(
+            _ids.size());
+
+        for (size_t i = 0; i < _ids.size(); ++i)
+        {
+            markers[i].Id = _ids[i];
+
+            for (size_t corner = 0; corner < 4; ++corner)
+            {
+                markers[i].Corners[corner] =
+                    (_corners[i][corner] + cv::Point2f(0.5f, 0.5f)) * imageScale - cv::Point2f(0.5f, 0.5f);
+
+                _corners[i][corner] = markers[i].Corners[corner];
+            }
+        }
+
+        const std::chrono::steady_clock::time_point poseStartTime =
+            std::chrono::steady_clock::now();
+
+        _lastFrameTimings.DetectionTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(poseStartTime - startTime).count();
+
+        if (nullptr != calibration && !markers.empty())
+        {
+            std::vector<cv::Vec3d> rotations, translations;
+
+            cv::aruco::estimatePoseSingleMarkers(
+                _corners,
+                _options.MarkerLengthInMeters,
+                cv::Mat(calibration->CameraMatrix),
+                cv::Mat(calibration->DistortionCoefficients),
+                rotations,
+                translations);
+
+            //
+            // OpenCV's camera looks down the positive Z axis with Y down: flip Y and Z.
+            //
+            const cv::Matx44d flip(
+                1.0, 0.0, 0.0, 0.0,
+                0.0, -1.0, 0.0, 0.0,
+                0.0, 0.0, -1.0, 0.0,
+                0.0, 0.0, 0.0, 1.0);
+
+            for (size_t i = 0; i < markers.size(); ++i)
+            {
+                cv::Matx33d rotation;
+
+                cv::Rodrigues(
+                    rotations[i],
+                    rotation);
+
+                cv::Matx44d markerToOpenCVCamera = cv::Matx44d::eye();
+
+                for (int32_t row = 0; row < 3; ++row)
+                {
+                    for (int32_t column = 0; column < 3; ++column)
+                    {
+                        markerToOpenCVCamera(row, column) = rotation(row, column);
+                    }
+
+                    markerToOpenCVCamera(row, 3) = translations[i][row];
+                }
+
+                markers[i].HasPose = true;
+                markers[i].MarkerToCamera = cv::Matx44f(flip * markerToOpenCVCamera);
+            }
+        }
+
+        const std::chrono::steady_clock::time_point endTime =
+            std::chrono::steady_clock::now();
+
+        _lastFrameTimings.PoseTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(endTime - poseStartTime).count();
+
+        _lastFrameTimings.TotalTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    }
+
+    void MarkerDetector::PredictRegionsOfInterest(
+        _In_ const cv::Size& imageSize,
+        _Out_ std::vector<cv::Rect>& regions) const
+    {
+        regions.clear();
+
+        const cv::Rect imageRect(
+            cv::Point(0, 0),
+            imageSize);
+
+        for (const TrackedMarker& trackedMarker : _trackedMarkers)
+        {
+            cv::Rect2f bounds(
+                trackedMarker.Corners[0] + trackedMarker.Velocity,
+                cv::Size2f(0.0f, 0.0f));
+
+            for (const cv::Point2f& corner : trackedMarker.Corners)
+            {
+                bounds |= cv::Rect2f(corner + trackedMarker.Velocity, cv::Size2f(1.0f, 1.0f));
+            }
+
+            //
+            // The margin also keeps the marker away from the region border, near which
+            // markers are rejected.
+            //
+            const float margin =
+                std::max(bounds.width, bounds.height) * _options.RegionOfInterestMargin +
+                static_cast<float>(_parameters->minDistanceToBorder + 2);
+
+            const cv::Rect region =
+                cv::Rect(
+                    cv::Point(
+                        cvFloor(bounds.x - margin),
+                        cvFloor(bounds.y - margin)),
+                    cv::Point(
+                        cvCeil(bounds.x + bounds.width + margin),
+                        cvCeil(bounds.y + bounds.height + margin))) & imageRect;
+
+            if (!region.empty())
+            {
+                regions.push_back(
+                    region);
+            }
+        }
+
+        //
+        // Merge overlapping regions, so that no marker is split between two regions.
+        //
+        bool isMerged = true;
+
+        while (isMerged)
+        {
+            isMerged = false;
+
+            for (size_t i = 0; i < regions.size() && !isMerged; ++i)
+            {
+                for (size_t j = i + 1; j < regions.size(); ++j)
+                {
+                    if (!(regions[i] & regions[j]).empty())
+                    {
+                        regions[i] |= regions[j];
+
+                        regions.erase(
+                            regions.begin() + j);
+
+                        isMerged = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    void MarkerDetector::DetectInRegion(
+        _In_ const cv::Mat& image,
+        _In_ const cv::Rect& region,
+        _Inout_ std::vector<int>& ids,
+        _Inout_ std::vector<std::vector<cv::Point2f>>& corners)
+    {
+        //
+        // The perimeter limits are relative to the largest side of the searched image:
+        // scale them so that the same marker sizes are accepted as in the whole frame.
+        //
+        const double rate =
+            static_cast<double>(std::max(image.cols, image.rows)) /
+            std::max(region.width, region.height);
+
+        _regionParameters->minMarkerPerimeterRate =
+            _parameters->minMarkerPerimeterRate * rate;
+
+        _regionParameters->maxMarkerPerimeterRate =
+            _parameters->maxMarkerPerimeterRate * rate;
+
+        _regionIds.clear();
+        _regionCorners.clear();
+
+        cv::aruco::detectMarkers(
+            image(region),
+            _dictionary,
+            _regionCorners,
+            _regionIds,
+            _regionParameters);
+
+        const cv::Point2f offset(
+            static_cast<float>(region.x),
+            static_cast<float>(region.y));
+
+        for (size_t i = 0; i < _regionIds.size(); ++i)
+        {
+            if (ids.end() != std::find(ids.begin(), ids.end(), _regionIds[i]))
+            {
+                continue;
+            }
+
+            for (cv::Point2f& corner : _regionCorners[i])
+            {
+                corner += offset;
+            }
+
+            ids.push_back(
+                _regionIds[i]);
+
+            corners.push_back(
+                _regionCorners[i]);
+        }
+    }
+
+    /* static */ float MarkerDetector::ComputeLuminance(
+        _In_ ImagePyramid& imagePyramid,
+        _In_ int32_t level,
+        _Out_ cv::Mat& luminance)
+    {
+        level =
+            std::min(
+                level,
+                imagePyramid.GetNumberOfLevels() - 1);
+
+        const cv::Mat& image =
+            imagePyramid.GetLevel(level);
+
+        switch (image.channels())
+        {
+        case 1:
+            luminance = image;
+            break;
+
+        case 3:
+            cv::cvtColor(image, luminance, cv::COLOR_BGR2GRAY);
+            break;
+
+        default:
+            REQUIRES(4 == image.channels());
+            cv::cvtColor(image, luminance, cv::COLOR_BGRA2GRAY);
+            break;
+        }
+
+        return static_cast<float>(1 << level);
+    }
+
+    /* static */ void MarkerDetector::ComputeWorldPoses(
+        _In_ const cv::Matx44f& cameraToWorld,
+        _Inout_ std::vector<DetectedMarker>& markers)
+    {
+        for (DetectedMarker& marker : markers)
+        {
+            if (marker.HasPose)
+            {
+                marker.HasWorldPose = true;
+                marker.MarkerToWorld = cameraToWorld * marker.MarkerToCamera;
+            }
+        }
+    }
+
+    /* static */ void MarkerDetector::SerializeMarkers(
+        _In_ int64_t timestamp,
+        _In_ const std::vector<DetectedMarker>& markers,
+        _Out_ std::vector<uint8_t>& message)
+    {
+        message.clear();
+
+        AppendValue(message, MessageCookie);
+        AppendValue(message, MessageVersion);
+        AppendValue(message, timestamp);
+        AppendValue(message, static_cast<uint32_t>(markers.size()));
+
+        for (const DetectedMarker& marker : markers)
+        {
+            AppendValue(message, marker.Id);
+            AppendValue(message, (marker.HasPose ? 1u : 0u) | (marker.HasWorldPose ? 2u : 0u));
+
+            for (const cv::Point2f& corner : marker.Corners)
+            {
+                AppendValue(message, corner.x);
+                AppendValue(message, corner.y);
+            }
+
+            AppendTransform(message, marker.HasPose, marker.MarkerToCamera);
+            AppendTransform(message, marker.HasWorldPose, marker.MarkerToWorld);
+        }
+    }
+
+    /* static */ std::string MarkerDetector::GetMarkersAsJson(
+        _In_ const std::vector<DetectedMarker>& markers)
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        stream << "[";
+
+        for (size_t i = 0; i < markers.size(); ++i)
+        {
+            const DetectedMarker& marker = markers[i];
+
+            stream
+                << (i > 0 ? "," : "")
+                << "{\"id\":" << marker.Id
+                << ",\"corners\":[";
+
+            for (size_t corner = 0; corner < marker.Corners.size(); ++corner)
+            {
+                stream
+                    << (corner > 0 ? "," : "")
+                    << marker.Corners[corner].x << "," << marker.Corners[corner].y;
+            }
+
+            stream << "]";
+
+            if (marker.HasPose)
+            {
+                stream << ",\"marker_to_camera\":";
+                WriteTransform(stream, marker.MarkerToCamera);
+            }
+
+            if (marker.HasWorldPose)
+            {
+                stream << ",\"marker_to_world\":";
+                WriteTransform(stream, marker.MarkerToWorld);
+            }
+
+            stream << "}";
+        }
+
+        stream << "]";
+
+        return stream.str();
+    }
+
+    /* static */ bool MarkerDetector::BenchmarkRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const Options& options,
+        _In_ size_t maximumNumberOfFrames,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        statistics = BenchmarkStatistics();
+
+        const std::string sensorName = "pv";
+
+        SensorFrameRecordingReader reader;
+
+        if (!reader.Open(recordingFolder, sensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> archive =
+            reader.OpenArchive();
+
+        const size_t numberOfFrames =
+            (0 == maximumNumberOfFrames)
+                ? reader.GetNumberOfFrames()
+                : std::min(maximumNumberOfFrames, reader.GetNumberOfFrames());
+
+        //
+        // The frames are read and downscaled once, the luminance images being searched
+        // twice: first in full, then with tracking.
+        //
+        const std::shared_ptr<ImagePyramidPool> pool =
+            std::make_shared<ImagePyramidPool>();
+
+        std::vector<cv::Mat> images;
+        std::vector<cv::Matx44f> camerasToWorld;
+        std::vector<bool> hasPoses;
+
+        float imageScale = 1.0f;
+
+        CameraCalibration calibration;
+        bool hasCalibration = false;
+
+        RecordedSensorFrame frame;
+
+        for (size_t frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+        {
+            if (!reader.ReadFrame(frameIndex, archive.get(), frame) ||
+                CV_8U != frame.Image.depth())
+            {
+                continue;
+            }
+
+            if (images.empty())
+            {
+                cv::Mat unitPlaneMap;
+
+                hasCalibration =
+                    PointCloudGenerator::LoadUnitPlaneMap(recordingFolder, sensorName, frame.Image.cols, frame.Image.rows, unitPlaneMap) &&
+                    ApproximateCameraCalibration(unitPlaneMap, calibration);
+            }
+
+            ImagePyramid imagePyramid(
+                frame.Image,
+                pool);
+
+            cv::Mat luminance;
+
+            imageScale =
+                ComputeLuminance(
+                    imagePyramid,
+                    options.PyramidLevel,
+                    luminance);
+
+            images.push_back(
+                luminance.clone());
+
+            camerasToWorld.emplace_back();
+
+            hasPoses.push_back(
+                PointCloudGenerator::ComputeCameraToWorld(
+                    frame.FrameToOrigin,
+                    frame.CameraViewTransform,
+                    camerasToWorld.back()));
+        }
+
+        if (images.empty())
+        {
+            return false;
+        }
+
+        statistics.NumberOfFrames = images.size();
+
+        std::vector<DetectedMarker> markers;
+
+        uint64_t numberOfRegionOfInterestFrames = 0;
+
+        for (int32_t pass = 0; pass < 2; ++pass)
+        {
+            Options passOptions = options;
+
+            passOptions.EnableRegionOfInterestTracking = (1 == pass);
+
+            MarkerDetector detector(
+                passOptions);
+
+            for (size_t i = 0; i < images.size(); ++i)
+            {
+                detector.Detect(
+                    images[i],
+                    imageScale,
+                    hasCalibration ? &calibration : nullptr,
+                    markers);
+
+                if (hasPoses[i])
+                {
+                    ComputeWorldPoses(
+                        camerasToWorld[i],
+                        markers);
+                }
+
+                const FrameTimings& timings =
+                    detector.GetLastFrameTimings();
+
+                if (0 == pass)
+                {
+                    statistics.FullFrameTimeInMilliseconds += timings.TotalTimeInMilliseconds;
+                    statistics.FullFrameMarkersPerFrame += static_cast<double>(markers.size());
+                }
+                else
+                {
+                    statistics.TrackingTimeInMilliseconds += timings.TotalTimeInMilliseconds;
+                    statistics.TrackingMarkersPerFrame += static_cast<double>(markers.size());
+                    statistics.SearchedAreaFraction += timings.SearchedAreaFraction;
+
+                    if (timings.RegionOfInterestSearch)
+                    {
+                        ++numberOfRegionOfInterestFrames;
+
+                        statistics.RegionOfInterestTimeInMilliseconds += timings.TotalTimeInMilliseconds;
+                    }
+                }
+            }
+        }
+
+        const double scale =
+            1.0 / statistics.NumberOfFrames;
+
+        statistics.FullFrameTimeInMilliseconds *= scale;
+        statistics.FullFrameMarkersPerFrame *= scale;
+        statistics.TrackingTimeInMilliseconds *= scale;
+        statistics.TrackingMarkersPerFrame *= scale;
+        statistics.SearchedAreaFraction *= scale;
+        statistics.RegionOfInterestFrameFraction = numberOfRegionOfInterestFrames * scale;
+
+        if (numberOfRegionOfInterestFrames > 0)
+        {
+            statistics.RegionOfInterestTimeInMilliseconds /= numberOfRegionOfInterestFrames;
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "MarkerDetector",
+            dbg::LogLevel::Information,
+            L"MarkerDetector::BenchmarkRecording: %llu frames, full frame %.3f ms/frame (%.2f markers/frame), tracking %.3f ms/frame (%.2f markers/frame, %.1f%% of the frames at %.3f ms in regions of interest covering %.1f%% of the image)",
+            statistics.NumberOfFrames,
+            statistics.FullFrameTimeInMilliseconds,
+            statistics.FullFrameMarkersPerFrame,
+            statistics.TrackingTimeInMilliseconds,
+            statistics.TrackingMarkersPerFrame,
+            statistics.RegionOfInterestFrameFraction * 100.0,
+            statistics.RegionOfInterestTimeInMilliseconds,
+            statistics.SearchedAreaFraction * 100.0);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return true;
+    }
+}
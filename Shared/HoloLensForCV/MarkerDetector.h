@@ -0,0 +1,250 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // A fiducial marker found in an image.
+    //
+    struct DetectedMarker
+    {
+        DetectedMarker();
+
+        int32_t Id;
+
+        // In pixels of the full resolution image, clockwise from the top left corner of
+        // the marker.
+        std::array<cv::Point2f, 4> Corners;
+
+        // Marker-to-camera transform (for column vectors), in the camera coordinate system
+        // of the sensor frames, which looks down the negative Z axis with Y up. The marker
+        // coordinate system is centered on the marker, with Z pointing out of it. Only
+        // valid if the camera calibration is known.
+        bool HasPose;
+        cv::Matx44f MarkerToCamera;
+
+        // Marker-to-world transform, if the frame also has a valid pose.
+        bool HasWorldPose;
+        cv::Matx44f MarkerToWorld;
+    };
+
+    //
+    // Detects ArUco markers in luminance images, typically a downscaled level of the
+    // photo video frames' image pyramid, and estimates their poses.
+    //
+    // Once markers are found, the following frames are only searched in regions around
+    // the positions predicted from their last two detections. A full frame search is made
+    // when a tracked marker is not found again, and at a fixed interval to pick up new
+    // markers.
+    //
+    // An instance keeps the tracked markers between calls, so it must not be used by
+    // several threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class MarkerDetector
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // One of cv::aruco::PREDEFINED_DICTIONARY_NAME.
+            int32_t Dictionary;
+
+            // Length of the side of the markers, in meters.
+            float MarkerLengthInMeters;
+
+            // Level of the image pyramid the markers are detected on (see
+            // ComputeLuminance).
+            int32_t PyramidLevel;
+
+            bool EnableRegionOfInterestTracking;
+
+            // Margin added around the predicted position of a marker, as a fraction of
+            // its size.
+            float RegionOfInterestMargin;
+
+            // Number of frames after which the whole frame is searched again.
+            int32_t FullFrameSearchInterval;
+        };
+
+        struct CameraCalibration
+        {
+            CameraCalibration();
+
+            // Pinhole camera matrix and (k1, k2, p1, p2, k3) distortion coefficients, in
+            // pixels of the full resolution image.
+            cv::Matx33d CameraMatrix;
+            cv::Vec<double, 5> DistortionCoefficients;
+        };
+
+        struct FrameTimings
+        {
+            FrameTimings();
+
+            double DetectionTimeInMilliseconds;
+            double PoseTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+
+            // Whether only regions of interest were searched, and the fraction of the
+            // image they cover.
+            bool RegionOfInterestSearch;
+            double SearchedAreaFraction;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfFrames;
+
+            // Per-frame averages, detecting the markers in the whole frame.
+            double FullFrameTimeInMilliseconds;
+            double FullFrameMarkersPerFrame;
+
+            // Per-frame averages with region of interest tracking, over all frames and
+            // over the frames where only regions of interest were searched.
+            double TrackingTimeInMilliseconds;
+            double RegionOfInterestTimeInMilliseconds;
+            double TrackingMarkersPerFrame;
+
+            double RegionOfInterestFrameFraction;
+            double SearchedAreaFraction;
+        };
+
+        static const uint32_t MessageCookie = 0x4b524d48; // 'HMRK'
+        static const uint32_t MessageVersion = 1;
+
+        explicit MarkerDetector(
+            _In_ const Options& options = Options());
+
+        const Options& GetOptions() const;
+
+        //
+        // Detects the markers of a CV_8UC1 image downscaled by the given factor from the
+        // full resolution image. Poses are estimated if the calibration is given.
+        //
+        void Detect(
+            _In_ const cv::Mat& image,
+            _In_ float imageScale,
+            _In_opt_ const CameraCalibration* calibration,
+            _Out_ std::vector<DetectedMarker>& markers);
+
+        const FrameTimings& GetLastFrameTimings() const;
+
+        //
+        // Forgets the tracked markers: the next frame is searched entirely.
+        //
+        void ResetTracking();
+
+        //
+        // Computes the luminance of the given pyramid level (the closest one if the
+        // pyramid has fewer levels) and returns the scale of that level.
+        //
+        static float ComputeLuminance(
+            _In_ ImagePyramid& imagePyramid,
+            _In_ int32_t level,
+            _Out_ cv::Mat& luminance);
+
+        //
+        // Sets the world poses of the markers with a pose.
+        //
+        static void ComputeWorldPoses(
+            _In_ const cv::Matx44f& cameraToWorld,
+            _Inout_ std::vector<DetectedMarker>& markers);
+
+        //
+        // Serializes the markers of a frame as a compact message:
+        //
+        //   uint32 cookie ('HMRK'), uint32 version, int64 frame timestamp (100ns ticks),
+        //   uint32 marker count,
+        //
+        // followed for each marker by:
+        //
+        //   int32 id, uint32 flags (1: camera pose, 2: world pose), float[8] corners,
+        //   float[12] marker-to-camera and float[12] marker-to-world transforms (the top
+        //   three rows, row-major; zero when not valid).
+        //
+        // Values are little-endian.
+        //
+        static void SerializeMarkers(
+            _In_ int64_t timestamp,
+            _In_ const std::vector<DetectedMarker>& markers,
+            _Out_ std::vector<uint8_t>& message);
+
+        //
+        // Returns the markers as JSON.
+        //
+        static std::string GetMarkersAsJson(
+            _In_ const std::vector<DetectedMarker>& markers);
+
+        //
+        // Detects the markers in the photo video frames of a recording, first in the whole
+        // frames, then with region of interest tracking. At most the given number of
+        // frames is processed, zero to process them all.
+        //
+        static bool BenchmarkRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const Options& options,
+            _In_ size_t maximumNumberOfFrames,
+            _Out_ BenchmarkStatistics& statistics);
+
+    private:
+        struct TrackedMarker
+        {
+            int32_t Id;
+
+            // In pixels of the detection image.
+            std::array<cv::Point2f, 4> Corners;
+            cv::Point2f Velocity;
+        };
+
+        //
+        // Returns the regions around the predicted positions of the tracked markers,
+        // overlapping regions being merged.
+        //
+        void PredictRegionsOfInterest(
+            _In_ const cv::Size& imageSize,
+            _Out_ std::vector<cv::Rect>& regions) const;
+
+        //
+        // Detects the markers of an image region, adding them to the given lists with
+        // coordinates in the whole image.
+        //
+        void DetectInRegion(
+            _In_ const cv::Mat& image,
+            _In_ const cv::Rect& region,
+            _Inout_ std::vector<int>& ids,
+            _Inout_ std::vector<std::vector<cv::Point2f>>& corners);
+
+    private:
+        Options _options;
+
+        cv::Ptr<cv::aruco::Dictionary> _dictionary;
+        cv::Ptr<cv::aruco::DetectorParameters> _parameters;
+        cv::Ptr<cv::aruco::DetectorParameters> _regionParameters;
+
+        std::vector<TrackedMarker> _trackedMarkers;
+        int32_t _framesSinceFullFrameSearch;
+
+        // Scratch buffers.
+        std::vector<cv::Rect> _regions;
+        std::vector<int> _ids;
+        std::vector<std::vector<cv::Point2f>> _corners;
+        std::vector<int> _regionIds;
+        std::vector<std::vector<cv::Point2f>> _regionCorners;
+
+        FrameTimings _lastFrameTimings;
+    };
+}
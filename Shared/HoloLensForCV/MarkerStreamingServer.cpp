@@ -0,0 +1,305 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        Platform::String^ ToPlatformString(
+            _In_ const std::string& value)
+        {
+            const std::wstring wideValue(
+                value.begin(),
+                value.end());
+
+            return ref new Platform::String(
+                wideValue.c_str());
+        }
+
+        std::array<float, 16> ToArray(
+            _In_ const Windows::Foundation::Numerics::float4x4& matrix)
+        {
+            std::array<float, 16> values;
+
+            static_assert(
+                sizeof(values) == sizeof(matrix),
+                "float4x4 must hold 16 contiguous floats");
+
+            memcpy(
+                values.data(),
+                &matrix,
+                sizeof(values));
+
+            return values;
+        }
+
+        MarkerDetector::CameraCalibration ToCameraCalibration(
+            _In_ Windows::Media::Devices::Core::CameraIntrinsics^ cameraIntrinsics)
+        {
+            MarkerDetector::CameraCalibration calibration;
+
+            calibration.CameraMatrix =
+                cv::Matx33d(
+                    cameraIntrinsics->FocalLength.x, 0.0, cameraIntrinsics->PrincipalPoint.x,
+                    0.0, cameraIntrinsics->FocalLength.y, cameraIntrinsics->PrincipalPoint.y,
+                    0.0, 0.0, 1.0);
+
+            calibration.DistortionCoefficients =
+                cv::Vec<double, 5>(
+                    cameraIntrinsics->RadialDistortion.x,
+                    cameraIntrinsics->RadialDistortion.y,
+                    cameraIntrinsics->TangentialDistortion.x,
+                    cameraIntrinsics->TangentialDistortion.y,
+                    cameraIntrinsics->RadialDistortion.z);
+
+            return calibration;
+        }
+    }
+
+    MarkerStreamingServer::MarkerStreamingServer(
+        _In_ Platform::String^ serviceName)
+        : _writeInProgress(false)
+        , _numberOfFrames(0)
+        , _numberOfRegionOfInterestFrames(0)
+        , _luminanceTimeInMilliseconds(0.0)
+        , _fullFrameTimeInMilliseconds(0.0)
+        , _regionOfInterestTimeInMilliseconds(0.0)
+        , _poseTimeInMilliseconds(0.0)
+        , _searchedAreaFraction(0.0)
+    {
+        _listener = ref new Windows::Networking::Sockets::StreamSocketListener();
+
+        _listener->ConnectionReceived +=
+            ref new Windows::Foundation::TypedEventHandler<
+            Windows::Networking::Sockets::StreamSocketListener^,
+            Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^>(
+                this,
+                &MarkerStreamingServer::OnConnection);
+
+        _listener->Control->KeepAlive = true;
+
+        Concurrency::create_task(_listener->BindServiceNameAsync(serviceName)).then(
+            [this](Concurrency::task<void> previousTask)
+            {
+                try
+                {
+                    previousTask.get();
+                }
+                catch (Platform::Exception^ exception)
+                {
+#if DBG_ENABLE_ERROR_LOGGING
+                    DBG_LOG(
+                        "MarkerStreamingServer",
+                        dbg::LogLevel::Error,
+                        L"MarkerStreamingServer::MarkerStreamingServer: %s",
+                        exception->Message->Data());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+                }
+            });
+    }
+
+    MarkerStreamingServer::~MarkerStreamingServer()
+    {
+        delete _listener;
+        _listener = nullptr;
+    }
+
+    void MarkerStreamingServer::OnConnection(
+        Windows::Networking::Sockets::StreamSocketListener^ listener,
+        Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^ object)
+    {
+        _socket = object->Socket;
+
+        _writer = ref new Windows::Storage::Streams::DataWriter(_socket->OutputStream);
+        _writer->ByteOrder = Windows::Storage::Streams::ByteOrder::LittleEndian;
+        _writeInProgress = false;
+    }
+
+    void MarkerStreamingServer::Send(
+        SensorFrame^ sensorFrame)
+    {
+        if (_previousTimestamp.UniversalTime.Equals(sensorFrame->Timestamp.UniversalTime))
+        {
+            return;
+        }
+
+        _previousTimestamp = sensorFrame->Timestamp;
+
+        //
+        // The pyramid of the frame is shared with the other sinks, e.g. a recorder's
+        // feature extraction.
+        //
+        const std::shared_ptr<ImagePyramid> imagePyramid =
+            sensorFrame->GetImagePyramid();
+
+        if (nullptr == imagePyramid)
+        {
+            return;
+        }
+
+        Windows::Media::Devices::Core::CameraIntrinsics^ cameraIntrinsics =
+            sensorFrame->CoreCameraIntrinsics;
+
+        MarkerDetector::CameraCalibration calibration;
+
+        if (nullptr != cameraIntrinsics)
+        {
+            calibration =
+                ToCameraCalibration(
+                    cameraIntrinsics);
+        }
+
+        cv::Matx44f cameraToWorld;
+
+        const bool hasPose =
+            PointCloudGenerator::ComputeCameraToWorld(
+                ToArray(sensorFrame->FrameToOrigin),
+                ToArray(sensorFrame->CameraViewTransform),
+                cameraToWorld);
+
+        std::lock_guard<std::mutex> guard(_detectorMutex);
+
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        const float imageScale =
+            MarkerDetector::ComputeLuminance(
+                *imagePyramid,
+                _detector.GetOptions().PyramidLevel,
+                _luminance);
+
+        _luminanceTimeInMilliseconds +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        _detector.Detect(
+            _luminance,
+            imageScale,
+            (nullptr != cameraIntrinsics) ? &calibration : nullptr,
+            _markers);
+
+        if (hasPose)
+        {
+            MarkerDetector::ComputeWorldPoses(
+                cameraToWorld,
+                _markers);
+        }
+
+        {
+            const MarkerDetector::FrameTimings& timings =
+                _detector.GetLastFrameTimings();
+
+            ++_numberOfFrames;
+
+            if (timings.RegionOfInterestSearch)
+            {
+                ++_numberOfRegionOfInterestFrames;
+
+                _regionOfInterestTimeInMilliseconds += timings.DetectionTimeInMilliseconds;
+            }
+            else
+            {
+                _fullFrameTimeInMilliseconds += timings.DetectionTimeInMilliseconds;
+            }
+
+            _poseTimeInMilliseconds += timings.PoseTimeInMilliseconds;
+            _searchedAreaFraction += timings.SearchedAreaFraction;
+        }
+
+        // The luminance may wrap a level of the frame's pyramid.
+        _luminance = cv::Mat();
+
+        if (nullptr == _socket || _writeInProgress || _markers.empty())
+        {
+            return;
+        }
+
+        MarkerDetector::SerializeMarkers(
+            sensorFrame->Timestamp.UniversalTime,
+            _markers,
+            _message);
+
+        _writeInProgress = true;
+
+        _writer->WriteUInt32(
+            static_cast<uint32_t>(_message.size()));
+
+        _writer->WriteBytes(
+            Platform::ArrayReference<uint8_t>(
+                _message.data(),
+                static_cast<unsigned int>(_message.size())));
+
+        Concurrency::create_task(_writer->StoreAsync()).then(
+            [&](Concurrency::task<unsigned int> writeTask)
+            {
+                try
+                {
+                    writeTask.get();
+                    _writeInProgress = false;
+                }
+                catch (Platform::Exception^ exception)
+                {
+#if DBG_ENABLE_ERROR_LOGGING
+                    DBG_LOG(
+                        "MarkerStreamingServer",
+                        dbg::LogLevel::Error,
+                        L"MarkerStreamingServer::Send: StoreAsync call failed with error: %s",
+                        exception->Message->Data());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+                    _socket = nullptr;
+                }
+            });
+    }
+
+    Platform::String^ MarkerStreamingServer::GetMarkersAsJson()
+    {
+        std::lock_guard<std::mutex> guard(_detectorMutex);
+
+        return ToPlatformString(
+            MarkerDetector::GetMarkersAsJson(
+                _markers));
+    }
+
+    Platform::String^ MarkerStreamingServer::GetStageTimingsAsJson()
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        {
+            std::lock_guard<std::mutex> guard(_detectorMutex);
+
+            const uint64_t numberOfFullFrames =
+                _numberOfFrames - _numberOfRegionOfInterestFrames;
+
+            const double scale =
+                (_numberOfFrames > 0) ? 1.0 / _numberOfFrames : 0.0;
+
+            stream
+                << "{\"frames\":" << _numberOfFrames
+                << ",\"luminance_ms\":" << _luminanceTimeInMilliseconds * scale
+                << ",\"full_frame_searches\":" << numberOfFullFrames
+                << ",\"full_frame_ms\":"
+                << ((numberOfFullFrames > 0) ? _fullFrameTimeInMilliseconds / numberOfFullFrames : 0.0)
+                << ",\"roi_searches\":" << _numberOfRegionOfInterestFrames
+                << ",\"roi_ms\":"
+                << ((_numberOfRegionOfInterestFrames > 0) ? _regionOfInterestTimeInMilliseconds / _numberOfRegionOfInterestFrames : 0.0)
+                << ",\"pose_ms\":" << _poseTimeInMilliseconds * scale
+                << ",\"searched_area\":" << _searchedAreaFraction * scale
+                << "}";
+        }
+
+        return ToPlatformString(
+            stream.str());
+    }
+}
@@ -0,0 +1,75 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Detects fiducial markers (see MarkerDetector) in the photo video frames, on a level
+    // of the frames' image pyramid, and streams their identifiers, corners and poses to
+    // the connected client instead of the frames. Each message is a uint32 length followed
+    // by the output of MarkerDetector::SerializeMarkers; frames without markers are not
+    // sent.
+    //
+    public ref class MarkerStreamingServer sealed
+        : public ISensorFrameSink
+    {
+    public:
+        MarkerStreamingServer(
+            _In_ Platform::String^ serviceName);
+
+        virtual void Send(
+            SensorFrame^ sensorFrame);
+
+        //
+        // Returns the markers of the last frame as JSON (see
+        // MarkerDetector::GetMarkersAsJson).
+        //
+        Platform::String^ GetMarkersAsJson();
+
+        //
+        // Returns the average per-frame latency of full frame and region of interest
+        // searches, as JSON.
+        //
+        Platform::String^ GetStageTimingsAsJson();
+
+    private:
+        ~MarkerStreamingServer();
+
+        void OnConnection(
+            Windows::Networking::Sockets::StreamSocketListener^ listener,
+            Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^ object);
+
+    private:
+        Windows::Networking::Sockets::StreamSocketListener^ _listener;
+        Windows::Networking::Sockets::StreamSocket^ _socket;
+        Windows::Storage::Streams::DataWriter^ _writer;
+        bool _writeInProgress;
+        Windows::Foundation::DateTime _previousTimestamp;
+
+        std::mutex _detectorMutex;
+
+        MarkerDetector _detector;
+
+        cv::Mat _luminance;
+        std::vector<DetectedMarker> _markers;
+        std::vector<uint8_t> _message;
+
+        uint64_t _numberOfFrames;
+        uint64_t _numberOfRegionOfInterestFrames;
+        double _luminanceTimeInMilliseconds;
+        double _fullFrameTimeInMilliseconds;
+        double _regionOfInterestTimeInMilliseconds;
+        double _poseTimeInMilliseconds;
+        double _searchedAreaFraction;
+    };
+}
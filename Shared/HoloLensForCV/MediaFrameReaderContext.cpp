@@ -20,7 +20,30 @@ namespace HoloLensForCV
         : _sensorType(sensorType)
         , _spatialPerception(spatialPerception)
         , _sensorFrameSink(sensorFrameSink)
+        , _previousRelativeTimestamp(0)
     {
+        Platform::String^ sensorName =
+            _sensorType.ToString();
+
+        _framesArrived =
+            &dbg::Metrics::GetCounter(
+                dbg::MakeMetricName("hololensforcv_frames_arrived_total", "sensor", sensorName->Data()));
+
+        _framesUnavailable =
+            &dbg::Metrics::GetCounter(
+                dbg::MakeMetricName("hololensforcv_frames_unavailable_total", "sensor", sensorName->Data()));
+
+        _frameInterval =
+            &dbg::Metrics::GetHistogram(
+                dbg::MakeMetricName("hololensforcv_frame_interval_microseconds", "sensor", sensorName->Data()));
+
+        _captureToArrivalLatency =
+            &dbg::Metrics::GetHistogram(
+                dbg::MakeMetricName("hololensforcv_capture_to_arrival_latency_microseconds", "sensor", sensorName->Data()));
+
+        _sinkSendTime =
+            &dbg::Metrics::GetHistogram(
+                dbg::MakeMetricName("hololensforcv_sink_send_time_microseconds", "sensor", sensorName->Data()));
     }
 
     SensorFrame^ MediaFrameReaderContext::GetLatestSensorFrame()
@@ -40,6 +63,12 @@ namespace HoloLensForCV
         Windows::Media::Capture::Frames::MediaFrameReader^ sender,
         Windows::Media::Capture::Frames::MediaFrameArrivedEventArgs^ args)
     {
+        DBG_PROFILE_SPAN(
+            "MediaFrameReaderContext::FrameArrived");
+
+        const int64_t arrivalTicks =
+            SensorFrameTrace::GetCurrentTicks();
+
         //
         // TryAcquireLatestFrame will return the latest frame that has not yet been acquired.
         // This can return null if there is no such frame, or if the reader is not in the
@@ -51,7 +80,12 @@ namespace HoloLensForCV
 
         if (nullptr == frame)
         {
-            dbg::trace(
+            _framesUnavailable->Increment();
+
+            DBG_LOG_RATE_LIMITED(
+                "MediaFrameReaderContext",
+                dbg::LogLevel::Warning,
+                1000.0 /* minimum_interval_in_milliseconds */,
                 L"MediaFrameReaderContext::FrameArrived: _sensorType=%s (%i), frame is null",
                 _sensorType.ToString()->Data(),
                 (int32_t)_sensorType);
@@ -60,7 +94,12 @@ namespace HoloLensForCV
         }
         else if (nullptr == frame->VideoMediaFrame)
         {
-            dbg::trace(
+            _framesUnavailable->Increment();
+
+            DBG_LOG_RATE_LIMITED(
+                "MediaFrameReaderContext",
+                dbg::LogLevel::Warning,
+                1000.0 /* minimum_interval_in_milliseconds */,
                 L"MediaFrameReaderContext::FrameArrived: _sensorType=%s (%i), frame->VideoMediaFrame is null",
                 _sensorType.ToString()->Data(),
                 (int32_t)_sensorType);
@@ -69,7 +108,12 @@ namespace HoloLensForCV
         }
         else if (nullptr == frame->VideoMediaFrame->SoftwareBitmap)
         {
-            dbg::trace(
+            _framesUnavailable->Increment();
+
+            DBG_LOG_RATE_LIMITED(
+                "MediaFrameReaderContext",
+                dbg::LogLevel::Warning,
+                1000.0 /* minimum_interval_in_milliseconds */,
                 L"MediaFrameReaderContext::FrameArrived: _sensorType=%s (%i), frame->VideoMediaFrame->SoftwareBitmap is null",
                 _sensorType.ToString()->Data(),
                 (int32_t)_sensorType);
@@ -78,7 +122,9 @@ namespace HoloLensForCV
         }
 
 #if DBG_ENABLE_VERBOSE_LOGGING
-        dbg::trace(
+        DBG_LOG(
+            "MediaFrameReaderContext",
+            dbg::LogLevel::Verbose,
             L"MediaFrameReaderContext::FrameArrived: _sensorType=%s (%i), timestamp=%llu (relative)",
             _sensorType.ToString()->Data(),
             (int32_t)_sensorType,
@@ -96,6 +142,25 @@ namespace HoloLensForCV
                 Io::HundredsOfNanoseconds(
                     frame->SystemRelativeTime->Value.Duration)).count();
 
+        {
+            const int64_t relativeTimestamp =
+                frame->SystemRelativeTime->Value.Duration;
+
+            _framesArrived->Increment();
+
+            if (0 != _previousRelativeTimestamp && relativeTimestamp > _previousRelativeTimestamp)
+            {
+                _frameInterval->Record(
+                    static_cast<uint64_t>(relativeTimestamp - _previousRelativeTimestamp) / 10);
+            }
+
+            _previousRelativeTimestamp = relativeTimestamp;
+
+            _captureToArrivalLatency->Record(
+                GetMicrosecondsSinceCapture(
+                    timestamp));
+        }
+
         //
         // Create a copy of the software bitmap and wrap it up with a SensorFrame.
         //
@@ -120,6 +185,17 @@ namespace HoloLensForCV
         SensorFrame^ sensorFrame =
             ref new SensorFrame(_sensorType, timestamp, softwareBitmap);
 
+        //
+        // Both times are relative to boot, which the sinks' own stages are measured against.
+        //
+        sensorFrame->GetTrace().Set(
+            SensorFrameStage::Exposure,
+            frame->SystemRelativeTime->Value.Duration);
+
+        sensorFrame->GetTrace().Set(
+            SensorFrameStage::Arrival,
+            arrivalTicks);
+
         //
         // Extract the frame-to-origin transform, if the MFT exposed it:
         //
@@ -146,7 +222,9 @@ namespace HoloLensForCV
 #if DBG_ENABLE_VERBOSE_LOGGING
                 Windows::Foundation::Numerics::float4x4 frameToOrigin =
                     frameToOriginReference->Value;
-                dbg::trace(
+                DBG_LOG(
+                    "MediaFrameReaderContext",
+                    dbg::LogLevel::Verbose,
                     L"frameToOrigin=[[%f, %f, %f, %f], [%f, %f, %f, %f], [%f, %f, %f, %f], [%f, %f, %f, %f]]",
                     frameToOrigin.m11, frameToOrigin.m12, frameToOrigin.m13, frameToOrigin.m14,
                     frameToOrigin.m21, frameToOrigin.m22, frameToOrigin.m23, frameToOrigin.m24,
@@ -196,7 +274,9 @@ namespace HoloLensForCV
 
 #if DBG_ENABLE_VERBOSE_LOGGING
             auto cameraViewTransform = sensorFrame->CameraViewTransform;
-            dbg::trace(
+            DBG_LOG(
+                "MediaFrameReaderContext",
+                dbg::LogLevel::Verbose,
                 L"cameraViewTransform=[[%f, %f, %f, %f], [%f, %f, %f, %f], [%f, %f, %f, %f], [%f, %f, %f, %f]]",
                 cameraViewTransform.m11, cameraViewTransform.m12, cameraViewTransform.m13, cameraViewTransform.m14,
                 cameraViewTransform.m21, cameraViewTransform.m22, cameraViewTransform.m23, cameraViewTransform.m24,
@@ -238,7 +318,9 @@ namespace HoloLensForCV
 
 #if DBG_ENABLE_VERBOSE_LOGGING
             auto cameraProjectionTransform = sensorFrame->CameraProjectionTransform;
-            dbg::trace(
+            DBG_LOG(
+                "MediaFrameReaderContext",
+                dbg::LogLevel::Verbose,
                 L"cameraProjectionTransform=[[%f, %f, %f, %f], [%f, %f, %f, %f], [%f, %f, %f, %f], [%f, %f, %f, %f]]",
                 cameraProjectionTransform.m11, cameraProjectionTransform.m12, cameraProjectionTransform.m13, cameraProjectionTransform.m14,
                 cameraProjectionTransform.m21, cameraProjectionTransform.m22, cameraProjectionTransform.m23, cameraProjectionTransform.m24,
@@ -295,7 +377,10 @@ namespace HoloLensForCV
         {
             if (_sensorType != SensorType::PhotoVideo)
             {
-                dbg::trace(
+                DBG_LOG_RATE_LIMITED(
+                    "MediaFrameReaderContext",
+                    dbg::LogLevel::Warning,
+                    1000.0 /* minimum_interval_in_milliseconds */,
                     L"MediaFrameReaderContext::FrameArrived: _sensorType=%s (%i), MFSampleExtension_SensorStreaming_CameraIntrinsics not found!",
                     _sensorType.ToString()->Data(),
                     (int32_t)_sensorType);
@@ -307,8 +392,18 @@ namespace HoloLensForCV
 
         if (nullptr != _sensorFrameSink)
         {
+            DBG_PROFILE_SPAN(
+                "MediaFrameReaderContext::FrameArrived: sink Send");
+
+            const int64_t sendBeginTicks =
+                dbg::Timer::GetCurrentTicks();
+
             _sensorFrameSink->Send(
                 sensorFrame);
+
+            _sinkSendTime->Record(
+                static_cast<uint64_t>(
+                    (dbg::Timer::GetCurrentTicks() - sendBeginTicks) * 1000.0 / dbg::Timer::GetTicksPerMillisecond()));
         }
 
         {
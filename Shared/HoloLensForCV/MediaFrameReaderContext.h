@@ -43,5 +43,13 @@ namespace HoloLensForCV
 
         std::mutex _latestSensorFrameMutex;
         SensorFrame^ _latestSensorFrame;
+
+        int64_t _previousRelativeTimestamp;
+
+        dbg::MetricCounter* _framesArrived;
+        dbg::MetricCounter* _framesUnavailable;
+        dbg::LatencyHistogram* _frameInterval;
+        dbg::LatencyHistogram* _captureToArrivalLatency;
+        dbg::LatencyHistogram* _sinkSendTime;
     };
 }
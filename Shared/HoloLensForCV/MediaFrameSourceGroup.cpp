@@ -144,7 +144,9 @@ namespace HoloLensForCV
                     (0 == wcscmp(c_HoloLensDevelopmentEditionPhotoVideoSourceGroupDisplayName, sourceGroupDisplayName)))
                 {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                    dbg::trace(
+                    DBG_LOG(
+                        "MediaFrameSourceGroup",
+                        dbg::LogLevel::Information,
                         L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: found the photo-video media frame source group.");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -158,7 +160,9 @@ namespace HoloLensForCV
                     (0 == wcscmp(c_HoloLensResearchModeSensorStreamingGroupDisplayName, sourceGroupDisplayName)))
                 {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                    dbg::trace(
+                    DBG_LOG(
+                        "MediaFrameSourceGroup",
+                        dbg::LogLevel::Information,
                         L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: found the HoloLens Sensor Streaming media frame source group.");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -173,7 +177,9 @@ namespace HoloLensForCV
             if (nullptr == selectedSourceGroup)
             {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "MediaFrameSourceGroup",
+                    dbg::LogLevel::Information,
                     L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: selected media frame source group not found.");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -201,7 +207,9 @@ namespace HoloLensForCV
                     Concurrency::task_from_result();
 
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "MediaFrameSourceGroup",
+                    dbg::LogLevel::Information,
                     L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: selected group has %i media frame sources",
                     _mediaCapture->FrameSources->Size);
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -223,7 +231,9 @@ namespace HoloLensForCV
                             // We couldn't map the source to a Research Mode sensor type. Ignore this source.
                             //
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                            dbg::trace(
+                            DBG_LOG(
+                                "MediaFrameSourceGroup",
+                                dbg::LogLevel::Information,
                                 L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: could not map the media frame source to a Research Mode sensor type!");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -235,7 +245,9 @@ namespace HoloLensForCV
                             // We couldn't map the source to a Research Mode sensor type. Ignore this source.
                             //
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                            dbg::trace(
+                            DBG_LOG(
+                                "MediaFrameSourceGroup",
+                                dbg::LogLevel::Information,
                                 L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: sensor type %s has already been initialized!",
                                 sensorType.ToString());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -248,7 +260,9 @@ namespace HoloLensForCV
                             // The sensor type was not explicitly enabled by user. Ignore this source.
                             //
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                            dbg::trace(
+                            DBG_LOG(
+                                "MediaFrameSourceGroup",
+                                dbg::LogLevel::Information,
                                 L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: sensor type %s has not been enabled!",
                                 sensorType.ToString());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -331,7 +345,9 @@ namespace HoloLensForCV
                                     token));
 
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                            dbg::trace(
+                            DBG_LOG(
+                                "MediaFrameSourceGroup",
+                                dbg::LogLevel::Information,
                                 L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: created the '%s' frame reader",
                                 sensorType.ToString()->Data());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -345,7 +361,9 @@ namespace HoloLensForCV
                             if (status == Windows::Media::Capture::Frames::MediaFrameReaderStartStatus::Success)
                             {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                                dbg::trace(
+                                DBG_LOG(
+                                    "MediaFrameSourceGroup",
+                                    dbg::LogLevel::Information,
                                     L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: started the '%s' frame reader",
                                     sensorType.ToString()->Data());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -356,7 +374,9 @@ namespace HoloLensForCV
                             else
                             {
 #if DBG_ENABLE_ERROR_LOGGING
-                                dbg::trace(
+                                DBG_LOG(
+                                    "MediaFrameSourceGroup",
+                                    dbg::LogLevel::Error,
                                     L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: unable to start the '%s' frame reader. Error: %s",
                                     sensorType.ToString()->Data(),
                                     status.ToString()->Data());
@@ -376,7 +396,9 @@ namespace HoloLensForCV
                     if (startedSensors->size() == 0)
                     {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                        dbg::trace(
+                        DBG_LOG(
+                            "MediaFrameSourceGroup",
+                            dbg::LogLevel::Information,
                             L"MediaFrameSourceGroup::InitializeMediaSourceWorkerAsync: no eligible sources in '%s'",
                             selectedSourceGroup->DisplayName->Data());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -398,7 +420,9 @@ namespace HoloLensForCV
         if (MediaFrameSourceGroupType::PhotoVideoCamera == _mediaFrameSourceGroupType)
         {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "MediaFrameSourceGroup",
+                dbg::LogLevel::Information,
                 L"MediaFrameSourceGroup::GetSensorType:: assuming SensorType::PhotoVideo per _mediaFrameSourceGroupType check (source id is '%s')",
                 source->Info->Id->Data());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
@@ -413,7 +437,9 @@ namespace HoloLensForCV
         if (!source->Info->Properties->HasKey(c_MF_MT_USER_DATA))
         {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "MediaFrameSourceGroup",
+                dbg::LogLevel::Information,
                 L"MediaFrameSourceGroup::GetSensorType:: assuming SensorType::Undefined given missing MF_MT_USER_DATA");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -433,7 +459,9 @@ namespace HoloLensForCV
                 sensorNameAsPlatformArray->Data);
 
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-        dbg::trace(
+        DBG_LOG(
+            "MediaFrameSourceGroup",
+            dbg::LogLevel::Information,
             L"MediaFrameSourceGroup::GetSensorType:: found sensor name '%s' in MF_MT_USER_DATA (blob has %i bytes)",
             sensorName,
             sensorNameAsPlatformArray->Length);
@@ -476,7 +504,9 @@ namespace HoloLensForCV
 #endif /* ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS */
         {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "MediaFrameSourceGroup",
+                dbg::LogLevel::Information,
                 L"MediaFrameSourceGroup::GetSensorType:: could not match sensor name to SensorType enumeration");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -510,7 +540,9 @@ namespace HoloLensForCV
                 //if (true)
             {
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "MediaFrameSourceGroup",
+                    dbg::LogLevel::Information,
                     L"MediaFrameSourceGroup::GetSubtypeForFrameReader: evaluating MediaFrameSourceKind::Color with format %s-%s @%i/%iHz and resolution %i x %i",
                     format->MajorType->Data(),
                     format->Subtype->Data(),
@@ -678,7 +710,9 @@ namespace HoloLensForCV
                 initializeMediaCaptureTask.get();
 
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "MediaFrameSourceGroup",
+                    dbg::LogLevel::Information,
                     L"MediaFrameSourceGroup::TryInitializeMediaCaptureAsync: MediaCapture is successfully initialized in shared mode.");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -687,7 +721,9 @@ namespace HoloLensForCV
             catch (Platform::Exception^ exception)
             {
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "MediaFrameSourceGroup",
+                    dbg::LogLevel::Error,
                     L"MediaFrameSourceGroup::TryInitializeMediaCaptureAsync: failed to initialize media capture: %s",
                     exception->Message->Data());
 #endif /* DBG_ENABLE_ERROR_LOGGING */
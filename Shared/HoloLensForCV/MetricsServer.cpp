@@ -0,0 +1,225 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Only the request line is looked at; the rest of the request is ignored.
+        //
+        const uint32_t c_maximumRequestLength = 4096;
+
+        Platform::String^ ToPlatformString(
+            _In_ const std::string& value)
+        {
+            const std::wstring wideValue(
+                value.begin(),
+                value.end());
+
+            return ref new Platform::String(
+                wideValue.c_str());
+        }
+
+        std::string FormatHttpResponse(
+            _In_ const std::string& request)
+        {
+            std::string status = "200 OK";
+            std::string contentType;
+            std::string body;
+
+            if (0 == request.compare(0, 18, "GET /metrics.json ") ||
+                0 == request.compare(0, 18, "GET /metrics.json?"))
+            {
+                contentType = "application/json";
+                body = dbg::Metrics::GetMetricsAsJson();
+            }
+            else if (0 == request.compare(0, 6, "GET / ") ||
+                0 == request.compare(0, 13, "GET /metrics ") ||
+                0 == request.compare(0, 13, "GET /metrics?"))
+            {
+                contentType = "text/plain; version=0.0.4";
+                body = dbg::Metrics::GetMetricsAsText();
+            }
+            else
+            {
+                status = "404 Not Found";
+                contentType = "text/plain";
+                body = "Try GET /metrics or GET /metrics.json\n";
+            }
+
+            std::ostringstream response;
+
+            response
+                << "HTTP/1.0 " << status << "\r\n"
+                << "Content-Type: " << contentType << "\r\n"
+                << "Content-Length: " << body.size() << "\r\n"
+                << "Connection: close\r\n"
+                << "\r\n"
+                << body;
+
+            return response.str();
+        }
+    }
+
+    MetricsServer::MetricsServer(
+        _In_ Platform::String^ serviceName)
+    {
+        _listener = ref new Windows::Networking::Sockets::StreamSocketListener();
+
+        _listener->ConnectionReceived +=
+            ref new Windows::Foundation::TypedEventHandler<
+            Windows::Networking::Sockets::StreamSocketListener^,
+            Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^>(
+                this,
+                &MetricsServer::OnConnection);
+
+        Concurrency::create_task(_listener->BindServiceNameAsync(serviceName)).then(
+            [this](Concurrency::task<void> previousTask)
+            {
+                try
+                {
+                    previousTask.get();
+                }
+                catch (Platform::Exception^ exception)
+                {
+#if DBG_ENABLE_ERROR_LOGGING
+                    DBG_LOG(
+                        "MetricsServer",
+                        dbg::LogLevel::Error,
+                        L"MetricsServer::MetricsServer: %s",
+                        exception->Message->Data());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+                }
+            });
+    }
+
+    MetricsServer::~MetricsServer()
+    {
+        delete _listener;
+        _listener = nullptr;
+    }
+
+    /* static */ Platform::String^ MetricsServer::GetMetricsAsText()
+    {
+        return ToPlatformString(
+            dbg::Metrics::GetMetricsAsText());
+    }
+
+    /* static */ Platform::String^ MetricsServer::GetMetricsAsJson()
+    {
+        return ToPlatformString(
+            dbg::Metrics::GetMetricsAsJson());
+    }
+
+    /* static */ Platform::String^ MetricsServer::RunOverheadBenchmark(
+        _In_ uint32_t numberOfThreads)
+    {
+        dbg::Metrics::BenchmarkStatistics statistics;
+
+        dbg::Metrics::Benchmark(
+            numberOfThreads,
+            1024 * 1024 /* numberOfUpdatesPerThread */,
+            statistics);
+
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        stream
+            << "{\"counter_increment_ns\":" << statistics.CounterIncrementTimeInNanoseconds
+            << ",\"gauge_set_ns\":" << statistics.GaugeSetTimeInNanoseconds
+            << ",\"histogram_record_ns\":" << statistics.HistogramRecordTimeInNanoseconds
+            << ",\"threads\":" << statistics.NumberOfThreads
+            << ",\"contended_histogram_record_ns\":" << statistics.ContendedHistogramRecordTimeInNanoseconds
+            << ",\"text_formatting_ms\":" << statistics.TextFormattingTimeInMilliseconds
+            << ",\"json_formatting_ms\":" << statistics.JsonFormattingTimeInMilliseconds
+            << "}";
+
+        return ToPlatformString(
+            stream.str());
+    }
+
+    void MetricsServer::OnConnection(
+        Windows::Networking::Sockets::StreamSocketListener^ listener,
+        Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^ object)
+    {
+        Windows::Networking::Sockets::StreamSocket^ socket =
+            object->Socket;
+
+        Windows::Storage::Streams::DataReader^ reader =
+            ref new Windows::Storage::Streams::DataReader(
+                socket->InputStream);
+
+        reader->InputStreamOptions =
+            Windows::Storage::Streams::InputStreamOptions::Partial;
+
+        Concurrency::create_task(reader->LoadAsync(c_maximumRequestLength)).then(
+            [socket, reader](Concurrency::task<unsigned int> loadTask)
+            {
+                const unsigned int numberOfBytesLoaded =
+                    loadTask.get();
+
+                std::string request(
+                    numberOfBytesLoaded,
+                    '\0');
+
+                if (numberOfBytesLoaded > 0)
+                {
+                    reader->ReadBytes(
+                        Platform::ArrayReference<uint8_t>(
+                            reinterpret_cast<uint8_t*>(&request[0]),
+                            numberOfBytesLoaded));
+                }
+
+                std::string response =
+                    FormatHttpResponse(
+                        request);
+
+                Windows::Storage::Streams::DataWriter^ writer =
+                    ref new Windows::Storage::Streams::DataWriter(
+                        socket->OutputStream);
+
+                writer->WriteBytes(
+                    Platform::ArrayReference<uint8_t>(
+                        reinterpret_cast<uint8_t*>(&response[0]),
+                        static_cast<unsigned int>(response.size())));
+
+                return Concurrency::create_task(writer->StoreAsync()).then(
+                    [writer](unsigned int)
+                    {
+                        return writer->FlushAsync();
+                    });
+            }).then(
+            [socket](Concurrency::task<bool> flushTask)
+            {
+                try
+                {
+                    flushTask.get();
+                }
+                catch (Platform::Exception^ exception)
+                {
+#if DBG_ENABLE_ERROR_LOGGING
+                    DBG_LOG(
+                        "MetricsServer",
+                        dbg::LogLevel::Error,
+                        L"MetricsServer::OnConnection: %s",
+                        exception->Message->Data());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+                }
+
+                delete socket;
+            });
+    }
+}
@@ -0,0 +1,50 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Serves the pipeline metrics (see dbg::Metrics) over HTTP: GET /metrics returns them
+    // in the Prometheus text format, GET /metrics.json as JSON. Each request is answered
+    // on its own connection, which is then closed, e.g.
+    //
+    //   curl http://<hololens>:10090/metrics
+    //
+    public ref class MetricsServer sealed
+    {
+    public:
+        MetricsServer(
+            _In_ Platform::String^ serviceName);
+
+        static Platform::String^ GetMetricsAsText();
+
+        static Platform::String^ GetMetricsAsJson();
+
+        //
+        // Measures the cost of updating the metrics (see dbg::Metrics::Benchmark) and
+        // returns the results as JSON.
+        //
+        static Platform::String^ RunOverheadBenchmark(
+            _In_ uint32_t numberOfThreads);
+
+    private:
+        ~MetricsServer();
+
+        void OnConnection(
+            Windows::Networking::Sockets::StreamSocketListener^ listener,
+            Windows::Networking::Sockets::StreamSocketListenerConnectionReceivedEventArgs^ object);
+
+    private:
+        Windows::Networking::Sockets::StreamSocketListener^ _listener;
+    };
+}
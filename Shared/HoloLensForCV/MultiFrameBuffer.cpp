@@ -22,6 +22,15 @@ namespace HoloLensForCV
         return timeDiff100ns * 1e-7;
     }
 
+    MultiFrameBuffer::MultiFrameBuffer()
+        : _framesBuffered(&dbg::Metrics::GetCounter("hololensforcv_multi_frame_buffer_frames_buffered_total"))
+        , _framesEvicted(&dbg::Metrics::GetCounter("hololensforcv_multi_frame_buffer_frames_evicted_total"))
+        , _bufferedFrames(&dbg::Metrics::GetGauge("hololensforcv_multi_frame_buffer_buffered_frames"))
+        , _frameLookupHits(&dbg::Metrics::GetCounter("hololensforcv_multi_frame_buffer_frame_lookup_hits_total"))
+        , _frameLookupMisses(&dbg::Metrics::GetCounter("hololensforcv_multi_frame_buffer_frame_lookup_misses_total"))
+    {
+    }
+
     ISensorFrameSink^ MultiFrameBuffer::GetSensorFrameSink(
         _In_ SensorType /* sensorType */)
     {
@@ -36,10 +45,16 @@ namespace HoloLensForCV
         auto& buffer = _frames[sensorFrame->FrameType];
         
         buffer.push_back(sensorFrame);
+
+        _framesBuffered->Increment();
+        _bufferedFrames->Add(1);
         
         while (buffer.size() > 5)
         {
             buffer.pop_front();
+
+            _framesEvicted->Increment();
+            _bufferedFrames->Add(-1);
         }
     }
 
@@ -77,10 +92,14 @@ namespace HoloLensForCV
 
             if (secondsDifference < toleranceInSeconds)
             {
+                _frameLookupHits->Increment();
+
                 return f;
             }
         }
 
+        _frameLookupMisses->Increment();
+
         return nullptr;
     }
 
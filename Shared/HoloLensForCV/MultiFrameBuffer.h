@@ -18,6 +18,8 @@ namespace HoloLensForCV
         , public ISensorFrameSinkGroup
     {
     public:
+        MultiFrameBuffer();
+
         virtual void Send(
             SensorFrame^ sensorFrame);
 
@@ -40,5 +42,11 @@ namespace HoloLensForCV
     private:
         std::map<SensorType, std::deque<SensorFrame^>> _frames;
         std::mutex _framesMutex;
+
+        dbg::MetricCounter* _framesBuffered;
+        dbg::MetricCounter* _framesEvicted;
+        dbg::MetricGauge* _bufferedFrames;
+        dbg::MetricCounter* _frameLookupHits;
+        dbg::MetricCounter* _frameLookupMisses;
     };
 }
@@ -0,0 +1,293 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        std::array<float, 16> ToArray(
+            _In_ const Windows::Foundation::Numerics::float4x4& matrix)
+        {
+            std::array<float, 16> values;
+
+            static_assert(
+                sizeof(values) == sizeof(matrix),
+                "float4x4 must hold 16 contiguous floats");
+
+            memcpy(
+                values.data(),
+                &matrix,
+                sizeof(values));
+
+            return values;
+        }
+
+        Platform::String^ ToPlatformString(
+            _In_ const std::string& value)
+        {
+            const std::wstring wideValue(
+                value.begin(),
+                value.end());
+
+            return ref new Platform::String(
+                wideValue.c_str());
+        }
+    }
+
+    PlaneDetectionSink::PlaneDetectionSink(
+        _In_ SensorType sensorType,
+        _In_opt_ ISensorFrameSink^ downstreamSink)
+        : _sensorType(sensorType)
+        , _downstreamSink(downstreamSink)
+    {
+    }
+
+    PlaneDetectionSink::~PlaneDetectionSink()
+    {
+    }
+
+    void PlaneDetectionSink::Send(
+        _In_ SensorFrame^ sensorFrame)
+    {
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            sensorFrame->SoftwareBitmap;
+
+        if (nullptr != softwareBitmap &&
+            Windows::Graphics::Imaging::BitmapPixelFormat::Gray16 == softwareBitmap->BitmapPixelFormat)
+        {
+            DetectPlanes(
+                sensorFrame);
+        }
+
+        if (nullptr != _downstreamSink)
+        {
+            _downstreamSink->Send(
+                sensorFrame);
+        }
+    }
+
+    Platform::String^ PlaneDetectionSink::GetPlanesAsJson()
+    {
+        std::string json;
+
+        {
+            std::lock_guard<std::mutex> guard(_detectorMutex);
+
+            json = (nullptr != _detector) ?
+                _detector->GetPlanesAsJson() :
+                "{\"frame\":0,\"planes\":[]}";
+        }
+
+        return ToPlatformString(
+            json);
+    }
+
+    Windows::Graphics::Imaging::SoftwareBitmap^ PlaneDetectionSink::GetInlierMask()
+    {
+        std::lock_guard<std::mutex> guard(_detectorMutex);
+
+        if (_labels.empty())
+        {
+            return nullptr;
+        }
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            ref new Windows::Graphics::Imaging::SoftwareBitmap(
+                Windows::Graphics::Imaging::BitmapPixelFormat::Gray8,
+                _labels.cols,
+                _labels.rows,
+                Windows::Graphics::Imaging::BitmapAlphaMode::Ignore);
+
+        {
+            Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+                softwareBitmap->LockBuffer(
+                    Windows::Graphics::Imaging::BitmapBufferAccessMode::Write);
+
+            const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+                bitmapBuffer->GetPlaneDescription(0);
+
+            Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+                bitmapBuffer->CreateReference();
+
+            uint32_t pixelBufferDataLength = 0;
+
+            uint8_t* pixelBufferData =
+                Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                    bitmapBufferReference,
+                    pixelBufferDataLength);
+
+            _labels.copyTo(
+                cv::Mat(
+                    _labels.rows,
+                    _labels.cols,
+                    CV_8UC1,
+                    pixelBufferData + bitmapPlaneDescription.StartIndex,
+                    bitmapPlaneDescription.Stride));
+
+            delete bitmapBufferReference;
+            delete bitmapBuffer;
+        }
+
+        return softwareBitmap;
+    }
+
+    Platform::String^ PlaneDetectionSink::GetStageTimingsAsJson()
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        {
+            std::lock_guard<std::mutex> guard(_detectorMutex);
+
+            const double scale =
+                (_timings.NumberOfFrames > 0) ? 1.0 / _timings.NumberOfFrames : 0.0;
+
+            stream
+                << "{\"frames\":" << _timings.NumberOfFrames
+                << ",\"normals_ms\":" << _timings.NormalsTimeInMilliseconds * scale
+                << ",\"tracking_ms\":" << _timings.TrackingTimeInMilliseconds * scale
+                << ",\"detection_ms\":" << _timings.DetectionTimeInMilliseconds * scale
+                << ",\"total_ms\":" << _timings.TotalTimeInMilliseconds * scale
+                << ",\"max_total_ms\":" << _timings.MaximumTotalTimeInMilliseconds
+                << ",\"hypotheses_per_frame\":" << _timings.NumberOfHypotheses * scale
+                << "}";
+        }
+
+        return ToPlatformString(
+            stream.str());
+    }
+
+    void PlaneDetectionSink::ResetPlanes()
+    {
+        std::lock_guard<std::mutex> guard(_detectorMutex);
+
+        if (nullptr != _detector)
+        {
+            _detector->Reset();
+        }
+
+        _labels.release();
+    }
+
+    void PlaneDetectionSink::DetectPlanes(
+        _In_ SensorFrame^ sensorFrame)
+    {
+        std::lock_guard<std::mutex> guard(_detectorMutex);
+
+        //
+        // The same frame may be delivered more than once; process it only once.
+        //
+        if (_prevFrameTimestamp.Equals(sensorFrame->Timestamp))
+        {
+            return;
+        }
+
+        _prevFrameTimestamp = sensorFrame->Timestamp;
+
+        if (nullptr == _detector &&
+            !CreatePlaneDetector(sensorFrame->SensorStreamingCameraIntrinsics))
+        {
+            return;
+        }
+
+        cv::Matx44f cameraToWorld;
+
+        if (!PointCloudGenerator::ComputeCameraToWorld(
+                ToArray(sensorFrame->FrameToOrigin),
+                ToArray(sensorFrame->CameraViewTransform),
+                cameraToWorld))
+        {
+            return;
+        }
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            sensorFrame->SoftwareBitmap;
+
+        Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+            softwareBitmap->LockBuffer(
+                Windows::Graphics::Imaging::BitmapBufferAccessMode::Read);
+
+        const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+            bitmapBuffer->GetPlaneDescription(0);
+
+        Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+            bitmapBuffer->CreateReference();
+
+        uint32_t pixelBufferDataLength = 0;
+
+        uint8_t* pixelBufferData =
+            Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                bitmapBufferReference,
+                pixelBufferDataLength);
+
+        const cv::Mat depth(
+            softwareBitmap->PixelHeight,
+            softwareBitmap->PixelWidth,
+            CV_16UC1,
+            pixelBufferData + bitmapPlaneDescription.StartIndex,
+            bitmapPlaneDescription.Stride);
+
+        _detector->Process(
+            depth,
+            cameraToWorld,
+            _labels);
+
+        delete bitmapBufferReference;
+        delete bitmapBuffer;
+
+        const PlaneDetector::FrameTimings& frameTimings =
+            _detector->GetLastFrameTimings();
+
+        ++_timings.NumberOfFrames;
+        _timings.NumberOfHypotheses += frameTimings.NumberOfHypotheses;
+        _timings.NormalsTimeInMilliseconds += frameTimings.NormalsTimeInMilliseconds;
+        _timings.TrackingTimeInMilliseconds += frameTimings.TrackingTimeInMilliseconds;
+        _timings.DetectionTimeInMilliseconds += frameTimings.DetectionTimeInMilliseconds;
+        _timings.TotalTimeInMilliseconds += frameTimings.TotalTimeInMilliseconds;
+
+        _timings.MaximumTotalTimeInMilliseconds =
+            std::max(
+                _timings.MaximumTotalTimeInMilliseconds,
+                frameTimings.TotalTimeInMilliseconds);
+    }
+
+    bool PlaneDetectionSink::CreatePlaneDetector(
+        _In_ CameraIntrinsics^ cameraIntrinsics)
+    {
+        if (nullptr == cameraIntrinsics)
+        {
+            return false;
+        }
+
+        cv::Mat unitPlaneMap;
+
+        if (!cameraIntrinsics->ComputeUnitPlaneMap(
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        const std::wstring sensorName =
+            GetSensorTypeName(_sensorType);
+
+        _detector.reset(
+            new PlaneDetector(
+                unitPlaneMap,
+                PlaneDetector::GetDefaultOptions(
+                    std::string(sensorName.begin(), sensorName.end()))));
+
+        return true;
+    }
+}
@@ -0,0 +1,76 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Detects and tracks planes (see PlaneDetector) in the frames of a depth sensor, then
+    // passes the frames on to another sink, if any. The tracked planes and the inlier
+    // mask of the last frame can be polled at any time.
+    //
+    public ref class PlaneDetectionSink sealed
+        : public ISensorFrameSink
+    {
+    public:
+        PlaneDetectionSink(
+            _In_ SensorType sensorType,
+            _In_opt_ ISensorFrameSink^ downstreamSink);
+
+        virtual void Send(
+            _In_ SensorFrame^ sensorFrame);
+
+        //
+        // Returns the tracked planes, in the world coordinate system of the last frame,
+        // as JSON (see PlaneDetector::GetPlanesAsJson).
+        //
+        Platform::String^ GetPlanesAsJson();
+
+        //
+        // Returns the inlier mask of the last frame as a Gray8 bitmap: each pixel holds
+        // the label of the plane it belongs to, or zero. Returns nullptr before the first
+        // frame.
+        //
+        Windows::Graphics::Imaging::SoftwareBitmap^ GetInlierMask();
+
+        //
+        // Returns the average per-frame latency of each stage, as JSON.
+        //
+        Platform::String^ GetStageTimingsAsJson();
+
+        void ResetPlanes();
+
+    private:
+        ~PlaneDetectionSink();
+
+        void DetectPlanes(
+            _In_ SensorFrame^ sensorFrame);
+
+        bool CreatePlaneDetector(
+            _In_ CameraIntrinsics^ cameraIntrinsics);
+
+    private:
+        SensorType _sensorType;
+
+        ISensorFrameSink^ _downstreamSink;
+
+        std::mutex _detectorMutex;
+
+        std::unique_ptr<PlaneDetector> _detector;
+
+        cv::Mat _labels;
+
+        PlaneDetector::BenchmarkStatistics _timings;
+
+        Windows::Foundation::DateTime _prevFrameTimestamp;
+    };
+}
@@ -0,0 +1,1115 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Labels are stored as uint8_t, zero meaning no plane.
+        //
+        const int32_t c_maximumNumberOfLabels = 255;
+
+        int32_t GetNumberOfBands(
+            _In_ size_t numberOfItems)
+        {
+            return static_cast<int32_t>(
+                std::max<size_t>(1, std::min<size_t>(numberOfItems / 1024 + 1, cv::getNumThreads() * 4)));
+        }
+
+        const char* GetOrientationName(
+            _In_ PlaneDetector::PlaneOrientation orientation)
+        {
+            switch (orientation)
+            {
+            case PlaneDetector::PlaneOrientation::HorizontalUp:
+                return "horizontal_up";
+
+            case PlaneDetector::PlaneOrientation::HorizontalDown:
+                return "horizontal_down";
+
+            case PlaneDetector::PlaneOrientation::Vertical:
+                return "vertical";
+
+            default:
+                return "oblique";
+            }
+        }
+
+        //
+        // Counts the points within the given distance of a plane (a, b, c, d) whose normals
+        // are within the given angle of the plane's normal, in either direction.
+        //
+        int32_t CountInliers(
+            _In_reads_(count) const float* pointX,
+            _In_reads_(count) const float* pointY,
+            _In_reads_(count) const float* pointZ,
+            _In_reads_(count) const float* normalX,
+            _In_reads_(count) const float* normalY,
+            _In_reads_(count) const float* normalZ,
+            _In_ size_t count,
+            _In_ const cv::Vec4f& plane,
+            _In_ float distanceThreshold,
+            _In_ float cosineThreshold)
+        {
+            const float a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+
+            int32_t numberOfInliers = 0;
+
+            size_t i = 0;
+
+#if CV_SIMD128
+            const cv::v_float32x4 va = cv::v_setall_f32(a);
+            const cv::v_float32x4 vb = cv::v_setall_f32(b);
+            const cv::v_float32x4 vc = cv::v_setall_f32(c);
+            const cv::v_float32x4 vd = cv::v_setall_f32(d);
+            const cv::v_float32x4 vDistanceThreshold = cv::v_setall_f32(distanceThreshold);
+            const cv::v_float32x4 vCosineThreshold = cv::v_setall_f32(cosineThreshold);
+
+            cv::v_int32x4 counts = cv::v_setzero_s32();
+
+            for (; i + 4 <= count; i += 4)
+            {
+                const cv::v_float32x4 distance =
+                    cv::v_muladd(va, cv::v_load(pointX + i),
+                        cv::v_muladd(vb, cv::v_load(pointY + i),
+                            cv::v_muladd(vc, cv::v_load(pointZ + i), vd)));
+
+                const cv::v_float32x4 cosine =
+                    cv::v_muladd(va, cv::v_load(normalX + i),
+                        cv::v_muladd(vb, cv::v_load(normalY + i),
+                            vc * cv::v_load(normalZ + i)));
+
+                const cv::v_float32x4 isInlier =
+                    (cv::v_abs(distance) < vDistanceThreshold) &
+                    (cv::v_abs(cosine) > vCosineThreshold);
+
+                //
+                // The comparison masks are all ones, i.e. -1, for inliers.
+                //
+                counts -= cv::v_reinterpret_as_s32(isInlier);
+            }
+
+            numberOfInliers += cv::v_reduce_sum(counts);
+#endif /* CV_SIMD128 */
+
+            for (; i < count; ++i)
+            {
+                const float distance = a * pointX[i] + b * pointY[i] + c * pointZ[i] + d;
+                const float cosine = a * normalX[i] + b * normalY[i] + c * normalZ[i];
+
+                if (std::abs(distance) < distanceThreshold &&
+                    std::abs(cosine) > cosineThreshold)
+                {
+                    ++numberOfInliers;
+                }
+            }
+
+            return numberOfInliers;
+        }
+    }
+
+    PlaneDetector::Options::Options()
+        : DistanceThresholdInMeters(0.02f)
+        , NormalThresholdInDegrees(15.0f)
+        , MinimumNumberOfInliers(1500)
+        , MaximumNumberOfNewPlanes(6)
+        , MaximumNumberOfPlanes(32)
+        , SampleStride(4)
+        , HypothesesPerBatch(16)
+        , MaximumNumberOfHypotheses(256)
+        , Confidence(0.99f)
+        , MergeAngleThresholdInDegrees(10.0f)
+        , MergeDistanceThresholdInMeters(0.05f)
+        , ObservationDecay(0.9f)
+        , MaximumAgeInFrames(300)
+        , OrientationThresholdInDegrees(10.0f)
+        , RandomSeed(0x5eed)
+    {
+    }
+
+    PlaneDetector::FrameTimings::FrameTimings()
+        : NormalsTimeInMilliseconds(0.0)
+        , TrackingTimeInMilliseconds(0.0)
+        , DetectionTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , NumberOfHypotheses(0)
+    {
+    }
+
+    PlaneDetector::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfFrames(0)
+        , NumberOfFramesWithoutPose(0)
+        , NumberOfNewPlanes(0)
+        , NumberOfTrackedPlaneObservations(0)
+        , NumberOfHypotheses(0)
+        , NumberOfPlanes(0)
+        , NormalsTimeInMilliseconds(0.0)
+        , TrackingTimeInMilliseconds(0.0)
+        , DetectionTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , MaximumTotalTimeInMilliseconds(0.0)
+    {
+    }
+
+    PlaneDetector::Moments::Moments()
+        : Weight(0.0)
+        , Mean(0.0, 0.0, 0.0)
+        , Scatter(cv::Matx33d::zeros())
+    {
+    }
+
+    void PlaneDetector::Moments::Add(
+        _In_ const Moments& other)
+    {
+        if (other.Weight <= 0.0)
+        {
+            return;
+        }
+
+        if (Weight <= 0.0)
+        {
+            *this = other;
+
+            return;
+        }
+
+        const double weight = Weight + other.Weight;
+
+        const cv::Vec3d delta = other.Mean - Mean;
+
+        Scatter += other.Scatter + (Weight * other.Weight / weight) * (delta * delta.t());
+        Mean += delta * (other.Weight / weight);
+        Weight = weight;
+    }
+
+    bool PlaneDetector::Moments::FitPlane(
+        _In_ const cv::Vec3d& viewpoint,
+        _Out_ cv::Vec3d& normal,
+        _Out_ double& offset) const
+    {
+        if (Weight < 3.0)
+        {
+            return false;
+        }
+
+        const double covariance[6] =
+        {
+            Scatter(0, 0) / Weight,
+            Scatter(0, 1) / Weight,
+            Scatter(0, 2) / Weight,
+            Scatter(1, 1) / Weight,
+            Scatter(1, 2) / Weight,
+            Scatter(2, 2) / Weight
+        };
+
+        double surfaceVariation = 0.0;
+
+        if (!SurfaceNormalEstimator::ComputeSmallestEigenvector(
+                covariance,
+                normal,
+                surfaceVariation))
+        {
+            return false;
+        }
+
+        if (normal.dot(viewpoint - Mean) < 0.0)
+        {
+            normal = -normal;
+        }
+
+        offset = -normal.dot(Mean);
+
+        return true;
+    }
+
+    void PlaneDetector::Candidates::Clear()
+    {
+        PointX.clear();
+        PointY.clear();
+        PointZ.clear();
+        NormalX.clear();
+        NormalY.clear();
+        NormalZ.clear();
+        Pixels.clear();
+        Labels.clear();
+    }
+
+    size_t PlaneDetector::Candidates::Size() const
+    {
+        return Pixels.size();
+    }
+
+    /* static */ PlaneDetector::Options PlaneDetector::GetDefaultOptions(
+        _In_ const std::string& sensorName)
+    {
+        Options options;
+
+        options.Normals.Depth =
+            PointCloudGenerator::GetDefaultOptions(
+                sensorName);
+
+        if ("long_throw_depth" == sensorName)
+        {
+            //
+            // Surfaces are further away, hence noisier and smaller in the image.
+            //
+            options.DistanceThresholdInMeters = 0.04f;
+            options.NormalThresholdInDegrees = 20.0f;
+            options.MinimumNumberOfInliers = 800;
+            options.MergeDistanceThresholdInMeters = 0.08f;
+        }
+
+        return options;
+    }
+
+    PlaneDetector::PlaneDetector(
+        _In_ const cv::Mat& unitPlaneMap,
+        _In_ const Options& options)
+        : _options(options)
+        , _normalEstimator(unitPlaneMap, options.Normals)
+        , _random(options.RandomSeed)
+        , _frameIndex(0)
+        , _nextPlaneId(1)
+    {
+        REQUIRES(
+            SurfaceNormalEstimator::Method::CrossProduct == options.Normals.EstimationMethod &&
+            options.SampleStride >= 1 &&
+            options.HypothesesPerBatch >= 1 &&
+            options.MinimumNumberOfInliers >= options.SampleStride &&
+            options.MaximumNumberOfPlanes < c_maximumNumberOfLabels);
+    }
+
+    const PlaneDetector::Options& PlaneDetector::GetOptions() const
+    {
+        return _options;
+    }
+
+    void PlaneDetector::Process(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& cameraToWorld,
+        _Out_ cv::Mat& labels)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        ++_frameIndex;
+
+        _lastFrameTimings = FrameTimings();
+
+        DropStalePlanes();
+
+        for (TrackedPlane& trackedPlane : _trackedPlanes)
+        {
+            trackedPlane.Parameters.NumberOfInliers = 0;
+        }
+
+        _normalEstimator.Compute(
+            depth,
+            _normals);
+
+        GatherCandidates();
+
+        const Clock::time_point trackingStartTime =
+            Clock::now();
+
+        TrackPlanes(
+            cameraToWorld);
+
+        const Clock::time_point detectionStartTime =
+            Clock::now();
+
+        DetectPlanes(
+            cameraToWorld);
+
+        const Clock::time_point endTime =
+            Clock::now();
+
+        labels.create(
+            depth.size(),
+            CV_8UC1);
+
+        labels = cv::Scalar::all(0);
+
+        for (size_t i = 0; i < _candidates.Size(); ++i)
+        {
+            if (0 != _candidates.Labels[i])
+            {
+                labels.ptr<uint8_t>()[_candidates.Pixels[i]] =
+                    _candidates.Labels[i];
+            }
+        }
+
+        _planes.clear();
+
+        for (const TrackedPlane& trackedPlane : _trackedPlanes)
+        {
+            _planes.push_back(
+                trackedPlane.Parameters);
+        }
+
+        _lastFrameTimings.NormalsTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(trackingStartTime - startTime).count();
+
+        _lastFrameTimings.TrackingTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(detectionStartTime - trackingStartTime).count();
+
+        _lastFrameTimings.DetectionTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(endTime - detectionStartTime).count();
+
+        _lastFrameTimings.TotalTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+    }
+
+    const std::vector<PlaneDetector::Plane>& PlaneDetector::GetPlanes() const
+    {
+        return _planes;
+    }
+
+    const PlaneDetector::FrameTimings& PlaneDetector::GetLastFrameTimings() const
+    {
+        return _lastFrameTimings;
+    }
+
+    std::string PlaneDetector::GetPlanesAsJson() const
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        stream << "{\"frame\":" << _frameIndex << ",\"planes\":[";
+
+        for (size_t i = 0; i < _planes.size(); ++i)
+        {
+            const Plane& plane = _planes[i];
+
+            stream
+                << ((i > 0) ? "," : "")
+                << "{\"label\":" << (i + 1)
+                << ",\"id\":" << plane.Id
+                << ",\"normal\":[" << plane.Normal[0] << "," << plane.Normal[1] << "," << plane.Normal[2] << "]"
+                << ",\"offset\":" << plane.Offset
+                << ",\"centroid\":[" << plane.Centroid.x << "," << plane.Centroid.y << "," << plane.Centroid.z << "]"
+                << ",\"orientation\":\"" << GetOrientationName(plane.Orientation) << "\""
+                << ",\"inliers\":" << plane.NumberOfInliers
+                << ",\"observations\":" << plane.NumberOfObservations
+                << ",\"last_observed_frame\":" << plane.LastObservedFrame
+                << "}";
+        }
+
+        stream << "]}";
+
+        return stream.str();
+    }
+
+    void PlaneDetector::Reset()
+    {
+        _trackedPlanes.clear();
+        _planes.clear();
+    }
+
+    /* static */ bool PlaneDetector::BenchmarkRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName,
+        _In_ const Options& options,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        statistics = BenchmarkStatistics();
+
+        SensorFrameRecordingReader reader;
+
+        if (!reader.Open(recordingFolder, sensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> archive =
+            reader.OpenArchive();
+
+        RecordedSensorFrame frame;
+
+        if (!reader.ReadFrame(0, archive.get(), frame))
+        {
+            return false;
+        }
+
+        cv::Mat unitPlaneMap;
+
+        if (!PointCloudGenerator::LoadUnitPlaneMap(
+                recordingFolder,
+                sensorName,
+                frame.Image.cols,
+                frame.Image.rows,
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        PlaneDetector detector(
+            unitPlaneMap,
+            options);
+
+        cv::Mat labels;
+
+        for (size_t i = 0; i < reader.GetNumberOfFrames(); ++i)
+        {
+            if (!reader.ReadFrame(i, archive.get(), frame) ||
+                CV_16UC1 != frame.Image.type() ||
+                frame.Image.size() != unitPlaneMap.size())
+            {
+                continue;
+            }
+
+            cv::Matx44f cameraToWorld;
+
+            if (!PointCloudGenerator::ComputeCameraToWorld(
+                    frame.FrameToOrigin,
+                    frame.CameraViewTransform,
+                    cameraToWorld))
+            {
+                ++statistics.NumberOfFramesWithoutPose;
+                continue;
+            }
+
+            const uint32_t nextPlaneId =
+                detector._nextPlaneId;
+
+            detector.Process(
+                frame.Image,
+                cameraToWorld,
+                labels);
+
+            ++statistics.NumberOfFrames;
+
+            statistics.NumberOfNewPlanes +=
+                detector._nextPlaneId - nextPlaneId;
+
+            for (const Plane& plane : detector.GetPlanes())
+            {
+                if (plane.LastObservedFrame == detector._frameIndex &&
+                    plane.NumberOfObservations > 1)
+                {
+                    ++statistics.NumberOfTrackedPlaneObservations;
+                }
+            }
+
+            const FrameTimings& timings =
+                detector.GetLastFrameTimings();
+
+            statistics.NumberOfHypotheses += timings.NumberOfHypotheses;
+            statistics.NormalsTimeInMilliseconds += timings.NormalsTimeInMilliseconds;
+            statistics.TrackingTimeInMilliseconds += timings.TrackingTimeInMilliseconds;
+            statistics.DetectionTimeInMilliseconds += timings.DetectionTimeInMilliseconds;
+            statistics.TotalTimeInMilliseconds += timings.TotalTimeInMilliseconds;
+
+            statistics.MaximumTotalTimeInMilliseconds =
+                std::max(
+                    statistics.MaximumTotalTimeInMilliseconds,
+                    timings.TotalTimeInMilliseconds);
+        }
+
+        statistics.NumberOfPlanes =
+            detector.GetPlanes().size();
+
+        if (statistics.NumberOfFrames > 0)
+        {
+            const double scale = 1.0 / statistics.NumberOfFrames;
+
+            statistics.NormalsTimeInMilliseconds *= scale;
+            statistics.TrackingTimeInMilliseconds *= scale;
+            statistics.DetectionTimeInMilliseconds *= scale;
+            statistics.TotalTimeInMilliseconds *= scale;
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "PlaneDetector",
+            dbg::LogLevel::Information,
+            L"PlaneDetector::BenchmarkRecording: %S: %llu frames, %.3f ms/frame (normals %.3f, tracking %.3f, detection %.3f), max %.3f ms, %llu planes",
+            sensorName.c_str(),
+            statistics.NumberOfFrames,
+            statistics.TotalTimeInMilliseconds,
+            statistics.NormalsTimeInMilliseconds,
+            statistics.TrackingTimeInMilliseconds,
+            statistics.DetectionTimeInMilliseconds,
+            statistics.MaximumTotalTimeInMilliseconds,
+            statistics.NumberOfPlanes);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return statistics.NumberOfFrames > 0;
+    }
+
+    void PlaneDetector::GatherCandidates()
+    {
+        _candidates.Clear();
+
+        cv::Mat pointX, pointY, pointZ;
+
+        _normalEstimator.GetPoints(
+            pointX,
+            pointY,
+            pointZ);
+
+        for (int32_t v = 0; v < _normals.rows; ++v)
+        {
+            const cv::Vec4f* normalRow = _normals.ptr<cv::Vec4f>(v);
+
+            const float* pointXRow = pointX.ptr<float>(v);
+            const float* pointYRow = pointY.ptr<float>(v);
+            const float* pointZRow = pointZ.ptr<float>(v);
+
+            for (int32_t u = 0; u < _normals.cols; ++u)
+            {
+                if (std::isnan(normalRow[u][0]))
+                {
+                    continue;
+                }
+
+                _candidates.PointX.push_back(pointXRow[u]);
+                _candidates.PointY.push_back(pointYRow[u]);
+                _candidates.PointZ.push_back(pointZRow[u]);
+                _candidates.NormalX.push_back(normalRow[u][0]);
+                _candidates.NormalY.push_back(normalRow[u][1]);
+                _candidates.NormalZ.push_back(normalRow[u][2]);
+                _candidates.Pixels.push_back(v * _normals.cols + u);
+            }
+        }
+
+        _candidates.Labels.assign(
+            _candidates.Size(),
+            0);
+    }
+
+    void PlaneDetector::TrackPlanes(
+        _In_ const cv::Matx44f& cameraToWorld)
+    {
+        const cv::Matx33f rotation = cameraToWorld.get_minor<3, 3>(0, 0);
+        const cv::Vec3f translation(cameraToWorld(0, 3), cameraToWorld(1, 3), cameraToWorld(2, 3));
+
+        for (size_t i = 0; i < _trackedPlanes.size(); ++i)
+        {
+            TrackedPlane& trackedPlane = _trackedPlanes[i];
+
+            //
+            // n . (R p + t) + d = (R^T n) . p + (n . t + d).
+            //
+            const cv::Vec3f cameraNormal =
+                rotation.t() * trackedPlane.Parameters.Normal;
+
+            const cv::Vec4f cameraPlane(
+                cameraNormal[0],
+                cameraNormal[1],
+                cameraNormal[2],
+                trackedPlane.Parameters.Normal.dot(translation) + trackedPlane.Parameters.Offset);
+
+            const uint8_t label =
+                static_cast<uint8_t>(i + 1);
+
+            const Moments cameraMoments =
+                LabelInliers(
+                    cameraPlane,
+                    label);
+
+            if (cameraMoments.Weight < _options.MinimumNumberOfInliers)
+            {
+                UnlabelInliers(
+                    label);
+
+                continue;
+            }
+
+            AddObservation(
+                cameraMoments,
+                cameraToWorld,
+                trackedPlane);
+        }
+    }
+
+    void PlaneDetector::DetectPlanes(
+        _In_ const cv::Matx44f& cameraToWorld)
+    {
+        //
+        // Hypotheses are scored on a subset of the unlabeled candidates.
+        //
+        _samples.Clear();
+
+        size_t numberOfUnlabeledCandidates = 0;
+
+        for (size_t i = 0; i < _candidates.Size(); ++i)
+        {
+            if (0 != _candidates.Labels[i] ||
+                0 != (numberOfUnlabeledCandidates++ % _options.SampleStride))
+            {
+                continue;
+            }
+
+            _samples.PointX.push_back(_candidates.PointX[i]);
+            _samples.PointY.push_back(_candidates.PointY[i]);
+            _samples.PointZ.push_back(_candidates.PointZ[i]);
+            _samples.NormalX.push_back(_candidates.NormalX[i]);
+            _samples.NormalY.push_back(_candidates.NormalY[i]);
+            _samples.NormalZ.push_back(_candidates.NormalZ[i]);
+
+            // Index of the candidate.
+            _samples.Pixels.push_back(static_cast<int32_t>(i));
+        }
+
+        const float cosineThreshold =
+            std::cos(_options.NormalThresholdInDegrees * static_cast<float>(CV_PI) / 180.0f);
+
+        const float mergeCosineThreshold =
+            std::cos(_options.MergeAngleThresholdInDegrees * static_cast<float>(CV_PI) / 180.0f);
+
+        const size_t minimumNumberOfSampleInliers =
+            static_cast<size_t>(_options.MinimumNumberOfInliers / _options.SampleStride);
+
+        std::vector<cv::Vec4f> hypotheses;
+        std::vector<int32_t> scores;
+
+        for (int32_t numberOfNewPlanes = 0;
+             numberOfNewPlanes < _options.MaximumNumberOfNewPlanes &&
+             static_cast<int32_t>(_trackedPlanes.size()) < _options.MaximumNumberOfPlanes &&
+             _samples.Size() >= minimumNumberOfSampleInliers;
+             ++numberOfNewPlanes)
+        {
+            //
+            // Normal-seeded RANSAC: each hypothesis is the tangent plane of one sample.
+            //
+            std::uniform_int_distribution<size_t> sampleDistribution(
+                0,
+                _samples.Size() - 1);
+
+            cv::Vec4f bestHypothesis;
+            int32_t bestScore = 0;
+
+            int32_t numberOfHypotheses = 0;
+            int32_t requiredNumberOfHypotheses = _options.MaximumNumberOfHypotheses;
+
+            while (numberOfHypotheses < requiredNumberOfHypotheses)
+            {
+                const int32_t batchSize =
+                    std::min(
+                        _options.HypothesesPerBatch,
+                        requiredNumberOfHypotheses - numberOfHypotheses);
+
+                hypotheses.resize(batchSize);
+                scores.resize(batchSize);
+
+                for (cv::Vec4f& hypothesis : hypotheses)
+                {
+                    const size_t j = sampleDistribution(_random);
+
+                    hypothesis = cv::Vec4f(
+                        _samples.NormalX[j],
+                        _samples.NormalY[j],
+                        _samples.NormalZ[j],
+                        -(_samples.NormalX[j] * _samples.PointX[j] +
+                          _samples.NormalY[j] * _samples.PointY[j] +
+                          _samples.NormalZ[j] * _samples.PointZ[j]));
+                }
+
+                cv::parallel_for_(
+                    cv::Range(0, batchSize),
+                    [&](const cv::Range& range)
+                {
+                    for (int32_t k = range.start; k < range.end; ++k)
+                    {
+                        scores[k] =
+                            CountInliers(
+                                _samples.PointX.data(),
+                                _samples.PointY.data(),
+                                _samples.PointZ.data(),
+                                _samples.NormalX.data(),
+                                _samples.NormalY.data(),
+                                _samples.NormalZ.data(),
+                                _samples.Size(),
+                                hypotheses[k],
+                                _options.DistanceThresholdInMeters,
+                                cosineThreshold);
+                    }
+                });
+
+                for (int32_t k = 0; k < batchSize; ++k)
+                {
+                    if (scores[k] > bestScore)
+                    {
+                        bestScore = scores[k];
+                        bestHypothesis = hypotheses[k];
+                    }
+                }
+
+                numberOfHypotheses += batchSize;
+
+                //
+                // Early termination: enough hypotheses have been tried to draw at least
+                // one inlier of the best plane with the requested confidence.
+                //
+                const double inlierRatio =
+                    static_cast<double>(bestScore) / _samples.Size();
+
+                if (inlierRatio >= 1.0)
+                {
+                    break;
+                }
+
+                if (inlierRatio > 0.0)
+                {
+                    const double neededNumberOfHypotheses =
+                        std::ceil(std::log(1.0 - _options.Confidence) / std::log(1.0 - inlierRatio));
+
+                    requiredNumberOfHypotheses =
+                        static_cast<int32_t>(
+                            std::min<double>(
+                                _options.MaximumNumberOfHypotheses,
+                                neededNumberOfHypotheses));
+                }
+            }
+
+            _lastFrameTimings.NumberOfHypotheses += numberOfHypotheses;
+
+            if (static_cast<size_t>(bestScore) < minimumNumberOfSampleInliers)
+            {
+                break;
+            }
+
+            //
+            // Refine the best hypothesis with a least squares fit to all its inliers, and
+            // label the inliers of the refined plane.
+            //
+            const uint8_t label =
+                static_cast<uint8_t>(_trackedPlanes.size() + 1);
+
+            Moments cameraMoments =
+                LabelInliers(
+                    bestHypothesis,
+                    label);
+
+            UnlabelInliers(
+                label);
+
+            cv::Vec3d normal;
+            double offset = 0.0;
+
+            if (!cameraMoments.FitPlane(
+                    cv::Vec3d(0.0, 0.0, 0.0),
+                    normal,
+                    offset))
+            {
+                break;
+            }
+
+            cameraMoments =
+                LabelInliers(
+                    cv::Vec4f(
+                        static_cast<float>(normal[0]),
+                        static_cast<float>(normal[1]),
+                        static_cast<float>(normal[2]),
+                        static_cast<float>(offset)),
+                    label);
+
+            if (cameraMoments.Weight < _options.MinimumNumberOfInliers)
+            {
+                UnlabelInliers(
+                    label);
+
+                break;
+            }
+
+            TrackedPlane newPlane = TrackedPlane();
+
+            AddObservation(
+                cameraMoments,
+                cameraToWorld,
+                newPlane);
+
+            //
+            // Merge the new plane into a matching tracked plane, if any.
+            //
+            size_t mergedPlaneIndex = _trackedPlanes.size();
+
+            for (size_t i = 0; i < _trackedPlanes.size(); ++i)
+            {
+                const Plane& trackedPlane = _trackedPlanes[i].Parameters;
+
+                if (trackedPlane.Normal.dot(newPlane.Parameters.Normal) > mergeCosineThreshold &&
+                    std::abs(trackedPlane.Normal.dot(cv::Vec3f(newPlane.Parameters.Centroid)) + trackedPlane.Offset) <
+                        _options.MergeDistanceThresholdInMeters)
+                {
+                    mergedPlaneIndex = i;
+                    break;
+                }
+            }
+
+            if (mergedPlaneIndex < _trackedPlanes.size())
+            {
+                const uint8_t mergedLabel =
+                    static_cast<uint8_t>(mergedPlaneIndex + 1);
+
+                std::replace(
+                    _candidates.Labels.begin(),
+                    _candidates.Labels.end(),
+                    label,
+                    mergedLabel);
+
+                AddObservation(
+                    cameraMoments,
+                    cameraToWorld,
+                    _trackedPlanes[mergedPlaneIndex]);
+            }
+            else
+            {
+                newPlane.Parameters.Id = _nextPlaneId++;
+
+                _trackedPlanes.push_back(
+                    newPlane);
+            }
+
+            //
+            // Remove the samples that are now labeled.
+            //
+            size_t numberOfSamples = 0;
+
+            for (size_t j = 0; j < _samples.Size(); ++j)
+            {
+                if (0 != _candidates.Labels[_samples.Pixels[j]])
+                {
+                    continue;
+                }
+
+                _samples.PointX[numberOfSamples] = _samples.PointX[j];
+                _samples.PointY[numberOfSamples] = _samples.PointY[j];
+                _samples.PointZ[numberOfSamples] = _samples.PointZ[j];
+                _samples.NormalX[numberOfSamples] = _samples.NormalX[j];
+                _samples.NormalY[numberOfSamples] = _samples.NormalY[j];
+                _samples.NormalZ[numberOfSamples] = _samples.NormalZ[j];
+                _samples.Pixels[numberOfSamples] = _samples.Pixels[j];
+
+                ++numberOfSamples;
+            }
+
+            _samples.PointX.resize(numberOfSamples);
+            _samples.PointY.resize(numberOfSamples);
+            _samples.PointZ.resize(numberOfSamples);
+            _samples.NormalX.resize(numberOfSamples);
+            _samples.NormalY.resize(numberOfSamples);
+            _samples.NormalZ.resize(numberOfSamples);
+            _samples.Pixels.resize(numberOfSamples);
+        }
+    }
+
+    PlaneDetector::Moments PlaneDetector::LabelInliers(
+        _In_ const cv::Vec4f& plane,
+        _In_ uint8_t label)
+    {
+        const float cosineThreshold =
+            std::cos(_options.NormalThresholdInDegrees * static_cast<float>(CV_PI) / 180.0f);
+
+        const size_t numberOfCandidates =
+            _candidates.Size();
+
+        const int32_t numberOfBands =
+            GetNumberOfBands(numberOfCandidates);
+
+        //
+        // Per band: count, sums of the coordinates and sums of their products.
+        //
+        std::vector<std::array<double, 10>> bandSums(
+            numberOfBands);
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                std::array<double, 10>& sums = bandSums[band];
+
+                sums.fill(0.0);
+
+                const size_t begin = numberOfCandidates * band / numberOfBands;
+                const size_t end = numberOfCandidates * (band + 1) / numberOfBands;
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (0 != _candidates.Labels[i])
+                    {
+                        continue;
+                    }
+
+                    const float x = _candidates.PointX[i];
+                    const float y = _candidates.PointY[i];
+                    const float z = _candidates.PointZ[i];
+
+                    const float distance =
+                        plane[0] * x + plane[1] * y + plane[2] * z + plane[3];
+
+                    const float cosine =
+                        plane[0] * _candidates.NormalX[i] +
+                        plane[1] * _candidates.NormalY[i] +
+                        plane[2] * _candidates.NormalZ[i];
+
+                    if (std::abs(distance) >= _options.DistanceThresholdInMeters ||
+                        std::abs(cosine) <= cosineThreshold)
+                    {
+                        continue;
+                    }
+
+                    _candidates.Labels[i] = label;
+
+                    sums[0] += 1.0;
+                    sums[1] += x;
+                    sums[2] += y;
+                    sums[3] += z;
+                    sums[4] += static_cast<double>(x) * x;
+                    sums[5] += static_cast<double>(x) * y;
+                    sums[6] += static_cast<double>(x) * z;
+                    sums[7] += static_cast<double>(y) * y;
+                    sums[8] += static_cast<double>(y) * z;
+                    sums[9] += static_cast<double>(z) * z;
+                }
+            }
+        });
+
+        std::array<double, 10> sums;
+
+        sums.fill(0.0);
+
+        for (const std::array<double, 10>& band : bandSums)
+        {
+            for (size_t k = 0; k < sums.size(); ++k)
+            {
+                sums[k] += band[k];
+            }
+        }
+
+        Moments moments;
+
+        if (sums[0] <= 0.0)
+        {
+            return moments;
+        }
+
+        moments.Weight = sums[0];
+        moments.Mean = cv::Vec3d(sums[1], sums[2], sums[3]) * (1.0 / sums[0]);
+
+        const cv::Vec3d& mean = moments.Mean;
+
+        moments.Scatter = cv::Matx33d(
+            sums[4], sums[5], sums[6],
+            sums[5], sums[7], sums[8],
+            sums[6], sums[8], sums[9]) - sums[0] * (mean * mean.t());
+
+        return moments;
+    }
+
+    void PlaneDetector::UnlabelInliers(
+        _In_ uint8_t label)
+    {
+        std::replace(
+            _candidates.Labels.begin(),
+            _candidates.Labels.end(),
+            label,
+            static_cast<uint8_t>(0));
+    }
+
+    void PlaneDetector::AddObservation(
+        _In_ const Moments& cameraMoments,
+        _In_ const cv::Matx44f& cameraToWorld,
+        _Inout_ TrackedPlane& trackedPlane) const
+    {
+        const cv::Matx33d rotation = cameraToWorld.get_minor<3, 3>(0, 0);
+        const cv::Vec3d translation(cameraToWorld(0, 3), cameraToWorld(1, 3), cameraToWorld(2, 3));
+
+        Moments worldMoments;
+
+        worldMoments.Weight = cameraMoments.Weight;
+        worldMoments.Mean = rotation * cameraMoments.Mean + translation;
+        worldMoments.Scatter = rotation * cameraMoments.Scatter * rotation.t();
+
+        Plane& plane = trackedPlane.Parameters;
+
+        //
+        // Older observations decay once per frame.
+        //
+        if (plane.LastObservedFrame != _frameIndex)
+        {
+            trackedPlane.WorldMoments.Weight *= _options.ObservationDecay;
+            trackedPlane.WorldMoments.Scatter *= _options.ObservationDecay;
+
+            plane.NumberOfInliers = 0;
+            ++plane.NumberOfObservations;
+            plane.LastObservedFrame = _frameIndex;
+        }
+
+        trackedPlane.WorldMoments.Add(
+            worldMoments);
+
+        plane.NumberOfInliers +=
+            static_cast<uint32_t>(cameraMoments.Weight);
+
+        cv::Vec3d normal;
+        double offset = 0.0;
+
+        if (trackedPlane.WorldMoments.FitPlane(
+                translation,
+                normal,
+                offset))
+        {
+            plane.Normal = cv::Vec3f(normal);
+            plane.Offset = static_cast<float>(offset);
+        }
+
+        plane.Centroid = cv::Point3f(cv::Vec3f(trackedPlane.WorldMoments.Mean));
+        plane.Orientation = ClassifyOrientation(plane.Normal);
+    }
+
+    PlaneDetector::PlaneOrientation PlaneDetector::ClassifyOrientation(
+        _In_ const cv::Vec3f& normal) const
+    {
+        const float threshold =
+            _options.OrientationThresholdInDegrees * static_cast<float>(CV_PI) / 180.0f;
+
+        if (normal[1] > std::cos(threshold))
+        {
+            return PlaneOrientation::HorizontalUp;
+        }
+        else if (normal[1] < -std::cos(threshold))
+        {
+            return PlaneOrientation::HorizontalDown;
+        }
+        else if (std::abs(normal[1]) < std::sin(threshold))
+        {
+            return PlaneOrientation::Vertical;
+        }
+        else
+        {
+            return PlaneOrientation::Oblique;
+        }
+    }
+
+    void PlaneDetector::DropStalePlanes()
+    {
+        _trackedPlanes.erase(
+            std::remove_if(
+                _trackedPlanes.begin(),
+                _trackedPlanes.end(),
+                [this](const TrackedPlane& trackedPlane)
+                {
+                    return _frameIndex - trackedPlane.Parameters.LastObservedFrame > _options.MaximumAgeInFrames;
+                }),
+            _trackedPlanes.end());
+    }
+}
@@ -0,0 +1,294 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Detects planes (floors, walls, tables...) in organized depth frames and tracks them
+    // over time in the world coordinate system.
+    //
+    // Each frame, the planes tracked so far are first moved to the camera coordinate
+    // system and claim their inliers, which refine them incrementally. New planes are then
+    // searched for among the remaining pixels with RANSAC. As every pixel has a local
+    // normal (see SurfaceNormalEstimator), a single pixel defines a plane hypothesis, so
+    // far fewer hypotheses are needed than with three-point sampling; they are scored in
+    // parallel, in batches, until enough of them have been tried to find the best plane
+    // with the requested confidence. New planes that match a tracked plane are merged
+    // into it.
+    //
+    // Tracked planes accumulate the (exponentially decaying) moments of their inliers,
+    // so their parameters are least squares fits over many frames.
+    //
+    // An instance keeps scratch buffers between calls, so it must not be used by several
+    // threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class PlaneDetector
+    {
+    public:
+        //
+        // Orientation of a plane with respect to gravity (the world Y axis), its normal
+        // pointing towards the side it was observed from.
+        //
+        enum class PlaneOrientation
+        {
+            HorizontalUp,   // Floors, tables
+            HorizontalDown, // Ceilings
+            Vertical,       // Walls
+            Oblique
+        };
+
+        struct Plane
+        {
+            uint32_t Id;
+
+            // World coordinate system: Normal . p + Offset = 0.
+            cv::Vec3f Normal;
+            float Offset;
+
+            cv::Point3f Centroid;
+
+            PlaneOrientation Orientation;
+
+            // Inliers in the last processed frame, zero if the plane was not seen.
+            uint32_t NumberOfInliers;
+
+            uint64_t NumberOfObservations;
+            uint64_t LastObservedFrame;
+        };
+
+        struct Options
+        {
+            Options();
+
+            // Normals are estimated with the cross product method.
+            SurfaceNormalEstimator::Options Normals;
+
+            // A pixel is an inlier of a plane if it is this close to the plane, and its
+            // normal is within the given angle of the plane's normal.
+            float DistanceThresholdInMeters;
+            float NormalThresholdInDegrees;
+
+            // Minimum number of inlier pixels of a plane in a frame.
+            int32_t MinimumNumberOfInliers;
+
+            // Maximum number of new planes detected per frame, and of tracked planes.
+            int32_t MaximumNumberOfNewPlanes;
+            int32_t MaximumNumberOfPlanes;
+
+            // Hypotheses are scored on every SampleStride-th pixel, in batches, until
+            // the best one is found with the given confidence or the maximum number of
+            // hypotheses is reached.
+            int32_t SampleStride;
+            int32_t HypothesesPerBatch;
+            int32_t MaximumNumberOfHypotheses;
+            float Confidence;
+
+            // New planes closer than these to a tracked plane are merged into it.
+            float MergeAngleThresholdInDegrees;
+            float MergeDistanceThresholdInMeters;
+
+            // Weight of the accumulated moments of a tracked plane when a frame is added.
+            float ObservationDecay;
+
+            // Tracked planes that have not been seen for this many frames are dropped.
+            uint32_t MaximumAgeInFrames;
+
+            // Planes within this angle of horizontal (or vertical) are classified as such.
+            float OrientationThresholdInDegrees;
+
+            uint32_t RandomSeed;
+        };
+
+        struct FrameTimings
+        {
+            FrameTimings();
+
+            double NormalsTimeInMilliseconds;
+            double TrackingTimeInMilliseconds;
+            double DetectionTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+
+            uint64_t NumberOfHypotheses;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfFramesWithoutPose;
+            uint64_t NumberOfNewPlanes;
+            uint64_t NumberOfTrackedPlaneObservations;
+            uint64_t NumberOfHypotheses;
+            uint64_t NumberOfPlanes;
+
+            // Per-frame averages of each stage, and maximum total per-frame latency.
+            double NormalsTimeInMilliseconds;
+            double TrackingTimeInMilliseconds;
+            double DetectionTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+            double MaximumTotalTimeInMilliseconds;
+        };
+
+        //
+        // Returns the options for 'short_throw_depth' and 'long_throw_depth': the long
+        // throw sensor sees surfaces further away, which are noisier and smaller.
+        //
+        static Options GetDefaultOptions(
+            _In_ const std::string& sensorName);
+
+        //
+        // The unit plane map is a CV_32FC2 image holding the (x, y) unit plane coordinates
+        // of each depth pixel, +infinity for pixels without a valid mapping.
+        //
+        PlaneDetector(
+            _In_ const cv::Mat& unitPlaneMap,
+            _In_ const Options& options);
+
+        const Options& GetOptions() const;
+
+        //
+        // Processes a depth frame (Gray16) taken from the given camera pose. The labels
+        // (CV_8UC1) hold, for each pixel, the index + 1 in GetPlanes() of the plane it is
+        // an inlier of, or zero.
+        //
+        void Process(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& cameraToWorld,
+            _Out_ cv::Mat& labels);
+
+        const std::vector<Plane>& GetPlanes() const;
+
+        const FrameTimings& GetLastFrameTimings() const;
+
+        //
+        // Returns the tracked planes as JSON, with their label values.
+        //
+        std::string GetPlanesAsJson() const;
+
+        //
+        // Forgets all the tracked planes.
+        //
+        void Reset();
+
+        //
+        // Processes all the frames recorded for a depth sensor and measures the per-frame
+        // latency of each stage.
+        //
+        static bool BenchmarkRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName,
+            _In_ const Options& options,
+            _Out_ BenchmarkStatistics& statistics);
+
+    private:
+        //
+        // Inlier statistics, about their mean.
+        //
+        struct Moments
+        {
+            Moments();
+
+            double Weight;
+            cv::Vec3d Mean;
+            cv::Matx33d Scatter;
+
+            void Add(
+                _In_ const Moments& other);
+
+            bool FitPlane(
+                _In_ const cv::Vec3d& viewpoint,
+                _Out_ cv::Vec3d& normal,
+                _Out_ double& offset) const;
+        };
+
+        struct TrackedPlane
+        {
+            Plane Parameters;
+
+            Moments WorldMoments;
+        };
+
+        //
+        // Valid pixels of the current frame, structure of arrays.
+        //
+        struct Candidates
+        {
+            std::vector<float> PointX, PointY, PointZ;
+            std::vector<float> NormalX, NormalY, NormalZ;
+            std::vector<int32_t> Pixels;
+
+            // Index + 1 of the plane each candidate is an inlier of, or zero.
+            std::vector<uint8_t> Labels;
+
+            void Clear();
+
+            size_t Size() const;
+        };
+
+        void GatherCandidates();
+
+        void TrackPlanes(
+            _In_ const cv::Matx44f& cameraToWorld);
+
+        void DetectPlanes(
+            _In_ const cv::Matx44f& cameraToWorld);
+
+        //
+        // Labels the unlabeled candidates that are inliers of the plane (in the camera
+        // coordinate system) and returns their moments.
+        //
+        Moments LabelInliers(
+            _In_ const cv::Vec4f& plane,
+            _In_ uint8_t label);
+
+        void UnlabelInliers(
+            _In_ uint8_t label);
+
+        //
+        // Moves the inlier moments of a frame to the world coordinate system and adds
+        // them to the given plane.
+        //
+        void AddObservation(
+            _In_ const Moments& cameraMoments,
+            _In_ const cv::Matx44f& cameraToWorld,
+            _Inout_ TrackedPlane& trackedPlane) const;
+
+        PlaneOrientation ClassifyOrientation(
+            _In_ const cv::Vec3f& normal) const;
+
+        void DropStalePlanes();
+
+    private:
+        Options _options;
+
+        SurfaceNormalEstimator _normalEstimator;
+
+        std::mt19937 _random;
+
+        uint64_t _frameIndex;
+        uint32_t _nextPlaneId;
+
+        std::vector<TrackedPlane> _trackedPlanes;
+        std::vector<Plane> _planes;
+
+        // Scratch buffers.
+        cv::Mat _normals;
+        Candidates _candidates;
+        Candidates _samples;
+
+        FrameTimings _lastFrameTimings;
+    };
+}
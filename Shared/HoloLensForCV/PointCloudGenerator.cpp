@@ -0,0 +1,637 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    PointCloudGenerator::Options::Options()
+        : MinimumDepthInMeters(0.02f)
+        , MaximumDepthInMeters(3.0f)
+        , DepthScale(0.001f)
+    {
+    }
+
+    PointCloudGenerator::ConversionStatistics::ConversionStatistics()
+        : NumberOfFrames(0)
+        , NumberOfFramesWithoutPose(0)
+        , NumberOfPoints(0)
+        , ElapsedTimeInMilliseconds(0.0)
+        , ComputeTimeInMilliseconds(0.0)
+    {
+    }
+
+    /* static */ PointCloudGenerator::Options PointCloudGenerator::GetDefaultOptions(
+        _In_ const std::string& sensorName)
+    {
+        Options options;
+
+        if (std::string::npos != sensorName.find("long"))
+        {
+            options.MinimumDepthInMeters = 1.0f;
+            options.MaximumDepthInMeters = 4.0f;
+        }
+
+        return options;
+    }
+
+    PointCloudGenerator::PointCloudGenerator(
+        _In_ const cv::Mat& unitPlaneMap)
+    {
+        REQUIRES(CV_32FC2 == unitPlaneMap.type());
+
+        _rayX.create(unitPlaneMap.size(), CV_32F);
+        _rayY.create(unitPlaneMap.size(), CV_32F);
+        _rayZ.create(unitPlaneMap.size(), CV_32F);
+
+        for (int32_t v = 0; v < unitPlaneMap.rows; ++v)
+        {
+            const cv::Point2f* xy = unitPlaneMap.ptr<cv::Point2f>(v);
+
+            float* rayX = _rayX.ptr<float>(v);
+            float* rayY = _rayY.ptr<float>(v);
+            float* rayZ = _rayZ.ptr<float>(v);
+
+            for (int32_t u = 0; u < unitPlaneMap.cols; ++u)
+            {
+                if (!std::isfinite(xy[u].x) || !std::isfinite(xy[u].y))
+                {
+                    rayX[u] = rayY[u] = rayZ[u] = 0.0f;
+                    continue;
+                }
+
+                const float scale =
+                    -1.0f / std::sqrt(xy[u].x * xy[u].x + xy[u].y * xy[u].y + 1.0f);
+
+                rayX[u] = xy[u].x * scale;
+                rayY[u] = xy[u].y * scale;
+                rayZ[u] = scale;
+            }
+        }
+    }
+
+    int32_t PointCloudGenerator::GetImageWidth() const
+    {
+        return _rayX.cols;
+    }
+
+    int32_t PointCloudGenerator::GetImageHeight() const
+    {
+        return _rayX.rows;
+    }
+
+    void PointCloudGenerator::GetRays(
+        _Out_ cv::Mat& rayX,
+        _Out_ cv::Mat& rayY,
+        _Out_ cv::Mat& rayZ) const
+    {
+        rayX = _rayX;
+        rayY = _rayY;
+        rayZ = _rayZ;
+    }
+
+    /* static */ bool PointCloudGenerator::LoadDenseProjectionTable(
+        _In_ const std::string& fileName,
+        _In_ int32_t imageWidth,
+        _In_ int32_t imageHeight,
+        _Out_ cv::Mat& unitPlaneMap)
+    {
+        const size_t tableSize =
+            static_cast<size_t>(imageWidth) * imageHeight * 2 * sizeof(float);
+
+        Io::MappedFile file;
+
+        if (!file.Open(fileName, 0 /* offset */, tableSize) ||
+            file.GetSpan().Size != tableSize)
+        {
+            return false;
+        }
+
+        //
+        // The mapping is page-aligned, so the table can be read in place.
+        //
+        const float* table =
+            reinterpret_cast<const float*>(file.GetSpan().Data);
+
+        //
+        // The table is stored column-major.
+        //
+        unitPlaneMap.create(
+            imageHeight,
+            imageWidth,
+            CV_32FC2);
+
+        size_t index = 0;
+
+        for (int32_t u = 0; u < imageWidth; ++u)
+        {
+            for (int32_t v = 0; v < imageHeight; ++v, index += 2)
+            {
+                unitPlaneMap.at<cv::Point2f>(v, u) =
+                    cv::Point2f(table[index], table[index + 1]);
+            }
+        }
+
+        return true;
+    }
+
+    /* static */ bool PointCloudGenerator::LoadUnitPlaneMap(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName,
+        _In_ int32_t imageWidth,
+        _In_ int32_t imageHeight,
+        _Out_ cv::Mat& unitPlaneMap)
+    {
+        const std::string prefix =
+            recordingFolder +
+            ((!recordingFolder.empty() && '/' != recordingFolder.back() && '\\' != recordingFolder.back()) ? "/" : "") +
+            sensorName;
+
+        if (LoadDenseProjectionTable(
+                prefix + "_camera_space_projection.bin",
+                imageWidth,
+                imageHeight,
+                unitPlaneMap))
+        {
+            return true;
+        }
+
+        std::ifstream modelFile(
+            prefix + "_camera_projection_model.bin",
+            std::ios::in | std::ios::binary);
+
+        CameraProjectionModel cameraProjectionModel;
+
+        if (!modelFile ||
+            !cameraProjectionModel.Load(modelFile) ||
+            static_cast<int32_t>(cameraProjectionModel.GetImageWidth()) != imageWidth ||
+            static_cast<int32_t>(cameraProjectionModel.GetImageHeight()) != imageHeight)
+        {
+#if DBG_ENABLE_ERROR_LOGGING
+            DBG_LOG(
+                "PointCloudGenerator",
+                dbg::LogLevel::Error,
+                L"PointCloudGenerator::LoadUnitPlaneMap: no camera projection found for %S",
+                sensorName.c_str());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+
+            return false;
+        }
+
+        cameraProjectionModel.ComputeUnitPlaneMap(
+            unitPlaneMap);
+
+        return true;
+    }
+
+    /* static */ bool PointCloudGenerator::ComputeCameraToWorld(
+        _In_ const std::array<float, 16>& frameToOrigin,
+        _In_ const std::array<float, 16>& cameraViewTransform,
+        _Out_ cv::Matx44f& cameraToWorld)
+    {
+        //
+        // Loading the row-major matrices as is yields the row-vector transforms. For
+        // column vectors, world-to-camera is CameraViewTransform^T * inverse(FrameToOrigin^T),
+        // hence camera-to-world is (inverse(CameraViewTransform) * FrameToOrigin)^T.
+        //
+        cv::Matx44d frameToOriginTransform, cameraViewTransformInverse;
+
+        for (int32_t i = 0; i < 16; ++i)
+        {
+            frameToOriginTransform.val[i] = frameToOrigin[i];
+            cameraViewTransformInverse.val[i] = cameraViewTransform[i];
+        }
+
+        const double rotationDeterminant =
+            cv::determinant(
+                cv::Matx33d(
+                    frameToOriginTransform(0, 0), frameToOriginTransform(0, 1), frameToOriginTransform(0, 2),
+                    frameToOriginTransform(1, 0), frameToOriginTransform(1, 1), frameToOriginTransform(1, 2),
+                    frameToOriginTransform(2, 0), frameToOriginTransform(2, 1), frameToOriginTransform(2, 2)));
+
+        if (std::abs(rotationDeterminant - 1.0) >= 0.01)
+        {
+            cameraToWorld = cv::Matx44f::eye();
+
+            return false;
+        }
+
+        cameraViewTransformInverse =
+            cameraViewTransformInverse.inv();
+
+        cameraToWorld =
+            cv::Matx44f((cameraViewTransformInverse * frameToOriginTransform).t());
+
+        return true;
+    }
+
+    void PointCloudGenerator::Compute(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& cameraToWorld,
+        _In_ const Options& options,
+        _Out_ std::vector<cv::Point3f>& points) const
+    {
+        REQUIRES(
+            CV_16UC1 == depth.type() &&
+            depth.size() == _rayX.size());
+
+        //
+        // Each band of rows produces its own list of points; they are concatenated in
+        // order afterwards so that the output does not depend on the scheduling.
+        //
+        const int32_t numberOfBands =
+            std::max(1, std::min(depth.rows, cv::getNumThreads() * 4));
+
+        std::vector<std::vector<cv::Point3f>> bandPoints(
+            numberOfBands);
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                ComputeRows(
+                    depth,
+                    cameraToWorld,
+                    options,
+                    depth.rows * band / numberOfBands,
+                    depth.rows * (band + 1) / numberOfBands,
+                    bandPoints[band]);
+            }
+        });
+
+        size_t numberOfPoints = 0;
+
+        for (const auto& band : bandPoints)
+        {
+            numberOfPoints += band.size();
+        }
+
+        points.clear();
+        points.reserve(numberOfPoints);
+
+        for (const auto& band : bandPoints)
+        {
+            points.insert(
+                points.end(),
+                band.begin(),
+                band.end());
+        }
+    }
+
+    void PointCloudGenerator::ComputeBatch(
+        _In_ const std::vector<cv::Mat>& depths,
+        _In_ const std::vector<cv::Matx44f>& camerasToWorld,
+        _In_ const Options& options,
+        _Out_ std::vector<std::vector<cv::Point3f>>& pointClouds) const
+    {
+        REQUIRES(depths.size() == camerasToWorld.size());
+
+        pointClouds.resize(
+            depths.size());
+
+        //
+        // Nested parallel loops run serially in OpenCV, so each frame is converted by
+        // a single thread here.
+        //
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(depths.size())),
+            [&](const cv::Range& range)
+        {
+            for (int32_t i = range.start; i < range.end; ++i)
+            {
+                pointClouds[i].clear();
+
+                ComputeRows(
+                    depths[i],
+                    camerasToWorld[i],
+                    options,
+                    0,
+                    depths[i].rows,
+                    pointClouds[i]);
+            }
+        });
+    }
+
+    void PointCloudGenerator::ComputeRows(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& cameraToWorld,
+        _In_ const Options& options,
+        _In_ int32_t beginRow,
+        _In_ int32_t endRow,
+        _Inout_ std::vector<cv::Point3f>& points) const
+    {
+        REQUIRES(
+            CV_16UC1 == depth.type() &&
+            depth.size() == _rayX.size());
+
+        const cv::Matx44f& m = cameraToWorld;
+
+        points.reserve(
+            points.size() + static_cast<size_t>(endRow - beginRow) * depth.cols);
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            const uint16_t* depthRow = depth.ptr<uint16_t>(v);
+            const float* rayX = _rayX.ptr<float>(v);
+            const float* rayY = _rayY.ptr<float>(v);
+            const float* rayZ = _rayZ.ptr<float>(v);
+
+            int32_t u = 0;
+
+#if CV_SIMD128
+            const cv::v_float32x4 scale = cv::v_setall_f32(options.DepthScale);
+            const cv::v_float32x4 minimumDepth = cv::v_setall_f32(options.MinimumDepthInMeters);
+            const cv::v_float32x4 maximumDepth = cv::v_setall_f32(options.MaximumDepthInMeters);
+            const cv::v_float32x4 zero = cv::v_setzero_f32();
+
+            const cv::v_float32x4 m00 = cv::v_setall_f32(m(0, 0)), m01 = cv::v_setall_f32(m(0, 1)), m02 = cv::v_setall_f32(m(0, 2)), m03 = cv::v_setall_f32(m(0, 3));
+            const cv::v_float32x4 m10 = cv::v_setall_f32(m(1, 0)), m11 = cv::v_setall_f32(m(1, 1)), m12 = cv::v_setall_f32(m(1, 2)), m13 = cv::v_setall_f32(m(1, 3));
+            const cv::v_float32x4 m20 = cv::v_setall_f32(m(2, 0)), m21 = cv::v_setall_f32(m(2, 1)), m22 = cv::v_setall_f32(m(2, 2)), m23 = cv::v_setall_f32(m(2, 3));
+
+            float worldX[4], worldY[4], worldZ[4];
+
+            for (; u + 8 <= depth.cols; u += 8)
+            {
+                cv::v_uint32x4 rawDepths[2];
+
+                cv::v_expand(
+                    cv::v_load(depthRow + u),
+                    rawDepths[0],
+                    rawDepths[1]);
+
+                for (int32_t half = 0; half < 2; ++half)
+                {
+                    const int32_t offset = u + 4 * half;
+
+                    const cv::v_float32x4 distance =
+                        cv::v_cvt_f32(cv::v_reinterpret_as_s32(rawDepths[half])) * scale;
+
+                    const cv::v_float32x4 rx = cv::v_load(rayX + offset);
+                    const cv::v_float32x4 ry = cv::v_load(rayY + offset);
+                    const cv::v_float32x4 rz = cv::v_load(rayZ + offset);
+
+                    const cv::v_float32x4 valid =
+                        (distance >= minimumDepth) &
+                        (distance <= maximumDepth) &
+                        (rz != zero);
+
+                    const int32_t validMask =
+                        cv::v_signmask(valid);
+
+                    if (0 == validMask)
+                    {
+                        continue;
+                    }
+
+                    const cv::v_float32x4 cameraX = distance * rx;
+                    const cv::v_float32x4 cameraY = distance * ry;
+                    const cv::v_float32x4 cameraZ = distance * rz;
+
+                    cv::v_store(worldX, cv::v_muladd(m00, cameraX, cv::v_muladd(m01, cameraY, cv::v_muladd(m02, cameraZ, m03))));
+                    cv::v_store(worldY, cv::v_muladd(m10, cameraX, cv::v_muladd(m11, cameraY, cv::v_muladd(m12, cameraZ, m13))));
+                    cv::v_store(worldZ, cv::v_muladd(m20, cameraX, cv::v_muladd(m21, cameraY, cv::v_muladd(m22, cameraZ, m23))));
+
+                    for (int32_t lane = 0; lane < 4; ++lane)
+                    {
+                        if (validMask & (1 << lane))
+                        {
+                            points.emplace_back(
+                                worldX[lane],
+                                worldY[lane],
+                                worldZ[lane]);
+                        }
+                    }
+                }
+            }
+#endif /* CV_SIMD128 */
+
+            for (; u < depth.cols; ++u)
+            {
+                const float distance =
+                    depthRow[u] * options.DepthScale;
+
+                if (distance < options.MinimumDepthInMeters ||
+                    distance > options.MaximumDepthInMeters ||
+                    0.0f == rayZ[u])
+                {
+                    continue;
+                }
+
+                const float cameraX = distance * rayX[u];
+                const float cameraY = distance * rayY[u];
+                const float cameraZ = distance * rayZ[u];
+
+                points.emplace_back(
+                    m(0, 0) * cameraX + m(0, 1) * cameraY + m(0, 2) * cameraZ + m(0, 3),
+                    m(1, 0) * cameraX + m(1, 1) * cameraY + m(1, 2) * cameraZ + m(1, 3),
+                    m(2, 0) * cameraX + m(2, 1) * cameraY + m(2, 2) * cameraZ + m(2, 3));
+            }
+        }
+    }
+
+    /* static */ bool PointCloudGenerator::ConvertRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName,
+        _In_ const std::string& outputFolder,
+        _In_ const Options& options,
+        _Out_ ConversionStatistics& statistics)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        statistics = ConversionStatistics();
+
+        SensorFrameRecordingReader reader;
+
+        if (!reader.Open(recordingFolder, sensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> archive =
+            reader.OpenArchive();
+
+        //
+        // The image size is only known from the frames themselves.
+        //
+        RecordedSensorFrame frame;
+
+        if (!reader.ReadFrame(0, archive.get(), frame))
+        {
+            return false;
+        }
+
+        const std::string separator =
+            (!outputFolder.empty() && '/' != outputFolder.back() && '\\' != outputFolder.back()) ? "/" : "";
+
+        cv::Mat unitPlaneMap;
+
+        if (!LoadUnitPlaneMap(
+                recordingFolder,
+                sensorName,
+                frame.Image.cols,
+                frame.Image.rows,
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        const PointCloudGenerator generator(
+            unitPlaneMap);
+
+        //
+        // Frames are read sequentially, then converted in parallel batches.
+        //
+        const size_t batchSize =
+            static_cast<size_t>(std::max(1, cv::getNumThreads()) * 2);
+
+        std::vector<cv::Mat> depths;
+        std::vector<cv::Matx44f> camerasToWorld;
+        std::vector<uint64_t> timestamps;
+        std::vector<std::vector<cv::Point3f>> pointClouds;
+
+        for (size_t batchStart = 0; batchStart < reader.GetNumberOfFrames(); batchStart += batchSize)
+        {
+            depths.clear();
+            camerasToWorld.clear();
+            timestamps.clear();
+
+            for (size_t i = batchStart; i < std::min(batchStart + batchSize, reader.GetNumberOfFrames()); ++i)
+            {
+                if (!reader.ReadFrame(i, archive.get(), frame) ||
+                    CV_16UC1 != frame.Image.type())
+                {
+                    continue;
+                }
+
+                cv::Matx44f cameraToWorld;
+
+                if (!ComputeCameraToWorld(
+                        frame.FrameToOrigin,
+                        frame.CameraViewTransform,
+                        cameraToWorld))
+                {
+                    ++statistics.NumberOfFramesWithoutPose;
+                    continue;
+                }
+
+                depths.push_back(frame.Image.clone());
+                camerasToWorld.push_back(cameraToWorld);
+                timestamps.push_back(frame.Timestamp);
+            }
+
+            const Clock::time_point computeStartTime =
+                Clock::now();
+
+            generator.ComputeBatch(
+                depths,
+                camerasToWorld,
+                options,
+                pointClouds);
+
+            statistics.ComputeTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - computeStartTime).count();
+
+            for (size_t i = 0; i < pointClouds.size(); ++i)
+            {
+                char fileName[32] = {};
+
+                snprintf(
+                    fileName,
+                    sizeof(fileName),
+                    "%020llu.ply",
+                    static_cast<unsigned long long>(timestamps[i]));
+
+                if (!WritePly(
+                        outputFolder + separator + fileName,
+                        pointClouds[i]))
+                {
+                    return false;
+                }
+
+                ++statistics.NumberOfFrames;
+                statistics.NumberOfPoints += pointClouds[i].size();
+            }
+        }
+
+        statistics.ElapsedTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(
+                Clock::now() - startTime).count();
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "PointCloudGenerator",
+            dbg::LogLevel::Information,
+            L"PointCloudGenerator::ConvertRecording: %S: %llu frames (%llu without pose), %llu points, %.3f ms/frame compute, %.3f ms/frame total",
+            sensorName.c_str(),
+            statistics.NumberOfFrames,
+            statistics.NumberOfFramesWithoutPose,
+            statistics.NumberOfPoints,
+            statistics.NumberOfFrames ? statistics.ComputeTimeInMilliseconds / statistics.NumberOfFrames : 0.0,
+            statistics.NumberOfFrames ? statistics.ElapsedTimeInMilliseconds / statistics.NumberOfFrames : 0.0);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return true;
+    }
+
+    /* static */ bool PointCloudGenerator::WritePly(
+        _In_ const std::string& fileName,
+        _In_ const std::vector<cv::Point3f>& points)
+    {
+        std::ofstream file(
+            fileName,
+            std::ios::out | std::ios::binary);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        file
+            << "ply\n"
+            << "format binary_little_endian 1.0\n"
+            << "element vertex " << points.size() << "\n"
+            << "property float x\n"
+            << "property float y\n"
+            << "property float z\n"
+            << "end_header\n";
+
+        static_assert(
+            sizeof(cv::Point3f) == 3 * sizeof(float),
+            "cv::Point3f is expected to be tightly packed.");
+
+        file.write(
+            reinterpret_cast<const char*>(points.data()),
+            points.size() * sizeof(cv::Point3f));
+
+        return !!file;
+    }
+
+    /* static */ bool PointCloudGenerator::WriteRaw(
+        _In_ const std::string& fileName,
+        _In_ const std::vector<cv::Point3f>& points)
+    {
+        std::ofstream file(
+            fileName,
+            std::ios::out | std::ios::binary);
+
+        file.write(
+            reinterpret_cast<const char*>(points.data()),
+            points.size() * sizeof(cv::Point3f));
+
+        return !!file;
+    }
+}
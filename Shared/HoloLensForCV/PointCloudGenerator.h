@@ -0,0 +1,169 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Converts depth frames (Gray16, in millimeters) to world-space point clouds.
+    //
+    // The depth sensors report the distance along the pixel's ray rather than its Z
+    // coordinate, so a pixel whose unit plane coordinates are (x, y) and whose distance
+    // is D maps to (x, y, 1) * z with z = -D / sqrt(x^2 + y^2 + 1) in the camera frame
+    // (the camera looks down the negative Z axis). The normalized rays are computed once
+    // per sensor, and each frame is then converted, range filtered and transformed to
+    // world space in a single vectorized pass.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class PointCloudGenerator
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Depth values outside of this range (in meters) are discarded.
+            float MinimumDepthInMeters;
+            float MaximumDepthInMeters;
+
+            // Conversion from the raw depth values to meters.
+            float DepthScale;
+        };
+
+        struct ConversionStatistics
+        {
+            ConversionStatistics();
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfFramesWithoutPose;
+            uint64_t NumberOfPoints;
+
+            double ElapsedTimeInMilliseconds;
+            double ComputeTimeInMilliseconds;
+        };
+
+        //
+        // Returns the approximate valid ranges for 'short_throw_depth' (0.02m to 3m) and
+        // 'long_throw_depth' (1m to 4m).
+        //
+        static Options GetDefaultOptions(
+            _In_ const std::string& sensorName);
+
+        //
+        // The unit plane map is a CV_32FC2 image holding the (x, y) unit plane coordinates
+        // of each pixel, +infinity for pixels without a valid mapping.
+        //
+        explicit PointCloudGenerator(
+            _In_ const cv::Mat& unitPlaneMap);
+
+        int32_t GetImageWidth() const;
+
+        int32_t GetImageHeight() const;
+
+        //
+        // The normalized ray components (CV_32F images). Pixels without a valid mapping
+        // have zero rays.
+        //
+        void GetRays(
+            _Out_ cv::Mat& rayX,
+            _Out_ cv::Mat& rayY,
+            _Out_ cv::Mat& rayZ) const;
+
+        //
+        // Reads a legacy '<sensor>_camera_space_projection.bin' table.
+        //
+        static bool LoadDenseProjectionTable(
+            _In_ const std::string& fileName,
+            _In_ int32_t imageWidth,
+            _In_ int32_t imageHeight,
+            _Out_ cv::Mat& unitPlaneMap);
+
+        //
+        // Loads the unit plane map of a recorded sensor, from its camera projection model or
+        // its dense table.
+        //
+        static bool LoadUnitPlaneMap(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName,
+            _In_ int32_t imageWidth,
+            _In_ int32_t imageHeight,
+            _Out_ cv::Mat& unitPlaneMap);
+
+        //
+        // Composes the camera-to-world transform (for column vectors) from the recorded
+        // FrameToOrigin and CameraViewTransform matrices (row-major, for row vectors).
+        // Returns false if the frame has no valid pose.
+        //
+        static bool ComputeCameraToWorld(
+            _In_ const std::array<float, 16>& frameToOrigin,
+            _In_ const std::array<float, 16>& cameraViewTransform,
+            _Out_ cv::Matx44f& cameraToWorld);
+
+        //
+        // Converts one depth frame. Rows are processed in parallel.
+        //
+        void Compute(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& cameraToWorld,
+            _In_ const Options& options,
+            _Out_ std::vector<cv::Point3f>& points) const;
+
+        //
+        // Converts several depth frames, in parallel across frames.
+        //
+        void ComputeBatch(
+            _In_ const std::vector<cv::Mat>& depths,
+            _In_ const std::vector<cv::Matx44f>& camerasToWorld,
+            _In_ const Options& options,
+            _Out_ std::vector<std::vector<cv::Point3f>>& pointClouds) const;
+
+        //
+        // Converts all the frames recorded for a depth sensor, writing one binary PLY
+        // file per frame into the output folder (named after the frame's timestamp).
+        // Uses the camera projection model or the dense table found in the recording.
+        //
+        static bool ConvertRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName,
+            _In_ const std::string& outputFolder,
+            _In_ const Options& options,
+            _Out_ ConversionStatistics& statistics);
+
+        static bool WritePly(
+            _In_ const std::string& fileName,
+            _In_ const std::vector<cv::Point3f>& points);
+
+        //
+        // Writes the points as consecutive little-endian float triplets.
+        //
+        static bool WriteRaw(
+            _In_ const std::string& fileName,
+            _In_ const std::vector<cv::Point3f>& points);
+
+    private:
+        void ComputeRows(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& cameraToWorld,
+            _In_ const Options& options,
+            _In_ int32_t beginRow,
+            _In_ int32_t endRow,
+            _Inout_ std::vector<cv::Point3f>& points) const;
+
+    private:
+        // Components of the normalized rays -(x, y, 1) / sqrt(x^2 + y^2 + 1), zero for
+        // pixels without a valid mapping.
+        cv::Mat _rayX;
+        cv::Mat _rayY;
+        cv::Mat _rayZ;
+    };
+}
@@ -26,11 +26,8 @@ namespace HoloLensForCV
         _In_ ROSSensorFrameStreamHeader^ header,
         _Inout_ Windows::Storage::Streams::DataWriter^ dataWriter)
     {
-#if DBG_ENABLE_INFORMATIONAL_LOGGING
-        dbg::TimerGuard timerGuard(
-            L"ROSSensorFrameStreamHeader::Write: buffer write operation [header]",
-            0.0 /* minimum_time_elapsed_in_milliseconds */);
-#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+        DBG_PROFILE_SPAN(
+            "ROSSensorFrameStreamHeader::Write: buffer write operation [header]");
 
         dataWriter->WriteUInt64(header->Timestamp);
         dataWriter->WriteUInt32(header->ImageWidth);
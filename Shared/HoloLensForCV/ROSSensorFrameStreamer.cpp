@@ -4,6 +4,8 @@ namespace HoloLensForCV
 {
     ROSSensorFrameStreamer::ROSSensorFrameStreamer()
     {
+        StreamHeightMapUpdates = false;
+        StreamMarkerPoses = false;
     }
 
     void ROSSensorFrameStreamer::Enable(
@@ -12,19 +14,43 @@ namespace HoloLensForCV
         switch (sensorType)
         {
         case SensorType::PhotoVideo:
-            _sensorFrameStreamingServers[(int32_t)SensorType::PhotoVideo] =
-                ref new ROSSensorFrameStreamingServer(L"10080");
+            if (StreamMarkerPoses)
+            {
+                _sensorFrameStreamingServers[(int32_t)SensorType::PhotoVideo] =
+                    ref new MarkerStreamingServer(L"10080");
+            }
+            else
+            {
+                _sensorFrameStreamingServers[(int32_t)SensorType::PhotoVideo] =
+                    ref new ROSSensorFrameStreamingServer(L"10080");
+            }
             break;
 
 #if ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS
         case SensorType::ShortThrowToFDepth:
-            _sensorFrameStreamingServers[(int32_t)SensorType::ShortThrowToFDepth] =
-                ref new ROSSensorFrameStreamingServer(L"10081");
+            if (StreamHeightMapUpdates)
+            {
+                _sensorFrameStreamingServers[(int32_t)SensorType::ShortThrowToFDepth] =
+                    ref new HeightMapStreamingServer(L"10081", SensorType::ShortThrowToFDepth);
+            }
+            else
+            {
+                _sensorFrameStreamingServers[(int32_t)SensorType::ShortThrowToFDepth] =
+                    ref new ROSSensorFrameStreamingServer(L"10081");
+            }
             break;
 
         case SensorType::LongThrowToFDepth:
-            _sensorFrameStreamingServers[(int32_t)SensorType::LongThrowToFDepth] =
-                ref new ROSSensorFrameStreamingServer(L"10082");
+            if (StreamHeightMapUpdates)
+            {
+                _sensorFrameStreamingServers[(int32_t)SensorType::LongThrowToFDepth] =
+                    ref new HeightMapStreamingServer(L"10082", SensorType::LongThrowToFDepth);
+            }
+            else
+            {
+                _sensorFrameStreamingServers[(int32_t)SensorType::LongThrowToFDepth] =
+                    ref new ROSSensorFrameStreamingServer(L"10082");
+            }
             break;
 #endif /* ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS */
         }
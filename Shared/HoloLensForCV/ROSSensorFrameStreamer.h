@@ -12,6 +12,18 @@ namespace HoloLensForCV
     public:
         ROSSensorFrameStreamer();
 
+        //
+        // When set before enabling the depth sensors, their ports stream height map updates
+        // (see HeightMapStreamingServer) instead of the depth frames.
+        //
+        property bool StreamHeightMapUpdates;
+
+        //
+        // When set before enabling the photo video camera, its port streams the poses of
+        // the fiducial markers in view (see MarkerStreamingServer) instead of the frames.
+        //
+        property bool StreamMarkerPoses;
+
         void Enable(
             _In_ SensorType sensorType);
 
@@ -19,6 +31,6 @@ namespace HoloLensForCV
             _In_ SensorType sensorType);
 
     private:
-        std::array<ROSSensorFrameStreamingServer^, (size_t)SensorType::NumberOfSensorTypes> _sensorFrameStreamingServers;
+        std::array<ISensorFrameSink^, (size_t)SensorType::NumberOfSensorTypes> _sensorFrameStreamingServers;
     };
 }
@@ -6,6 +6,8 @@ namespace HoloLensForCV
     ROSSensorFrameStreamingServer::ROSSensorFrameStreamingServer(
         _In_ Platform::String^ serviceName)
         : _writeInProgress(false)
+        , _metrics("hololensforcv_ros_streaming", serviceName)
+        , _latencyBreakdown("ros_streaming")
     {
         // Initialize a TCP stream socket listener for incoming network 
         _listener = ref new Windows::Networking::Sockets::StreamSocketListener();
@@ -30,7 +32,9 @@ namespace HoloLensForCV
                 catch (Platform::Exception^ exception)
                 {
 #if DBG_ENABLE_ERROR_LOGGING
-                    dbg::trace(
+                    DBG_LOG(
+                        "ROSSensorFrameStreamingServer",
+                        dbg::LogLevel::Error,
                         L"ROSSensorFrameStreamingServer::ROSSensorFrameStreamingServer: %s",
                         exception->Message->Data());
 #endif /* DBG_ENABLE_ERROR_LOGGING */
@@ -74,11 +78,15 @@ namespace HoloLensForCV
 
         _previousTimestamp = sensorFrame->Timestamp;
 
-#if DBG_ENABLE_INFORMATIONAL_LOGGING
-        dbg::TimerGuard timerGuard(
-            L"ROSSensorFrameStreamingServer::Send: buffer prepare operation",
+        SensorFrameTrace trace =
+            sensorFrame->GetTrace();
+
+        trace.Mark(
+            SensorFrameStage::SinkDequeue);
+
+        DBG_PROFILE_SPAN_REPORT_OVER(
+            "ROSSensorFrameStreamingServer::Send: buffer prepare operation",
             10.0 /* minimum_time_elapsed_in_milliseconds */);
-#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
         std::chrono::nanoseconds currTimestamp = 
             std::chrono::duration_cast<std::chrono::nanoseconds>(
                 std::chrono::system_clock::now().time_since_epoch());   // use current nano seconds as timestamp (already in Unix epoch)
@@ -95,6 +103,9 @@ namespace HoloLensForCV
         double_t resizeScale = 0.5;
 
         {
+            trace.Mark(
+                SensorFrameStage::EncodeStart);
+
             bitmap = sensorFrame->SoftwareBitmap;
 
             bitmapBufferReference = 
@@ -110,6 +121,25 @@ namespace HoloLensForCV
             {
 
                 case Windows::Graphics::Imaging::BitmapPixelFormat::Bgra8:
+                {
+                    //
+                    // The half-resolution image is taken from the frame's pyramid, which
+                    // the other sinks (e.g. feature extraction) share.
+                    //
+                    const std::shared_ptr<ImagePyramid> imagePyramid =
+                        sensorFrame->GetImagePyramid();
+
+                    if (nullptr != imagePyramid &&
+                        CV_8UC4 == imagePyramid->GetLevel(0).type() &&
+                        imagePyramid->GetNumberOfLevels() > 1)
+                    {
+                        cv::cvtColor(
+                            imagePyramid->GetLevel(1), wrappedImage,
+                            cv::COLOR_BGRA2BGR);
+
+                        break;
+                    }
+
                     wrappedImage = cv::Mat(
                         bitmap->PixelHeight,
                         bitmap->PixelWidth,
@@ -126,6 +156,7 @@ namespace HoloLensForCV
                         cv::INTER_LINEAR);
                     
                     break;
+                }
 
                 case Windows::Graphics::Imaging::BitmapPixelFormat::Gray16:
                     wrappedImage = cv::Mat(
@@ -152,12 +183,19 @@ namespace HoloLensForCV
                 ref new Platform::Array<byte>(
                     wrappedImage.data,
                     imageBufferSize);
+
+            trace.Mark(
+                SensorFrameStage::EncodeEnd);
         }
 
         if (_writeInProgress)
         {
+            _metrics.OnFrameDropped();
+
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "ROSSensorFrameStreamingServer",
+                dbg::LogLevel::Information,
                 L"ROSSensorFrameStreamingServer::Send: image dropped -- previous send operation is in progress!");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -185,18 +223,58 @@ namespace HoloLensForCV
             _writer->WriteBytes(imageBufferAsPlatformArray);    // Image BytesArray
         }
 
+        //
+        // The store completes on a thread pool thread; its span is recorded there, from
+        // the time the store was started.
+        //
+        const int64_t storeBeginTicks =
+            dbg::Timer::GetCurrentTicks();
+
+        const Windows::Foundation::DateTime timestamp =
+            sensorFrame->Timestamp;
+
+        const SensorType frameType =
+            sensorFrame->FrameType;
+
         Concurrency::create_task(_writer->StoreAsync()).then(
-            [&](Concurrency::task<unsigned int> writeTask)
+            [&, storeBeginTicks, timestamp, frameType, trace](Concurrency::task<unsigned int> writeTask)
             {
+                if (dbg::Profiler::IsEnabled())
+                {
+                    dbg::Profiler::RecordSpan(
+                        "ROSSensorFrameStreamingServer::Send: StoreAsync",
+                        storeBeginTicks,
+                        dbg::Timer::GetCurrentTicks(),
+                        0 /* depth */);
+                }
+
                 try
                 {
-                    writeTask.get();
+                    const unsigned int numberOfBytesStored =
+                        writeTask.get();
+
+                    _metrics.OnFrameSent(
+                        timestamp,
+                        numberOfBytesStored);
+
+                    SensorFrameTrace sentTrace =
+                        trace;
+
+                    sentTrace.Mark(
+                        SensorFrameStage::SendComplete);
+
+                    _latencyBreakdown.Record(
+                        frameType,
+                        sentTrace);
+
                     _writeInProgress = false;
                 }
                 catch (Platform::Exception^ exception)
                 {
 #if DBG_ENABLE_ERROR_LOGGING
-                    dbg::trace(
+                    DBG_LOG(
+                        "ROSSensorFrameStreamingServer",
+                        dbg::LogLevel::Error,
                         L"ROSSensorFrameStreamingServer::SendImage: StoreAsync call failed with error: %s",
                         exception->Message->Data());
 #endif /* DBG_ENABLE_ERROR_LOGGING */
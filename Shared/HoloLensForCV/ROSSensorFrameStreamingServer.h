@@ -34,5 +34,8 @@ namespace HoloLensForCV
         bool _writeInProgress;
         Windows::Foundation::DateTime _previousTimestamp;
         //Io::TimeConverter _timeConverter;
+
+        StreamingServerMetrics _metrics;
+        SensorFrameLatencyBreakdown _latencyBreakdown;
     };
 }
@@ -13,6 +13,45 @@
 
 namespace HoloLensForCV
 {
+    namespace
+    {
+        Platform::String^ ToPlatformString(
+            _In_ const std::string& value)
+        {
+            const std::wstring wideValue(
+                value.begin(),
+                value.end());
+
+            return ref new Platform::String(
+                wideValue.c_str());
+        }
+
+        bool IsVisibleLightCamera(
+            _In_ SensorType sensorType)
+        {
+            return
+                SensorType::VisibleLightLeftLeft == sensorType ||
+                SensorType::VisibleLightLeftFront == sensorType ||
+                SensorType::VisibleLightRightFront == sensorType ||
+                SensorType::VisibleLightRightRight == sensorType;
+        }
+
+        //
+        // Keeps a bitmap locked for reading for as long as an image pyramid wraps it.
+        //
+        struct LockedBitmapBuffer
+        {
+            ~LockedBitmapBuffer()
+            {
+                delete BufferReference;
+                delete Buffer;
+            }
+
+            Windows::Graphics::Imaging::BitmapBuffer^ Buffer;
+            Windows::Foundation::IMemoryBufferReference^ BufferReference;
+        };
+    }
+
     SensorFrame::SensorFrame(
         _In_ SensorType frameType,
         _In_ Windows::Foundation::DateTime timestamp,
@@ -22,4 +61,100 @@ namespace HoloLensForCV
         Timestamp = timestamp;
         SoftwareBitmap = softwareBitmap;
     }
+
+    /* static */ Platform::String^ SensorFrame::GetImagePyramidStatisticsAsJson()
+    {
+        return ToPlatformString(
+            ImagePyramidPool::GetDefault()->GetStatisticsAsJson());
+    }
+
+    /* static */ void SensorFrame::ResetImagePyramidStatistics()
+    {
+        ImagePyramidPool::GetDefault()->ResetStatistics();
+    }
+
+    SensorFrameTrace& SensorFrame::GetTrace()
+    {
+        return _trace;
+    }
+
+    std::shared_ptr<ImagePyramid> SensorFrame::GetImagePyramid()
+    {
+        std::lock_guard<std::mutex> guard(_imagePyramidMutex);
+
+        if (nullptr != _imagePyramid)
+        {
+            return _imagePyramid;
+        }
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            SoftwareBitmap;
+
+        if (nullptr == softwareBitmap)
+        {
+            return nullptr;
+        }
+
+        int32_t imageWidth;
+        int32_t imageType;
+
+        switch (softwareBitmap->BitmapPixelFormat)
+        {
+        case Windows::Graphics::Imaging::BitmapPixelFormat::Bgra8:
+            if (IsVisibleLightCamera(FrameType))
+            {
+                imageWidth = softwareBitmap->PixelWidth * 4;
+                imageType = CV_8UC1;
+            }
+            else
+            {
+                imageWidth = softwareBitmap->PixelWidth;
+                imageType = CV_8UC4;
+            }
+            break;
+
+        case Windows::Graphics::Imaging::BitmapPixelFormat::Gray8:
+            imageWidth = softwareBitmap->PixelWidth;
+            imageType = CV_8UC1;
+            break;
+
+        default:
+            return nullptr;
+        }
+
+        std::shared_ptr<LockedBitmapBuffer> lockedBitmapBuffer =
+            std::make_shared<LockedBitmapBuffer>();
+
+        lockedBitmapBuffer->Buffer =
+            softwareBitmap->LockBuffer(
+                Windows::Graphics::Imaging::BitmapBufferAccessMode::Read);
+
+        lockedBitmapBuffer->BufferReference =
+            lockedBitmapBuffer->Buffer->CreateReference();
+
+        const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+            lockedBitmapBuffer->Buffer->GetPlaneDescription(0);
+
+        uint32_t pixelBufferDataLength = 0;
+
+        uint8_t* pixelBufferData =
+            Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                lockedBitmapBuffer->BufferReference,
+                pixelBufferDataLength);
+
+        const cv::Mat image(
+            softwareBitmap->PixelHeight,
+            imageWidth,
+            imageType,
+            pixelBufferData + bitmapPlaneDescription.StartIndex,
+            bitmapPlaneDescription.Stride);
+
+        _imagePyramid =
+            std::make_shared<ImagePyramid>(
+                image,
+                ImagePyramidPool::GetDefault(),
+                lockedBitmapBuffer);
+
+        return _imagePyramid;
+    }
 }
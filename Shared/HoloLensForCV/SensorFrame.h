@@ -13,6 +13,10 @@
 
 namespace HoloLensForCV
 {
+    ref class SensorFrameFeatures;
+
+    class ImagePyramid;
+
     //
     // Collects information about a sensor frame -- originated on device, or remotely.
     // 
@@ -34,5 +38,43 @@ namespace HoloLensForCV
         property Windows::Foundation::Numerics::float4x4 FrameToOrigin;
         property Windows::Foundation::Numerics::float4x4 CameraViewTransform;
         property Windows::Foundation::Numerics::float4x4 CameraProjectionTransform;
+
+        //
+        // Keypoints and descriptors of the frame's image, if a FeatureExtractionSink (or
+        // the recording the frame was played back from) provided them.
+        //
+        property SensorFrameFeatures^ Features;
+
+        //
+        // Returns the image pyramid statistics of all sensor frames (see
+        // ImagePyramidPool), as JSON.
+        //
+        static Platform::String^ GetImagePyramidStatisticsAsJson();
+
+        static void ResetImagePyramidStatistics();
+
+    internal:
+        //
+        // Returns the pyramid of the frame's bitmap, created on first request and shared
+        // by all the sinks the frame is sent to; nullptr if the bitmap is not an 8-bit
+        // image. Visible light camera frames, which pack four grayscale pixels per BGRA
+        // pixel, are unpacked to single channel images.
+        //
+        // The bitmap stays locked for reading while the pyramid is held.
+        //
+        std::shared_ptr<ImagePyramid> GetImagePyramid();
+
+        //
+        // The times at which the frame was exposed and received. Set before the frame is
+        // sent to the sinks, which copy it to trace their own stages.
+        //
+        SensorFrameTrace& GetTrace();
+
+    private:
+        std::mutex _imagePyramidMutex;
+
+        std::shared_ptr<ImagePyramid> _imagePyramid;
+
+        SensorFrameTrace _trace;
     };
 }
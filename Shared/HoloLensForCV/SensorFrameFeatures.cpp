@@ -0,0 +1,70 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    SensorFrameFeatures::SensorFrameFeatures(
+        _In_ ImageFeatures features)
+        : _features(std::move(features))
+    {
+        REQUIRES(_features.Descriptors.rows == static_cast<int32_t>(_features.Keypoints.size()));
+    }
+
+    uint32_t SensorFrameFeatures::NumberOfFeatures::get()
+    {
+        return static_cast<uint32_t>(_features.Keypoints.size());
+    }
+
+    Platform::Array<float>^ SensorFrameFeatures::GetKeypointPositions()
+    {
+        Platform::Array<float>^ positions =
+            ref new Platform::Array<float>(
+                static_cast<uint32_t>(2 * _features.Keypoints.size()));
+
+        for (size_t i = 0; i < _features.Keypoints.size(); ++i)
+        {
+            positions[static_cast<uint32_t>(2 * i)] = _features.Keypoints[i].pt.x;
+            positions[static_cast<uint32_t>(2 * i + 1)] = _features.Keypoints[i].pt.y;
+        }
+
+        return positions;
+    }
+
+    Platform::Array<uint8_t>^ SensorFrameFeatures::GetDescriptors()
+    {
+        const cv::Mat& descriptors =
+            _features.Descriptors;
+
+        const size_t rowSizeInBytes =
+            static_cast<size_t>(descriptors.cols);
+
+        Platform::Array<uint8_t>^ data =
+            ref new Platform::Array<uint8_t>(
+                static_cast<uint32_t>(descriptors.rows * rowSizeInBytes));
+
+        for (int32_t row = 0; row < descriptors.rows; ++row)
+        {
+            memcpy(
+                data->Data + row * rowSizeInBytes,
+                descriptors.ptr<uint8_t>(row),
+                rowSizeInBytes);
+        }
+
+        return data;
+    }
+
+    const ImageFeatures& SensorFrameFeatures::GetImageFeatures()
+    {
+        return _features;
+    }
+}
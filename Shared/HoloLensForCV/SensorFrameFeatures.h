@@ -0,0 +1,48 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Keypoints and binary descriptors attached to a sensor frame (see FeatureExtractor).
+    // Positions are in pixels of the frame's image; for the visible light cameras, whose
+    // bitmaps pack four grayscale pixels per BGRA pixel, of the unpacked image.
+    //
+    public ref class SensorFrameFeatures sealed
+    {
+    public:
+        property uint32_t NumberOfFeatures
+        {
+            uint32_t get();
+        }
+
+        //
+        // Returns the keypoint positions as (x, y) pairs.
+        //
+        Platform::Array<float>^ GetKeypointPositions();
+
+        //
+        // Returns the descriptors, FeatureExtractor::DescriptorSize bytes per keypoint.
+        //
+        Platform::Array<uint8_t>^ GetDescriptors();
+
+    internal:
+        SensorFrameFeatures(
+            _In_ ImageFeatures features);
+
+        const ImageFeatures& GetImageFeatures();
+
+    private:
+        ImageFeatures _features;
+    };
+}
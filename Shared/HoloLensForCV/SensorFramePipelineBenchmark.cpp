@@ -0,0 +1,123 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    SensorFramePipelineBenchmark::SensorFramePipelineBenchmark()
+    {
+        const PipelineBenchmark::Options defaultOptions;
+
+        DurationInSeconds = defaultOptions.DurationInSeconds;
+        NumberOfWarmupFrames = defaultOptions.NumberOfWarmupFrames;
+        Paced = defaultOptions.Paced;
+    }
+
+    void SensorFramePipelineBenchmark::EnableAll()
+    {
+        Enable(SensorType::PhotoVideo);
+
+#if ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS
+        Enable(SensorType::ShortThrowToFDepth);
+        Enable(SensorType::ShortThrowToFReflectivity);
+        Enable(SensorType::LongThrowToFDepth);
+        Enable(SensorType::LongThrowToFReflectivity);
+        Enable(SensorType::VisibleLightLeftLeft);
+        Enable(SensorType::VisibleLightLeftFront);
+        Enable(SensorType::VisibleLightRightFront);
+        Enable(SensorType::VisibleLightRightRight);
+#endif /* ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS */
+    }
+
+    void SensorFramePipelineBenchmark::Enable(
+        _In_ SensorType sensorType)
+    {
+        if (std::find(_sensorTypes.begin(), _sensorTypes.end(), sensorType) != _sensorTypes.end())
+        {
+            return;
+        }
+
+        _sensorTypes.push_back(
+            sensorType);
+    }
+
+    Platform::String^ SensorFramePipelineBenchmark::Run(
+        _In_ Platform::String^ name,
+        _In_ ISensorFrameSinkGroup^ sensorFrameSinkGroup)
+    {
+        REQUIRES(!_sensorTypes.empty());
+
+        SyntheticSensorFrameGenerator generator;
+        std::vector<ISensorFrameSink^> sensorFrameSinks;
+
+        for (const SensorType sensorType : _sensorTypes)
+        {
+            SyntheticSensorProfile profile;
+
+            ASSERT(SyntheticSensorFrameGenerator::GetDefaultProfile(
+                Utf16ToUtf8(GetSensorTypeName(sensorType)),
+                profile));
+
+            generator.AddSensor(
+                profile);
+
+            sensorFrameSinks.push_back(
+                sensorFrameSinkGroup->GetSensorFrameSink(
+                    sensorType));
+        }
+
+        PipelineBenchmark::Options options;
+
+        options.DurationInSeconds = DurationInSeconds;
+        options.NumberOfWarmupFrames = NumberOfWarmupFrames;
+        options.Paced = Paced;
+
+        //
+        // Converting the frames to sensor frames is part of the measurement, as is
+        // the creation of the sensor frames by the media frame readers on device.
+        //
+        const PipelineBenchmark::Results results =
+            PipelineBenchmark::Run(
+                Utf16ToUtf8(name->Data()),
+                generator,
+                [&](const RecordedSensorFrame& frame)
+            {
+                ISensorFrameSink^ sensorFrameSink =
+                    sensorFrameSinks[frame.SensorIndex];
+
+                if (nullptr == sensorFrameSink)
+                {
+                    return;
+                }
+
+                sensorFrameSink->Send(
+                    CreateSensorFrame(
+                        _sensorTypes[frame.SensorIndex],
+                        frame));
+            },
+                options);
+
+        _results.push_back(
+            results);
+
+        return ref new Platform::String(
+            Utf8ToUtf16(
+                PipelineBenchmark::ToJson({ results })).c_str());
+    }
+
+    Platform::String^ SensorFramePipelineBenchmark::GetResultsAsJson()
+    {
+        return ref new Platform::String(
+            Utf8ToUtf16(
+                PipelineBenchmark::ToJson(_results)).c_str());
+    }
+}
@@ -0,0 +1,56 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Benchmarks sensor frame sink groups (the streamer, the recorder, the multi-frame
+    // buffer, ...) with synthetic frames that mimic the enabled sensors.
+    //
+    // Refer to PipelineBenchmark for the platform-independent implementation.
+    //
+    public ref class SensorFramePipelineBenchmark sealed
+    {
+    public:
+        SensorFramePipelineBenchmark();
+
+        property double DurationInSeconds;
+
+        property uint32_t NumberOfWarmupFrames;
+
+        //
+        // Deliver frames on the sensors' nominal schedules rather than back-to-back.
+        //
+        property bool Paced;
+
+        void EnableAll();
+
+        void Enable(
+            _In_ SensorType sensorType);
+
+        //
+        // Runs the benchmark against the sinks of the given group and returns its
+        // results as JSON. The results are also accumulated for GetResultsAsJson.
+        //
+        Platform::String^ Run(
+            _In_ Platform::String^ name,
+            _In_ ISensorFrameSinkGroup^ sensorFrameSinkGroup);
+
+        Platform::String^ GetResultsAsJson();
+
+    private:
+        std::vector<SensorType> _sensorTypes;
+
+        std::vector<PipelineBenchmark::Results> _results;
+    };
+}
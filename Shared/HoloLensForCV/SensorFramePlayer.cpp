@@ -0,0 +1,316 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        Windows::Foundation::Numerics::float4x4 ToFloat4x4(
+            _In_ const std::array<float, 16>& m)
+        {
+            return Windows::Foundation::Numerics::float4x4(
+                m[0], m[1], m[2], m[3],
+                m[4], m[5], m[6], m[7],
+                m[8], m[9], m[10], m[11],
+                m[12], m[13], m[14], m[15]);
+        }
+    }
+
+    SensorFrame^ CreateSensorFrame(
+        _In_ SensorType sensorType,
+        _In_ const RecordedSensorFrame& recordedSensorFrame)
+    {
+        //
+        // Reproduce the bitmap formats delivered by the media capture pipeline.
+        //
+        const cv::Mat& image =
+            recordedSensorFrame.Image;
+
+        cv::Mat convertedImage;
+
+        Windows::Graphics::Imaging::BitmapPixelFormat pixelFormat;
+        int32_t bitmapWidth = image.cols;
+
+        switch (image.type())
+        {
+        case CV_16UC1:
+            pixelFormat = Windows::Graphics::Imaging::BitmapPixelFormat::Gray16;
+            convertedImage = image;
+            break;
+
+        case CV_8UC1:
+            if (SensorType::VisibleLightLeftLeft == sensorType ||
+                SensorType::VisibleLightLeftFront == sensorType ||
+                SensorType::VisibleLightRightFront == sensorType ||
+                SensorType::VisibleLightRightRight == sensorType)
+            {
+                //
+                // Visible light camera frames are delivered as BGRA images, with each of
+                // the BGRA values representing 4 consecutive grayscale pixel intensities.
+                //
+                ASSERT(0 == image.cols % 4);
+
+                pixelFormat = Windows::Graphics::Imaging::BitmapPixelFormat::Bgra8;
+                bitmapWidth = image.cols / 4;
+            }
+            else
+            {
+                pixelFormat = Windows::Graphics::Imaging::BitmapPixelFormat::Gray8;
+            }
+
+            convertedImage = image;
+            break;
+
+        case CV_8UC4:
+            pixelFormat = Windows::Graphics::Imaging::BitmapPixelFormat::Bgra8;
+            convertedImage = image;
+            break;
+
+        case CV_8UC3:
+            pixelFormat = Windows::Graphics::Imaging::BitmapPixelFormat::Bgra8;
+
+            cv::cvtColor(
+                image,
+                convertedImage,
+                cv::COLOR_BGR2BGRA);
+            break;
+
+        default:
+#if DBG_ENABLE_ERROR_LOGGING
+            DBG_LOG(
+                "SensorFramePlayer",
+                dbg::LogLevel::Error,
+                L"CreateSensorFrame: unsupported image type %i",
+                image.type());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+
+            return nullptr;
+        }
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            ref new Windows::Graphics::Imaging::SoftwareBitmap(
+                pixelFormat,
+                bitmapWidth,
+                convertedImage.rows,
+                Windows::Graphics::Imaging::BitmapAlphaMode::Ignore);
+
+        {
+            Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+                softwareBitmap->LockBuffer(
+                    Windows::Graphics::Imaging::BitmapBufferAccessMode::Write);
+
+            const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+                bitmapBuffer->GetPlaneDescription(0);
+
+            Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+                bitmapBuffer->CreateReference();
+
+            uint32_t pixelBufferDataLength = 0;
+
+            uint8_t* pixelBufferData =
+                Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                    bitmapBufferReference,
+                    pixelBufferDataLength);
+
+            const int32_t rowSizeInBytes =
+                convertedImage.cols * static_cast<int32_t>(convertedImage.elemSize());
+
+            ASSERT(rowSizeInBytes <= bitmapPlaneDescription.Stride);
+
+            cv::Mat(
+                convertedImage.rows,
+                rowSizeInBytes,
+                CV_8UC1,
+                convertedImage.data,
+                convertedImage.step).copyTo(
+                    cv::Mat(
+                        convertedImage.rows,
+                        rowSizeInBytes,
+                        CV_8UC1,
+                        pixelBufferData + bitmapPlaneDescription.StartIndex,
+                        bitmapPlaneDescription.Stride));
+
+            delete bitmapBufferReference;
+            delete bitmapBuffer;
+        }
+
+        Windows::Foundation::DateTime timestamp;
+
+        timestamp.UniversalTime =
+            static_cast<int64_t>(recordedSensorFrame.Timestamp);
+
+        SensorFrame^ sensorFrame =
+            ref new SensorFrame(
+                sensorType,
+                timestamp,
+                softwareBitmap);
+
+        sensorFrame->FrameToOrigin =
+            ToFloat4x4(recordedSensorFrame.FrameToOrigin);
+
+        sensorFrame->CameraViewTransform =
+            ToFloat4x4(recordedSensorFrame.CameraViewTransform);
+
+        sensorFrame->CameraProjectionTransform =
+            ToFloat4x4(recordedSensorFrame.CameraProjectionTransform);
+
+        if (!recordedSensorFrame.Features.Keypoints.empty())
+        {
+            sensorFrame->Features =
+                ref new SensorFrameFeatures(
+                    recordedSensorFrame.Features);
+        }
+
+        return sensorFrame;
+    }
+
+    SensorFramePlayer::SensorFramePlayer(
+        _In_ Platform::String^ recordingFolder,
+        _In_ ISensorFrameSinkGroup^ sensorFrameSinkGroup)
+        : _recordingFolder(Utf16ToUtf8(recordingFolder->Data()))
+        , _sensorFrameSinkGroup(sensorFrameSinkGroup)
+    {
+        const SensorFramePlaybackEngine::Options defaultOptions;
+
+        PlaybackSpeed = defaultOptions.PlaybackSpeed;
+        Loop = defaultOptions.Loop;
+        PrefetchDepth = defaultOptions.PrefetchDepth;
+        NumberOfDecodingThreads = defaultOptions.NumberOfDecodingThreads;
+    }
+
+    SensorFramePlayer::~SensorFramePlayer()
+    {
+        Stop();
+    }
+
+    void SensorFramePlayer::EnableAll()
+    {
+        Enable(SensorType::PhotoVideo);
+
+#if ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS
+        Enable(SensorType::ShortThrowToFDepth);
+        Enable(SensorType::ShortThrowToFReflectivity);
+        Enable(SensorType::LongThrowToFDepth);
+        Enable(SensorType::LongThrowToFReflectivity);
+        Enable(SensorType::VisibleLightLeftLeft);
+        Enable(SensorType::VisibleLightLeftFront);
+        Enable(SensorType::VisibleLightRightFront);
+        Enable(SensorType::VisibleLightRightRight);
+#endif /* ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS */
+    }
+
+    bool SensorFramePlayer::Enable(
+        _In_ SensorType sensorType)
+    {
+        const int32_t sensorIndex =
+            _playbackEngine.AddSensor(
+                _recordingFolder,
+                Utf16ToUtf8(GetSensorTypeName(sensorType)));
+
+        if (sensorIndex < 0)
+        {
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+            DBG_LOG(
+                "SensorFramePlayer",
+                dbg::LogLevel::Information,
+                L"SensorFramePlayer::Enable: no frames recorded for sensor %s",
+                GetSensorTypeName(sensorType));
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+            return false;
+        }
+
+        ASSERT(static_cast<size_t>(sensorIndex) == _sensorTypes.size());
+
+        _sensorTypes.push_back(
+            sensorType);
+
+        return true;
+    }
+
+    void SensorFramePlayer::Start()
+    {
+        SensorFramePlaybackEngine::Options options;
+
+        options.PlaybackSpeed = PlaybackSpeed;
+        options.Loop = Loop;
+        options.PrefetchDepth = PrefetchDepth;
+        options.NumberOfDecodingThreads = NumberOfDecodingThreads;
+
+        _playbackEngine.Start(
+            options,
+            [this](const RecordedSensorFrame& recordedSensorFrame)
+        {
+            Send(
+                recordedSensorFrame);
+        });
+    }
+
+    void SensorFramePlayer::Stop()
+    {
+        _playbackEngine.Stop();
+    }
+
+    Windows::Foundation::IAsyncAction^ SensorFramePlayer::WaitForCompletionAsync()
+    {
+        return concurrency::create_async(
+            [this]()
+        {
+            _playbackEngine.WaitForCompletion();
+        });
+    }
+
+    bool SensorFramePlayer::IsPlaying::get()
+    {
+        return _playbackEngine.IsRunning();
+    }
+
+    uint64_t SensorFramePlayer::FramesDelivered::get()
+    {
+        return _playbackEngine.GetStatistics().FramesDelivered;
+    }
+
+    uint64_t SensorFramePlayer::FramesDeliveredLate::get()
+    {
+        return _playbackEngine.GetStatistics().FramesDeliveredLate;
+    }
+
+    void SensorFramePlayer::Send(
+        _In_ const RecordedSensorFrame& recordedSensorFrame)
+    {
+        const SensorType sensorType =
+            _sensorTypes[recordedSensorFrame.SensorIndex];
+
+        ISensorFrameSink^ sensorFrameSink =
+            _sensorFrameSinkGroup->GetSensorFrameSink(
+                sensorType);
+
+        if (nullptr == sensorFrameSink)
+        {
+            return;
+        }
+
+        SensorFrame^ sensorFrame =
+            CreateSensorFrame(
+                sensorType,
+                recordedSensorFrame);
+
+        if (nullptr == sensorFrame)
+        {
+            return;
+        }
+
+        sensorFrameSink->Send(
+            sensorFrame);
+    }
+}
@@ -0,0 +1,94 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Creates a sensor frame from a recorded (or synthetic) frame, using the bitmap formats
+    // delivered by the media capture pipeline. Returns nullptr for unsupported images.
+    //
+    SensorFrame^ CreateSensorFrame(
+        _In_ SensorType sensorType,
+        _In_ const RecordedSensorFrame& recordedSensorFrame);
+
+    //
+    // Replays a recording made with the SensorFrameRecorder (extracted to a folder) into
+    // the sensor frame sinks of a sink group, as if the frames were coming from the
+    // device's sensors.
+    //
+    // Refer to SensorFramePlaybackEngine for the platform-independent implementation.
+    //
+    public ref class SensorFramePlayer sealed
+    {
+    public:
+        SensorFramePlayer(
+            _In_ Platform::String^ recordingFolder,
+            _In_ ISensorFrameSinkGroup^ sensorFrameSinkGroup);
+
+        //
+        // 1.0 replays on the recorded schedule, 2.0 twice as fast, etc. Zero or negative
+        // values deliver frames as fast as the sinks accept them.
+        //
+        property double PlaybackSpeed;
+
+        property bool Loop;
+
+        property uint32_t PrefetchDepth;
+
+        property uint32_t NumberOfDecodingThreads;
+
+        void EnableAll();
+
+        //
+        // Returns false if the recording does not contain frames for this sensor.
+        //
+        bool Enable(
+            _In_ SensorType sensorType);
+
+        void Start();
+
+        void Stop();
+
+        Windows::Foundation::IAsyncAction^ WaitForCompletionAsync();
+
+        property bool IsPlaying
+        {
+            bool get();
+        }
+
+        property uint64_t FramesDelivered
+        {
+            uint64_t get();
+        }
+
+        property uint64_t FramesDeliveredLate
+        {
+            uint64_t get();
+        }
+
+    private:
+        ~SensorFramePlayer();
+
+        void Send(
+            _In_ const RecordedSensorFrame& recordedSensorFrame);
+
+    private:
+        std::string _recordingFolder;
+        ISensorFrameSinkGroup^ _sensorFrameSinkGroup;
+
+        // Sensor type for each of the sensors added to the playback engine.
+        std::vector<SensorType> _sensorTypes;
+
+        SensorFramePlaybackEngine _playbackEngine;
+    };
+}
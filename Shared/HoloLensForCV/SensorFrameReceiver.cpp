@@ -16,6 +16,7 @@ namespace HoloLensForCV
     SensorFrameReceiver::SensorFrameReceiver(
         _In_ Windows::Networking::Sockets::StreamSocket^ streamSocket)
         : _streamSocket(streamSocket)
+        , _remoteLatencyBreakdown("sensor_frame_streaming_remote")
     {
         _reader = ref new Windows::Storage::Streams::DataReader(
             _streamSocket->InputStream);
@@ -44,7 +45,9 @@ namespace HoloLensForCV
             if (SensorFrameStreamHeader::ProtocolHeaderLength != headerBytesLoaded)
             {
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameReceiver",
+                    dbg::LogLevel::Error,
                     L"SensorFrameReceiver::ReceiveAsync: expected SensorFrameStreamHeader of %i bytes, got %i bytes",
                     SensorFrameStreamHeader::ProtocolHeaderLength,
                     headerBytesLoaded);
@@ -61,10 +64,13 @@ namespace HoloLensForCV
 
             if (SensorFrameStreamHeader::ProtocolCookie != header->Cookie ||
                 SensorFrameStreamHeader::ProtocolVersionMajor != header->VersionMajor ||
-                SensorFrameStreamHeader::ProtocolVersionMinor != header->VersionMinor)
+                (SensorFrameStreamHeader::ProtocolVersionMinor != header->VersionMinor &&
+                 !header->HasFrameTrace()))
             {
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameReceiver",
+                    dbg::LogLevel::Error,
                     L"SensorFrameReceiver::ReceiveAsync: expected ProtocolCookie/ProtocolVersionMajor/ProtocolVersionMinor of 0x%08x/0x%02x/0x%02x, got 0x%08x/0x%02x/0x%02x",
                     SensorFrameStreamHeader::ProtocolCookie,
                     SensorFrameStreamHeader::ProtocolVersionMajor,
@@ -78,7 +84,9 @@ namespace HoloLensForCV
             }
 
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "SensorFrameReceiver",
+                dbg::LogLevel::Information,
                 L"SensorFrameReceiver::ReceiveAsync: seeing a %ix%i image with pixel stride %i at timestamp %llu",
                 header->ImageWidth,
                 header->ImageHeight,
@@ -93,10 +101,19 @@ namespace HoloLensForCV
     Concurrency::task<SensorFrame^> SensorFrameReceiver::ReceiveSensorFrameAsync(
         SensorFrameStreamHeader^ header)
     {
+        //
+        // The frame trace, if any, is loaded together with the image that follows it.
+        //
+        const uint32_t frameTraceLength =
+            header->HasFrameTrace() ? SensorFrameStreamHeader::FrameTraceLength : 0;
+
+        const uint32_t imageLength =
+            header->ImageHeight * header->RowStride;
+
         return concurrency::create_task(
             _reader->LoadAsync(
-                header->ImageHeight * header->RowStride)).
-            then([this, header](concurrency::task<unsigned int> frameBytesLoadedTaskResult)
+                frameTraceLength + imageLength)).
+            then([this, header, frameTraceLength, imageLength](concurrency::task<unsigned int> frameBytesLoadedTaskResult)
         {
             //
             // Make sure that we have received exactly the number of bytes we have
@@ -105,21 +122,38 @@ namespace HoloLensForCV
             //
             const size_t frameBytesLoaded = frameBytesLoadedTaskResult.get();
 
-            if (header->ImageHeight * header->RowStride != frameBytesLoaded)
+            if (frameTraceLength + imageLength != frameBytesLoaded)
             {
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameReceiver",
+                    dbg::LogLevel::Error,
                     L"SensorFrameReceiver::ReceiveAsync: expected image frame data of %i bytes, got %i bytes",
-                    header->ImageHeight * header->RowStride,
+                    frameTraceLength + imageLength,
                     frameBytesLoaded);
 #endif /* DBG_ENABLE_ERROR_LOGGING */
 
                 throw ref new Platform::FailureException();
             }
 
+            if (header->HasFrameTrace())
+            {
+                SensorFrameStreamHeader::ReadFrameTrace(
+                    _reader,
+                    header);
+
+                //
+                // The trace is relative to the exposure of the frame, so only the time
+                // spent on the device is known; it is aggregated as such.
+                //
+                _remoteLatencyBreakdown.Record(
+                    header->FrameType,
+                    header->FrameTrace);
+            }
+
             Windows::Storage::Streams::IBuffer^ frameAsBuffer =
                 _reader->ReadBuffer(
-                    static_cast<uint32_t>(frameBytesLoaded));
+                    imageLength);
 
             Windows::Graphics::Imaging::BitmapPixelFormat pixelFormat;
             uint32_t packedImageWidthMultiplier = 1;
@@ -150,7 +184,9 @@ namespace HoloLensForCV
 
             default:
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameReceiver",
+                    dbg::LogLevel::Error,
                     L"SensorFrameReceiver::ReceiveAsync: unrecognized sensor type %i",
                     header->FrameType);
 #endif /* DBG_ENABLE_ERROR_LOGGING */
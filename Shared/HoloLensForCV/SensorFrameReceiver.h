@@ -37,5 +37,10 @@ namespace HoloLensForCV
     private:
         Windows::Networking::Sockets::StreamSocket^ _streamSocket;
         Windows::Storage::Streams::DataReader^ _reader;
+
+        //
+        // The device side stage latencies of the frames received with a frame trace.
+        //
+        SensorFrameLatencyBreakdown _remoteLatencyBreakdown;
     };
 }
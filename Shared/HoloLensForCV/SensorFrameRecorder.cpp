@@ -14,7 +14,9 @@
 namespace HoloLensForCV
 {
     SensorFrameRecorder::SensorFrameRecorder()
+        : _clockSynchronizationUpdateIndex(0)
     {
+        WriteDenseCameraSpaceProjection = false;
     }
 
     SensorFrameRecorder::~SensorFrameRecorder()
@@ -80,6 +82,9 @@ namespace HoloLensForCV
 
                     _archiveSourceFolder = archiveSourceFolder;
 
+                    _clockSynchronizationUpdateIndex =
+                        Io::TimeConverter::GetClockSynchronizer().GetLatestRecord().UpdateIndex;
+
                     for (SensorFrameRecorderSink^ sensorFrameSink : _sensorFrameSinks)
                     {
                         if (nullptr == sensorFrameSink)
@@ -134,6 +139,11 @@ namespace HoloLensForCV
         //
         ReportCameraCalibrationInformation(sourceFiles);
 
+        //
+        // Add the drift between the clocks the frame timestamps were converted with.
+        //
+        ReportClockSynchronizationInformation(sourceFiles);
+
         //
         // Create a TAR file containing all the recording files reported so far.
         //
@@ -181,7 +191,7 @@ namespace HoloLensForCV
         sourceFiles.push_back(
             L"recording_version_information.csv");
 
-        CsvWriter csvWriter(
+        Io::CsvWriter csvWriter(
             fileName);
 
         {
@@ -227,8 +237,39 @@ namespace HoloLensForCV
                 continue;
             }
 
+            CameraProjectionModel cameraProjectionModel;
+
+            GetCameraProjectionModel(
+                sensorFrameSink,
+                cameraIntrinsics,
+                cameraProjectionModel);
+
             wchar_t fileName[MAX_PATH] = {};
 
+            swprintf_s(
+                fileName,
+                L"%s\\%s_camera_projection_model.bin",
+                _archiveSourceFolder->Path->Data(),
+                sensorFrameSink->GetSensorName()->Data());
+
+            sourceFiles.push_back(fileName);
+
+            {
+                std::ofstream modelFile(
+                    fileName,
+                    std::ios::out | std::ios::binary);
+
+                cameraProjectionModel.Save(
+                    modelFile);
+
+                ASSERT(!!modelFile);
+            }
+
+            if (!WriteDenseCameraSpaceProjection)
+            {
+                continue;
+            }
+
             swprintf_s(
                 fileName,
                 L"%s\\%s_camera_space_projection.bin",
@@ -237,37 +278,210 @@ namespace HoloLensForCV
 
             sourceFiles.push_back(fileName);
 
-            std::vector<Windows::Foundation::Point> pointList;
-            pointList.resize(cameraIntrinsics->ImageWidth * cameraIntrinsics->ImageHeight);
+            //
+            // The dense table is exact: it is queried from the intrinsics once per pixel,
+            // not generated from the model. It is stored column-major, as pairs of floats.
+            //
+            std::vector<float> pointList(
+                cameraIntrinsics->ImageWidth * cameraIntrinsics->ImageHeight * 2);
+
             size_t index = 0;
+
             for (unsigned int x = 0; x < cameraIntrinsics->ImageWidth; ++x)
             {
                 for (unsigned int y = 0; y < cameraIntrinsics->ImageHeight; ++y)
                 {
                     Windows::Foundation::Point uv = { float(x), float(y) }, xy;
                     cameraIntrinsics->MapImagePointToCameraUnitPlane(uv, &xy);
-                    pointList[index++] = xy;
+                    pointList[index++] = xy.X;
+                    pointList[index++] = xy.Y;
                 }
             }
 
-            //TODO: Better conversion to char*
-            std::wstring ws(fileName);
-            std::string outputFilePath;
-            outputFilePath.assign(ws.begin(), ws.end());
+            std::ofstream denseFile(
+                fileName,
+                std::ios::out | std::ios::binary);
 
-            FILE* file = nullptr;
-            ASSERT(0 == fopen_s(&file, outputFilePath.c_str(), "wb"));
+            denseFile.write(
+                reinterpret_cast<const char*>(pointList.data()),
+                pointList.size() * sizeof(float));
 
-            size_t expectedSize = pointList.size() * sizeof(Windows::Foundation::Point);
-            ASSERT(expectedSize == fwrite(
-                reinterpret_cast<uint8_t*>(&pointList[0]),
-                sizeof(uint8_t),
-                expectedSize,
-                file));
+            ASSERT(!!denseFile);
+        }
+    }
+
+    void SensorFrameRecorder::ReportClockSynchronizationInformation(
+        _Inout_ std::vector<std::wstring>& sourceFiles)
+    {
+        const std::vector<Io::ClockSynchronizationRecord> records =
+            Io::TimeConverter::GetClockSynchronizer().GetRecords(
+                _clockSynchronizationUpdateIndex);
+
+        wchar_t fileName[MAX_PATH] = {};
+
+        swprintf_s(
+            fileName,
+            L"%s\\clock_synchronization.csv",
+            _archiveSourceFolder->Path->Data());
+
+        sourceFiles.push_back(
+            L"clock_synchronization.csv");
+
+        Io::CsvWriter csvWriter(
+            fileName);
+
+        {
+            std::vector<std::wstring> columns;
 
-            ASSERT(0 == fclose(file));
+            columns.push_back(L"RelativeTimestamp");
+            columns.push_back(L"Timestamp");
+            columns.push_back(L"UncertaintyMicroseconds");
+            columns.push_back(L"DriftPartsPerMillion");
+            columns.push_back(L"CorrectionMicroseconds");
+            columns.push_back(L"Stepped");
+            columns.push_back(L"ResidualMicroseconds");
+            columns.push_back(L"NumberOfInliers");
 
+            csvWriter.WriteHeader(
+                columns);
         }
+
+        double maximumCorrectionInMicroseconds = 0.0;
+
+        for (const Io::ClockSynchronizationRecord& record : records)
+        {
+            bool writeComma = false;
+
+            csvWriter.WriteUInt64(
+                record.Sample.ReferenceTicks,
+                &writeComma);
+
+            csvWriter.WriteUInt64(
+                record.Sample.TargetTicks,
+                &writeComma);
+
+            csvWriter.WriteDouble(
+                record.Sample.UncertaintyTicks / 10.0,
+                &writeComma);
+
+            csvWriter.WriteDouble(
+                record.DriftPartsPerMillion,
+                &writeComma);
+
+            csvWriter.WriteDouble(
+                record.CorrectionTicks / 10.0,
+                &writeComma);
+
+            csvWriter.WriteInt32(
+                record.Stepped ? 1 : 0,
+                &writeComma);
+
+            csvWriter.WriteDouble(
+                record.ResidualRootMeanSquare / 10.0,
+                &writeComma);
+
+            csvWriter.WriteInt32(
+                static_cast<int32_t>(record.NumberOfInliers),
+                &writeComma);
+
+            csvWriter.EndLine();
+
+            if (!record.Stepped)
+            {
+                maximumCorrectionInMicroseconds =
+                    std::max(maximumCorrectionInMicroseconds, std::abs(record.CorrectionTicks / 10.0));
+            }
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        if (!records.empty())
+        {
+            DBG_LOG(
+                "SensorFrameRecorder",
+                dbg::LogLevel::Information,
+                L"SensorFrameRecorder::ReportClockSynchronizationInformation: %zu updates, drift %.3f ppm, maximum correction %.1f us",
+                records.size(),
+                records.back().DriftPartsPerMillion,
+                maximumCorrectionInMicroseconds);
+        }
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+    }
+
+    void SensorFrameRecorder::GetCameraProjectionModel(
+        _In_ SensorFrameRecorderSink^ sensorFrameSink,
+        _In_ CameraIntrinsics^ cameraIntrinsics,
+        _Out_ CameraProjectionModel& cameraProjectionModel)
+    {
+        const CameraProjectionModel::ImagePointMapper mapper =
+            [cameraIntrinsics](float u, float v, float* x, float* y)
+        {
+            Windows::Foundation::Point uv = { u, v }, xy;
+
+            if (!cameraIntrinsics->MapImagePointToCameraUnitPlane(uv, &xy))
+            {
+                return false;
+            }
+
+            *x = xy.X;
+            *y = xy.Y;
+
+            return true;
+        };
+
+        //
+        // Fitting the model only requires a sparse set of samples, but it is still cached
+        // per device (in the application's local folder) and re-validated with a handful
+        // of fresh samples on subsequent recordings.
+        //
+        wchar_t cacheFileName[MAX_PATH] = {};
+
+        swprintf_s(
+            cacheFileName,
+            L"%s\\%s_camera_projection_model_%ux%u.bin",
+            Windows::Storage::ApplicationData::Current->LocalFolder->Path->Data(),
+            sensorFrameSink->GetSensorName()->Data(),
+            cameraIntrinsics->ImageWidth,
+            cameraIntrinsics->ImageHeight);
+
+        {
+            std::ifstream cacheFile(
+                cacheFileName,
+                std::ios::in | std::ios::binary);
+
+            if (cacheFile &&
+                cameraProjectionModel.Load(cacheFile) &&
+                cameraProjectionModel.GetImageWidth() == cameraIntrinsics->ImageWidth &&
+                cameraProjectionModel.GetImageHeight() == cameraIntrinsics->ImageHeight &&
+                cameraProjectionModel.Verify(mapper))
+            {
+                return;
+            }
+        }
+
+        cameraProjectionModel.Fit(
+            cameraIntrinsics->ImageWidth,
+            cameraIntrinsics->ImageHeight,
+            mapper);
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "SensorFrameRecorder",
+            dbg::LogLevel::Information,
+            L"SensorFrameRecorder::GetCameraProjectionModel: %s: degree %u, within tolerance: %i, max error %f, rms error %f (%u samples)",
+            sensorFrameSink->GetSensorName()->Data(),
+            cameraProjectionModel.GetDegree(),
+            cameraProjectionModel.IsWithinTolerance() ? 1 : 0,
+            cameraProjectionModel.GetFitErrorStatistics().MaximumError,
+            cameraProjectionModel.GetFitErrorStatistics().RootMeanSquareError,
+            cameraProjectionModel.GetFitErrorStatistics().NumberOfValidSamples);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        std::ofstream cacheFile(
+            cacheFileName,
+            std::ios::out | std::ios::binary);
+
+        cameraProjectionModel.Save(
+            cacheFile);
     }
 
     ISensorFrameSink^ SensorFrameRecorder::GetSensorFrameSink(
@@ -296,39 +510,7 @@ namespace HoloLensForCV
     const wchar_t* SensorFrameRecorder::GetSensorName(
         SensorType sensorType)
     {
-        switch (sensorType)
-        {
-        case SensorType::PhotoVideo:
-            return L"pv";
-
-#if ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS
-        case SensorType::ShortThrowToFDepth:
-            return L"short_throw_depth";
-
-        case SensorType::ShortThrowToFReflectivity:
-            return L"short_throw_reflectivity";
-
-        case SensorType::LongThrowToFDepth:
-            return L"long_throw_depth";
-
-        case SensorType::LongThrowToFReflectivity:
-            return L"long_throw_reflectivity";
-
-        case SensorType::VisibleLightLeftLeft:
-            return L"vlc_ll";
-
-        case SensorType::VisibleLightLeftFront:
-            return L"vlc_lf";
-
-        case SensorType::VisibleLightRightFront:
-            return L"vlc_rf";
-
-        case SensorType::VisibleLightRightRight:
-            return L"vlc_rr";
-#endif /* ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS */
-
-        default:
-            throw std::logic_error("unexpected sensor type");
-        }
+        return GetSensorTypeName(
+            sensorType);
     }
 }
@@ -36,6 +36,15 @@ namespace HoloLensForCV
             uint8_t get() { return 0x01; }
         }
 
+        //
+        // When set, the dense per-pixel '<sensor>_camera_space_projection.bin' tables are
+        // written next to the compact '<sensor>_camera_projection_model.bin' files, for
+        // the benefit of tools that have not been updated to read the latter. The tables
+        // are queried from the intrinsics for every pixel, as they always were. Off by
+        // default.
+        //
+        property bool WriteDenseCameraSpaceProjection;
+
         void EnableAll();
 
         void Enable(
@@ -60,11 +69,22 @@ namespace HoloLensForCV
         void ReportCameraCalibrationInformation(
             _Inout_ std::vector<std::wstring>& sourceFiles);
 
+        void ReportClockSynchronizationInformation(
+            _Inout_ std::vector<std::wstring>& sourceFiles);
+
+        void GetCameraProjectionModel(
+            _In_ SensorFrameRecorderSink^ sensorFrameSink,
+            _In_ CameraIntrinsics^ cameraIntrinsics,
+            _Out_ CameraProjectionModel& cameraProjectionModel);
+
     private:
         std::mutex _recorderMutex;
 
         Windows::Storage::StorageFolder^ _archiveSourceFolder;
 
+        // The last clock synchronization update before the recording started.
+        uint64_t _clockSynchronizationUpdateIndex;
+
         std::array<SensorFrameRecorderSink^, (size_t)SensorType::NumberOfSensorTypes> _sensorFrameSinks;
     };
 }
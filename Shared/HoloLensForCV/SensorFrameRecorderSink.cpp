@@ -13,11 +13,53 @@
 
 namespace HoloLensForCV
 {
+	namespace
+	{
+		//
+		// Counts the frames waiting for the sink's lock or being written: the sink writes
+		// synchronously, so these are the frames queued up on the calling threads.
+		//
+		class PendingFrameGuard
+		{
+		public:
+			explicit PendingFrameGuard(
+				_Inout_ dbg::MetricGauge& pendingFrames)
+				: _pendingFrames(pendingFrames)
+			{
+				_pendingFrames.Add(1);
+			}
+
+			~PendingFrameGuard()
+			{
+				_pendingFrames.Add(-1);
+			}
+
+		private:
+			dbg::MetricGauge& _pendingFrames;
+		};
+	}
+
 	SensorFrameRecorderSink::SensorFrameRecorderSink(
 		_In_ SensorType sensorType,
 		_In_ Platform::String^ sensorName)
 		: _sensorType(sensorType), _sensorName(sensorName)
+		, _latencyBreakdown("recorder")
 	{
+		_framesRecorded =
+			&dbg::Metrics::GetCounter(
+				dbg::MakeMetricName("hololensforcv_recorder_frames_recorded_total", "sensor", _sensorName->Data()));
+
+		_bytesRecorded =
+			&dbg::Metrics::GetCounter(
+				dbg::MakeMetricName("hololensforcv_recorder_bytes_recorded_total", "sensor", _sensorName->Data()));
+
+		_pendingFrames =
+			&dbg::Metrics::GetGauge(
+				dbg::MakeMetricName("hololensforcv_recorder_pending_frames", "sensor", _sensorName->Data()));
+
+		_writeTime =
+			&dbg::Metrics::GetHistogram(
+				dbg::MakeMetricName("hololensforcv_recorder_write_time_microseconds", "sensor", _sensorName->Data()));
 	}
 
 	SensorFrameRecorderSink::~SensorFrameRecorderSink()
@@ -56,7 +98,7 @@ namespace HoloLensForCV
 				L"%s\\%s.csv",
 				_archiveSourceFolder->Path->Data(),
 				_sensorName->Data());
-			_csvWriter.reset(new CsvWriter(fileName));
+			_csvWriter.reset(new Io::CsvWriter(fileName));
 		}
 
 		// Write header information to csv file.
@@ -120,12 +162,21 @@ namespace HoloLensForCV
 	void SensorFrameRecorderSink::Send(
 		SensorFrame^ sensorFrame)
 	{
-		dbg::TimerGuard timerGuard(
-			L"SensorFrameRecorderSink::Send: synchrounous I/O",
+		DBG_PROFILE_SPAN_REPORT_OVER(
+			"SensorFrameRecorderSink::Send: synchrounous I/O",
 			20.0 /* minimum_time_elapsed_in_milliseconds */);
 
+		PendingFrameGuard pendingFrameGuard(
+			*_pendingFrames);
+
 		std::lock_guard<std::mutex> lockGuard(_sinkMutex);
 
+		SensorFrameTrace trace =
+			sensorFrame->GetTrace();
+
+		trace.Mark(
+			SensorFrameStage::SinkDequeue);
+
 		if (nullptr == _archiveSourceFolder)
 		{
 			return;
@@ -144,12 +195,17 @@ namespace HoloLensForCV
 
 		_prevFrameTimestamp = sensorFrame->Timestamp;
 
+		const int64_t writeBeginTicks =
+			dbg::Timer::GetCurrentTicks();
+
 		//
 		// Write the sensor frame as a bitmap to the archive.
 		//
 
 #if DBG_ENABLE_VERBOSE_LOGGING
-		dbg::trace(
+		DBG_LOG(
+			"SensorFrameRecorderSink",
+			dbg::LogLevel::Verbose,
 			L"SensorFrameRecorderSink::Send: saving sensor frame to %s",
 			bitmapPath);
 #endif /* DBG_ENABLE_VERBOSE_LOGGING */
@@ -196,7 +252,9 @@ namespace HoloLensForCV
 		default:
 			// Unsupported by PGM format. Need to update save logic
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-			dbg::trace(
+			DBG_LOG(
+				"SensorFrameRecorderSink",
+				dbg::LogLevel::Information,
 				L"SensorFrameRecorderSink::Send: unsupported bitmap pixel format for PGM");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -234,6 +292,9 @@ namespace HoloLensForCV
 			<< maxBitmapValue << "\n";
 		const std::string headerString = header.str();
 
+		trace.Mark(
+			SensorFrameStage::EncodeStart);
+
 		// Get bitmap buffer object of the frame.
 		Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
 			softwareBitmap->LockBuffer(
@@ -284,8 +345,34 @@ namespace HoloLensForCV
                 pixelBufferData, pixelBufferData + pixelBufferDataLength);
         }
 
+		trace.Mark(
+			SensorFrameStage::EncodeEnd);
+
 		// Add the bitmap to the tarball.
 		_bitmapTarball->AddFile(bitmapPath, bitmapData.data(), bitmapData.size());
+		_bytesRecorded->Increment(bitmapData.size());
+
+		//
+		// Store the frame's features, if any, next to the bitmap, so that offline
+		// processing does not have to extract them again.
+		//
+		if (nullptr != sensorFrame->Features)
+		{
+			wchar_t featuresPath[MAX_PATH];
+			swprintf_s(
+				featuresPath, L"%s\\%020llu.orb",
+				_sensorName->Data(),
+				sensorFrame->Timestamp.UniversalTime);
+
+			std::vector<uint8_t> featuresData;
+
+			SerializeImageFeatures(
+				sensorFrame->Features->GetImageFeatures(),
+				featuresData);
+
+			_bitmapTarball->AddFile(featuresPath, featuresData.data(), featuresData.size());
+			_bytesRecorded->Increment(featuresData.size());
+		}
 
 		//
 		// Record the sensor frame meta data to the csv file.
@@ -311,5 +398,18 @@ namespace HoloLensForCV
 			sensorFrame->CameraProjectionTransform, &writeComma);
 
 		_csvWriter->EndLine();
+
+		trace.Mark(
+			SensorFrameStage::WriteComplete);
+
+		_latencyBreakdown.Record(
+			_sensorType,
+			trace);
+
+		_framesRecorded->Increment();
+
+		_writeTime->Record(
+			static_cast<uint64_t>(
+				(dbg::Timer::GetCurrentTicks() - writeBeginTicks) * 1000.0 / dbg::Timer::GetTicksPerMillisecond()));
 	}
 }
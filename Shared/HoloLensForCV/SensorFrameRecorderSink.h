@@ -54,10 +54,17 @@ namespace HoloLensForCV
 		Windows::Storage::StorageFolder^ _archiveSourceFolder;
 
 		std::unique_ptr<Io::Tarball> _bitmapTarball;
-		std::unique_ptr<CsvWriter> _csvWriter;
+		std::unique_ptr<Io::CsvWriter> _csvWriter;
 
 		CameraIntrinsics^ _cameraIntrinsics;
 
 		Windows::Foundation::DateTime _prevFrameTimestamp;
+
+		dbg::MetricCounter* _framesRecorded;
+		dbg::MetricCounter* _bytesRecorded;
+		dbg::MetricGauge* _pendingFrames;
+		dbg::LatencyHistogram* _writeTime;
+
+		SensorFrameLatencyBreakdown _latencyBreakdown;
 	};
 }
@@ -59,5 +59,20 @@ namespace HoloLensForCV
         dataWriter->WriteUInt32(header->ImageHeight);
         dataWriter->WriteUInt32(header->PixelStride);
         dataWriter->WriteUInt32(header->RowStride);
+
+        if (header->HasFrameTrace())
+        {
+            header->FrameTrace.Serialize(
+                dataWriter);
+        }
+    }
+
+    /* static */ void SensorFrameStreamHeader::ReadFrameTrace(
+        _Inout_ Windows::Storage::Streams::DataReader^ dataReader,
+        _Inout_ SensorFrameStreamHeader^ header)
+    {
+        header->FrameTrace =
+            SensorFrameTrace::Deserialize(
+                dataReader);
     }
 }
@@ -49,6 +49,21 @@ namespace HoloLensForCV
             uint8_t get() { return 0x01; }
         }
 
+        //
+        // Headers of this minor version are followed by the trace of the frame (see
+        // SensorFrameTrace) up to the time it was encoded, FrameTraceLength bytes long.
+        // Receivers accept both versions; servers only send it when asked to.
+        //
+        static property uint8_t ProtocolVersionMinorWithFrameTrace
+        {
+            uint8_t get() { return 0x02; }
+        }
+
+        static property uint32_t FrameTraceLength
+        {
+            uint32_t get() { return SensorFrameTrace::SerializedLength; }
+        }
+
         property uint32_t Cookie;
         property uint8_t VersionMajor;
         property uint8_t VersionMinor;
@@ -66,5 +81,24 @@ namespace HoloLensForCV
         static void Write(
             _In_ SensorFrameStreamHeader^ header,
             _Inout_ Windows::Storage::Streams::DataWriter^ dataWriter);
+
+    internal:
+        bool HasFrameTrace()
+        {
+            return ProtocolVersionMinorWithFrameTrace == VersionMinor;
+        }
+
+        //
+        // Reads the frame trace following the header into FrameTrace; expects
+        // FrameTraceLength bytes to have been loaded.
+        //
+        static void ReadFrameTrace(
+            _Inout_ Windows::Storage::Streams::DataReader^ dataReader,
+            _Inout_ SensorFrameStreamHeader^ header);
+
+        //
+        // Written after the header if HasFrameTrace().
+        //
+        SensorFrameTrace FrameTrace;
     };
 }
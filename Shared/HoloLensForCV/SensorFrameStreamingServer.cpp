@@ -16,7 +16,11 @@ namespace HoloLensForCV
     SensorFrameStreamingServer::SensorFrameStreamingServer(
         _In_ Platform::String^ serviceName)
         : _writeInProgress(false)
+        , _metrics("hololensforcv_sensor_frame_streaming", serviceName)
+        , _latencyBreakdown("sensor_frame_streaming")
     {
+        AppendFrameTrace = false;
+
         _listener = ref new Windows::Networking::Sockets::StreamSocketListener();
 
         _listener->ConnectionReceived +=
@@ -40,7 +44,9 @@ namespace HoloLensForCV
             catch (Platform::Exception^ exception)
             {
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameStreamingServer",
+                    dbg::LogLevel::Error,
                     L"SensorFrameStreamingServer::SensorFrameStreamingServer: %s",
                     exception->Message->Data());
 #endif /* DBG_ENABLE_ERROR_LOGGING */
@@ -78,7 +84,9 @@ namespace HoloLensForCV
         if (nullptr == _socket)
         {
 #if DBG_ENABLE_VERBOSE_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "SensorFrameStreamingServer",
+                dbg::LogLevel::Verbose,
                 L"SensorFrameStreamingServer::Consume: image dropped -- no connection!");
 #endif /* DBG_ENABLE_VERBOSE_LOGGING */
 
@@ -87,14 +95,25 @@ namespace HoloLensForCV
 
         if (_writeInProgress)
         {
+            _metrics.OnFrameDropped();
+
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG_RATE_LIMITED(
+                "SensorFrameStreamingServer",
+                dbg::LogLevel::Information,
+                1000.0 /* minimum_interval_in_milliseconds */,
                 L"SensorFrameStreamingServer::Send: image dropped -- previous send operation is in progress!");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
             return;
         }
 
+        SensorFrameTrace trace =
+            sensorFrame->GetTrace();
+
+        trace.Mark(
+            SensorFrameStage::SinkDequeue);
+
         Windows::Graphics::Imaging::SoftwareBitmap^ bitmap;
         Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer;
         Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference;
@@ -108,11 +127,12 @@ namespace HoloLensForCV
         int32_t imageBufferSize = 0;
 
         {
-#if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::TimerGuard timerGuard(
-                L"SensorFrameStreamingServer::Send: buffer preparation",
+            DBG_PROFILE_SPAN_REPORT_OVER(
+                "SensorFrameStreamingServer::Send: buffer preparation",
                 4.0 /* minimum_time_elapsed_in_milliseconds */);
-#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+            trace.Mark(
+                SensorFrameStage::EncodeStart);
 
             bitmap =
                 sensorFrame->SoftwareBitmap;
@@ -150,7 +170,9 @@ namespace HoloLensForCV
 
             default:
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameStreamingServer",
+                    dbg::LogLevel::Information,
                     L"SensorFrameStreamingServer::Send: unrecognized bitmap pixel format, assuming 1 byte per pixel");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -170,6 +192,9 @@ namespace HoloLensForCV
                 ref new Platform::Array<uint8_t>(
                     bitmapBufferData,
                     imageBufferSize);
+
+            trace.Mark(
+                SensorFrameStage::EncodeEnd);
         }
 
         SensorFrameStreamHeader^ header =
@@ -181,6 +206,13 @@ namespace HoloLensForCV
         header->ImageHeight = imageHeight;
         header->PixelStride = pixelStride;
         header->RowStride = rowStride;
+        header->FrameTrace = trace;
+
+        if (AppendFrameTrace)
+        {
+            header->VersionMinor =
+                SensorFrameStreamHeader::ProtocolVersionMinorWithFrameTrace;
+        }
 
         SendImage(
             header,
@@ -194,7 +226,9 @@ namespace HoloLensForCV
         if (nullptr == _socket)
         {
 #if DBG_ENABLE_VERBOSE_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "SensorFrameStreamingServer",
+                dbg::LogLevel::Verbose,
                 L"SensorFrameStreamingServer::SendImage: image dropped -- no connection!");
 #endif /* DBG_ENABLE_VERBOSE_LOGGING */
 
@@ -203,8 +237,13 @@ namespace HoloLensForCV
 
         if (_writeInProgress)
         {
+            _metrics.OnFrameDropped();
+
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG_RATE_LIMITED(
+                "SensorFrameStreamingServer",
+                dbg::LogLevel::Information,
+                1000.0 /* minimum_interval_in_milliseconds */,
                 L"SensorFrameStreamingServer::SendImage: image dropped -- previous StoreAsync task is still in progress!");
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
@@ -214,11 +253,9 @@ namespace HoloLensForCV
         _writeInProgress = true;
 
         {
-#if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::TimerGuard timerGuard(
-                L"SensorFrameStreamingServer::SendImage: writer operations",
+            DBG_PROFILE_SPAN_REPORT_OVER(
+                "SensorFrameStreamingServer::SendImage: writer operations",
                 4.0 /* minimum_time_elapsed_in_milliseconds */);
-#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
 
             SensorFrameStreamHeader::Write(
                 header,
@@ -228,26 +265,68 @@ namespace HoloLensForCV
                 data);
         }
 
-#if DBG_ENABLE_INFORMATIONAL_LOGGING
-        dbg::TimerGuard timerGuard(
-            L"SensorFrameStreamingServer::SendImage: StoreAsync task creation",
+        DBG_PROFILE_SPAN_REPORT_OVER(
+            "SensorFrameStreamingServer::SendImage: StoreAsync task creation",
             10.0 /* minimum_time_elapsed_in_milliseconds */);
-#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        //
+        // The store completes on a thread pool thread; its span is recorded there, from
+        // the time the store was started.
+        //
+        const int64_t storeBeginTicks =
+            dbg::Timer::GetCurrentTicks();
+
+        Windows::Foundation::DateTime timestamp;
+
+        timestamp.UniversalTime =
+            header->Timestamp;
+
+        const SensorType frameType =
+            header->FrameType;
+
+        const SensorFrameTrace trace =
+            header->FrameTrace;
 
         Concurrency::create_task(_writer->StoreAsync()).then(
-            [&](Concurrency::task<unsigned int> writeTask)
+            [&, storeBeginTicks, timestamp, frameType, trace](Concurrency::task<unsigned int> writeTask)
         {
+            if (dbg::Profiler::IsEnabled())
+            {
+                dbg::Profiler::RecordSpan(
+                    "SensorFrameStreamingServer::SendImage: StoreAsync",
+                    storeBeginTicks,
+                    dbg::Timer::GetCurrentTicks(),
+                    0 /* depth */);
+            }
+
             try
             {
                 // Try getting an exception.
-                writeTask.get();
+                const unsigned int numberOfBytesStored =
+                    writeTask.get();
+
+                _metrics.OnFrameSent(
+                    timestamp,
+                    numberOfBytesStored);
+
+                SensorFrameTrace sentTrace =
+                    trace;
+
+                sentTrace.Mark(
+                    SensorFrameStage::SendComplete);
+
+                _latencyBreakdown.Record(
+                    frameType,
+                    sentTrace);
 
                 _writeInProgress = false;
             }
             catch (Platform::Exception^ exception)
             {
 #if DBG_ENABLE_ERROR_LOGGING
-                dbg::trace(
+                DBG_LOG(
+                    "SensorFrameStreamingServer",
+                    dbg::LogLevel::Error,
                     L"SensorFrameStreamingServer::SendImage: StoreAsync call failed with error: %s",
                     exception->Message->Data());
 #endif /* DBG_ENABLE_ERROR_LOGGING */
@@ -23,6 +23,13 @@ namespace HoloLensForCV
         virtual void Send(
             SensorFrame^ sensorFrame);
 
+        //
+        // Whether to send the trace of each frame (see SensorFrameTrace) after its header,
+        // using SensorFrameStreamHeader::ProtocolVersionMinorWithFrameTrace. Off by default
+        // for the sake of clients that only understand the original protocol.
+        //
+        property bool AppendFrameTrace;
+
     private:
         ~SensorFrameStreamingServer();
 
@@ -39,5 +46,8 @@ namespace HoloLensForCV
         Windows::Networking::Sockets::StreamSocket^ _socket;
         Windows::Storage::Streams::DataWriter^ _writer;
         bool _writeInProgress;
+
+        StreamingServerMetrics _metrics;
+        SensorFrameLatencyBreakdown _latencyBreakdown;
     };
 }
@@ -0,0 +1,298 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        uint32_t GetStageIndex(
+            _In_ const SensorFrameStage stage)
+        {
+            const uint32_t stageIndex =
+                static_cast<uint32_t>(stage);
+
+            REQUIRES(stageIndex < SensorFrameTrace::NumberOfStages);
+
+            return stageIndex;
+        }
+    }
+
+    SensorFrameTrace::SensorFrameTrace()
+    {
+        _ticks.fill(0);
+    }
+
+    void SensorFrameTrace::Mark(
+        _In_ const SensorFrameStage stage)
+    {
+        _ticks[GetStageIndex(stage)] =
+            GetCurrentTicks();
+    }
+
+    void SensorFrameTrace::Set(
+        _In_ const SensorFrameStage stage,
+        _In_ const int64_t ticks)
+    {
+        _ticks[GetStageIndex(stage)] =
+            ticks;
+    }
+
+    int64_t SensorFrameTrace::Get(
+        _In_ const SensorFrameStage stage) const
+    {
+        return _ticks[GetStageIndex(stage)];
+    }
+
+    bool SensorFrameTrace::HasReached(
+        _In_ const SensorFrameStage stage) const
+    {
+        return 0 != Get(stage);
+    }
+
+    void SensorFrameTrace::Serialize(
+        _Inout_ Windows::Storage::Streams::DataWriter^ dataWriter) const
+    {
+        const int64_t exposureTicks =
+            _ticks[0];
+
+        dataWriter->WriteUInt32(
+            NumberOfStages - 1);
+
+        for (uint32_t stageIndex = 1; stageIndex < NumberOfStages; ++stageIndex)
+        {
+            uint32_t microsecondsSinceExposure =
+                NotReachedInMicroseconds;
+
+            if (0 != exposureTicks &&
+                0 != _ticks[stageIndex] &&
+                _ticks[stageIndex] >= exposureTicks)
+            {
+                microsecondsSinceExposure =
+                    static_cast<uint32_t>(
+                        std::min<int64_t>(
+                            (_ticks[stageIndex] - exposureTicks) / 10,
+                            NotReachedInMicroseconds - 1));
+            }
+
+            dataWriter->WriteUInt32(
+                microsecondsSinceExposure);
+        }
+    }
+
+    /* static */ SensorFrameTrace SensorFrameTrace::Deserialize(
+        _Inout_ Windows::Storage::Streams::DataReader^ dataReader)
+    {
+        SensorFrameTrace trace;
+
+        const uint32_t numberOfStages =
+            dataReader->ReadUInt32();
+
+        //
+        // The exposure time is not part of the serialized trace: the times of the other
+        // stages are kept relative to it, and it is set to 1 so that they are defined.
+        //
+        trace._ticks[0] = 1;
+
+        for (uint32_t stageIndex = 1; stageIndex <= numberOfStages; ++stageIndex)
+        {
+            const uint32_t microsecondsSinceExposure =
+                dataReader->ReadUInt32();
+
+            if (stageIndex < NumberOfStages &&
+                NotReachedInMicroseconds != microsecondsSinceExposure)
+            {
+                trace._ticks[stageIndex] =
+                    1 + static_cast<int64_t>(microsecondsSinceExposure) * 10;
+            }
+        }
+
+        return trace;
+    }
+
+    /* static */ int64_t SensorFrameTrace::GetCurrentTicks()
+    {
+        static const Io::TimeConverter c_timeConverter;
+
+        LARGE_INTEGER qpc;
+
+        QueryPerformanceCounter(
+            &qpc);
+
+        return c_timeConverter.QpcToRelativeTicks(
+            qpc).count();
+    }
+
+    /* static */ const char* SensorFrameTrace::GetStageName(
+        _In_ const SensorFrameStage stage)
+    {
+        switch (stage)
+        {
+        case SensorFrameStage::Exposure:
+            return "Exposure";
+
+        case SensorFrameStage::Arrival:
+            return "Arrival";
+
+        case SensorFrameStage::SinkDequeue:
+            return "SinkDequeue";
+
+        case SensorFrameStage::EncodeStart:
+            return "EncodeStart";
+
+        case SensorFrameStage::EncodeEnd:
+            return "EncodeEnd";
+
+        case SensorFrameStage::SendComplete:
+            return "SendComplete";
+
+        case SensorFrameStage::WriteComplete:
+            return "WriteComplete";
+
+        default:
+            return "Unknown";
+        }
+    }
+
+    SensorFrameLatencyBreakdown::SensorFrameLatencyBreakdown(
+        _In_z_ const char* sinkName)
+        : _sinkName(sinkName)
+    {
+        for (std::atomic<SensorHistograms*>& sensor : _sensors)
+        {
+            sensor.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    SensorFrameLatencyBreakdown::~SensorFrameLatencyBreakdown()
+    {
+        //
+        // The histograms themselves belong to the metrics registry.
+        //
+        for (std::atomic<SensorHistograms*>& sensor : _sensors)
+        {
+            delete sensor.load(std::memory_order_relaxed);
+        }
+    }
+
+    void SensorFrameLatencyBreakdown::Record(
+        _In_ const SensorType sensorType,
+        _In_ const SensorFrameTrace& trace)
+    {
+        SensorHistograms* const histograms =
+            GetSensorHistograms(
+                sensorType);
+
+        if (nullptr == histograms)
+        {
+            return;
+        }
+
+        //
+        // Attribute the time between consecutive stages reached to the later one; sinks
+        // skip the stages that do not apply to them.
+        //
+        int64_t previousTicks = 0;
+
+        for (uint32_t stageIndex = 0; stageIndex < SensorFrameTrace::NumberOfStages; ++stageIndex)
+        {
+            const int64_t ticks =
+                trace.Get(static_cast<SensorFrameStage>(stageIndex));
+
+            if (0 == ticks)
+            {
+                continue;
+            }
+
+            if (0 != previousTicks && ticks >= previousTicks)
+            {
+                histograms->StageLatencies[stageIndex]->Record(
+                    static_cast<uint64_t>(ticks - previousTicks) / 10);
+            }
+
+            previousTicks = ticks;
+        }
+
+        //
+        // Frames that were played back or generated have no exposure time.
+        //
+        const int64_t exposureTicks =
+            trace.Get(SensorFrameStage::Exposure);
+
+        if (0 != exposureTicks && previousTicks >= exposureTicks)
+        {
+            histograms->TotalLatency->Record(
+                static_cast<uint64_t>(previousTicks - exposureTicks) / 10);
+        }
+    }
+
+    SensorFrameLatencyBreakdown::SensorHistograms* SensorFrameLatencyBreakdown::GetSensorHistograms(
+        _In_ const SensorType sensorType)
+    {
+        const int32_t sensorIndex =
+            static_cast<int32_t>(sensorType);
+
+        if (sensorIndex < 0 || sensorIndex >= static_cast<int32_t>(_sensors.size()))
+        {
+            return nullptr;
+        }
+
+        SensorHistograms* histograms =
+            _sensors[sensorIndex].load(std::memory_order_acquire);
+
+        if (nullptr != histograms)
+        {
+            return histograms;
+        }
+
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        histograms =
+            _sensors[sensorIndex].load(std::memory_order_relaxed);
+
+        if (nullptr != histograms)
+        {
+            return histograms;
+        }
+
+        const std::wstring wideSensorName(
+            sensorType.ToString()->Data());
+
+        const std::string labels =
+            "sink=\"" + _sinkName + "\",sensor=\"" + std::string(wideSensorName.begin(), wideSensorName.end()) + "\"";
+
+        histograms = new SensorHistograms();
+
+        //
+        // Nothing precedes the exposure.
+        //
+        histograms->StageLatencies[0] = nullptr;
+
+        for (uint32_t stageIndex = 1; stageIndex < SensorFrameTrace::NumberOfStages; ++stageIndex)
+        {
+            histograms->StageLatencies[stageIndex] =
+                &dbg::Metrics::GetHistogram(
+                    "hololensforcv_frame_stage_latency_microseconds{" + labels + ",stage=\"" +
+                    SensorFrameTrace::GetStageName(static_cast<SensorFrameStage>(stageIndex)) + "\"}");
+        }
+
+        histograms->TotalLatency =
+            &dbg::Metrics::GetHistogram(
+                "hololensforcv_frame_total_latency_microseconds{" + labels + "}");
+
+        _sensors[sensorIndex].store(
+            histograms,
+            std::memory_order_release);
+
+        return histograms;
+    }
+}
@@ -0,0 +1,142 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // The points a sensor frame goes through on its way from the camera to the network
+    // or the disk, in order.
+    //
+    enum class SensorFrameStage : uint32_t
+    {
+        // Exposure of the frame, as reported by the media frame reader.
+        Exposure,
+
+        // The MediaFrameReaderContext received the frame.
+        Arrival,
+
+        // A sink started processing the frame, e.g. after waiting for its lock.
+        SinkDequeue,
+
+        // The sink started and finished converting the frame to its output format.
+        EncodeStart,
+        EncodeEnd,
+
+        // The frame was handed to the network stack (DataWriter::StoreAsync completed).
+        SendComplete,
+
+        // The frame was written to the recording.
+        WriteComplete,
+
+        NumberOfStages
+    };
+
+    //
+    // The times at which a sensor frame reached each stage, in hundreds of nanoseconds
+    // since boot (the time base of MediaFrameReference::SystemRelativeTime). The frame's
+    // own trace ends at Arrival; each sink copies it and marks the stages it goes through.
+    //
+    class SensorFrameTrace
+    {
+    public:
+        static const uint32_t NumberOfStages =
+            static_cast<uint32_t>(SensorFrameStage::NumberOfStages);
+
+        //
+        // Length of a trace in the sensor frame stream: the number of stages after the
+        // exposure, followed by the time from the exposure to each of them in
+        // microseconds, or NotReachedInMicroseconds.
+        //
+        static const uint32_t SerializedLength =
+            sizeof(uint32_t) + (NumberOfStages - 1) * sizeof(uint32_t);
+
+        static const uint32_t NotReachedInMicroseconds = 0xffffffff;
+
+        SensorFrameTrace();
+
+        //
+        // Records that the given stage was reached now.
+        //
+        void Mark(
+            _In_ const SensorFrameStage stage);
+
+        void Set(
+            _In_ const SensorFrameStage stage,
+            _In_ const int64_t ticks);
+
+        //
+        // Returns the time at which the stage was reached, or zero if it was not.
+        //
+        int64_t Get(
+            _In_ const SensorFrameStage stage) const;
+
+        bool HasReached(
+            _In_ const SensorFrameStage stage) const;
+
+        void Serialize(
+            _Inout_ Windows::Storage::Streams::DataWriter^ dataWriter) const;
+
+        static SensorFrameTrace Deserialize(
+            _Inout_ Windows::Storage::Streams::DataReader^ dataReader);
+
+        static int64_t GetCurrentTicks();
+
+        static const char* GetStageName(
+            _In_ const SensorFrameStage stage);
+
+    private:
+        std::array<int64_t, NumberOfStages> _ticks;
+    };
+
+    //
+    // Aggregates the traces of the frames that went through a sink into per-sensor
+    // histograms (see dbg::Metrics) of the time spent before each stage, e.g.
+    //
+    //   hololensforcv_frame_stage_latency_microseconds{sink="recorder",sensor="PhotoVideo",stage="EncodeEnd"}
+    //
+    // is the time the recorder spent encoding photo video frames, and
+    //
+    //   hololensforcv_frame_total_latency_microseconds{sink="recorder",sensor="PhotoVideo"}
+    //
+    // the time from exposure to the last stage reached.
+    //
+    class SensorFrameLatencyBreakdown
+    {
+    public:
+        explicit SensorFrameLatencyBreakdown(
+            _In_z_ const char* sinkName);
+
+        ~SensorFrameLatencyBreakdown();
+
+        void Record(
+            _In_ const SensorType sensorType,
+            _In_ const SensorFrameTrace& trace);
+
+    private:
+        struct SensorHistograms
+        {
+            std::array<dbg::LatencyHistogram*, SensorFrameTrace::NumberOfStages> StageLatencies;
+            dbg::LatencyHistogram* TotalLatency;
+        };
+
+        SensorHistograms* GetSensorHistograms(
+            _In_ const SensorType sensorType);
+
+    private:
+        const std::string _sinkName;
+
+        std::mutex _mutex;
+
+        std::array<std::atomic<SensorHistograms*>, static_cast<size_t>(SensorType::NumberOfSensorTypes)> _sensors;
+    };
+}
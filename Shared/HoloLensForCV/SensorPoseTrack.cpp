@@ -0,0 +1,262 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Quaternions are stored as (w, x, y, z).
+        //
+        cv::Vec4d RotationToQuaternion(
+            _In_ const cv::Matx44f& m)
+        {
+            const double trace = m(0, 0) + m(1, 1) + m(2, 2);
+
+            cv::Vec4d q;
+
+            if (trace > 0.0)
+            {
+                const double s = 0.5 / std::sqrt(trace + 1.0);
+
+                q = cv::Vec4d(
+                    0.25 / s,
+                    (m(2, 1) - m(1, 2)) * s,
+                    (m(0, 2) - m(2, 0)) * s,
+                    (m(1, 0) - m(0, 1)) * s);
+            }
+            else if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2))
+            {
+                const double s = 2.0 * std::sqrt(1.0 + m(0, 0) - m(1, 1) - m(2, 2));
+
+                q = cv::Vec4d(
+                    (m(2, 1) - m(1, 2)) / s,
+                    0.25 * s,
+                    (m(0, 1) + m(1, 0)) / s,
+                    (m(0, 2) + m(2, 0)) / s);
+            }
+            else if (m(1, 1) > m(2, 2))
+            {
+                const double s = 2.0 * std::sqrt(1.0 + m(1, 1) - m(0, 0) - m(2, 2));
+
+                q = cv::Vec4d(
+                    (m(0, 2) - m(2, 0)) / s,
+                    (m(0, 1) + m(1, 0)) / s,
+                    0.25 * s,
+                    (m(1, 2) + m(2, 1)) / s);
+            }
+            else
+            {
+                const double s = 2.0 * std::sqrt(1.0 + m(2, 2) - m(0, 0) - m(1, 1));
+
+                q = cv::Vec4d(
+                    (m(1, 0) - m(0, 1)) / s,
+                    (m(0, 2) + m(2, 0)) / s,
+                    (m(1, 2) + m(2, 1)) / s,
+                    0.25 * s);
+            }
+
+            return q * (1.0 / cv::norm(q));
+        }
+
+        void QuaternionToRotation(
+            _In_ const cv::Vec4d& q,
+            _Inout_ cv::Matx44f& m)
+        {
+            const double w = q[0], x = q[1], y = q[2], z = q[3];
+
+            m(0, 0) = static_cast<float>(1.0 - 2.0 * (y * y + z * z));
+            m(0, 1) = static_cast<float>(2.0 * (x * y - z * w));
+            m(0, 2) = static_cast<float>(2.0 * (x * z + y * w));
+
+            m(1, 0) = static_cast<float>(2.0 * (x * y + z * w));
+            m(1, 1) = static_cast<float>(1.0 - 2.0 * (x * x + z * z));
+            m(1, 2) = static_cast<float>(2.0 * (y * z - x * w));
+
+            m(2, 0) = static_cast<float>(2.0 * (x * z - y * w));
+            m(2, 1) = static_cast<float>(2.0 * (y * z + x * w));
+            m(2, 2) = static_cast<float>(1.0 - 2.0 * (x * x + y * y));
+        }
+
+        bool CompareTimestamps(
+            _In_ const std::pair<uint64_t, cv::Matx44f>& pose,
+            _In_ uint64_t timestamp)
+        {
+            return pose.first < timestamp;
+        }
+    }
+
+    void SensorPoseTrack::Add(
+        _In_ uint64_t timestamp,
+        _In_ const cv::Matx44f& cameraToWorld)
+    {
+        const auto position =
+            std::lower_bound(
+                _poses.begin(),
+                _poses.end(),
+                timestamp,
+                CompareTimestamps);
+
+        _poses.insert(
+            position,
+            std::make_pair(timestamp, cameraToWorld));
+    }
+
+    void SensorPoseTrack::Add(
+        _In_ const SensorFrameRecordingReader& reader)
+    {
+        for (size_t i = 0; i < reader.GetNumberOfFrames(); ++i)
+        {
+            const SensorFrameRecordingReader::FrameIndexEntry& entry =
+                reader.GetFrameIndexEntry(i);
+
+            cv::Matx44f cameraToWorld;
+
+            if (PointCloudGenerator::ComputeCameraToWorld(
+                    entry.FrameToOrigin,
+                    entry.CameraViewTransform,
+                    cameraToWorld))
+            {
+                Add(
+                    entry.Timestamp,
+                    cameraToWorld);
+            }
+        }
+    }
+
+    void SensorPoseTrack::Clear()
+    {
+        _poses.clear();
+    }
+
+    size_t SensorPoseTrack::GetNumberOfPoses() const
+    {
+        return _poses.size();
+    }
+
+    bool SensorPoseTrack::Interpolate(
+        _In_ uint64_t timestamp,
+        _In_ uint64_t maximumGap,
+        _Out_ cv::Matx44f& cameraToWorld) const
+    {
+        cameraToWorld = cv::Matx44f::eye();
+
+        if (_poses.empty())
+        {
+            return false;
+        }
+
+        const auto next =
+            std::lower_bound(
+                _poses.begin(),
+                _poses.end(),
+                timestamp,
+                CompareTimestamps);
+
+        if (_poses.end() != next && next->first == timestamp)
+        {
+            cameraToWorld = next->second;
+
+            return true;
+        }
+
+        //
+        // Before the first pose or after the last one: use the closest pose if it is
+        // recent enough.
+        //
+        if (_poses.begin() == next || _poses.end() == next)
+        {
+            const auto& closest =
+                (_poses.begin() == next) ? _poses.front() : _poses.back();
+
+            const uint64_t gap =
+                (closest.first > timestamp) ? closest.first - timestamp : timestamp - closest.first;
+
+            if (gap > maximumGap)
+            {
+                return false;
+            }
+
+            cameraToWorld = closest.second;
+
+            return true;
+        }
+
+        const auto& previous = *(next - 1);
+
+        if (next->first - previous.first > maximumGap)
+        {
+            return false;
+        }
+
+        cameraToWorld =
+            InterpolateRigidTransforms(
+                previous.second,
+                next->second,
+                static_cast<float>(
+                    static_cast<double>(timestamp - previous.first) / (next->first - previous.first)));
+
+        return true;
+    }
+
+    /* static */ cv::Matx44f SensorPoseTrack::InterpolateRigidTransforms(
+        _In_ const cv::Matx44f& first,
+        _In_ const cv::Matx44f& second,
+        _In_ float alpha)
+    {
+        const cv::Vec4d q0 = RotationToQuaternion(first);
+        cv::Vec4d q1 = RotationToQuaternion(second);
+
+        //
+        // Take the shortest path.
+        //
+        double cosine = q0.dot(q1);
+
+        if (cosine < 0.0)
+        {
+            q1 = -q1;
+            cosine = -cosine;
+        }
+
+        cv::Vec4d q;
+
+        if (cosine > 0.9995)
+        {
+            q = q0 + (q1 - q0) * alpha;
+        }
+        else
+        {
+            const double angle = std::acos(cosine);
+
+            q =
+                (q0 * std::sin((1.0 - alpha) * angle) + q1 * std::sin(alpha * angle)) *
+                (1.0 / std::sin(angle));
+        }
+
+        q *= 1.0 / cv::norm(q);
+
+        cv::Matx44f result = cv::Matx44f::eye();
+
+        QuaternionToRotation(
+            q,
+            result);
+
+        for (int32_t row = 0; row < 3; ++row)
+        {
+            result(row, 3) =
+                first(row, 3) + (second(row, 3) - first(row, 3)) * alpha;
+        }
+
+        return result;
+    }
+}
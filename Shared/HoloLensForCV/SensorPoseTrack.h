@@ -0,0 +1,68 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Time series of the camera-to-world transforms of a sensor, used to estimate the pose
+    // of the sensor at an arbitrary time: e.g. the pose of the photo-video camera at the
+    // time a depth frame was captured, or the pose of a frame that was recorded without
+    // one.
+    //
+    // Rotations are interpolated spherically and translations linearly. Poses are never
+    // extrapolated further than the allowed gap.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class SensorPoseTrack
+    {
+    public:
+        //
+        // Adds a pose. Poses may be added in any order.
+        //
+        void Add(
+            _In_ uint64_t timestamp,
+            _In_ const cv::Matx44f& cameraToWorld);
+
+        //
+        // Adds the valid poses of all the frames of a recording.
+        //
+        void Add(
+            _In_ const SensorFrameRecordingReader& reader);
+
+        void Clear();
+
+        size_t GetNumberOfPoses() const;
+
+        //
+        // Estimates the pose at the given time (universal time, in 100ns ticks). Fails if
+        // the closest poses are more than the given gap apart, or if the time is more than
+        // the given gap away from the track.
+        //
+        bool Interpolate(
+            _In_ uint64_t timestamp,
+            _In_ uint64_t maximumGap,
+            _Out_ cv::Matx44f& cameraToWorld) const;
+
+        //
+        // Interpolates between two rigid transforms, for 0 <= alpha <= 1.
+        //
+        static cv::Matx44f InterpolateRigidTransforms(
+            _In_ const cv::Matx44f& first,
+            _In_ const cv::Matx44f& second,
+            _In_ float alpha);
+
+    private:
+        std::vector<std::pair<uint64_t, cv::Matx44f>> _poses;
+    };
+}
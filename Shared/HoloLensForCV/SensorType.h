@@ -41,4 +41,46 @@ namespace HoloLensForCV
             return std::hash<int32_t>()((int32_t)sensorType);
         }
     };
+
+    //
+    // Name used for the sensor's files in recordings.
+    //
+    inline const wchar_t* GetSensorTypeName(
+        _In_ SensorType sensorType)
+    {
+        switch (sensorType)
+        {
+        case SensorType::PhotoVideo:
+            return L"pv";
+
+#if ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS
+        case SensorType::ShortThrowToFDepth:
+            return L"short_throw_depth";
+
+        case SensorType::ShortThrowToFReflectivity:
+            return L"short_throw_reflectivity";
+
+        case SensorType::LongThrowToFDepth:
+            return L"long_throw_depth";
+
+        case SensorType::LongThrowToFReflectivity:
+            return L"long_throw_reflectivity";
+
+        case SensorType::VisibleLightLeftLeft:
+            return L"vlc_ll";
+
+        case SensorType::VisibleLightLeftFront:
+            return L"vlc_lf";
+
+        case SensorType::VisibleLightRightFront:
+            return L"vlc_rf";
+
+        case SensorType::VisibleLightRightRight:
+            return L"vlc_rr";
+#endif /* ENABLE_HOLOLENS_RESEARCH_MODE_SENSORS */
+
+        default:
+            throw std::logic_error("unexpected sensor type");
+        }
+    }
 }
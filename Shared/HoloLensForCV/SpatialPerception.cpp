@@ -70,7 +70,9 @@ namespace HoloLensForCV
         {
             // Holograms cannot be rendered.
 #if DBG_ENABLE_INFORMATIONAL_LOGGING
-            dbg::trace(
+            DBG_LOG(
+                "SpatialPerception",
+                dbg::LogLevel::Information,
                 L"SpatialPerception::OnLocatabilityChanged: warning positional tracking is %s!\n",
                 sender->Locatability.ToString());
 #endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
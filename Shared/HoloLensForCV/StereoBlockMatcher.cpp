@@ -0,0 +1,1067 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        const int32_t c_censusRadius = 2;
+
+        // The 24 bits of a census code are stored in three planes.
+        const int32_t c_censusBytes = 3;
+
+        // Cost of the disparities that point outside of the right image.
+        const uint8_t c_invalidCost = 255;
+
+        const uint16_t c_noRightCost = 0xffff;
+
+        // Number of bits set in each byte.
+        const std::array<uint8_t, 256> c_bitCounts = []()
+        {
+            std::array<uint8_t, 256> bitCounts;
+
+            for (int32_t value = 0; value < 256; ++value)
+            {
+                bitCounts[value] = static_cast<uint8_t>(
+                    (value & 1) + ((value >> 1) & 1) + ((value >> 2) & 1) + ((value >> 3) & 1) +
+                    ((value >> 4) & 1) + ((value >> 5) & 1) + ((value >> 6) & 1) + (value >> 7));
+            }
+
+            return bitCounts;
+        }();
+
+#if CV_SIMD128
+        //
+        // Number of bits set in each byte. There are no 8-bit shifts: 16-bit shifts are
+        // used, the masks discarding the bits shifted in from the neighboring byte.
+        //
+        cv::v_uint8x16 CountBits(
+            _In_ const cv::v_uint8x16& value)
+        {
+            const cv::v_uint8x16 m1 = cv::v_setall_u8(0x55);
+            const cv::v_uint8x16 m2 = cv::v_setall_u8(0x33);
+            const cv::v_uint8x16 m4 = cv::v_setall_u8(0x0f);
+
+            const cv::v_uint8x16 pairs =
+                value - (cv::v_reinterpret_as_u8(cv::v_reinterpret_as_u16(value) >> 1) & m1);
+
+            const cv::v_uint8x16 nibbles =
+                (pairs & m2) + (cv::v_reinterpret_as_u8(cv::v_reinterpret_as_u16(pairs) >> 2) & m2);
+
+            return (nibbles + cv::v_reinterpret_as_u8(cv::v_reinterpret_as_u16(nibbles) >> 4)) & m4;
+        }
+#endif /* CV_SIMD128 */
+
+        //
+        // sums[i] += costs[i]
+        //
+        void AddCosts(
+            _In_reads_(count) const uint8_t* costs,
+            _In_ int32_t count,
+            _Inout_updates_(count) uint16_t* sums)
+        {
+            int32_t i = 0;
+
+#if CV_SIMD128
+            for (; i + 16 <= count; i += 16)
+            {
+                cv::v_uint16x8 low, high;
+
+                cv::v_expand(
+                    cv::v_load(costs + i),
+                    low,
+                    high);
+
+                cv::v_store(sums + i, cv::v_load(sums + i) + low);
+                cv::v_store(sums + i + 8, cv::v_load(sums + i + 8) + high);
+            }
+#endif /* CV_SIMD128 */
+
+            for (; i < count; ++i)
+            {
+                sums[i] = static_cast<uint16_t>(sums[i] + costs[i]);
+            }
+        }
+
+        //
+        // sums[i] = sums[i] - removedCosts[i] + addedCosts[i]
+        //
+        void ReplaceCosts(
+            _In_reads_(count) const uint8_t* removedCosts,
+            _In_reads_(count) const uint8_t* addedCosts,
+            _In_ int32_t count,
+            _Inout_updates_(count) uint16_t* sums)
+        {
+            int32_t i = 0;
+
+#if CV_SIMD128
+            for (; i + 16 <= count; i += 16)
+            {
+                cv::v_uint16x8 removedLow, removedHigh, addedLow, addedHigh;
+
+                cv::v_expand(cv::v_load(removedCosts + i), removedLow, removedHigh);
+                cv::v_expand(cv::v_load(addedCosts + i), addedLow, addedHigh);
+
+                //
+                // 16-bit arithmetic saturates: subtract first, the sums always include
+                // the removed costs.
+                //
+                cv::v_store(sums + i, (cv::v_load(sums + i) - removedLow) + addedLow);
+                cv::v_store(sums + i + 8, (cv::v_load(sums + i + 8) - removedHigh) + addedHigh);
+            }
+#endif /* CV_SIMD128 */
+
+            for (; i < count; ++i)
+            {
+                sums[i] = static_cast<uint16_t>(sums[i] - removedCosts[i] + addedCosts[i]);
+            }
+        }
+
+        //
+        // sums[i] = sums[i] + added[i] - removed[i]
+        //
+        void SlideSums(
+            _In_reads_(count) const uint16_t* added,
+            _In_reads_(count) const uint16_t* removed,
+            _In_ int32_t count,
+            _Inout_updates_(count) uint16_t* sums)
+        {
+            int32_t i = 0;
+
+#if CV_SIMD128
+            for (; i + 8 <= count; i += 8)
+            {
+                cv::v_store(
+                    sums + i,
+                    (cv::v_load(sums + i) + cv::v_load(added + i)) - cv::v_load(removed + i));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; i < count; ++i)
+            {
+                sums[i] = static_cast<uint16_t>(sums[i] + added[i] - removed[i]);
+            }
+        }
+
+        //
+        // Returns the smallest of the first 'count' sums, ignoring those within one of
+        // 'best'.
+        //
+        uint16_t FindSecondMinimum(
+            _In_reads_(count) const uint16_t* sums,
+            _In_ int32_t count,
+            _In_ int32_t best)
+        {
+            uint16_t minimum = c_noRightCost;
+
+            int32_t i = 0;
+
+#if CV_SIMD128
+            const cv::v_int16x8 eight = cv::v_setall_s16(8);
+            const cv::v_int16x8 ignoredBegin = cv::v_setall_s16(static_cast<int16_t>(best - 2));
+            const cv::v_int16x8 ignoredEnd = cv::v_setall_s16(static_cast<int16_t>(best + 2));
+            const cv::v_uint16x8 ignoredSum = cv::v_setall_u16(c_noRightCost);
+
+            cv::v_int16x8 index(0, 1, 2, 3, 4, 5, 6, 7);
+            cv::v_uint16x8 minimums = ignoredSum;
+
+            for (; i + 8 <= count; i += 8, index += eight)
+            {
+                const cv::v_uint16x8 isIgnored =
+                    cv::v_reinterpret_as_u16((index > ignoredBegin) & (index < ignoredEnd));
+
+                minimums = cv::v_min(
+                    minimums,
+                    cv::v_select(isIgnored, ignoredSum, cv::v_load(sums + i)));
+            }
+
+            uint16_t lanes[8];
+
+            cv::v_store(lanes, minimums);
+
+            minimum = *std::min_element(lanes, lanes + 8);
+#endif /* CV_SIMD128 */
+
+            for (; i < count; ++i)
+            {
+                if (std::abs(i - best) > 1)
+                {
+                    minimum = std::min(minimum, sums[i]);
+                }
+            }
+
+            return minimum;
+        }
+
+        //
+        // Slides the block sums of a pixel to the next pixel (see SlideSums) and returns
+        // the index of the smallest of the first 'count' sums, the first one on ties.
+        //
+        // Unless rightSums is null, also keeps, for each right pixel, the lowest sum of the
+        // left pixels matched with it and their disparity. Both arrays are reversed, so
+        // that the right pixels matched with the left pixel u are at W - 1 - u + d, i.e.
+        // contiguous.
+        //
+        int32_t SlideSumsAndFindMinimum(
+            _In_reads_(numberOfSums) const uint16_t* added,
+            _In_reads_(numberOfSums) const uint16_t* removed,
+            _In_ int32_t numberOfSums,
+            _In_ int32_t count,
+            _Inout_updates_(numberOfSums) uint16_t* sums,
+            _Inout_updates_opt_(count) uint16_t* rightSums,
+            _Inout_updates_opt_(count) int16_t* rightDisparities)
+        {
+#if CV_SIMD128
+            //
+            // All the sums are searched: single pass, loading each vector once.
+            //
+            if (count == numberOfSums && 0 == count % 8)
+            {
+                const cv::v_uint16x8 eight = cv::v_setall_u16(8);
+
+                cv::v_uint16x8 index(0, 1, 2, 3, 4, 5, 6, 7);
+                cv::v_uint16x8 minimum = cv::v_setall_u16(0xffff);
+                cv::v_uint16x8 minimumIndex = cv::v_setzero_u16();
+
+                for (int32_t i = 0; i < count; i += 8, index += eight)
+                {
+                    const cv::v_uint16x8 sum =
+                        (cv::v_load(sums + i) + cv::v_load(added + i)) - cv::v_load(removed + i);
+
+                    cv::v_store(sums + i, sum);
+
+                    minimumIndex = cv::v_select(sum < minimum, index, minimumIndex);
+                    minimum = cv::v_min(minimum, sum);
+
+                    if (nullptr != rightSums)
+                    {
+                        const cv::v_uint16x8 rightSum = cv::v_load(rightSums + i);
+
+                        cv::v_store(
+                            rightDisparities + i,
+                            cv::v_select(
+                                cv::v_reinterpret_as_s16(sum < rightSum),
+                                cv::v_reinterpret_as_s16(index),
+                                cv::v_load(rightDisparities + i)));
+
+                        cv::v_store(rightSums + i, cv::v_min(sum, rightSum));
+                    }
+                }
+
+                uint16_t minimums[8], indices[8];
+
+                cv::v_store(minimums, minimum);
+                cv::v_store(indices, minimumIndex);
+
+                int32_t best = indices[0];
+
+                for (int32_t lane = 1; lane < 8; ++lane)
+                {
+                    if (minimums[lane] < sums[best] ||
+                        (minimums[lane] == sums[best] && indices[lane] < best))
+                    {
+                        best = indices[lane];
+                    }
+                }
+
+                return best;
+            }
+#endif /* CV_SIMD128 */
+
+            SlideSums(
+                added,
+                removed,
+                numberOfSums,
+                sums);
+
+            int32_t best = 0;
+
+            for (int32_t i = 0; i < count; ++i)
+            {
+                if (sums[i] < sums[best])
+                {
+                    best = i;
+                }
+
+                if (nullptr != rightSums && sums[i] < rightSums[i])
+                {
+                    rightSums[i] = sums[i];
+                    rightDisparities[i] = static_cast<int16_t>(i);
+                }
+            }
+
+            return best;
+        }
+    }
+
+    StereoBlockMatcher::Options::Options()
+        : Cost(CostFunction::Census)
+        , NumberOfDisparities(64)
+        , BlockRadius(3)
+        , UniquenessRatio(10)
+        , LeftRightTolerance(1)
+        , SubpixelRefinement(true)
+        , NumberOfBands(0)
+    {
+    }
+
+    StereoBlockMatcher::FrameTimings::FrameTimings()
+        : CensusTimeInMilliseconds(0.0)
+        , MatchingTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , ValidPixelFraction(0.0)
+    {
+    }
+
+    StereoBlockMatcher::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfPairs(0)
+        , NumberOfUnpairedFrames(0)
+        , RectificationTimeInMilliseconds(0.0)
+        , MatchingTimeInMilliseconds(0.0)
+        , TotalTimeInMilliseconds(0.0)
+        , MaximumTotalTimeInMilliseconds(0.0)
+        , PairsPerSecond(0.0)
+        , ValidPixelFraction(0.0)
+    {
+    }
+
+    StereoBlockMatcher::StereoBlockMatcher(
+        _In_ const Options& options)
+        : _options(options)
+        , _width(0)
+        , _height(0)
+    {
+        REQUIRES(
+            options.NumberOfDisparities > 0 &&
+            options.NumberOfDisparities <= 256 &&
+            0 == options.NumberOfDisparities % 16 &&
+            options.BlockRadius >= 1 &&
+            options.BlockRadius <= 7 &&
+            options.UniquenessRatio >= 0);
+    }
+
+    const StereoBlockMatcher::Options& StereoBlockMatcher::GetOptions() const
+    {
+        return _options;
+    }
+
+    const StereoBlockMatcher::FrameTimings& StereoBlockMatcher::GetLastFrameTimings() const
+    {
+        return _lastFrameTimings;
+    }
+
+    void StereoBlockMatcher::Compute(
+        _In_ const cv::Mat& left,
+        _In_ const cv::Mat& right,
+        _Out_ cv::Mat& disparity)
+    {
+        REQUIRES(
+            CV_8UC1 == left.type() &&
+            CV_8UC1 == right.type() &&
+            left.size() == right.size());
+
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        _width = left.cols;
+        _height = left.rows;
+
+        const int32_t numberOfDisparities =
+            _options.NumberOfDisparities;
+
+        cv::Mat rightValues;
+
+        if (CostFunction::Census == _options.Cost)
+        {
+            ComputeCensus(
+                left,
+                _left);
+
+            ComputeCensus(
+                right,
+                rightValues);
+        }
+        else
+        {
+            _left = left;
+            rightValues = right;
+        }
+
+        _reversedRight.create(
+            rightValues.rows,
+            _width + numberOfDisparities,
+            rightValues.type());
+
+        _reversedRight.colRange(_width, _width + numberOfDisparities).setTo(
+            cv::Scalar());
+
+        cv::flip(
+            rightValues,
+            _reversedRight.colRange(0, _width),
+            1 /* flipCode: around the vertical axis */);
+
+        const std::chrono::steady_clock::time_point censusTime =
+            std::chrono::steady_clock::now();
+
+        disparity.create(
+            _height,
+            _width,
+            CV_32FC1);
+
+        //
+        // Each band recomputes the costs of the 2 * BlockRadius rows around it, so bands
+        // are kept several blocks high.
+        //
+        const int32_t blockSize =
+            2 * _options.BlockRadius + 1;
+
+        const int32_t numberOfBands =
+            std::max(
+                1,
+                std::min(
+                    (_options.NumberOfBands > 0) ? _options.NumberOfBands : 2 * cv::getNumThreads(),
+                    _height / (4 * blockSize)));
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                MatchBand(
+                    _height * band / numberOfBands,
+                    _height * (band + 1) / numberOfBands,
+                    disparity);
+            }
+        });
+
+        const std::chrono::steady_clock::time_point endTime =
+            std::chrono::steady_clock::now();
+
+        _lastFrameTimings.CensusTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(censusTime - startTime).count();
+
+        _lastFrameTimings.MatchingTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(endTime - censusTime).count();
+
+        _lastFrameTimings.TotalTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        size_t numberOfValidPixels = 0;
+
+        for (int32_t v = 0; v < _height; ++v)
+        {
+            const float* disparityRow = disparity.ptr<float>(v);
+
+            for (int32_t u = 0; u < _width; ++u)
+            {
+                if (!std::isnan(disparityRow[u]))
+                {
+                    ++numberOfValidPixels;
+                }
+            }
+        }
+
+        _lastFrameTimings.ValidPixelFraction =
+            static_cast<double>(numberOfValidPixels) /
+            static_cast<double>(disparity.total());
+    }
+
+    void StereoBlockMatcher::ComputeCensus(
+        _In_ const cv::Mat& image,
+        _Out_ cv::Mat& census) const
+    {
+        cv::Mat padded;
+
+        cv::copyMakeBorder(
+            image,
+            padded,
+            c_censusRadius,
+            c_censusRadius,
+            c_censusRadius,
+            c_censusRadius,
+            cv::BORDER_REPLICATE);
+
+        census.create(
+            c_censusBytes * image.rows,
+            image.cols,
+            CV_8UC1);
+
+        cv::parallel_for_(
+            cv::Range(0, image.rows),
+            [&](const cv::Range& range)
+        {
+            for (int32_t v = range.start; v < range.end; ++v)
+            {
+                const uint8_t* rows[2 * c_censusRadius + 1];
+
+                for (int32_t dy = 0; dy <= 2 * c_censusRadius; ++dy)
+                {
+                    rows[dy] = padded.ptr<uint8_t>(v + dy);
+                }
+
+                uint8_t* codes[c_censusBytes];
+
+                for (int32_t plane = 0; plane < c_censusBytes; ++plane)
+                {
+                    codes[plane] = census.ptr<uint8_t>(c_censusBytes * v + plane);
+                }
+
+                int32_t u = 0;
+
+#if CV_SIMD128
+                //
+                // The 24 comparisons of 16 pixels are accumulated in three bytes per
+                // pixel.
+                //
+                for (; u + 16 <= image.cols; u += 16)
+                {
+                    const cv::v_uint8x16 center =
+                        cv::v_load(rows[c_censusRadius] + u + c_censusRadius);
+
+                    cv::v_uint8x16 bytes[c_censusBytes] =
+                    {
+                        cv::v_setzero_u8(),
+                        cv::v_setzero_u8(),
+                        cv::v_setzero_u8()
+                    };
+
+                    int32_t bit = 0;
+
+                    for (int32_t dy = 0; dy <= 2 * c_censusRadius; ++dy)
+                    {
+                        for (int32_t dx = 0; dx <= 2 * c_censusRadius; ++dx)
+                        {
+                            if (c_censusRadius == dy && c_censusRadius == dx)
+                            {
+                                continue;
+                            }
+
+                            const cv::v_uint8x16 isDarker =
+                                cv::v_load(rows[dy] + u + dx) < center;
+
+                            bytes[bit / 8] |=
+                                isDarker & cv::v_setall_u8(static_cast<uint8_t>(1 << (bit % 8)));
+
+                            ++bit;
+                        }
+                    }
+
+                    for (int32_t plane = 0; plane < c_censusBytes; ++plane)
+                    {
+                        cv::v_store(
+                            codes[plane] + u,
+                            bytes[plane]);
+                    }
+                }
+#endif /* CV_SIMD128 */
+
+                for (; u < image.cols; ++u)
+                {
+                    const uint8_t center =
+                        rows[c_censusRadius][u + c_censusRadius];
+
+                    uint32_t code = 0;
+                    int32_t bit = 0;
+
+                    for (int32_t dy = 0; dy <= 2 * c_censusRadius; ++dy)
+                    {
+                        for (int32_t dx = 0; dx <= 2 * c_censusRadius; ++dx)
+                        {
+                            if (c_censusRadius == dy && c_censusRadius == dx)
+                            {
+                                continue;
+                            }
+
+                            if (rows[dy][u + dx] < center)
+                            {
+                                code |= 1u << bit;
+                            }
+
+                            ++bit;
+                        }
+                    }
+
+                    for (int32_t plane = 0; plane < c_censusBytes; ++plane)
+                    {
+                        codes[plane][u] = static_cast<uint8_t>(code >> (8 * plane));
+                    }
+                }
+            }
+        });
+    }
+
+    void StereoBlockMatcher::ComputeRowCosts(
+        _In_ int32_t row,
+        _Out_writes_(_width * _options.NumberOfDisparities) uint8_t* costs) const
+    {
+        const int32_t numberOfDisparities =
+            _options.NumberOfDisparities;
+
+        if (CostFunction::Census == _options.Cost)
+        {
+            const uint8_t* left[c_censusBytes];
+            const uint8_t* reversedRight[c_censusBytes];
+
+            for (int32_t plane = 0; plane < c_censusBytes; ++plane)
+            {
+                left[plane] = _left.ptr<uint8_t>(c_censusBytes * row + plane);
+                reversedRight[plane] = _reversedRight.ptr<uint8_t>(c_censusBytes * row + plane) + _width - 1;
+            }
+
+            for (int32_t u = 0; u < _width; ++u)
+            {
+                uint8_t* pixelCosts = costs + u * numberOfDisparities;
+
+                int32_t d = 0;
+
+#if CV_SIMD128
+                const cv::v_uint8x16 code0 = cv::v_setall_u8(left[0][u]);
+                const cv::v_uint8x16 code1 = cv::v_setall_u8(left[1][u]);
+                const cv::v_uint8x16 code2 = cv::v_setall_u8(left[2][u]);
+
+                for (; d + 16 <= numberOfDisparities; d += 16)
+                {
+                    cv::v_store(
+                        pixelCosts + d,
+                        CountBits(code0 ^ cv::v_load(reversedRight[0] - u + d)) +
+                        CountBits(code1 ^ cv::v_load(reversedRight[1] - u + d)) +
+                        CountBits(code2 ^ cv::v_load(reversedRight[2] - u + d)));
+                }
+#endif /* CV_SIMD128 */
+
+                for (; d < numberOfDisparities; ++d)
+                {
+                    pixelCosts[d] = static_cast<uint8_t>(
+                        c_bitCounts[left[0][u] ^ reversedRight[0][d - u]] +
+                        c_bitCounts[left[1][u] ^ reversedRight[1][d - u]] +
+                        c_bitCounts[left[2][u] ^ reversedRight[2][d - u]]);
+                }
+            }
+        }
+        else
+        {
+            const uint8_t* left = _left.ptr<uint8_t>(row);
+            const uint8_t* reversedRight = _reversedRight.ptr<uint8_t>(row);
+
+            for (int32_t u = 0; u < _width; ++u)
+            {
+                const uint8_t* right = reversedRight + _width - 1 - u;
+                uint8_t* pixelCosts = costs + u * numberOfDisparities;
+
+                int32_t d = 0;
+
+#if CV_SIMD128
+                const cv::v_uint8x16 value = cv::v_setall_u8(left[u]);
+
+                for (; d + 16 <= numberOfDisparities; d += 16)
+                {
+                    cv::v_store(
+                        pixelCosts + d,
+                        cv::v_absdiff(value, cv::v_load(right + d)));
+                }
+#endif /* CV_SIMD128 */
+
+                for (; d < numberOfDisparities; ++d)
+                {
+                    pixelCosts[d] = static_cast<uint8_t>(
+                        std::abs(left[u] - right[d]));
+                }
+            }
+        }
+
+        //
+        // The right pixels of the first columns' largest disparities are padding.
+        //
+        for (int32_t u = 0; u < std::min(_width, numberOfDisparities - 1); ++u)
+        {
+            std::fill(
+                costs + u * numberOfDisparities + u + 1,
+                costs + (u + 1) * numberOfDisparities,
+                c_invalidCost);
+        }
+    }
+
+    void StereoBlockMatcher::MatchBand(
+        _In_ int32_t beginRow,
+        _In_ int32_t endRow,
+        _Out_ cv::Mat& disparity) const
+    {
+        const int32_t numberOfDisparities = _options.NumberOfDisparities;
+        const int32_t radius = _options.BlockRadius;
+        const int32_t blockSize = 2 * radius + 1;
+        const int32_t rowLength = _width * numberOfDisparities;
+        const bool checkLeftRight = _options.LeftRightTolerance >= 0;
+
+        //
+        // The costs of the blockSize rows around the current row, and their sums over
+        // those rows (i.e. along the columns of the blocks).
+        //
+        std::vector<std::vector<uint8_t>> costRows(
+            blockSize,
+            std::vector<uint8_t>(rowLength));
+
+        std::vector<uint8_t> nextCostRow(
+            rowLength);
+
+        std::vector<uint16_t> columnSums(
+            rowLength,
+            0);
+
+        const std::vector<uint16_t> zeros(
+            numberOfDisparities,
+            0);
+
+        // Sums over the blocks centered on the current pixel.
+        std::vector<uint16_t> blockSums(
+            numberOfDisparities);
+
+        std::vector<uint16_t> rightCosts(
+            _width + numberOfDisparities);
+
+        std::vector<int16_t> rightDisparities(
+            _width + numberOfDisparities);
+
+        std::vector<int16_t> bestDisparities(
+            _width);
+
+        const auto clampRow = [this](int32_t row)
+        {
+            return std::min(std::max(row, 0), _height - 1);
+        };
+
+        for (int32_t i = 0; i < blockSize; ++i)
+        {
+            ComputeRowCosts(
+                clampRow(beginRow - radius + i),
+                costRows[i].data());
+
+            AddCosts(
+                costRows[i].data(),
+                rowLength,
+                columnSums.data());
+        }
+
+        const float notANumber =
+            std::numeric_limits<float>::quiet_NaN();
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            float* disparityRow = disparity.ptr<float>(v);
+
+            std::fill(
+                disparityRow,
+                disparityRow + _width,
+                notANumber);
+
+            std::fill(
+                bestDisparities.begin(),
+                bestDisparities.end(),
+                static_cast<int16_t>(-1));
+
+            if (checkLeftRight)
+            {
+                std::fill(rightCosts.begin(), rightCosts.end(), c_noRightCost);
+                std::fill(rightDisparities.begin(), rightDisparities.end(), static_cast<int16_t>(-1));
+            }
+
+            std::fill(
+                blockSums.begin(),
+                blockSums.end(),
+                static_cast<uint16_t>(0));
+
+            for (int32_t u = 0; u < std::min(blockSize - 1, _width); ++u)
+            {
+                SlideSums(
+                    columnSums.data() + u * numberOfDisparities,
+                    zeros.data(),
+                    numberOfDisparities,
+                    blockSums.data());
+            }
+
+            for (int32_t u = radius; u + radius < _width; ++u)
+            {
+                //
+                // Only the disparities whose blocks are entirely inside the right image
+                // are searched.
+                //
+                const int32_t searchedDisparities =
+                    std::min(numberOfDisparities, u - radius + 1);
+
+                const int32_t best =
+                    SlideSumsAndFindMinimum(
+                        columnSums.data() + (u + radius) * numberOfDisparities,
+                        (u > radius) ? columnSums.data() + (u - radius - 1) * numberOfDisparities : zeros.data(),
+                        numberOfDisparities,
+                        searchedDisparities,
+                        blockSums.data(),
+                        checkLeftRight ? rightCosts.data() + _width - 1 - u : nullptr,
+                        checkLeftRight ? rightDisparities.data() + _width - 1 - u : nullptr);
+
+                const uint32_t bestCost = blockSums[best];
+
+                if (_options.UniquenessRatio > 0 &&
+                    100 * static_cast<uint32_t>(FindSecondMinimum(blockSums.data(), searchedDisparities, best)) <=
+                        (100 + _options.UniquenessRatio) * bestCost)
+                {
+                    continue;
+                }
+
+                bestDisparities[u] = static_cast<int16_t>(best);
+
+                float refinedDisparity = static_cast<float>(best);
+
+                if (_options.SubpixelRefinement &&
+                    best > 0 &&
+                    best + 1 < searchedDisparities)
+                {
+                    const int32_t previous = blockSums[best - 1];
+                    const int32_t next = blockSums[best + 1];
+                    const int32_t curvature = previous + next - 2 * static_cast<int32_t>(bestCost);
+
+                    if (curvature > 0)
+                    {
+                        refinedDisparity +=
+                            static_cast<float>(previous - next) / (2.0f * curvature);
+                    }
+                }
+
+                disparityRow[u] = refinedDisparity;
+            }
+
+            //
+            // A match is kept if the best match of the right pixel is the same, give or
+            // take the tolerance.
+            //
+            if (checkLeftRight)
+            {
+                for (int32_t u = radius; u + radius < _width; ++u)
+                {
+                    const int32_t best = bestDisparities[u];
+
+                    if (best < 0)
+                    {
+                        continue;
+                    }
+
+                    const int32_t rightBest =
+                        rightDisparities[_width - 1 - (u - best)];
+
+                    if (rightBest < 0 ||
+                        std::abs(rightBest - best) > _options.LeftRightTolerance)
+                    {
+                        disparityRow[u] = notANumber;
+                    }
+                }
+            }
+
+            //
+            // Slides the rows down: the costs of the top row are replaced with those of
+            // the row below the bottom one.
+            //
+            if (v + 1 < endRow)
+            {
+                std::vector<uint8_t>& topCostRow =
+                    costRows[(v - beginRow) % blockSize];
+
+                ComputeRowCosts(
+                    clampRow(v + radius + 1),
+                    nextCostRow.data());
+
+                ReplaceCosts(
+                    topCostRow.data(),
+                    nextCostRow.data(),
+                    rowLength,
+                    columnSums.data());
+
+                topCostRow.swap(
+                    nextCostRow);
+            }
+        }
+    }
+
+    /* static */ bool StereoBlockMatcher::BenchmarkRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const StereoRectifier::Options& rectifierOptions,
+        _In_ const Options& options,
+        _In_ size_t maximumNumberOfPairs,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        statistics = BenchmarkStatistics();
+
+        const std::string leftSensorName = "vlc_lf";
+        const std::string rightSensorName = "vlc_rf";
+
+        SensorFrameRecordingReader leftReader, rightReader;
+
+        if (!leftReader.Open(recordingFolder, leftSensorName) ||
+            !rightReader.Open(recordingFolder, rightSensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> leftArchive =
+            leftReader.OpenArchive();
+
+        std::unique_ptr<std::istream> rightArchive =
+            rightReader.OpenArchive();
+
+        StereoRectifier rectifier;
+        StereoBlockMatcher matcher(options);
+
+        RecordedSensorFrame leftFrame, rightFrame;
+        cv::Mat rectifiedLeft, rectifiedRight, disparity;
+
+        double elapsedTimeInMilliseconds = 0.0;
+
+        size_t leftIndex = 0, rightIndex = 0;
+
+        //
+        // Both cameras are triggered together, so the frames are paired by walking both
+        // recordings in timestamp order.
+        //
+        while (leftIndex < leftReader.GetNumberOfFrames() &&
+               rightIndex < rightReader.GetNumberOfFrames() &&
+               (0 == maximumNumberOfPairs || statistics.NumberOfPairs < maximumNumberOfPairs))
+        {
+            const uint64_t leftTimestamp =
+                leftReader.GetFrameIndexEntry(leftIndex).Timestamp;
+
+            const uint64_t rightTimestamp =
+                rightReader.GetFrameIndexEntry(rightIndex).Timestamp;
+
+            if (leftTimestamp + MaximumPairingDelta < rightTimestamp)
+            {
+                ++leftIndex;
+                ++statistics.NumberOfUnpairedFrames;
+                continue;
+            }
+
+            if (rightTimestamp + MaximumPairingDelta < leftTimestamp)
+            {
+                ++rightIndex;
+                ++statistics.NumberOfUnpairedFrames;
+                continue;
+            }
+
+            const bool isPairRead =
+                leftReader.ReadFrame(leftIndex++, leftArchive.get(), leftFrame) &&
+                rightReader.ReadFrame(rightIndex++, rightArchive.get(), rightFrame) &&
+                CV_8UC1 == leftFrame.Image.type() &&
+                CV_8UC1 == rightFrame.Image.type() &&
+                leftFrame.Image.size() == rightFrame.Image.size();
+
+            if (!isPairRead)
+            {
+                continue;
+            }
+
+            if (!rectifier.IsInitialized())
+            {
+                cv::Mat leftUnitPlaneMap, rightUnitPlaneMap;
+                cv::Matx44f leftCameraToWorld, rightCameraToWorld;
+
+                if (!PointCloudGenerator::LoadUnitPlaneMap(recordingFolder, leftSensorName, leftFrame.Image.cols, leftFrame.Image.rows, leftUnitPlaneMap) ||
+                    !PointCloudGenerator::LoadUnitPlaneMap(recordingFolder, rightSensorName, rightFrame.Image.cols, rightFrame.Image.rows, rightUnitPlaneMap) ||
+                    !PointCloudGenerator::ComputeCameraToWorld(leftFrame.FrameToOrigin, leftFrame.CameraViewTransform, leftCameraToWorld) ||
+                    !PointCloudGenerator::ComputeCameraToWorld(rightFrame.FrameToOrigin, rightFrame.CameraViewTransform, rightCameraToWorld))
+                {
+                    continue;
+                }
+
+                if (!rectifier.Initialize(
+                        leftUnitPlaneMap,
+                        rightUnitPlaneMap,
+                        leftCameraToWorld,
+                        rightCameraToWorld,
+                        rectifierOptions))
+                {
+                    return false;
+                }
+            }
+
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            rectifier.Rectify(
+                leftFrame.Image,
+                rightFrame.Image,
+                rectifiedLeft,
+                rectifiedRight);
+
+            const std::chrono::steady_clock::time_point rectifiedTime =
+                std::chrono::steady_clock::now();
+
+            matcher.Compute(
+                rectifiedLeft,
+                rectifiedRight,
+                disparity);
+
+            const std::chrono::steady_clock::time_point endTime =
+                std::chrono::steady_clock::now();
+
+            const double totalTimeInMilliseconds =
+                std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+            ++statistics.NumberOfPairs;
+
+            statistics.RectificationTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(rectifiedTime - startTime).count();
+
+            statistics.MatchingTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(endTime - rectifiedTime).count();
+
+            statistics.TotalTimeInMilliseconds += totalTimeInMilliseconds;
+
+            statistics.MaximumTotalTimeInMilliseconds =
+                std::max(
+                    statistics.MaximumTotalTimeInMilliseconds,
+                    totalTimeInMilliseconds);
+
+            statistics.ValidPixelFraction +=
+                matcher.GetLastFrameTimings().ValidPixelFraction;
+
+            elapsedTimeInMilliseconds += totalTimeInMilliseconds;
+        }
+
+        if (statistics.NumberOfPairs > 0)
+        {
+            const double scale = 1.0 / statistics.NumberOfPairs;
+
+            statistics.RectificationTimeInMilliseconds *= scale;
+            statistics.MatchingTimeInMilliseconds *= scale;
+            statistics.TotalTimeInMilliseconds *= scale;
+            statistics.ValidPixelFraction *= scale;
+
+            statistics.PairsPerSecond =
+                1000.0 * statistics.NumberOfPairs / std::max(elapsedTimeInMilliseconds, 1e-6);
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "StereoBlockMatcher",
+            dbg::LogLevel::Information,
+            L"StereoBlockMatcher::BenchmarkRecording: %llu pairs (%llu unpaired frames), %.3f ms/pair (rectification %.3f, matching %.3f), max %.3f ms, %.1f pairs/s, %.1f%% valid",
+            statistics.NumberOfPairs,
+            statistics.NumberOfUnpairedFrames,
+            statistics.TotalTimeInMilliseconds,
+            statistics.RectificationTimeInMilliseconds,
+            statistics.MatchingTimeInMilliseconds,
+            statistics.MaximumTotalTimeInMilliseconds,
+            statistics.PairsPerSecond,
+            statistics.ValidPixelFraction * 100.0);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return statistics.NumberOfPairs > 0;
+    }
+}
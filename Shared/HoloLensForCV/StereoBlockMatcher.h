@@ -0,0 +1,175 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Computes dense disparity maps from pairs of rectified 8-bit images (see
+    // StereoRectifier) by block matching.
+    //
+    // The matching cost of a pixel is either the Hamming distance between 5x5 census
+    // transforms, which is robust to the different exposures of the two cameras, or the
+    // absolute difference of intensities. Costs are summed over square blocks with running
+    // sums, and the disparity with the lowest sum wins, unless it is not unique enough or
+    // the right-to-left match does not agree. All disparities of a pixel are evaluated at
+    // once with SIMD instructions, and the image is split in horizontal bands matched in
+    // parallel.
+    //
+    // An instance keeps scratch buffers between calls, so it must not be used by several
+    // threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class StereoBlockMatcher
+    {
+    public:
+        enum class CostFunction
+        {
+            Census,
+            SumOfAbsoluteDifferences
+        };
+
+        struct Options
+        {
+            Options();
+
+            CostFunction Cost;
+
+            // Disparities 0 to NumberOfDisparities - 1 are searched; must be a multiple
+            // of 16.
+            int32_t NumberOfDisparities;
+
+            // Blocks are (2 * BlockRadius + 1)^2 pixels, BlockRadius being 1 to 7.
+            int32_t BlockRadius;
+
+            // The winning cost must be lower than any other cost (but those of its two
+            // neighbors) by this percentage.
+            int32_t UniquenessRatio;
+
+            // Maximum difference, in pixels, between the left-to-right and right-to-left
+            // disparities; negative to skip the check.
+            int32_t LeftRightTolerance;
+
+            // Refines the disparities by fitting a parabola to the costs.
+            bool SubpixelRefinement;
+
+            // Number of bands matched in parallel; zero to pick one from the number of
+            // threads.
+            int32_t NumberOfBands;
+        };
+
+        struct FrameTimings
+        {
+            FrameTimings();
+
+            double CensusTimeInMilliseconds;
+            double MatchingTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+
+            // Fraction of the pixels with a valid disparity.
+            double ValidPixelFraction;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfPairs;
+            uint64_t NumberOfUnpairedFrames;
+
+            // Per-pair averages, and maximum per-pair latency.
+            double RectificationTimeInMilliseconds;
+            double MatchingTimeInMilliseconds;
+            double TotalTimeInMilliseconds;
+            double MaximumTotalTimeInMilliseconds;
+
+            double PairsPerSecond;
+            double ValidPixelFraction;
+        };
+
+        explicit StereoBlockMatcher(
+            _In_ const Options& options = Options());
+
+        const Options& GetOptions() const;
+
+        //
+        // Computes the disparity map (CV_32FC1) of the left image: for each pixel, the
+        // difference between its column and the column of the matching right image
+        // pixel, or NaN if no reliable match was found.
+        //
+        void Compute(
+            _In_ const cv::Mat& left,
+            _In_ const cv::Mat& right,
+            _Out_ cv::Mat& disparity);
+
+        const FrameTimings& GetLastFrameTimings() const;
+
+        //
+        // Pairs the frames recorded for the left front and right front visible light
+        // cameras by timestamp, rectifies them (the rectification is computed from the
+        // first pair) and matches them. At most the given number of pairs is processed,
+        // zero to process them all.
+        //
+        static bool BenchmarkRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const StereoRectifier::Options& rectifierOptions,
+            _In_ const Options& options,
+            _In_ size_t maximumNumberOfPairs,
+            _Out_ BenchmarkStatistics& statistics);
+
+        //
+        // Largest difference between the timestamps (in 100ns ticks) of a left and a
+        // right frame for them to be paired.
+        //
+        static const uint64_t MaximumPairingDelta = 10000;
+
+    private:
+        //
+        // Census transforms of the rows of an image: the 24-bit code of the pixels of row
+        // v are stored in rows 3v (least significant byte) to 3v + 2.
+        //
+        void ComputeCensus(
+            _In_ const cv::Mat& image,
+            _Out_ cv::Mat& census) const;
+
+        //
+        // Matches the rows [beginRow, endRow) of the images.
+        //
+        void MatchBand(
+            _In_ int32_t beginRow,
+            _In_ int32_t endRow,
+            _Out_ cv::Mat& disparity) const;
+
+        //
+        // Computes the costs of all the disparities of all the pixels of a row, as
+        // [column][disparity].
+        //
+        void ComputeRowCosts(
+            _In_ int32_t row,
+            _Out_writes_(_width * _options.NumberOfDisparities) uint8_t* costs) const;
+
+    private:
+        Options _options;
+
+        int32_t _width;
+        int32_t _height;
+
+        // Left image (or its census codes) and right image (or its census codes), the
+        // rows of the latter being reversed and padded with NumberOfDisparities elements,
+        // so that the right pixels matched with a left pixel are contiguous.
+        cv::Mat _left;
+        cv::Mat _reversedRight;
+
+        FrameTimings _lastFrameTimings;
+    };
+}
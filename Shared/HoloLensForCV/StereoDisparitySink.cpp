@@ -0,0 +1,49 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    StereoDisparitySink::StereoDisparitySink(
+        _In_ SensorType sensorType,
+        _In_ StereoDisparitySinkGroup^ sinkGroup,
+        _In_opt_ ISensorFrameSink^ downstreamSink)
+        : _sensorType(sensorType)
+        , _sinkGroup(sinkGroup)
+        , _downstreamSink(downstreamSink)
+    {
+    }
+
+    StereoDisparitySink::~StereoDisparitySink()
+    {
+    }
+
+    void StereoDisparitySink::Send(
+        _In_ SensorFrame^ sensorFrame)
+    {
+        StereoDisparitySinkGroup^ sinkGroup =
+            _sinkGroup.Resolve<StereoDisparitySinkGroup>();
+
+        if (nullptr != sinkGroup)
+        {
+            sinkGroup->ProcessFrame(
+                _sensorType,
+                sensorFrame);
+        }
+
+        if (nullptr != _downstreamSink)
+        {
+            _downstreamSink->Send(
+                sensorFrame);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    ref class StereoDisparitySinkGroup;
+
+    //
+    // Hands the frames of one of the front visible light cameras to a
+    // StereoDisparitySinkGroup, then passes them on to another sink, if any.
+    //
+    ref class StereoDisparitySink sealed
+        : public ISensorFrameSink
+    {
+    internal:
+        StereoDisparitySink(
+            _In_ SensorType sensorType,
+            _In_ StereoDisparitySinkGroup^ sinkGroup,
+            _In_opt_ ISensorFrameSink^ downstreamSink);
+
+    public:
+        virtual void Send(
+            _In_ SensorFrame^ sensorFrame);
+
+    private:
+        ~StereoDisparitySink();
+
+    private:
+        SensorType _sensorType;
+
+        // The sink group owns its sinks.
+        Platform::WeakReference _sinkGroup;
+
+        ISensorFrameSink^ _downstreamSink;
+    };
+}
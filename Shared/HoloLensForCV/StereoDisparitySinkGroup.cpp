@@ -0,0 +1,406 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        std::array<float, 16> ToArray(
+            _In_ const Windows::Foundation::Numerics::float4x4& matrix)
+        {
+            std::array<float, 16> values;
+
+            static_assert(
+                sizeof(values) == sizeof(matrix),
+                "float4x4 must hold 16 contiguous floats");
+
+            memcpy(
+                values.data(),
+                &matrix,
+                sizeof(values));
+
+            return values;
+        }
+
+        Platform::String^ ToPlatformString(
+            _In_ const std::string& value)
+        {
+            const std::wstring wideValue(
+                value.begin(),
+                value.end());
+
+            return ref new Platform::String(
+                wideValue.c_str());
+        }
+
+        //
+        // Index of the camera in the pair, or -1.
+        //
+        int32_t GetCameraIndex(
+            _In_ SensorType sensorType)
+        {
+            switch (sensorType)
+            {
+            case SensorType::VisibleLightLeftFront:
+                return 0;
+
+            case SensorType::VisibleLightRightFront:
+                return 1;
+
+            default:
+                return -1;
+            }
+        }
+    }
+
+    StereoDisparitySinkGroup::CameraFrame::CameraFrame()
+        : Timestamp(0)
+        , IsPaired(false)
+        , HasPose(false)
+    {
+    }
+
+    StereoDisparitySinkGroup::StereoDisparitySinkGroup(
+        _In_opt_ ISensorFrameSinkGroup^ downstreamSinkGroup)
+        : _downstreamSinkGroup(downstreamSinkGroup)
+    {
+    }
+
+    StereoDisparitySinkGroup::~StereoDisparitySinkGroup()
+    {
+    }
+
+    ISensorFrameSink^ StereoDisparitySinkGroup::GetSensorFrameSink(
+        _In_ SensorType sensorType)
+    {
+        ISensorFrameSink^ downstreamSink =
+            (nullptr != _downstreamSinkGroup) ?
+                _downstreamSinkGroup->GetSensorFrameSink(sensorType) :
+                nullptr;
+
+        const int32_t cameraIndex =
+            GetCameraIndex(sensorType);
+
+        if (cameraIndex < 0)
+        {
+            return downstreamSink;
+        }
+
+        std::lock_guard<std::mutex> guard(_sinkGroupMutex);
+
+        if (nullptr == _sensorFrameSinks[cameraIndex])
+        {
+            _sensorFrameSinks[cameraIndex] =
+                ref new StereoDisparitySink(
+                    sensorType,
+                    this,
+                    downstreamSink);
+        }
+
+        return _sensorFrameSinks[cameraIndex];
+    }
+
+    Windows::Graphics::Imaging::SoftwareBitmap^ StereoDisparitySinkGroup::GetDisparity()
+    {
+        std::lock_guard<std::mutex> guard(_stereoMutex);
+
+        if (_disparity.empty())
+        {
+            return nullptr;
+        }
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            ref new Windows::Graphics::Imaging::SoftwareBitmap(
+                Windows::Graphics::Imaging::BitmapPixelFormat::Gray16,
+                _disparity.cols,
+                _disparity.rows,
+                Windows::Graphics::Imaging::BitmapAlphaMode::Ignore);
+
+        {
+            Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+                softwareBitmap->LockBuffer(
+                    Windows::Graphics::Imaging::BitmapBufferAccessMode::Write);
+
+            const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+                bitmapBuffer->GetPlaneDescription(0);
+
+            Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+                bitmapBuffer->CreateReference();
+
+            uint32_t pixelBufferDataLength = 0;
+
+            uint8_t* pixelBufferData =
+                Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                    bitmapBufferReference,
+                    pixelBufferDataLength);
+
+            for (int32_t v = 0; v < _disparity.rows; ++v)
+            {
+                const float* disparityRow = _disparity.ptr<float>(v);
+
+                uint16_t* pixelRow = reinterpret_cast<uint16_t*>(
+                    pixelBufferData + bitmapPlaneDescription.StartIndex + v * bitmapPlaneDescription.Stride);
+
+                for (int32_t u = 0; u < _disparity.cols; ++u)
+                {
+                    pixelRow[u] = std::isnan(disparityRow[u]) ?
+                        0 :
+                        cv::saturate_cast<uint16_t>(disparityRow[u] * 16.0f);
+                }
+            }
+
+            delete bitmapBufferReference;
+            delete bitmapBuffer;
+        }
+
+        return softwareBitmap;
+    }
+
+    Platform::String^ StereoDisparitySinkGroup::GetStageTimingsAsJson()
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(6);
+
+        {
+            std::lock_guard<std::mutex> guard(_stereoMutex);
+
+            const double scale =
+                (_timings.NumberOfPairs > 0) ? 1.0 / _timings.NumberOfPairs : 0.0;
+
+            stream
+                << "{\"pairs\":" << _timings.NumberOfPairs
+                << ",\"unpaired_frames\":" << _timings.NumberOfUnpairedFrames
+                << ",\"focal_length_px\":" << ((nullptr != _rectifier) ? _rectifier->GetFocalLength() : 0.0f)
+                << ",\"baseline_m\":" << ((nullptr != _rectifier) ? _rectifier->GetBaseline() : 0.0f)
+                << ",\"rectification_ms\":" << _timings.RectificationTimeInMilliseconds * scale
+                << ",\"matching_ms\":" << _timings.MatchingTimeInMilliseconds * scale
+                << ",\"total_ms\":" << _timings.TotalTimeInMilliseconds * scale
+                << ",\"max_total_ms\":" << _timings.MaximumTotalTimeInMilliseconds
+                << ",\"valid_fraction\":" << _timings.ValidPixelFraction * scale
+                << "}";
+        }
+
+        return ToPlatformString(
+            stream.str());
+    }
+
+    void StereoDisparitySinkGroup::ProcessFrame(
+        _In_ SensorType sensorType,
+        _In_ SensorFrame^ sensorFrame)
+    {
+        const int32_t cameraIndex =
+            GetCameraIndex(sensorType);
+
+        Windows::Graphics::Imaging::SoftwareBitmap^ softwareBitmap =
+            sensorFrame->SoftwareBitmap;
+
+        if (cameraIndex < 0 ||
+            nullptr == softwareBitmap)
+        {
+            return;
+        }
+
+        //
+        // The visible light cameras are grayscale, but their frames are packed as 32bpp
+        // BGRA images.
+        //
+        int32_t imageWidth;
+
+        switch (softwareBitmap->BitmapPixelFormat)
+        {
+        case Windows::Graphics::Imaging::BitmapPixelFormat::Bgra8:
+            imageWidth = softwareBitmap->PixelWidth * 4;
+            break;
+
+        case Windows::Graphics::Imaging::BitmapPixelFormat::Gray8:
+            imageWidth = softwareBitmap->PixelWidth;
+            break;
+
+        default:
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(_stereoMutex);
+
+        CameraFrame& cameraFrame =
+            _cameraFrames[cameraIndex];
+
+        //
+        // The same frame may be delivered more than once; process it only once.
+        //
+        if (cameraFrame.Timestamp == sensorFrame->Timestamp.UniversalTime)
+        {
+            return;
+        }
+
+        if (0 != cameraFrame.Timestamp &&
+            !cameraFrame.IsPaired)
+        {
+            ++_timings.NumberOfUnpairedFrames;
+        }
+
+        cameraFrame.Timestamp = sensorFrame->Timestamp.UniversalTime;
+        cameraFrame.IsPaired = false;
+
+        cameraFrame.Intrinsics = sensorFrame->SensorStreamingCameraIntrinsics;
+
+        cameraFrame.HasPose =
+            PointCloudGenerator::ComputeCameraToWorld(
+                ToArray(sensorFrame->FrameToOrigin),
+                ToArray(sensorFrame->CameraViewTransform),
+                cameraFrame.CameraToWorld);
+
+        {
+            Windows::Graphics::Imaging::BitmapBuffer^ bitmapBuffer =
+                softwareBitmap->LockBuffer(
+                    Windows::Graphics::Imaging::BitmapBufferAccessMode::Read);
+
+            const Windows::Graphics::Imaging::BitmapPlaneDescription bitmapPlaneDescription =
+                bitmapBuffer->GetPlaneDescription(0);
+
+            Windows::Foundation::IMemoryBufferReference^ bitmapBufferReference =
+                bitmapBuffer->CreateReference();
+
+            uint32_t pixelBufferDataLength = 0;
+
+            uint8_t* pixelBufferData =
+                Io::GetTypedPointerToMemoryBuffer<uint8_t>(
+                    bitmapBufferReference,
+                    pixelBufferDataLength);
+
+            //
+            // The bitmap is recycled by the media frame reader: keep a copy.
+            //
+            cv::Mat(
+                softwareBitmap->PixelHeight,
+                imageWidth,
+                CV_8UC1,
+                pixelBufferData + bitmapPlaneDescription.StartIndex,
+                bitmapPlaneDescription.Stride).copyTo(
+                    cameraFrame.Image);
+
+            delete bitmapBufferReference;
+            delete bitmapBuffer;
+        }
+
+        CameraFrame& leftFrame = _cameraFrames[0];
+        CameraFrame& rightFrame = _cameraFrames[1];
+
+        if (0 == leftFrame.Timestamp ||
+            0 == rightFrame.Timestamp ||
+            std::abs(leftFrame.Timestamp - rightFrame.Timestamp) > static_cast<int64_t>(StereoBlockMatcher::MaximumPairingDelta) ||
+            leftFrame.Image.size() != rightFrame.Image.size())
+        {
+            return;
+        }
+
+        if (nullptr == _rectifier &&
+            !CreateRectifier())
+        {
+            return;
+        }
+
+        leftFrame.IsPaired = rightFrame.IsPaired = true;
+
+        ComputeDisparity();
+    }
+
+    bool StereoDisparitySinkGroup::CreateRectifier()
+    {
+        const CameraFrame& leftFrame = _cameraFrames[0];
+        const CameraFrame& rightFrame = _cameraFrames[1];
+
+        if (nullptr == leftFrame.Intrinsics ||
+            nullptr == rightFrame.Intrinsics ||
+            !leftFrame.HasPose ||
+            !rightFrame.HasPose)
+        {
+            return false;
+        }
+
+        cv::Mat leftUnitPlaneMap, rightUnitPlaneMap;
+
+        if (!leftFrame.Intrinsics->ComputeUnitPlaneMap(leftUnitPlaneMap) ||
+            !rightFrame.Intrinsics->ComputeUnitPlaneMap(rightUnitPlaneMap) ||
+            leftUnitPlaneMap.size() != leftFrame.Image.size() ||
+            rightUnitPlaneMap.size() != rightFrame.Image.size())
+        {
+            return false;
+        }
+
+        std::unique_ptr<StereoRectifier> rectifier(
+            new StereoRectifier());
+
+        if (!rectifier->Initialize(
+                leftUnitPlaneMap,
+                rightUnitPlaneMap,
+                leftFrame.CameraToWorld,
+                rightFrame.CameraToWorld))
+        {
+            dbg::trace(
+                L"StereoDisparitySinkGroup::CreateRectifier: the front cameras cannot be rectified");
+
+            return false;
+        }
+
+        _rectifier = std::move(rectifier);
+
+        return true;
+    }
+
+    void StereoDisparitySinkGroup::ComputeDisparity()
+    {
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        _rectifier->Rectify(
+            _cameraFrames[0].Image,
+            _cameraFrames[1].Image,
+            _rectifiedLeft,
+            _rectifiedRight);
+
+        const std::chrono::steady_clock::time_point rectifiedTime =
+            std::chrono::steady_clock::now();
+
+        _matcher.Compute(
+            _rectifiedLeft,
+            _rectifiedRight,
+            _disparity);
+
+        const std::chrono::steady_clock::time_point endTime =
+            std::chrono::steady_clock::now();
+
+        const double totalTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        ++_timings.NumberOfPairs;
+
+        _timings.RectificationTimeInMilliseconds +=
+            std::chrono::duration<double, std::milli>(rectifiedTime - startTime).count();
+
+        _timings.MatchingTimeInMilliseconds +=
+            std::chrono::duration<double, std::milli>(endTime - rectifiedTime).count();
+
+        _timings.TotalTimeInMilliseconds += totalTimeInMilliseconds;
+
+        _timings.MaximumTotalTimeInMilliseconds =
+            std::max(
+                _timings.MaximumTotalTimeInMilliseconds,
+                totalTimeInMilliseconds);
+
+        _timings.ValidPixelFraction +=
+            _matcher.GetLastFrameTimings().ValidPixelFraction;
+    }
+}
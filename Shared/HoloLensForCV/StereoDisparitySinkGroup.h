@@ -0,0 +1,101 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Computes disparity maps from the front visible light cameras (see StereoRectifier
+    // and StereoBlockMatcher). Frames of the two cameras are paired by timestamp; the
+    // rectification is computed from the cameras' intrinsics and poses when the first
+    // pair arrives. Frames are then passed on to the sinks of another sink group, if any:
+    //
+    //     ref new MediaFrameSourceGroup(
+    //         ...,
+    //         ref new StereoDisparitySinkGroup(sensorFrameStreamer));
+    //
+    // The last disparity map can be polled at any time.
+    //
+    public ref class StereoDisparitySinkGroup sealed
+        : public ISensorFrameSinkGroup
+    {
+    public:
+        StereoDisparitySinkGroup(
+            _In_opt_ ISensorFrameSinkGroup^ downstreamSinkGroup);
+
+        virtual ISensorFrameSink^ GetSensorFrameSink(
+            _In_ SensorType sensorType);
+
+        //
+        // Returns the last disparity map, in the rectified left camera, as a Gray16 bitmap
+        // holding disparities in 1/16 pixels, zero where no reliable match was found.
+        // Returns nullptr before the first pair.
+        //
+        Windows::Graphics::Imaging::SoftwareBitmap^ GetDisparity();
+
+        //
+        // Returns the rectified cameras' focal length (pixels) and baseline (meters), and
+        // the average per-pair latency of each stage, as JSON.
+        //
+        Platform::String^ GetStageTimingsAsJson();
+
+    internal:
+        void ProcessFrame(
+            _In_ SensorType sensorType,
+            _In_ SensorFrame^ sensorFrame);
+
+    private:
+        ~StereoDisparitySinkGroup();
+
+        bool CreateRectifier();
+
+        void ComputeDisparity();
+
+    private:
+        //
+        // The last frame of each camera, left front then right front.
+        //
+        struct CameraFrame
+        {
+            CameraFrame();
+
+            int64_t Timestamp;
+
+            // Frames that are replaced before being paired are counted as unpaired.
+            bool IsPaired;
+
+            cv::Mat Image;
+
+            bool HasPose;
+            cv::Matx44f CameraToWorld;
+
+            CameraIntrinsics^ Intrinsics;
+        };
+
+        std::mutex _sinkGroupMutex;
+
+        ISensorFrameSinkGroup^ _downstreamSinkGroup;
+
+        std::array<ISensorFrameSink^, 2> _sensorFrameSinks;
+
+        std::mutex _stereoMutex;
+
+        std::array<CameraFrame, 2> _cameraFrames;
+
+        std::unique_ptr<StereoRectifier> _rectifier;
+        StereoBlockMatcher _matcher;
+
+        cv::Mat _rectifiedLeft, _rectifiedRight, _disparity;
+
+        StereoBlockMatcher::BenchmarkStatistics _timings;
+    };
+}
@@ -0,0 +1,612 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        // Resolution of the coarse inverse of the unit plane maps, used to seed Newton.
+        const int32_t c_seedGridSize = 64;
+        const int32_t c_seedSampleStep = 2;
+
+        // Largest Newton step, in pixels.
+        const float c_maximumStepInPixels = 8.0f;
+
+        // Remap coordinates of the rectified pixels that do not see the source image.
+        const float c_invalidCoordinate = -16.0f;
+
+        //
+        // Bilinearly interpolates a unit plane map and its derivatives. Fails if one of
+        // the surrounding pixels has no valid mapping.
+        //
+        bool SampleUnitPlaneMap(
+            _In_ const cv::Mat& unitPlaneMap,
+            _In_ float u,
+            _In_ float v,
+            _Out_ cv::Vec2f& xy,
+            _Out_ cv::Matx22f& jacobian)
+        {
+            const int32_t u0 =
+                std::min(std::max(static_cast<int32_t>(std::floor(u)), 0), unitPlaneMap.cols - 2);
+
+            const int32_t v0 =
+                std::min(std::max(static_cast<int32_t>(std::floor(v)), 0), unitPlaneMap.rows - 2);
+
+            const cv::Vec2f* row0 = unitPlaneMap.ptr<cv::Vec2f>(v0) + u0;
+            const cv::Vec2f* row1 = unitPlaneMap.ptr<cv::Vec2f>(v0 + 1) + u0;
+
+            const cv::Vec2f& p00 = row0[0];
+            const cv::Vec2f& p10 = row0[1];
+            const cv::Vec2f& p01 = row1[0];
+            const cv::Vec2f& p11 = row1[1];
+
+            if (!std::isfinite(p00[0]) || !std::isfinite(p10[0]) ||
+                !std::isfinite(p01[0]) || !std::isfinite(p11[0]))
+            {
+                return false;
+            }
+
+            const float a = u - u0;
+            const float b = v - v0;
+
+            const cv::Vec2f du = (p10 - p00) * (1.0f - b) + (p11 - p01) * b;
+            const cv::Vec2f dv = (p01 - p00) * (1.0f - a) + (p11 - p10) * a;
+
+            xy = p00 + (p10 - p00) * a + (p01 - p00) * b + (p11 - p10 - p01 + p00) * (a * b);
+
+            jacobian = cv::Matx22f(
+                du[0], dv[0],
+                du[1], dv[1]);
+
+            return true;
+        }
+
+        //
+        // Solves unitPlaneMap(u, v) = target for (u, v), starting from the given point.
+        //
+        bool SolveImagePoint(
+            _In_ const cv::Mat& unitPlaneMap,
+            _In_ const cv::Vec2f& target,
+            _In_ int32_t maximumNumberOfIterations,
+            _In_ float tolerance,
+            _Inout_ cv::Point2f& imagePoint)
+        {
+            cv::Point2f point = imagePoint;
+
+            for (int32_t iteration = 0; iteration < maximumNumberOfIterations; ++iteration)
+            {
+                cv::Vec2f xy;
+                cv::Matx22f jacobian;
+
+                if (!SampleUnitPlaneMap(unitPlaneMap, point.x, point.y, xy, jacobian))
+                {
+                    return false;
+                }
+
+                const float determinant =
+                    jacobian(0, 0) * jacobian(1, 1) - jacobian(0, 1) * jacobian(1, 0);
+
+                if (0.0f == determinant)
+                {
+                    return false;
+                }
+
+                const cv::Vec2f residual = target - xy;
+
+                cv::Point2f step(
+                    (jacobian(1, 1) * residual[0] - jacobian(0, 1) * residual[1]) / determinant,
+                    (jacobian(0, 0) * residual[1] - jacobian(1, 0) * residual[0]) / determinant);
+
+                const float stepLength =
+                    std::sqrt(step.x * step.x + step.y * step.y);
+
+                if (stepLength > c_maximumStepInPixels)
+                {
+                    step *= c_maximumStepInPixels / stepLength;
+                }
+
+                point += step;
+
+                if (stepLength < tolerance)
+                {
+                    if (point.x < 0.0f || point.x > unitPlaneMap.cols - 1.0f ||
+                        point.y < 0.0f || point.y > unitPlaneMap.rows - 1.0f)
+                    {
+                        return false;
+                    }
+
+                    imagePoint = point;
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        //
+        // Average focal length, in pixels, and orientation (the sign of the determinant of
+        // the derivatives) of a unit plane map at its center.
+        //
+        bool ComputeFocalLength(
+            _In_ const cv::Mat& unitPlaneMap,
+            _Out_ float& focalLength,
+            _Out_ float& orientation)
+        {
+            cv::Vec2f xy;
+            cv::Matx22f jacobian;
+
+            if (!SampleUnitPlaneMap(
+                    unitPlaneMap,
+                    0.5f * (unitPlaneMap.cols - 1),
+                    0.5f * (unitPlaneMap.rows - 1),
+                    xy,
+                    jacobian))
+            {
+                return false;
+            }
+
+            const float determinant =
+                jacobian(0, 0) * jacobian(1, 1) - jacobian(0, 1) * jacobian(1, 0);
+
+            if (0.0f == determinant)
+            {
+                return false;
+            }
+
+            focalLength = 1.0f / std::sqrt(std::abs(determinant));
+            orientation = (determinant > 0.0f) ? 1.0f : -1.0f;
+
+            return true;
+        }
+    }
+
+    StereoRectifier::Options::Options()
+        : RectifiedWidth(0)
+        , RectifiedHeight(0)
+        , FocalLengthScale(1.0f)
+        , MaximumNumberOfIterations(20)
+        , ToleranceInPixels(0.01f)
+    {
+    }
+
+    StereoRectifier::StereoRectifier()
+        : _isInitialized(false)
+        , _focalLength(0.0f)
+        , _baseline(0.0f)
+        , _leftRotation(cv::Matx33f::eye())
+        , _overlap(0.0f)
+    {
+    }
+
+    bool StereoRectifier::Initialize(
+        _In_ const cv::Mat& leftUnitPlaneMap,
+        _In_ const cv::Mat& rightUnitPlaneMap,
+        _In_ const cv::Matx44f& leftCameraToWorld,
+        _In_ const cv::Matx44f& rightCameraToWorld,
+        _In_ const Options& options)
+    {
+        REQUIRES(
+            CV_32FC2 == leftUnitPlaneMap.type() &&
+            CV_32FC2 == rightUnitPlaneMap.type() &&
+            leftUnitPlaneMap.size() == rightUnitPlaneMap.size() &&
+            leftUnitPlaneMap.cols >= 2 &&
+            leftUnitPlaneMap.rows >= 2);
+
+        _isInitialized = false;
+        _options = options;
+
+        _sourceSize = leftUnitPlaneMap.size();
+
+        _rectifiedSize = cv::Size(
+            (options.RectifiedWidth > 0) ? options.RectifiedWidth : _sourceSize.width,
+            (options.RectifiedHeight > 0) ? options.RectifiedHeight : _sourceSize.height);
+
+        //
+        // Pose of the right camera in the left camera coordinate system.
+        //
+        const cv::Matx44d leftToRight =
+            cv::Matx44d(leftCameraToWorld).inv() * cv::Matx44d(rightCameraToWorld);
+
+        const cv::Matx33d rightToLeftRotation(
+            leftToRight(0, 0), leftToRight(0, 1), leftToRight(0, 2),
+            leftToRight(1, 0), leftToRight(1, 1), leftToRight(1, 2),
+            leftToRight(2, 0), leftToRight(2, 1), leftToRight(2, 2));
+
+        const cv::Vec3d rightPosition(
+            leftToRight(0, 3),
+            leftToRight(1, 3),
+            leftToRight(2, 3));
+
+        _baseline = static_cast<float>(
+            cv::norm(rightPosition));
+
+        float leftFocalLength, rightFocalLength;
+        float leftOrientation, rightOrientation;
+
+        if (_baseline < 1e-3f ||
+            !ComputeFocalLength(leftUnitPlaneMap, leftFocalLength, leftOrientation) ||
+            !ComputeFocalLength(rightUnitPlaneMap, rightFocalLength, rightOrientation))
+        {
+            return false;
+        }
+
+        //
+        // The rectified X axis is the baseline and the rectified Z axis is the average of
+        // the cameras' Z axes, made orthogonal to the baseline.
+        //
+        const cv::Vec3d e1 =
+            rightPosition * (1.0 / _baseline);
+
+        const cv::Vec3d averageZ =
+            cv::normalize(cv::Vec3d(0.0, 0.0, 1.0) + rightToLeftRotation * cv::Vec3d(0.0, 0.0, 1.0));
+
+        const cv::Vec3d orthogonalZ =
+            averageZ - e1 * averageZ.dot(e1);
+
+        if (cv::norm(orthogonalZ) < 1e-3)
+        {
+            return false;
+        }
+
+        const cv::Vec3d e3 = cv::normalize(orthogonalZ);
+        const cv::Vec3d e2 = e3.cross(e1);
+
+        _leftRotation = cv::Matx33f(
+            static_cast<float>(e1[0]), static_cast<float>(e1[1]), static_cast<float>(e1[2]),
+            static_cast<float>(e2[0]), static_cast<float>(e2[1]), static_cast<float>(e2[2]),
+            static_cast<float>(e3[0]), static_cast<float>(e3[1]), static_cast<float>(e3[2]));
+
+        _focalLength =
+            0.5f * (leftFocalLength + rightFocalLength) * options.FocalLengthScale;
+
+        _principalPoint = cv::Point2f(
+            0.5f * (_rectifiedSize.width - 1),
+            0.5f * (_rectifiedSize.height - 1));
+
+        //
+        // Rays are -(x, y, 1) in unit plane coordinates. With the baseline along +X, the
+        // right camera sees points at larger x, so u must decrease with x for disparities
+        // to be positive; v is oriented so that the rectified images are not mirrored with
+        // respect to the left image.
+        //
+        const float signX = -1.0f;
+        const float signY = -leftOrientation;
+
+        const cv::Matx33f rectifiedToLeft =
+            _leftRotation.t();
+
+        const cv::Matx33f rectifiedToRight =
+            cv::Matx33f(rightToLeftRotation.t()) * rectifiedToLeft;
+
+        const float infinity =
+            std::numeric_limits<float>::infinity();
+
+        cv::Mat leftTargets(_rectifiedSize, CV_32FC2);
+        cv::Mat rightTargets(_rectifiedSize, CV_32FC2);
+
+        for (int32_t v = 0; v < _rectifiedSize.height; ++v)
+        {
+            cv::Vec2f* leftRow = leftTargets.ptr<cv::Vec2f>(v);
+            cv::Vec2f* rightRow = rightTargets.ptr<cv::Vec2f>(v);
+
+            for (int32_t u = 0; u < _rectifiedSize.width; ++u)
+            {
+                const cv::Vec3f ray(
+                    -signX * (u - _principalPoint.x) / _focalLength,
+                    -signY * (v - _principalPoint.y) / _focalLength,
+                    -1.0f);
+
+                const cv::Vec3f leftRay = rectifiedToLeft * ray;
+                const cv::Vec3f rightRay = rectifiedToRight * ray;
+
+                leftRow[u] = (leftRay[2] < 0.0f) ?
+                    cv::Vec2f(leftRay[0] / leftRay[2], leftRay[1] / leftRay[2]) :
+                    cv::Vec2f(infinity, infinity);
+
+                rightRow[u] = (rightRay[2] < 0.0f) ?
+                    cv::Vec2f(rightRay[0] / rightRay[2], rightRay[1] / rightRay[2]) :
+                    cv::Vec2f(infinity, infinity);
+            }
+        }
+
+        cv::Mat leftValid, rightValid;
+
+        InvertUnitPlaneMap(
+            leftUnitPlaneMap,
+            leftTargets,
+            _leftMap1,
+            _leftMap2,
+            leftValid);
+
+        InvertUnitPlaneMap(
+            rightUnitPlaneMap,
+            rightTargets,
+            _rightMap1,
+            _rightMap2,
+            rightValid);
+
+        cv::Mat bothValid;
+
+        cv::bitwise_and(
+            leftValid,
+            rightValid,
+            bothValid);
+
+        _overlap =
+            static_cast<float>(cv::countNonZero(bothValid)) /
+            static_cast<float>(_rectifiedSize.area());
+
+        _isInitialized = (_overlap > 0.0f);
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "StereoRectifier",
+            dbg::LogLevel::Information,
+            L"StereoRectifier::Initialize: %ix%i, f=%.2f px, baseline=%.4f m, overlap=%.1f%%",
+            _rectifiedSize.width,
+            _rectifiedSize.height,
+            _focalLength,
+            _baseline,
+            _overlap * 100.0f);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return _isInitialized;
+    }
+
+    bool StereoRectifier::IsInitialized() const
+    {
+        return _isInitialized;
+    }
+
+    cv::Size StereoRectifier::GetRectifiedSize() const
+    {
+        return _rectifiedSize;
+    }
+
+    cv::Size StereoRectifier::GetSourceSize() const
+    {
+        return _sourceSize;
+    }
+
+    float StereoRectifier::GetFocalLength() const
+    {
+        return _focalLength;
+    }
+
+    cv::Point2f StereoRectifier::GetPrincipalPoint() const
+    {
+        return _principalPoint;
+    }
+
+    float StereoRectifier::GetBaseline() const
+    {
+        return _baseline;
+    }
+
+    const cv::Matx33f& StereoRectifier::GetLeftRotation() const
+    {
+        return _leftRotation;
+    }
+
+    float StereoRectifier::GetOverlap() const
+    {
+        return _overlap;
+    }
+
+    void StereoRectifier::Rectify(
+        _In_ const cv::Mat& left,
+        _In_ const cv::Mat& right,
+        _Out_ cv::Mat& rectifiedLeft,
+        _Out_ cv::Mat& rectifiedRight) const
+    {
+        REQUIRES(
+            _isInitialized &&
+            CV_8UC1 == left.type() &&
+            CV_8UC1 == right.type() &&
+            left.size() == _sourceSize &&
+            right.size() == _sourceSize);
+
+        cv::remap(
+            left,
+            rectifiedLeft,
+            _leftMap1,
+            _leftMap2,
+            cv::INTER_LINEAR,
+            cv::BORDER_CONSTANT,
+            cv::Scalar());
+
+        cv::remap(
+            right,
+            rectifiedRight,
+            _rightMap1,
+            _rightMap2,
+            cv::INTER_LINEAR,
+            cv::BORDER_CONSTANT,
+            cv::Scalar());
+    }
+
+    void StereoRectifier::InvertUnitPlaneMap(
+        _In_ const cv::Mat& unitPlaneMap,
+        _In_ const cv::Mat& targets,
+        _Out_ cv::Mat& map1,
+        _Out_ cv::Mat& map2,
+        _Out_ cv::Mat& valid) const
+    {
+        //
+        // Coarse inverse: a grid over the bounding box of the unit plane coordinates,
+        // each cell holding a source pixel that maps into it.
+        //
+        float minimumX = std::numeric_limits<float>::max(), maximumX = -minimumX;
+        float minimumY = minimumX, maximumY = maximumX;
+
+        for (int32_t v = 0; v < unitPlaneMap.rows; ++v)
+        {
+            const cv::Vec2f* row = unitPlaneMap.ptr<cv::Vec2f>(v);
+
+            for (int32_t u = 0; u < unitPlaneMap.cols; ++u)
+            {
+                if (std::isfinite(row[u][0]) && std::isfinite(row[u][1]))
+                {
+                    minimumX = std::min(minimumX, row[u][0]);
+                    maximumX = std::max(maximumX, row[u][0]);
+                    minimumY = std::min(minimumY, row[u][1]);
+                    maximumY = std::max(maximumY, row[u][1]);
+                }
+            }
+        }
+
+        const float seedScaleX =
+            c_seedGridSize / std::max(maximumX - minimumX, 1e-6f);
+
+        const float seedScaleY =
+            c_seedGridSize / std::max(maximumY - minimumY, 1e-6f);
+
+        std::vector<cv::Point2f> seeds(
+            c_seedGridSize * c_seedGridSize,
+            cv::Point2f(-1.0f, -1.0f));
+
+        for (int32_t v = 0; v < unitPlaneMap.rows; v += c_seedSampleStep)
+        {
+            const cv::Vec2f* row = unitPlaneMap.ptr<cv::Vec2f>(v);
+
+            for (int32_t u = 0; u < unitPlaneMap.cols; u += c_seedSampleStep)
+            {
+                if (!std::isfinite(row[u][0]) || !std::isfinite(row[u][1]))
+                {
+                    continue;
+                }
+
+                const int32_t i = std::min(static_cast<int32_t>((row[u][0] - minimumX) * seedScaleX), c_seedGridSize - 1);
+                const int32_t j = std::min(static_cast<int32_t>((row[u][1] - minimumY) * seedScaleY), c_seedGridSize - 1);
+
+                seeds[j * c_seedGridSize + i] = cv::Point2f(
+                    static_cast<float>(u),
+                    static_cast<float>(v));
+            }
+        }
+
+        const auto findSeed = [&](const cv::Vec2f& target, cv::Point2f& seed)
+        {
+            const int32_t i = static_cast<int32_t>(std::floor((target[0] - minimumX) * seedScaleX));
+            const int32_t j = static_cast<int32_t>(std::floor((target[1] - minimumY) * seedScaleY));
+
+            for (int32_t dj = -1; dj <= 1; ++dj)
+            {
+                for (int32_t di = -1; di <= 1; ++di)
+                {
+                    if (i + di < 0 || i + di >= c_seedGridSize ||
+                        j + dj < 0 || j + dj >= c_seedGridSize)
+                    {
+                        continue;
+                    }
+
+                    const cv::Point2f& candidate =
+                        seeds[(j + dj) * c_seedGridSize + i + di];
+
+                    if (candidate.x >= 0.0f)
+                    {
+                        seed = candidate;
+
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        };
+
+        cv::Mat mapX(targets.size(), CV_32FC1);
+        cv::Mat mapY(targets.size(), CV_32FC1);
+
+        valid.create(targets.size(), CV_8UC1);
+
+        cv::parallel_for_(
+            cv::Range(0, targets.rows),
+            [&](const cv::Range& range)
+        {
+            for (int32_t v = range.start; v < range.end; ++v)
+            {
+                const cv::Vec2f* targetRow = targets.ptr<cv::Vec2f>(v);
+
+                float* mapXRow = mapX.ptr<float>(v);
+                float* mapYRow = mapY.ptr<float>(v);
+                uint8_t* validRow = valid.ptr<uint8_t>(v);
+
+                //
+                // Neighboring rectified pixels map to neighboring source points, so the
+                // previous solution of the row is the best starting point.
+                //
+                bool hasPrevious = false;
+                cv::Point2f previous;
+
+                for (int32_t u = 0; u < targets.cols; ++u)
+                {
+                    const cv::Vec2f& target = targetRow[u];
+
+                    cv::Point2f imagePoint;
+
+                    bool solved = false;
+
+                    if (std::isfinite(target[0]) && std::isfinite(target[1]))
+                    {
+                        if (hasPrevious)
+                        {
+                            imagePoint = previous;
+
+                            solved = SolveImagePoint(
+                                unitPlaneMap,
+                                target,
+                                _options.MaximumNumberOfIterations,
+                                _options.ToleranceInPixels,
+                                imagePoint);
+                        }
+
+                        if (!solved && findSeed(target, imagePoint))
+                        {
+                            solved = SolveImagePoint(
+                                unitPlaneMap,
+                                target,
+                                _options.MaximumNumberOfIterations,
+                                _options.ToleranceInPixels,
+                                imagePoint);
+                        }
+                    }
+
+                    hasPrevious = solved;
+
+                    if (solved)
+                    {
+                        previous = imagePoint;
+
+                        mapXRow[u] = imagePoint.x;
+                        mapYRow[u] = imagePoint.y;
+                        validRow[u] = 255;
+                    }
+                    else
+                    {
+                        mapXRow[u] = mapYRow[u] = c_invalidCoordinate;
+                        validRow[u] = 0;
+                    }
+                }
+            }
+        });
+
+        cv::convertMaps(
+            mapX,
+            mapY,
+            map1,
+            map2,
+            CV_16SC2);
+    }
+}
@@ -0,0 +1,134 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Rectifies the images of a stereo pair of cameras (e.g. the left front and right front
+    // visible light cameras), so that corresponding points lie on the same row and the
+    // left image point is to the right of the right image point (positive disparity).
+    //
+    // Both cameras are rotated to a common orientation, whose X axis is the baseline and
+    // whose viewing direction is the average of the cameras' viewing directions, and share
+    // the same pinhole model. As the cameras are described by their unit plane maps (see
+    // CameraProjectionModel), the remap tables are computed by inverting those maps
+    // numerically, once, in Initialize; rectifying a pair of images is then a table lookup
+    // with bilinear interpolation.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class StereoRectifier
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Size of the rectified images; zero to use the size of the source images.
+            int32_t RectifiedWidth;
+            int32_t RectifiedHeight;
+
+            // Scales the focal length of the rectified cameras, which is by default the
+            // average focal length of the source cameras at their image center. Values
+            // below one keep more of the source images in the rectified images.
+            float FocalLengthScale;
+
+            // Newton iterations used to invert the unit plane maps.
+            int32_t MaximumNumberOfIterations;
+            float ToleranceInPixels;
+        };
+
+        StereoRectifier();
+
+        //
+        // Computes the remap tables. The unit plane maps are CV_32FC2 images holding the
+        // (x, y) unit plane coordinates of each pixel, +infinity for pixels without a valid
+        // mapping, and the poses are the camera-to-world transforms of a pair of frames
+        // (the cameras are rigidly mounted, so any pair will do). Fails if the cameras
+        // do not overlap or share the same position.
+        //
+        bool Initialize(
+            _In_ const cv::Mat& leftUnitPlaneMap,
+            _In_ const cv::Mat& rightUnitPlaneMap,
+            _In_ const cv::Matx44f& leftCameraToWorld,
+            _In_ const cv::Matx44f& rightCameraToWorld,
+            _In_ const Options& options = Options());
+
+        bool IsInitialized() const;
+
+        cv::Size GetRectifiedSize() const;
+
+        cv::Size GetSourceSize() const;
+
+        //
+        // Pinhole model of the rectified cameras, in pixels, and distance between the
+        // cameras, in meters: a disparity d corresponds to a depth of f * b / d.
+        //
+        float GetFocalLength() const;
+
+        cv::Point2f GetPrincipalPoint() const;
+
+        float GetBaseline() const;
+
+        //
+        // Rotation from the left camera coordinate system to the rectified one.
+        //
+        const cv::Matx33f& GetLeftRotation() const;
+
+        //
+        // Rectifies a pair of 8-bit images. Rectified pixels that do not see the source
+        // images are set to zero.
+        //
+        void Rectify(
+            _In_ const cv::Mat& left,
+            _In_ const cv::Mat& right,
+            _Out_ cv::Mat& rectifiedLeft,
+            _Out_ cv::Mat& rectifiedRight) const;
+
+        //
+        // Fraction of the rectified pixels that see both source images.
+        //
+        float GetOverlap() const;
+
+    private:
+        //
+        // Finds, for each rectified pixel, the source image point whose unit plane
+        // coordinates are the given ones, and packs the result as fixed point tables.
+        //
+        void InvertUnitPlaneMap(
+            _In_ const cv::Mat& unitPlaneMap,
+            _In_ const cv::Mat& targets,
+            _Out_ cv::Mat& map1,
+            _Out_ cv::Mat& map2,
+            _Out_ cv::Mat& valid) const;
+
+    private:
+        Options _options;
+
+        bool _isInitialized;
+
+        cv::Size _sourceSize;
+        cv::Size _rectifiedSize;
+
+        float _focalLength;
+        cv::Point2f _principalPoint;
+        float _baseline;
+
+        cv::Matx33f _leftRotation;
+
+        float _overlap;
+
+        cv::Mat _leftMap1, _leftMap2;
+        cv::Mat _rightMap1, _rightMap2;
+    };
+}
@@ -0,0 +1,67 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        std::string MakeServerMetricName(
+            _In_z_ const char* prefix,
+            _In_z_ const char* name,
+            _In_ Platform::String^ serviceName)
+        {
+            return dbg::MakeMetricName(
+                (std::string(prefix) + name).c_str(),
+                "service",
+                serviceName->Data());
+        }
+    }
+
+    uint64_t GetMicrosecondsSinceCapture(
+        _In_ const Windows::Foundation::DateTime& timestamp)
+    {
+        FILETIME now;
+
+        GetSystemTimePreciseAsFileTime(
+            &now);
+
+        const int64_t nowInHundredsOfNanoseconds =
+            static_cast<int64_t>(
+                now.dwLowDateTime + (static_cast<uint64_t>(now.dwHighDateTime) << 32));
+
+        const int64_t elapsedTimeInHundredsOfNanoseconds =
+            nowInHundredsOfNanoseconds - timestamp.UniversalTime;
+
+        return (elapsedTimeInHundredsOfNanoseconds > 0) ?
+            static_cast<uint64_t>(elapsedTimeInHundredsOfNanoseconds / 10) :
+            0;
+    }
+
+    StreamingServerMetrics::StreamingServerMetrics(
+        _In_z_ const char* prefix,
+        _In_ Platform::String^ serviceName)
+        : _framesSent(
+            dbg::Metrics::GetCounter(
+                MakeServerMetricName(prefix, "_frames_sent_total", serviceName)))
+        , _framesDropped(
+            dbg::Metrics::GetCounter(
+                MakeServerMetricName(prefix, "_frames_dropped_total", serviceName)))
+        , _bytesSent(
+            dbg::Metrics::GetCounter(
+                MakeServerMetricName(prefix, "_bytes_sent_total", serviceName)))
+        , _captureToSendLatency(
+            dbg::Metrics::GetHistogram(
+                MakeServerMetricName(prefix, "_capture_to_send_latency_microseconds", serviceName)))
+    {
+    }
+}
@@ -0,0 +1,63 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Returns the time elapsed since the exposure of a frame, given its timestamp, in
+    // microseconds; zero if the timestamp lies in the future.
+    //
+    uint64_t GetMicrosecondsSinceCapture(
+        _In_ const Windows::Foundation::DateTime& timestamp);
+
+    //
+    // The metrics (see dbg::Metrics) of a server streaming sensor frames to a client,
+    // labelled with the server's service name:
+    //
+    //   <prefix>_frames_sent_total
+    //   <prefix>_frames_dropped_total -- a previous send was still in progress
+    //   <prefix>_bytes_sent_total
+    //   <prefix>_capture_to_send_latency_microseconds -- from exposure until the
+    //       frame was handed to the network stack
+    //
+    class StreamingServerMetrics
+    {
+    public:
+        StreamingServerMetrics(
+            _In_z_ const char* prefix,
+            _In_ Platform::String^ serviceName);
+
+        void OnFrameDropped()
+        {
+            _framesDropped.Increment();
+        }
+
+        void OnFrameSent(
+            _In_ const Windows::Foundation::DateTime& timestamp,
+            _In_ const uint64_t numberOfBytes)
+        {
+            _framesSent.Increment();
+            _bytesSent.Increment(numberOfBytes);
+
+            _captureToSendLatency.Record(
+                GetMicrosecondsSinceCapture(
+                    timestamp));
+        }
+
+    private:
+        dbg::MetricCounter& _framesSent;
+        dbg::MetricCounter& _framesDropped;
+        dbg::MetricCounter& _bytesSent;
+        dbg::LatencyHistogram& _captureToSendLatency;
+    };
+}
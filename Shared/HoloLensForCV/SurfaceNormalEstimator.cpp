@@ -0,0 +1,957 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Number of interleaved integral images: count, x, y, z, xx, xy, xz, yy, yz, zz.
+        //
+        const int32_t c_numberOfIntegralImages = 10;
+
+        //
+        // Points closer than this are merged when building the nearest neighbor index.
+        //
+        const float c_nearestNeighborVoxelSizeInMeters = 0.001f;
+
+        int32_t GetNumberOfBands(
+            _In_ int32_t numberOfRows)
+        {
+            return std::max(1, std::min(numberOfRows, cv::getNumThreads() * 4));
+        }
+
+        //
+        // Normal and surface variation from accumulated point moments: count, sums of the
+        // coordinates and sums of their products.
+        //
+        bool ComputeNormalFromMoments(
+            _In_ const double moments[c_numberOfIntegralImages],
+            _In_ const cv::Vec3d& viewpointToPoint,
+            _Out_ cv::Vec4f& normal)
+        {
+            const double inverseCount = 1.0 / moments[0];
+
+            const double mx = moments[1] * inverseCount;
+            const double my = moments[2] * inverseCount;
+            const double mz = moments[3] * inverseCount;
+
+            const double covariance[6] =
+            {
+                moments[4] * inverseCount - mx * mx,
+                moments[5] * inverseCount - mx * my,
+                moments[6] * inverseCount - mx * mz,
+                moments[7] * inverseCount - my * my,
+                moments[8] * inverseCount - my * mz,
+                moments[9] * inverseCount - mz * mz
+            };
+
+            cv::Vec3d eigenvector;
+            double surfaceVariation = 0.0;
+
+            if (!SurfaceNormalEstimator::ComputeSmallestEigenvector(
+                    covariance,
+                    eigenvector,
+                    surfaceVariation))
+            {
+                return false;
+            }
+
+            if (eigenvector.dot(viewpointToPoint) > 0.0)
+            {
+                eigenvector = -eigenvector;
+            }
+
+            normal = cv::Vec4f(
+                static_cast<float>(eigenvector[0]),
+                static_cast<float>(eigenvector[1]),
+                static_cast<float>(eigenvector[2]),
+                static_cast<float>(surfaceVariation));
+
+            return true;
+        }
+
+        void AccumulateMoments(
+            _In_ const cv::Point3f& point,
+            _Inout_ double moments[c_numberOfIntegralImages])
+        {
+            const double x = point.x, y = point.y, z = point.z;
+
+            moments[0] += 1.0;
+            moments[1] += x;
+            moments[2] += y;
+            moments[3] += z;
+            moments[4] += x * x;
+            moments[5] += x * y;
+            moments[6] += x * z;
+            moments[7] += y * y;
+            moments[8] += y * z;
+            moments[9] += z * z;
+        }
+    }
+
+    SurfaceNormalEstimator::Options::Options()
+        : EstimationMethod(Method::CrossProduct)
+        , NeighborDistance(2)
+        , WindowRadius(3)
+        , DepthDiscontinuityThreshold(0.05f)
+    {
+    }
+
+    SurfaceNormalEstimator::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfFrames(0)
+        , NumberOfPoints(0)
+        , NumberOfOrganizedNormals(0)
+        , NumberOfNearestNeighborNormals(0)
+        , OrganizedTimeInMilliseconds(0.0)
+        , NearestNeighborTimeInMilliseconds(0.0)
+        , MeanAngularDifferenceInDegrees(0.0)
+    {
+    }
+
+    SurfaceNormalEstimator::SurfaceNormalEstimator(
+        _In_ const cv::Mat& unitPlaneMap,
+        _In_ const Options& options)
+        : _options(options)
+    {
+        REQUIRES(
+            options.NeighborDistance > 0 &&
+            options.WindowRadius > 0);
+
+        PointCloudGenerator(unitPlaneMap).GetRays(
+            _rayX,
+            _rayY,
+            _rayZ);
+
+        _pointX.create(unitPlaneMap.size(), CV_32F);
+        _pointY.create(unitPlaneMap.size(), CV_32F);
+        _pointZ.create(unitPlaneMap.size(), CV_32F);
+    }
+
+    const SurfaceNormalEstimator::Options& SurfaceNormalEstimator::GetOptions() const
+    {
+        return _options;
+    }
+
+    void SurfaceNormalEstimator::Compute(
+        _In_ const cv::Mat& depth,
+        _Out_ cv::Mat& normals)
+    {
+        REQUIRES(
+            CV_16UC1 == depth.type() &&
+            depth.size() == _rayX.size());
+
+        normals.create(
+            depth.size(),
+            CV_32FC4);
+
+        const int32_t numberOfBands =
+            GetNumberOfBands(depth.rows);
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                ComputePointRows(
+                    depth,
+                    depth.rows * band / numberOfBands,
+                    depth.rows * (band + 1) / numberOfBands);
+            }
+        });
+
+        if (Method::Covariance == _options.EstimationMethod)
+        {
+            ComputeIntegralImages();
+        }
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                const int32_t beginRow = depth.rows * band / numberOfBands;
+                const int32_t endRow = depth.rows * (band + 1) / numberOfBands;
+
+                if (Method::Covariance == _options.EstimationMethod)
+                {
+                    ComputeCovarianceRows(
+                        beginRow,
+                        endRow,
+                        normals);
+                }
+                else
+                {
+                    ComputeCrossProductRows(
+                        beginRow,
+                        endRow,
+                        normals);
+                }
+            }
+        });
+    }
+
+    /* static */ bool SurfaceNormalEstimator::ComputeSmallestEigenvector(
+        _In_ const double covariance[6],
+        _Out_ cv::Vec3d& eigenvector,
+        _Out_ double& surfaceVariation)
+    {
+        const double c00 = covariance[0], c01 = covariance[1], c02 = covariance[2];
+        const double c11 = covariance[3], c12 = covariance[4], c22 = covariance[5];
+
+        const double trace = c00 + c11 + c22;
+
+        const double p1 = c01 * c01 + c02 * c02 + c12 * c12;
+        const double q = trace / 3.0;
+
+        const double p2 =
+            (c00 - q) * (c00 - q) + (c11 - q) * (c11 - q) + (c22 - q) * (c22 - q) + 2.0 * p1;
+
+        if (p2 <= 0.0 || trace <= 0.0)
+        {
+            return false;
+        }
+
+        const double p = std::sqrt(p2 / 6.0);
+
+        const double b00 = (c00 - q) / p, b11 = (c11 - q) / p, b22 = (c22 - q) / p;
+        const double b01 = c01 / p, b02 = c02 / p, b12 = c12 / p;
+
+        const double halfDeterminant = 0.5 * (
+            b00 * (b11 * b22 - b12 * b12) -
+            b01 * (b01 * b22 - b12 * b02) +
+            b02 * (b01 * b12 - b11 * b02));
+
+        const double phi =
+            std::acos(std::max(-1.0, std::min(1.0, halfDeterminant))) / 3.0;
+
+        const double smallestEigenvalue =
+            q + 2.0 * p * std::cos(phi + 2.0 * CV_PI / 3.0);
+
+        //
+        // The rows of (C - lambda I) span the plane orthogonal to the eigenvector: use
+        // the best conditioned cross product of two of them.
+        //
+        const cv::Vec3d row0(c00 - smallestEigenvalue, c01, c02);
+        const cv::Vec3d row1(c01, c11 - smallestEigenvalue, c12);
+        const cv::Vec3d row2(c02, c12, c22 - smallestEigenvalue);
+
+        const cv::Vec3d candidates[3] =
+        {
+            row0.cross(row1),
+            row0.cross(row2),
+            row1.cross(row2)
+        };
+
+        double largestSquaredNorm = 0.0;
+
+        for (const cv::Vec3d& candidate : candidates)
+        {
+            const double squaredNorm = candidate.dot(candidate);
+
+            if (squaredNorm > largestSquaredNorm)
+            {
+                largestSquaredNorm = squaredNorm;
+                eigenvector = candidate;
+            }
+        }
+
+        if (largestSquaredNorm <= 0.0)
+        {
+            return false;
+        }
+
+        eigenvector *= 1.0 / std::sqrt(largestSquaredNorm);
+
+        surfaceVariation =
+            std::max(0.0, smallestEigenvalue) / trace;
+
+        return true;
+    }
+
+    void SurfaceNormalEstimator::GetPoints(
+        _Out_ cv::Mat& pointX,
+        _Out_ cv::Mat& pointY,
+        _Out_ cv::Mat& pointZ) const
+    {
+        pointX = _pointX;
+        pointY = _pointY;
+        pointZ = _pointZ;
+    }
+
+    /* static */ void SurfaceNormalEstimator::PackNormals(
+        _In_ const cv::Mat& normals,
+        _In_ float maximumCurvature,
+        _Out_ cv::Mat& packed)
+    {
+        REQUIRES(
+            CV_32FC4 == normals.type() &&
+            maximumCurvature > 0.0f);
+
+        packed.create(
+            normals.size(),
+            CV_8UC4);
+
+        const float curvatureScale =
+            255.0f / maximumCurvature;
+
+        for (int32_t v = 0; v < normals.rows; ++v)
+        {
+            const cv::Vec4f* normal = normals.ptr<cv::Vec4f>(v);
+            cv::Vec4b* packedNormal = packed.ptr<cv::Vec4b>(v);
+
+            for (int32_t u = 0; u < normals.cols; ++u)
+            {
+                if (std::isnan(normal[u][0]))
+                {
+                    packedNormal[u] = cv::Vec4b(0, 0, 0, 0);
+                    continue;
+                }
+
+                packedNormal[u] = cv::Vec4b(
+                    cv::saturate_cast<uint8_t>((normal[u][0] + 1.0f) * 127.5f),
+                    cv::saturate_cast<uint8_t>((normal[u][1] + 1.0f) * 127.5f),
+                    cv::saturate_cast<uint8_t>((normal[u][2] + 1.0f) * 127.5f),
+                    cv::saturate_cast<uint8_t>(normal[u][3] * curvatureScale));
+            }
+        }
+    }
+
+    /* static */ void SurfaceNormalEstimator::ComputeNearestNeighborNormals(
+        _In_ const std::vector<cv::Point3f>& points,
+        _In_ size_t numberOfNeighbors,
+        _In_ const cv::Point3f& viewpoint,
+        _Out_ std::vector<cv::Vec4f>& normals)
+    {
+        const float nan =
+            std::numeric_limits<float>::quiet_NaN();
+
+        normals.assign(
+            points.size(),
+            cv::Vec4f(nan, nan, nan, nan));
+
+        VoxelGridPointCloud::Options indexOptions;
+
+        indexOptions.VoxelSizeInMeters =
+            c_nearestNeighborVoxelSizeInMeters;
+
+        VoxelGridPointCloud index(
+            indexOptions);
+
+        index.Insert(
+            points);
+
+        index.BuildIndex();
+
+        const std::vector<cv::Point3f>& indexedPoints =
+            index.GetPoints();
+
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(points.size())),
+            [&](const cv::Range& range)
+        {
+            std::vector<size_t> neighbors;
+
+            for (int32_t i = range.start; i < range.end; ++i)
+            {
+                index.FindNearestNeighbors(
+                    points[i],
+                    numberOfNeighbors,
+                    neighbors);
+
+                if (neighbors.size() < 3)
+                {
+                    continue;
+                }
+
+                double moments[c_numberOfIntegralImages] = {};
+
+                for (const size_t neighbor : neighbors)
+                {
+                    AccumulateMoments(
+                        indexedPoints[neighbor],
+                        moments);
+                }
+
+                ComputeNormalFromMoments(
+                    moments,
+                    cv::Vec3d(
+                        points[i].x - viewpoint.x,
+                        points[i].y - viewpoint.y,
+                        points[i].z - viewpoint.z),
+                    normals[i]);
+            }
+        });
+    }
+
+    /* static */ bool SurfaceNormalEstimator::BenchmarkRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName,
+        _In_ const Options& options,
+        _In_ size_t numberOfNeighbors,
+        _In_ size_t maximumNumberOfFrames,
+        _Out_ BenchmarkStatistics& statistics)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        statistics = BenchmarkStatistics();
+
+        SensorFrameRecordingReader reader;
+
+        if (!reader.Open(recordingFolder, sensorName))
+        {
+            return false;
+        }
+
+        std::unique_ptr<std::istream> archive =
+            reader.OpenArchive();
+
+        RecordedSensorFrame frame;
+
+        if (!reader.ReadFrame(0, archive.get(), frame))
+        {
+            return false;
+        }
+
+        cv::Mat unitPlaneMap;
+
+        if (!PointCloudGenerator::LoadUnitPlaneMap(
+                recordingFolder,
+                sensorName,
+                frame.Image.cols,
+                frame.Image.rows,
+                unitPlaneMap))
+        {
+            return false;
+        }
+
+        SurfaceNormalEstimator estimator(
+            unitPlaneMap,
+            options);
+
+        cv::Mat normals;
+        std::vector<cv::Point3f> points;
+        std::vector<cv::Point> pixels;
+        std::vector<cv::Vec4f> nearestNeighborNormals;
+
+        double sumOfAngularDifferences = 0.0;
+        uint64_t numberOfComparedNormals = 0;
+
+        for (size_t i = 0; i < reader.GetNumberOfFrames() && statistics.NumberOfFrames < maximumNumberOfFrames; ++i)
+        {
+            if (!reader.ReadFrame(i, archive.get(), frame) ||
+                CV_16UC1 != frame.Image.type() ||
+                frame.Image.size() != unitPlaneMap.size())
+            {
+                continue;
+            }
+
+            ++statistics.NumberOfFrames;
+
+            const Clock::time_point organizedStartTime =
+                Clock::now();
+
+            estimator.Compute(
+                frame.Image,
+                normals);
+
+            statistics.OrganizedTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - organizedStartTime).count();
+
+            //
+            // The same points, as an unorganized cloud.
+            //
+            points.clear();
+            pixels.clear();
+
+            for (int32_t v = 0; v < frame.Image.rows; ++v)
+            {
+                const float* pointX = estimator._pointX.ptr<float>(v);
+                const float* pointY = estimator._pointY.ptr<float>(v);
+                const float* pointZ = estimator._pointZ.ptr<float>(v);
+
+                for (int32_t u = 0; u < frame.Image.cols; ++u)
+                {
+                    if (0.0f != pointZ[u])
+                    {
+                        points.emplace_back(pointX[u], pointY[u], pointZ[u]);
+                        pixels.emplace_back(u, v);
+                    }
+                }
+            }
+
+            statistics.NumberOfPoints += points.size();
+
+            const Clock::time_point nearestNeighborStartTime =
+                Clock::now();
+
+            ComputeNearestNeighborNormals(
+                points,
+                numberOfNeighbors,
+                cv::Point3f(0.0f, 0.0f, 0.0f),
+                nearestNeighborNormals);
+
+            statistics.NearestNeighborTimeInMilliseconds +=
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - nearestNeighborStartTime).count();
+
+            for (size_t j = 0; j < points.size(); ++j)
+            {
+                const cv::Vec4f& organizedNormal =
+                    normals.at<cv::Vec4f>(pixels[j]);
+
+                const cv::Vec4f& nearestNeighborNormal =
+                    nearestNeighborNormals[j];
+
+                const bool hasOrganizedNormal = !std::isnan(organizedNormal[0]);
+                const bool hasNearestNeighborNormal = !std::isnan(nearestNeighborNormal[0]);
+
+                statistics.NumberOfOrganizedNormals += hasOrganizedNormal ? 1 : 0;
+                statistics.NumberOfNearestNeighborNormals += hasNearestNeighborNormal ? 1 : 0;
+
+                if (hasOrganizedNormal && hasNearestNeighborNormal)
+                {
+                    const float cosine =
+                        organizedNormal[0] * nearestNeighborNormal[0] +
+                        organizedNormal[1] * nearestNeighborNormal[1] +
+                        organizedNormal[2] * nearestNeighborNormal[2];
+
+                    sumOfAngularDifferences +=
+                        std::acos(std::max(-1.0f, std::min(1.0f, cosine))) * 180.0 / CV_PI;
+
+                    ++numberOfComparedNormals;
+                }
+            }
+        }
+
+        if (numberOfComparedNormals > 0)
+        {
+            statistics.MeanAngularDifferenceInDegrees =
+                sumOfAngularDifferences / numberOfComparedNormals;
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "SurfaceNormalEstimator",
+            dbg::LogLevel::Information,
+            L"SurfaceNormalEstimator::BenchmarkRecording: %S: %llu frames, organized %.3f ms/frame, %llu-NN %.3f ms/frame, mean difference %.2f degrees",
+            sensorName.c_str(),
+            statistics.NumberOfFrames,
+            statistics.NumberOfFrames ? statistics.OrganizedTimeInMilliseconds / statistics.NumberOfFrames : 0.0,
+            static_cast<unsigned long long>(numberOfNeighbors),
+            statistics.NumberOfFrames ? statistics.NearestNeighborTimeInMilliseconds / statistics.NumberOfFrames : 0.0,
+            statistics.MeanAngularDifferenceInDegrees);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return statistics.NumberOfFrames > 0;
+    }
+
+    void SurfaceNormalEstimator::ComputePointRows(
+        _In_ const cv::Mat& depth,
+        _In_ int32_t beginRow,
+        _In_ int32_t endRow)
+    {
+        const PointCloudGenerator::Options& depthOptions =
+            _options.Depth;
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            const uint16_t* depthRow = depth.ptr<uint16_t>(v);
+            const float* rayX = _rayX.ptr<float>(v);
+            const float* rayY = _rayY.ptr<float>(v);
+            const float* rayZ = _rayZ.ptr<float>(v);
+
+            float* pointX = _pointX.ptr<float>(v);
+            float* pointY = _pointY.ptr<float>(v);
+            float* pointZ = _pointZ.ptr<float>(v);
+
+            int32_t u = 0;
+
+#if CV_SIMD128
+            const cv::v_float32x4 scale = cv::v_setall_f32(depthOptions.DepthScale);
+            const cv::v_float32x4 minimumDepth = cv::v_setall_f32(depthOptions.MinimumDepthInMeters);
+            const cv::v_float32x4 maximumDepth = cv::v_setall_f32(depthOptions.MaximumDepthInMeters);
+
+            for (; u + 4 <= depth.cols; u += 4)
+            {
+                const cv::v_float32x4 distance =
+                    cv::v_cvt_f32(cv::v_reinterpret_as_s32(cv::v_load_expand(depthRow + u))) * scale;
+
+                //
+                // Invalid rays are (0, 0, 0), so they yield invalid points as well.
+                //
+                const cv::v_float32x4 validDistance =
+                    cv::v_select(
+                        (distance >= minimumDepth) & (distance <= maximumDepth),
+                        distance,
+                        cv::v_setzero_f32());
+
+                cv::v_store(pointX + u, validDistance * cv::v_load(rayX + u));
+                cv::v_store(pointY + u, validDistance * cv::v_load(rayY + u));
+                cv::v_store(pointZ + u, validDistance * cv::v_load(rayZ + u));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; u < depth.cols; ++u)
+            {
+                float distance =
+                    depthRow[u] * depthOptions.DepthScale;
+
+                if (distance < depthOptions.MinimumDepthInMeters ||
+                    distance > depthOptions.MaximumDepthInMeters)
+                {
+                    distance = 0.0f;
+                }
+
+                pointX[u] = distance * rayX[u];
+                pointY[u] = distance * rayY[u];
+                pointZ[u] = distance * rayZ[u];
+            }
+        }
+    }
+
+    void SurfaceNormalEstimator::ComputeCrossProductRows(
+        _In_ int32_t beginRow,
+        _In_ int32_t endRow,
+        _Inout_ cv::Mat& normals) const
+    {
+        const int32_t s = _options.NeighborDistance;
+        const int32_t width = _pointZ.cols;
+        const int32_t height = _pointZ.rows;
+        const float threshold = _options.DepthDiscontinuityThreshold;
+
+        const float nan =
+            std::numeric_limits<float>::quiet_NaN();
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            float* normal = normals.ptr<float>(v);
+
+            std::fill(
+                normal,
+                normal + 4 * width,
+                nan);
+
+            if (v < s || v >= height - s)
+            {
+                continue;
+            }
+
+            const float* x = _pointX.ptr<float>(v);
+            const float* y = _pointY.ptr<float>(v);
+            const float* z = _pointZ.ptr<float>(v);
+
+            const float* xUp = _pointX.ptr<float>(v - s);
+            const float* yUp = _pointY.ptr<float>(v - s);
+            const float* zUp = _pointZ.ptr<float>(v - s);
+
+            const float* xDown = _pointX.ptr<float>(v + s);
+            const float* yDown = _pointY.ptr<float>(v + s);
+            const float* zDown = _pointZ.ptr<float>(v + s);
+
+            int32_t u = s;
+
+#if CV_SIMD128
+            const cv::v_float32x4 zero = cv::v_setzero_f32();
+            const cv::v_float32x4 thresholds = cv::v_setall_f32(threshold);
+            const cv::v_float32x4 nans = cv::v_setall_f32(nan);
+            const cv::v_float32x4 two = cv::v_setall_f32(2.0f);
+
+            for (; u + 4 <= width - s; u += 4)
+            {
+                const cv::v_float32x4 cx = cv::v_load(x + u), cy = cv::v_load(y + u), cz = cv::v_load(z + u);
+                const cv::v_float32x4 lx = cv::v_load(x + u - s), ly = cv::v_load(y + u - s), lz = cv::v_load(z + u - s);
+                const cv::v_float32x4 rx = cv::v_load(x + u + s), ry = cv::v_load(y + u + s), rz = cv::v_load(z + u + s);
+                const cv::v_float32x4 ux = cv::v_load(xUp + u), uy = cv::v_load(yUp + u), uz = cv::v_load(zUp + u);
+                const cv::v_float32x4 dx = cv::v_load(xDown + u), dy = cv::v_load(yDown + u), dz = cv::v_load(zDown + u);
+
+                //
+                // Invalid neighbors have a zero depth, so they fail the discontinuity test.
+                //
+                const cv::v_float32x4 tolerance = cv::v_abs(cz) * thresholds;
+
+                cv::v_float32x4 valid =
+                    (cz != zero) &
+                    (cv::v_abs(lz - cz) <= tolerance) &
+                    (cv::v_abs(rz - cz) <= tolerance) &
+                    (cv::v_abs(uz - cz) <= tolerance) &
+                    (cv::v_abs(dz - cz) <= tolerance);
+
+                if (0 == cv::v_signmask(valid))
+                {
+                    continue;
+                }
+
+                const cv::v_float32x4 hx = rx - lx, hy = ry - ly, hz = rz - lz;
+                const cv::v_float32x4 vx = dx - ux, vy = dy - uy, vz = dz - uz;
+
+                cv::v_float32x4 nx = hy * vz - hz * vy;
+                cv::v_float32x4 ny = hz * vx - hx * vz;
+                cv::v_float32x4 nz = hx * vy - hy * vx;
+
+                const cv::v_float32x4 squaredNorm =
+                    cv::v_muladd(nx, nx, cv::v_muladd(ny, ny, nz * nz));
+
+                valid = valid & (squaredNorm > zero);
+
+                //
+                // Orient the normals towards the camera: n . p < 0.
+                //
+                const cv::v_float32x4 facing =
+                    cv::v_muladd(nx, cx, cv::v_muladd(ny, cy, nz * cz));
+
+                const cv::v_float32x4 inverseNorm =
+                    cv::v_select(
+                        facing > zero,
+                        zero - cv::v_invsqrt(squaredNorm),
+                        cv::v_invsqrt(squaredNorm));
+
+                nx = nx * inverseNorm;
+                ny = ny * inverseNorm;
+                nz = nz * inverseNorm;
+
+                //
+                // Normal curvature along each axis: 4 (p(+s) + p(-s) - 2 p) . n / |p(+s) - p(-s)|^2.
+                //
+                const cv::v_float32x4 horizontalBend =
+                    cv::v_muladd(rx + lx - cx - cx, nx, cv::v_muladd(ry + ly - cy - cy, ny, (rz + lz - cz - cz) * nz));
+
+                const cv::v_float32x4 verticalBend =
+                    cv::v_muladd(dx + ux - cx - cx, nx, cv::v_muladd(dy + uy - cy - cy, ny, (dz + uz - cz - cz) * nz));
+
+                const cv::v_float32x4 horizontalLength =
+                    cv::v_muladd(hx, hx, cv::v_muladd(hy, hy, hz * hz));
+
+                const cv::v_float32x4 verticalLength =
+                    cv::v_muladd(vx, vx, cv::v_muladd(vy, vy, vz * vz));
+
+                const cv::v_float32x4 curvature =
+                    two * (
+                        cv::v_abs(horizontalBend) / horizontalLength +
+                        cv::v_abs(verticalBend) / verticalLength);
+
+                cv::v_store_interleave(
+                    normal + 4 * u,
+                    cv::v_select(valid, nx, nans),
+                    cv::v_select(valid, ny, nans),
+                    cv::v_select(valid, nz, nans),
+                    cv::v_select(valid, curvature, nans));
+            }
+#endif /* CV_SIMD128 */
+
+            for (; u < width - s; ++u)
+            {
+                const cv::Vec3f c(x[u], y[u], z[u]);
+                const cv::Vec3f l(x[u - s], y[u - s], z[u - s]);
+                const cv::Vec3f r(x[u + s], y[u + s], z[u + s]);
+                const cv::Vec3f up(xUp[u], yUp[u], zUp[u]);
+                const cv::Vec3f down(xDown[u], yDown[u], zDown[u]);
+
+                const float tolerance = std::abs(c[2]) * threshold;
+
+                if (0.0f == c[2] ||
+                    std::abs(l[2] - c[2]) > tolerance ||
+                    std::abs(r[2] - c[2]) > tolerance ||
+                    std::abs(up[2] - c[2]) > tolerance ||
+                    std::abs(down[2] - c[2]) > tolerance)
+                {
+                    continue;
+                }
+
+                const cv::Vec3f horizontal = r - l;
+                const cv::Vec3f vertical = down - up;
+
+                cv::Vec3f n = horizontal.cross(vertical);
+
+                const float squaredNorm = n.dot(n);
+
+                if (squaredNorm <= 0.0f)
+                {
+                    continue;
+                }
+
+                n *= ((n.dot(c) > 0.0f) ? -1.0f : 1.0f) / std::sqrt(squaredNorm);
+
+                const float curvature =
+                    2.0f * (
+                        std::abs((r + l - 2.0f * c).dot(n)) / horizontal.dot(horizontal) +
+                        std::abs((down + up - 2.0f * c).dot(n)) / vertical.dot(vertical));
+
+                normal[4 * u + 0] = n[0];
+                normal[4 * u + 1] = n[1];
+                normal[4 * u + 2] = n[2];
+                normal[4 * u + 3] = curvature;
+            }
+        }
+    }
+
+    void SurfaceNormalEstimator::ComputeIntegralImages()
+    {
+        const int32_t width = _pointZ.cols;
+        const int32_t height = _pointZ.rows;
+        const size_t integralRowSize = static_cast<size_t>(width + 1) * c_numberOfIntegralImages;
+
+        _integralImages.resize(
+            integralRowSize * (height + 1));
+
+        std::fill(
+            _integralImages.begin(),
+            _integralImages.begin() + integralRowSize,
+            0.0);
+
+        //
+        // Prefix sums along the rows, in parallel over rows, then along the columns, in
+        // parallel over bands of columns.
+        //
+        cv::parallel_for_(
+            cv::Range(0, height),
+            [&](const cv::Range& range)
+        {
+            for (int32_t v = range.start; v < range.end; ++v)
+            {
+                const float* pointX = _pointX.ptr<float>(v);
+                const float* pointY = _pointY.ptr<float>(v);
+                const float* pointZ = _pointZ.ptr<float>(v);
+
+                double* integralRow =
+                    _integralImages.data() + integralRowSize * (v + 1);
+
+                double moments[c_numberOfIntegralImages] = {};
+
+                std::fill(
+                    integralRow,
+                    integralRow + c_numberOfIntegralImages,
+                    0.0);
+
+                for (int32_t u = 0; u < width; ++u)
+                {
+                    if (0.0f != pointZ[u])
+                    {
+                        AccumulateMoments(
+                            cv::Point3f(pointX[u], pointY[u], pointZ[u]),
+                            moments);
+                    }
+
+                    std::copy(
+                        moments,
+                        moments + c_numberOfIntegralImages,
+                        integralRow + c_numberOfIntegralImages * (u + 1));
+                }
+            }
+        });
+
+        const int32_t numberOfBands =
+            GetNumberOfBands(width + 1);
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfBands),
+            [&](const cv::Range& range)
+        {
+            for (int32_t band = range.start; band < range.end; ++band)
+            {
+                const size_t begin = integralRowSize * band / numberOfBands;
+                const size_t end = integralRowSize * (band + 1) / numberOfBands;
+
+                for (int32_t v = 2; v <= height; ++v)
+                {
+                    double* integralRow = _integralImages.data() + integralRowSize * v;
+                    const double* previousIntegralRow = integralRow - integralRowSize;
+
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        integralRow[i] += previousIntegralRow[i];
+                    }
+                }
+            }
+        });
+    }
+
+    void SurfaceNormalEstimator::ComputeCovarianceRows(
+        _In_ int32_t beginRow,
+        _In_ int32_t endRow,
+        _Inout_ cv::Mat& normals) const
+    {
+        const int32_t radius = _options.WindowRadius;
+        const int32_t width = _pointZ.cols;
+        const int32_t height = _pointZ.rows;
+        const size_t integralRowSize = static_cast<size_t>(width + 1) * c_numberOfIntegralImages;
+        const float threshold = _options.DepthDiscontinuityThreshold;
+
+        const float nan =
+            std::numeric_limits<float>::quiet_NaN();
+
+        for (int32_t v = beginRow; v < endRow; ++v)
+        {
+            const float* pointX = _pointX.ptr<float>(v);
+            const float* pointY = _pointY.ptr<float>(v);
+            const float* pointZ = _pointZ.ptr<float>(v);
+
+            cv::Vec4f* normal = normals.ptr<cv::Vec4f>(v);
+
+            const int32_t top = std::max(0, v - radius);
+            const int32_t bottom = std::min(height, v + radius + 1);
+
+            const double* topRow = _integralImages.data() + integralRowSize * top;
+            const double* bottomRow = _integralImages.data() + integralRowSize * bottom;
+
+            for (int32_t u = 0; u < width; ++u)
+            {
+                normal[u] = cv::Vec4f(nan, nan, nan, nan);
+
+                if (0.0f == pointZ[u])
+                {
+                    continue;
+                }
+
+                const int32_t left = std::max(0, u - radius) * c_numberOfIntegralImages;
+                const int32_t right = std::min(width, u + radius + 1) * c_numberOfIntegralImages;
+
+                double moments[c_numberOfIntegralImages];
+
+                for (int32_t i = 0; i < c_numberOfIntegralImages; ++i)
+                {
+                    moments[i] =
+                        bottomRow[right + i] - bottomRow[left + i] -
+                        topRow[right + i] + topRow[left + i];
+                }
+
+                //
+                // Require at least half of the window to be valid, and reject windows that
+                // straddle a discontinuity.
+                //
+                const int32_t windowArea =
+                    (bottom - top) * (right - left) / c_numberOfIntegralImages;
+
+                if (moments[0] < 3.0 || 2.0 * moments[0] < windowArea)
+                {
+                    continue;
+                }
+
+                const double meanZ = moments[3] / moments[0];
+
+                if (std::abs(meanZ - pointZ[u]) > std::abs(pointZ[u]) * threshold)
+                {
+                    continue;
+                }
+
+                ComputeNormalFromMoments(
+                    moments,
+                    cv::Vec3d(pointX[u], pointY[u], pointZ[u]),
+                    normal[u]);
+            }
+        }
+    }
+}
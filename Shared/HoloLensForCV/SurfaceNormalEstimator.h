@@ -0,0 +1,195 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Estimates per-pixel surface normals and curvature directly from organized depth
+    // frames, instead of searching for nearest neighbors in an unorganized point cloud.
+    //
+    // Depth pixels are first unprojected with precomputed rays. Normals are then either
+    // computed from the cross product of the horizontal and vertical tangents (vectorized),
+    // or from the covariance of the points in a square window, using integral images so
+    // that the cost does not depend on the window size. Both are parallelized over rows.
+    //
+    // Normals are expressed in the camera coordinate system and oriented towards the
+    // camera.
+    //
+    // An instance keeps scratch buffers between calls, so it must not be used by several
+    // threads at once.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class SurfaceNormalEstimator
+    {
+    public:
+        enum class Method
+        {
+            //
+            // Cross product of the tangents between the neighbors at the given distance.
+            // The curvature is the mean absolute normal curvature along the image axes,
+            // in 1/m.
+            //
+            CrossProduct,
+
+            //
+            // Smallest eigenvector of the covariance of the points in the window. The
+            // curvature is the surface variation, lambda0 / (lambda0 + lambda1 + lambda2),
+            // between 0 (plane) and 1/3 (isotropic).
+            //
+            Covariance
+        };
+
+        struct Options
+        {
+            Options();
+
+            Method EstimationMethod;
+
+            // Distance, in pixels, to the neighbors used by the cross product.
+            int32_t NeighborDistance;
+
+            // Half size, in pixels, of the covariance window.
+            int32_t WindowRadius;
+
+            // Neighbors whose depth differs from the pixel's by more than this fraction of
+            // its depth lie across a discontinuity: no normal is estimated.
+            float DepthDiscontinuityThreshold;
+
+            // Depth range and scale.
+            PointCloudGenerator::Options Depth;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfPoints;
+            uint64_t NumberOfOrganizedNormals;
+            uint64_t NumberOfNearestNeighborNormals;
+
+            double OrganizedTimeInMilliseconds;
+            double NearestNeighborTimeInMilliseconds;
+
+            // Over the points that have both normals.
+            double MeanAngularDifferenceInDegrees;
+        };
+
+        //
+        // The unit plane map is a CV_32FC2 image holding the (x, y) unit plane coordinates
+        // of each depth pixel, +infinity for pixels without a valid mapping.
+        //
+        SurfaceNormalEstimator(
+            _In_ const cv::Mat& unitPlaneMap,
+            _In_ const Options& options);
+
+        const Options& GetOptions() const;
+
+        //
+        // Computes the normal map (CV_32FC4: nx, ny, nz, curvature) of a depth frame
+        // (Gray16). Pixels without a normal are NaN.
+        //
+        void Compute(
+            _In_ const cv::Mat& depth,
+            _Out_ cv::Mat& normals);
+
+        //
+        // Packs a normal map into a CV_8UC4 image, to be stored or sent alongside the
+        // depth frame: n = packed / 127.5 - 1 for the normal, and curvature = packed /
+        // 255 * maximumCurvature (saturated). Pixels without a normal are all zeros.
+        //
+        static void PackNormals(
+            _In_ const cv::Mat& normals,
+            _In_ float maximumCurvature,
+            _Out_ cv::Mat& packed);
+
+        //
+        // Camera space points of the last frame (CV_32FC1 images), zero where the depth
+        // is invalid. They are overwritten by the next call to Compute.
+        //
+        void GetPoints(
+            _Out_ cv::Mat& pointX,
+            _Out_ cv::Mat& pointY,
+            _Out_ cv::Mat& pointZ) const;
+
+        //
+        // Finds the eigenvector of the smallest eigenvalue of a symmetric 3x3 matrix,
+        // given as (c00, c01, c02, c11, c12, c22), in closed form, and the surface
+        // variation lambda0 / (lambda0 + lambda1 + lambda2). Fails for degenerate
+        // matrices.
+        //
+        static bool ComputeSmallestEigenvector(
+            _In_ const double covariance[6],
+            _Out_ cv::Vec3d& eigenvector,
+            _Out_ double& surfaceVariation);
+
+        //
+        // Reference implementation for unorganized point clouds: the normal of each point
+        // is the smallest eigenvector of the covariance of its nearest neighbors, oriented
+        // towards the viewpoint. The curvature is the surface variation.
+        //
+        static void ComputeNearestNeighborNormals(
+            _In_ const std::vector<cv::Point3f>& points,
+            _In_ size_t numberOfNeighbors,
+            _In_ const cv::Point3f& viewpoint,
+            _Out_ std::vector<cv::Vec4f>& normals);
+
+        //
+        // Estimates the normals of (up to the given number of) frames recorded for a depth
+        // sensor, both from the organized frames and from their point clouds with k nearest
+        // neighbors, and compares the run times and the results.
+        //
+        static bool BenchmarkRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName,
+            _In_ const Options& options,
+            _In_ size_t numberOfNeighbors,
+            _In_ size_t maximumNumberOfFrames,
+            _Out_ BenchmarkStatistics& statistics);
+
+    private:
+        void ComputePointRows(
+            _In_ const cv::Mat& depth,
+            _In_ int32_t beginRow,
+            _In_ int32_t endRow);
+
+        void ComputeCrossProductRows(
+            _In_ int32_t beginRow,
+            _In_ int32_t endRow,
+            _Inout_ cv::Mat& normals) const;
+
+        void ComputeIntegralImages();
+
+        void ComputeCovarianceRows(
+            _In_ int32_t beginRow,
+            _In_ int32_t endRow,
+            _Inout_ cv::Mat& normals) const;
+
+    private:
+        Options _options;
+
+        cv::Mat _rayX;
+        cv::Mat _rayY;
+        cv::Mat _rayZ;
+
+        // Camera space points of the current frame, (0, 0, 0) where the depth is invalid.
+        cv::Mat _pointX;
+        cv::Mat _pointY;
+        cv::Mat _pointZ;
+
+        // Integral images of the number of valid points, their coordinates and the
+        // products of their coordinates, interleaved: (rows + 1) x (cols + 1) x 10.
+        std::vector<double> _integralImages;
+    };
+}
@@ -0,0 +1,706 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Block coordinates are packed as three signed 21-bit integers.
+        //
+        const uint64_t c_coordinateMask = (1ull << 21) - 1;
+
+        int32_t SignExtend21(
+            _In_ uint64_t value)
+        {
+            return static_cast<int32_t>(static_cast<uint32_t>(value << 11)) >> 11;
+        }
+
+        int32_t FloorToInt(
+            _In_ float value)
+        {
+            return static_cast<int32_t>(std::floor(value));
+        }
+    }
+
+    TsdfVolume::Options::Options()
+        : VoxelSizeInMeters(0.01f)
+        , TruncationDistanceInMeters(0.04f)
+        , MaximumWeight(64.0f)
+    {
+    }
+
+    TsdfVolume::ReplayStatistics::ReplayStatistics()
+        : NumberOfFrames(0)
+        , NumberOfFramesWithoutPose(0)
+        , ElapsedTimeInMilliseconds(0.0)
+        , IntegrationTimeInMilliseconds(0.0)
+        , MaximumIntegrationTimeInMilliseconds(0.0)
+        , NumberOfBlocks(0)
+        , MemoryUsageInBytes(0)
+    {
+    }
+
+    TsdfVolume::VoxelBlock::VoxelBlock()
+        : LastModifiedFrame(0)
+    {
+        Tsdf.fill(1.0f);
+        Weight.fill(0.0f);
+    }
+
+    TsdfVolume::TsdfVolume(
+        _In_ const cv::Mat& unitPlaneMap,
+        _In_ const Options& options)
+        : _options(options)
+        , _pointCloudGenerator(unitPlaneMap)
+        , _projector(unitPlaneMap)
+        , _numberOfIntegratedFrames(0)
+    {
+        REQUIRES(
+            options.VoxelSizeInMeters > 0.0f &&
+            options.TruncationDistanceInMeters > 0.0f &&
+            options.MaximumWeight >= 1.0f);
+    }
+
+    void TsdfVolume::Integrate(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& cameraToWorld)
+    {
+        REQUIRES(
+            CV_16UC1 == depth.type() &&
+            depth.isContinuous() &&
+            depth.cols == _projector.GetImageWidth() &&
+            depth.rows == _projector.GetImageHeight());
+
+        std::unique_lock<std::shared_mutex> lock(
+            _mutex);
+
+        const uint64_t frameNumber =
+            ++_numberOfIntegratedFrames;
+
+        std::vector<std::pair<uint64_t, VoxelBlock*>> blocks;
+
+        AllocateBlocks(
+            depth,
+            cameraToWorld,
+            blocks);
+
+        const cv::Matx44f worldToCamera =
+            cameraToWorld.inv();
+
+        //
+        // Blocks are independent from one another, so they can be updated in parallel.
+        //
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(blocks.size())),
+            [&](const cv::Range& range)
+        {
+            for (int32_t i = range.start; i < range.end; ++i)
+            {
+                if (IntegrateBlock(
+                        depth,
+                        worldToCamera,
+                        blocks[i].first,
+                        *blocks[i].second))
+                {
+                    blocks[i].second->LastModifiedFrame = frameNumber;
+                }
+            }
+        });
+    }
+
+    void TsdfVolume::Reset()
+    {
+        std::unique_lock<std::shared_mutex> lock(
+            _mutex);
+
+        _blocks.clear();
+        _numberOfIntegratedFrames = 0;
+    }
+
+    uint64_t TsdfVolume::GetNumberOfIntegratedFrames() const
+    {
+        std::shared_lock<std::shared_mutex> lock(
+            _mutex);
+
+        return _numberOfIntegratedFrames;
+    }
+
+    size_t TsdfVolume::GetNumberOfBlocks() const
+    {
+        std::shared_lock<std::shared_mutex> lock(
+            _mutex);
+
+        return _blocks.size();
+    }
+
+    size_t TsdfVolume::GetMemoryUsageInBytes() const
+    {
+        std::shared_lock<std::shared_mutex> lock(
+            _mutex);
+
+        //
+        // Approximate: the blocks, plus a node (key, pointer, link) per block and the
+        // bucket array of the hash map.
+        //
+        return
+            _blocks.size() * (sizeof(VoxelBlock) + sizeof(BlockMap::value_type) + sizeof(void*)) +
+            _blocks.bucket_count() * sizeof(void*);
+    }
+
+    void TsdfVolume::ExtractSurfacePoints(
+        _Out_ std::vector<cv::Point3f>& points) const
+    {
+        std::vector<SurfaceBlock> blocks;
+
+        ExtractModifiedSurfaceBlocks(
+            0,
+            blocks);
+
+        size_t numberOfPoints = 0;
+
+        for (const SurfaceBlock& block : blocks)
+        {
+            numberOfPoints += block.Points.size();
+        }
+
+        points.clear();
+        points.reserve(numberOfPoints);
+
+        for (const SurfaceBlock& block : blocks)
+        {
+            points.insert(
+                points.end(),
+                block.Points.begin(),
+                block.Points.end());
+        }
+    }
+
+    uint64_t TsdfVolume::ExtractModifiedSurfaceBlocks(
+        _In_ uint64_t sinceFrame,
+        _Out_ std::vector<SurfaceBlock>& blocks) const
+    {
+        std::shared_lock<std::shared_mutex> lock(
+            _mutex);
+
+        //
+        // The surface of a block also depends on its neighbors in the positive X, Y and Z
+        // directions, so their modifications invalidate it as well.
+        //
+        std::unordered_set<uint64_t> keys;
+
+        for (const auto& entry : _blocks)
+        {
+            if (entry.second->LastModifiedFrame <= sinceFrame)
+            {
+                continue;
+            }
+
+            keys.insert(entry.first);
+
+            const cv::Vec3i blockCoordinates =
+                UnpackBlockCoordinates(entry.first);
+
+            for (int32_t axis = 0; axis < 3; ++axis)
+            {
+                cv::Vec3i neighborCoordinates = blockCoordinates;
+                --neighborCoordinates[axis];
+
+                const uint64_t neighborKey =
+                    PackBlockCoordinates(neighborCoordinates);
+
+                if (0 != _blocks.count(neighborKey))
+                {
+                    keys.insert(neighborKey);
+                }
+            }
+        }
+
+        const std::vector<uint64_t> sortedKeys(
+            keys.begin(),
+            keys.end());
+
+        blocks.clear();
+        blocks.resize(sortedKeys.size());
+
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(sortedKeys.size())),
+            [&](const cv::Range& range)
+        {
+            for (int32_t i = range.start; i < range.end; ++i)
+            {
+                blocks[i].BlockCoordinates =
+                    UnpackBlockCoordinates(sortedKeys[i]);
+
+                ExtractBlockSurface(
+                    sortedKeys[i],
+                    *_blocks.find(sortedKeys[i])->second,
+                    blocks[i].Points);
+            }
+        });
+
+        return _numberOfIntegratedFrames;
+    }
+
+    /* static */ std::unique_ptr<TsdfVolume> TsdfVolume::IntegrateRecording(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName,
+        _In_ const Options& options,
+        _Out_ ReplayStatistics& statistics)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        statistics = ReplayStatistics();
+
+        SensorFrameRecordingReader reader;
+
+        if (!reader.Open(recordingFolder, sensorName))
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<std::istream> archive =
+            reader.OpenArchive();
+
+        RecordedSensorFrame frame;
+
+        if (!reader.ReadFrame(0, archive.get(), frame))
+        {
+            return nullptr;
+        }
+
+        cv::Mat unitPlaneMap;
+
+        if (!PointCloudGenerator::LoadUnitPlaneMap(
+                recordingFolder,
+                sensorName,
+                frame.Image.cols,
+                frame.Image.rows,
+                unitPlaneMap))
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<TsdfVolume> volume(
+            new TsdfVolume(unitPlaneMap, options));
+
+        for (size_t i = 0; i < reader.GetNumberOfFrames(); ++i)
+        {
+            if (!reader.ReadFrame(i, archive.get(), frame) ||
+                CV_16UC1 != frame.Image.type())
+            {
+                continue;
+            }
+
+            cv::Matx44f cameraToWorld;
+
+            if (!PointCloudGenerator::ComputeCameraToWorld(
+                    frame.FrameToOrigin,
+                    frame.CameraViewTransform,
+                    cameraToWorld))
+            {
+                ++statistics.NumberOfFramesWithoutPose;
+                continue;
+            }
+
+            const Clock::time_point integrationStartTime =
+                Clock::now();
+
+            volume->Integrate(
+                frame.Image,
+                cameraToWorld);
+
+            const double integrationTimeInMilliseconds =
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - integrationStartTime).count();
+
+            ++statistics.NumberOfFrames;
+
+            statistics.IntegrationTimeInMilliseconds +=
+                integrationTimeInMilliseconds;
+
+            statistics.MaximumIntegrationTimeInMilliseconds =
+                std::max(
+                    statistics.MaximumIntegrationTimeInMilliseconds,
+                    integrationTimeInMilliseconds);
+        }
+
+        statistics.ElapsedTimeInMilliseconds =
+            std::chrono::duration<double, std::milli>(
+                Clock::now() - startTime).count();
+
+        statistics.NumberOfBlocks =
+            volume->GetNumberOfBlocks();
+
+        statistics.MemoryUsageInBytes =
+            volume->GetMemoryUsageInBytes();
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "TsdfVolume",
+            dbg::LogLevel::Information,
+            L"TsdfVolume::IntegrateRecording: %S: %llu frames (%llu without pose), %.3f ms/frame (max %.3f ms), %zu blocks, %.1f MB",
+            sensorName.c_str(),
+            statistics.NumberOfFrames,
+            statistics.NumberOfFramesWithoutPose,
+            statistics.NumberOfFrames ? statistics.IntegrationTimeInMilliseconds / statistics.NumberOfFrames : 0.0,
+            statistics.MaximumIntegrationTimeInMilliseconds,
+            statistics.NumberOfBlocks,
+            statistics.MemoryUsageInBytes / (1024.0 * 1024.0));
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return volume;
+    }
+
+    /* static */ uint64_t TsdfVolume::PackBlockCoordinates(
+        _In_ const cv::Vec3i& blockCoordinates)
+    {
+        return
+            ((static_cast<uint64_t>(blockCoordinates[0]) & c_coordinateMask) << 42) |
+            ((static_cast<uint64_t>(blockCoordinates[1]) & c_coordinateMask) << 21) |
+            (static_cast<uint64_t>(blockCoordinates[2]) & c_coordinateMask);
+    }
+
+    /* static */ cv::Vec3i TsdfVolume::UnpackBlockCoordinates(
+        _In_ uint64_t key)
+    {
+        return cv::Vec3i(
+            SignExtend21((key >> 42) & c_coordinateMask),
+            SignExtend21((key >> 21) & c_coordinateMask),
+            SignExtend21(key & c_coordinateMask));
+    }
+
+    void TsdfVolume::AllocateBlocks(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& cameraToWorld,
+        _Out_ std::vector<std::pair<uint64_t, VoxelBlock*>>& blocks)
+    {
+        _pointCloudGenerator.Compute(
+            depth,
+            cameraToWorld,
+            _options.Depth,
+            _points);
+
+        const cv::Point3f cameraPosition(
+            cameraToWorld(0, 3),
+            cameraToWorld(1, 3),
+            cameraToWorld(2, 3));
+
+        const float truncationDistance =
+            _options.TruncationDistanceInMeters;
+
+        const float inverseBlockExtent =
+            1.0f / (BlockSize * _options.VoxelSizeInMeters);
+
+        //
+        // Sample the truncation band along each ray at half the block extent, so that no
+        // block crossed by the band is missed.
+        //
+        const float stepSize =
+            std::min(truncationDistance, 0.5f / inverseBlockExtent);
+
+        const int32_t numberOfSteps =
+            static_cast<int32_t>(std::ceil(2.0f * truncationDistance / stepSize));
+
+        const int32_t numberOfChunks =
+            std::max(1, cv::getNumThreads() * 4);
+
+        std::vector<std::vector<uint64_t>> chunkKeys(
+            numberOfChunks);
+
+        cv::parallel_for_(
+            cv::Range(0, numberOfChunks),
+            [&](const cv::Range& range)
+        {
+            for (int32_t chunk = range.start; chunk < range.end; ++chunk)
+            {
+                const size_t begin = _points.size() * chunk / numberOfChunks;
+                const size_t end = _points.size() * (chunk + 1) / numberOfChunks;
+
+                std::vector<uint64_t>& keys = chunkKeys[chunk];
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const cv::Point3f ray =
+                        _points[i] - cameraPosition;
+
+                    const float rayLength =
+                        static_cast<float>(cv::norm(ray));
+
+                    if (rayLength <= 0.0f)
+                    {
+                        continue;
+                    }
+
+                    const cv::Point3f direction =
+                        ray * (1.0f / rayLength);
+
+                    for (int32_t step = 0; step <= numberOfSteps; ++step)
+                    {
+                        const cv::Point3f sample =
+                            _points[i] + direction * (step * stepSize - truncationDistance);
+
+                        keys.push_back(
+                            PackBlockCoordinates(
+                                cv::Vec3i(
+                                    FloorToInt(sample.x * inverseBlockExtent),
+                                    FloorToInt(sample.y * inverseBlockExtent),
+                                    FloorToInt(sample.z * inverseBlockExtent))));
+                    }
+                }
+
+                std::sort(keys.begin(), keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            }
+        });
+
+        std::vector<uint64_t> keys;
+
+        for (const auto& chunk : chunkKeys)
+        {
+            keys.insert(
+                keys.end(),
+                chunk.begin(),
+                chunk.end());
+        }
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        blocks.clear();
+        blocks.reserve(keys.size());
+
+        for (const uint64_t key : keys)
+        {
+            std::unique_ptr<VoxelBlock>& block =
+                _blocks[key];
+
+            if (!block)
+            {
+                block.reset(new VoxelBlock());
+            }
+
+            blocks.emplace_back(
+                key,
+                block.get());
+        }
+    }
+
+    bool TsdfVolume::IntegrateBlock(
+        _In_ const cv::Mat& depth,
+        _In_ const cv::Matx44f& worldToCamera,
+        _In_ uint64_t key,
+        _Inout_ VoxelBlock& block) const
+    {
+        const cv::Vec3i blockCoordinates =
+            UnpackBlockCoordinates(key);
+
+        const float voxelSize =
+            _options.VoxelSizeInMeters;
+
+        const float truncationDistance =
+            _options.TruncationDistanceInMeters;
+
+        const float inverseTruncationDistance =
+            1.0f / truncationDistance;
+
+        const uint16_t* depthData =
+            depth.ptr<uint16_t>();
+
+        const cv::Matx44f& m = worldToCamera;
+
+        //
+        // Stepping along X in world space moves by the first column of the rotation in
+        // camera space.
+        //
+        const cv::Point3f stepX(
+            m(0, 0) * voxelSize,
+            m(1, 0) * voxelSize,
+            m(2, 0) * voxelSize);
+
+        bool modified = false;
+
+        for (int32_t z = 0; z < BlockSize; ++z)
+        {
+            for (int32_t y = 0; y < BlockSize; ++y)
+            {
+                const cv::Point3f rowStart(
+                    (blockCoordinates[0] * BlockSize + 0.5f) * voxelSize,
+                    (blockCoordinates[1] * BlockSize + y + 0.5f) * voxelSize,
+                    (blockCoordinates[2] * BlockSize + z + 0.5f) * voxelSize);
+
+                cv::Point3f cameraPoint(
+                    m(0, 0) * rowStart.x + m(0, 1) * rowStart.y + m(0, 2) * rowStart.z + m(0, 3),
+                    m(1, 0) * rowStart.x + m(1, 1) * rowStart.y + m(1, 2) * rowStart.z + m(1, 3),
+                    m(2, 0) * rowStart.x + m(2, 1) * rowStart.y + m(2, 2) * rowStart.z + m(2, 3));
+
+                int32_t voxelIndex =
+                    (z * BlockSize + y) * BlockSize;
+
+                for (int32_t x = 0; x < BlockSize; ++x, ++voxelIndex, cameraPoint += stepX)
+                {
+                    const int32_t pixel =
+                        _projector.ProjectCameraSpacePoint(cameraPoint);
+
+                    if (pixel < 0)
+                    {
+                        continue;
+                    }
+
+                    const float measuredDistance =
+                        depthData[pixel] * _options.Depth.DepthScale;
+
+                    if (measuredDistance < _options.Depth.MinimumDepthInMeters ||
+                        measuredDistance > _options.Depth.MaximumDepthInMeters)
+                    {
+                        continue;
+                    }
+
+                    //
+                    // The depth sensors measure the distance along the ray, which is
+                    // compared with the distance of the voxel to the camera.
+                    //
+                    const float signedDistance =
+                        measuredDistance -
+                        std::sqrt(cameraPoint.x * cameraPoint.x + cameraPoint.y * cameraPoint.y + cameraPoint.z * cameraPoint.z);
+
+                    if (signedDistance < -truncationDistance)
+                    {
+                        continue;
+                    }
+
+                    const float tsdf =
+                        std::min(1.0f, signedDistance * inverseTruncationDistance);
+
+                    const float weight =
+                        block.Weight[voxelIndex];
+
+                    block.Tsdf[voxelIndex] =
+                        (block.Tsdf[voxelIndex] * weight + tsdf) / (weight + 1.0f);
+
+                    block.Weight[voxelIndex] =
+                        std::min(weight + 1.0f, _options.MaximumWeight);
+
+                    modified = true;
+                }
+            }
+        }
+
+        return modified;
+    }
+
+    void TsdfVolume::ExtractBlockSurface(
+        _In_ uint64_t key,
+        _In_ const VoxelBlock& block,
+        _Inout_ std::vector<cv::Point3f>& points) const
+    {
+        const cv::Vec3i blockCoordinates =
+            UnpackBlockCoordinates(key);
+
+        const float voxelSize =
+            _options.VoxelSizeInMeters;
+
+        //
+        // Neighboring blocks in the positive X, Y and Z directions.
+        //
+        const VoxelBlock* neighbors[3] = {};
+
+        for (int32_t axis = 0; axis < 3; ++axis)
+        {
+            cv::Vec3i neighborCoordinates = blockCoordinates;
+            ++neighborCoordinates[axis];
+
+            const auto neighbor =
+                _blocks.find(PackBlockCoordinates(neighborCoordinates));
+
+            if (_blocks.end() != neighbor)
+            {
+                neighbors[axis] = neighbor->second.get();
+            }
+        }
+
+        const int32_t strides[3] =
+        {
+            1, BlockSize, BlockSize * BlockSize
+        };
+
+        for (int32_t z = 0; z < BlockSize; ++z)
+        {
+            for (int32_t y = 0; y < BlockSize; ++y)
+            {
+                for (int32_t x = 0; x < BlockSize; ++x)
+                {
+                    const int32_t voxel[3] = { x, y, z };
+
+                    const int32_t voxelIndex =
+                        (z * BlockSize + y) * BlockSize + x;
+
+                    if (0.0f == block.Weight[voxelIndex])
+                    {
+                        continue;
+                    }
+
+                    const float tsdf =
+                        block.Tsdf[voxelIndex];
+
+                    for (int32_t axis = 0; axis < 3; ++axis)
+                    {
+                        const VoxelBlock* neighborBlock = &block;
+                        int32_t neighborIndex = voxelIndex + strides[axis];
+
+                        if (BlockSize - 1 == voxel[axis])
+                        {
+                            neighborBlock = neighbors[axis];
+                            neighborIndex = voxelIndex - (BlockSize - 1) * strides[axis];
+                        }
+
+                        if (nullptr == neighborBlock ||
+                            0.0f == neighborBlock->Weight[neighborIndex])
+                        {
+                            continue;
+                        }
+
+                        const float neighborTsdf =
+                            neighborBlock->Tsdf[neighborIndex];
+
+                        if ((tsdf > 0.0f) == (neighborTsdf > 0.0f))
+                        {
+                            continue;
+                        }
+
+                        //
+                        // Linearly interpolate the zero crossing along the edge.
+                        //
+                        float position[3] =
+                        {
+                            (blockCoordinates[0] * BlockSize + x + 0.5f) * voxelSize,
+                            (blockCoordinates[1] * BlockSize + y + 0.5f) * voxelSize,
+                            (blockCoordinates[2] * BlockSize + z + 0.5f) * voxelSize
+                        };
+
+                        position[axis] +=
+                            voxelSize * tsdf / (tsdf - neighborTsdf);
+
+                        points.emplace_back(
+                            position[0],
+                            position[1],
+                            position[2]);
+                    }
+                }
+            }
+        }
+    }
+}
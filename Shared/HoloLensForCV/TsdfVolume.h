@@ -0,0 +1,184 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Truncated signed distance function (TSDF) volume fusing depth frames into a single
+    // surface estimate.
+    //
+    // Voxels are stored in sparse blocks of 8x8x8 voxels, addressed through a hash map of
+    // block coordinates, so memory grows with the observed surface rather than with the
+    // bounding volume. Each frame is integrated in two passes: blocks intersecting the
+    // truncation band around the measured surface are allocated, then these blocks are
+    // updated in parallel by projecting their voxels into the depth image.
+    //
+    // Surface points are extracted at the zero crossings of the TSDF. Blocks remember the
+    // frame that last modified them, so that consumers can extract the surface
+    // incrementally.
+    //
+    // Integration and extraction may be called from different threads.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class TsdfVolume
+    {
+    public:
+        static const int32_t BlockSize = 8;
+        static const int32_t VoxelsPerBlock = BlockSize * BlockSize * BlockSize;
+
+        struct Options
+        {
+            Options();
+
+            float VoxelSizeInMeters;
+
+            // Distance behind and in front of the measured surface within which voxels
+            // are updated.
+            float TruncationDistanceInMeters;
+
+            // Caps the weight of the running average so that the volume can adapt to
+            // changes in the scene.
+            float MaximumWeight;
+
+            // Depth range and scale.
+            PointCloudGenerator::Options Depth;
+        };
+
+        struct SurfaceBlock
+        {
+            cv::Vec3i BlockCoordinates;
+
+            std::vector<cv::Point3f> Points;
+        };
+
+        struct ReplayStatistics
+        {
+            ReplayStatistics();
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfFramesWithoutPose;
+
+            double ElapsedTimeInMilliseconds;
+            double IntegrationTimeInMilliseconds;
+            double MaximumIntegrationTimeInMilliseconds;
+
+            size_t NumberOfBlocks;
+            size_t MemoryUsageInBytes;
+        };
+
+        //
+        // The unit plane map is a CV_32FC2 image holding the (x, y) unit plane coordinates
+        // of each depth pixel, +infinity for pixels without a valid mapping.
+        //
+        TsdfVolume(
+            _In_ const cv::Mat& unitPlaneMap,
+            _In_ const Options& options);
+
+        //
+        // Fuses one depth frame (Gray16), given its camera-to-world transform (see
+        // PointCloudGenerator::ComputeCameraToWorld).
+        //
+        void Integrate(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& cameraToWorld);
+
+        void Reset();
+
+        uint64_t GetNumberOfIntegratedFrames() const;
+
+        size_t GetNumberOfBlocks() const;
+
+        size_t GetMemoryUsageInBytes() const;
+
+        //
+        // Extracts the surface points of the whole volume.
+        //
+        void ExtractSurfacePoints(
+            _Out_ std::vector<cv::Point3f>& points) const;
+
+        //
+        // Extracts the surface of the blocks modified after the given number of integrated
+        // frames (zero for all blocks). Blocks that no longer hold any surface are reported
+        // with no points. Returns the number of integrated frames, to be passed to the next
+        // call.
+        //
+        uint64_t ExtractModifiedSurfaceBlocks(
+            _In_ uint64_t sinceFrame,
+            _Out_ std::vector<SurfaceBlock>& blocks) const;
+
+        //
+        // Fuses all the frames recorded for a depth sensor, as fast as possible, and reports
+        // the integration times.
+        //
+        static std::unique_ptr<TsdfVolume> IntegrateRecording(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName,
+            _In_ const Options& options,
+            _Out_ ReplayStatistics& statistics);
+
+    private:
+        struct VoxelBlock
+        {
+            VoxelBlock();
+
+            std::array<float, VoxelsPerBlock> Tsdf;
+            std::array<float, VoxelsPerBlock> Weight;
+
+            // Number of integrated frames when the block was last modified.
+            uint64_t LastModifiedFrame;
+        };
+
+        typedef std::unordered_map<uint64_t, std::unique_ptr<VoxelBlock>> BlockMap;
+
+        static uint64_t PackBlockCoordinates(
+            _In_ const cv::Vec3i& blockCoordinates);
+
+        static cv::Vec3i UnpackBlockCoordinates(
+            _In_ uint64_t key);
+
+        void AllocateBlocks(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& cameraToWorld,
+            _Out_ std::vector<std::pair<uint64_t, VoxelBlock*>>& blocks);
+
+        //
+        // Returns true if any voxel of the block was updated.
+        //
+        bool IntegrateBlock(
+            _In_ const cv::Mat& depth,
+            _In_ const cv::Matx44f& worldToCamera,
+            _In_ uint64_t key,
+            _Inout_ VoxelBlock& block) const;
+
+        void ExtractBlockSurface(
+            _In_ uint64_t key,
+            _In_ const VoxelBlock& block,
+            _Inout_ std::vector<cv::Point3f>& points) const;
+
+    private:
+        Options _options;
+
+        PointCloudGenerator _pointCloudGenerator;
+        UnitPlaneProjector _projector;
+
+        mutable std::shared_mutex _mutex;
+
+        BlockMap _blocks;
+
+        uint64_t _numberOfIntegratedFrames;
+
+        // Scratch storage reused across frames.
+        std::vector<cv::Point3f> _points;
+    };
+}
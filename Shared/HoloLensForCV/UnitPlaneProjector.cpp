@@ -0,0 +1,248 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Bounds the size of the lookup grid (per side).
+        //
+        const int32_t c_maximumGridSize = 4096;
+
+        bool IsValid(
+            _In_ const cv::Point2f& point)
+        {
+            return std::isfinite(point.x) && std::isfinite(point.y);
+        }
+    }
+
+    UnitPlaneProjector::UnitPlaneProjector(
+        _In_ const cv::Mat& unitPlaneMap)
+        : _imageWidth(unitPlaneMap.cols)
+        , _imageHeight(unitPlaneMap.rows)
+        , _minimumX(0.0f)
+        , _minimumY(0.0f)
+        , _inverseCellSize(0.0f)
+        , _gridColumns(0)
+        , _gridRows(0)
+    {
+        REQUIRES(CV_32FC2 == unitPlaneMap.type());
+
+        //
+        // Find the extent of the field of view, and the typical spacing between two
+        // neighboring pixels.
+        //
+        float minimumX = std::numeric_limits<float>::max();
+        float minimumY = std::numeric_limits<float>::max();
+        float maximumX = -std::numeric_limits<float>::max();
+        float maximumY = -std::numeric_limits<float>::max();
+
+        std::vector<float> spacings;
+
+        for (int32_t v = 0; v < unitPlaneMap.rows; ++v)
+        {
+            const cv::Point2f* row = unitPlaneMap.ptr<cv::Point2f>(v);
+
+            for (int32_t u = 0; u < unitPlaneMap.cols; ++u)
+            {
+                if (!IsValid(row[u]))
+                {
+                    continue;
+                }
+
+                minimumX = std::min(minimumX, row[u].x);
+                minimumY = std::min(minimumY, row[u].y);
+                maximumX = std::max(maximumX, row[u].x);
+                maximumY = std::max(maximumY, row[u].y);
+
+                if (u + 1 < unitPlaneMap.cols && IsValid(row[u + 1]) && 0 == (v % 8))
+                {
+                    spacings.push_back(
+                        static_cast<float>(cv::norm(row[u + 1] - row[u])));
+                }
+            }
+        }
+
+        if (spacings.empty())
+        {
+#if DBG_ENABLE_ERROR_LOGGING
+            DBG_LOG(
+                "UnitPlaneProjector",
+                dbg::LogLevel::Error,
+                L"UnitPlaneProjector::UnitPlaneProjector: the unit plane map has no valid pixels");
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+
+            return;
+        }
+
+        std::nth_element(
+            spacings.begin(),
+            spacings.begin() + spacings.size() / 2,
+            spacings.end());
+
+        //
+        // Cells are about half a pixel wide so that the nearest pixel is resolved
+        // accurately, unless that would make the grid too large.
+        //
+        const float extent =
+            std::max(maximumX - minimumX, maximumY - minimumY);
+
+        const float cellSize =
+            std::max(
+                0.5f * spacings[spacings.size() / 2],
+                extent / (c_maximumGridSize - 2));
+
+        _minimumX = minimumX;
+        _minimumY = minimumY;
+        _inverseCellSize = 1.0f / cellSize;
+
+        _gridColumns = static_cast<int32_t>((maximumX - minimumX) * _inverseCellSize) + 2;
+        _gridRows = static_cast<int32_t>((maximumY - minimumY) * _inverseCellSize) + 2;
+
+        _grid.assign(
+            static_cast<size_t>(_gridColumns) * _gridRows,
+            -1);
+
+        std::vector<float> squaredDistances(
+            _grid.size(),
+            std::numeric_limits<float>::max());
+
+        //
+        // Rasterize the bounding box of each quad of neighboring pixels, keeping the
+        // nearest of its corners in every covered cell.
+        //
+        for (int32_t v = 0; v + 1 < unitPlaneMap.rows; ++v)
+        {
+            const cv::Point2f* row = unitPlaneMap.ptr<cv::Point2f>(v);
+            const cv::Point2f* nextRow = unitPlaneMap.ptr<cv::Point2f>(v + 1);
+
+            for (int32_t u = 0; u + 1 < unitPlaneMap.cols; ++u)
+            {
+                const cv::Point2f corners[4] =
+                {
+                    row[u], row[u + 1], nextRow[u], nextRow[u + 1]
+                };
+
+                const int32_t cornerPixels[4] =
+                {
+                    v * _imageWidth + u,
+                    v * _imageWidth + u + 1,
+                    (v + 1) * _imageWidth + u,
+                    (v + 1) * _imageWidth + u + 1
+                };
+
+                if (!IsValid(corners[0]) || !IsValid(corners[1]) ||
+                    !IsValid(corners[2]) || !IsValid(corners[3]))
+                {
+                    continue;
+                }
+
+                float quadMinimumX = corners[0].x, quadMaximumX = corners[0].x;
+                float quadMinimumY = corners[0].y, quadMaximumY = corners[0].y;
+
+                for (int32_t i = 1; i < 4; ++i)
+                {
+                    quadMinimumX = std::min(quadMinimumX, corners[i].x);
+                    quadMaximumX = std::max(quadMaximumX, corners[i].x);
+                    quadMinimumY = std::min(quadMinimumY, corners[i].y);
+                    quadMaximumY = std::max(quadMaximumY, corners[i].y);
+                }
+
+                const int32_t beginColumn = static_cast<int32_t>((quadMinimumX - _minimumX) * _inverseCellSize);
+                const int32_t endColumn = static_cast<int32_t>((quadMaximumX - _minimumX) * _inverseCellSize);
+                const int32_t beginRow = static_cast<int32_t>((quadMinimumY - _minimumY) * _inverseCellSize);
+                const int32_t endRow = static_cast<int32_t>((quadMaximumY - _minimumY) * _inverseCellSize);
+
+                for (int32_t gridRow = beginRow; gridRow <= endRow; ++gridRow)
+                {
+                    const float centerY =
+                        _minimumY + (gridRow + 0.5f) * cellSize;
+
+                    for (int32_t gridColumn = beginColumn; gridColumn <= endColumn; ++gridColumn)
+                    {
+                        const float centerX =
+                            _minimumX + (gridColumn + 0.5f) * cellSize;
+
+                        const size_t cell =
+                            static_cast<size_t>(gridRow) * _gridColumns + gridColumn;
+
+                        for (int32_t i = 0; i < 4; ++i)
+                        {
+                            const float dx = corners[i].x - centerX;
+                            const float dy = corners[i].y - centerY;
+
+                            const float squaredDistance =
+                                dx * dx + dy * dy;
+
+                            if (squaredDistance < squaredDistances[cell])
+                            {
+                                squaredDistances[cell] = squaredDistance;
+                                _grid[cell] = cornerPixels[i];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int32_t UnitPlaneProjector::GetImageWidth() const
+    {
+        return _imageWidth;
+    }
+
+    int32_t UnitPlaneProjector::GetImageHeight() const
+    {
+        return _imageHeight;
+    }
+
+    int32_t UnitPlaneProjector::Project(
+        _In_ float x,
+        _In_ float y) const
+    {
+        const float column =
+            (x - _minimumX) * _inverseCellSize;
+
+        const float row =
+            (y - _minimumY) * _inverseCellSize;
+
+        //
+        // Written so that NaNs are rejected as well.
+        //
+        if (!(column >= 0.0f && column < _gridColumns &&
+              row >= 0.0f && row < _gridRows))
+        {
+            return -1;
+        }
+
+        return _grid[
+            static_cast<size_t>(row) * _gridColumns + static_cast<size_t>(column)];
+    }
+
+    int32_t UnitPlaneProjector::ProjectCameraSpacePoint(
+        _In_ const cv::Point3f& point) const
+    {
+        if (point.z >= 0.0f)
+        {
+            return -1;
+        }
+
+        const float inverseZ =
+            1.0f / point.z;
+
+        return Project(
+            point.x * inverseZ,
+            point.y * inverseZ);
+    }
+}
@@ -0,0 +1,68 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Inverse of a unit plane map: finds the pixel that observes a given point of the
+    // unit (Z=1) plane.
+    //
+    // The research mode sensors only expose the pixel to unit plane mapping, so the
+    // inverse is tabulated once on a regular grid over the unit plane. Each grid cell
+    // holds the pixel whose unit plane coordinates are the nearest to the cell center,
+    // or -1 if the cell is not covered by the sensor's field of view.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class UnitPlaneProjector
+    {
+    public:
+        //
+        // The unit plane map is a CV_32FC2 image holding the (x, y) unit plane coordinates
+        // of each pixel, +infinity for pixels without a valid mapping.
+        //
+        explicit UnitPlaneProjector(
+            _In_ const cv::Mat& unitPlaneMap);
+
+        int32_t GetImageWidth() const;
+
+        int32_t GetImageHeight() const;
+
+        //
+        // Returns the index (v * width + u) of the pixel observing the given unit plane
+        // point, or -1 if the point is outside of the field of view.
+        //
+        int32_t Project(
+            _In_ float x,
+            _In_ float y) const;
+
+        //
+        // Projects a camera space point (the camera looks down the negative Z axis).
+        //
+        int32_t ProjectCameraSpacePoint(
+            _In_ const cv::Point3f& point) const;
+
+    private:
+        int32_t _imageWidth;
+        int32_t _imageHeight;
+
+        float _minimumX;
+        float _minimumY;
+        float _inverseCellSize;
+
+        int32_t _gridColumns;
+        int32_t _gridRows;
+
+        std::vector<int32_t> _grid;
+    };
+}
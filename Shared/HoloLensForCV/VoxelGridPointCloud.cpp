@@ -0,0 +1,659 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        //
+        // Voxel coordinates are stored on 21 bits each, offset so that the origin lies
+        // in the middle of the range.
+        //
+        const int32_t c_coordinateBits = 21;
+        const int64_t c_coordinateOffset = 1ll << (c_coordinateBits - 1);
+        const int32_t c_rootLevel = c_coordinateBits;
+
+        //
+        // Octree nodes with at most this many points are searched exhaustively.
+        //
+        const size_t c_leafSize = 8;
+
+        //
+        // Voxel blocks hold 8x8x8 voxels, i.e. the 9 least significant bits of the code.
+        //
+        const int32_t c_blockBits = 9;
+        const uint64_t c_localIndexMask = (1ull << c_blockBits) - 1;
+
+        uint64_t SpreadBits(
+            _In_ uint64_t value)
+        {
+            value &= 0x1fffff;
+            value = (value | value << 32) & 0x1f00000000ffffull;
+            value = (value | value << 16) & 0x1f0000ff0000ffull;
+            value = (value | value << 8) & 0x100f00f00f00f00full;
+            value = (value | value << 4) & 0x10c30c30c30c30c3ull;
+            value = (value | value << 2) & 0x1249249249249249ull;
+
+            return value;
+        }
+
+        uint64_t CompactBits(
+            _In_ uint64_t value)
+        {
+            value &= 0x1249249249249249ull;
+            value = (value ^ (value >> 2)) & 0x10c30c30c30c30c3ull;
+            value = (value ^ (value >> 4)) & 0x100f00f00f00f00full;
+            value = (value ^ (value >> 8)) & 0x1f0000ff0000ffull;
+            value = (value ^ (value >> 16)) & 0x1f00000000ffffull;
+            value = (value ^ (value >> 32)) & 0x1fffff;
+
+            return value;
+        }
+
+        uint64_t EncodeMorton(
+            _In_ uint64_t x,
+            _In_ uint64_t y,
+            _In_ uint64_t z)
+        {
+            return SpreadBits(x) | (SpreadBits(y) << 1) | (SpreadBits(z) << 2);
+        }
+
+        size_t SelectShard(
+            _In_ uint64_t blockCode,
+            _In_ size_t numberOfShards)
+        {
+            return static_cast<size_t>((blockCode * 0x9e3779b97f4a7c15ull) >> 32) % numberOfShards;
+        }
+
+        struct QueueEntry
+        {
+            float SquaredDistance;
+
+            size_t Begin;
+            size_t End;
+
+            uint64_t Prefix;
+            int32_t Level;
+
+            bool operator>(
+                _In_ const QueueEntry& other) const
+            {
+                return SquaredDistance > other.SquaredDistance;
+            }
+        };
+
+        struct IndexedVoxel
+        {
+            uint64_t Code;
+            cv::Point3f Point;
+            uint32_t Weight;
+
+            bool operator<(
+                _In_ const IndexedVoxel& other) const
+            {
+                return Code < other.Code;
+            }
+        };
+    }
+
+    VoxelGridPointCloud::Options::Options()
+        : VoxelSizeInMeters(0.01f)
+        , NumberOfShards(64)
+    {
+    }
+
+    VoxelGridPointCloud::VoxelGridPointCloud(
+        _In_ const Options& options)
+        : _options(options)
+        , _numberOfInsertedPoints(0)
+        , _numberOfRejectedPoints(0)
+    {
+        REQUIRES(
+            options.VoxelSizeInMeters > 0.0f &&
+            options.NumberOfShards > 0);
+
+        for (uint32_t i = 0; i < options.NumberOfShards; ++i)
+        {
+            _shards.emplace_back(
+                new Shard());
+        }
+    }
+
+    void VoxelGridPointCloud::Insert(
+        _In_ const std::vector<cv::Point3f>& points)
+    {
+        //
+        // Sorting the points by Morton code groups them by block, so that each shard is
+        // locked once per block rather than once per point.
+        //
+        std::vector<std::pair<uint64_t, uint32_t>> codes;
+
+        codes.reserve(
+            points.size());
+
+        uint64_t numberOfRejectedPoints = 0;
+
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            uint64_t code;
+
+            if (!ComputeVoxelCode(points[i], code))
+            {
+                ++numberOfRejectedPoints;
+                continue;
+            }
+
+            codes.emplace_back(
+                code,
+                static_cast<uint32_t>(i));
+        }
+
+        std::sort(
+            codes.begin(),
+            codes.end());
+
+        size_t runStart = 0;
+
+        while (runStart < codes.size())
+        {
+            const uint64_t blockCode =
+                codes[runStart].first >> c_blockBits;
+
+            size_t runEnd = runStart + 1;
+
+            while (runEnd < codes.size() &&
+                   (codes[runEnd].first >> c_blockBits) == blockCode)
+            {
+                ++runEnd;
+            }
+
+            Shard& shard =
+                *_shards[SelectShard(blockCode, _shards.size())];
+
+            std::lock_guard<std::mutex> lock(
+                shard.Mutex);
+
+            VoxelBlock& block =
+                shard.Blocks[blockCode];
+
+            for (size_t i = runStart; i < runEnd; ++i)
+            {
+                const uint16_t localIndex =
+                    static_cast<uint16_t>(codes[i].first & c_localIndexMask);
+
+                auto entry =
+                    std::lower_bound(
+                        block.begin(),
+                        block.end(),
+                        localIndex,
+                        [](const VoxelEntry& voxel, uint16_t index)
+                {
+                    return voxel.LocalIndex < index;
+                });
+
+                if (block.end() == entry || entry->LocalIndex != localIndex)
+                {
+                    VoxelEntry voxel = {};
+                    voxel.LocalIndex = localIndex;
+
+                    entry =
+                        block.insert(
+                            entry,
+                            voxel);
+                }
+
+                const cv::Point3f& point =
+                    points[codes[i].second];
+
+                ++entry->Count;
+                entry->Sum[0] += point.x;
+                entry->Sum[1] += point.y;
+                entry->Sum[2] += point.z;
+            }
+
+            runStart = runEnd;
+        }
+
+        _numberOfInsertedPoints += points.size();
+        _numberOfRejectedPoints += numberOfRejectedPoints;
+    }
+
+    void VoxelGridPointCloud::InsertBatch(
+        _In_ const std::vector<std::vector<cv::Point3f>>& pointClouds)
+    {
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(pointClouds.size())),
+            [&](const cv::Range& range)
+        {
+            for (int32_t i = range.start; i < range.end; ++i)
+            {
+                Insert(
+                    pointClouds[i]);
+            }
+        });
+    }
+
+    void VoxelGridPointCloud::Clear()
+    {
+        for (auto& shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(
+                shard->Mutex);
+
+            shard->Blocks.clear();
+        }
+
+        _numberOfInsertedPoints = 0;
+        _numberOfRejectedPoints = 0;
+
+        _codes.clear();
+        _points.clear();
+        _weights.clear();
+    }
+
+    uint64_t VoxelGridPointCloud::GetNumberOfInsertedPoints() const
+    {
+        return _numberOfInsertedPoints.load();
+    }
+
+    uint64_t VoxelGridPointCloud::GetNumberOfRejectedPoints() const
+    {
+        return _numberOfRejectedPoints.load();
+    }
+
+    size_t VoxelGridPointCloud::GetNumberOfVoxels() const
+    {
+        size_t numberOfVoxels = 0;
+
+        for (const auto& shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(
+                shard->Mutex);
+
+            for (const auto& block : shard->Blocks)
+            {
+                numberOfVoxels += block.second.size();
+            }
+        }
+
+        return numberOfVoxels;
+    }
+
+    void VoxelGridPointCloud::BuildIndex()
+    {
+        std::vector<std::vector<IndexedVoxel>> shardVoxels(
+            _shards.size());
+
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int32_t>(_shards.size())),
+            [&](const cv::Range& range)
+        {
+            for (int32_t i = range.start; i < range.end; ++i)
+            {
+                Shard& shard = *_shards[i];
+
+                std::lock_guard<std::mutex> lock(
+                    shard.Mutex);
+
+                for (const auto& block : shard.Blocks)
+                {
+                    for (const VoxelEntry& voxel : block.second)
+                    {
+                        const float inverseCount =
+                            1.0f / voxel.Count;
+
+                        IndexedVoxel indexedVoxel;
+
+                        indexedVoxel.Code = (block.first << c_blockBits) | voxel.LocalIndex;
+                        indexedVoxel.Point = cv::Point3f(voxel.Sum[0], voxel.Sum[1], voxel.Sum[2]) * inverseCount;
+                        indexedVoxel.Weight = voxel.Count;
+
+                        shardVoxels[i].push_back(
+                            indexedVoxel);
+                    }
+                }
+            }
+        });
+
+        std::vector<IndexedVoxel> voxels;
+
+        for (auto& shard : shardVoxels)
+        {
+            voxels.insert(
+                voxels.end(),
+                shard.begin(),
+                shard.end());
+
+            std::vector<IndexedVoxel>().swap(shard);
+        }
+
+        std::sort(
+            voxels.begin(),
+            voxels.end());
+
+        _codes.resize(voxels.size());
+        _points.resize(voxels.size());
+        _weights.resize(voxels.size());
+
+        for (size_t i = 0; i < voxels.size(); ++i)
+        {
+            _codes[i] = voxels[i].Code;
+            _points[i] = voxels[i].Point;
+            _weights[i] = voxels[i].Weight;
+        }
+    }
+
+    const std::vector<cv::Point3f>& VoxelGridPointCloud::GetPoints() const
+    {
+        return _points;
+    }
+
+    const std::vector<uint32_t>& VoxelGridPointCloud::GetPointWeights() const
+    {
+        return _weights;
+    }
+
+    void VoxelGridPointCloud::FindWithinRadius(
+        _In_ const cv::Point3f& center,
+        _In_ float radius,
+        _Out_ std::vector<size_t>& indices) const
+    {
+        indices.clear();
+
+        FindWithinRadius(
+            center,
+            radius * radius,
+            0,
+            _codes.size(),
+            0,
+            c_rootLevel,
+            indices);
+    }
+
+    void VoxelGridPointCloud::FindNearestNeighbors(
+        _In_ const cv::Point3f& center,
+        _In_ size_t k,
+        _Out_ std::vector<size_t>& indices,
+        _Out_opt_ std::vector<float>* squaredDistances) const
+    {
+        indices.clear();
+
+        if (nullptr != squaredDistances)
+        {
+            squaredDistances->clear();
+        }
+
+        if (0 == k || _codes.empty())
+        {
+            return;
+        }
+
+        //
+        // Best-first traversal: nodes are visited by increasing distance to the query
+        // point, until the nearest remaining node is farther than the k-th best point.
+        //
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+        std::priority_queue<std::pair<float, size_t>> best;
+
+        QueueEntry root;
+        root.SquaredDistance = 0.0f;
+        root.Begin = 0;
+        root.End = _codes.size();
+        root.Prefix = 0;
+        root.Level = c_rootLevel;
+
+        queue.push(root);
+
+        while (!queue.empty())
+        {
+            const QueueEntry entry = queue.top();
+            queue.pop();
+
+            if (best.size() == k &&
+                entry.SquaredDistance > best.top().first)
+            {
+                break;
+            }
+
+            if (0 == entry.Level || entry.End - entry.Begin <= c_leafSize)
+            {
+                for (size_t i = entry.Begin; i < entry.End; ++i)
+                {
+                    const cv::Point3f delta = _points[i] - center;
+
+                    const float squaredDistance =
+                        delta.dot(delta);
+
+                    if (best.size() < k)
+                    {
+                        best.emplace(squaredDistance, i);
+                    }
+                    else if (squaredDistance < best.top().first)
+                    {
+                        best.pop();
+                        best.emplace(squaredDistance, i);
+                    }
+                }
+
+                continue;
+            }
+
+            size_t childBegin = entry.Begin;
+
+            for (uint64_t child = 0; child < 8 && childBegin < entry.End; ++child)
+            {
+                QueueEntry childEntry;
+
+                childEntry.Prefix = (entry.Prefix << 3) | child;
+                childEntry.Level = entry.Level - 1;
+                childEntry.Begin = childBegin;
+                childEntry.End = FindChildEnd(childBegin, entry.End, childEntry.Prefix, childEntry.Level);
+
+                childBegin = childEntry.End;
+
+                if (childEntry.Begin == childEntry.End)
+                {
+                    continue;
+                }
+
+                childEntry.SquaredDistance =
+                    ComputeSquaredDistanceToNode(
+                        center,
+                        childEntry.Prefix,
+                        childEntry.Level);
+
+                queue.push(childEntry);
+            }
+        }
+
+        indices.resize(best.size());
+
+        if (nullptr != squaredDistances)
+        {
+            squaredDistances->resize(best.size());
+        }
+
+        for (size_t i = best.size(); i > 0; --i)
+        {
+            indices[i - 1] = best.top().second;
+
+            if (nullptr != squaredDistances)
+            {
+                (*squaredDistances)[i - 1] = best.top().first;
+            }
+
+            best.pop();
+        }
+    }
+
+    bool VoxelGridPointCloud::WritePly(
+        _In_ const std::string& fileName) const
+    {
+        return PointCloudGenerator::WritePly(
+            fileName,
+            _points);
+    }
+
+    bool VoxelGridPointCloud::ComputeVoxelCode(
+        _In_ const cv::Point3f& point,
+        _Out_ uint64_t& code) const
+    {
+        const float inverseVoxelSize =
+            1.0f / _options.VoxelSizeInMeters;
+
+        const float coordinates[3] =
+        {
+            std::floor(point.x * inverseVoxelSize),
+            std::floor(point.y * inverseVoxelSize),
+            std::floor(point.z * inverseVoxelSize)
+        };
+
+        uint64_t offsetCoordinates[3];
+
+        for (int32_t axis = 0; axis < 3; ++axis)
+        {
+            //
+            // Also rejects NaNs.
+            //
+            if (!(coordinates[axis] >= -c_coordinateOffset &&
+                  coordinates[axis] < c_coordinateOffset))
+            {
+                code = 0;
+
+                return false;
+            }
+
+            offsetCoordinates[axis] =
+                static_cast<uint64_t>(static_cast<int64_t>(coordinates[axis]) + c_coordinateOffset);
+        }
+
+        code =
+            EncodeMorton(
+                offsetCoordinates[0],
+                offsetCoordinates[1],
+                offsetCoordinates[2]);
+
+        return true;
+    }
+
+    void VoxelGridPointCloud::ComputeNodeBounds(
+        _In_ uint64_t prefix,
+        _In_ int32_t level,
+        _Out_ cv::Point3f& minimum,
+        _Out_ cv::Point3f& maximum) const
+    {
+        const int64_t nodeSize = 1ll << level;
+
+        const int64_t x = (static_cast<int64_t>(CompactBits(prefix)) << level) - c_coordinateOffset;
+        const int64_t y = (static_cast<int64_t>(CompactBits(prefix >> 1)) << level) - c_coordinateOffset;
+        const int64_t z = (static_cast<int64_t>(CompactBits(prefix >> 2)) << level) - c_coordinateOffset;
+
+        const float voxelSize =
+            _options.VoxelSizeInMeters;
+
+        minimum = cv::Point3f(x * voxelSize, y * voxelSize, z * voxelSize);
+        maximum = cv::Point3f((x + nodeSize) * voxelSize, (y + nodeSize) * voxelSize, (z + nodeSize) * voxelSize);
+    }
+
+    float VoxelGridPointCloud::ComputeSquaredDistanceToNode(
+        _In_ const cv::Point3f& point,
+        _In_ uint64_t prefix,
+        _In_ int32_t level) const
+    {
+        cv::Point3f minimum, maximum;
+
+        ComputeNodeBounds(
+            prefix,
+            level,
+            minimum,
+            maximum);
+
+        const float dx = std::max(0.0f, std::max(minimum.x - point.x, point.x - maximum.x));
+        const float dy = std::max(0.0f, std::max(minimum.y - point.y, point.y - maximum.y));
+        const float dz = std::max(0.0f, std::max(minimum.z - point.z, point.z - maximum.z));
+
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    size_t VoxelGridPointCloud::FindChildEnd(
+        _In_ size_t begin,
+        _In_ size_t end,
+        _In_ uint64_t childPrefix,
+        _In_ int32_t childLevel) const
+    {
+        //
+        // The codes of a node's voxels share its prefix, so the child ends where the
+        // codes reach the next prefix.
+        //
+        const uint64_t endCode =
+            (childPrefix + 1) << (3 * childLevel);
+
+        return static_cast<size_t>(
+            std::lower_bound(
+                _codes.begin() + begin,
+                _codes.begin() + end,
+                endCode) - _codes.begin());
+    }
+
+    void VoxelGridPointCloud::FindWithinRadius(
+        _In_ const cv::Point3f& center,
+        _In_ float squaredRadius,
+        _In_ size_t begin,
+        _In_ size_t end,
+        _In_ uint64_t prefix,
+        _In_ int32_t level,
+        _Inout_ std::vector<size_t>& indices) const
+    {
+        if (begin == end ||
+            ComputeSquaredDistanceToNode(center, prefix, level) > squaredRadius)
+        {
+            return;
+        }
+
+        if (0 == level || end - begin <= c_leafSize)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const cv::Point3f delta = _points[i] - center;
+
+                if (delta.dot(delta) <= squaredRadius)
+                {
+                    indices.push_back(i);
+                }
+            }
+
+            return;
+        }
+
+        for (uint64_t child = 0; child < 8 && begin < end; ++child)
+        {
+            const uint64_t childPrefix =
+                (prefix << 3) | child;
+
+            const size_t childEnd =
+                FindChildEnd(begin, end, childPrefix, level - 1);
+
+            FindWithinRadius(
+                center,
+                squaredRadius,
+                begin,
+                childEnd,
+                childPrefix,
+                level - 1,
+                indices);
+
+            begin = childEnd;
+        }
+    }
+}
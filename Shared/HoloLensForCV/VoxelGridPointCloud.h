@@ -0,0 +1,169 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace HoloLensForCV
+{
+    //
+    // Point cloud merging points from many frames, deduplicated on a voxel grid.
+    //
+    // Points falling into the same voxel are averaged. Voxels are identified by the Morton
+    // code (Z-order) of their integer coordinates and grouped in blocks of 8x8x8 voxels,
+    // which are spread over independently locked shards so that several frames can be
+    // inserted concurrently.
+    //
+    // Once all the points have been inserted, BuildIndex sorts the voxels by Morton code.
+    // The sorted codes form a linear octree: the voxels of any octree node are stored
+    // contiguously, so radius and k-nearest-neighbor queries only need binary searches
+    // over a cache-friendly array.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class VoxelGridPointCloud
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            float VoxelSizeInMeters;
+
+            // Number of independently locked partitions of the voxel blocks.
+            uint32_t NumberOfShards;
+        };
+
+        explicit VoxelGridPointCloud(
+            _In_ const Options& options = Options());
+
+        //
+        // Adds the points of a frame. May be called from several threads.
+        //
+        void Insert(
+            _In_ const std::vector<cv::Point3f>& points);
+
+        //
+        // Adds the points of several frames, in parallel across frames.
+        //
+        void InsertBatch(
+            _In_ const std::vector<std::vector<cv::Point3f>>& pointClouds);
+
+        void Clear();
+
+        //
+        // Number of points passed to Insert, and number of points rejected because they
+        // lie too far from the origin to be indexed.
+        //
+        uint64_t GetNumberOfInsertedPoints() const;
+
+        uint64_t GetNumberOfRejectedPoints() const;
+
+        //
+        // Number of occupied voxels.
+        //
+        size_t GetNumberOfVoxels() const;
+
+        //
+        // Sorts the voxels by Morton code. Must be called after the last insertion and
+        // before any query.
+        //
+        void BuildIndex();
+
+        //
+        // The deduplicated points, in Morton order. Query results index into this array.
+        //
+        const std::vector<cv::Point3f>& GetPoints() const;
+
+        //
+        // Number of input points merged into each of the deduplicated points.
+        //
+        const std::vector<uint32_t>& GetPointWeights() const;
+
+        void FindWithinRadius(
+            _In_ const cv::Point3f& center,
+            _In_ float radius,
+            _Out_ std::vector<size_t>& indices) const;
+
+        //
+        // Finds the k nearest points, sorted by increasing distance.
+        //
+        void FindNearestNeighbors(
+            _In_ const cv::Point3f& center,
+            _In_ size_t k,
+            _Out_ std::vector<size_t>& indices,
+            _Out_opt_ std::vector<float>* squaredDistances = nullptr) const;
+
+        bool WritePly(
+            _In_ const std::string& fileName) const;
+
+    private:
+        struct VoxelEntry
+        {
+            uint16_t LocalIndex;
+            uint32_t Count;
+            float Sum[3];
+        };
+
+        //
+        // Occupied voxels of an 8x8x8 block, sorted by their index in the block.
+        //
+        typedef std::vector<VoxelEntry> VoxelBlock;
+
+        struct Shard
+        {
+            std::mutex Mutex;
+            std::unordered_map<uint64_t, VoxelBlock> Blocks;
+        };
+
+        bool ComputeVoxelCode(
+            _In_ const cv::Point3f& point,
+            _Out_ uint64_t& code) const;
+
+        void ComputeNodeBounds(
+            _In_ uint64_t prefix,
+            _In_ int32_t level,
+            _Out_ cv::Point3f& minimum,
+            _Out_ cv::Point3f& maximum) const;
+
+        float ComputeSquaredDistanceToNode(
+            _In_ const cv::Point3f& point,
+            _In_ uint64_t prefix,
+            _In_ int32_t level) const;
+
+        size_t FindChildEnd(
+            _In_ size_t begin,
+            _In_ size_t end,
+            _In_ uint64_t childPrefix,
+            _In_ int32_t childLevel) const;
+
+        void FindWithinRadius(
+            _In_ const cv::Point3f& center,
+            _In_ float squaredRadius,
+            _In_ size_t begin,
+            _In_ size_t end,
+            _In_ uint64_t prefix,
+            _In_ int32_t level,
+            _Inout_ std::vector<size_t>& indices) const;
+
+    private:
+        Options _options;
+
+        std::vector<std::unique_ptr<Shard>> _shards;
+
+        std::atomic<uint64_t> _numberOfInsertedPoints;
+        std::atomic<uint64_t> _numberOfRejectedPoints;
+
+        // The index, built by BuildIndex.
+        std::vector<uint64_t> _codes;
+        std::vector<cv::Point3f> _points;
+        std::vector<uint32_t> _weights;
+    };
+}
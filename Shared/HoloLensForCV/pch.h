@@ -22,8 +22,16 @@
 #include <sstream>
 #include <cstddef>
 #include <stdexcept>
+#include <atomic>
+#include <numeric>
+#include <functional>
+#include <thread>
+#include <condition_variable>
 #include <shared_mutex>
 #include <unordered_set>
+#include <unordered_map>
+#include <queue>
+#include <random>
 
 #include <agile.h>
 #include <collection.h>
@@ -42,8 +50,7 @@
 
 #include <Debugging/All.h>
 #include <Io/All.h>
-
-#include "CsvWriter.h"
+#include <Playback/All.h>
 
 #include "ICameraIntrinsics.h"
 #include "CameraIntrinsics.h"
@@ -51,12 +58,14 @@
 #include "SpatialPerception.h"
 
 #include "SensorType.h"
+#include "SensorFrameTrace.h"
 #include "SensorFrame.h"
 
 #include "ISensorFrameSink.h"
 #include "ISensorFrameSinkGroup.h"
 
 #include "SensorFrameStreamHeader.h"
+#include "StreamingServerMetrics.h"
 #include "SensorFrameStreamingServer.h"
 #include "SensorFrameStreamer.h"
 #include "SensorFrameReceiver.h"
@@ -76,3 +85,39 @@
 
 #include "opencv2/core.hpp"
 #include "opencv2/imgproc.hpp"
+#include "opencv2/calib3d.hpp"
+#include "opencv2/aruco.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+#include "ImagePyramid.h"
+
+#include "FeatureExtractor.h"
+#include "SensorFrameFeatures.h"
+
+#include "SensorFramePlayer.h"
+
+#include "SensorFramePipelineBenchmark.h"
+
+#include "PointCloudGenerator.h"
+#include "UnitPlaneProjector.h"
+#include "TsdfVolume.h"
+#include "VoxelGridPointCloud.h"
+#include "SensorPoseTrack.h"
+#include "DepthToColorRegistration.h"
+#include "DepthFrameFilter.h"
+#include "DepthFrameFilterSink.h"
+#include "DepthFrameFilterSinkGroup.h"
+#include "SurfaceNormalEstimator.h"
+#include "HeightMap.h"
+#include "HeightMapStreamingServer.h"
+#include "PlaneDetector.h"
+#include "PlaneDetectionSink.h"
+#include "StereoRectifier.h"
+#include "StereoBlockMatcher.h"
+#include "StereoDisparitySink.h"
+#include "StereoDisparitySinkGroup.h"
+#include "FeatureExtractionSink.h"
+#include "FeatureExtractionSinkGroup.h"
+#include "MarkerDetector.h"
+#include "MarkerStreamingServer.h"
+#include "MetricsServer.h"
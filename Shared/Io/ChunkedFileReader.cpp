@@ -0,0 +1,366 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace Io
+{
+    namespace
+    {
+        bool GetStreamSize(
+            _In_ std::FILE* file,
+            _Out_ uint64_t& size)
+        {
+#if defined(_WIN32)
+            if (0 != _fseeki64(file, 0, SEEK_END))
+            {
+                return false;
+            }
+
+            const int64_t end = _ftelli64(file);
+
+            if (end < 0 || 0 != _fseeki64(file, 0, SEEK_SET))
+            {
+                return false;
+            }
+#else
+            if (0 != fseeko(file, 0, SEEK_END))
+            {
+                return false;
+            }
+
+            const int64_t end = ftello(file);
+
+            if (end < 0 || 0 != fseeko(file, 0, SEEK_SET))
+            {
+                return false;
+            }
+#endif /* defined(_WIN32) */
+
+            size = static_cast<uint64_t>(end);
+
+            return true;
+        }
+    }
+
+    ChunkedFileReader::Options::Options()
+        : ChunkSize(4 * 1024 * 1024)
+        , ReadAheadChunks(2)
+    {
+    }
+
+    ChunkedFileReader::ChunkedFileReader(
+        _In_ const Options& options)
+        : _options(options)
+        , _file(nullptr)
+        , _fileSize(0)
+        , _endOfFile(true)
+        , _failed(false)
+        , _stopRequested(false)
+        , _currentChunkOffset(0)
+    {
+    }
+
+    ChunkedFileReader::~ChunkedFileReader()
+    {
+        Close();
+    }
+
+#if defined(_WIN32)
+    bool ChunkedFileReader::Open(
+        _In_ const std::string& fileName)
+    {
+        return Open(
+            Utf8ToUtf16(fileName));
+    }
+
+    bool ChunkedFileReader::Open(
+        _In_ const std::wstring& fileName)
+    {
+        Close();
+
+        std::FILE* file = nullptr;
+
+        if (0 != _wfopen_s(&file, fileName.c_str(), L"rb"))
+        {
+            return false;
+        }
+
+        return Start(
+            file);
+    }
+#else
+    bool ChunkedFileReader::Open(
+        _In_ const std::string& fileName)
+    {
+        Close();
+
+        std::FILE* file =
+            std::fopen(fileName.c_str(), "rb");
+
+        if (nullptr == file)
+        {
+            return false;
+        }
+
+        return Start(
+            file);
+    }
+#endif /* defined(_WIN32) */
+
+    bool ChunkedFileReader::Start(
+        _In_ std::FILE* file)
+    {
+        _file = file;
+
+        if (!GetStreamSize(_file, _fileSize))
+        {
+            Close();
+
+            return false;
+        }
+
+        //
+        // The chunks are large enough that the C runtime's own buffering would only add
+        // a copy.
+        //
+        std::setvbuf(
+            _file,
+            nullptr,
+            _IONBF,
+            0);
+
+        _readyChunks.clear();
+        _freeBuffers.assign(
+            _options.ReadAheadChunks + 1,
+            std::vector<uint8_t>());
+
+        _endOfFile = false;
+        _failed = false;
+        _stopRequested = false;
+
+        _currentChunk.clear();
+        _currentChunkOffset = 0;
+
+        _thread = std::thread(
+            [this]()
+        {
+            ReadAhead();
+        });
+
+        return true;
+    }
+
+    void ChunkedFileReader::Close()
+    {
+        if (_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> guard(
+                    _mutex);
+
+                _stopRequested = true;
+            }
+
+            _bufferAvailable.notify_all();
+
+            _thread.join();
+        }
+
+        if (nullptr != _file)
+        {
+            std::fclose(
+                _file);
+
+            _file = nullptr;
+        }
+
+        _fileSize = 0;
+
+        _readyChunks.clear();
+        _freeBuffers.clear();
+        _endOfFile = true;
+        _stopRequested = false;
+
+        _currentChunk.clear();
+        _currentChunkOffset = 0;
+    }
+
+    uint64_t ChunkedFileReader::GetFileSize() const
+    {
+        return _fileSize;
+    }
+
+    void ChunkedFileReader::ReadAhead()
+    {
+        const size_t chunkSize =
+            std::max<size_t>(_options.ChunkSize, 1);
+
+        for (;;)
+        {
+            std::vector<uint8_t> buffer;
+
+            {
+                std::unique_lock<std::mutex> lock(
+                    _mutex);
+
+                _bufferAvailable.wait(
+                    lock,
+                    [this]() { return _stopRequested || !_freeBuffers.empty(); });
+
+                if (_stopRequested)
+                {
+                    return;
+                }
+
+                buffer = std::move(_freeBuffers.back());
+
+                _freeBuffers.pop_back();
+            }
+
+            buffer.resize(
+                chunkSize);
+
+            const size_t numberOfBytesRead =
+                std::fread(
+                    buffer.data(),
+                    1 /* size */,
+                    chunkSize,
+                    _file);
+
+            buffer.resize(
+                numberOfBytesRead);
+
+            const bool endOfFile =
+                numberOfBytesRead < chunkSize;
+
+            {
+                std::lock_guard<std::mutex> guard(
+                    _mutex);
+
+                if (0 != numberOfBytesRead)
+                {
+                    _readyChunks.push_back(
+                        std::move(buffer));
+                }
+
+                if (endOfFile)
+                {
+                    _failed = 0 != std::ferror(_file);
+                    _endOfFile = true;
+                }
+            }
+
+            _chunkReady.notify_one();
+
+            if (endOfFile)
+            {
+                return;
+            }
+        }
+    }
+
+    bool ChunkedFileReader::FetchNextChunk()
+    {
+        if (nullptr == _file)
+        {
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(
+            _mutex);
+
+        //
+        // Hand the current chunk's buffer back to the read-ahead thread.
+        //
+        if (0 != _currentChunk.capacity())
+        {
+            _freeBuffers.push_back(
+                std::move(_currentChunk));
+
+            _bufferAvailable.notify_one();
+        }
+
+        _currentChunk = std::vector<uint8_t>();
+        _currentChunkOffset = 0;
+
+        _chunkReady.wait(
+            lock,
+            [this]() { return _endOfFile || !_readyChunks.empty(); });
+
+        if (_readyChunks.empty())
+        {
+            return false;
+        }
+
+        _currentChunk = std::move(_readyChunks.front());
+
+        _readyChunks.pop_front();
+
+        return true;
+    }
+
+    ByteSpan ChunkedFileReader::ReadNextChunk()
+    {
+        if (_currentChunkOffset == _currentChunk.size() &&
+            !FetchNextChunk())
+        {
+            return ByteSpan();
+        }
+
+        const ByteSpan chunk(
+            _currentChunk.data() + _currentChunkOffset,
+            _currentChunk.size() - _currentChunkOffset);
+
+        _currentChunkOffset = _currentChunk.size();
+
+        return chunk;
+    }
+
+    size_t ChunkedFileReader::Read(
+        _Out_writes_bytes_(size) uint8_t* buffer,
+        _In_ size_t size)
+    {
+        size_t numberOfBytesCopied = 0;
+
+        while (numberOfBytesCopied < size)
+        {
+            if (_currentChunkOffset == _currentChunk.size() &&
+                !FetchNextChunk())
+            {
+                break;
+            }
+
+            const size_t numberOfBytesToCopy =
+                std::min(
+                    size - numberOfBytesCopied,
+                    _currentChunk.size() - _currentChunkOffset);
+
+            std::memcpy(
+                buffer + numberOfBytesCopied,
+                _currentChunk.data() + _currentChunkOffset,
+                numberOfBytesToCopy);
+
+            numberOfBytesCopied += numberOfBytesToCopy;
+            _currentChunkOffset += numberOfBytesToCopy;
+        }
+
+        return numberOfBytesCopied;
+    }
+
+    bool ChunkedFileReader::HasFailed() const
+    {
+        std::lock_guard<std::mutex> guard(
+            _mutex);
+
+        return _failed;
+    }
+}
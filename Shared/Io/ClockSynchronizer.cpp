@@ -0,0 +1,666 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace Io
+{
+    namespace
+    {
+        //
+        // Adds (referenceTicks - referenceOrigin) * rate to targetOrigin, scaling only the
+        // deviation of the rate from one, so that the result is exact for a rate of one.
+        //
+        int64_t MapLinearly(
+            _In_ const int64_t referenceOrigin,
+            _In_ const int64_t targetOrigin,
+            _In_ const double rate,
+            _In_ const int64_t referenceTicks)
+        {
+            const int64_t elapsedTicks =
+                referenceTicks - referenceOrigin;
+
+            return targetOrigin + elapsedTicks +
+                std::llround(static_cast<double>(elapsedTicks) * (rate - 1.0));
+        }
+
+        //
+        // Least squares fit of y = intercept + slope * x to the points selected by the mask;
+        // falls back to the mean of y (and a zero slope) if the x values do not vary.
+        //
+        void FitLine(
+            _In_ const std::vector<double>& x,
+            _In_ const std::vector<double>& y,
+            _In_ const std::vector<bool>& mask,
+            _Out_ double& intercept,
+            _Out_ double& slope)
+        {
+            double count = 0.0;
+            double sumX = 0.0;
+            double sumY = 0.0;
+
+            for (size_t i = 0; i < x.size(); ++i)
+            {
+                if (mask[i])
+                {
+                    count += 1.0;
+                    sumX += x[i];
+                    sumY += y[i];
+                }
+            }
+
+            intercept = 0.0;
+            slope = 0.0;
+
+            if (0.0 == count)
+            {
+                return;
+            }
+
+            const double meanX = sumX / count;
+            const double meanY = sumY / count;
+
+            double sxx = 0.0;
+            double sxy = 0.0;
+
+            for (size_t i = 0; i < x.size(); ++i)
+            {
+                if (mask[i])
+                {
+                    sxx += (x[i] - meanX) * (x[i] - meanX);
+                    sxy += (x[i] - meanX) * (y[i] - meanY);
+                }
+            }
+
+            if (sxx > 0.0)
+            {
+                slope = sxy / sxx;
+            }
+
+            intercept = meanY - slope * meanX;
+        }
+
+        double Median(
+            _Inout_ std::vector<double>& values)
+        {
+            const size_t middle =
+                values.size() / 2;
+
+            std::nth_element(
+                values.begin(),
+                values.begin() + middle,
+                values.end());
+
+            double median =
+                values[middle];
+
+            if (0 == values.size() % 2)
+            {
+                median = 0.5 * (median +
+                    *std::max_element(values.begin(), values.begin() + middle));
+            }
+
+            return median;
+        }
+    }
+
+    ClockSample::ClockSample()
+        : ReferenceTicks(0)
+        , TargetTicks(0)
+        , UncertaintyTicks(0)
+    {
+    }
+
+    ClockFit::ClockFit()
+        : IsValid(false)
+        , ReferenceOrigin(0)
+        , TargetOrigin(0)
+        , Rate(1.0)
+        , ResidualRootMeanSquare(0.0)
+        , NumberOfSamples(0)
+        , NumberOfInliers(0)
+    {
+    }
+
+    int64_t ClockFit::Map(
+        _In_ const int64_t referenceTicks) const
+    {
+        return MapLinearly(
+            ReferenceOrigin,
+            TargetOrigin,
+            Rate,
+            referenceTicks);
+    }
+
+    ClockDriftEstimator::Options::Options()
+        : WindowSize(64)
+        , UncertaintyMultiplier(2.0)
+        , MinimumUncertaintyTicks(10)
+        , OutlierThreshold(3.0)
+        , MinimumOutlierTicks(10)
+        , MaximumRateDeviation(1e-3)
+    {
+    }
+
+    ClockDriftEstimator::ClockDriftEstimator(
+        _In_ const Options& options)
+        : _options(options)
+    {
+    }
+
+    void ClockDriftEstimator::AddSample(
+        _In_ const ClockSample& sample)
+    {
+        _samples.push_back(
+            sample);
+
+        while (_samples.size() > std::max<size_t>(_options.WindowSize, 1))
+        {
+            _samples.pop_front();
+        }
+    }
+
+    ClockFit ClockDriftEstimator::Fit() const
+    {
+        ClockFit fit;
+
+        if (_samples.empty())
+        {
+            return fit;
+        }
+
+        int64_t minimumUncertaintyTicks =
+            _samples.front().UncertaintyTicks;
+
+        for (const ClockSample& sample : _samples)
+        {
+            minimumUncertaintyTicks =
+                std::min(minimumUncertaintyTicks, sample.UncertaintyTicks);
+        }
+
+        const double uncertaintyLimit =
+            std::max(
+                static_cast<double>(minimumUncertaintyTicks) * _options.UncertaintyMultiplier,
+                static_cast<double>(_options.MinimumUncertaintyTicks));
+
+        std::vector<const ClockSample*> samples;
+
+        for (const ClockSample& sample : _samples)
+        {
+            if (static_cast<double>(sample.UncertaintyTicks) <= uncertaintyLimit)
+            {
+                samples.push_back(&sample);
+            }
+        }
+
+        //
+        // Fit the offset between the clocks relative to that of the most recent sample,
+        // against the time elapsed since it, to keep the values small.
+        //
+        const ClockSample& origin =
+            *samples.back();
+
+        const int64_t originOffset =
+            origin.TargetTicks - origin.ReferenceTicks;
+
+        std::vector<double> x(samples.size());
+        std::vector<double> y(samples.size());
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            x[i] = static_cast<double>(samples[i]->ReferenceTicks - origin.ReferenceTicks);
+            y[i] = static_cast<double>(samples[i]->TargetTicks - samples[i]->ReferenceTicks - originOffset);
+        }
+
+        std::vector<bool> inliers(samples.size(), true);
+
+        double intercept = 0.0;
+        double slope = 0.0;
+
+        FitLine(
+            x, y, inliers,
+            intercept, slope);
+
+        //
+        // Reject the samples whose residual is far from the median residual, and refit.
+        //
+        std::vector<double> residuals(samples.size());
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            residuals[i] = y[i] - (intercept + slope * x[i]);
+        }
+
+        std::vector<double> scratch(residuals);
+
+        const double medianResidual =
+            Median(scratch);
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            scratch[i] = std::abs(residuals[i] - medianResidual);
+        }
+
+        const double medianAbsoluteDeviation =
+            Median(scratch);
+
+        const double outlierLimit =
+            std::max(
+                _options.OutlierThreshold * 1.4826 * medianAbsoluteDeviation,
+                static_cast<double>(_options.MinimumOutlierTicks));
+
+        uint32_t numberOfInliers = 0;
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            inliers[i] =
+                std::abs(residuals[i] - medianResidual) <= outlierLimit;
+
+            if (inliers[i])
+            {
+                ++numberOfInliers;
+            }
+        }
+
+        FitLine(
+            x, y, inliers,
+            intercept, slope);
+
+        slope =
+            std::max(-_options.MaximumRateDeviation, std::min(_options.MaximumRateDeviation, slope));
+
+        double sumOfSquaredResiduals = 0.0;
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            if (inliers[i])
+            {
+                const double residual =
+                    y[i] - (intercept + slope * x[i]);
+
+                sumOfSquaredResiduals += residual * residual;
+            }
+        }
+
+        fit.IsValid = true;
+        fit.ReferenceOrigin = origin.ReferenceTicks;
+        fit.TargetOrigin = origin.ReferenceTicks + originOffset + std::llround(intercept);
+        fit.Rate = 1.0 + slope;
+        fit.ResidualRootMeanSquare = std::sqrt(sumOfSquaredResiduals / std::max<uint32_t>(numberOfInliers, 1));
+        fit.NumberOfSamples = static_cast<uint32_t>(samples.size());
+        fit.NumberOfInliers = numberOfInliers;
+
+        return fit;
+    }
+
+    size_t ClockDriftEstimator::GetNumberOfSamples() const
+    {
+        return _samples.size();
+    }
+
+    void ClockDriftEstimator::Reset()
+    {
+        _samples.clear();
+    }
+
+    ClockSynchronizationRecord::ClockSynchronizationRecord()
+        : UpdateIndex(0)
+        , DriftPartsPerMillion(0.0)
+        , CorrectionTicks(0)
+        , Stepped(false)
+        , ResidualRootMeanSquare(0.0)
+        , NumberOfInliers(0)
+    {
+    }
+
+    ClockSynchronizer::Options::Options()
+        : SamplesPerUpdate(8)
+        , MaximumSlewRate(500e-6)
+        , MaximumSlewTicks(1'280'000)
+        , RecordCapacity(7200)
+    {
+    }
+
+    ClockSynchronizer::ClockSynchronizer(
+        _In_ const ClockFunction& readReferenceClock,
+        _In_ const ClockFunction& readTargetClock,
+        _In_ const Options& options)
+        : _readReferenceClock(readReferenceClock)
+        , _readTargetClock(readTargetClock)
+        , _options(options)
+        , _sequence(0)
+        , _published(false)
+        , _anchorReference(0)
+        , _anchorTarget(0)
+        , _slewRate(1.0)
+        , _convergenceReference(0)
+        , _fitReferenceOrigin(0)
+        , _fitTargetOrigin(0)
+        , _fitRate(1.0)
+        , _estimator(options.EstimatorOptions)
+        , _mapping()
+        , _hasMapping(false)
+        , _numberOfUpdates(0)
+        , _stopRequested(false)
+    {
+    }
+
+    ClockSynchronizer::~ClockSynchronizer()
+    {
+        Stop();
+    }
+
+    ClockSample ClockSynchronizer::TakeSample() const
+    {
+        ClockSample bestSample;
+
+        for (uint32_t i = 0; i < std::max<uint32_t>(_options.SamplesPerUpdate, 1); ++i)
+        {
+            const int64_t referenceBeforeTicks =
+                _readReferenceClock();
+
+            const int64_t targetTicks =
+                _readTargetClock();
+
+            const int64_t referenceAfterTicks =
+                _readReferenceClock();
+
+            ClockSample sample;
+
+            sample.ReferenceTicks = referenceBeforeTicks + (referenceAfterTicks - referenceBeforeTicks) / 2;
+            sample.TargetTicks = targetTicks;
+            sample.UncertaintyTicks = (referenceAfterTicks - referenceBeforeTicks + 1) / 2;
+
+            if (0 == i || sample.UncertaintyTicks < bestSample.UncertaintyTicks)
+            {
+                bestSample = sample;
+            }
+        }
+
+        return bestSample;
+    }
+
+    void ClockSynchronizer::Update()
+    {
+        std::lock_guard<std::mutex> updateGuard(
+            _updateMutex);
+
+        const ClockSample sample =
+            TakeSample();
+
+        _estimator.AddSample(
+            sample);
+
+        ClockFit fit =
+            _estimator.Fit();
+
+        //
+        // The earlier samples predate a step of the target clock: start over.
+        //
+        if (std::abs(fit.Map(sample.ReferenceTicks) - sample.TargetTicks) > _options.MaximumSlewTicks)
+        {
+            _estimator.Reset();
+
+            _estimator.AddSample(
+                sample);
+
+            fit = _estimator.Fit();
+        }
+
+        const int64_t now =
+            sample.ReferenceTicks;
+
+        const int64_t fitTargetTicks =
+            fit.Map(now);
+
+        ClockSynchronizationRecord record;
+
+        record.UpdateIndex = ++_numberOfUpdates;
+        record.Sample = sample;
+        record.DriftPartsPerMillion = (fit.Rate - 1.0) * 1e6;
+        record.ResidualRootMeanSquare = fit.ResidualRootMeanSquare;
+        record.NumberOfInliers = fit.NumberOfInliers;
+
+        Mapping mapping;
+
+        mapping.AnchorReference = now;
+        mapping.AnchorTarget = fitTargetTicks;
+        mapping.SlewRate = fit.Rate;
+        mapping.ConvergenceReference = now;
+        mapping.Fit = fit;
+
+        if (_hasMapping)
+        {
+            const int64_t currentTargetTicks =
+                Map(_mapping, now);
+
+            record.CorrectionTicks =
+                fitTargetTicks - currentTargetTicks;
+
+            if (std::abs(record.CorrectionTicks) > _options.MaximumSlewTicks)
+            {
+                record.Stepped = true;
+            }
+            else if (0 != record.CorrectionTicks)
+            {
+                //
+                // Continue from the current mapping, with a rate that reaches the fit
+                // once the correction has been applied at the maximum slew rate.
+                //
+                const int64_t slewDurationTicks =
+                    static_cast<int64_t>(
+                        std::ceil(std::abs(static_cast<double>(record.CorrectionTicks)) / _options.MaximumSlewRate));
+
+                mapping.AnchorTarget = currentTargetTicks;
+                mapping.SlewRate = fit.Rate + static_cast<double>(record.CorrectionTicks) / static_cast<double>(slewDurationTicks);
+                mapping.ConvergenceReference = now + slewDurationTicks;
+            }
+        }
+
+        Publish(
+            mapping);
+
+        _mapping = mapping;
+        _hasMapping = true;
+
+        _records.push_back(
+            record);
+
+        while (_records.size() > _options.RecordCapacity)
+        {
+            _records.pop_front();
+        }
+    }
+
+    void ClockSynchronizer::Publish(
+        _In_ const Mapping& mapping)
+    {
+        const uint32_t sequence =
+            _sequence.load(std::memory_order_relaxed);
+
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        _anchorReference.store(mapping.AnchorReference, std::memory_order_relaxed);
+        _anchorTarget.store(mapping.AnchorTarget, std::memory_order_relaxed);
+        _slewRate.store(mapping.SlewRate, std::memory_order_relaxed);
+        _convergenceReference.store(mapping.ConvergenceReference, std::memory_order_relaxed);
+        _fitReferenceOrigin.store(mapping.Fit.ReferenceOrigin, std::memory_order_relaxed);
+        _fitTargetOrigin.store(mapping.Fit.TargetOrigin, std::memory_order_relaxed);
+        _fitRate.store(mapping.Fit.Rate, std::memory_order_relaxed);
+        _published.store(true, std::memory_order_relaxed);
+
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /* static */ int64_t ClockSynchronizer::Map(
+        _In_ const Mapping& mapping,
+        _In_ const int64_t referenceTicks)
+    {
+        if (referenceTicks < mapping.ConvergenceReference)
+        {
+            return MapLinearly(
+                mapping.AnchorReference,
+                mapping.AnchorTarget,
+                mapping.SlewRate,
+                referenceTicks);
+        }
+
+        return mapping.Fit.Map(
+            referenceTicks);
+    }
+
+    int64_t ClockSynchronizer::ReferenceToTarget(
+        _In_ const int64_t referenceTicks) const
+    {
+        Mapping mapping;
+        bool published = false;
+
+        for (;;)
+        {
+            const uint32_t sequenceBefore =
+                _sequence.load(std::memory_order_acquire);
+
+            if (0 != (sequenceBefore & 1))
+            {
+                std::this_thread::yield();
+
+                continue;
+            }
+
+            published = _published.load(std::memory_order_relaxed);
+            mapping.AnchorReference = _anchorReference.load(std::memory_order_relaxed);
+            mapping.AnchorTarget = _anchorTarget.load(std::memory_order_relaxed);
+            mapping.SlewRate = _slewRate.load(std::memory_order_relaxed);
+            mapping.ConvergenceReference = _convergenceReference.load(std::memory_order_relaxed);
+            mapping.Fit.ReferenceOrigin = _fitReferenceOrigin.load(std::memory_order_relaxed);
+            mapping.Fit.TargetOrigin = _fitTargetOrigin.load(std::memory_order_relaxed);
+            mapping.Fit.Rate = _fitRate.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequenceBefore == _sequence.load(std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        if (!published)
+        {
+            return referenceTicks;
+        }
+
+        return Map(
+            mapping,
+            referenceTicks);
+    }
+
+    void ClockSynchronizer::Start(
+        _In_ const std::chrono::milliseconds updateInterval)
+    {
+        std::lock_guard<std::mutex> threadGuard(
+            _threadMutex);
+
+        if (_thread.joinable())
+        {
+            return;
+        }
+
+        //
+        // Publish a mapping before returning, so that conversions are corrected from now on.
+        //
+        Update();
+
+        _stopRequested = false;
+
+        _thread = std::thread(
+            [this, updateInterval]()
+        {
+            Run(
+                updateInterval);
+        });
+    }
+
+    void ClockSynchronizer::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> threadGuard(
+                _threadMutex);
+
+            if (!_thread.joinable())
+            {
+                return;
+            }
+
+            _stopRequested = true;
+        }
+
+        _threadCondition.notify_all();
+
+        _thread.join();
+    }
+
+    void ClockSynchronizer::Run(
+        _In_ const std::chrono::milliseconds updateInterval)
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> threadLock(
+                    _threadMutex);
+
+                if (_threadCondition.wait_for(
+                    threadLock,
+                    updateInterval,
+                    [this]() { return _stopRequested; }))
+                {
+                    return;
+                }
+            }
+
+            Update();
+        }
+    }
+
+    ClockSynchronizationRecord ClockSynchronizer::GetLatestRecord() const
+    {
+        std::lock_guard<std::mutex> updateGuard(
+            _updateMutex);
+
+        if (_records.empty())
+        {
+            return ClockSynchronizationRecord();
+        }
+
+        return _records.back();
+    }
+
+    std::vector<ClockSynchronizationRecord> ClockSynchronizer::GetRecords(
+        _In_ const uint64_t afterUpdateIndex) const
+    {
+        std::lock_guard<std::mutex> updateGuard(
+            _updateMutex);
+
+        std::vector<ClockSynchronizationRecord> records;
+
+        for (const ClockSynchronizationRecord& record : _records)
+        {
+            if (record.UpdateIndex > afterUpdateIndex)
+            {
+                records.push_back(
+                    record);
+            }
+        }
+
+        return records;
+    }
+}
@@ -0,0 +1,478 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace Io
+{
+    namespace
+    {
+        //
+        // Matches the line breaks of the text-mode stream this class used to write with.
+        //
+        const char c_lineBreak[] = "\r\n";
+
+        std::wstring JoinPath(
+            _In_ const std::wstring& folder,
+            _In_ const wchar_t* fileName)
+        {
+#if defined(_WIN32)
+            return folder + L"\\" + fileName;
+#else
+            return folder + L"/" + fileName;
+#endif /* defined(_WIN32) */
+        }
+
+        //
+        // The Microsoft standard library opens files from wide paths, other ones only from
+        // (UTF-8) narrow paths.
+        //
+#if defined(_WIN32)
+        const std::wstring& GetNativeFileName(
+            _In_ const std::wstring& fileName)
+        {
+            return fileName;
+        }
+#else
+        std::string GetNativeFileName(
+            _In_ const std::wstring& fileName)
+        {
+            return Utf16ToUtf8(
+                fileName);
+        }
+#endif /* defined(_WIN32) */
+
+        void RemoveFile(
+            _In_ const std::wstring& fileName)
+        {
+#if defined(_WIN32)
+            _wremove(fileName.c_str());
+#else
+            std::remove(GetNativeFileName(fileName).c_str());
+#endif /* defined(_WIN32) */
+        }
+
+        uint64_t GetFileSize(
+            _In_ const std::wstring& fileName)
+        {
+            std::ifstream file(
+                GetNativeFileName(fileName),
+                std::ios::in | std::ios::binary | std::ios::ate);
+
+            return file ? static_cast<uint64_t>(file.tellg()) : 0;
+        }
+
+        template <typename WriteRowFunction>
+        double MeasureTimePerRowInMicroseconds(
+            _In_ uint32_t numberOfRows,
+            _In_ const WriteRowFunction& writeRow)
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            for (uint32_t row = 0; row < numberOfRows; ++row)
+            {
+                writeRow(row);
+            }
+
+            const std::chrono::duration<double, std::micro> elapsedTime =
+                std::chrono::steady_clock::now() - startTime;
+
+            return elapsedTime.count() / numberOfRows;
+        }
+
+        //
+        // A camera pose that changes a little with every row: a rotation about the Y axis
+        // followed by a translation, in the row-major layout of the Numerics float4x4.
+        //
+        void GetBenchmarkMatrix(
+            _In_ uint32_t row,
+            _Out_writes_(16) float* values)
+        {
+            const float angle =
+                0.001f * row;
+
+            const float cosine = std::cos(angle);
+            const float sine = std::sin(angle);
+
+            const float matrix[16] =
+            {
+                cosine, 0.0f, -sine, 0.0f,
+                0.0f, 1.0f, 0.0f, 0.0f,
+                sine, 0.0f, cosine, 0.0f,
+                0.1f * angle, 1.6f, -0.01f * row, 1.0f
+            };
+
+            std::copy(
+                matrix,
+                matrix + 16,
+                values);
+        }
+    }
+
+    CsvWriter::Options::Options()
+        : BufferSize(64 * 1024)
+        , FlushInterval(1000)
+    {
+    }
+
+    CsvWriter::BenchmarkStatistics::BenchmarkStatistics()
+        : NumberOfRows(0)
+        , StreamTimePerRowInMicroseconds(0.0)
+        , StreamFileSize(0)
+        , BufferedTimePerRowInMicroseconds(0.0)
+        , BufferedFileSize(0)
+    {
+    }
+
+    _Use_decl_annotations_
+    CsvWriter::CsvWriter(
+        const std::wstring& outputFileName,
+        const Options& options)
+        : _options(options)
+        , _lastFlushTime(std::chrono::steady_clock::now())
+    {
+        //
+        // The rows are buffered here; the stream's own buffer would only add a copy.
+        //
+        _file.rdbuf()->pubsetbuf(
+            nullptr,
+            0);
+
+        _file.open(
+            GetNativeFileName(outputFileName),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+        ASSERT(_file);
+
+        _buffer.reserve(
+            _options.BufferSize + 4096);
+    }
+
+    CsvWriter::~CsvWriter()
+    {
+        //
+        // End the row the caller left unfinished, if any.
+        //
+        if (!_buffer.empty() && '\n' != _buffer.back())
+        {
+            _buffer.append(
+                c_lineBreak);
+        }
+
+        Flush();
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteHeader(
+        const std::vector<std::wstring>& columns)
+    {
+        bool writeComma = false;
+
+        for (const auto& column : columns)
+        {
+            WriteText(
+                column,
+                &writeComma);
+        }
+
+        EndLine();
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteText(
+        const std::wstring& text,
+        bool* writeComma)
+    {
+        WriteComma(
+            writeComma);
+
+        Io::SmallUtf8Buffer utf8Text;
+
+        Utf16ToUtf8(
+            text,
+            utf8Text);
+
+        _buffer.append(
+            utf8Text.GetView());
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteInt32(
+        const int32_t value,
+        bool* writeComma)
+    {
+        WriteComma(
+            writeComma);
+
+        Io::AppendNumber(
+            value,
+            _buffer);
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteUInt64(
+        _In_ const uint64_t value,
+        _Inout_ bool* writeComma)
+    {
+        WriteComma(
+            writeComma);
+
+        Io::AppendNumber(
+            value,
+            _buffer);
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteFloat(
+        const float value,
+        bool* writeComma)
+    {
+        WriteComma(
+            writeComma);
+
+        Io::AppendNumber(
+            value,
+            _buffer);
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteDouble(
+        const double value,
+        bool* writeComma)
+    {
+        WriteComma(
+            writeComma);
+
+        Io::AppendNumber(
+            value,
+            _buffer);
+    }
+
+#if defined(__cplusplus_winrt)
+    _Use_decl_annotations_
+    void CsvWriter::WriteFloat4x4(
+        const Windows::Foundation::Numerics::float4x4& value,
+        bool* writeComma)
+    {
+        WriteFloat(value.m11, writeComma);
+        WriteFloat(value.m12, writeComma);
+        WriteFloat(value.m13, writeComma);
+        WriteFloat(value.m14, writeComma);
+
+        WriteFloat(value.m21, writeComma);
+        WriteFloat(value.m22, writeComma);
+        WriteFloat(value.m23, writeComma);
+        WriteFloat(value.m24, writeComma);
+
+        WriteFloat(value.m31, writeComma);
+        WriteFloat(value.m32, writeComma);
+        WriteFloat(value.m33, writeComma);
+        WriteFloat(value.m34, writeComma);
+
+        WriteFloat(value.m41, writeComma);
+        WriteFloat(value.m42, writeComma);
+        WriteFloat(value.m43, writeComma);
+        WriteFloat(value.m44, writeComma);
+    }
+#endif /* defined(__cplusplus_winrt) */
+
+    void CsvWriter::WriteZeroFloat4x4(
+        _Inout_ bool* writeComma)
+    {
+        for (int32_t i = 0; i < 16; ++i)
+        {
+            WriteFloat(0.0f, writeComma);
+        }
+    }
+
+#if defined(__cplusplus_winrt)
+    _Use_decl_annotations_
+    void CsvWriter::WriteQuaternionWXYZ(
+        const Windows::Foundation::Numerics::quaternion& value,
+        bool* writeComma)
+    {
+        WriteFloat(value.w, writeComma);
+        WriteFloat(value.x, writeComma);
+        WriteFloat(value.y, writeComma);
+        WriteFloat(value.z, writeComma);
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteFloat3XYZ(
+        const Windows::Foundation::Numerics::float3& value,
+        bool* writeComma)
+    {
+        WriteFloat(value.x, writeComma);
+        WriteFloat(value.y, writeComma);
+        WriteFloat(value.z, writeComma);
+    }
+#endif /* defined(__cplusplus_winrt) */
+
+    void CsvWriter::EndLine()
+    {
+        _buffer.append(
+            c_lineBreak);
+
+        if (_buffer.size() >= _options.BufferSize ||
+            std::chrono::steady_clock::now() - _lastFlushTime >= _options.FlushInterval)
+        {
+            Flush();
+        }
+    }
+
+    void CsvWriter::Flush()
+    {
+        if (!_buffer.empty())
+        {
+            _file.write(
+                _buffer.data(),
+                _buffer.size());
+
+            _file.flush();
+
+#if DBG_ENABLE_ERROR_LOGGING
+            if (!_file)
+            {
+                DBG_LOG_RATE_LIMITED(
+                    "CsvWriter",
+                    dbg::LogLevel::Error,
+                    1000 /* minimumIntervalInMilliseconds */,
+                    L"CsvWriter::Flush: failed to write %zu bytes",
+                    _buffer.size());
+            }
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+
+            _buffer.clear();
+        }
+
+        _lastFlushTime = std::chrono::steady_clock::now();
+    }
+
+    _Use_decl_annotations_
+    void CsvWriter::WriteComma(
+        bool* writeComma)
+    {
+        if (*writeComma)
+        {
+            _buffer.push_back(',');
+        }
+        else
+        {
+            *writeComma = true;
+        }
+    }
+
+    _Use_decl_annotations_
+    /* static */ bool CsvWriter::Benchmark(
+        const std::wstring& folder,
+        uint32_t numberOfRows,
+        BenchmarkStatistics& statistics)
+    {
+        statistics = BenchmarkStatistics();
+
+        if (0 == numberOfRows)
+        {
+            return false;
+        }
+
+        statistics.NumberOfRows = numberOfRows;
+
+        const std::wstring streamFileName =
+            JoinPath(folder, L"csv_writer_benchmark_stream.csv");
+
+        const std::wstring bufferedFileName =
+            JoinPath(folder, L"csv_writer_benchmark_buffered.csv");
+
+        const std::wstring imageFileName =
+            L"131571592373545123_pv.pgm";
+
+        {
+            std::wofstream file(
+                GetNativeFileName(streamFileName));
+
+            if (!file)
+            {
+                return false;
+            }
+
+            statistics.StreamTimePerRowInMicroseconds =
+                MeasureTimePerRowInMicroseconds(
+                    numberOfRows,
+                    [&](uint32_t row)
+            {
+                float values[16];
+
+                GetBenchmarkMatrix(
+                    row,
+                    values);
+
+                file << (131571592373545123ull + row * 333333ull) << L',' << imageFileName;
+
+                for (int32_t i = 0; i < 48; ++i)
+                {
+                    file << L',' << values[i % 16];
+                }
+
+                file << std::endl;
+            });
+        }
+
+        {
+            CsvWriter csvWriter(
+                bufferedFileName);
+
+            statistics.BufferedTimePerRowInMicroseconds =
+                MeasureTimePerRowInMicroseconds(
+                    numberOfRows,
+                    [&](uint32_t row)
+            {
+                float values[16];
+
+                GetBenchmarkMatrix(
+                    row,
+                    values);
+
+                bool writeComma = false;
+
+                csvWriter.WriteUInt64(131571592373545123ull + row * 333333ull, &writeComma);
+                csvWriter.WriteText(imageFileName, &writeComma);
+
+                for (int32_t i = 0; i < 48; ++i)
+                {
+                    csvWriter.WriteFloat(values[i % 16], &writeComma);
+                }
+
+                csvWriter.EndLine();
+            });
+        }
+
+        statistics.StreamFileSize = GetFileSize(streamFileName);
+        statistics.BufferedFileSize = GetFileSize(bufferedFileName);
+
+        RemoveFile(streamFileName);
+        RemoveFile(bufferedFileName);
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "CsvWriter",
+            dbg::LogLevel::Information,
+            L"CsvWriter::Benchmark: %u rows: stream %.2f us/row (%llu bytes), buffered %.2f us/row (%llu bytes)",
+            numberOfRows,
+            statistics.StreamTimePerRowInMicroseconds,
+            static_cast<unsigned long long>(statistics.StreamFileSize),
+            statistics.BufferedTimePerRowInMicroseconds,
+            static_cast<unsigned long long>(statistics.BufferedFileSize));
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return true;
+    }
+}
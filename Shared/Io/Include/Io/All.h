@@ -11,11 +11,32 @@
 
 #pragma once
 
+//
+// Outside of Windows, and in desktop builds, only the parts of the library that depend on
+// the standard library alone (and on the Win32 or POSIX file APIs) are available.
+//
+#if defined(_WIN32)
 #include <Io/Time.h>
+#endif /* defined(_WIN32) */
+#include <Io/ClockSynchronizer.h>
+#if defined(_WIN32)
 #include <Io/TimeConverter.h>
 #include <Io/Timer.h>
+#endif /* defined(_WIN32) */
+#if defined(__cplusplus_winrt)
 #include <Io/StorageHandleAccess.h>
+#endif /* defined(__cplusplus_winrt) */
+#include <Io/MappedFile.h>
+#include <Io/ChunkedFileReader.h>
+#if defined(__cplusplus_winrt)
 #include <Io/Tar.h>
+#endif /* defined(__cplusplus_winrt) */
+#include <Io/TarReader.h>
+#if defined(__cplusplus_winrt)
 #include <Io/BufferHelpers.h>
+#endif /* defined(__cplusplus_winrt) */
 #include <Io/StringHelpers.h>
-#include <Io/IoHelpers.h>
\ No newline at end of file
+#include <Io/CsvWriter.h>
+#if defined(__cplusplus_winrt)
+#include <Io/IoHelpers.h>
+#endif /* defined(__cplusplus_winrt) */
\ No newline at end of file
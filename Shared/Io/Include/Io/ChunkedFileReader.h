@@ -0,0 +1,114 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Io
+{
+    //
+    // Reads a file front to back in fixed-size chunks, with a background thread reading
+    // the next chunks while the current one is being processed. Memory use is bounded by
+    // the chunk size times the number of chunks read ahead, whatever the size of the file.
+    //
+    class ChunkedFileReader
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            size_t ChunkSize;
+
+            // Number of chunks read ahead of the one being processed.
+            uint32_t ReadAheadChunks;
+        };
+
+        explicit ChunkedFileReader(
+            _In_ const Options& options = Options());
+
+        ~ChunkedFileReader();
+
+        bool Open(
+            _In_ const std::string& fileName);
+
+#if defined(_WIN32)
+        bool Open(
+            _In_ const std::wstring& fileName);
+#endif /* defined(_WIN32) */
+
+        void Close();
+
+        uint64_t GetFileSize() const;
+
+        //
+        // Returns the next chunk of the file (or what Read left of the current one), which
+        // stays valid until the next call. Returns an empty span at the end of the file, or
+        // if reading failed (see HasFailed).
+        //
+        ByteSpan ReadNextChunk();
+
+        //
+        // Copies the next size bytes of the file, across chunks if needed. Returns the
+        // number of bytes copied, which is less than size at the end of the file.
+        //
+        size_t Read(
+            _Out_writes_bytes_(size) uint8_t* buffer,
+            _In_ size_t size);
+
+        bool HasFailed() const;
+
+    private:
+        ChunkedFileReader(
+            _In_ const ChunkedFileReader&) = delete;
+
+        ChunkedFileReader& operator=(
+            _In_ const ChunkedFileReader&) = delete;
+
+        bool Start(
+            _In_ std::FILE* file);
+
+        void ReadAhead();
+
+        bool FetchNextChunk();
+
+    private:
+        const Options _options;
+
+        std::FILE* _file;
+        uint64_t _fileSize;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _chunkReady;
+        std::condition_variable _bufferAvailable;
+
+        // Guarded by _mutex.
+        std::deque<std::vector<uint8_t>> _readyChunks;
+        std::vector<std::vector<uint8_t>> _freeBuffers;
+        bool _endOfFile;
+        bool _failed;
+        bool _stopRequested;
+
+        // Owned by the consumer.
+        std::vector<uint8_t> _currentChunk;
+        size_t _currentChunkOffset;
+
+        std::thread _thread;
+    };
+}
@@ -0,0 +1,279 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Io
+{
+    //
+    // A simultaneous reading of two clocks, both in hundreds of nanoseconds: the reference
+    // clock (e.g. the QueryPerformanceCounter) and the target clock (e.g. the system time).
+    // The target clock is read between two readings of the reference clock; the sample is
+    // placed halfway between them, and half the time between them bounds its error.
+    //
+    struct ClockSample
+    {
+        ClockSample();
+
+        int64_t ReferenceTicks;
+        int64_t TargetTicks;
+        int64_t UncertaintyTicks;
+    };
+
+    //
+    // A linear mapping from the reference clock to the target clock:
+    //
+    //   target = TargetOrigin + (reference - ReferenceOrigin) * Rate
+    //
+    struct ClockFit
+    {
+        ClockFit();
+
+        int64_t Map(
+            _In_ const int64_t referenceTicks) const;
+
+        bool IsValid;
+
+        int64_t ReferenceOrigin;
+        int64_t TargetOrigin;
+        double Rate;
+
+        // Of the samples used in the fit, in hundreds of nanoseconds.
+        double ResidualRootMeanSquare;
+
+        uint32_t NumberOfSamples;
+        uint32_t NumberOfInliers;
+    };
+
+    //
+    // Fits a ClockFit to a sliding window of clock samples. Only the samples whose
+    // uncertainty is close to the smallest in the window are considered, and samples whose
+    // residual is far from the median residual are rejected before the final fit, so that
+    // samples delayed by preemption or by a step of the target clock do not bias it.
+    //
+    // Only depends on the C++ standard library.
+    //
+    class ClockDriftEstimator
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Number of most recent samples to fit.
+            size_t WindowSize;
+
+            // Samples whose uncertainty exceeds this multiple of the smallest uncertainty
+            // in the window (or MinimumUncertaintyTicks) are ignored.
+            double UncertaintyMultiplier;
+            int64_t MinimumUncertaintyTicks;
+
+            // Samples whose residual exceeds this many (normalized) median absolute
+            // deviations, or MinimumOutlierTicks, are rejected.
+            double OutlierThreshold;
+            int64_t MinimumOutlierTicks;
+
+            // The fitted rate is clamped to 1 +/- MaximumRateDeviation.
+            double MaximumRateDeviation;
+        };
+
+        explicit ClockDriftEstimator(
+            _In_ const Options& options = Options());
+
+        void AddSample(
+            _In_ const ClockSample& sample);
+
+        //
+        // Fits the samples in the window. With a single usable sample, the fit goes
+        // through it with a rate of one.
+        //
+        ClockFit Fit() const;
+
+        size_t GetNumberOfSamples() const;
+
+        void Reset();
+
+    private:
+        const Options _options;
+
+        std::deque<ClockSample> _samples;
+    };
+
+    //
+    // The statistics of a ClockSynchronizer update.
+    //
+    struct ClockSynchronizationRecord
+    {
+        ClockSynchronizationRecord();
+
+        uint64_t UpdateIndex;
+
+        // The sample taken by the update.
+        ClockSample Sample;
+
+        // Drift of the target clock relative to the reference clock, in parts per million.
+        double DriftPartsPerMillion;
+
+        // The difference between the new fit and the previously published mapping at the
+        // time of the sample, in hundreds of nanoseconds. It is slewed away, or stepped
+        // if larger than ClockSynchronizer::Options::MaximumSlewTicks.
+        int64_t CorrectionTicks;
+
+        bool Stepped;
+
+        double ResidualRootMeanSquare;
+        uint32_t NumberOfInliers;
+    };
+
+    //
+    // Maps reference clock readings (e.g. frame timestamps) to the target clock, keeping
+    // the mapping in line with periodic samples of both clocks. The clocks are injected,
+    // so that the synchronizer can be run against simulated clocks.
+    //
+    // Conversions do not take locks: they read the published mapping with a sequence
+    // counter and retry if an update raced with them. Updates never move the mapping
+    // backwards at the time of the update: a new fit is reached by slewing towards it at
+    // MaximumSlewRate, unless the correction exceeds MaximumSlewTicks, in which case the
+    // mapping is stepped (e.g. when the target clock was set).
+    //
+    class ClockSynchronizer
+    {
+    public:
+        typedef std::function<int64_t()> ClockFunction;
+
+        struct Options
+        {
+            Options();
+
+            ClockDriftEstimator::Options EstimatorOptions;
+
+            // Each update keeps the least uncertain of this many samples.
+            uint32_t SamplesPerUpdate;
+
+            double MaximumSlewRate;
+            int64_t MaximumSlewTicks;
+
+            // Number of update records kept for GetRecords.
+            size_t RecordCapacity;
+        };
+
+        ClockSynchronizer(
+            _In_ const ClockFunction& readReferenceClock,
+            _In_ const ClockFunction& readTargetClock,
+            _In_ const Options& options = Options());
+
+        ~ClockSynchronizer();
+
+        //
+        // Samples the clocks and publishes the updated mapping.
+        //
+        void Update();
+
+        //
+        // Calls Update every updateInterval on a background thread, until Stop is called.
+        //
+        void Start(
+            _In_ const std::chrono::milliseconds updateInterval);
+
+        void Stop();
+
+        //
+        // Maps a reading of the reference clock to the target clock. Lock-free; returns
+        // the reference ticks unchanged until the first update.
+        //
+        int64_t ReferenceToTarget(
+            _In_ const int64_t referenceTicks) const;
+
+        //
+        // The most recent update, or a record with an UpdateIndex of zero if none.
+        //
+        ClockSynchronizationRecord GetLatestRecord() const;
+
+        //
+        // The retained records of the updates with an index greater than afterUpdateIndex.
+        //
+        std::vector<ClockSynchronizationRecord> GetRecords(
+            _In_ const uint64_t afterUpdateIndex) const;
+
+    private:
+        //
+        // Until ConvergenceReference, the mapping follows the slew line through the anchor;
+        // from then on, the fit.
+        //
+        struct Mapping
+        {
+            int64_t AnchorReference;
+            int64_t AnchorTarget;
+            double SlewRate;
+            int64_t ConvergenceReference;
+
+            ClockFit Fit;
+        };
+
+        ClockSample TakeSample() const;
+
+        void Publish(
+            _In_ const Mapping& mapping);
+
+        static int64_t Map(
+            _In_ const Mapping& mapping,
+            _In_ const int64_t referenceTicks);
+
+        void Run(
+            _In_ const std::chrono::milliseconds updateInterval);
+
+    private:
+        const ClockFunction _readReferenceClock;
+        const ClockFunction _readTargetClock;
+        const Options _options;
+
+        //
+        // The published mapping, read with a sequence lock: odd sequence numbers mark
+        // updates in progress.
+        //
+        std::atomic<uint32_t> _sequence;
+        std::atomic<bool> _published;
+        std::atomic<int64_t> _anchorReference;
+        std::atomic<int64_t> _anchorTarget;
+        std::atomic<double> _slewRate;
+        std::atomic<int64_t> _convergenceReference;
+        std::atomic<int64_t> _fitReferenceOrigin;
+        std::atomic<int64_t> _fitTargetOrigin;
+        std::atomic<double> _fitRate;
+
+        //
+        // Serializes updates and guards the fields below.
+        //
+        mutable std::mutex _updateMutex;
+
+        ClockDriftEstimator _estimator;
+        Mapping _mapping;
+        bool _hasMapping;
+
+        uint64_t _numberOfUpdates;
+        std::deque<ClockSynchronizationRecord> _records;
+
+        std::mutex _threadMutex;
+        std::condition_variable _threadCondition;
+        bool _stopRequested;
+        std::thread _thread;
+    };
+}
@@ -0,0 +1,141 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Io
+{
+    //
+    // Writes comma-separated values into an in-memory buffer, which is written to the file
+    // in one go once it is full or once the flush interval has passed. Numbers are written
+    // with Io::FormatNumber: floating point numbers with the fewest digits that parse back
+    // to the same value, and independently of the locale. Text is written as UTF-8. The
+    // overloads taking Windows::Foundation::Numerics types are only available to C++/CX.
+    //
+    class CsvWriter
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Buffered rows are written once they take this many bytes...
+            size_t BufferSize;
+
+            // ...or at the end of the first row this long after the previous write, which
+            // bounds what a crash can lose. Zero writes every row.
+            std::chrono::milliseconds FlushInterval;
+        };
+
+        struct BenchmarkStatistics
+        {
+            BenchmarkStatistics();
+
+            uint64_t NumberOfRows;
+
+            // The stream-based writer this class replaced: std::wofstream, operator<< and
+            // std::endl.
+            double StreamTimePerRowInMicroseconds;
+            uint64_t StreamFileSize;
+
+            double BufferedTimePerRowInMicroseconds;
+            uint64_t BufferedFileSize;
+        };
+
+        CsvWriter(
+            _In_ const std::wstring& outputFileName,
+            _In_ const Options& options = Options());
+
+        ~CsvWriter();
+
+        void WriteHeader(
+            _In_ const std::vector<std::wstring>& columns);
+
+        void WriteText(
+            _In_ const std::wstring& text,
+            _Inout_ bool* writeComma);
+
+        void WriteInt32(
+            _In_ const int32_t value,
+            _Inout_ bool* writeComma);
+
+        void WriteUInt64(
+            _In_ const uint64_t value,
+            _Inout_ bool* writeComma);
+
+        void WriteFloat(
+            _In_ const float value,
+            _Inout_ bool* writeComma);
+
+        void WriteDouble(
+            _In_ const double value,
+            _Inout_ bool* writeComma);
+
+#if defined(__cplusplus_winrt)
+        void WriteFloat4x4(
+            _In_ const Windows::Foundation::Numerics::float4x4& value,
+            _Inout_ bool* writeComma);
+#endif /* defined(__cplusplus_winrt) */
+
+        void WriteZeroFloat4x4(
+            _Inout_ bool* writeComma);
+
+#if defined(__cplusplus_winrt)
+        void WriteQuaternionWXYZ(
+            _In_ const Windows::Foundation::Numerics::quaternion& value,
+            _Inout_ bool* writeComma);
+
+        void WriteFloat3XYZ(
+            _In_ const Windows::Foundation::Numerics::float3& value,
+            _Inout_ bool* writeComma);
+#endif /* defined(__cplusplus_winrt) */
+
+        //
+        // Ends the row, and writes the buffered rows if the buffer is full or the flush
+        // interval has passed.
+        //
+        void EndLine();
+
+        //
+        // Writes the buffered rows to the file now.
+        //
+        void Flush();
+
+        //
+        // Writes the given number of frame index rows (a timestamp, a file name and three
+        // 4x4 matrices) to two files in the given folder, with the stream-based writer and
+        // with this one, and deletes the files.
+        //
+        static bool Benchmark(
+            _In_ const std::wstring& folder,
+            _In_ uint32_t numberOfRows,
+            _Out_ BenchmarkStatistics& statistics);
+
+    protected:
+        void WriteComma(
+            _Inout_ bool* shouldWrite);
+
+    protected:
+        const Options _options;
+
+        std::ofstream _file;
+
+        std::string _buffer;
+        std::chrono::steady_clock::time_point _lastFlushTime;
+    };
+}
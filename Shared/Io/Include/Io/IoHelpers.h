@@ -24,4 +24,30 @@ namespace Io
     std::vector<byte> ReadDataSync(
         _In_ Windows::Storage::StorageFolder^ folder,
         _In_ const std::wstring& fileName);
+
+    // Function that maps a binary file from the specified folder for reading in place.
+    // Returns a closed mapping if the file cannot be mapped.
+    MappedFile MapDataSync(
+        _In_ Windows::Storage::StorageFolder^ folder,
+        _In_ const std::wstring& fileName);
+
+    //
+    // Load times of a file from the specified folder with each of the helpers above and
+    // the ChunkedFileReader, in seconds, each time touching every page of the data. The
+    // ReadDataSync time is negative if the file does not fit in a single buffer.
+    //
+    struct FileLoadingBenchmarkResults
+    {
+        FileLoadingBenchmarkResults();
+
+        uint64_t FileSize;
+
+        double ReadDataSyncSeconds;
+        double MapDataSyncSeconds;
+        double ChunkedFileReaderSeconds;
+    };
+
+    FileLoadingBenchmarkResults BenchmarkFileLoading(
+        _In_ Windows::Storage::StorageFolder^ folder,
+        _In_ const std::wstring& fileName);
 }
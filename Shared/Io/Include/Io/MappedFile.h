@@ -0,0 +1,142 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Io
+{
+    //
+    // A read-only view of bytes owned by someone else, e.g. a MappedFile or a
+    // ChunkedFileReader.
+    //
+    struct ByteSpan
+    {
+        ByteSpan();
+
+        ByteSpan(
+            _In_reads_bytes_(size) const uint8_t* data,
+            _In_ size_t size);
+
+        bool IsEmpty() const
+        {
+            return 0 == Size;
+        }
+
+        //
+        // The bytes from offset on, at most length of them.
+        //
+        ByteSpan Subspan(
+            _In_ size_t offset,
+            _In_ size_t length = SIZE_MAX) const;
+
+        const uint8_t* Data;
+        size_t Size;
+    };
+
+    //
+    // Maps a file, or a region of it, into memory for reading, so that it can be used in
+    // place instead of being copied into a buffer: pages are read by the OS on first
+    // access, and shared with other mappings of the file.
+    //
+    // On 32-bit processes, the region mapped at once must fit in the address space; use
+    // the ChunkedFileReader to read larger files sequentially.
+    //
+    class MappedFile
+    {
+    public:
+        static const uint64_t WholeFile = UINT64_MAX;
+
+        MappedFile();
+
+        MappedFile(
+            _Inout_ MappedFile&& other);
+
+        MappedFile& operator=(
+            _Inout_ MappedFile&& other);
+
+        ~MappedFile();
+
+        //
+        // Maps length bytes from offset on (up to the end of the file). Returns false if
+        // the file cannot be opened or mapped; the file is closed in that case. Empty
+        // regions, including those at or past the end of the file, are opened
+        // successfully and have an empty span.
+        //
+        bool Open(
+            _In_ const std::string& fileName,
+            _In_ uint64_t offset = 0,
+            _In_ uint64_t length = WholeFile);
+
+#if defined(_WIN32)
+        bool Open(
+            _In_ const std::wstring& fileName,
+            _In_ uint64_t offset = 0,
+            _In_ uint64_t length = WholeFile);
+
+        //
+        // Maps a file opened for reading, e.g. through IStorageFolderHandleAccess. Takes
+        // ownership of the handle.
+        //
+        bool Open(
+            _In_ HANDLE file,
+            _In_ uint64_t offset = 0,
+            _In_ uint64_t length = WholeFile);
+#endif /* defined(_WIN32) */
+
+        void Close();
+
+        bool IsOpen() const;
+
+        // Size of the whole file, not only of the mapped region.
+        uint64_t GetFileSize() const;
+
+        ByteSpan GetSpan() const;
+
+        //
+        // Asks the OS to read the given part of the span ahead of its use.
+        //
+        void Prefetch(
+            _In_ size_t offset,
+            _In_ size_t length) const;
+
+    private:
+        MappedFile(
+            _In_ const MappedFile&) = delete;
+
+        MappedFile& operator=(
+            _In_ const MappedFile&) = delete;
+
+        bool MapRegion(
+            _In_ uint64_t offset,
+            _In_ uint64_t length);
+
+    private:
+#if defined(_WIN32)
+        HANDLE _file;
+        HANDLE _mapping;
+#else
+        int _file;
+#endif /* defined(_WIN32) */
+
+        bool _isOpen;
+        uint64_t _fileSize;
+
+        // The view starts at an allocation granularity boundary at or before the region.
+        void* _view;
+        size_t _viewSize;
+
+        ByteSpan _span;
+    };
+}
@@ -11,23 +11,299 @@
 
 #pragma once
 
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
 namespace Io
 {
+    //
+    // Splits a string into the tokens separated by any of the delimiter characters without
+    // copying it: tokens are views of the string, which has to outlive them. Like strtok,
+    // empty tokens (between consecutive delimiters) are skipped unless asked for, e.g. for
+    // the cells of a CSV row.
+    //
+    class StringTokenizer
+    {
+    public:
+        StringTokenizer(
+            _In_ std::string_view text,
+            _In_ std::string_view delimiters,
+            _In_ bool skipEmptyTokens = true);
+
+        //
+        // Returns false once all tokens have been returned.
+        //
+        bool Next(
+            _Out_ std::string_view& token);
+
+        // The text after the last token returned.
+        std::string_view GetRemainder() const;
+
+    private:
+        bool IsDelimiter(
+            _In_ char c) const
+        {
+            return _isDelimiter[static_cast<uint8_t>(c)];
+        }
+
+    private:
+        std::string_view _text;
+        bool _skipEmptyTokens;
+
+        // Looked up per character; much faster than searching the delimiters each time.
+        bool _isDelimiter[256];
+
+        // Start of the next token, or npos once all tokens have been returned.
+        size_t _position;
+    };
+
+    void TokenizeString(
+        _In_ std::string_view string,
+        _In_ std::string_view delimiter,
+        _Inout_ std::vector<std::string_view>& tokens);
+
+    //
+    // Copies the tokens; prefer the overload above, which does not.
+    //
     void TokenizeString(
         _In_ const std::string& string,
         _In_ const std::string& delimiter,
         _Inout_ std::vector<std::string>& tokens,
         _Inout_ std::vector<char>& tokenizerBuffer);
-}
 
-std::wstring Utf8ToUtf16(
-    _In_z_ const char* text);
+    //
+    // Strips leading and trailing spaces, tabs and line breaks.
+    //
+    std::string_view TrimString(
+        _In_ std::string_view text);
+
+    //
+    // Parses the whole text as a number, without allocating or depending on the locale:
+    // no leading or trailing characters (including whitespace and a '+' sign) are allowed.
+    // Returns false and leaves the value unchanged if the text is not a number or if the
+    // number does not fit.
+    //
+    template <typename Ty>
+    bool ParseNumber(
+        _In_ std::string_view text,
+        _Inout_ Ty& value)
+    {
+        static_assert(
+            std::is_arithmetic<Ty>::value && !std::is_same<Ty, bool>::value,
+            "ParseNumber only parses integers and floating point numbers.");
+
+        Ty result;
+
+        const std::from_chars_result parsed =
+            std::from_chars(
+                text.data(),
+                text.data() + text.size(),
+                result);
+
+        if (std::errc() != parsed.ec || text.data() + text.size() != parsed.ptr)
+        {
+            return false;
+        }
+
+        value = result;
+
+        return true;
+    }
+
+    template <typename Ty>
+    bool ParseNumber(
+        _In_ std::string_view text,
+        _In_ int base,
+        _Inout_ Ty& value)
+    {
+        static_assert(
+            std::is_integral<Ty>::value && !std::is_same<Ty, bool>::value,
+            "Only integers can be parsed in another base.");
+
+        Ty result;
+
+        const std::from_chars_result parsed =
+            std::from_chars(
+                text.data(),
+                text.data() + text.size(),
+                result,
+                base);
+
+        if (std::errc() != parsed.ec || text.data() + text.size() != parsed.ptr)
+        {
+            return false;
+        }
+
+        value = result;
+
+        return true;
+    }
+
+    //
+    // Large enough for any integer, and for any floating point number written with the
+    // fewest digits that parse back to it.
+    //
+    const size_t MaximumNumberLength = 32;
+
+    //
+    // Formats a number into the buffer, without allocating or depending on the locale, and
+    // returns the characters written (not null-terminated). Floating point numbers are
+    // written with the fewest digits that parse back to the same value.
+    //
+    template <typename Ty>
+    std::string_view FormatNumber(
+        _In_ Ty value,
+        _Out_writes_(MaximumNumberLength) char (&buffer)[MaximumNumberLength])
+    {
+        static_assert(
+            std::is_arithmetic<Ty>::value && !std::is_same<Ty, bool>::value,
+            "FormatNumber only formats integers and floating point numbers.");
+
+        const std::to_chars_result formatted =
+            std::to_chars(
+                buffer,
+                buffer + MaximumNumberLength,
+                value);
+
+        ASSERT(std::errc() == formatted.ec);
 
+        return std::string_view(
+            buffer,
+            static_cast<size_t>(formatted.ptr - buffer));
+    }
+
+    template <typename Ty>
+    void AppendNumber(
+        _In_ Ty value,
+        _Inout_ std::string& text)
+    {
+        char buffer[MaximumNumberLength];
+
+        text.append(
+            FormatNumber(
+                value,
+                buffer));
+    }
+
+    //
+    // A null-terminated string kept in place for up to InlineCapacity characters, and on the
+    // heap beyond; used to convert file names and other short strings without allocating.
+    //
+    template <typename CharTy, size_t InlineCapacity = 260 /* MAX_PATH */>
+    class SmallStringBuffer
+    {
+    public:
+        SmallStringBuffer()
+            : _length(0)
+        {
+            _inline[0] = CharTy();
+        }
+
+        //
+        // Makes room for length characters and the null terminator, and returns where to
+        // write them. The previous contents are lost.
+        //
+        CharTy* Resize(
+            _In_ size_t length)
+        {
+            _length = length;
+
+            CharTy* data = _inline;
+
+            if (length <= InlineCapacity)
+            {
+                _heap.clear();
+            }
+            else
+            {
+                _heap.resize(
+                    length + 1);
+
+                data = _heap.data();
+            }
+
+            data[length] = CharTy();
+
+            return data;
+        }
+
+        CharTy* GetData()
+        {
+            return _heap.empty() ? _inline : _heap.data();
+        }
+
+        const CharTy* GetData() const
+        {
+            return _heap.empty() ? _inline : _heap.data();
+        }
+
+        size_t GetLength() const
+        {
+            return _length;
+        }
+
+        std::basic_string_view<CharTy> GetView() const
+        {
+            return std::basic_string_view<CharTy>(
+                GetData(),
+                _length);
+        }
+
+    private:
+        CharTy _inline[InlineCapacity + 1];
+        std::vector<CharTy> _heap;
+        size_t _length;
+    };
+
+    typedef SmallStringBuffer<char> SmallUtf8Buffer;
+    typedef SmallStringBuffer<wchar_t> SmallUtf16Buffer;
+
+    //
+    // Time per call of the string helpers above and of the code they replace, measured on a
+    // frame index row and a frame file name, in nanoseconds.
+    //
+    struct StringHelpersBenchmarkResults
+    {
+        StringHelpersBenchmarkResults();
+
+        // istringstream, getline and strtof/strtoull, as the frame index was parsed before.
+        double StreamRowParsingNanoseconds;
+        double TokenizerRowParsingNanoseconds;
+
+        // std::to_string and sprintf_s, and FormatNumber.
+        double StringNumberFormattingNanoseconds;
+        double FormatNumberNanoseconds;
+
+        double Utf16ToUtf8StringNanoseconds;
+        double Utf16ToUtf8BufferNanoseconds;
+    };
+
+    StringHelpersBenchmarkResults BenchmarkStringHelpers(
+        _In_ uint32_t numberOfIterations);
+}
+
+//
+// Wide strings are UTF-16 on Windows, and UTF-32 elsewhere.
+//
 std::wstring Utf8ToUtf16(
-    _In_ const std::string& text);
+    _In_ std::string_view text);
 
 std::string Utf16ToUtf8(
-    _In_z_ const wchar_t* text);
+    _In_ std::wstring_view text);
 
-std::string Utf16ToUtf8(
-    _In_ const std::wstring& text);
+//
+// Converts into the buffer, which only allocates for long strings.
+//
+void Utf8ToUtf16(
+    _In_ std::string_view text,
+    _Out_ Io::SmallUtf16Buffer& buffer);
+
+void Utf16ToUtf8(
+    _In_ std::wstring_view text,
+    _Out_ Io::SmallUtf8Buffer& buffer);
@@ -0,0 +1,41 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace Io
+{
+    //
+    // A file stored in a tar archive: its data takes Size bytes from Offset on.
+    //
+    struct TarArchiveEntry
+    {
+        TarArchiveEntry();
+
+        std::string FileName;
+        uint64_t Offset;
+        uint64_t Size;
+    };
+
+    //
+    // Lists the files of a tar archive, such as the ones written by the Tarball class, in
+    // the order they are stored, by reading their headers and seeking over their data. UStar
+    // file name prefixes are supported. Returns false if the archive has no file at all.
+    //
+    bool ReadTarArchiveIndex(
+        _Inout_ std::istream& archive,
+        _Out_ std::vector<TarArchiveEntry>& entries);
+}
@@ -19,6 +19,10 @@ namespace Io
     // the absolute ticks (counting hundreds of nanoseconds since midnight of January 1st, 1601,
     // see the definition of FILETIME for more details on this time encoding).
     //
+    // Relative ticks are converted to absolute ticks with a process-wide ClockSynchronizer,
+    // which samples both clocks every couple of seconds on a background thread and corrects
+    // for the drift between them, rather than with an offset computed once at construction.
+    //
     class TimeConverter
     {
     public:
@@ -38,6 +42,12 @@ namespace Io
 
         HundredsOfNanoseconds CalculateRelativeToAbsoluteTicksOffset() const;
 
+        //
+        // The synchronizer mapping relative ticks to absolute ticks, started on first use.
+        // Its records describe the drift between the clocks.
+        //
+        static ClockSynchronizer& GetClockSynchronizer();
+
     private:
         void Initialize();
 
@@ -46,6 +56,5 @@ namespace Io
 
     private:
         LARGE_INTEGER _qpf;
-        HundredsOfNanoseconds _qpc2ft;
     };
 }
@@ -37,18 +37,16 @@ namespace Io
                     filename.c_str()))).
             then([](Windows::Storage::Streams::IBuffer^ fileBuffer) -> std::vector<byte>
         {
-            std::vector<byte> returnBuffer;
-
-            returnBuffer.resize(
-                fileBuffer->Length);
-
-            Windows::Storage::Streams::DataReader::FromBuffer(
-                fileBuffer)->ReadBytes(
-                    Platform::ArrayReference<byte>(
-                        returnBuffer.data(),
-                        static_cast<uint32_t>(returnBuffer.size())));
-
-            return std::move(returnBuffer);
+            //
+            // Copy straight out of the buffer; a DataReader would add a copy of its own.
+            //
+            const byte* fileData =
+                GetTypedPointerToIBuffer<byte>(
+                    fileBuffer);
+
+            return std::vector<byte>(
+                fileData,
+                fileData + fileBuffer->Length);
         });
     }
 
@@ -94,4 +92,148 @@ namespace Io
         return std::move(
             fileBuffer);
     }
+
+    MappedFile MapDataSync(
+        _In_ Windows::Storage::StorageFolder^ folder,
+        _In_ const std::wstring& fileName)
+    {
+        Microsoft::WRL::ComPtr<IStorageFolderHandleAccess> folderHandleAccess =
+            GetStorageFolderHandleAccess(
+                folder);
+
+        HANDLE input = nullptr;
+
+        ASSERT_SUCCEEDED(folderHandleAccess->Create(
+            fileName.c_str() /* fileName */,
+            HCO_OPEN_EXISTING /* creationOptions */,
+            HAO_READ /* accessOptions */,
+            HSO_SHARE_READ /* sharingOptions */,
+            HO_NONE /* options */,
+            nullptr /* oplockBreakingHandler */,
+            &input));
+
+        MappedFile mappedFile;
+
+        mappedFile.Open(
+            input);
+
+        return mappedFile;
+    }
+
+    namespace
+    {
+        //
+        // Reads a byte from every page so that lazily loaded data is actually loaded.
+        //
+        uint8_t TouchPages(
+            _In_ const ByteSpan& data)
+        {
+            const size_t pageSize = 4096;
+
+            uint8_t checksum = 0;
+
+            for (size_t offset = 0; offset < data.Size; offset += pageSize)
+            {
+                checksum ^= data.Data[offset];
+            }
+
+            return checksum;
+        }
+    }
+
+    FileLoadingBenchmarkResults::FileLoadingBenchmarkResults()
+        : FileSize(0)
+        , ReadDataSyncSeconds(-1.0)
+        , MapDataSyncSeconds(-1.0)
+        , ChunkedFileReaderSeconds(-1.0)
+    {
+    }
+
+    FileLoadingBenchmarkResults BenchmarkFileLoading(
+        _In_ Windows::Storage::StorageFolder^ folder,
+        _In_ const std::wstring& fileName)
+    {
+        FileLoadingBenchmarkResults results;
+
+        Timer timer;
+        uint8_t checksum = 0;
+
+        //
+        // Mapped first, which also tells the file size.
+        //
+        {
+            timer.ResetElapsedTime();
+
+            MappedFile mappedFile =
+                MapDataSync(
+                    folder,
+                    fileName);
+
+            checksum ^= TouchPages(
+                mappedFile.GetSpan());
+
+            if (mappedFile.IsOpen())
+            {
+                results.MapDataSyncSeconds = timer.GetElapsedSeconds();
+            }
+
+            results.FileSize = mappedFile.GetFileSize();
+        }
+
+        //
+        // ReadFile takes at most 4 GB at once, and the buffer has to fit in memory.
+        //
+        if (results.FileSize <= MAXDWORD &&
+            results.FileSize <= SIZE_MAX / 2)
+        {
+            timer.ResetElapsedTime();
+
+            const std::vector<byte> data =
+                ReadDataSync(
+                    folder,
+                    fileName);
+
+            checksum ^= TouchPages(
+                ByteSpan(data.data(), data.size()));
+
+            results.ReadDataSyncSeconds = timer.GetElapsedSeconds();
+        }
+
+        {
+            timer.ResetElapsedTime();
+
+            ChunkedFileReader reader;
+
+            if (reader.Open(std::wstring(folder->Path->Data()) + L"\\" + fileName))
+            {
+                for (ByteSpan chunk = reader.ReadNextChunk(); !chunk.IsEmpty(); chunk = reader.ReadNextChunk())
+                {
+                    checksum ^= TouchPages(
+                        chunk);
+                }
+
+                if (!reader.HasFailed())
+                {
+                    results.ChunkedFileReaderSeconds = timer.GetElapsedSeconds();
+                }
+            }
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "Io",
+            dbg::LogLevel::Information,
+            L"Io::BenchmarkFileLoading: %s (%llu bytes): ReadDataSync %.3f s, MapDataSync %.3f s, ChunkedFileReader %.3f s (checksum %u)",
+            fileName.c_str(),
+            results.FileSize,
+            results.ReadDataSyncSeconds,
+            results.MapDataSyncSeconds,
+            results.ChunkedFileReaderSeconds,
+            checksum);
+#else
+        (void)checksum;
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return results;
+    }
 }
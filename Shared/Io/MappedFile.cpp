@@ -0,0 +1,421 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* !defined(_WIN32) */
+
+namespace Io
+{
+    namespace
+    {
+        uint64_t GetAllocationGranularity()
+        {
+#if defined(_WIN32)
+            SYSTEM_INFO systemInfo;
+
+            GetNativeSystemInfo(
+                &systemInfo);
+
+            return systemInfo.dwAllocationGranularity;
+#else
+            return static_cast<uint64_t>(
+                sysconf(_SC_PAGE_SIZE));
+#endif /* defined(_WIN32) */
+        }
+    }
+
+    ByteSpan::ByteSpan()
+        : Data(nullptr)
+        , Size(0)
+    {
+    }
+
+    ByteSpan::ByteSpan(
+        _In_reads_bytes_(size) const uint8_t* data,
+        _In_ size_t size)
+        : Data(data)
+        , Size(size)
+    {
+    }
+
+    ByteSpan ByteSpan::Subspan(
+        _In_ size_t offset,
+        _In_ size_t length) const
+    {
+        if (offset >= Size)
+        {
+            return ByteSpan();
+        }
+
+        return ByteSpan(
+            Data + offset,
+            std::min(length, Size - offset));
+    }
+
+    MappedFile::MappedFile()
+#if defined(_WIN32)
+        : _file(INVALID_HANDLE_VALUE)
+        , _mapping(nullptr)
+#else
+        : _file(-1)
+#endif /* defined(_WIN32) */
+        , _isOpen(false)
+        , _fileSize(0)
+        , _view(nullptr)
+        , _viewSize(0)
+    {
+    }
+
+    MappedFile::MappedFile(
+        _Inout_ MappedFile&& other)
+        : MappedFile()
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(
+        _Inout_ MappedFile&& other)
+    {
+        if (this != &other)
+        {
+            Close();
+
+            std::swap(_file, other._file);
+#if defined(_WIN32)
+            std::swap(_mapping, other._mapping);
+#endif /* defined(_WIN32) */
+            std::swap(_isOpen, other._isOpen);
+            std::swap(_fileSize, other._fileSize);
+            std::swap(_view, other._view);
+            std::swap(_viewSize, other._viewSize);
+            std::swap(_span, other._span);
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#if defined(_WIN32)
+    bool MappedFile::Open(
+        _In_ const std::string& fileName,
+        _In_ uint64_t offset,
+        _In_ uint64_t length)
+    {
+        return Open(
+            Utf8ToUtf16(fileName),
+            offset,
+            length);
+    }
+
+    bool MappedFile::Open(
+        _In_ const std::wstring& fileName,
+        _In_ uint64_t offset,
+        _In_ uint64_t length)
+    {
+        Close();
+
+        const HANDLE file =
+            CreateFile2(
+                fileName.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                OPEN_EXISTING,
+                nullptr /* pCreateExParams */);
+
+        if (INVALID_HANDLE_VALUE == file)
+        {
+            return false;
+        }
+
+        return Open(
+            file,
+            offset,
+            length);
+    }
+
+    bool MappedFile::Open(
+        _In_ HANDLE file,
+        _In_ uint64_t offset,
+        _In_ uint64_t length)
+    {
+        Close();
+
+        _file = file;
+
+        LARGE_INTEGER fileSize = {};
+
+        if (!GetFileSizeEx(_file, &fileSize))
+        {
+            Close();
+
+            return false;
+        }
+
+        _fileSize = static_cast<uint64_t>(fileSize.QuadPart);
+
+        //
+        // Empty files cannot be mapped, but are valid nonetheless.
+        //
+        if (0 != _fileSize)
+        {
+            _mapping =
+                CreateFileMappingFromApp(
+                    _file,
+                    nullptr /* SecurityAttributes */,
+                    PAGE_READONLY,
+                    0 /* MaximumSize: that of the file */,
+                    nullptr /* Name */);
+
+            if (nullptr == _mapping)
+            {
+                Close();
+
+                return false;
+            }
+        }
+
+        _isOpen = true;
+
+        if (!MapRegion(offset, length))
+        {
+            Close();
+
+            return false;
+        }
+
+        return true;
+    }
+#else
+    bool MappedFile::Open(
+        _In_ const std::string& fileName,
+        _In_ uint64_t offset,
+        _In_ uint64_t length)
+    {
+        Close();
+
+        _file = open(
+            fileName.c_str(),
+            O_RDONLY | O_CLOEXEC);
+
+        if (_file < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStatus;
+
+        if (0 != fstat(_file, &fileStatus))
+        {
+            Close();
+
+            return false;
+        }
+
+        _fileSize = static_cast<uint64_t>(fileStatus.st_size);
+        _isOpen = true;
+
+        if (!MapRegion(offset, length))
+        {
+            Close();
+
+            return false;
+        }
+
+        return true;
+    }
+#endif /* defined(_WIN32) */
+
+    bool MappedFile::MapRegion(
+        _In_ uint64_t offset,
+        _In_ uint64_t length)
+    {
+        length =
+            offset < _fileSize ? std::min(length, _fileSize - offset) : 0;
+
+        //
+        // Nothing to map: zero-sized views would be rejected by mmap, and would map the
+        // rest of the file with MapViewOfFileFromApp.
+        //
+        if (0 == length)
+        {
+            return true;
+        }
+
+        //
+        // Views have to start at a multiple of the allocation granularity.
+        //
+        const uint64_t granularity =
+            GetAllocationGranularity();
+
+        const uint64_t viewOffset =
+            offset - offset % granularity;
+
+        const uint64_t viewSize =
+            offset - viewOffset + length;
+
+        if (viewSize > SIZE_MAX)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        _view =
+            MapViewOfFileFromApp(
+                _mapping,
+                FILE_MAP_READ,
+                viewOffset,
+                static_cast<SIZE_T>(viewSize));
+
+        if (nullptr == _view)
+        {
+            return false;
+        }
+#else
+        _view =
+            mmap(
+                nullptr,
+                static_cast<size_t>(viewSize),
+                PROT_READ,
+                MAP_PRIVATE,
+                _file,
+                static_cast<off_t>(viewOffset));
+
+        if (MAP_FAILED == _view)
+        {
+            _view = nullptr;
+
+            return false;
+        }
+#endif /* defined(_WIN32) */
+
+        _viewSize = static_cast<size_t>(viewSize);
+
+        _span = ByteSpan(
+            static_cast<const uint8_t*>(_view) + (offset - viewOffset),
+            static_cast<size_t>(length));
+
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+#if defined(_WIN32)
+        if (nullptr != _view)
+        {
+            UnmapViewOfFile(
+                _view);
+        }
+
+        if (nullptr != _mapping)
+        {
+            CloseHandle(
+                _mapping);
+        }
+
+        if (INVALID_HANDLE_VALUE != _file)
+        {
+            CloseHandle(
+                _file);
+        }
+
+        _file = INVALID_HANDLE_VALUE;
+        _mapping = nullptr;
+#else
+        if (nullptr != _view)
+        {
+            munmap(
+                _view,
+                _viewSize);
+        }
+
+        if (_file >= 0)
+        {
+            close(
+                _file);
+        }
+
+        _file = -1;
+#endif /* defined(_WIN32) */
+
+        _isOpen = false;
+        _fileSize = 0;
+        _view = nullptr;
+        _viewSize = 0;
+        _span = ByteSpan();
+    }
+
+    bool MappedFile::IsOpen() const
+    {
+        return _isOpen;
+    }
+
+    uint64_t MappedFile::GetFileSize() const
+    {
+        return _fileSize;
+    }
+
+    ByteSpan MappedFile::GetSpan() const
+    {
+        return _span;
+    }
+
+    void MappedFile::Prefetch(
+        _In_ size_t offset,
+        _In_ size_t length) const
+    {
+        const ByteSpan region =
+            _span.Subspan(
+                offset,
+                length);
+
+        if (region.IsEmpty())
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        WIN32_MEMORY_RANGE_ENTRY range;
+
+        range.VirtualAddress = const_cast<uint8_t*>(region.Data);
+        range.NumberOfBytes = region.Size;
+
+        PrefetchVirtualMemory(
+            GetCurrentProcess(),
+            1 /* NumberOfEntries */,
+            &range,
+            0 /* Flags */);
+#else
+        //
+        // madvise wants a page-aligned address.
+        //
+        const uintptr_t pageSize =
+            static_cast<uintptr_t>(GetAllocationGranularity());
+
+        const uintptr_t begin =
+            reinterpret_cast<uintptr_t>(region.Data) & ~(pageSize - 1);
+
+        madvise(
+            reinterpret_cast<void*>(begin),
+            reinterpret_cast<uintptr_t>(region.Data) + region.Size - begin,
+            MADV_WILLNEED);
+#endif /* defined(_WIN32) */
+    }
+}
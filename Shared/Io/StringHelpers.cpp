@@ -13,84 +13,473 @@
 
 namespace Io
 {
+    StringTokenizer::StringTokenizer(
+        _In_ std::string_view text,
+        _In_ std::string_view delimiters,
+        _In_ bool skipEmptyTokens)
+        : _text(text)
+        , _skipEmptyTokens(skipEmptyTokens)
+        , _position(0)
+    {
+        std::memset(
+            _isDelimiter,
+            0,
+            sizeof(_isDelimiter));
+
+        for (const char delimiter : delimiters)
+        {
+            _isDelimiter[static_cast<uint8_t>(delimiter)] = true;
+        }
+    }
+
+    bool StringTokenizer::Next(
+        _Out_ std::string_view& token)
+    {
+        token = std::string_view();
+
+        if (std::string_view::npos == _position)
+        {
+            return false;
+        }
+
+        const size_t length =
+            _text.size();
+
+        if (_skipEmptyTokens)
+        {
+            while (_position < length && IsDelimiter(_text[_position]))
+            {
+                ++_position;
+            }
+
+            if (_position == length)
+            {
+                _position = std::string_view::npos;
+
+                return false;
+            }
+        }
+
+        size_t end = _position;
+
+        while (end < length && !IsDelimiter(_text[end]))
+        {
+            ++end;
+        }
+
+        token = _text.substr(
+            _position,
+            end - _position);
+
+        _position =
+            (end < length) ? end + 1 : std::string_view::npos;
+
+        return true;
+    }
+
+    std::string_view StringTokenizer::GetRemainder() const
+    {
+        if (std::string_view::npos == _position)
+        {
+            return std::string_view();
+        }
+
+        return _text.substr(
+            _position);
+    }
+
+    void TokenizeString(
+        _In_ std::string_view string,
+        _In_ std::string_view delimiter,
+        _Inout_ std::vector<std::string_view>& tokens)
+    {
+        tokens.clear();
+
+        StringTokenizer tokenizer(
+            string,
+            delimiter);
+
+        std::string_view token;
+
+        while (tokenizer.Next(token))
+        {
+            tokens.push_back(
+                token);
+        }
+    }
+
     void TokenizeString(
         _In_ const std::string& string,
         _In_ const std::string& delimiter,
         _Inout_ std::vector<std::string>& tokens,
-        _Inout_ std::vector<char>& tokenizerBuffer)
+        _Inout_ std::vector<char>& /* tokenizerBuffer */)
     {
         tokens.clear();
 
-        tokenizerBuffer.resize(
-            string.length() + 1);
+        StringTokenizer tokenizer(
+            string,
+            delimiter);
 
-        std::copy(
-            string.begin(),
-            string.end(),
-            tokenizerBuffer.begin());
+        std::string_view token;
 
-        tokenizerBuffer[string.length()] = '\0';
+        while (tokenizer.Next(token))
+        {
+            tokens.emplace_back(
+                token);
+        }
+    }
 
-        char* nextToken =
-            nullptr;
+    std::string_view TrimString(
+        _In_ std::string_view text)
+    {
+        const char* const whitespace = " \t\r\n";
 
-        char* cursor =
-            strtok_s(
-            tokenizerBuffer.data(),
-            delimiter.c_str(),
-            &nextToken);
+        const size_t begin =
+            text.find_first_not_of(
+                whitespace);
 
-        while (nullptr != cursor)
+        if (std::string_view::npos == begin)
         {
-            tokens.emplace_back(
-                cursor);
-
-            cursor = strtok_s(
-                nullptr,
-                delimiter.c_str(),
-                &nextToken);
+            return std::string_view();
         }
+
+        const size_t end =
+            text.find_last_not_of(
+                whitespace);
+
+        return text.substr(
+            begin,
+            end - begin + 1);
     }
 }
 
-std::wstring Utf8ToUtf16(
-    _In_z_ const char* text)
+namespace
 {
-    wchar_t buffer[1024];
+#if defined(_WIN32)
+    int GetUtf16Length(
+        _In_ std::string_view text)
+    {
+        REQUIRES(text.size() <= INT_MAX);
+
+        return MultiByteToWideChar(
+            CP_UTF8,
+            0 /* dwFlags */,
+            text.data(),
+            static_cast<int>(text.size()),
+            nullptr /* lpWideCharStr */,
+            0 /* cchWideChar */);
+    }
+
+    void ConvertUtf8ToUtf16(
+        _In_ std::string_view text,
+        _Out_writes_(length) wchar_t* output,
+        _In_ int length)
+    {
+        ASSERT(length == MultiByteToWideChar(
+            CP_UTF8,
+            0 /* dwFlags */,
+            text.data(),
+            static_cast<int>(text.size()),
+            output,
+            length));
+    }
+
+    int GetUtf8Length(
+        _In_ std::wstring_view text)
+    {
+        REQUIRES(text.size() <= INT_MAX);
+
+        return WideCharToMultiByte(
+            CP_UTF8,
+            0 /* dwFlags */,
+            text.data(),
+            static_cast<int>(text.size()),
+            nullptr /* lpMultiByteStr */,
+            0 /* cbMultiByte */,
+            nullptr /* lpDefaultChar */,
+            nullptr /* lpUsedDefaultChar */);
+    }
+
+    void ConvertUtf16ToUtf8(
+        _In_ std::wstring_view text,
+        _Out_writes_(length) char* output,
+        _In_ int length)
+    {
+        ASSERT(length == WideCharToMultiByte(
+            CP_UTF8,
+            0 /* dwFlags */,
+            text.data(),
+            static_cast<int>(text.size()),
+            output,
+            length,
+            nullptr /* lpDefaultChar */,
+            nullptr /* lpUsedDefaultChar */));
+    }
+#else
+    //
+    // wchar_t holds UTF-32 code points outside of Windows. Malformed sequences decode to
+    // U+FFFD, as they do with MultiByteToWideChar.
+    //
+    const uint32_t c_replacementCharacter = 0xfffd;
+
+    //
+    // Decodes the code point at the given position and moves past it.
+    //
+    uint32_t DecodeUtf8(
+        _In_ std::string_view text,
+        _Inout_ size_t& position)
+    {
+        const uint8_t lead =
+            static_cast<uint8_t>(text[position++]);
+
+        if (lead < 0x80)
+        {
+            return lead;
+        }
+
+        size_t numberOfContinuationBytes = 0;
+        uint32_t codePoint = 0;
+        uint32_t minimumCodePoint = 0;
+
+        if (0xc0 == (lead & 0xe0))
+        {
+            numberOfContinuationBytes = 1;
+            codePoint = lead & 0x1f;
+            minimumCodePoint = 0x80;
+        }
+        else if (0xe0 == (lead & 0xf0))
+        {
+            numberOfContinuationBytes = 2;
+            codePoint = lead & 0x0f;
+            minimumCodePoint = 0x800;
+        }
+        else if (0xf0 == (lead & 0xf8))
+        {
+            numberOfContinuationBytes = 3;
+            codePoint = lead & 0x07;
+            minimumCodePoint = 0x10000;
+        }
+        else
+        {
+            return c_replacementCharacter;
+        }
+
+        for (size_t i = 0; i < numberOfContinuationBytes; ++i)
+        {
+            if (position >= text.size() ||
+                0x80 != (static_cast<uint8_t>(text[position]) & 0xc0))
+            {
+                return c_replacementCharacter;
+            }
+
+            codePoint = (codePoint << 6) | (static_cast<uint8_t>(text[position++]) & 0x3f);
+        }
+
+        if (codePoint < minimumCodePoint || codePoint > 0x10ffff ||
+            (codePoint >= 0xd800 && codePoint < 0xe000))
+        {
+            return c_replacementCharacter;
+        }
+
+        return codePoint;
+    }
+
+    //
+    // Encodes a code point into output, if not null, and returns the number of bytes.
+    //
+    int EncodeUtf8(
+        _In_ uint32_t codePoint,
+        _Out_writes_opt_(4) char* output)
+    {
+        if (codePoint > 0x10ffff || (codePoint >= 0xd800 && codePoint < 0xe000))
+        {
+            codePoint = c_replacementCharacter;
+        }
+
+        if (codePoint < 0x80)
+        {
+            if (nullptr != output)
+            {
+                output[0] = static_cast<char>(codePoint);
+            }
+
+            return 1;
+        }
+
+        const int length =
+            (codePoint < 0x800) ? 2 : (codePoint < 0x10000) ? 3 : 4;
+
+        if (nullptr != output)
+        {
+            static const uint8_t c_leadBytes[] = { 0, 0, 0xc0, 0xe0, 0xf0 };
+
+            for (int i = length - 1; i > 0; --i)
+            {
+                output[i] = static_cast<char>(0x80 | (codePoint & 0x3f));
+                codePoint >>= 6;
+            }
+
+            output[0] = static_cast<char>(c_leadBytes[length] | codePoint);
+        }
+
+        return length;
+    }
+
+    int GetUtf16Length(
+        _In_ std::string_view text)
+    {
+        REQUIRES(text.size() <= INT_MAX);
+
+        int length = 0;
+
+        for (size_t position = 0; position < text.size(); ++length)
+        {
+            DecodeUtf8(
+                text,
+                position);
+        }
+
+        return length;
+    }
+
+    void ConvertUtf8ToUtf16(
+        _In_ std::string_view text,
+        _Out_writes_(length) wchar_t* output,
+        _In_ int length)
+    {
+        int outputLength = 0;
+
+        for (size_t position = 0; position < text.size(); ++outputLength)
+        {
+            output[outputLength] = static_cast<wchar_t>(
+                DecodeUtf8(
+                    text,
+                    position));
+        }
 
-    swprintf_s(
-        buffer,
-        L"%S",
-        text);
+        ASSERT(length == outputLength);
+    }
+
+    int GetUtf8Length(
+        _In_ std::wstring_view text)
+    {
+        REQUIRES(text.size() <= INT_MAX / 4);
+
+        int length = 0;
+
+        for (const wchar_t character : text)
+        {
+            length += EncodeUtf8(
+                static_cast<uint32_t>(character),
+                nullptr /* output */);
+        }
+
+        return length;
+    }
+
+    void ConvertUtf16ToUtf8(
+        _In_ std::wstring_view text,
+        _Out_writes_(length) char* output,
+        _In_ int length)
+    {
+        int outputLength = 0;
 
-    return std::wstring(
-        buffer);
+        for (const wchar_t character : text)
+        {
+            outputLength += EncodeUtf8(
+                static_cast<uint32_t>(character),
+                output + outputLength);
+        }
+
+        ASSERT(length == outputLength);
+    }
+#endif /* defined(_WIN32) */
 }
 
 std::wstring Utf8ToUtf16(
-    _In_ const std::string& text)
+    _In_ std::string_view text)
 {
-    return Utf8ToUtf16(
-        text.c_str());
+    std::wstring result;
+
+    if (!text.empty())
+    {
+        const int length =
+            GetUtf16Length(
+                text);
+
+        result.resize(
+            static_cast<size_t>(length));
+
+        ConvertUtf8ToUtf16(
+            text,
+            &result[0],
+            length);
+    }
+
+    return result;
 }
 
 std::string Utf16ToUtf8(
-    _In_z_ const wchar_t* text)
+    _In_ std::wstring_view text)
 {
-    char buffer[1024];
+    std::string result;
+
+    if (!text.empty())
+    {
+        const int length =
+            GetUtf8Length(
+                text);
 
-    sprintf_s(
-        buffer,
-        "%S",
-        text);
+        result.resize(
+            static_cast<size_t>(length));
+
+        ConvertUtf16ToUtf8(
+            text,
+            &result[0],
+            length);
+    }
 
-    return std::string(
-        buffer);
+    return result;
 }
 
-std::string Utf16ToUtf8(
-    _In_ const std::wstring& text)
+void Utf8ToUtf16(
+    _In_ std::string_view text,
+    _Out_ Io::SmallUtf16Buffer& buffer)
 {
-    return Utf16ToUtf8(
-        text.c_str());
+    if (text.empty())
+    {
+        buffer.Resize(0);
+
+        return;
+    }
+
+    const int length =
+        GetUtf16Length(
+            text);
+
+    ConvertUtf8ToUtf16(
+        text,
+        buffer.Resize(static_cast<size_t>(length)),
+        length);
+}
+
+void Utf16ToUtf8(
+    _In_ std::wstring_view text,
+    _Out_ Io::SmallUtf8Buffer& buffer)
+{
+    if (text.empty())
+    {
+        buffer.Resize(0);
+
+        return;
+    }
+
+    const int length =
+        GetUtf8Length(
+            text);
+
+    ConvertUtf16ToUtf8(
+        text,
+        buffer.Resize(static_cast<size_t>(length)),
+        length);
 }
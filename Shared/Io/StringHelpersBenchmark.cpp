@@ -0,0 +1,176 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace Io
+{
+    StringHelpersBenchmarkResults::StringHelpersBenchmarkResults()
+        : StreamRowParsingNanoseconds(0.0)
+        , TokenizerRowParsingNanoseconds(0.0)
+        , StringNumberFormattingNanoseconds(0.0)
+        , FormatNumberNanoseconds(0.0)
+        , Utf16ToUtf8StringNanoseconds(0.0)
+        , Utf16ToUtf8BufferNanoseconds(0.0)
+    {
+    }
+
+    StringHelpersBenchmarkResults BenchmarkStringHelpers(
+        _In_ uint32_t numberOfIterations)
+    {
+        REQUIRES(0 != numberOfIterations);
+
+        //
+        // A frame index row: timestamp, file name and three 4x4 matrices.
+        //
+        std::string row =
+            "131571592373545123,131571592373545123_pv.pgm";
+
+        for (int32_t i = 0; i < 48; ++i)
+        {
+            row += (0 == i % 5) ? ",1" : ",-0.0123456";
+        }
+
+        const std::wstring fileName =
+            L"131571592373545123_pv.pgm";
+
+        StringHelpersBenchmarkResults results;
+        dbg::Timer timer;
+
+        //
+        // Keeps the compiler from optimizing the work away.
+        //
+        double checksum = 0.0;
+
+        const auto getNanosecondsPerIteration = [&]()
+        {
+            return timer.GetMillisecondsFromLastEvent() * 1e6 / numberOfIterations;
+        };
+
+        timer.MarkEvent();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            std::istringstream stream(row);
+            std::string cell;
+
+            std::getline(stream, cell, ',');
+            checksum += static_cast<double>(std::strtoull(cell.c_str(), nullptr, 10));
+
+            std::getline(stream, cell, ',');
+            checksum += static_cast<double>(cell.size());
+
+            while (std::getline(stream, cell, ','))
+            {
+                checksum += std::strtof(cell.c_str(), nullptr);
+            }
+        }
+
+        results.StreamRowParsingNanoseconds = getNanosecondsPerIteration();
+
+        timer.MarkEvent();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            StringTokenizer tokenizer(
+                row,
+                ",",
+                false /* skipEmptyTokens */);
+
+            std::string_view cell;
+            uint64_t timestamp = 0;
+            float value = 0.0f;
+
+            tokenizer.Next(cell);
+            ParseNumber(cell, timestamp);
+            checksum += static_cast<double>(timestamp);
+
+            tokenizer.Next(cell);
+            checksum += static_cast<double>(cell.size());
+
+            while (tokenizer.Next(cell))
+            {
+                ParseNumber(cell, value);
+                checksum += value;
+            }
+        }
+
+        results.TokenizerRowParsingNanoseconds = getNanosecondsPerIteration();
+
+        timer.MarkEvent();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            std::ostringstream stream;
+
+            stream << (131571592373545123ull + iteration) << ',' << (-0.0123456f * iteration);
+
+            checksum += static_cast<double>(stream.str().size());
+        }
+
+        results.StringNumberFormattingNanoseconds = getNanosecondsPerIteration();
+
+        timer.MarkEvent();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            std::string text;
+
+            AppendNumber(131571592373545123ull + iteration, text);
+            text.push_back(',');
+            AppendNumber(-0.0123456f * iteration, text);
+
+            checksum += static_cast<double>(text.size());
+        }
+
+        results.FormatNumberNanoseconds = getNanosecondsPerIteration();
+
+        timer.MarkEvent();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            checksum += static_cast<double>(Utf16ToUtf8(fileName).size());
+        }
+
+        results.Utf16ToUtf8StringNanoseconds = getNanosecondsPerIteration();
+
+        timer.MarkEvent();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            SmallUtf8Buffer buffer;
+
+            Utf16ToUtf8(fileName, buffer);
+
+            checksum += static_cast<double>(buffer.GetLength());
+        }
+
+        results.Utf16ToUtf8BufferNanoseconds = getNanosecondsPerIteration();
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "Io",
+            dbg::LogLevel::Information,
+            L"Io::BenchmarkStringHelpers: row parsing %.0f ns (stream) vs %.0f ns (tokenizer), number formatting %.0f ns (stream) vs %.0f ns (FormatNumber), Utf16ToUtf8 %.0f ns (string) vs %.0f ns (buffer) (checksum %f)",
+            results.StreamRowParsingNanoseconds,
+            results.TokenizerRowParsingNanoseconds,
+            results.StringNumberFormattingNanoseconds,
+            results.FormatNumberNanoseconds,
+            results.Utf16ToUtf8StringNanoseconds,
+            results.Utf16ToUtf8BufferNanoseconds,
+            checksum);
+#else
+        (void)checksum;
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return results;
+    }
+}
@@ -103,7 +103,7 @@ namespace Io
 
     template <size_t N>
     void CopyStringToTarHeader(
-        _In_ const std::string& input,
+        _In_ std::string_view input,
         _Out_ char output[N])
     {
         ASSERT(input.size() < N);
@@ -128,19 +128,38 @@ namespace Io
 
         if (input > 0)
         {
-            char buffer[32] = {};
+            //
+            // Zero-padded to N - 1 digits, followed by a null terminator.
+            //
+            char buffer[32];
+
+            const std::to_chars_result formatted =
+                std::to_chars(
+                    buffer,
+                    buffer + sizeof(buffer),
+                    input,
+                    8 /* base */);
+
+            ASSERT(std::errc() == formatted.ec);
+
+            const size_t numberOfDigits =
+                static_cast<size_t>(formatted.ptr - buffer);
+
+            ASSERT(numberOfDigits <= N - 1);
 
-            numberOfOctets = sprintf_s(
-                buffer,
-                "%0*llo",
-                static_cast<int>(N - 1),
-                input);
+            numberOfOctets = N - 1;
 
-            ASSERT(numberOfOctets <= N - 1);
+            const size_t numberOfPaddingZeros =
+                numberOfOctets - numberOfDigits;
 
-            for (size_t i = 0; i < numberOfOctets; ++i)
+            for (size_t i = 0; i < numberOfPaddingZeros; ++i)
             {
-                output[i] = buffer[i];
+                output[i] = '0';
+            }
+
+            for (size_t i = 0; i < numberOfDigits; ++i)
+            {
+                output[numberOfPaddingZeros + i] = buffer[i];
             }
         }
 
@@ -231,8 +250,14 @@ namespace Io
                 512 == sizeof(TarHeader),
                 "Size of the TarHeader structure must be equal to 512 bytes.");
 
+            SmallUtf8Buffer utf8FileName;
+
+            Utf16ToUtf8(
+                sourceFileName,
+                utf8FileName);
+
             CopyStringToTarHeader<100>(
-                Utf16ToUtf8(sourceFileName),
+                utf8FileName.GetView(),
                 header.FileName);
 
             CopyUInt64ToTarHeaderAsOctets<12>(
@@ -351,7 +376,11 @@ namespace Io
 
 		TarHeader header;
 
-		CopyStringToTarHeader<100>(Utf16ToUtf8(fileName), header.FileName);
+		// The file name is converted on the stack, without allocating for every frame.
+		SmallUtf8Buffer utf8FileName;
+		Utf16ToUtf8(fileName, utf8FileName);
+
+		CopyStringToTarHeader<100>(utf8FileName.GetView(), header.FileName);
 		CopyUInt64ToTarHeaderAsOctets<12>(fileSize, header.FileSize);
 		CopyUInt64ToTarHeaderAsOctets<12>(
 			std::chrono::duration_cast<std::chrono::seconds>(
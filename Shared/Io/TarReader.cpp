@@ -0,0 +1,97 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace Io
+{
+    namespace
+    {
+        const uint64_t c_tarBlockSize = 512;
+
+        uint64_t ParseOctal(
+            _In_reads_(length) const char* text,
+            _In_ size_t length)
+        {
+            //
+            // Octal fields are padded with spaces or null characters.
+            //
+            uint64_t value = 0;
+
+            ParseNumber(
+                TrimString(std::string_view(text, strnlen(text, length))),
+                8 /* base */,
+                value);
+
+            return value;
+        }
+    }
+
+    TarArchiveEntry::TarArchiveEntry()
+        : Offset(0)
+        , Size(0)
+    {
+    }
+
+    bool ReadTarArchiveIndex(
+        _Inout_ std::istream& archive,
+        _Out_ std::vector<TarArchiveEntry>& entries)
+    {
+        entries.clear();
+
+        char header[c_tarBlockSize];
+        uint64_t offset = 0;
+
+        archive.clear();
+        archive.seekg(0);
+
+        while (archive.read(header, sizeof(header)))
+        {
+            offset += sizeof(header);
+
+            if ('\0' == header[0])
+            {
+                //
+                // End of archive marker.
+                //
+                break;
+            }
+
+            TarArchiveEntry entry;
+
+            entry.FileName.assign(
+                header,
+                strnlen(header, 100));
+
+            //
+            // UStar file name prefix.
+            //
+            if (0 == memcmp(header + 257, "ustar", 5) && '\0' != header[345])
+            {
+                entry.FileName =
+                    std::string(header + 345, strnlen(header + 345, 155)) + "/" + entry.FileName;
+            }
+
+            entry.Offset = offset;
+            entry.Size = ParseOctal(header + 124, 12);
+
+            offset +=
+                (entry.Size + c_tarBlockSize - 1) / c_tarBlockSize * c_tarBlockSize;
+
+            entries.push_back(
+                std::move(entry));
+
+            archive.seekg(offset);
+        }
+
+        return !entries.empty();
+    }
+}
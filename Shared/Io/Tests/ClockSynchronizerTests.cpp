@@ -0,0 +1,349 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+//
+// Exercises the ClockDriftEstimator and ClockSynchronizer with simulated clocks: a target
+// clock that drifts by 50 ppm relative to the reference clock, reads that take a random
+// time and are now and then preempted, and a target clock that is set while the
+// synchronizer runs. Returns a non-zero exit code if a check fails (run with ctest).
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+#include <Debugging/Sal.h>
+#include <Io/ClockSynchronizer.h>
+
+namespace
+{
+    const double c_driftPartsPerMillion = 50.0;
+
+    // The synchronizer samples the clocks every two seconds.
+    const int64_t c_updateIntervalTicks = 20'000'000;
+
+    int g_numberOfFailures = 0;
+
+    void Check(
+        _In_ bool condition,
+        _In_ const char* description)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", description);
+
+            ++g_numberOfFailures;
+        }
+    }
+
+    //
+    // Both clocks count hundreds of nanoseconds of simulated time, the target clock
+    // c_driftPartsPerMillion faster than the reference clock. Each read advances the
+    // simulated time by a few ticks, and by a lot one time in fifty (preemption).
+    //
+    class SimulatedClocks
+    {
+    public:
+        SimulatedClocks()
+            : _random(1)
+            , _readDelay(1.0 / 5.0)
+            , _time(100'000'000)
+            , _targetOffset(131'571'592'373'545'123)
+        {
+        }
+
+        int64_t ReadReference()
+        {
+            AdvanceRead();
+
+            return _time;
+        }
+
+        int64_t ReadTarget()
+        {
+            AdvanceRead();
+
+            return GetTarget(_time);
+        }
+
+        //
+        // The target clock reading at the given reference clock reading.
+        //
+        int64_t GetTarget(
+            _In_ int64_t referenceTicks) const
+        {
+            return _targetOffset + referenceTicks +
+                static_cast<int64_t>(std::llround(referenceTicks * c_driftPartsPerMillion * 1e-6));
+        }
+
+        int64_t GetTime() const
+        {
+            return _time;
+        }
+
+        void Advance(
+            _In_ int64_t ticks)
+        {
+            _time += ticks;
+        }
+
+        //
+        // Sets the target clock, e.g. when the system time is synchronized.
+        //
+        void StepTarget(
+            _In_ int64_t ticks)
+        {
+            _targetOffset += ticks;
+        }
+
+    private:
+        void AdvanceRead()
+        {
+            _time += 1 + static_cast<int64_t>(_readDelay(_random));
+
+            if (0 == _random() % 50)
+            {
+                _time += 2000;
+            }
+        }
+
+    private:
+        std::mt19937_64 _random;
+        std::exponential_distribution<double> _readDelay;
+
+        int64_t _time;
+        int64_t _targetOffset;
+    };
+
+    Io::ClockSynchronizer::ClockFunction GetReferenceClock(
+        _In_ SimulatedClocks& clocks)
+    {
+        return [&clocks]() { return clocks.ReadReference(); };
+    }
+
+    Io::ClockSynchronizer::ClockFunction GetTargetClock(
+        _In_ SimulatedClocks& clocks)
+    {
+        return [&clocks]() { return clocks.ReadTarget(); };
+    }
+
+    //
+    // A full window of bracketed samples, some of them shifted as if the target clock
+    // read had been delayed after its bracket, fits the simulated drift.
+    //
+    void TestDriftEstimatorFit()
+    {
+        SimulatedClocks clocks;
+
+        Io::ClockDriftEstimator estimator;
+
+        for (int32_t i = 0; i < 64; ++i)
+        {
+            Io::ClockSample sample;
+
+            const int64_t referenceBeforeTicks = clocks.ReadReference();
+
+            sample.TargetTicks = clocks.ReadTarget();
+
+            const int64_t referenceAfterTicks = clocks.ReadReference();
+
+            sample.ReferenceTicks = (referenceBeforeTicks + referenceAfterTicks) / 2;
+            sample.UncertaintyTicks = (referenceAfterTicks - referenceBeforeTicks + 1) / 2;
+
+            if (0 == i % 10)
+            {
+                sample.TargetTicks += 5000;
+            }
+
+            estimator.AddSample(
+                sample);
+
+            clocks.Advance(
+                c_updateIntervalTicks);
+        }
+
+        const Io::ClockFit fit =
+            estimator.Fit();
+
+        const double driftPartsPerMillion =
+            (fit.Rate - 1.0) * 1e6;
+
+        std::printf(
+            "TestDriftEstimatorFit: drift %.3f ppm, %u of %u samples, residual %.1f ticks\n",
+            driftPartsPerMillion,
+            fit.NumberOfInliers,
+            fit.NumberOfSamples,
+            fit.ResidualRootMeanSquare);
+
+        Check(fit.IsValid, "the fit is valid");
+        Check(std::abs(driftPartsPerMillion - c_driftPartsPerMillion) < 0.1, "the fit has the simulated drift");
+        Check(fit.NumberOfInliers < fit.NumberOfSamples, "the shifted samples are rejected");
+        Check(std::abs(fit.Map(clocks.GetTime()) - clocks.GetTarget(clocks.GetTime())) < 100, "the fit maps to the target clock");
+    }
+
+    //
+    // Converted timestamps never go backwards, including while a correction smaller than
+    // MaximumSlewTicks (here, the target clock set back by 50 ms) is slewed in, and the
+    // mapping converges to the target clock afterwards.
+    //
+    void TestSynchronizerSlewIsMonotonic()
+    {
+        SimulatedClocks clocks;
+
+        Io::ClockSynchronizer synchronizer(
+            GetReferenceClock(clocks),
+            GetTargetClock(clocks));
+
+        Check(5 == synchronizer.ReferenceToTarget(5), "conversions are identities until the first update");
+
+        int64_t previousTargetTicks = std::numeric_limits<int64_t>::min();
+        bool isMonotonic = true;
+        bool hasStepped = false;
+        double maximumDriftErrorPartsPerMillion = 0.0;
+
+        for (int32_t update = 0; update < 400; ++update)
+        {
+            if (200 == update)
+            {
+                clocks.StepTarget(-500'000);
+            }
+
+            synchronizer.Update();
+
+            const Io::ClockSynchronizationRecord record =
+                synchronizer.GetLatestRecord();
+
+            hasStepped = hasStepped || record.Stepped;
+
+            //
+            // While the window holds samples from both sides of the step, the fit is off;
+            // the slew limits what that does to the mapping.
+            //
+            if ((update >= 32 && update < 200) || update >= 200 + 64)
+            {
+                maximumDriftErrorPartsPerMillion = std::max(
+                    maximumDriftErrorPartsPerMillion,
+                    std::abs(record.DriftPartsPerMillion - c_driftPartsPerMillion));
+            }
+
+            //
+            // Convert timestamps until the next update, as a frame source would.
+            //
+            for (int32_t i = 0; i < 100; ++i)
+            {
+                clocks.Advance(
+                    c_updateIntervalTicks / 100);
+
+                const int64_t targetTicks =
+                    synchronizer.ReferenceToTarget(clocks.GetTime());
+
+                isMonotonic = isMonotonic && (targetTicks >= previousTargetTicks);
+
+                previousTargetTicks = targetTicks;
+            }
+        }
+
+        const int64_t errorTicks =
+            synchronizer.ReferenceToTarget(clocks.GetTime()) - clocks.GetTarget(clocks.GetTime());
+
+        std::printf(
+            "TestSynchronizerSlewIsMonotonic: drift error up to %.3f ppm outside of the step, final error %lld ticks\n",
+            maximumDriftErrorPartsPerMillion,
+            static_cast<long long>(errorTicks));
+
+        Check(isMonotonic, "ReferenceToTarget is monotonic");
+        Check(!hasStepped, "corrections below MaximumSlewTicks are slewed");
+        Check(maximumDriftErrorPartsPerMillion < 0.5, "the synchronizer reports the simulated drift");
+        Check(std::abs(errorTicks) < 100, "the mapping converges to the target clock");
+    }
+
+    //
+    // A correction larger than MaximumSlewTicks (here, the target clock set back by one
+    // second) is stepped at the next update instead of being slewed in over half an hour.
+    //
+    void TestSynchronizerStepsLargeCorrections()
+    {
+        SimulatedClocks clocks;
+
+        Io::ClockSynchronizer synchronizer(
+            GetReferenceClock(clocks),
+            GetTargetClock(clocks));
+
+        for (int32_t update = 0; update < 100; ++update)
+        {
+            synchronizer.Update();
+
+            clocks.Advance(
+                c_updateIntervalTicks);
+        }
+
+        const int64_t stepTicks = -10'000'000;
+
+        Check(std::abs(stepTicks) > Io::ClockSynchronizer::Options().MaximumSlewTicks, "the step exceeds MaximumSlewTicks");
+
+        clocks.StepTarget(
+            stepTicks);
+
+        synchronizer.Update();
+
+        const Io::ClockSynchronizationRecord record =
+            synchronizer.GetLatestRecord();
+
+        clocks.Advance(
+            c_updateIntervalTicks / 2);
+
+        const int64_t errorTicks =
+            synchronizer.ReferenceToTarget(clocks.GetTime()) - clocks.GetTarget(clocks.GetTime());
+
+        std::printf(
+            "TestSynchronizerStepsLargeCorrections: correction %lld ticks, error after the step %lld ticks\n",
+            static_cast<long long>(record.CorrectionTicks),
+            static_cast<long long>(errorTicks));
+
+        Check(record.Stepped, "the correction is stepped");
+        Check(std::abs(record.CorrectionTicks - stepTicks) < 1000, "the correction is the step");
+        Check(std::abs(errorTicks) < 1000, "the mapping follows the target clock right after the step");
+
+        //
+        // The estimator starts over after the step, and fits the drift again.
+        //
+        for (int32_t update = 0; update < 64; ++update)
+        {
+            clocks.Advance(
+                c_updateIntervalTicks);
+
+            synchronizer.Update();
+        }
+
+        Check(!synchronizer.GetLatestRecord().Stepped, "later updates are not stepped");
+        Check(std::abs(synchronizer.GetLatestRecord().DriftPartsPerMillion - c_driftPartsPerMillion) < 0.5, "the drift is fitted again after the step");
+    }
+}
+
+int main()
+{
+    TestDriftEstimatorFit();
+    TestSynchronizerSlewIsMonotonic();
+    TestSynchronizerStepsLargeCorrections();
+
+    if (0 != g_numberOfFailures)
+    {
+        std::printf("%d check(s) failed\n", g_numberOfFailures);
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,9 +13,13 @@
 
 namespace Io
 {
+    namespace
+    {
+        const std::chrono::milliseconds c_clockSynchronizationInterval(2000);
+    }
+
     TimeConverter::TimeConverter()
         : _qpf()
-        , _qpc2ft()
     {
         Initialize();
     }
@@ -69,7 +73,9 @@ namespace Io
     HundredsOfNanoseconds TimeConverter::RelativeTicksToAbsoluteTicks(
         _In_ const HundredsOfNanoseconds ticks) const
     {
-        return _qpc2ft + ticks;
+        return HundredsOfNanoseconds(
+            GetClockSynchronizer().ReferenceToTarget(
+                ticks.count()));
     }
 
     HundredsOfNanoseconds TimeConverter::CalculateRelativeToAbsoluteTicksOffset() const
@@ -96,12 +102,52 @@ namespace Io
         return ft_now_in_ticks - qpc_now_in_ticks;
     }
 
+    /* static */ ClockSynchronizer& TimeConverter::GetClockSynchronizer()
+    {
+        //
+        // Deliberately leaked, along with its thread: conversions may happen until the
+        // process exits.
+        //
+        static ClockSynchronizer* const s_clockSynchronizer =
+            []()
+        {
+            const TimeConverter timeConverter;
+
+            ClockSynchronizer* clockSynchronizer =
+                new ClockSynchronizer(
+                    [timeConverter]()
+                {
+                    LARGE_INTEGER qpc;
+
+                    QueryPerformanceCounter(
+                        &qpc);
+
+                    return timeConverter.QpcToRelativeTicks(
+                        qpc).count();
+                },
+                    [timeConverter]()
+                {
+                    FILETIME ft;
+
+                    GetSystemTimePreciseAsFileTime(
+                        &ft);
+
+                    return timeConverter.FileTimeToAbsoluteTicks(
+                        ft).count();
+                });
+
+            clockSynchronizer->Start(
+                c_clockSynchronizationInterval);
+
+            return clockSynchronizer;
+        }();
+
+        return *s_clockSynchronizer;
+    }
+
     void TimeConverter::Initialize()
     {
         ASSERT(QueryPerformanceFrequency(
             &_qpf));
-
-        _qpc2ft =
-            CalculateRelativeToAbsoluteTicksOffset();
     }
 }
@@ -11,23 +11,37 @@
 
 #pragma once
 
+#include <sstream>
 #include <string>
 #include <vector>
+#include <algorithm>
 
+#include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 
+#if defined(_WIN32)
 #include "targetver.h"
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
 
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif /* !defined(NOMINMAX) */
+
 #include <Windows.h>
+#endif /* defined(_WIN32) */
+
+#if defined(__cplusplus_winrt)
 #include <ppltasks.h>
 #include <memorybuffer.h>
 #include <robuffer.h>
+#endif /* defined(__cplusplus_winrt) */
 
 #include <Debugging/All.h>
 #include <Io/All.h>
@@ -0,0 +1,1055 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        template <typename Ty>
+        void WriteValue(
+            _Inout_ std::ostream& stream,
+            _In_ const Ty& value)
+        {
+            stream.write(
+                reinterpret_cast<const char*>(&value),
+                sizeof(value));
+        }
+
+        template <typename Ty>
+        void WriteVector(
+            _Inout_ std::ostream& stream,
+            _In_ const std::vector<Ty>& values)
+        {
+            if (!values.empty())
+            {
+                stream.write(
+                    reinterpret_cast<const char*>(values.data()),
+                    values.size() * sizeof(Ty));
+            }
+        }
+
+        template <typename Ty>
+        bool ReadValue(
+            _Inout_ std::istream& stream,
+            _Out_ Ty* value)
+        {
+            stream.read(
+                reinterpret_cast<char*>(value),
+                sizeof(Ty));
+
+            return !!stream;
+        }
+
+        template <typename Ty>
+        bool ReadVector(
+            _Inout_ std::istream& stream,
+            _In_ size_t count,
+            _Out_ std::vector<Ty>& values)
+        {
+            values.resize(count);
+
+            if (0 == count)
+            {
+                return true;
+            }
+
+            stream.read(
+                reinterpret_cast<char*>(values.data()),
+                count * sizeof(Ty));
+
+            return !!stream;
+        }
+
+        void MakeGridCoordinates(
+            _In_ uint32_t extent,
+            _In_ uint32_t step,
+            _Out_ std::vector<float>& coordinates)
+        {
+            coordinates.clear();
+
+            for (uint32_t c = 0; c + 1 < extent; c += step)
+            {
+                coordinates.push_back(static_cast<float>(c));
+            }
+
+            coordinates.push_back(static_cast<float>(extent - 1));
+        }
+    }
+
+    //
+    // Save passes these by reference, so they need a definition.
+    //
+    const uint32_t CameraProjectionModel::FileCookie;
+    const uint32_t CameraProjectionModel::FileVersion;
+
+    CameraProjectionModel::FitOptions::FitOptions()
+        : GridStep(8)
+        , MinimumDegree(3)
+        , MaximumDegree(7)
+        , MaximumErrorAllowed(5e-4f)
+    {
+    }
+
+    CameraProjectionModel::ErrorStatistics::ErrorStatistics()
+        : NumberOfSamples(0)
+        , NumberOfValidSamples(0)
+        , MaximumError(0.0f)
+        , RootMeanSquareError(0.0f)
+    {
+    }
+
+    CameraProjectionModel::UnprojectionBenchmarkResults::UnprojectionBenchmarkResults()
+        : UnprojectRowNanosecondsPerPixel(0.0)
+        , DenseTableLookupNanosecondsPerPixel(0.0)
+    {
+    }
+
+    CameraProjectionModel::CameraProjectionModel()
+        : _imageWidth(0)
+        , _imageHeight(0)
+        , _degree(0)
+        , _withinTolerance(false)
+    {
+    }
+
+    bool CameraProjectionModel::Fit(
+        _In_ uint32_t imageWidth,
+        _In_ uint32_t imageHeight,
+        _In_ const ImagePointMapper& mapper,
+        _In_ const FitOptions& options)
+    {
+        REQUIRES(
+            imageWidth > 1 &&
+            imageHeight > 1 &&
+            options.GridStep > 0 &&
+            options.MinimumDegree <= options.MaximumDegree);
+
+        _imageWidth = imageWidth;
+        _imageHeight = imageHeight;
+        _degree = 0;
+        _withinTolerance = false;
+
+        MakeGridCoordinates(
+            imageWidth,
+            options.GridStep,
+            _gridU);
+
+        MakeGridCoordinates(
+            imageHeight,
+            options.GridStep,
+            _gridV);
+
+        const float infinity =
+            std::numeric_limits<float>::infinity();
+
+        //
+        // Sample the mapping on the sparse grid.
+        //
+        _gridSamples.resize(
+            _gridU.size() * _gridV.size());
+
+        for (size_t j = 0; j < _gridV.size(); ++j)
+        {
+            for (size_t i = 0; i < _gridU.size(); ++i)
+            {
+                float x = infinity, y = infinity;
+
+                if (!mapper(_gridU[i], _gridV[j], &x, &y) ||
+                    !std::isfinite(x) ||
+                    !std::isfinite(y))
+                {
+                    x = y = infinity;
+                }
+
+                _gridSamples[j * _gridU.size() + i] =
+                    cv::Point2f(x, y);
+            }
+        }
+
+        //
+        // Sample the mapping half-way between the grid samples to validate the fit.
+        //
+        std::vector<cv::Point2f> validationImagePoints;
+        std::vector<cv::Point2f> validationUnitPlanePoints;
+        std::vector<uint8_t> validationValid;
+
+        for (size_t j = 0; j + 1 < _gridV.size(); ++j)
+        {
+            for (size_t i = 0; i + 1 < _gridU.size(); ++i)
+            {
+                const float u = 0.5f * (_gridU[i] + _gridU[i + 1]);
+                const float v = 0.5f * (_gridV[j] + _gridV[j + 1]);
+
+                float x = infinity, y = infinity;
+
+                const bool valid =
+                    mapper(u, v, &x, &y) &&
+                    std::isfinite(x) &&
+                    std::isfinite(y);
+
+                validationImagePoints.emplace_back(u, v);
+                validationUnitPlanePoints.emplace_back(x, y);
+                validationValid.push_back(valid ? 1 : 0);
+            }
+        }
+
+        //
+        // Try increasingly complex polynomials until the error bound is met, keeping the
+        // most accurate one otherwise.
+        //
+        std::vector<double> bestCoefficientsX, bestCoefficientsY;
+        ErrorStatistics bestStatistics;
+        uint32_t bestDegree = 0;
+
+        for (uint32_t degree = options.MinimumDegree; degree <= options.MaximumDegree; ++degree)
+        {
+            if (!FitPolynomial(degree))
+            {
+                break;
+            }
+
+            const ErrorStatistics statistics =
+                Measure(
+                    validationImagePoints,
+                    validationUnitPlanePoints,
+                    validationValid,
+                    true /* usePolynomial */);
+
+            if (0 == bestDegree ||
+                statistics.MaximumError < bestStatistics.MaximumError)
+            {
+                bestCoefficientsX = _coefficientsX;
+                bestCoefficientsY = _coefficientsY;
+                bestStatistics = statistics;
+                bestDegree = degree;
+            }
+
+            if (statistics.MaximumError <= options.MaximumErrorAllowed)
+            {
+                break;
+            }
+        }
+
+        if (0 == bestDegree)
+        {
+            _coefficientsX.clear();
+            _coefficientsY.clear();
+
+            _fitErrorStatistics =
+                Measure(
+                    validationImagePoints,
+                    validationUnitPlanePoints,
+                    validationValid,
+                    false /* usePolynomial */);
+
+            return false;
+        }
+
+        _coefficientsX = std::move(bestCoefficientsX);
+        _coefficientsY = std::move(bestCoefficientsY);
+        _degree = bestDegree;
+        _withinTolerance =
+            bestStatistics.MaximumError <= options.MaximumErrorAllowed;
+
+        _fitErrorStatistics = _withinTolerance ?
+            bestStatistics :
+            Measure(
+                validationImagePoints,
+                validationUnitPlanePoints,
+                validationValid,
+                false /* usePolynomial */);
+
+        return _withinTolerance;
+    }
+
+    bool CameraProjectionModel::Verify(
+        _In_ const ImagePointMapper& mapper,
+        _In_ uint32_t numberOfSamplesPerAxis) const
+    {
+        if (!IsValid() || numberOfSamplesPerAxis < 2)
+        {
+            return false;
+        }
+
+        //
+        // Allow for twice the error measured at fit time before declaring the model stale.
+        //
+        const float maximumErrorAllowed =
+            std::max(2.0f * _fitErrorStatistics.MaximumError, 1e-5f);
+
+        for (uint32_t j = 0; j < numberOfSamplesPerAxis; ++j)
+        {
+            for (uint32_t i = 0; i < numberOfSamplesPerAxis; ++i)
+            {
+                const float u =
+                    (_imageWidth - 1) * (i + 0.5f) / numberOfSamplesPerAxis;
+
+                const float v =
+                    (_imageHeight - 1) * (j + 0.5f) / numberOfSamplesPerAxis;
+
+                float expectedX, expectedY;
+
+                const bool expectedValid =
+                    mapper(u, v, &expectedX, &expectedY) &&
+                    std::isfinite(expectedX) &&
+                    std::isfinite(expectedY);
+
+                float x, y;
+
+                const bool valid =
+                    MapImagePointToCameraUnitPlane(u, v, &x, &y);
+
+                if (!expectedValid || !valid)
+                {
+                    //
+                    // Disagreements about validity are expected along the border of
+                    // the field of view, so only compare points valid in both.
+                    //
+                    continue;
+                }
+
+                if (std::abs(x - expectedX) > maximumErrorAllowed ||
+                    std::abs(y - expectedY) > maximumErrorAllowed)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool CameraProjectionModel::IsValid() const
+    {
+        return
+            _imageWidth > 0 &&
+            _imageHeight > 0 &&
+            !_gridSamples.empty();
+    }
+
+    bool CameraProjectionModel::IsWithinTolerance() const
+    {
+        return _withinTolerance;
+    }
+
+    uint32_t CameraProjectionModel::GetImageWidth() const
+    {
+        return _imageWidth;
+    }
+
+    uint32_t CameraProjectionModel::GetImageHeight() const
+    {
+        return _imageHeight;
+    }
+
+    uint32_t CameraProjectionModel::GetDegree() const
+    {
+        return _degree;
+    }
+
+    const CameraProjectionModel::ErrorStatistics& CameraProjectionModel::GetFitErrorStatistics() const
+    {
+        return _fitErrorStatistics;
+    }
+
+    bool CameraProjectionModel::MapImagePointToCameraUnitPlane(
+        _In_ float u,
+        _In_ float v,
+        _Out_ float* x,
+        _Out_ float* y) const
+    {
+        const float infinity =
+            std::numeric_limits<float>::infinity();
+
+        *x = *y = infinity;
+
+        if (!IsValid() ||
+            u < 0.0f || u > static_cast<float>(_imageWidth - 1) ||
+            v < 0.0f || v > static_cast<float>(_imageHeight - 1))
+        {
+            return false;
+        }
+
+        if (_withinTolerance)
+        {
+            //
+            // The polynomial does not know about the field of view, so borrow the
+            // validity of the nearest grid sample.
+            //
+            uint32_t i, j;
+            float alpha, beta;
+
+            GetGridCell(u, _gridU, &i, &alpha);
+            GetGridCell(v, _gridV, &j, &beta);
+
+            const cv::Point2f& nearest =
+                _gridSamples[(j + (beta > 0.5f ? 1 : 0)) * _gridU.size() + (i + (alpha > 0.5f ? 1 : 0))];
+
+            if (!std::isfinite(nearest.x))
+            {
+                return false;
+            }
+
+            EvaluatePolynomial(u, v, x, y);
+
+            return true;
+        }
+
+        return InterpolateGrid(u, v, x, y);
+    }
+
+    void CameraProjectionModel::UnprojectRow(
+        _In_ uint32_t v,
+        _Out_writes_(GetImageWidth()) float* x,
+        _Out_writes_(GetImageWidth()) float* y) const
+    {
+        REQUIRES(IsValid() && v < _imageHeight);
+
+        const float infinity =
+            std::numeric_limits<float>::infinity();
+
+        if (!_withinTolerance)
+        {
+            for (uint32_t u = 0; u < _imageWidth; ++u)
+            {
+                MapImagePointToCameraUnitPlane(
+                    static_cast<float>(u),
+                    static_cast<float>(v),
+                    &x[u],
+                    &y[u]);
+            }
+
+            return;
+        }
+
+        //
+        // Collapse the bivariate polynomials into univariate ones for this row:
+        // x(s) = sum_i a_i * s^i, with a_i = sum_j c_ij * t^j.
+        //
+        double s0, t;
+
+        ToNormalized(
+            0.0f,
+            static_cast<float>(v),
+            &s0,
+            &t);
+
+        const double ds =
+            2.0 / static_cast<double>(_imageWidth - 1);
+
+        float ax[16] = {}, ay[16] = {};
+
+        ASSERT(_degree < 16);
+
+        {
+            size_t k = 0;
+            double tj = 1.0;
+
+            for (uint32_t j = 0; j <= _degree; ++j)
+            {
+                for (uint32_t i = 0; i <= _degree - j; ++i, ++k)
+                {
+                    ax[i] += static_cast<float>(_coefficientsX[k] * tj);
+                    ay[i] += static_cast<float>(_coefficientsY[k] * tj);
+                }
+
+                tj *= t;
+            }
+        }
+
+        uint32_t u = 0;
+
+#if CV_SIMD128
+        const cv::v_float32x4 laneOffsets(0.0f, 1.0f, 2.0f, 3.0f);
+        const cv::v_float32x4 scale = cv::v_setall_f32(static_cast<float>(ds));
+        const cv::v_float32x4 offset = cv::v_setall_f32(static_cast<float>(s0));
+
+        for (; u + 4 <= _imageWidth; u += 4)
+        {
+            const cv::v_float32x4 s =
+                cv::v_muladd(
+                    cv::v_setall_f32(static_cast<float>(u)) + laneOffsets,
+                    scale,
+                    offset);
+
+            cv::v_float32x4 accumulatorX = cv::v_setall_f32(ax[_degree]);
+            cv::v_float32x4 accumulatorY = cv::v_setall_f32(ay[_degree]);
+
+            for (int32_t i = static_cast<int32_t>(_degree) - 1; i >= 0; --i)
+            {
+                accumulatorX = cv::v_muladd(accumulatorX, s, cv::v_setall_f32(ax[i]));
+                accumulatorY = cv::v_muladd(accumulatorY, s, cv::v_setall_f32(ay[i]));
+            }
+
+            cv::v_store(x + u, accumulatorX);
+            cv::v_store(y + u, accumulatorY);
+        }
+#endif /* CV_SIMD128 */
+
+        for (; u < _imageWidth; ++u)
+        {
+            const float s =
+                static_cast<float>(s0 + ds * u);
+
+            float accumulatorX = ax[_degree];
+            float accumulatorY = ay[_degree];
+
+            for (int32_t i = static_cast<int32_t>(_degree) - 1; i >= 0; --i)
+            {
+                accumulatorX = accumulatorX * s + ax[i];
+                accumulatorY = accumulatorY * s + ay[i];
+            }
+
+            x[u] = accumulatorX;
+            y[u] = accumulatorY;
+        }
+
+        //
+        // Mask out the pixels whose nearest grid sample has no valid mapping.
+        //
+        uint32_t j;
+        float beta;
+
+        GetGridCell(static_cast<float>(v), _gridV, &j, &beta);
+
+        const cv::Point2f* gridRow =
+            &_gridSamples[(j + (beta > 0.5f ? 1 : 0)) * _gridU.size()];
+
+        for (size_t i = 0; i < _gridU.size(); ++i)
+        {
+            if (std::isfinite(gridRow[i].x))
+            {
+                continue;
+            }
+
+            const float begin =
+                (0 == i) ? 0.0f : 0.5f * (_gridU[i - 1] + _gridU[i]);
+
+            const float end =
+                (i + 1 == _gridU.size()) ? static_cast<float>(_imageWidth) : 0.5f * (_gridU[i] + _gridU[i + 1]);
+
+            for (uint32_t k = static_cast<uint32_t>(std::ceil(begin)); k < _imageWidth && static_cast<float>(k) < end; ++k)
+            {
+                x[k] = y[k] = infinity;
+            }
+        }
+    }
+
+    void CameraProjectionModel::ComputeUnitPlaneMap(
+        _Out_ cv::Mat& unitPlaneMap) const
+    {
+        REQUIRES(IsValid());
+
+        unitPlaneMap.create(
+            static_cast<int>(_imageHeight),
+            static_cast<int>(_imageWidth),
+            CV_32FC2);
+
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int>(_imageHeight)),
+            [&](const cv::Range& range)
+        {
+            std::vector<float> x(_imageWidth), y(_imageWidth);
+
+            for (int v = range.start; v < range.end; ++v)
+            {
+                UnprojectRow(
+                    static_cast<uint32_t>(v),
+                    x.data(),
+                    y.data());
+
+                cv::Point2f* row =
+                    unitPlaneMap.ptr<cv::Point2f>(v);
+
+                for (uint32_t u = 0; u < _imageWidth; ++u)
+                {
+                    row[u] = cv::Point2f(x[u], y[u]);
+                }
+            }
+        });
+    }
+
+    void CameraProjectionModel::ComputeDenseProjectionTable(
+        _Out_ std::vector<float>& table) const
+    {
+        cv::Mat unitPlaneMap;
+
+        ComputeUnitPlaneMap(
+            unitPlaneMap);
+
+        table.resize(
+            static_cast<size_t>(_imageWidth) * _imageHeight * 2);
+
+        size_t index = 0;
+
+        for (uint32_t u = 0; u < _imageWidth; ++u)
+        {
+            for (uint32_t v = 0; v < _imageHeight; ++v)
+            {
+                const cv::Point2f& xy =
+                    unitPlaneMap.at<cv::Point2f>(v, u);
+
+                table[index++] = xy.x;
+                table[index++] = xy.y;
+            }
+        }
+    }
+
+    CameraProjectionModel::ErrorStatistics CameraProjectionModel::CompareWithDenseProjectionTable(
+        _In_ const std::vector<float>& table) const
+    {
+        REQUIRES(
+            table.size() == static_cast<size_t>(_imageWidth) * _imageHeight * 2);
+
+        std::vector<float> modelTable;
+
+        ComputeDenseProjectionTable(
+            modelTable);
+
+        ErrorStatistics statistics;
+        double sumOfSquares = 0.0;
+
+        for (size_t k = 0; k < table.size(); k += 2)
+        {
+            ++statistics.NumberOfSamples;
+
+            if (!std::isfinite(table[k]) || !std::isfinite(modelTable[k]))
+            {
+                continue;
+            }
+
+            const float error =
+                std::hypot(
+                    modelTable[k] - table[k],
+                    modelTable[k + 1] - table[k + 1]);
+
+            ++statistics.NumberOfValidSamples;
+
+            statistics.MaximumError =
+                std::max(statistics.MaximumError, error);
+
+            sumOfSquares += error * error;
+        }
+
+        if (statistics.NumberOfValidSamples > 0)
+        {
+            statistics.RootMeanSquareError =
+                static_cast<float>(std::sqrt(sumOfSquares / statistics.NumberOfValidSamples));
+        }
+
+        return statistics;
+    }
+
+    CameraProjectionModel::UnprojectionBenchmarkResults CameraProjectionModel::BenchmarkUnprojection(
+        _In_ const std::vector<float>& table,
+        _In_ uint32_t numberOfIterations) const
+    {
+        REQUIRES(
+            IsValid() &&
+            numberOfIterations > 0 &&
+            table.size() == static_cast<size_t>(_imageWidth) * _imageHeight * 2);
+
+        std::vector<float> x(_imageWidth);
+        std::vector<float> y(_imageWidth);
+
+        //
+        // Summed, so that the compiler cannot drop the work being measured.
+        //
+        float checksum = 0.0f;
+
+        const std::chrono::steady_clock::time_point unprojectStartTime =
+            std::chrono::steady_clock::now();
+
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            for (uint32_t v = 0; v < _imageHeight; ++v)
+            {
+                UnprojectRow(
+                    v,
+                    x.data(),
+                    y.data());
+
+                checksum += x[v % _imageWidth];
+            }
+        }
+
+        const std::chrono::steady_clock::time_point lookupStartTime =
+            std::chrono::steady_clock::now();
+
+        //
+        // The table is column-major, so reading a row strides through it, as the
+        // consumers of the table did.
+        //
+        for (uint32_t iteration = 0; iteration < numberOfIterations; ++iteration)
+        {
+            for (uint32_t v = 0; v < _imageHeight; ++v)
+            {
+                for (uint32_t u = 0; u < _imageWidth; ++u)
+                {
+                    const size_t index =
+                        (static_cast<size_t>(u) * _imageHeight + v) * 2;
+
+                    x[u] = table[index];
+                    y[u] = table[index + 1];
+                }
+
+                checksum += x[v % _imageWidth];
+            }
+        }
+
+        const std::chrono::steady_clock::time_point endTime =
+            std::chrono::steady_clock::now();
+
+        const double numberOfPixels =
+            static_cast<double>(_imageWidth) * _imageHeight * numberOfIterations;
+
+        UnprojectionBenchmarkResults results;
+
+        results.UnprojectRowNanosecondsPerPixel =
+            std::chrono::duration<double, std::nano>(lookupStartTime - unprojectStartTime).count() / numberOfPixels;
+
+        results.DenseTableLookupNanosecondsPerPixel =
+            std::chrono::duration<double, std::nano>(endTime - lookupStartTime).count() / numberOfPixels;
+
+        dbg::trace(
+            L"CameraProjectionModel::BenchmarkUnprojection: %ux%u, UnprojectRow %.2fns/pixel, dense table %.2fns/pixel (checksum %f)",
+            _imageWidth,
+            _imageHeight,
+            results.UnprojectRowNanosecondsPerPixel,
+            results.DenseTableLookupNanosecondsPerPixel,
+            checksum);
+
+        return results;
+    }
+
+    void CameraProjectionModel::Save(
+        _Inout_ std::ostream& stream) const
+    {
+        REQUIRES(IsValid());
+
+        WriteValue(stream, FileCookie);
+        WriteValue(stream, FileVersion);
+        WriteValue(stream, _imageWidth);
+        WriteValue(stream, _imageHeight);
+        WriteValue(stream, _degree);
+        WriteValue(stream, static_cast<uint32_t>(_withinTolerance ? 1 : 0));
+        WriteValue(stream, _fitErrorStatistics.NumberOfSamples);
+        WriteValue(stream, _fitErrorStatistics.NumberOfValidSamples);
+        WriteValue(stream, _fitErrorStatistics.MaximumError);
+        WriteValue(stream, _fitErrorStatistics.RootMeanSquareError);
+        WriteValue(stream, static_cast<uint32_t>(_gridU.size()));
+        WriteValue(stream, static_cast<uint32_t>(_gridV.size()));
+
+        WriteVector(stream, _gridU);
+        WriteVector(stream, _gridV);
+        WriteVector(stream, _coefficientsX);
+        WriteVector(stream, _coefficientsY);
+        WriteVector(stream, _gridSamples);
+    }
+
+    bool CameraProjectionModel::Load(
+        _Inout_ std::istream& stream)
+    {
+        uint32_t cookie = 0, version = 0, withinTolerance = 0;
+        uint32_t gridColumns = 0, gridRows = 0;
+
+        if (!ReadValue(stream, &cookie) || FileCookie != cookie ||
+            !ReadValue(stream, &version) || FileVersion != version ||
+            !ReadValue(stream, &_imageWidth) ||
+            !ReadValue(stream, &_imageHeight) ||
+            !ReadValue(stream, &_degree) ||
+            !ReadValue(stream, &withinTolerance) ||
+            !ReadValue(stream, &_fitErrorStatistics.NumberOfSamples) ||
+            !ReadValue(stream, &_fitErrorStatistics.NumberOfValidSamples) ||
+            !ReadValue(stream, &_fitErrorStatistics.MaximumError) ||
+            !ReadValue(stream, &_fitErrorStatistics.RootMeanSquareError) ||
+            !ReadValue(stream, &gridColumns) ||
+            !ReadValue(stream, &gridRows) ||
+            _degree >= 16)
+        {
+            *this = CameraProjectionModel();
+
+            return false;
+        }
+
+        const size_t numberOfTerms =
+            (0 == _degree) ? 0 : GetNumberOfTerms(_degree);
+
+        if (!ReadVector(stream, gridColumns, _gridU) ||
+            !ReadVector(stream, gridRows, _gridV) ||
+            !ReadVector(stream, numberOfTerms, _coefficientsX) ||
+            !ReadVector(stream, numberOfTerms, _coefficientsY) ||
+            !ReadVector(stream, static_cast<size_t>(gridColumns) * gridRows, _gridSamples))
+        {
+            *this = CameraProjectionModel();
+
+            return false;
+        }
+
+        _withinTolerance =
+            (0 != withinTolerance) && (0 != _degree);
+
+        return IsValid();
+    }
+
+    /* static */ uint32_t CameraProjectionModel::GetNumberOfTerms(
+        _In_ uint32_t degree)
+    {
+        return (degree + 1) * (degree + 2) / 2;
+    }
+
+    void CameraProjectionModel::ToNormalized(
+        _In_ float u,
+        _In_ float v,
+        _Out_ double* s,
+        _Out_ double* t) const
+    {
+        const double halfWidth = 0.5 * (_imageWidth - 1);
+        const double halfHeight = 0.5 * (_imageHeight - 1);
+
+        *s = (u - halfWidth) / halfWidth;
+        *t = (v - halfHeight) / halfHeight;
+    }
+
+    void CameraProjectionModel::EvaluatePolynomial(
+        _In_ float u,
+        _In_ float v,
+        _Out_ float* x,
+        _Out_ float* y) const
+    {
+        double s, t;
+
+        ToNormalized(u, v, &s, &t);
+
+        double sumX = 0.0, sumY = 0.0;
+        double tj = 1.0;
+        size_t k = 0;
+
+        for (uint32_t j = 0; j <= _degree; ++j)
+        {
+            double si = tj;
+
+            for (uint32_t i = 0; i <= _degree - j; ++i, ++k)
+            {
+                sumX += _coefficientsX[k] * si;
+                sumY += _coefficientsY[k] * si;
+
+                si *= s;
+            }
+
+            tj *= t;
+        }
+
+        *x = static_cast<float>(sumX);
+        *y = static_cast<float>(sumY);
+    }
+
+    bool CameraProjectionModel::InterpolateGrid(
+        _In_ float u,
+        _In_ float v,
+        _Out_ float* x,
+        _Out_ float* y) const
+    {
+        uint32_t i, j;
+        float alpha, beta;
+
+        GetGridCell(u, _gridU, &i, &alpha);
+        GetGridCell(v, _gridV, &j, &beta);
+
+        const size_t columns = _gridU.size();
+
+        const cv::Point2f& p00 = _gridSamples[j * columns + i];
+        const cv::Point2f& p01 = _gridSamples[j * columns + i + 1];
+        const cv::Point2f& p10 = _gridSamples[(j + 1) * columns + i];
+        const cv::Point2f& p11 = _gridSamples[(j + 1) * columns + i + 1];
+
+        if (!std::isfinite(p00.x) || !std::isfinite(p01.x) ||
+            !std::isfinite(p10.x) || !std::isfinite(p11.x))
+        {
+            *x = *y = std::numeric_limits<float>::infinity();
+
+            return false;
+        }
+
+        const cv::Point2f top = p00 + (p01 - p00) * alpha;
+        const cv::Point2f bottom = p10 + (p11 - p10) * alpha;
+        const cv::Point2f xy = top + (bottom - top) * beta;
+
+        *x = xy.x;
+        *y = xy.y;
+
+        return true;
+    }
+
+    bool CameraProjectionModel::FitPolynomial(
+        _In_ uint32_t degree)
+    {
+        const uint32_t numberOfTerms =
+            GetNumberOfTerms(degree);
+
+        size_t numberOfValidSamples = 0;
+
+        for (const cv::Point2f& sample : _gridSamples)
+        {
+            if (std::isfinite(sample.x))
+            {
+                ++numberOfValidSamples;
+            }
+        }
+
+        if (numberOfValidSamples < 2 * numberOfTerms)
+        {
+            return false;
+        }
+
+        cv::Mat A(static_cast<int>(numberOfValidSamples), static_cast<int>(numberOfTerms), CV_64F);
+        cv::Mat b(static_cast<int>(numberOfValidSamples), 2, CV_64F);
+
+        int row = 0;
+
+        for (size_t j = 0; j < _gridV.size(); ++j)
+        {
+            for (size_t i = 0; i < _gridU.size(); ++i)
+            {
+                const cv::Point2f& sample =
+                    _gridSamples[j * _gridU.size() + i];
+
+                if (!std::isfinite(sample.x))
+                {
+                    continue;
+                }
+
+                double s, t;
+
+                ToNormalized(_gridU[i], _gridV[j], &s, &t);
+
+                double* a = A.ptr<double>(row);
+                double tj = 1.0;
+
+                for (uint32_t q = 0; q <= degree; ++q)
+                {
+                    double si = tj;
+
+                    for (uint32_t p = 0; p <= degree - q; ++p)
+                    {
+                        *a++ = si;
+                        si *= s;
+                    }
+
+                    tj *= t;
+                }
+
+                b.at<double>(row, 0) = sample.x;
+                b.at<double>(row, 1) = sample.y;
+
+                ++row;
+            }
+        }
+
+        cv::Mat coefficients;
+
+        if (!cv::solve(A, b, coefficients, cv::DECOMP_QR))
+        {
+            return false;
+        }
+
+        _degree = degree;
+        _coefficientsX.resize(numberOfTerms);
+        _coefficientsY.resize(numberOfTerms);
+
+        for (uint32_t k = 0; k < numberOfTerms; ++k)
+        {
+            _coefficientsX[k] = coefficients.at<double>(k, 0);
+            _coefficientsY[k] = coefficients.at<double>(k, 1);
+        }
+
+        return true;
+    }
+
+    CameraProjectionModel::ErrorStatistics CameraProjectionModel::Measure(
+        _In_ const std::vector<cv::Point2f>& imagePoints,
+        _In_ const std::vector<cv::Point2f>& unitPlanePoints,
+        _In_ const std::vector<uint8_t>& valid,
+        _In_ bool usePolynomial) const
+    {
+        ErrorStatistics statistics;
+        double sumOfSquares = 0.0;
+
+        for (size_t k = 0; k < imagePoints.size(); ++k)
+        {
+            ++statistics.NumberOfSamples;
+
+            if (!valid[k])
+            {
+                continue;
+            }
+
+            float x, y;
+
+            if (usePolynomial)
+            {
+                EvaluatePolynomial(imagePoints[k].x, imagePoints[k].y, &x, &y);
+            }
+            else if (!InterpolateGrid(imagePoints[k].x, imagePoints[k].y, &x, &y))
+            {
+                continue;
+            }
+
+            const float error =
+                std::hypot(
+                    x - unitPlanePoints[k].x,
+                    y - unitPlanePoints[k].y);
+
+            ++statistics.NumberOfValidSamples;
+
+            statistics.MaximumError =
+                std::max(statistics.MaximumError, error);
+
+            sumOfSquares += error * error;
+        }
+
+        if (statistics.NumberOfValidSamples > 0)
+        {
+            statistics.RootMeanSquareError =
+                static_cast<float>(std::sqrt(sumOfSquares / statistics.NumberOfValidSamples));
+        }
+
+        return statistics;
+    }
+
+    void CameraProjectionModel::GetGridCell(
+        _In_ float coordinate,
+        _In_ const std::vector<float>& gridCoordinates,
+        _Out_ uint32_t* cell,
+        _Out_ float* alpha) const
+    {
+        //
+        // All grid cells but the last one are of the same size, so the cell index can
+        // be derived from the size of the first one.
+        //
+        const float step =
+            gridCoordinates[1] - gridCoordinates[0];
+
+        uint32_t i =
+            static_cast<uint32_t>(std::max(0.0f, coordinate) / step);
+
+        i = std::min(
+            i,
+            static_cast<uint32_t>(gridCoordinates.size() - 2));
+
+        *cell = i;
+
+        *alpha =
+            (coordinate - gridCoordinates[i]) / (gridCoordinates[i + 1] - gridCoordinates[i]);
+    }
+}
@@ -0,0 +1,148 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        const char c_serializationMagic[4] = { 'O', 'R', 'B', '1' };
+        const size_t c_serializedHeaderSize = 12;
+        const size_t c_serializedKeypointSize = 24;
+
+        template <typename T>
+        void AppendValue(
+            _In_ const T& value,
+            _Inout_ std::vector<uint8_t>& data)
+        {
+            const uint8_t* bytes =
+                reinterpret_cast<const uint8_t*>(&value);
+
+            data.insert(
+                data.end(),
+                bytes,
+                bytes + sizeof(T));
+        }
+
+        template <typename T>
+        T ReadValue(
+            _In_reads_bytes_(sizeof(T)) const uint8_t* data)
+        {
+            T value;
+
+            memcpy(&value, data, sizeof(T));
+
+            return value;
+        }
+    }
+
+    void SerializeImageFeatures(
+        _In_ const ImageFeatures& features,
+        _Out_ std::vector<uint8_t>& data)
+    {
+        const uint32_t numberOfKeypoints =
+            static_cast<uint32_t>(features.Keypoints.size());
+
+        REQUIRES(features.Descriptors.rows == static_cast<int32_t>(numberOfKeypoints));
+        REQUIRES(0 == numberOfKeypoints || CV_8UC1 == features.Descriptors.type());
+
+        const uint32_t descriptorSize =
+            (numberOfKeypoints > 0) ? static_cast<uint32_t>(features.Descriptors.cols) : ImageFeatures::DescriptorSize;
+
+        data.clear();
+        data.reserve(
+            c_serializedHeaderSize + numberOfKeypoints * (c_serializedKeypointSize + descriptorSize));
+
+        data.insert(
+            data.end(),
+            c_serializationMagic,
+            c_serializationMagic + sizeof(c_serializationMagic));
+
+        AppendValue(numberOfKeypoints, data);
+        AppendValue(descriptorSize, data);
+
+        for (const cv::KeyPoint& keypoint : features.Keypoints)
+        {
+            AppendValue(keypoint.pt.x, data);
+            AppendValue(keypoint.pt.y, data);
+            AppendValue(keypoint.size, data);
+            AppendValue(keypoint.angle, data);
+            AppendValue(keypoint.response, data);
+            AppendValue(static_cast<int32_t>(keypoint.octave), data);
+        }
+
+        for (uint32_t i = 0; i < numberOfKeypoints; ++i)
+        {
+            const uint8_t* descriptor =
+                features.Descriptors.ptr<uint8_t>(static_cast<int32_t>(i));
+
+            data.insert(
+                data.end(),
+                descriptor,
+                descriptor + descriptorSize);
+        }
+    }
+
+    bool DeserializeImageFeatures(
+        _In_reads_bytes_(dataSize) const uint8_t* data,
+        _In_ size_t dataSize,
+        _Out_ ImageFeatures& features)
+    {
+        features.Keypoints.clear();
+        features.Descriptors.release();
+
+        if (dataSize < c_serializedHeaderSize ||
+            0 != memcmp(data, c_serializationMagic, sizeof(c_serializationMagic)))
+        {
+            return false;
+        }
+
+        const uint32_t numberOfKeypoints =
+            ReadValue<uint32_t>(data + 4);
+
+        const uint32_t descriptorSize =
+            ReadValue<uint32_t>(data + 8);
+
+        if (0 == descriptorSize ||
+            (dataSize - c_serializedHeaderSize) / (c_serializedKeypointSize + descriptorSize) < numberOfKeypoints)
+        {
+            return false;
+        }
+
+        const uint8_t* keypointData =
+            data + c_serializedHeaderSize;
+
+        features.Keypoints.resize(numberOfKeypoints);
+
+        for (cv::KeyPoint& keypoint : features.Keypoints)
+        {
+            keypoint.pt.x = ReadValue<float>(keypointData);
+            keypoint.pt.y = ReadValue<float>(keypointData + 4);
+            keypoint.size = ReadValue<float>(keypointData + 8);
+            keypoint.angle = ReadValue<float>(keypointData + 12);
+            keypoint.response = ReadValue<float>(keypointData + 16);
+            keypoint.octave = ReadValue<int32_t>(keypointData + 20);
+            keypoint.class_id = -1;
+
+            keypointData += c_serializedKeypointSize;
+        }
+
+        cv::Mat(
+            static_cast<int32_t>(numberOfKeypoints),
+            static_cast<int32_t>(descriptorSize),
+            CV_8UC1,
+            const_cast<uint8_t*>(keypointData)).copyTo(
+                features.Descriptors);
+
+        return true;
+    }
+}
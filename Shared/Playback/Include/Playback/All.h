@@ -0,0 +1,19 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <Playback/CameraProjectionModel.h>
+#include <Playback/ImageFeatures.h>
+#include <Playback/SensorFrameRecordingReader.h>
+#include <Playback/SensorFramePlaybackEngine.h>
+#include <Playback/SyntheticSensorFrameGenerator.h>
+#include <Playback/PipelineBenchmark.h>
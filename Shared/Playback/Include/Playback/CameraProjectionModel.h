@@ -0,0 +1,223 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace HoloLensForCV
+{
+    //
+    // Compact description of the mapping from image pixels to the camera unit (Z=1) plane.
+    //
+    // Instead of querying the sensor streaming intrinsics once per pixel, the mapping is
+    // sampled on a sparse grid and fitted with a pair of bivariate polynomials. The sparse
+    // grid is retained as a compressed lookup table: it marks the pixels that do not have a
+    // valid mapping and can be bilinearly interpolated when the polynomial fit did not reach
+    // the requested accuracy.
+    //
+    // Pixel coordinates follow the CameraIntrinsics convention: the integer coordinate of a
+    // pixel corresponds to the location of its top-left corner.
+    //
+    class CameraProjectionModel
+    {
+    public:
+        //
+        // Maps an image point to the unit plane. Returns false if the point has no valid
+        // mapping (e.g. it lies outside of the sensor's field of view).
+        //
+        typedef std::function<bool(float u, float v, float* x, float* y)> ImagePointMapper;
+
+        struct FitOptions
+        {
+            FitOptions();
+
+            // Distance, in pixels, between two neighboring grid samples.
+            uint32_t GridStep;
+
+            // Polynomial degrees tried in increasing order until the error bound is met.
+            uint32_t MinimumDegree;
+            uint32_t MaximumDegree;
+
+            // Maximum error allowed on the unit plane, measured on validation samples
+            // placed half-way between the fitting samples.
+            float MaximumErrorAllowed;
+        };
+
+        struct ErrorStatistics
+        {
+            ErrorStatistics();
+
+            uint32_t NumberOfSamples;
+            uint32_t NumberOfValidSamples;
+            float MaximumError;
+            float RootMeanSquareError;
+        };
+
+        struct UnprojectionBenchmarkResults
+        {
+            UnprojectionBenchmarkResults();
+
+            // Time per pixel to map the image a row at a time with UnprojectRow, and to
+            // read the same rows from the dense table it replaces.
+            double UnprojectRowNanosecondsPerPixel;
+            double DenseTableLookupNanosecondsPerPixel;
+        };
+
+        CameraProjectionModel();
+
+        //
+        // Samples the mapping on a sparse grid and fits the polynomial model. Returns true if
+        // the polynomial model is within the requested error bound.
+        //
+        bool Fit(
+            _In_ uint32_t imageWidth,
+            _In_ uint32_t imageHeight,
+            _In_ const ImagePointMapper& mapper,
+            _In_ const FitOptions& options = FitOptions());
+
+        //
+        // Compares the model against a small number of fresh samples. Used to make sure
+        // that a cached model still describes the current device calibration.
+        //
+        bool Verify(
+            _In_ const ImagePointMapper& mapper,
+            _In_ uint32_t numberOfSamplesPerAxis = 5) const;
+
+        bool IsValid() const;
+
+        bool IsWithinTolerance() const;
+
+        uint32_t GetImageWidth() const;
+
+        uint32_t GetImageHeight() const;
+
+        uint32_t GetDegree() const;
+
+        const ErrorStatistics& GetFitErrorStatistics() const;
+
+        //
+        // Maps a single image point to the unit plane.
+        //
+        bool MapImagePointToCameraUnitPlane(
+            _In_ float u,
+            _In_ float v,
+            _Out_ float* x,
+            _Out_ float* y) const;
+
+        //
+        // Maps one image row at a time using vectorized polynomial evaluation. Pixels
+        // without a valid mapping are set to +infinity.
+        //
+        void UnprojectRow(
+            _In_ uint32_t v,
+            _Out_writes_(GetImageWidth()) float* x,
+            _Out_writes_(GetImageWidth()) float* y) const;
+
+        //
+        // Produces the full unit plane map as a CV_32FC2 image, parallelized over rows.
+        //
+        void ComputeUnitPlaneMap(
+            _Out_ cv::Mat& unitPlaneMap) const;
+
+        //
+        // Produces the legacy dense table, stored column-major (x-major) as pairs of floats,
+        // which is the layout of the '<sensor>_camera_space_projection.bin' files.
+        //
+        void ComputeDenseProjectionTable(
+            _Out_ std::vector<float>& table) const;
+
+        //
+        // Compares the model against a dense table in the legacy layout.
+        //
+        ErrorStatistics CompareWithDenseProjectionTable(
+            _In_ const std::vector<float>& table) const;
+
+        //
+        // Measures the throughput of UnprojectRow against lookups in a dense table in the
+        // legacy layout (e.g. one sampled from the sensor's own mapping), over the given
+        // number of passes over the image.
+        //
+        UnprojectionBenchmarkResults BenchmarkUnprojection(
+            _In_ const std::vector<float>& table,
+            _In_ uint32_t numberOfIterations) const;
+
+        void Save(
+            _Inout_ std::ostream& stream) const;
+
+        bool Load(
+            _Inout_ std::istream& stream);
+
+        static const uint32_t FileCookie = 0x4d434c48; // 'HLCM'
+        static const uint32_t FileVersion = 1;
+
+    private:
+        static uint32_t GetNumberOfTerms(
+            _In_ uint32_t degree);
+
+        void ToNormalized(
+            _In_ float u,
+            _In_ float v,
+            _Out_ double* s,
+            _Out_ double* t) const;
+
+        void EvaluatePolynomial(
+            _In_ float u,
+            _In_ float v,
+            _Out_ float* x,
+            _Out_ float* y) const;
+
+        bool InterpolateGrid(
+            _In_ float u,
+            _In_ float v,
+            _Out_ float* x,
+            _Out_ float* y) const;
+
+        bool FitPolynomial(
+            _In_ uint32_t degree);
+
+        ErrorStatistics Measure(
+            _In_ const std::vector<cv::Point2f>& imagePoints,
+            _In_ const std::vector<cv::Point2f>& unitPlanePoints,
+            _In_ const std::vector<uint8_t>& valid,
+            _In_ bool usePolynomial) const;
+
+        void GetGridCell(
+            _In_ float coordinate,
+            _In_ const std::vector<float>& gridCoordinates,
+            _Out_ uint32_t* cell,
+            _Out_ float* alpha) const;
+
+    private:
+        uint32_t _imageWidth;
+        uint32_t _imageHeight;
+        uint32_t _degree;
+        bool _withinTolerance;
+
+        ErrorStatistics _fitErrorStatistics;
+
+        // Polynomial coefficients, in the order s^i * t^j for j = 0..degree, i = 0..degree-j.
+        std::vector<double> _coefficientsX;
+        std::vector<double> _coefficientsY;
+
+        // Sparse grid samples: pixel coordinates along each axis, and the mapped points
+        // (row-major, +infinity for invalid samples).
+        std::vector<float> _gridU;
+        std::vector<float> _gridV;
+        std::vector<cv::Point2f> _gridSamples;
+    };
+}
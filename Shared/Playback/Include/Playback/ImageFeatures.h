@@ -0,0 +1,57 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace HoloLensForCV
+{
+    //
+    // Keypoints and binary descriptors of an image.
+    //
+    struct ImageFeatures
+    {
+        // Size of the ORB descriptors computed by the FeatureExtractor, in bytes.
+        static const int32_t DescriptorSize = 32;
+
+        // Positions, sizes and scales (octave) are expressed in pixels of the image the
+        // features were extracted from; angles are in degrees.
+        std::vector<cv::KeyPoint> Keypoints;
+
+        // CV_8UC1, one row of DescriptorSize bytes per keypoint.
+        cv::Mat Descriptors;
+    };
+
+    //
+    // Serializes features as stored in recordings (see SensorFrameRecorderSink):
+    //
+    //     char[4]   "ORB1"
+    //     uint32    number of keypoints
+    //     uint32    descriptor size, in bytes
+    //     then, for each keypoint, x, y, size, angle and response (float) and
+    //     octave (int32), followed by the descriptors, row after row.
+    //
+    // Values are little-endian.
+    //
+    void SerializeImageFeatures(
+        _In_ const ImageFeatures& features,
+        _Out_ std::vector<uint8_t>& data);
+
+    bool DeserializeImageFeatures(
+        _In_reads_bytes_(dataSize) const uint8_t* data,
+        _In_ size_t dataSize,
+        _Out_ ImageFeatures& features);
+}
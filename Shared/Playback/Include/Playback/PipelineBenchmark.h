@@ -0,0 +1,149 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <Playback/SyntheticSensorFrameGenerator.h>
+
+namespace HoloLensForCV
+{
+    //
+    // Counts the heap allocations made by the current module. The counter only moves if
+    // the module expands HOLOLENSFORCV_DEFINE_COUNTING_OPERATOR_NEW once (typically in the
+    // benchmark host's main translation unit), replacing the global operator new.
+    //
+    inline std::atomic<uint64_t>& GetAllocationCounter()
+    {
+        static std::atomic<uint64_t> allocationCounter(0);
+
+        return allocationCounter;
+    }
+
+#define HOLOLENSFORCV_DEFINE_COUNTING_OPERATOR_NEW()                                    \
+    void* operator new(size_t size)                                                    \
+    {                                                                                  \
+        ++HoloLensForCV::GetAllocationCounter();                                       \
+                                                                                       \
+        if (void* pointer = std::malloc(0 == size ? 1 : size))                         \
+        {                                                                              \
+            return pointer;                                                            \
+        }                                                                              \
+                                                                                       \
+        throw std::bad_alloc();                                                        \
+    }                                                                                  \
+                                                                                       \
+    void operator delete(void* pointer) noexcept                                       \
+    {                                                                                  \
+        std::free(pointer);                                                            \
+    }
+
+    //
+    // Drives a frame consumer (a sink, a processing stage, ...) with synthetic frames and
+    // measures throughput, per-frame latency, CPU time and allocations.
+    //
+    // Latency is measured from the moment a frame is handed to the consumer (its scheduled
+    // time when pacing) until the consumer returns. Frame generation is not included.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class PipelineBenchmark
+    {
+    public:
+        typedef std::function<void(const RecordedSensorFrame& frame)> FrameConsumer;
+
+        struct Options
+        {
+            Options();
+
+            // The run stops after this duration of playback, or this number of frames.
+            double DurationInSeconds;
+            uint64_t MaximumNumberOfFrames;
+
+            // Frames consumed before measurements start.
+            uint32_t NumberOfWarmupFrames;
+
+            // Deliver frames on the sensors' nominal schedules rather than back-to-back.
+            bool Paced;
+        };
+
+        struct LatencyStatistics
+        {
+            LatencyStatistics();
+
+            double P50InMilliseconds;
+            double P99InMilliseconds;
+            double MaximumInMilliseconds;
+            double MeanInMilliseconds;
+        };
+
+        struct SensorResults
+        {
+            std::string SensorName;
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfBytes;
+
+            LatencyStatistics Latency;
+        };
+
+        struct Results
+        {
+            Results();
+
+            std::string Name;
+
+            uint64_t NumberOfFrames;
+            uint64_t NumberOfBytes;
+            double ElapsedTimeInSeconds;
+
+            double FramesPerSecond;
+            double MegabytesPerSecond;
+
+            LatencyStatistics Latency;
+
+            double CpuTimePerFrameInMilliseconds;
+
+            // Negative if allocations are not being counted.
+            double AllocationsPerFrame;
+
+            std::vector<SensorResults> Sensors;
+        };
+
+        static Results Run(
+            _In_ const std::string& name,
+            _Inout_ SyntheticSensorFrameGenerator& generator,
+            _In_ const FrameConsumer& consumer,
+            _In_ const Options& options = Options());
+
+        //
+        // Serializes a set of results as JSON, for regression tracking.
+        //
+        static std::string ToJson(
+            _In_ const std::vector<Results>& results);
+
+        //
+        // User plus kernel CPU time consumed by the process so far.
+        //
+        static double GetProcessCpuTimeInSeconds();
+
+    private:
+        static LatencyStatistics ComputeLatencyStatistics(
+            _Inout_ std::vector<double>& latenciesInMilliseconds);
+    };
+}
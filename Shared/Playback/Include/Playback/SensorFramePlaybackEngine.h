@@ -0,0 +1,156 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Playback/SensorFrameRecordingReader.h>
+
+namespace HoloLensForCV
+{
+    //
+    // Replays the frames of one or more recorded sensors, merged in timestamp order.
+    //
+    // Frames are read and decoded ahead of time by a pool of background threads, then
+    // delivered in order by a dedicated thread, either on the recorded schedule (scaled
+    // by the playback speed) or as fast as the consumer accepts them.
+    //
+    // Like the reader, this class does not depend on any Windows API.
+    //
+    class SensorFramePlaybackEngine
+    {
+    public:
+        typedef std::function<void(const RecordedSensorFrame& frame)> FrameCallback;
+
+        struct Options
+        {
+            Options();
+
+            //
+            // 1.0 replays on the recorded schedule, 2.0 twice as fast, etc. Zero or
+            // negative values deliver frames as fast as possible.
+            //
+            double PlaybackSpeed;
+
+            // Number of decoded frames kept ahead of the delivery thread.
+            uint32_t PrefetchDepth;
+
+            // Number of threads reading and decoding frames.
+            uint32_t NumberOfDecodingThreads;
+
+            // Restart from the first frame once all frames have been delivered.
+            bool Loop;
+        };
+
+        struct Statistics
+        {
+            Statistics();
+
+            uint64_t FramesDelivered;
+            uint64_t FramesDropped;
+
+            // Frames delivered later than their scheduled time by more than a millisecond.
+            uint64_t FramesDeliveredLate;
+            double MaximumLatenessInMilliseconds;
+
+            // Time the delivery thread spent waiting for the decoding threads.
+            double DecodingStallsInMilliseconds;
+
+            double ElapsedTimeInMilliseconds;
+        };
+
+        SensorFramePlaybackEngine();
+
+        ~SensorFramePlaybackEngine();
+
+        //
+        // Adds a sensor to replay. Returns the sensor index reported with its frames,
+        // or -1 if the recording does not contain frames for this sensor.
+        //
+        int32_t AddSensor(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName);
+
+        size_t GetNumberOfSensors() const;
+
+        size_t GetNumberOfFrames() const;
+
+        void Start(
+            _In_ const Options& options,
+            _In_ const FrameCallback& callback);
+
+        //
+        // Stops the playback and waits for the background threads to exit.
+        //
+        void Stop();
+
+        //
+        // Waits until all frames have been delivered (never returns while looping,
+        // unless Stop is called from another thread).
+        //
+        void WaitForCompletion();
+
+        bool IsRunning() const;
+
+        Statistics GetStatistics() const;
+
+    private:
+        struct TimelineEntry
+        {
+            uint64_t Timestamp;
+            uint32_t SensorIndex;
+            uint32_t FrameIndex;
+        };
+
+        struct DecodedFrame
+        {
+            bool Valid;
+            RecordedSensorFrame Frame;
+        };
+
+        void DecodingThread();
+
+        void DeliveryThread();
+
+    private:
+        std::vector<std::unique_ptr<SensorFrameRecordingReader>> _readers;
+        std::vector<TimelineEntry> _timeline;
+
+        Options _options;
+        FrameCallback _callback;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _frameDecoded;
+        std::condition_variable _frameDelivered;
+
+        // Monotonically increasing sequence numbers (they keep growing while looping).
+        uint64_t _nextSequenceToDecode;
+        uint64_t _nextSequenceToDeliver;
+        std::map<uint64_t, DecodedFrame> _decodedFrames;
+
+        bool _stopRequested;
+        bool _running;
+
+        Statistics _statistics;
+
+        std::vector<std::thread> _decodingThreads;
+        std::thread _deliveryThread;
+    };
+}
@@ -0,0 +1,177 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <Io/MappedFile.h>
+#include <Playback/ImageFeatures.h>
+
+namespace HoloLensForCV
+{
+    //
+    // A sensor frame as stored in a recording. Matrices are kept in the row-major order
+    // used by the recorder's CSV files (m11, m12, ..., m44).
+    //
+    struct RecordedSensorFrame
+    {
+        RecordedSensorFrame();
+
+        // Index of the sensor in the SensorFramePlaybackEngine it was read by.
+        uint32_t SensorIndex;
+
+        std::string SensorName;
+
+        // Universal time, in 100ns ticks.
+        uint64_t Timestamp;
+
+        std::string ImageFileName;
+
+        std::array<float, 16> FrameToOrigin;
+        std::array<float, 16> CameraViewTransform;
+        std::array<float, 16> CameraProjectionTransform;
+
+        //
+        // The decoded bitmap: CV_16UC1 for 16-bit images (in host byte order, exactly as
+        // captured), CV_8UC1 for 8-bit images (the visible light cameras are stored four
+        // pixels per BGRA pixel, i.e. unpacked) and CV_8UC3 (BGR) for color images. Frames
+        // that were not read from a recording may also use CV_8UC4 (BGRA).
+        //
+        cv::Mat Image;
+
+        //
+        // The features recorded with the frame (see FeatureExtractionSink), if any.
+        //
+        ImageFeatures Features;
+    };
+
+    //
+    // Reads the frames recorded for one sensor: the '<sensor>.csv' file and either the
+    // '<sensor>.tar' archive written on device or the files extracted from it.
+    //
+    // This class does not depend on any Windows API so that it can be used off-device.
+    //
+    class SensorFrameRecordingReader
+    {
+    public:
+        struct FrameIndexEntry
+        {
+            uint64_t Timestamp;
+            std::string ImageFileName;
+
+            std::array<float, 16> FrameToOrigin;
+            std::array<float, 16> CameraViewTransform;
+            std::array<float, 16> CameraProjectionTransform;
+
+            // Location of the bitmap in the tar archive, if any.
+            uint64_t ArchiveOffset;
+            uint64_t ArchiveSize;
+
+            // Location of the features in the tar archive, if any.
+            uint64_t FeaturesArchiveOffset;
+            uint64_t FeaturesArchiveSize;
+        };
+
+        SensorFrameRecordingReader();
+
+        //
+        // Opens the recording for the given sensor in the given (extracted recording)
+        // folder. Returns false if no frames could be found.
+        //
+        bool Open(
+            _In_ const std::string& recordingFolder,
+            _In_ const std::string& sensorName);
+
+        const std::string& GetSensorName() const;
+
+        size_t GetNumberOfFrames() const;
+
+        const FrameIndexEntry& GetFrameIndexEntry(
+            _In_ size_t frameIndex) const;
+
+        //
+        // Opens a stream over the archive. Each reading thread needs its own stream.
+        // Returns an empty pointer if the frames are read from extracted files.
+        //
+        std::unique_ptr<std::istream> OpenArchive() const;
+
+        //
+        // Returns true if features were recorded with the frames.
+        //
+        bool HasFeatures() const;
+
+        //
+        // Reads and decodes one frame, and its features if any. The archive stream must
+        // have been obtained through OpenArchive (and can be null if the frames were
+        // extracted).
+        //
+        bool ReadFrame(
+            _In_ size_t frameIndex,
+            _Inout_opt_ std::istream* archive,
+            _Out_ RecordedSensorFrame& frame) const;
+
+        static bool DecodeNetpbm(
+            _In_reads_bytes_(dataSize) const uint8_t* data,
+            _In_ size_t dataSize,
+            _Out_ cv::Mat& image);
+
+        //
+        // The features of a frame are stored as '<timestamp>.orb', next to its image.
+        //
+        static std::string GetFeaturesFileName(
+            _In_ const std::string& imageFileName);
+
+    private:
+        bool ReadFrameIndex(
+            _In_ const std::string& csvFileName);
+
+        bool IndexArchive(
+            _In_ const std::string& archiveFileName);
+
+        //
+        // Reads a file from the archive if it is in there, or from the recording folder.
+        // The data is used in place when the archive or the file could be mapped, and is
+        // otherwise copied to the storage; it stays valid as long as both are.
+        //
+        bool ReadFileData(
+            _Inout_opt_ std::istream* archive,
+            _In_ uint64_t archiveOffset,
+            _In_ uint64_t archiveSize,
+            _In_ const std::string& fileName,
+            _Inout_ Io::MappedFile& fileMapping,
+            _Inout_ std::vector<uint8_t>& storage,
+            _Out_ Io::ByteSpan& data) const;
+
+    private:
+        std::string _recordingFolder;
+        std::string _sensorName;
+        std::string _archiveFileName;
+
+        //
+        // The whole archive, if it fits in the address space; the archive streams are only
+        // used otherwise.
+        //
+        Io::MappedFile _archiveMapping;
+
+        // Whether the extracted files include features.
+        bool _hasExtractedFeatures;
+
+        std::vector<FrameIndexEntry> _frameIndex;
+    };
+}
@@ -0,0 +1,101 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <Playback/SensorFrameRecordingReader.h>
+
+namespace HoloLensForCV
+{
+    //
+    // Resolution, pixel format and frame rate of a sensor stream. The image type follows
+    // the RecordedSensorFrame conventions (visible light camera images are unpacked).
+    //
+    struct SyntheticSensorProfile
+    {
+        std::string SensorName;
+
+        int32_t ImageWidth;
+        int32_t ImageHeight;
+        int32_t ImageType;
+
+        double FramesPerSecond;
+    };
+
+    //
+    // Produces frames that mimic the HoloLens sensor streams, without a device. Frames of
+    // all the added sensors are interleaved on their nominal schedules.
+    //
+    // The image content is cheap to generate but changes from frame to frame (a moving
+    // slanted plane for depth, moving gradients otherwise) so that downstream components
+    // cannot take shortcuts on constant input.
+    //
+    // This class does not depend on any Windows API.
+    //
+    class SyntheticSensorFrameGenerator
+    {
+    public:
+        SyntheticSensorFrameGenerator();
+
+        //
+        // Returns the profile of one of the recorder's sensor names ('pv', 'vlc_lf', ...).
+        //
+        static bool GetDefaultProfile(
+            _In_ const std::string& sensorName,
+            _Out_ SyntheticSensorProfile& profile);
+
+        static std::vector<std::string> GetDefaultSensorNames();
+
+        //
+        // Returns the sensor index reported with the sensor's frames.
+        //
+        uint32_t AddSensor(
+            _In_ const SyntheticSensorProfile& profile);
+
+        size_t GetNumberOfSensors() const;
+
+        const SyntheticSensorProfile& GetProfile(
+            _In_ uint32_t sensorIndex) const;
+
+        //
+        // Produces the next frame in timestamp order. The frame's image buffer is reused
+        // when it already has the right size and type.
+        //
+        void GetNextFrame(
+            _Inout_ RecordedSensorFrame& frame);
+
+        //
+        // Rewinds all the sensors to their first frame.
+        //
+        void Reset();
+
+    private:
+        void Render(
+            _In_ const SyntheticSensorProfile& profile,
+            _In_ uint64_t frameNumber,
+            _Inout_ cv::Mat& image) const;
+
+    private:
+        std::vector<SyntheticSensorProfile> _profiles;
+
+        // Per sensor: number of frames produced so far.
+        std::vector<uint64_t> _frameCounts;
+
+        // Universal time of the first frame, in 100ns ticks.
+        uint64_t _startTimestamp;
+    };
+}
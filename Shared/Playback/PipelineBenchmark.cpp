@@ -0,0 +1,432 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        void WriteJsonString(
+            _Inout_ std::ostream& stream,
+            _In_ const std::string& text)
+        {
+            stream << '"';
+
+            for (const char c : text)
+            {
+                switch (c)
+                {
+                case '"':
+                    stream << "\\\"";
+                    break;
+
+                case '\\':
+                    stream << "\\\\";
+                    break;
+
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char escaped[8] = {};
+
+                        snprintf(
+                            escaped,
+                            sizeof(escaped),
+                            "\\u%04x",
+                            c);
+
+                        stream << escaped;
+                    }
+                    else
+                    {
+                        stream << c;
+                    }
+                    break;
+                }
+            }
+
+            stream << '"';
+        }
+
+        void WriteJsonLatency(
+            _Inout_ std::ostream& stream,
+            _In_ const PipelineBenchmark::LatencyStatistics& latency)
+        {
+            stream
+                << "{\"p50_ms\":" << latency.P50InMilliseconds
+                << ",\"p99_ms\":" << latency.P99InMilliseconds
+                << ",\"max_ms\":" << latency.MaximumInMilliseconds
+                << ",\"mean_ms\":" << latency.MeanInMilliseconds
+                << "}";
+        }
+    }
+
+    PipelineBenchmark::Options::Options()
+        : DurationInSeconds(10.0)
+        , MaximumNumberOfFrames(0)
+        , NumberOfWarmupFrames(30)
+        , Paced(false)
+    {
+    }
+
+    PipelineBenchmark::LatencyStatistics::LatencyStatistics()
+        : P50InMilliseconds(0.0)
+        , P99InMilliseconds(0.0)
+        , MaximumInMilliseconds(0.0)
+        , MeanInMilliseconds(0.0)
+    {
+    }
+
+    PipelineBenchmark::Results::Results()
+        : NumberOfFrames(0)
+        , NumberOfBytes(0)
+        , ElapsedTimeInSeconds(0.0)
+        , FramesPerSecond(0.0)
+        , MegabytesPerSecond(0.0)
+        , CpuTimePerFrameInMilliseconds(0.0)
+        , AllocationsPerFrame(-1.0)
+    {
+    }
+
+    /* static */ PipelineBenchmark::Results PipelineBenchmark::Run(
+        _In_ const std::string& name,
+        _Inout_ SyntheticSensorFrameGenerator& generator,
+        _In_ const FrameConsumer& consumer,
+        _In_ const Options& options)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        REQUIRES(
+            generator.GetNumberOfSensors() > 0 &&
+            (options.DurationInSeconds > 0.0 || options.MaximumNumberOfFrames > 0));
+
+        RecordedSensorFrame frame;
+
+        generator.Reset();
+
+        for (uint32_t i = 0; i < options.NumberOfWarmupFrames; ++i)
+        {
+            generator.GetNextFrame(frame);
+
+            consumer(frame);
+        }
+
+        //
+        // Reserve storage for the measurements upfront so that the benchmark itself does
+        // not allocate while measuring.
+        //
+        const size_t numberOfSensors =
+            generator.GetNumberOfSensors();
+
+        std::vector<std::vector<double>> latencies(numberOfSensors);
+        std::vector<uint64_t> numberOfBytes(numberOfSensors, 0);
+
+        for (uint32_t i = 0; i < numberOfSensors; ++i)
+        {
+            const double expectedNumberOfFrames =
+                (options.MaximumNumberOfFrames > 0) ?
+                    static_cast<double>(options.MaximumNumberOfFrames) :
+                    options.DurationInSeconds * generator.GetProfile(i).FramesPerSecond;
+
+            latencies[i].reserve(
+                static_cast<size_t>(expectedNumberOfFrames * 1.1) + 16);
+        }
+
+        Results results;
+        results.Name = name;
+
+        const uint64_t allocationsBefore =
+            GetAllocationCounter().load();
+
+        const double cpuTimeBefore =
+            GetProcessCpuTimeInSeconds();
+
+        const Clock::time_point startTime =
+            Clock::now();
+
+        uint64_t firstTimestamp = 0;
+
+        while (0 == options.MaximumNumberOfFrames ||
+               results.NumberOfFrames < options.MaximumNumberOfFrames)
+        {
+            generator.GetNextFrame(frame);
+
+            if (0 == results.NumberOfFrames)
+            {
+                firstTimestamp = frame.Timestamp;
+            }
+
+            const double frameTimeInSeconds =
+                (frame.Timestamp - firstTimestamp) * 1e-7;
+
+            if (options.DurationInSeconds > 0.0 &&
+                frameTimeInSeconds >= options.DurationInSeconds)
+            {
+                break;
+            }
+
+            Clock::time_point frameStartTime;
+
+            if (options.Paced)
+            {
+                frameStartTime =
+                    startTime + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(frameTimeInSeconds));
+
+                std::this_thread::sleep_until(
+                    frameStartTime);
+            }
+            else
+            {
+                frameStartTime = Clock::now();
+            }
+
+            consumer(frame);
+
+            const double latencyInMilliseconds =
+                std::chrono::duration<double, std::milli>(
+                    Clock::now() - frameStartTime).count();
+
+            latencies[frame.SensorIndex].push_back(
+                latencyInMilliseconds);
+
+            const uint64_t frameSize =
+                frame.Image.total() * frame.Image.elemSize();
+
+            numberOfBytes[frame.SensorIndex] += frameSize;
+
+            ++results.NumberOfFrames;
+            results.NumberOfBytes += frameSize;
+        }
+
+        results.ElapsedTimeInSeconds =
+            std::chrono::duration<double>(
+                Clock::now() - startTime).count();
+
+        const double cpuTime =
+            GetProcessCpuTimeInSeconds() - cpuTimeBefore;
+
+        const uint64_t allocationsAfter =
+            GetAllocationCounter().load();
+
+        //
+        // Summarize.
+        //
+        if (results.ElapsedTimeInSeconds > 0.0)
+        {
+            results.FramesPerSecond =
+                results.NumberOfFrames / results.ElapsedTimeInSeconds;
+
+            results.MegabytesPerSecond =
+                results.NumberOfBytes / (1024.0 * 1024.0) / results.ElapsedTimeInSeconds;
+        }
+
+        if (results.NumberOfFrames > 0)
+        {
+            results.CpuTimePerFrameInMilliseconds =
+                cpuTime * 1000.0 / results.NumberOfFrames;
+
+            if (0 != allocationsAfter)
+            {
+                results.AllocationsPerFrame =
+                    static_cast<double>(allocationsAfter - allocationsBefore) / results.NumberOfFrames;
+            }
+        }
+
+        std::vector<double> allLatencies;
+
+        allLatencies.reserve(
+            static_cast<size_t>(results.NumberOfFrames));
+
+        for (uint32_t i = 0; i < numberOfSensors; ++i)
+        {
+            allLatencies.insert(
+                allLatencies.end(),
+                latencies[i].begin(),
+                latencies[i].end());
+
+            SensorResults sensorResults;
+
+            sensorResults.SensorName = generator.GetProfile(i).SensorName;
+            sensorResults.NumberOfFrames = latencies[i].size();
+            sensorResults.NumberOfBytes = numberOfBytes[i];
+            sensorResults.Latency = ComputeLatencyStatistics(latencies[i]);
+
+            results.Sensors.push_back(
+                sensorResults);
+        }
+
+        results.Latency =
+            ComputeLatencyStatistics(allLatencies);
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "PipelineBenchmark",
+            dbg::LogLevel::Information,
+            L"PipelineBenchmark::Run: %S: %llu frames, %.1f fps, %.1f MB/s, p50 %.3f ms, p99 %.3f ms, %.3f ms CPU/frame",
+            name.c_str(),
+            results.NumberOfFrames,
+            results.FramesPerSecond,
+            results.MegabytesPerSecond,
+            results.Latency.P50InMilliseconds,
+            results.Latency.P99InMilliseconds,
+            results.CpuTimePerFrameInMilliseconds);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return results;
+    }
+
+    /* static */ std::string PipelineBenchmark::ToJson(
+        _In_ const std::vector<Results>& results)
+    {
+        std::ostringstream stream;
+
+        stream.imbue(std::locale::classic());
+        stream.precision(9);
+
+        stream << "{\"benchmarks\":[";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Results& result = results[i];
+
+            if (i > 0)
+            {
+                stream << ",";
+            }
+
+            stream << "{\"name\":";
+            WriteJsonString(stream, result.Name);
+
+            stream
+                << ",\"frames\":" << result.NumberOfFrames
+                << ",\"bytes\":" << result.NumberOfBytes
+                << ",\"elapsed_s\":" << result.ElapsedTimeInSeconds
+                << ",\"frames_per_second\":" << result.FramesPerSecond
+                << ",\"megabytes_per_second\":" << result.MegabytesPerSecond
+                << ",\"cpu_ms_per_frame\":" << result.CpuTimePerFrameInMilliseconds
+                << ",\"allocations_per_frame\":";
+
+            if (result.AllocationsPerFrame < 0.0)
+            {
+                stream << "null";
+            }
+            else
+            {
+                stream << result.AllocationsPerFrame;
+            }
+
+            stream << ",\"latency\":";
+            WriteJsonLatency(stream, result.Latency);
+
+            stream << ",\"sensors\":[";
+
+            for (size_t j = 0; j < result.Sensors.size(); ++j)
+            {
+                const SensorResults& sensorResults = result.Sensors[j];
+
+                if (j > 0)
+                {
+                    stream << ",";
+                }
+
+                stream << "{\"name\":";
+                WriteJsonString(stream, sensorResults.SensorName);
+
+                stream
+                    << ",\"frames\":" << sensorResults.NumberOfFrames
+                    << ",\"bytes\":" << sensorResults.NumberOfBytes
+                    << ",\"latency\":";
+
+                WriteJsonLatency(stream, sensorResults.Latency);
+
+                stream << "}";
+            }
+
+            stream << "]}";
+        }
+
+        stream << "]}";
+
+        return stream.str();
+    }
+
+    /* static */ double PipelineBenchmark::GetProcessCpuTimeInSeconds()
+    {
+#if defined(_WIN32)
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+
+        if (!GetProcessTimes(
+            GetCurrentProcess(),
+            &creationTime,
+            &exitTime,
+            &kernelTime,
+            &userTime))
+        {
+            return 0.0;
+        }
+
+        const auto toSeconds = [](const FILETIME& fileTime)
+        {
+            return
+                ((static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime) * 1e-7;
+        };
+
+        return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+        rusage usage = {};
+
+        if (0 != getrusage(RUSAGE_SELF, &usage))
+        {
+            return 0.0;
+        }
+
+        return
+            usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+            usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+    }
+
+    /* static */ PipelineBenchmark::LatencyStatistics PipelineBenchmark::ComputeLatencyStatistics(
+        _Inout_ std::vector<double>& latenciesInMilliseconds)
+    {
+        LatencyStatistics statistics;
+
+        if (latenciesInMilliseconds.empty())
+        {
+            return statistics;
+        }
+
+        std::sort(
+            latenciesInMilliseconds.begin(),
+            latenciesInMilliseconds.end());
+
+        const size_t n =
+            latenciesInMilliseconds.size();
+
+        statistics.P50InMilliseconds = latenciesInMilliseconds[(n - 1) / 2];
+        statistics.P99InMilliseconds = latenciesInMilliseconds[(n - 1) * 99 / 100];
+        statistics.MaximumInMilliseconds = latenciesInMilliseconds.back();
+
+        statistics.MeanInMilliseconds =
+            std::accumulate(
+                latenciesInMilliseconds.begin(),
+                latenciesInMilliseconds.end(),
+                0.0) / n;
+
+        return statistics;
+    }
+}
@@ -0,0 +1,421 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    SensorFramePlaybackEngine::Options::Options()
+        : PlaybackSpeed(1.0)
+        , PrefetchDepth(8)
+        , NumberOfDecodingThreads(2)
+        , Loop(false)
+    {
+    }
+
+    SensorFramePlaybackEngine::Statistics::Statistics()
+        : FramesDelivered(0)
+        , FramesDropped(0)
+        , FramesDeliveredLate(0)
+        , MaximumLatenessInMilliseconds(0.0)
+        , DecodingStallsInMilliseconds(0.0)
+        , ElapsedTimeInMilliseconds(0.0)
+    {
+    }
+
+    SensorFramePlaybackEngine::SensorFramePlaybackEngine()
+        : _nextSequenceToDecode(0)
+        , _nextSequenceToDeliver(0)
+        , _stopRequested(false)
+        , _running(false)
+    {
+    }
+
+    SensorFramePlaybackEngine::~SensorFramePlaybackEngine()
+    {
+        Stop();
+    }
+
+    int32_t SensorFramePlaybackEngine::AddSensor(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName)
+    {
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        REQUIRES(!_running);
+
+        std::unique_ptr<SensorFrameRecordingReader> reader(
+            new SensorFrameRecordingReader());
+
+        if (!reader->Open(recordingFolder, sensorName))
+        {
+            return -1;
+        }
+
+        const uint32_t sensorIndex =
+            static_cast<uint32_t>(_readers.size());
+
+        for (size_t frameIndex = 0; frameIndex < reader->GetNumberOfFrames(); ++frameIndex)
+        {
+            TimelineEntry entry;
+
+            entry.Timestamp = reader->GetFrameIndexEntry(frameIndex).Timestamp;
+            entry.SensorIndex = sensorIndex;
+            entry.FrameIndex = static_cast<uint32_t>(frameIndex);
+
+            _timeline.push_back(entry);
+        }
+
+        std::stable_sort(
+            _timeline.begin(),
+            _timeline.end(),
+            [](const TimelineEntry& a, const TimelineEntry& b)
+        {
+            return a.Timestamp < b.Timestamp;
+        });
+
+        _readers.push_back(
+            std::move(reader));
+
+        return static_cast<int32_t>(sensorIndex);
+    }
+
+    size_t SensorFramePlaybackEngine::GetNumberOfSensors() const
+    {
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        return _readers.size();
+    }
+
+    size_t SensorFramePlaybackEngine::GetNumberOfFrames() const
+    {
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        return _timeline.size();
+    }
+
+    void SensorFramePlaybackEngine::Start(
+        _In_ const Options& options,
+        _In_ const FrameCallback& callback)
+    {
+        Stop();
+
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        REQUIRES(
+            !_timeline.empty() &&
+            options.PrefetchDepth > 0 &&
+            options.NumberOfDecodingThreads > 0);
+
+        _options = options;
+        _callback = callback;
+
+        _nextSequenceToDecode = 0;
+        _nextSequenceToDeliver = 0;
+        _decodedFrames.clear();
+
+        _stopRequested = false;
+        _running = true;
+
+        _statistics = Statistics();
+
+        for (uint32_t i = 0; i < _options.NumberOfDecodingThreads; ++i)
+        {
+            _decodingThreads.emplace_back(
+                &SensorFramePlaybackEngine::DecodingThread,
+                this);
+        }
+
+        _deliveryThread = std::thread(
+            &SensorFramePlaybackEngine::DeliveryThread,
+            this);
+    }
+
+    void SensorFramePlaybackEngine::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lockGuard(
+                _mutex);
+
+            _stopRequested = true;
+        }
+
+        _frameDecoded.notify_all();
+        _frameDelivered.notify_all();
+
+        for (std::thread& decodingThread : _decodingThreads)
+        {
+            decodingThread.join();
+        }
+
+        _decodingThreads.clear();
+
+        if (_deliveryThread.joinable())
+        {
+            _deliveryThread.join();
+        }
+
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        _decodedFrames.clear();
+        _running = false;
+    }
+
+    void SensorFramePlaybackEngine::WaitForCompletion()
+    {
+        std::unique_lock<std::mutex> lock(
+            _mutex);
+
+        _frameDelivered.wait(
+            lock,
+            [this]()
+        {
+            return !_running;
+        });
+    }
+
+    bool SensorFramePlaybackEngine::IsRunning() const
+    {
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        return _running;
+    }
+
+    SensorFramePlaybackEngine::Statistics SensorFramePlaybackEngine::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lockGuard(
+            _mutex);
+
+        return _statistics;
+    }
+
+    void SensorFramePlaybackEngine::DecodingThread()
+    {
+        //
+        // Each decoding thread reads the archives through its own streams.
+        //
+        std::vector<std::unique_ptr<std::istream>> archives(
+            _readers.size());
+
+        for (size_t i = 0; i < _readers.size(); ++i)
+        {
+            archives[i] = _readers[i]->OpenArchive();
+        }
+
+        const uint64_t numberOfFrames =
+            _timeline.size();
+
+        while (true)
+        {
+            uint64_t sequence;
+
+            {
+                std::unique_lock<std::mutex> lock(
+                    _mutex);
+
+                _frameDelivered.wait(
+                    lock,
+                    [this]()
+                {
+                    return
+                        _stopRequested ||
+                        _nextSequenceToDecode < _nextSequenceToDeliver + _options.PrefetchDepth;
+                });
+
+                if (_stopRequested ||
+                    (!_options.Loop && _nextSequenceToDecode >= numberOfFrames))
+                {
+                    return;
+                }
+
+                sequence = _nextSequenceToDecode++;
+            }
+
+            const TimelineEntry& entry =
+                _timeline[sequence % numberOfFrames];
+
+            DecodedFrame decodedFrame;
+
+            decodedFrame.Valid =
+                _readers[entry.SensorIndex]->ReadFrame(
+                    entry.FrameIndex,
+                    archives[entry.SensorIndex].get(),
+                    decodedFrame.Frame);
+
+            decodedFrame.Frame.SensorIndex =
+                entry.SensorIndex;
+
+            {
+                std::lock_guard<std::mutex> lockGuard(
+                    _mutex);
+
+                _decodedFrames[sequence] =
+                    std::move(decodedFrame);
+            }
+
+            _frameDecoded.notify_all();
+        }
+    }
+
+    void SensorFramePlaybackEngine::DeliveryThread()
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const uint64_t numberOfFrames =
+            _timeline.size();
+
+        const Clock::time_point playbackStartTime =
+            Clock::now();
+
+        Clock::time_point loopStartTime =
+            playbackStartTime;
+
+        while (true)
+        {
+            DecodedFrame decodedFrame;
+            uint64_t sequence;
+
+            {
+                std::unique_lock<std::mutex> lock(
+                    _mutex);
+
+                sequence = _nextSequenceToDeliver;
+
+                if (!_options.Loop && sequence >= numberOfFrames)
+                {
+                    break;
+                }
+
+                const Clock::time_point stallStartTime =
+                    Clock::now();
+
+                _frameDecoded.wait(
+                    lock,
+                    [this, sequence]()
+                {
+                    return
+                        _stopRequested ||
+                        _decodedFrames.end() != _decodedFrames.find(sequence);
+                });
+
+                if (_stopRequested)
+                {
+                    break;
+                }
+
+                _statistics.DecodingStallsInMilliseconds +=
+                    std::chrono::duration<double, std::milli>(
+                        Clock::now() - stallStartTime).count();
+
+                auto decodedFrameIterator =
+                    _decodedFrames.find(sequence);
+
+                decodedFrame = std::move(
+                    decodedFrameIterator->second);
+
+                _decodedFrames.erase(
+                    decodedFrameIterator);
+
+                ++_nextSequenceToDeliver;
+            }
+
+            _frameDelivered.notify_all();
+
+            //
+            // Wait for the frame's scheduled time. The schedule restarts with each loop.
+            //
+            const uint64_t frameIndex =
+                sequence % numberOfFrames;
+
+            if (0 == frameIndex)
+            {
+                loopStartTime = Clock::now();
+            }
+
+            double latenessInMilliseconds = 0.0;
+
+            if (_options.PlaybackSpeed > 0.0)
+            {
+                const double offsetInSeconds =
+                    (_timeline[frameIndex].Timestamp - _timeline[0].Timestamp) * 1e-7 / _options.PlaybackSpeed;
+
+                const Clock::time_point scheduledTime =
+                    loopStartTime + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(offsetInSeconds));
+
+                std::this_thread::sleep_until(
+                    scheduledTime);
+
+                latenessInMilliseconds =
+                    std::chrono::duration<double, std::milli>(
+                        Clock::now() - scheduledTime).count();
+            }
+
+            if (decodedFrame.Valid)
+            {
+                _callback(
+                    decodedFrame.Frame);
+            }
+
+            {
+                std::lock_guard<std::mutex> lockGuard(
+                    _mutex);
+
+                if (decodedFrame.Valid)
+                {
+                    ++_statistics.FramesDelivered;
+                }
+                else
+                {
+                    ++_statistics.FramesDropped;
+                }
+
+                if (latenessInMilliseconds > 1.0)
+                {
+                    ++_statistics.FramesDeliveredLate;
+                }
+
+                _statistics.MaximumLatenessInMilliseconds =
+                    std::max(_statistics.MaximumLatenessInMilliseconds, latenessInMilliseconds);
+
+                _statistics.ElapsedTimeInMilliseconds =
+                    std::chrono::duration<double, std::milli>(
+                        Clock::now() - playbackStartTime).count();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lockGuard(
+                _mutex);
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+            DBG_LOG(
+                "SensorFramePlaybackEngine",
+                dbg::LogLevel::Information,
+                L"SensorFramePlaybackEngine::DeliveryThread: delivered %llu frames (%llu dropped, %llu late) in %.1f ms",
+                _statistics.FramesDelivered,
+                _statistics.FramesDropped,
+                _statistics.FramesDeliveredLate,
+                _statistics.ElapsedTimeInMilliseconds);
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+            _running = false;
+        }
+
+        _frameDelivered.notify_all();
+    }
+}
@@ -0,0 +1,531 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        std::string JoinPath(
+            _In_ const std::string& folder,
+            _In_ const std::string& fileName)
+        {
+            std::string path = folder;
+
+            if (!path.empty() && '/' != path.back() && '\\' != path.back())
+            {
+                path.push_back('/');
+            }
+
+            for (const char c : fileName)
+            {
+                path.push_back('\\' == c ? '/' : c);
+            }
+
+            return path;
+        }
+
+        bool ReadFloatMatrix(
+            _Inout_ Io::StringTokenizer& row,
+            _Out_ std::array<float, 16>& matrix)
+        {
+            std::string_view cell;
+
+            for (float& value : matrix)
+            {
+                if (!row.Next(cell) ||
+                    !Io::ParseNumber(Io::TrimString(cell), value))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        //
+        // Skips whitespace and comments, then parses a decimal number from a Netpbm header.
+        //
+        bool ReadNetpbmHeaderValue(
+            _In_reads_bytes_(dataSize) const uint8_t* data,
+            _In_ size_t dataSize,
+            _Inout_ size_t* position,
+            _Out_ uint32_t* value)
+        {
+            size_t i = *position;
+
+            while (i < dataSize)
+            {
+                if ('#' == data[i])
+                {
+                    while (i < dataSize && '\n' != data[i])
+                    {
+                        ++i;
+                    }
+                }
+                else if (isspace(data[i]))
+                {
+                    ++i;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            if (i >= dataSize || !isdigit(data[i]))
+            {
+                return false;
+            }
+
+            *value = 0;
+
+            while (i < dataSize && isdigit(data[i]))
+            {
+                *value = *value * 10 + (data[i] - '0');
+                ++i;
+            }
+
+            *position = i;
+
+            return true;
+        }
+    }
+
+    RecordedSensorFrame::RecordedSensorFrame()
+        : SensorIndex(0)
+        , Timestamp(0)
+        , FrameToOrigin()
+        , CameraViewTransform()
+        , CameraProjectionTransform()
+    {
+    }
+
+    SensorFrameRecordingReader::SensorFrameRecordingReader()
+        : _hasExtractedFeatures(false)
+    {
+    }
+
+    bool SensorFrameRecordingReader::Open(
+        _In_ const std::string& recordingFolder,
+        _In_ const std::string& sensorName)
+    {
+        _recordingFolder = recordingFolder;
+        _sensorName = sensorName;
+        _archiveFileName.clear();
+        _hasExtractedFeatures = false;
+        _frameIndex.clear();
+
+        if (!ReadFrameIndex(JoinPath(recordingFolder, sensorName + ".csv")))
+        {
+            return false;
+        }
+
+        //
+        // Prefer the archive written on device; fall back on extracted files otherwise.
+        //
+        const std::string archiveFileName =
+            JoinPath(recordingFolder, sensorName + ".tar");
+
+        if (std::ifstream(archiveFileName, std::ios::binary) &&
+            IndexArchive(archiveFileName))
+        {
+            _archiveFileName = archiveFileName;
+
+            _archiveMapping.Open(
+                archiveFileName);
+        }
+        else if (!_frameIndex.empty())
+        {
+            //
+            // Recordings carry features for all of their frames or for none.
+            //
+            _hasExtractedFeatures =
+                !!std::ifstream(
+                    JoinPath(recordingFolder, GetFeaturesFileName(_frameIndex.front().ImageFileName)),
+                    std::ios::binary);
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "SensorFrameRecordingReader",
+            dbg::LogLevel::Information,
+            L"SensorFrameRecordingReader::Open: found %zu frames for sensor %S (%s)",
+            _frameIndex.size(),
+            sensorName.c_str(),
+            _archiveFileName.empty() ? L"extracted files" : L"archive");
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return !_frameIndex.empty();
+    }
+
+    const std::string& SensorFrameRecordingReader::GetSensorName() const
+    {
+        return _sensorName;
+    }
+
+    size_t SensorFrameRecordingReader::GetNumberOfFrames() const
+    {
+        return _frameIndex.size();
+    }
+
+    const SensorFrameRecordingReader::FrameIndexEntry& SensorFrameRecordingReader::GetFrameIndexEntry(
+        _In_ size_t frameIndex) const
+    {
+        REQUIRES(frameIndex < _frameIndex.size());
+
+        return _frameIndex[frameIndex];
+    }
+
+    std::unique_ptr<std::istream> SensorFrameRecordingReader::OpenArchive() const
+    {
+        if (_archiveFileName.empty())
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<std::istream> archive(
+            new std::ifstream(
+                _archiveFileName,
+                std::ios::in | std::ios::binary));
+
+        ASSERT(!!*archive);
+
+        return archive;
+    }
+
+    bool SensorFrameRecordingReader::ReadFrame(
+        _In_ size_t frameIndex,
+        _Inout_opt_ std::istream* archive,
+        _Out_ RecordedSensorFrame& frame) const
+    {
+        const FrameIndexEntry& entry =
+            GetFrameIndexEntry(frameIndex);
+
+        frame.SensorName = _sensorName;
+        frame.Timestamp = entry.Timestamp;
+        frame.ImageFileName = entry.ImageFileName;
+        frame.FrameToOrigin = entry.FrameToOrigin;
+        frame.CameraViewTransform = entry.CameraViewTransform;
+        frame.CameraProjectionTransform = entry.CameraProjectionTransform;
+
+        Io::MappedFile fileMapping;
+        std::vector<uint8_t> storage;
+        Io::ByteSpan data;
+
+        if (!ReadFileData(archive, entry.ArchiveOffset, entry.ArchiveSize, entry.ImageFileName, fileMapping, storage, data))
+        {
+            return false;
+        }
+
+        //
+        // Features are optional: frames whose features cannot be read have none.
+        //
+        frame.Features.Keypoints.clear();
+        frame.Features.Descriptors.release();
+
+        if ((nullptr != archive) ? (0 != entry.FeaturesArchiveSize) : _hasExtractedFeatures)
+        {
+            Io::MappedFile featuresFileMapping;
+            std::vector<uint8_t> featuresStorage;
+            Io::ByteSpan featuresData;
+
+            if (ReadFileData(archive, entry.FeaturesArchiveOffset, entry.FeaturesArchiveSize, GetFeaturesFileName(entry.ImageFileName), featuresFileMapping, featuresStorage, featuresData))
+            {
+                DeserializeImageFeatures(
+                    featuresData.Data,
+                    featuresData.Size,
+                    frame.Features);
+            }
+        }
+
+        return DecodeNetpbm(
+            data.Data,
+            data.Size,
+            frame.Image);
+    }
+
+    bool SensorFrameRecordingReader::HasFeatures() const
+    {
+        if (_hasExtractedFeatures)
+        {
+            return true;
+        }
+
+        for (const FrameIndexEntry& entry : _frameIndex)
+        {
+            if (0 != entry.FeaturesArchiveSize)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /* static */ std::string SensorFrameRecordingReader::GetFeaturesFileName(
+        _In_ const std::string& imageFileName)
+    {
+        const size_t extension =
+            imageFileName.find_last_of('.');
+
+        return imageFileName.substr(0, extension) + ".orb";
+    }
+
+    bool SensorFrameRecordingReader::ReadFileData(
+        _Inout_opt_ std::istream* archive,
+        _In_ uint64_t archiveOffset,
+        _In_ uint64_t archiveSize,
+        _In_ const std::string& fileName,
+        _Inout_ Io::MappedFile& fileMapping,
+        _Inout_ std::vector<uint8_t>& storage,
+        _Out_ Io::ByteSpan& data) const
+    {
+        data = Io::ByteSpan();
+
+        if (0 != archiveSize && _archiveMapping.IsOpen())
+        {
+            data =
+                _archiveMapping.GetSpan().Subspan(
+                    static_cast<size_t>(archiveOffset),
+                    static_cast<size_t>(archiveSize));
+
+            return data.Size == archiveSize;
+        }
+
+        if (nullptr != archive && 0 != archiveSize)
+        {
+            storage.resize(static_cast<size_t>(archiveSize));
+
+            archive->clear();
+            archive->seekg(archiveOffset);
+            archive->read(
+                reinterpret_cast<char*>(storage.data()),
+                storage.size());
+
+            data = Io::ByteSpan(
+                storage.data(),
+                storage.size());
+
+            return !!*archive;
+        }
+
+        if (!fileMapping.Open(JoinPath(_recordingFolder, fileName)))
+        {
+            return false;
+        }
+
+        data =
+            fileMapping.GetSpan();
+
+        return true;
+    }
+
+    /* static */ bool SensorFrameRecordingReader::DecodeNetpbm(
+        _In_reads_bytes_(dataSize) const uint8_t* data,
+        _In_ size_t dataSize,
+        _Out_ cv::Mat& image)
+    {
+        if (dataSize < 2 || 'P' != data[0] || ('5' != data[1] && '6' != data[1]))
+        {
+            return false;
+        }
+
+        const bool isColor =
+            '6' == data[1];
+
+        size_t position = 2;
+        uint32_t width = 0, height = 0, maximumValue = 0;
+
+        if (!ReadNetpbmHeaderValue(data, dataSize, &position, &width) ||
+            !ReadNetpbmHeaderValue(data, dataSize, &position, &height) ||
+            !ReadNetpbmHeaderValue(data, dataSize, &position, &maximumValue) ||
+            position >= dataSize)
+        {
+            return false;
+        }
+
+        //
+        // A single whitespace character separates the header from the pixel data.
+        //
+        ++position;
+
+        const int depth =
+            maximumValue > 255 ? CV_16U : CV_8U;
+
+        const int channels =
+            isColor ? 3 : 1;
+
+        const size_t expectedSize =
+            static_cast<size_t>(width) * height * channels * CV_ELEM_SIZE1(depth);
+
+        if (dataSize - position < expectedSize)
+        {
+            return false;
+        }
+
+        //
+        // The recorder stores the pixels exactly as they are laid out in memory (which,
+        // unlike what the Netpbm format specifies, means little-endian for 16-bit images).
+        //
+        const cv::Mat wrapped(
+            static_cast<int>(height),
+            static_cast<int>(width),
+            CV_MAKETYPE(depth, channels),
+            const_cast<uint8_t*>(data + position));
+
+        if (isColor)
+        {
+            cv::cvtColor(
+                wrapped,
+                image,
+                cv::COLOR_RGB2BGR);
+        }
+        else
+        {
+            wrapped.copyTo(
+                image);
+        }
+
+        return true;
+    }
+
+    bool SensorFrameRecordingReader::ReadFrameIndex(
+        _In_ const std::string& csvFileName)
+    {
+        //
+        // The rows are parsed in place, without copying lines or cells.
+        //
+        Io::MappedFile csvFile;
+
+        if (!csvFile.Open(csvFileName))
+        {
+            return false;
+        }
+
+        const Io::ByteSpan csvData =
+            csvFile.GetSpan();
+
+        Io::StringTokenizer lines(
+            std::string_view(reinterpret_cast<const char*>(csvData.Data), csvData.Size),
+            "\r\n");
+
+        std::string_view line;
+
+        //
+        // Skip the header.
+        //
+        if (!lines.Next(line))
+        {
+            return false;
+        }
+
+        while (lines.Next(line))
+        {
+            Io::StringTokenizer row(
+                line,
+                ",",
+                false /* skipEmptyTokens */);
+
+            std::string_view cell;
+
+            FrameIndexEntry entry = {};
+
+            std::string_view imageFileName;
+
+            if (!row.Next(cell) ||
+                !Io::ParseNumber(Io::TrimString(cell), entry.Timestamp) ||
+                !row.Next(imageFileName) ||
+                !ReadFloatMatrix(row, entry.FrameToOrigin) ||
+                !ReadFloatMatrix(row, entry.CameraViewTransform) ||
+                !ReadFloatMatrix(row, entry.CameraProjectionTransform))
+            {
+#if DBG_ENABLE_ERROR_LOGGING
+                DBG_LOG(
+                    "SensorFrameRecordingReader",
+                    dbg::LogLevel::Error,
+                    L"SensorFrameRecordingReader::ReadFrameIndex: skipping malformed row in %S",
+                    csvFileName.c_str());
+#endif /* DBG_ENABLE_ERROR_LOGGING */
+
+                continue;
+            }
+
+            entry.ImageFileName = imageFileName;
+
+            _frameIndex.push_back(
+                std::move(entry));
+        }
+
+        std::stable_sort(
+            _frameIndex.begin(),
+            _frameIndex.end(),
+            [](const FrameIndexEntry& a, const FrameIndexEntry& b)
+        {
+            return a.Timestamp < b.Timestamp;
+        });
+
+        return true;
+    }
+
+    bool SensorFrameRecordingReader::IndexArchive(
+        _In_ const std::string& archiveFileName)
+    {
+        std::ifstream archive(
+            archiveFileName,
+            std::ios::in | std::ios::binary);
+
+        std::vector<Io::TarArchiveEntry> entries;
+
+        if (!Io::ReadTarArchiveIndex(archive, entries))
+        {
+            return false;
+        }
+
+        std::map<std::string, std::pair<uint64_t, uint64_t>> archiveEntries;
+
+        for (const Io::TarArchiveEntry& entry : entries)
+        {
+            archiveEntries[entry.FileName] =
+                std::make_pair(entry.Offset, entry.Size);
+        }
+
+        size_t numberOfFramesFound = 0;
+
+        for (FrameIndexEntry& entry : _frameIndex)
+        {
+            const auto archiveEntry =
+                archiveEntries.find(entry.ImageFileName);
+
+            if (archiveEntries.end() == archiveEntry)
+            {
+                continue;
+            }
+
+            entry.ArchiveOffset = archiveEntry->second.first;
+            entry.ArchiveSize = archiveEntry->second.second;
+
+            const auto featuresArchiveEntry =
+                archiveEntries.find(GetFeaturesFileName(entry.ImageFileName));
+
+            if (archiveEntries.end() != featuresArchiveEntry)
+            {
+                entry.FeaturesArchiveOffset = featuresArchiveEntry->second.first;
+                entry.FeaturesArchiveSize = featuresArchiveEntry->second.second;
+            }
+
+            ++numberOfFramesFound;
+        }
+
+        return numberOfFramesFound > 0;
+    }
+}
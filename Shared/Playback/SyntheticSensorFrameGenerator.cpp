@@ -0,0 +1,258 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace HoloLensForCV
+{
+    namespace
+    {
+        const double c_ticksPerSecond = 1e7;
+
+        //
+        // Universal time (100ns ticks since 1601) of 2018-01-01, used as the timestamp
+        // of the first synthetic frame.
+        //
+        const uint64_t c_defaultStartTimestamp = 131592384000000000ull;
+
+        void SetIdentity(
+            _Out_ std::array<float, 16>& matrix)
+        {
+            matrix.fill(0.0f);
+
+            matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0f;
+        }
+    }
+
+    SyntheticSensorFrameGenerator::SyntheticSensorFrameGenerator()
+        : _startTimestamp(c_defaultStartTimestamp)
+    {
+    }
+
+    /* static */ bool SyntheticSensorFrameGenerator::GetDefaultProfile(
+        _In_ const std::string& sensorName,
+        _Out_ SyntheticSensorProfile& profile)
+    {
+        profile.SensorName = sensorName;
+
+        if ("pv" == sensorName)
+        {
+            profile.ImageWidth = 1280;
+            profile.ImageHeight = 720;
+            profile.ImageType = CV_8UC4;
+            profile.FramesPerSecond = 30.0;
+        }
+        else if ("short_throw_depth" == sensorName || "short_throw_reflectivity" == sensorName)
+        {
+            profile.ImageWidth = 512;
+            profile.ImageHeight = 512;
+            profile.ImageType = ("short_throw_depth" == sensorName) ? CV_16UC1 : CV_8UC1;
+            profile.FramesPerSecond = 45.0;
+        }
+        else if ("long_throw_depth" == sensorName || "long_throw_reflectivity" == sensorName)
+        {
+            profile.ImageWidth = 448;
+            profile.ImageHeight = 450;
+            profile.ImageType = ("long_throw_depth" == sensorName) ? CV_16UC1 : CV_8UC1;
+            profile.FramesPerSecond = 5.0;
+        }
+        else if ("vlc_ll" == sensorName || "vlc_lf" == sensorName ||
+                 "vlc_rf" == sensorName || "vlc_rr" == sensorName)
+        {
+            profile.ImageWidth = 640;
+            profile.ImageHeight = 480;
+            profile.ImageType = CV_8UC1;
+            profile.FramesPerSecond = 30.0;
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    /* static */ std::vector<std::string> SyntheticSensorFrameGenerator::GetDefaultSensorNames()
+    {
+        return
+        {
+            "pv",
+            "short_throw_depth",
+            "short_throw_reflectivity",
+            "long_throw_depth",
+            "long_throw_reflectivity",
+            "vlc_ll",
+            "vlc_lf",
+            "vlc_rf",
+            "vlc_rr"
+        };
+    }
+
+    uint32_t SyntheticSensorFrameGenerator::AddSensor(
+        _In_ const SyntheticSensorProfile& profile)
+    {
+        REQUIRES(
+            profile.ImageWidth > 0 &&
+            profile.ImageHeight > 0 &&
+            profile.FramesPerSecond > 0.0);
+
+        _profiles.push_back(profile);
+        _frameCounts.push_back(0);
+
+        return static_cast<uint32_t>(_profiles.size() - 1);
+    }
+
+    size_t SyntheticSensorFrameGenerator::GetNumberOfSensors() const
+    {
+        return _profiles.size();
+    }
+
+    const SyntheticSensorProfile& SyntheticSensorFrameGenerator::GetProfile(
+        _In_ uint32_t sensorIndex) const
+    {
+        REQUIRES(sensorIndex < _profiles.size());
+
+        return _profiles[sensorIndex];
+    }
+
+    void SyntheticSensorFrameGenerator::GetNextFrame(
+        _Inout_ RecordedSensorFrame& frame)
+    {
+        REQUIRES(!_profiles.empty());
+
+        //
+        // Pick the sensor whose next frame is due first.
+        //
+        uint32_t sensorIndex = 0;
+        uint64_t timestamp = std::numeric_limits<uint64_t>::max();
+
+        for (uint32_t i = 0; i < _profiles.size(); ++i)
+        {
+            const uint64_t nextTimestamp =
+                _startTimestamp + static_cast<uint64_t>(
+                    _frameCounts[i] * c_ticksPerSecond / _profiles[i].FramesPerSecond + 0.5);
+
+            if (nextTimestamp < timestamp)
+            {
+                timestamp = nextTimestamp;
+                sensorIndex = i;
+            }
+        }
+
+        const SyntheticSensorProfile& profile =
+            _profiles[sensorIndex];
+
+        const uint64_t frameNumber =
+            _frameCounts[sensorIndex]++;
+
+        frame.SensorIndex = sensorIndex;
+        frame.SensorName = profile.SensorName;
+        frame.Timestamp = timestamp;
+        frame.ImageFileName.clear();
+
+        //
+        // The device slowly moves along the X axis.
+        //
+        SetIdentity(frame.FrameToOrigin);
+        SetIdentity(frame.CameraViewTransform);
+        SetIdentity(frame.CameraProjectionTransform);
+
+        frame.FrameToOrigin[12] =
+            static_cast<float>((timestamp - _startTimestamp) / c_ticksPerSecond * 0.1);
+
+        frame.Image.create(
+            profile.ImageHeight,
+            profile.ImageWidth,
+            profile.ImageType);
+
+        Render(
+            profile,
+            frameNumber,
+            frame.Image);
+    }
+
+    void SyntheticSensorFrameGenerator::Reset()
+    {
+        std::fill(
+            _frameCounts.begin(),
+            _frameCounts.end(),
+            0);
+    }
+
+    void SyntheticSensorFrameGenerator::Render(
+        _In_ const SyntheticSensorProfile& profile,
+        _In_ uint64_t frameNumber,
+        _Inout_ cv::Mat& image) const
+    {
+        const int32_t phase =
+            static_cast<int32_t>(frameNumber % 256);
+
+        switch (profile.ImageType)
+        {
+        case CV_16UC1:
+            //
+            // A slanted plane, between 0.5m and about 3.5m, moving away from the camera.
+            //
+            for (int32_t y = 0; y < image.rows; ++y)
+            {
+                uint16_t* row = image.ptr<uint16_t>(y);
+
+                for (int32_t x = 0; x < image.cols; ++x)
+                {
+                    row[x] = static_cast<uint16_t>(500 + 2 * x + 2 * y + 4 * phase);
+                }
+            }
+            break;
+
+        case CV_8UC1:
+            for (int32_t y = 0; y < image.rows; ++y)
+            {
+                uint8_t* row = image.ptr<uint8_t>(y);
+
+                for (int32_t x = 0; x < image.cols; ++x)
+                {
+                    row[x] = static_cast<uint8_t>(x + 2 * y + phase);
+                }
+            }
+            break;
+
+        case CV_8UC3:
+        case CV_8UC4:
+        {
+            const int32_t channels =
+                image.channels();
+
+            for (int32_t y = 0; y < image.rows; ++y)
+            {
+                uint8_t* row = image.ptr<uint8_t>(y);
+
+                for (int32_t x = 0; x < image.cols; ++x, row += channels)
+                {
+                    row[0] = static_cast<uint8_t>(x + phase);
+                    row[1] = static_cast<uint8_t>(y + phase);
+                    row[2] = static_cast<uint8_t>(x + y);
+
+                    if (4 == channels)
+                    {
+                        row[3] = 255;
+                    }
+                }
+            }
+            break;
+        }
+
+        default:
+            image.setTo(
+                cv::Scalar::all(phase));
+            break;
+        }
+    }
+}
@@ -0,0 +1,342 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+//
+// Fits CameraProjectionModels to a synthetic lens distortion and compares them with a
+// dense table sampled from that distortion at every pixel, as the recorder samples
+// '<sensor>_camera_space_projection.bin' from the intrinsics of the sensor. Returns a
+// non-zero exit code if a check fails (run with ctest).
+//
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Debugging/Sal.h>
+#include <Playback/CameraProjectionModel.h>
+
+using HoloLensForCV::CameraProjectionModel;
+
+namespace
+{
+    // The resolution of the visible light cameras.
+    const uint32_t c_imageWidth = 640;
+    const uint32_t c_imageHeight = 480;
+
+    int g_numberOfFailures = 0;
+
+    void Check(
+        _In_ bool condition,
+        _In_ const char* description)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", description);
+
+            ++g_numberOfFailures;
+        }
+    }
+
+    //
+    // A pinhole camera with radial and tangential (Brown-Conrady) distortion. Image points
+    // are undistorted iteratively; points farther than 380 pixels from the principal
+    // point are outside of the field of view, which leaves the corners of the image
+    // without a mapping.
+    //
+    bool MapDistortedImagePoint(
+        _In_ float u,
+        _In_ float v,
+        _Out_ float* x,
+        _Out_ float* y)
+    {
+        const double fx = 420.0, fy = 420.0;
+        const double cx = 319.5, cy = 239.5;
+        const double k1 = -0.15, k2 = 0.03;
+        const double p1 = 1e-3, p2 = -5e-4;
+
+        *x = *y = std::numeric_limits<float>::infinity();
+
+        if (std::hypot(u - cx, v - cy) > 380.0)
+        {
+            return false;
+        }
+
+        const double xd = (u - cx) / fx;
+        const double yd = (v - cy) / fy;
+
+        double xu = xd, yu = yd;
+
+        for (int32_t iteration = 0; iteration < 50; ++iteration)
+        {
+            const double r2 = xu * xu + yu * yu;
+            const double radial = 1.0 + k1 * r2 + k2 * r2 * r2;
+
+            const double dx = 2.0 * p1 * xu * yu + p2 * (r2 + 2.0 * xu * xu);
+            const double dy = p1 * (r2 + 2.0 * yu * yu) + 2.0 * p2 * xu * yu;
+
+            xu = (xd - dx) / radial;
+            yu = (yd - dy) / radial;
+        }
+
+        *x = static_cast<float>(xu);
+        *y = static_cast<float>(yu);
+
+        return true;
+    }
+
+    //
+    // Samples the mapping at every pixel, in the layout of ComputeDenseProjectionTable.
+    //
+    std::vector<float> SampleDenseProjectionTable(
+        _In_ const CameraProjectionModel::ImagePointMapper& mapper)
+    {
+        std::vector<float> table;
+
+        table.reserve(
+            static_cast<size_t>(c_imageWidth) * c_imageHeight * 2);
+
+        for (uint32_t u = 0; u < c_imageWidth; ++u)
+        {
+            for (uint32_t v = 0; v < c_imageHeight; ++v)
+            {
+                float x, y;
+
+                if (!mapper(static_cast<float>(u), static_cast<float>(v), &x, &y))
+                {
+                    x = y = std::numeric_limits<float>::infinity();
+                }
+
+                table.push_back(x);
+                table.push_back(y);
+            }
+        }
+
+        return table;
+    }
+
+    //
+    // The number of pixels with a mapping in one table and not in the other.
+    //
+    uint32_t CountValidityMismatches(
+        _In_ const std::vector<float>& table,
+        _In_ const std::vector<float>& otherTable)
+    {
+        uint32_t numberOfMismatches = 0;
+
+        for (size_t k = 0; k < table.size(); k += 2)
+        {
+            if (std::isfinite(table[k]) != std::isfinite(otherTable[k]))
+            {
+                ++numberOfMismatches;
+            }
+        }
+
+        return numberOfMismatches;
+    }
+
+    void CheckAgainstDenseTable(
+        _In_ const char* name,
+        _In_ const CameraProjectionModel& model,
+        _In_ const CameraProjectionModel::FitOptions& options,
+        _In_ const std::vector<float>& denseTable)
+    {
+        const CameraProjectionModel::ErrorStatistics statistics =
+            model.CompareWithDenseProjectionTable(
+                denseTable);
+
+        std::vector<float> modelTable;
+
+        model.ComputeDenseProjectionTable(
+            modelTable);
+
+        const uint32_t numberOfMismatches =
+            CountValidityMismatches(
+                denseTable,
+                modelTable);
+
+        std::printf(
+            "%s: degree %u, within tolerance: %i, max error %g, rms error %g (%u of %u pixels), %u validity mismatches\n",
+            name,
+            model.GetDegree(),
+            model.IsWithinTolerance() ? 1 : 0,
+            statistics.MaximumError,
+            statistics.RootMeanSquareError,
+            statistics.NumberOfValidSamples,
+            statistics.NumberOfSamples,
+            numberOfMismatches);
+
+        Check(statistics.NumberOfSamples == c_imageWidth * c_imageHeight, "every pixel is compared");
+        Check(statistics.MaximumError <= options.MaximumErrorAllowed, "the maximum error is within MaximumErrorAllowed");
+        Check(statistics.RootMeanSquareError <= 0.25f * options.MaximumErrorAllowed, "the rms error is well within MaximumErrorAllowed");
+
+        //
+        // Only the pixels along the edge of the field of view may disagree about having a
+        // mapping: the model takes their validity from the sparse grid.
+        //
+        Check(numberOfMismatches < statistics.NumberOfSamples / 100, "the model has a mapping for the same pixels");
+    }
+
+    void CheckSaveLoadRoundTrip(
+        _In_ const char* name,
+        _In_ const CameraProjectionModel& model)
+    {
+        std::stringstream stream(
+            std::ios::in | std::ios::out | std::ios::binary);
+
+        model.Save(
+            stream);
+
+        CameraProjectionModel loadedModel;
+
+        const bool loaded =
+            loadedModel.Load(stream);
+
+        std::vector<float> table, loadedTable;
+
+        model.ComputeDenseProjectionTable(table);
+
+        if (loaded)
+        {
+            loadedModel.ComputeDenseProjectionTable(loadedTable);
+        }
+
+        std::printf(
+            "%s: round trip through %zu bytes\n",
+            name,
+            stream.str().size());
+
+        Check(loaded, "the saved model loads");
+        Check(loadedModel.GetDegree() == model.GetDegree(), "the loaded model has the same degree");
+        Check(loadedModel.IsWithinTolerance() == model.IsWithinTolerance(), "the loaded model uses the same mapping");
+        Check(table.size() == loadedTable.size() && 0 == CountValidityMismatches(table, loadedTable), "the loaded model has a mapping for the same pixels");
+
+        bool isIdentical = table.size() == loadedTable.size();
+
+        for (size_t k = 0; isIdentical && k < table.size(); ++k)
+        {
+            isIdentical = (!std::isfinite(table[k]) || table[k] == loadedTable[k]);
+        }
+
+        Check(isIdentical, "the loaded model maps every pixel the same way");
+
+        //
+        // A truncated or foreign file is rejected.
+        //
+        const std::string data = stream.str();
+
+        std::stringstream truncatedStream(
+            data.substr(0, data.size() / 2),
+            std::ios::in | std::ios::binary);
+
+        CameraProjectionModel truncatedModel;
+
+        Check(!truncatedModel.Load(truncatedStream) && !truncatedModel.IsValid(), "a truncated model is rejected");
+
+        std::stringstream foreignStream(
+            "P5\n640 480\n255\n" + data,
+            std::ios::in | std::ios::binary);
+
+        CameraProjectionModel foreignModel;
+
+        Check(!foreignModel.Load(foreignStream) && !foreignModel.IsValid(), "a file without the model cookie is rejected");
+    }
+
+    //
+    // With the default options, a polynomial fits the distortion within tolerance.
+    //
+    void TestPolynomialModel(
+        _In_ const std::vector<float>& denseTable)
+    {
+        const CameraProjectionModel::FitOptions options;
+
+        CameraProjectionModel model;
+
+        const bool isWithinTolerance =
+            model.Fit(
+                c_imageWidth,
+                c_imageHeight,
+                MapDistortedImagePoint,
+                options);
+
+        Check(isWithinTolerance && model.IsWithinTolerance(), "the polynomial fit is within tolerance");
+        Check(model.Verify(MapDistortedImagePoint), "the polynomial model verifies against the mapping");
+
+        CheckAgainstDenseTable(
+            "TestPolynomialModel",
+            model,
+            options,
+            denseTable);
+
+        CheckSaveLoadRoundTrip(
+            "TestPolynomialModel",
+            model);
+    }
+
+    //
+    // When no polynomial of the allowed degrees is accurate enough, the model falls back to
+    // interpolating the sparse grid, which is still accurate enough.
+    //
+    void TestGridFallbackModel(
+        _In_ const std::vector<float>& denseTable)
+    {
+        CameraProjectionModel::FitOptions options;
+
+        options.MinimumDegree = 2;
+        options.MaximumDegree = 2;
+
+        CameraProjectionModel model;
+
+        const bool isWithinTolerance =
+            model.Fit(
+                c_imageWidth,
+                c_imageHeight,
+                MapDistortedImagePoint,
+                options);
+
+        Check(!isWithinTolerance && !model.IsWithinTolerance(), "a quadratic polynomial is not within tolerance");
+        Check(model.IsValid(), "the model falls back to the grid");
+        Check(model.Verify(MapDistortedImagePoint), "the grid model verifies against the mapping");
+
+        CheckAgainstDenseTable(
+            "TestGridFallbackModel",
+            model,
+            options,
+            denseTable);
+
+        CheckSaveLoadRoundTrip(
+            "TestGridFallbackModel",
+            model);
+    }
+}
+
+int main()
+{
+    const std::vector<float> denseTable =
+        SampleDenseProjectionTable(
+            MapDistortedImagePoint);
+
+    TestPolynomialModel(denseTable);
+    TestGridFallbackModel(denseTable);
+
+    if (0 != g_numberOfFailures)
+    {
+        std::printf("%d check(s) failed\n", g_numberOfFailures);
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace BenchmarkRunner
+{
+    namespace
+    {
+        const size_t c_pageSize = 4096;
+
+        //
+        // Reads one byte per page, so that mapped pages are actually loaded.
+        //
+        uint8_t TouchPages(
+            _In_ const Io::ByteSpan& data)
+        {
+            uint8_t checksum = 0;
+
+            for (size_t offset = 0; offset < data.Size; offset += c_pageSize)
+            {
+                checksum ^= data.Data[offset];
+            }
+
+            return checksum;
+        }
+
+        double GetSecondsSince(
+            _In_ const std::chrono::steady_clock::time_point& startTime)
+        {
+            return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - startTime).count();
+        }
+    }
+
+    FileLoadingResults::FileLoadingResults()
+        : FileSize(0)
+        , ReadSeconds(-1.0)
+        , MappedSeconds(-1.0)
+        , ChunkedSeconds(-1.0)
+    {
+    }
+
+    FileLoadingResults BenchmarkFileLoading(
+        _In_ const std::string& fileName)
+    {
+        FileLoadingResults results;
+
+        uint8_t checksum = 0;
+
+        //
+        // Mapped first, which also tells the file size.
+        //
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            Io::MappedFile mappedFile;
+
+            if (mappedFile.Open(fileName))
+            {
+                checksum ^= TouchPages(
+                    mappedFile.GetSpan());
+
+                results.MappedSeconds = GetSecondsSince(startTime);
+            }
+
+            results.FileSize = mappedFile.GetFileSize();
+        }
+
+        if (results.FileSize <= SIZE_MAX / 2)
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            try
+            {
+                std::ifstream file(
+                    fileName,
+                    std::ios::in | std::ios::binary);
+
+                std::vector<uint8_t> data(
+                    static_cast<size_t>(results.FileSize));
+
+                if (file.read(reinterpret_cast<char*>(data.data()), data.size()))
+                {
+                    checksum ^= TouchPages(
+                        Io::ByteSpan(data.data(), data.size()));
+
+                    results.ReadSeconds = GetSecondsSince(startTime);
+                }
+            }
+            catch (const std::bad_alloc&)
+            {
+            }
+        }
+
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            Io::ChunkedFileReader reader;
+
+            if (reader.Open(fileName))
+            {
+                for (Io::ByteSpan chunk = reader.ReadNextChunk(); !chunk.IsEmpty(); chunk = reader.ReadNextChunk())
+                {
+                    checksum ^= TouchPages(
+                        chunk);
+                }
+
+                if (!reader.HasFailed())
+                {
+                    results.ChunkedSeconds = GetSecondsSince(startTime);
+                }
+            }
+        }
+
+#if DBG_ENABLE_INFORMATIONAL_LOGGING
+        DBG_LOG(
+            "BenchmarkRunner",
+            dbg::LogLevel::Information,
+            L"BenchmarkFileLoading: %llu bytes: read %.3f s, mapped %.3f s, chunked %.3f s (checksum %u)",
+            static_cast<unsigned long long>(results.FileSize),
+            results.ReadSeconds,
+            results.MappedSeconds,
+            results.ChunkedSeconds,
+            checksum);
+#else
+        (void)checksum;
+#endif /* DBG_ENABLE_INFORMATIONAL_LOGGING */
+
+        return results;
+    }
+
+    _Use_decl_annotations_
+    bool CreateBenchmarkFile(
+        const std::string& fileName,
+        uint64_t fileSize)
+    {
+        std::ofstream file(
+            fileName,
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+        std::vector<uint64_t> block(
+            1024 * 1024 / sizeof(uint64_t));
+
+        uint64_t state = 0x9e3779b97f4a7c15ull;
+
+        for (uint64_t written = 0; file && written < fileSize; written += block.size() * sizeof(uint64_t))
+        {
+            //
+            // xorshift64: fast, and not compressible.
+            //
+            for (uint64_t& value : block)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+
+                value = state;
+            }
+
+            file.write(
+                reinterpret_cast<const char*>(block.data()),
+                static_cast<std::streamsize>(
+                    std::min<uint64_t>(block.size() * sizeof(uint64_t), fileSize - written)));
+        }
+
+        return static_cast<bool>(file);
+    }
+}
@@ -0,0 +1,44 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace BenchmarkRunner
+{
+    //
+    // Load times of a file, in seconds, each time touching every page of the data: read
+    // into a buffer at once (as Io::ReadDataSync does on device), mapped with
+    // Io::MappedFile, and read with the Io::ChunkedFileReader. The read time is negative
+    // if the file does not fit in memory. This is Io::BenchmarkFileLoading without the
+    // Windows Runtime.
+    //
+    struct FileLoadingResults
+    {
+        FileLoadingResults();
+
+        uint64_t FileSize;
+
+        double ReadSeconds;
+        double MappedSeconds;
+        double ChunkedSeconds;
+    };
+
+    FileLoadingResults BenchmarkFileLoading(
+        _In_ const std::string& fileName);
+
+    //
+    // Writes a file of the given size with content that does not compress, to load in
+    // the benchmark.
+    //
+    bool CreateBenchmarkFile(
+        _In_ const std::string& fileName,
+        _In_ uint64_t fileSize);
+}
@@ -0,0 +1,192 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace BenchmarkRunner
+{
+    JsonWriter::JsonWriter()
+    {
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::BeginObject(
+        const char* name)
+    {
+        BeginValue(
+            name);
+
+        _text.push_back('{');
+        _hasValues.push_back(false);
+    }
+
+    void JsonWriter::EndObject()
+    {
+        REQUIRES(!_hasValues.empty());
+
+        _text.push_back('}');
+        _hasValues.pop_back();
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::BeginArray(
+        const char* name)
+    {
+        BeginValue(
+            name);
+
+        _text.push_back('[');
+        _hasValues.push_back(false);
+    }
+
+    void JsonWriter::EndArray()
+    {
+        REQUIRES(!_hasValues.empty());
+
+        _text.push_back(']');
+        _hasValues.pop_back();
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::WriteString(
+        const char* name,
+        std::string_view value)
+    {
+        BeginValue(
+            name);
+
+        AppendString(
+            value);
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::WriteNumber(
+        const char* name,
+        double value)
+    {
+        BeginValue(
+            name);
+
+        if (std::isfinite(value))
+        {
+            Io::AppendNumber(
+                value,
+                _text);
+        }
+        else
+        {
+            _text.append(
+                "null");
+        }
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::WriteInteger(
+        const char* name,
+        uint64_t value)
+    {
+        BeginValue(
+            name);
+
+        Io::AppendNumber(
+            value,
+            _text);
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::WriteBoolean(
+        const char* name,
+        bool value)
+    {
+        BeginValue(
+            name);
+
+        _text.append(
+            value ? "true" : "false");
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::WriteRaw(
+        const char* name,
+        std::string_view json)
+    {
+        BeginValue(
+            name);
+
+        _text.append(
+            json);
+    }
+
+    const std::string& JsonWriter::GetText() const
+    {
+        REQUIRES(_hasValues.empty());
+
+        return _text;
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::BeginValue(
+        const char* name)
+    {
+        if (!_hasValues.empty())
+        {
+            if (_hasValues.back())
+            {
+                _text.push_back(',');
+            }
+
+            _hasValues.back() = true;
+        }
+
+        if (nullptr != name)
+        {
+            AppendString(
+                name);
+
+            _text.push_back(':');
+        }
+    }
+
+    _Use_decl_annotations_
+    void JsonWriter::AppendString(
+        std::string_view text)
+    {
+        _text.push_back('"');
+
+        for (const char c : text)
+        {
+            if ('"' == c || '\\' == c)
+            {
+                _text.push_back('\\');
+                _text.push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8] = {};
+
+                snprintf(
+                    escaped,
+                    sizeof(escaped),
+                    "\\u%04x",
+                    static_cast<unsigned int>(c));
+
+                _text.append(
+                    escaped);
+            }
+            else
+            {
+                _text.push_back(c);
+            }
+        }
+
+        _text.push_back('"');
+    }
+}
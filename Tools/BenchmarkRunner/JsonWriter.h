@@ -0,0 +1,74 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace BenchmarkRunner
+{
+    //
+    // Writes a JSON document front to back. Values are named inside objects, and unnamed
+    // (nullptr) inside arrays and for the document itself. Numbers are written with the
+    // fewest digits that parse back to the same value; infinities and NaNs as null.
+    //
+    class JsonWriter
+    {
+    public:
+        JsonWriter();
+
+        void BeginObject(
+            _In_opt_z_ const char* name = nullptr);
+
+        void EndObject();
+
+        void BeginArray(
+            _In_opt_z_ const char* name = nullptr);
+
+        void EndArray();
+
+        void WriteString(
+            _In_opt_z_ const char* name,
+            _In_ std::string_view value);
+
+        void WriteNumber(
+            _In_opt_z_ const char* name,
+            _In_ double value);
+
+        void WriteInteger(
+            _In_opt_z_ const char* name,
+            _In_ uint64_t value);
+
+        void WriteBoolean(
+            _In_opt_z_ const char* name,
+            _In_ bool value);
+
+        //
+        // Writes a value that is already formatted as JSON, e.g. by PipelineBenchmark::ToJson.
+        //
+        void WriteRaw(
+            _In_opt_z_ const char* name,
+            _In_ std::string_view json);
+
+        const std::string& GetText() const;
+
+    private:
+        void BeginValue(
+            _In_opt_z_ const char* name);
+
+        void AppendString(
+            _In_ std::string_view text);
+
+    private:
+        std::string _text;
+
+        // For each open object or array, whether it has values already.
+        std::vector<bool> _hasValues;
+    };
+}
@@ -0,0 +1,137 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#if ENABLE_PIPELINE_BENCHMARKS
+namespace BenchmarkRunner
+{
+    namespace
+    {
+        // Frames kept per sensor by the 'buffer' consumer.
+        const size_t c_bufferedFramesPerSensor = 8;
+    }
+
+    std::vector<std::string> GetPipelineConsumerNames()
+    {
+        return { "discard", "buffer", "write" };
+    }
+
+    _Use_decl_annotations_
+    bool RunPipelineBenchmark(
+        const std::string& consumerName,
+        const std::vector<std::string>& sensorNames,
+        const HoloLensForCV::PipelineBenchmark::Options& options,
+        const std::filesystem::path& temporaryFolder,
+        HoloLensForCV::PipelineBenchmark::Results& results)
+    {
+        HoloLensForCV::SyntheticSensorFrameGenerator generator;
+
+        for (const std::string& sensorName : sensorNames)
+        {
+            HoloLensForCV::SyntheticSensorProfile profile;
+
+            if (!HoloLensForCV::SyntheticSensorFrameGenerator::GetDefaultProfile(sensorName, profile))
+            {
+                std::cerr << "Unknown sensor: " << sensorName << std::endl;
+
+                return false;
+            }
+
+            generator.AddSensor(
+                profile);
+        }
+
+        const std::string name =
+            consumerName + (options.Paced ? "_paced" : "");
+
+        if ("discard" == consumerName)
+        {
+            results = HoloLensForCV::PipelineBenchmark::Run(
+                name,
+                generator,
+                [](const HoloLensForCV::RecordedSensorFrame&)
+            {
+            },
+                options);
+        }
+        else if ("buffer" == consumerName)
+        {
+            std::vector<std::vector<cv::Mat>> bufferedFrames(
+                generator.GetNumberOfSensors(),
+                std::vector<cv::Mat>(c_bufferedFramesPerSensor));
+
+            std::vector<size_t> nextFrames(
+                generator.GetNumberOfSensors());
+
+            results = HoloLensForCV::PipelineBenchmark::Run(
+                name,
+                generator,
+                [&](const HoloLensForCV::RecordedSensorFrame& frame)
+            {
+                size_t& nextFrame =
+                    nextFrames[frame.SensorIndex];
+
+                frame.Image.copyTo(
+                    bufferedFrames[frame.SensorIndex][nextFrame]);
+
+                nextFrame = (nextFrame + 1) % c_bufferedFramesPerSensor;
+            },
+                options);
+        }
+        else if ("write" == consumerName)
+        {
+            const std::filesystem::path fileName =
+                temporaryFolder / "pipeline_benchmark_frames.bin";
+
+            {
+                std::ofstream file(
+                    fileName,
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+
+                if (!file)
+                {
+                    std::cerr << "Cannot write to " << fileName.string() << std::endl;
+
+                    return false;
+                }
+
+                results = HoloLensForCV::PipelineBenchmark::Run(
+                    name,
+                    generator,
+                    [&](const HoloLensForCV::RecordedSensorFrame& frame)
+                {
+                    REQUIRES(frame.Image.isContinuous());
+
+                    file.write(
+                        reinterpret_cast<const char*>(frame.Image.data),
+                        static_cast<std::streamsize>(frame.Image.total() * frame.Image.elemSize()));
+                },
+                    options);
+            }
+
+            std::error_code error;
+
+            std::filesystem::remove(
+                fileName,
+                error);
+        }
+        else
+        {
+            std::cerr << "Unknown consumer: " << consumerName << std::endl;
+
+            return false;
+        }
+
+        return true;
+    }
+}
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
@@ -0,0 +1,40 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#if ENABLE_PIPELINE_BENCHMARKS
+namespace BenchmarkRunner
+{
+    //
+    // The frame consumers that the pipeline benchmark can drive off-device, standing in
+    // for the sink groups of the app:
+    //
+    //   discard   returns right away, to measure the cost of the harness itself;
+    //   buffer    deep-copies each frame into a ring of the last frames of its sensor, as
+    //             the MultiFrameBuffer keeps them;
+    //   write     appends the pixels of each frame to a file, as the recorder does.
+    //
+    std::vector<std::string> GetPipelineConsumerNames();
+
+    //
+    // Runs the PipelineBenchmark with the synthetic frames of the given sensors (see
+    // SyntheticSensorFrameGenerator::GetDefaultProfile). Files are written to the given
+    // folder, and deleted. Returns false if a name is unknown.
+    //
+    bool RunPipelineBenchmark(
+        _In_ const std::string& consumerName,
+        _In_ const std::vector<std::string>& sensorNames,
+        _In_ const HoloLensForCV::PipelineBenchmark::Options& options,
+        _In_ const std::filesystem::path& temporaryFolder,
+        _Out_ HoloLensForCV::PipelineBenchmark::Results& results);
+}
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
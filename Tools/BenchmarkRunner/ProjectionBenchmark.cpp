@@ -0,0 +1,173 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#if ENABLE_PIPELINE_BENCHMARKS
+namespace BenchmarkRunner
+{
+    namespace
+    {
+        // The resolution of the visible light cameras.
+        const uint32_t c_imageWidth = 640;
+        const uint32_t c_imageHeight = 480;
+
+        //
+        // A pinhole camera with radial and tangential (Brown-Conrady) distortion, the same
+        // as in Shared/Playback/Tests/CameraProjectionModelTests.cpp. Image points farther
+        // than 380 pixels from the principal point are outside of the field of view.
+        //
+        bool MapDistortedImagePoint(
+            _In_ float u,
+            _In_ float v,
+            _Out_ float* x,
+            _Out_ float* y)
+        {
+            const double fx = 420.0, fy = 420.0;
+            const double cx = 319.5, cy = 239.5;
+            const double k1 = -0.15, k2 = 0.03;
+            const double p1 = 1e-3, p2 = -5e-4;
+
+            *x = *y = std::numeric_limits<float>::infinity();
+
+            if (std::hypot(u - cx, v - cy) > 380.0)
+            {
+                return false;
+            }
+
+            const double xd = (u - cx) / fx;
+            const double yd = (v - cy) / fy;
+
+            double xu = xd, yu = yd;
+
+            for (int32_t iteration = 0; iteration < 50; ++iteration)
+            {
+                const double r2 = xu * xu + yu * yu;
+                const double radial = 1.0 + k1 * r2 + k2 * r2 * r2;
+
+                const double dx = 2.0 * p1 * xu * yu + p2 * (r2 + 2.0 * xu * xu);
+                const double dy = p1 * (r2 + 2.0 * yu * yu) + 2.0 * p2 * xu * yu;
+
+                xu = (xd - dx) / radial;
+                yu = (yd - dy) / radial;
+            }
+
+            *x = static_cast<float>(xu);
+            *y = static_cast<float>(yu);
+
+            return true;
+        }
+
+        //
+        // Samples the mapping at every pixel, in the layout of
+        // CameraProjectionModel::ComputeDenseProjectionTable.
+        //
+        std::vector<float> SampleDenseProjectionTable()
+        {
+            std::vector<float> table;
+
+            table.reserve(
+                static_cast<size_t>(c_imageWidth) * c_imageHeight * 2);
+
+            for (uint32_t u = 0; u < c_imageWidth; ++u)
+            {
+                for (uint32_t v = 0; v < c_imageHeight; ++v)
+                {
+                    float x, y;
+
+                    MapDistortedImagePoint(
+                        static_cast<float>(u),
+                        static_cast<float>(v),
+                        &x,
+                        &y);
+
+                    table.push_back(x);
+                    table.push_back(y);
+                }
+            }
+
+            return table;
+        }
+    }
+
+    ProjectionBenchmarkResults::ProjectionBenchmarkResults()
+        : ImageWidth(0)
+        , ImageHeight(0)
+        , Degree(0)
+        , IsWithinTolerance(false)
+        , FitSeconds(0.0)
+    {
+    }
+
+    std::vector<std::string> GetProjectionModelNames()
+    {
+        return { "polynomial", "grid" };
+    }
+
+    _Use_decl_annotations_
+    bool RunProjectionBenchmark(
+        const std::string& modelName,
+        uint32_t numberOfIterations,
+        ProjectionBenchmarkResults& results)
+    {
+        results = ProjectionBenchmarkResults();
+
+        HoloLensForCV::CameraProjectionModel::FitOptions options;
+
+        if ("grid" == modelName)
+        {
+            options.MinimumDegree = 2;
+            options.MaximumDegree = 2;
+        }
+        else if ("polynomial" != modelName)
+        {
+            std::cerr << "Unknown projection model: " << modelName << std::endl;
+
+            return false;
+        }
+
+        HoloLensForCV::CameraProjectionModel model;
+
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        model.Fit(
+            c_imageWidth,
+            c_imageHeight,
+            MapDistortedImagePoint,
+            options);
+
+        results.FitSeconds =
+            std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - startTime).count();
+
+        const std::vector<float> table =
+            SampleDenseProjectionTable();
+
+        results.Name = modelName;
+        results.ImageWidth = c_imageWidth;
+        results.ImageHeight = c_imageHeight;
+        results.Degree = model.GetDegree();
+        results.IsWithinTolerance = model.IsWithinTolerance();
+
+        results.Error =
+            model.CompareWithDenseProjectionTable(
+                table);
+
+        results.Throughput =
+            model.BenchmarkUnprojection(
+                table,
+                numberOfIterations);
+
+        return true;
+    }
+}
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
@@ -0,0 +1,58 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#if ENABLE_PIPELINE_BENCHMARKS
+namespace BenchmarkRunner
+{
+    //
+    // The accuracy and unprojection throughput of a CameraProjectionModel fitted to a
+    // synthetic lens distortion, against a dense table sampled from that distortion at
+    // every pixel, as the recorder samples '<sensor>_camera_space_projection.bin' from
+    // the intrinsics of the sensor.
+    //
+    struct ProjectionBenchmarkResults
+    {
+        ProjectionBenchmarkResults();
+
+        std::string Name;
+
+        uint32_t ImageWidth;
+        uint32_t ImageHeight;
+
+        uint32_t Degree;
+        bool IsWithinTolerance;
+        double FitSeconds;
+
+        HoloLensForCV::CameraProjectionModel::ErrorStatistics Error;
+        HoloLensForCV::CameraProjectionModel::UnprojectionBenchmarkResults Throughput;
+    };
+
+    //
+    // The models that the projection benchmark can fit:
+    //
+    //   polynomial   the default fit options, which are met by a polynomial;
+    //   grid         polynomials of degree 2 only, which are not, so that the model
+    //                interpolates the sparse grid instead.
+    //
+    std::vector<std::string> GetProjectionModelNames();
+
+    //
+    // Fits the named model and times the given number of passes over the image. Returns
+    // false if the name is unknown.
+    //
+    bool RunProjectionBenchmark(
+        _In_ const std::string& modelName,
+        _In_ uint32_t numberOfIterations,
+        _Out_ ProjectionBenchmarkResults& results);
+}
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
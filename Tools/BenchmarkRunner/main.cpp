@@ -0,0 +1,606 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#if ENABLE_PIPELINE_BENCHMARKS
+//
+// Lets the pipeline benchmark count allocations (see PipelineBenchmark.h).
+//
+HOLOLENSFORCV_DEFINE_COUNTING_OPERATOR_NEW()
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
+
+using namespace BenchmarkRunner;
+
+namespace
+{
+    struct CommandLine
+    {
+        std::string Command;
+        std::map<std::string, std::string> Options;
+    };
+
+    void PrintUsage()
+    {
+        std::cout <<
+            "Usage:\n"
+            "  BenchmarkRunner <benchmark> [options]\n"
+            "      Runs a benchmark and writes its results as JSON.\n"
+            "      --output <file>         Where to write the results (default: stdout)\n"
+            "\n"
+            "  Benchmarks:\n"
+            "  metrics                     Cost of updating and formatting dbg::Metrics\n"
+            "      --threads <n>           Threads recording into one histogram (default: 4)\n"
+            "      --updates <n>           Updates per thread (default: 1000000)\n"
+            "  logger                      Cost of dbg::log calls and throughput under contention\n"
+            "      --threads <n>           Threads logging at once (default: 4)\n"
+            "      --messages <n>          Messages per thread (default: 100000)\n"
+            "  strings                     Io string helpers and the code they replaced\n"
+            "      --iterations <n>        Calls timed per helper (default: 100000)\n"
+            "  csv                         Io::CsvWriter and the stream-based writer it replaced\n"
+            "      --rows <n>              Frame index rows written (default: 20000)\n"
+            "  files                       Loading a file read at once, mapped and chunked\n"
+            "      --file <path>           File to load (default: a generated file)\n"
+            "      --size-mb <n>           Size of the generated file (default: 100)\n"
+            "      --passes <n>            Times the file is loaded (default: 2)\n"
+#if ENABLE_PIPELINE_BENCHMARKS
+            "  pipeline                    Synthetic sensor frames through frame consumers\n"
+            "      --consumers <a,b,...>   discard, buffer and/or write (default: all)\n"
+            "      --sensors <a,b,...>     Sensors to generate frames for (default: all)\n"
+            "      --duration <seconds>    Playback time per consumer (default: 10)\n"
+            "      --paced <0|1>           Deliver frames on the sensors' schedules (default: 0)\n"
+            "  projection                  CameraProjectionModel against a dense projection table\n"
+            "      --iterations <n>        Passes over the image timed per model (default: 20)\n"
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
+            "  all                         All of the above, with the default options\n";
+    }
+
+    bool ParseCommandLine(
+        _In_ const std::vector<std::string>& arguments,
+        _Out_ CommandLine& commandLine)
+    {
+        commandLine = CommandLine();
+
+        if (arguments.empty())
+        {
+            return false;
+        }
+
+        commandLine.Command = arguments[0];
+
+        for (size_t i = 1; i < arguments.size(); ++i)
+        {
+            if (0 != arguments[i].compare(0, 2, "--"))
+            {
+                std::cerr << "Unexpected argument: " << arguments[i] << std::endl;
+
+                return false;
+            }
+            else if (i + 1 < arguments.size())
+            {
+                commandLine.Options[arguments[i].substr(2)] = arguments[i + 1];
+
+                ++i;
+            }
+            else
+            {
+                std::cerr << "Missing value for " << arguments[i] << std::endl;
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    bool GetOption(
+        _In_ const CommandLine& commandLine,
+        _In_ const char* name,
+        _Inout_ T& value)
+    {
+        const auto option =
+            commandLine.Options.find(name);
+
+        if (commandLine.Options.end() == option)
+        {
+            return true;
+        }
+
+        if (!Io::ParseNumber(option->second, value))
+        {
+            std::cerr << "Invalid value for --" << name << ": " << option->second << std::endl;
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool RunMetricsBenchmark(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        uint32_t numberOfThreads = 4;
+        uint32_t numberOfUpdatesPerThread = 1000000;
+
+        if (!GetOption(commandLine, "threads", numberOfThreads) ||
+            !GetOption(commandLine, "updates", numberOfUpdatesPerThread))
+        {
+            return false;
+        }
+
+        dbg::Metrics::BenchmarkStatistics statistics;
+
+        dbg::Metrics::Benchmark(
+            numberOfThreads,
+            numberOfUpdatesPerThread,
+            statistics);
+
+        json.BeginObject("metrics");
+        json.WriteInteger("updates_per_thread", numberOfUpdatesPerThread);
+        json.WriteNumber("counter_increment_ns", statistics.CounterIncrementTimeInNanoseconds);
+        json.WriteNumber("gauge_set_ns", statistics.GaugeSetTimeInNanoseconds);
+        json.WriteNumber("histogram_record_ns", statistics.HistogramRecordTimeInNanoseconds);
+        json.WriteInteger("threads", statistics.NumberOfThreads);
+        json.WriteNumber("contended_histogram_record_ns", statistics.ContendedHistogramRecordTimeInNanoseconds);
+        json.WriteNumber("text_formatting_ms", statistics.TextFormattingTimeInMilliseconds);
+        json.WriteNumber("json_formatting_ms", statistics.JsonFormattingTimeInMilliseconds);
+        json.EndObject();
+
+        return true;
+    }
+
+    bool RunLoggerBenchmark(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        uint32_t numberOfThreads = 4;
+        uint32_t numberOfMessagesPerThread = 100000;
+
+        if (!GetOption(commandLine, "threads", numberOfThreads) ||
+            !GetOption(commandLine, "messages", numberOfMessagesPerThread))
+        {
+            return false;
+        }
+
+        dbg::Logger::BenchmarkStatistics statistics;
+
+        dbg::Logger::Benchmark(
+            numberOfThreads,
+            numberOfMessagesPerThread,
+            statistics);
+
+        json.BeginObject("logger");
+        json.WriteInteger("messages_per_thread", numberOfMessagesPerThread);
+        json.WriteNumber("enabled_call_ns", statistics.EnabledCallTimeInNanoseconds);
+        json.WriteNumber("disabled_call_ns", statistics.DisabledCallTimeInNanoseconds);
+        json.WriteNumber("rate_limited_call_ns", statistics.RateLimitedCallTimeInNanoseconds);
+        json.WriteNumber("synchronous_formatting_ns", statistics.SynchronousFormattingTimeInNanoseconds);
+        json.WriteInteger("threads", statistics.NumberOfThreads);
+        json.WriteNumber("contended_messages_per_second", statistics.ContendedMessagesPerSecond);
+        json.WriteNumber("contended_dropped_fraction", statistics.ContendedDroppedFraction);
+        json.EndObject();
+
+        return true;
+    }
+
+    bool RunStringsBenchmark(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        uint32_t numberOfIterations = 100000;
+
+        if (!GetOption(commandLine, "iterations", numberOfIterations) ||
+            0 == numberOfIterations)
+        {
+            return false;
+        }
+
+        const Io::StringHelpersBenchmarkResults results =
+            Io::BenchmarkStringHelpers(
+                numberOfIterations);
+
+        json.BeginObject("strings");
+        json.WriteInteger("iterations", numberOfIterations);
+        json.WriteNumber("stream_row_parsing_ns", results.StreamRowParsingNanoseconds);
+        json.WriteNumber("tokenizer_row_parsing_ns", results.TokenizerRowParsingNanoseconds);
+        json.WriteNumber("string_number_formatting_ns", results.StringNumberFormattingNanoseconds);
+        json.WriteNumber("format_number_ns", results.FormatNumberNanoseconds);
+        json.WriteNumber("utf16_to_utf8_string_ns", results.Utf16ToUtf8StringNanoseconds);
+        json.WriteNumber("utf16_to_utf8_buffer_ns", results.Utf16ToUtf8BufferNanoseconds);
+        json.EndObject();
+
+        return true;
+    }
+
+    bool RunCsvBenchmark(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        uint32_t numberOfRows = 20000;
+
+        if (!GetOption(commandLine, "rows", numberOfRows))
+        {
+            return false;
+        }
+
+        Io::CsvWriter::BenchmarkStatistics statistics;
+
+        if (!Io::CsvWriter::Benchmark(
+            std::filesystem::temp_directory_path().wstring(),
+            numberOfRows,
+            statistics))
+        {
+            return false;
+        }
+
+        json.BeginObject("csv");
+        json.WriteInteger("rows", statistics.NumberOfRows);
+        json.WriteNumber("stream_us_per_row", statistics.StreamTimePerRowInMicroseconds);
+        json.WriteInteger("stream_file_size", statistics.StreamFileSize);
+        json.WriteNumber("buffered_us_per_row", statistics.BufferedTimePerRowInMicroseconds);
+        json.WriteInteger("buffered_file_size", statistics.BufferedFileSize);
+        json.EndObject();
+
+        return true;
+    }
+
+    bool RunFilesBenchmark(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        uint64_t fileSizeInMegabytes = 100;
+        uint32_t numberOfPasses = 2;
+
+        if (!GetOption(commandLine, "size-mb", fileSizeInMegabytes) ||
+            !GetOption(commandLine, "passes", numberOfPasses))
+        {
+            return false;
+        }
+
+        const auto fileOption =
+            commandLine.Options.find("file");
+
+        const bool generateFile =
+            commandLine.Options.end() == fileOption;
+
+        const std::string fileName =
+            generateFile ?
+                (std::filesystem::temp_directory_path() / "benchmark_runner_file_loading.bin").string() :
+                fileOption->second;
+
+        if (generateFile &&
+            !CreateBenchmarkFile(fileName, fileSizeInMegabytes * 1024 * 1024))
+        {
+            std::cerr << "Cannot write " << fileName << std::endl;
+
+            return false;
+        }
+
+        json.BeginObject("files");
+        json.WriteString("file", generateFile ? std::string("generated") : fileName);
+        json.BeginArray("passes");
+
+        uint64_t fileSize = 0;
+
+        for (uint32_t pass = 0; pass < numberOfPasses; ++pass)
+        {
+            const FileLoadingResults results =
+                BenchmarkFileLoading(
+                    fileName);
+
+            fileSize = results.FileSize;
+
+            json.BeginObject();
+            json.WriteNumber("read_s", results.ReadSeconds);
+            json.WriteNumber("mapped_s", results.MappedSeconds);
+            json.WriteNumber("chunked_s", results.ChunkedSeconds);
+            json.EndObject();
+        }
+
+        json.EndArray();
+        json.WriteInteger("file_size", fileSize);
+        json.EndObject();
+
+        if (generateFile)
+        {
+            std::error_code error;
+
+            std::filesystem::remove(
+                fileName,
+                error);
+        }
+
+        return true;
+    }
+
+#if ENABLE_PIPELINE_BENCHMARKS
+    std::vector<std::string> SplitNames(
+        _In_ const std::string& text)
+    {
+        std::vector<std::string_view> tokens;
+
+        Io::TokenizeString(
+            text,
+            ",",
+            tokens);
+
+        std::vector<std::string> names;
+
+        for (const std::string_view token : tokens)
+        {
+            names.emplace_back(
+                Io::TrimString(token));
+        }
+
+        return names;
+    }
+
+    bool RunPipelineBenchmarks(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        HoloLensForCV::PipelineBenchmark::Options options;
+        uint32_t paced = 0;
+
+        if (!GetOption(commandLine, "duration", options.DurationInSeconds) ||
+            !GetOption(commandLine, "paced", paced))
+        {
+            return false;
+        }
+
+        options.Paced = (0 != paced);
+
+        std::vector<std::string> consumerNames =
+            GetPipelineConsumerNames();
+
+        std::vector<std::string> sensorNames =
+            HoloLensForCV::SyntheticSensorFrameGenerator::GetDefaultSensorNames();
+
+        if (commandLine.Options.count("consumers"))
+        {
+            consumerNames = SplitNames(commandLine.Options.at("consumers"));
+        }
+
+        if (commandLine.Options.count("sensors"))
+        {
+            sensorNames = SplitNames(commandLine.Options.at("sensors"));
+        }
+
+        std::vector<HoloLensForCV::PipelineBenchmark::Results> results;
+
+        for (const std::string& consumerName : consumerNames)
+        {
+            results.emplace_back();
+
+            if (!RunPipelineBenchmark(
+                consumerName,
+                sensorNames,
+                options,
+                std::filesystem::temp_directory_path(),
+                results.back()))
+            {
+                return false;
+            }
+        }
+
+        json.WriteRaw(
+            "pipeline",
+            HoloLensForCV::PipelineBenchmark::ToJson(results));
+
+        return true;
+    }
+
+    bool RunProjectionBenchmarks(
+        _In_ const CommandLine& commandLine,
+        _Inout_ JsonWriter& json)
+    {
+        uint32_t numberOfIterations = 20;
+
+        if (!GetOption(commandLine, "iterations", numberOfIterations) ||
+            0 == numberOfIterations)
+        {
+            return false;
+        }
+
+        json.BeginObject("projection");
+        json.WriteInteger("iterations", numberOfIterations);
+        json.BeginArray("models");
+
+        for (const std::string& modelName : GetProjectionModelNames())
+        {
+            ProjectionBenchmarkResults results;
+
+            if (!RunProjectionBenchmark(
+                modelName,
+                numberOfIterations,
+                results))
+            {
+                return false;
+            }
+
+            json.BeginObject();
+            json.WriteString("name", results.Name);
+            json.WriteInteger("image_width", results.ImageWidth);
+            json.WriteInteger("image_height", results.ImageHeight);
+            json.WriteInteger("degree", results.Degree);
+            json.WriteBoolean("within_tolerance", results.IsWithinTolerance);
+            json.WriteNumber("fit_s", results.FitSeconds);
+            json.WriteInteger("valid_pixels", results.Error.NumberOfValidSamples);
+            json.WriteNumber("max_error", results.Error.MaximumError);
+            json.WriteNumber("rms_error", results.Error.RootMeanSquareError);
+            json.WriteNumber("unproject_row_ns_per_pixel", results.Throughput.UnprojectRowNanosecondsPerPixel);
+            json.WriteNumber("dense_table_ns_per_pixel", results.Throughput.DenseTableLookupNanosecondsPerPixel);
+            json.EndObject();
+        }
+
+        json.EndArray();
+        json.EndObject();
+
+        return true;
+    }
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
+
+    bool RunBenchmark(
+        _In_ const CommandLine& commandLine,
+        _In_ const std::string& benchmark,
+        _Inout_ JsonWriter& json)
+    {
+        if ("metrics" == benchmark)
+        {
+            return RunMetricsBenchmark(commandLine, json);
+        }
+        else if ("logger" == benchmark)
+        {
+            return RunLoggerBenchmark(commandLine, json);
+        }
+        else if ("strings" == benchmark)
+        {
+            return RunStringsBenchmark(commandLine, json);
+        }
+        else if ("csv" == benchmark)
+        {
+            return RunCsvBenchmark(commandLine, json);
+        }
+        else if ("files" == benchmark)
+        {
+            return RunFilesBenchmark(commandLine, json);
+        }
+#if ENABLE_PIPELINE_BENCHMARKS
+        else if ("pipeline" == benchmark)
+        {
+            return RunPipelineBenchmarks(commandLine, json);
+        }
+        else if ("projection" == benchmark)
+        {
+            return RunProjectionBenchmarks(commandLine, json);
+        }
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
+
+        return false;
+    }
+
+    int Run(
+        _In_ const std::vector<std::string>& arguments)
+    {
+        CommandLine commandLine;
+
+        if (!ParseCommandLine(arguments, commandLine))
+        {
+            PrintUsage();
+
+            return 1;
+        }
+
+        std::vector<std::string> benchmarks;
+
+        if ("all" == commandLine.Command)
+        {
+            benchmarks = { "metrics", "logger", "strings", "csv", "files" };
+
+#if ENABLE_PIPELINE_BENCHMARKS
+            benchmarks.push_back("pipeline");
+            benchmarks.push_back("projection");
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
+        }
+        else
+        {
+            benchmarks = { commandLine.Command };
+        }
+
+        JsonWriter json;
+
+        json.BeginObject();
+
+        json.BeginObject("system");
+#if defined(_WIN32)
+        json.WriteString("platform", "windows");
+#elif defined(__linux__)
+        json.WriteString("platform", "linux");
+#else
+        json.WriteString("platform", "other");
+#endif /* defined(_WIN32) */
+        json.WriteInteger("hardware_threads", std::thread::hardware_concurrency());
+        json.EndObject();
+
+        try
+        {
+            for (const std::string& benchmark : benchmarks)
+            {
+                if (!RunBenchmark(commandLine, benchmark, json))
+                {
+                    PrintUsage();
+
+                    return 1;
+                }
+            }
+        }
+        catch (const std::exception& exception)
+        {
+            std::cerr << "Error: " << exception.what() << std::endl;
+
+            return 1;
+        }
+
+        json.EndObject();
+
+        const auto outputOption =
+            commandLine.Options.find("output");
+
+        if (commandLine.Options.end() == outputOption)
+        {
+            std::cout << json.GetText() << std::endl;
+
+            return 0;
+        }
+
+        std::ofstream output(
+            outputOption->second,
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+        output << json.GetText() << '\n';
+
+        if (!output)
+        {
+            std::cerr << "Cannot write " << outputOption->second << std::endl;
+
+            return 1;
+        }
+
+        return 0;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(
+    _In_ int argc,
+    _In_reads_(argc) wchar_t* argv[])
+{
+    std::vector<std::string> arguments;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        arguments.push_back(
+            Utf16ToUtf8(argv[i]));
+    }
+
+    return Run(arguments);
+}
+#else
+int main(
+    _In_ int argc,
+    _In_reads_(argc) char* argv[])
+{
+    return Run(
+        std::vector<std::string>(argv + 1, argv + argc));
+}
+#endif /* defined(_WIN32) */
@@ -0,0 +1,70 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif /* !defined(WIN32_LEAN_AND_MEAN) */
+
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif /* !defined(NOMINMAX) */
+
+#include <Windows.h>
+#endif /* defined(_WIN32) */
+
+#define DBG_ENABLE_ERROR_LOGGING 1
+#define DBG_ENABLE_INFORMATIONAL_LOGGING 1
+#define DBG_ENABLE_VERBOSE_LOGGING 0
+
+#include <Debugging/All.h>
+
+//
+// Only the parts of the Io library that do not depend on the Windows Runtime are built
+// with CMake (see Shared/Io/CMakeLists.txt).
+//
+#include <Io/MappedFile.h>
+#include <Io/ChunkedFileReader.h>
+#include <Io/StringHelpers.h>
+#include <Io/CsvWriter.h>
+
+//
+// The pipeline and projection benchmarks need the Playback library, which is only built when OpenCV is
+// found (see CMakeLists.txt).
+//
+#if ENABLE_PIPELINE_BENCHMARKS
+#include <Playback/All.h>
+#endif /* ENABLE_PIPELINE_BENCHMARKS */
+
+#include "JsonWriter.h"
+#include "FileLoadingBenchmark.h"
+#include "PipelineBenchmarks.h"
+#include "ProjectionBenchmark.h"
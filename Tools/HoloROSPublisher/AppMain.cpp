@@ -25,6 +25,10 @@ using namespace std::placeholders;
 
 #define RENDER_PREVIEW_HOLOGRAM
 
+// Uncomment to write a Chrome trace of the profiler spans to the app's local folder,
+// from launch until the app is suspended.
+//#define CAPTURE_PROFILER_TRACE
+
 // Only enable PhotoVideo & ShortThrowDepth sensors.
 std::vector<HoloLensForCV::SensorType> kEnabledSensorTypes = {
     HoloLensForCV::SensorType::PhotoVideo,
@@ -39,6 +43,17 @@ namespace HoloROSPublisher
         , _photoVideoMediaFrameSourceGroupStarted(false)
         , _researchModeMediaFrameSourceGroupStarted(false)
     {
+        //
+        // Serve the pipeline metrics, e.g. curl http://<hololens>:10090/metrics
+        //
+        _metricsServer =
+            ref new HoloLensForCV::MetricsServer(L"10090");
+
+#ifdef CAPTURE_PROFILER_TRACE
+        dbg::Profiler::StartFlushing(
+            std::wstring(Windows::Storage::ApplicationData::Current->LocalFolder->Path->Data()) +
+            L"\\profiler_trace.json");
+#endif // CAPTURE_PROFILER_TRACE
     }
 
     void AppMain::OnHolographicSpaceChanged(
@@ -69,8 +84,8 @@ namespace HoloROSPublisher
         _In_ Windows::Graphics::Holographic::HolographicFrame^ holographicFrame,
         _In_ const Graphics::StepTimer& stepTimer)
     {
-        dbg::TimerGuard timerGuard(
-            L"AppMain::OnUpdate",
+        DBG_PROFILE_SPAN_REPORT_OVER(
+            "AppMain::OnUpdate",
             30.0 /* minimum_time_elapsed_in_milliseconds */);
 
         if (!_photoVideoMediaFrameSourceGroupStarted)
@@ -163,6 +178,9 @@ namespace HoloROSPublisher
     // current application and spatial positioning state.
     void AppMain::OnRender()
     {
+        DBG_PROFILE_SPAN(
+            "AppMain::OnRender");
+
 #ifdef RENDER_PREVIEW_HOLOGRAM
         // Draw the sample hologram.
         _previewRenderer->Render(
@@ -200,6 +218,10 @@ namespace HoloROSPublisher
 	// Called when the application is suspending.
 	void AppMain::SaveAppState()
 	{
+#ifdef CAPTURE_PROFILER_TRACE
+        dbg::Profiler::StopFlushing();
+#endif // CAPTURE_PROFILER_TRACE
+
         if (_photoVideoMediaFrameSourceGroup == nullptr ||
             _researchModeMediaFrameSourceGroup == nullptr)
         {
@@ -59,6 +59,9 @@ namespace HoloROSPublisher
         // HoloLens media frame server manager
         HoloLensForCV::ROSSensorFrameStreamer^ _sensorFrameStreamer;
 
+        // Pipeline metrics endpoint
+        HoloLensForCV::MetricsServer^ _metricsServer;
+
         // Camera preview
         std::unique_ptr<Rendering::SlateRenderer> _previewRenderer;
         Rendering::Texture2DPtr _previewTexture;
@@ -0,0 +1,1023 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace RecordingConverter
+{
+    namespace
+    {
+        const char c_orbFeaturesMagic[] = { 'O', 'R', 'B', '1' };
+
+        //
+        // COLMAP's OPENCV camera model: fx, fy, cx, cy, k1, k2, p1, p2.
+        //
+        const int c_colmapOpenCvCameraModelId = 4;
+        const size_t c_numberOfOpenCvCameraParameters = 8;
+
+        const uint64_t c_cameraWidth = 640;
+        const uint64_t c_cameraHeight = 480;
+
+        struct CameraIntrinsics
+        {
+            const char* SensorName;
+            double Parameters[c_numberOfOpenCvCameraParameters];
+        };
+
+        //
+        // Same as in recorder_console.py: determined for a specific HoloLens with COLMAP's
+        // self-calibration, and refined by the reconstruction.
+        //
+        const CameraIntrinsics c_cameraIntrinsics[] =
+        {
+            { "vlc_ll", { 450.072070, 450.274345, 320, 240, -0.013211, 0.012778, -0.002714, -0.003603 } },
+            { "vlc_lf", { 448.189452, 452.478090, 320, 240, -0.009463, 0.003013, -0.006169, -0.008975 } },
+            { "vlc_rf", { 449.435779, 453.332057, 320, 240, -0.000305, -0.013207, 0.003258, 0.001051 } },
+            { "vlc_rr", { 450.301002, 450.244147, 320, 240, -0.010926, 0.008377, -0.003105, -0.004976 } },
+        };
+
+        const CameraIntrinsics* FindCameraIntrinsics(
+            _In_ const std::string& sensorName)
+        {
+            for (const CameraIntrinsics& cameraIntrinsics : c_cameraIntrinsics)
+            {
+                if (sensorName == cameraIntrinsics.SensorName)
+                {
+                    return &cameraIntrinsics;
+                }
+            }
+
+            return nullptr;
+        }
+
+        uint32_t CountBits(
+            _In_ uint64_t value)
+        {
+#if defined(_MSC_VER)
+#if defined(_M_X64)
+            return static_cast<uint32_t>(
+                __popcnt64(value));
+#else
+            return
+                __popcnt(static_cast<uint32_t>(value)) +
+                __popcnt(static_cast<uint32_t>(value >> 32));
+#endif /* defined(_M_X64) */
+#else
+            return static_cast<uint32_t>(
+                __builtin_popcountll(value));
+#endif /* defined(_MSC_VER) */
+        }
+
+        uint64_t LoadWord(
+            _In_reads_bytes_(sizeof(uint64_t)) const uint8_t* data)
+        {
+            uint64_t word;
+
+            std::memcpy(
+                &word,
+                data,
+                sizeof(word));
+
+            return word;
+        }
+
+        uint32_t GetHammingDistance(
+            _In_reads_bytes_(size) const uint8_t* descriptor1,
+            _In_reads_bytes_(size) const uint8_t* descriptor2,
+            _In_ uint32_t size)
+        {
+            uint32_t distance = 0;
+            uint32_t i = 0;
+
+            for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+            {
+                distance += CountBits(LoadWord(descriptor1 + i) ^ LoadWord(descriptor2 + i));
+            }
+
+            for (; i < size; ++i)
+            {
+                distance += CountBits(descriptor1[i] ^ descriptor2[i]);
+            }
+
+            return distance;
+        }
+
+        //
+        // ORB descriptors are 32 bytes; spelled out, this is much faster than the loop above.
+        //
+        uint32_t GetHammingDistance32(
+            _In_reads_bytes_(32) const uint8_t* descriptor1,
+            _In_reads_bytes_(32) const uint8_t* descriptor2)
+        {
+            return
+                CountBits(LoadWord(descriptor1) ^ LoadWord(descriptor2)) +
+                CountBits(LoadWord(descriptor1 + 8) ^ LoadWord(descriptor2 + 8)) +
+                CountBits(LoadWord(descriptor1 + 16) ^ LoadWord(descriptor2 + 16)) +
+                CountBits(LoadWord(descriptor1 + 24) ^ LoadWord(descriptor2 + 24));
+        }
+
+        //
+        // One pass over all pairs of features finds the best and second best match of each
+        // feature of the first image, and the best match of each feature of the second image
+        // for the mutual check, without keeping the whole distance matrix. Ties go to the
+        // first feature, as with numpy's argmin.
+        //
+        template <typename DistanceFunction>
+        void FindBestMatches(
+            _In_ const OrbFeatures& features1,
+            _In_ const OrbFeatures& features2,
+            _In_ size_t count1,
+            _In_ size_t count2,
+            _In_ const DistanceFunction& getDistance,
+            _Inout_ ColmapExporter::MatchingStorage& storage)
+        {
+            const uint32_t descriptorSize = features1.DescriptorSize;
+
+            storage.Distances.resize(count2);
+            storage.BestMatches1.resize(count1);
+            storage.SecondBestDistances1.resize(count1);
+            storage.BestMatches2.assign(count2, 0);
+            storage.BestDistances2.assign(count2, UINT32_MAX);
+
+            //
+            // The distances are computed a row at a time and then reduced, which keeps the
+            // loops simple enough for the compiler to unroll.
+            //
+            uint32_t* const distances = storage.Distances.data();
+
+            for (size_t i = 0; i < count1; ++i)
+            {
+                const uint8_t* descriptor1 = features1.Descriptors.data() + i * descriptorSize;
+
+                for (size_t j = 0; j < count2; ++j)
+                {
+                    distances[j] =
+                        getDistance(
+                            descriptor1,
+                            features2.Descriptors.data() + j * descriptorSize);
+                }
+
+                uint32_t bestMatch = 0;
+                uint32_t bestDistance = UINT32_MAX;
+                uint32_t secondBestDistance = UINT32_MAX;
+
+                for (size_t j = 0; j < count2; ++j)
+                {
+                    if (distances[j] < bestDistance)
+                    {
+                        secondBestDistance = bestDistance;
+                        bestDistance = distances[j];
+                        bestMatch = static_cast<uint32_t>(j);
+                    }
+                    else if (distances[j] < secondBestDistance)
+                    {
+                        secondBestDistance = distances[j];
+                    }
+                }
+
+                storage.BestMatches1[i] = std::make_pair(bestMatch, bestDistance);
+                storage.SecondBestDistances1[i] = secondBestDistance;
+
+                for (size_t j = 0; j < count2; ++j)
+                {
+                    if (distances[j] < storage.BestDistances2[j])
+                    {
+                        storage.BestDistances2[j] = distances[j];
+                        storage.BestMatches2[j] = static_cast<uint32_t>(i);
+                    }
+                }
+            }
+    }
+
+        //
+        // result = a * b, for 4x4 matrices.
+        //
+        void Multiply(
+            _In_ const double (&a)[4][4],
+            _In_ const double (&b)[4][4],
+            _Out_ double (&result)[4][4])
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    result[row][column] = 0.0;
+
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        result[row][column] += a[row][k] * b[k][column];
+                    }
+                }
+            }
+        }
+
+        //
+        // Gauss-Jordan elimination with partial pivoting; returns false for singular
+        // matrices.
+        //
+        bool Invert(
+            _In_ const double (&matrix)[4][4],
+            _Out_ double (&inverse)[4][4])
+        {
+            double work[4][8];
+
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    work[row][column] = matrix[row][column];
+                    work[row][4 + column] = row == column ? 1.0 : 0.0;
+                }
+            }
+
+            for (int column = 0; column < 4; ++column)
+            {
+                int pivot = column;
+
+                for (int row = column + 1; row < 4; ++row)
+                {
+                    if (std::abs(work[row][column]) > std::abs(work[pivot][column]))
+                    {
+                        pivot = row;
+                    }
+                }
+
+                if (std::abs(work[pivot][column]) < 1.0e-12)
+                {
+                    return false;
+                }
+
+                std::swap(work[pivot], work[column]);
+
+                const double scale = 1.0 / work[column][column];
+
+                for (int k = 0; k < 8; ++k)
+                {
+                    work[column][k] *= scale;
+                }
+
+                for (int row = 0; row < 4; ++row)
+                {
+                    if (row == column)
+                    {
+                        continue;
+                    }
+
+                    const double factor = work[row][column];
+
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        work[row][k] -= factor * work[column][k];
+                    }
+                }
+            }
+
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    inverse[row][column] = work[row][4 + column];
+                }
+            }
+
+            return true;
+        }
+
+        //
+        // The world-to-camera transform of the image, as read_sensor_poses in
+        // recorder_console.py composes it: the camera-to-frame transform after the inverse
+        // frame-to-origin transform, with y and z flipped from the HoloLens' camera
+        // convention (y up, looking down -z) to COLMAP's (y down, looking down +z).
+        //
+        bool GetWorldToCamera(
+            _In_ const SensorRecordingFrame& frame,
+            _Out_ double (&worldToCamera)[4][4])
+        {
+            double frameToOrigin[4][4];
+            double cameraToFrame[4][4];
+
+            //
+            // The recorded matrices are transposed.
+            //
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    frameToOrigin[row][column] = frame.FrameToOrigin[column * 4 + row];
+                    cameraToFrame[row][column] = frame.CameraViewTransform[column * 4 + row];
+                }
+            }
+
+            double originToFrame[4][4];
+
+            if (!Invert(frameToOrigin, originToFrame))
+            {
+                return false;
+            }
+
+            Multiply(
+                cameraToFrame,
+                originToFrame,
+                worldToCamera);
+
+            for (int column = 0; column < 4; ++column)
+            {
+                worldToCamera[1][column] = -worldToCamera[1][column];
+                worldToCamera[2][column] = -worldToCamera[2][column];
+            }
+
+            return true;
+        }
+
+        //
+        // COLMAP's (w, x, y, z) quaternion of a rotation matrix, with w >= 0.
+        //
+        void GetQuaternion(
+            _In_ const double (&r)[4][4],
+            _Out_ double (&quaternion)[4])
+        {
+            const double trace = r[0][0] + r[1][1] + r[2][2];
+
+            if (trace > 0.0)
+            {
+                const double s = 2.0 * std::sqrt(trace + 1.0);
+
+                quaternion[0] = 0.25 * s;
+                quaternion[1] = (r[2][1] - r[1][2]) / s;
+                quaternion[2] = (r[0][2] - r[2][0]) / s;
+                quaternion[3] = (r[1][0] - r[0][1]) / s;
+            }
+            else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+            {
+                const double s = 2.0 * std::sqrt(1.0 + r[0][0] - r[1][1] - r[2][2]);
+
+                quaternion[0] = (r[2][1] - r[1][2]) / s;
+                quaternion[1] = 0.25 * s;
+                quaternion[2] = (r[0][1] + r[1][0]) / s;
+                quaternion[3] = (r[0][2] + r[2][0]) / s;
+            }
+            else if (r[1][1] > r[2][2])
+            {
+                const double s = 2.0 * std::sqrt(1.0 + r[1][1] - r[0][0] - r[2][2]);
+
+                quaternion[0] = (r[0][2] - r[2][0]) / s;
+                quaternion[1] = (r[0][1] + r[1][0]) / s;
+                quaternion[2] = 0.25 * s;
+                quaternion[3] = (r[1][2] + r[2][1]) / s;
+            }
+            else
+            {
+                const double s = 2.0 * std::sqrt(1.0 + r[2][2] - r[0][0] - r[1][1]);
+
+                quaternion[0] = (r[1][0] - r[0][1]) / s;
+                quaternion[1] = (r[0][2] + r[2][0]) / s;
+                quaternion[2] = (r[1][2] + r[2][1]) / s;
+                quaternion[3] = 0.25 * s;
+            }
+
+            const double norm =
+                std::sqrt(
+                    quaternion[0] * quaternion[0] + quaternion[1] * quaternion[1] +
+                    quaternion[2] * quaternion[2] + quaternion[3] * quaternion[3]);
+
+            const double sign =
+                quaternion[0] < 0.0 ? -1.0 : 1.0;
+
+            for (double& component : quaternion)
+            {
+                component *= sign / norm;
+            }
+        }
+
+        //
+        // COLMAP's binary models are little-endian, like all the platforms this builds for.
+        //
+        template <typename T>
+        void WriteBinary(
+            _Inout_ std::string& data,
+            _In_ T value)
+        {
+            static_assert(std::is_arithmetic<T>::value, "Only numbers are written as is.");
+
+            data.append(
+                reinterpret_cast<const char*>(&value),
+                sizeof(value));
+        }
+
+        bool WriteFile(
+            _In_ const std::filesystem::path& fileName,
+            _In_ const std::string& data)
+        {
+            std::ofstream file(
+                fileName,
+                std::ios::out | std::ios::binary | std::ios::trunc);
+
+            file.write(
+                data.data(),
+                static_cast<std::streamsize>(data.size()));
+
+            file.close();
+
+            if (!file)
+            {
+                std::cerr << "Failed to write " << fileName.u8string() << std::endl;
+
+                return false;
+            }
+
+            return true;
+        }
+
+        //
+        // Images are numbered across frames, in the order of the image list.
+        //
+        void GetImageNames(
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _Out_ std::vector<std::string>& imageNames,
+            _Out_ std::vector<size_t>& firstImageIndices)
+        {
+            imageNames.clear();
+            firstImageIndices.clear();
+
+            for (const SynchronizedFrame& frame : frames)
+            {
+                firstImageIndices.push_back(
+                    imageNames.size());
+
+                for (const SynchronizedImage& image : frame.Images)
+                {
+                    imageNames.push_back(
+                        FrameSynchronizer::GetImageName(frame, image));
+                }
+            }
+        }
+    }
+
+    OrbFeatures::OrbFeatures()
+        : DescriptorSize(0)
+    {
+    }
+
+    ColmapExporter::Options::Options()
+        : FeatureMatchWindow(10)
+        , MaxRatio(0.8)
+        , MaxDistance(64)
+    {
+    }
+
+    ColmapExporter::ColmapExporter(
+        _In_ const Options& options,
+        _In_ uint32_t numberOfThreads)
+        : _options(options)
+        , _numberOfThreads(std::max<uint32_t>(numberOfThreads, 1))
+    {
+    }
+
+    bool ColmapExporter::WriteImageList(
+        _In_ const std::vector<SynchronizedFrame>& frames,
+        _In_ const std::filesystem::path& fileName) const
+    {
+        std::vector<std::string> imageNames;
+        std::vector<size_t> firstImageIndices;
+
+        GetImageNames(
+            frames,
+            imageNames,
+            firstImageIndices);
+
+        std::string imageList;
+
+        for (const std::string& imageName : imageNames)
+        {
+            imageList += imageName;
+            imageList += '\n';
+        }
+
+        return WriteFile(
+            fileName,
+            imageList);
+    }
+
+    bool ColmapExporter::HasFeatures(
+        _In_ const std::vector<SynchronizedFrame>& frames,
+        _In_ const std::filesystem::path& imageFolder) const
+    {
+        std::vector<std::string> imageNames;
+        std::vector<size_t> firstImageIndices;
+
+        GetImageNames(
+            frames,
+            imageNames,
+            firstImageIndices);
+
+        std::error_code error;
+
+        for (const std::string& imageName : imageNames)
+        {
+            if (!std::filesystem::exists(imageFolder / std::filesystem::u8path(SensorRecording::GetFeaturesFileName(imageName)), error))
+            {
+                return false;
+            }
+        }
+
+        return !imageNames.empty();
+    }
+
+    bool ColmapExporter::WriteFeatures(
+        _In_ const std::vector<SensorRecording>& recordings,
+        _In_ const std::vector<SynchronizedFrame>& frames,
+        _In_ const std::filesystem::path& imageFolder,
+        _In_ const std::filesystem::path& featuresFolder,
+        _In_ const std::filesystem::path& matchesFileName) const
+    {
+        std::vector<std::string> imageNames;
+        std::vector<size_t> firstImageIndices;
+
+        GetImageNames(
+            frames,
+            imageNames,
+            firstImageIndices);
+
+        for (const SensorRecording& recording : recordings)
+        {
+            std::error_code error;
+
+            std::filesystem::create_directories(
+                featuresFolder / std::filesystem::u8path(recording.GetSensorName()),
+                error);
+
+            if (error)
+            {
+                std::cerr << "Failed to create the features folder: " << error.message() << std::endl;
+
+                return false;
+            }
+        }
+
+        //
+        // Convert the features of each sensor on its own thread. Only the descriptors are
+        // kept for matching.
+        //
+        std::vector<OrbFeatures> features(
+            imageNames.size());
+
+        std::atomic<uint32_t> numberOfFailures(0);
+        std::vector<std::thread> threads;
+
+        for (const SensorRecording& recording : recordings)
+        {
+            threads.emplace_back(
+                [&, sensor = &recording]()
+            {
+                for (size_t frameIndex = 0; frameIndex < frames.size(); ++frameIndex)
+                {
+                    const std::vector<SynchronizedImage>& images =
+                        frames[frameIndex].Images;
+
+                    for (size_t i = 0; i < images.size(); ++i)
+                    {
+                        if (sensor != images[i].Recording)
+                        {
+                            continue;
+                        }
+
+                        const size_t imageIndex = firstImageIndices[frameIndex] + i;
+                        const std::string& imageName = imageNames[imageIndex];
+                        OrbFeatures& imageFeatures = features[imageIndex];
+
+                        if (!ReadOrbFeatures(imageFolder / std::filesystem::u8path(SensorRecording::GetFeaturesFileName(imageName)), imageFeatures) ||
+                            !WriteFile(featuresFolder / std::filesystem::u8path(imageName + ".txt"), FormatFeatures(imageFeatures)))
+                        {
+                            ++numberOfFailures;
+
+                            continue;
+                        }
+
+                        imageFeatures.Keypoints = std::vector<OrbKeypoint>();
+                    }
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (0 != numberOfFailures)
+        {
+            std::cerr << "Failed to convert the features of " << numberOfFailures << " images" << std::endl;
+
+            return false;
+        }
+
+        //
+        // Then match them, a frame per thread at a time, and list the matches in order.
+        //
+        std::vector<std::string> frameMatches(
+            frames.size());
+
+        std::atomic<size_t> nextFrame(0);
+
+        threads.clear();
+
+        for (uint32_t i = 0; i < std::min<size_t>(_numberOfThreads, std::max<size_t>(frames.size(), 1)); ++i)
+        {
+            threads.emplace_back(
+                [&]()
+            {
+                for (size_t frameIndex = nextFrame++; frameIndex < frames.size(); frameIndex = nextFrame++)
+                {
+                    frameMatches[frameIndex] =
+                        FormatFrameMatches(
+                            frames,
+                            imageNames,
+                            features,
+                            firstImageIndices,
+                            frameIndex);
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::ofstream matchesFile(
+            matchesFileName,
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+        for (const std::string& matches : frameMatches)
+        {
+            matchesFile.write(
+                matches.data(),
+                static_cast<std::streamsize>(matches.size()));
+        }
+
+        matchesFile.close();
+
+        if (!matchesFile)
+        {
+            std::cerr << "Failed to write " << matchesFileName.u8string() << std::endl;
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool ColmapExporter::WriteModel(
+        _In_ const std::vector<SensorRecording>& recordings,
+        _In_ const std::vector<SynchronizedFrame>& frames,
+        _In_ const std::filesystem::path& modelFolder) const
+    {
+        std::error_code error;
+
+        std::filesystem::create_directories(
+            modelFolder,
+            error);
+
+        if (error)
+        {
+            std::cerr << "Failed to create " << modelFolder.u8string() << ": " << error.message() << std::endl;
+
+            return false;
+        }
+
+        std::string cameras;
+
+        WriteBinary<uint64_t>(cameras, recordings.size());
+
+        for (size_t i = 0; i < recordings.size(); ++i)
+        {
+            const CameraIntrinsics* cameraIntrinsics =
+                FindCameraIntrinsics(recordings[i].GetSensorName());
+
+            if (nullptr == cameraIntrinsics)
+            {
+                std::cerr << "No camera parameters for " << recordings[i].GetSensorName() << std::endl;
+
+                return false;
+            }
+
+            WriteBinary<uint32_t>(cameras, static_cast<uint32_t>(i + 1));
+            WriteBinary<int32_t>(cameras, c_colmapOpenCvCameraModelId);
+            WriteBinary<uint64_t>(cameras, c_cameraWidth);
+            WriteBinary<uint64_t>(cameras, c_cameraHeight);
+
+            for (const double parameter : cameraIntrinsics->Parameters)
+            {
+                WriteBinary<double>(cameras, parameter);
+            }
+        }
+
+        std::vector<std::string> imageNames;
+        std::vector<size_t> firstImageIndices;
+
+        GetImageNames(
+            frames,
+            imageNames,
+            firstImageIndices);
+
+        std::string images;
+
+        WriteBinary<uint64_t>(images, imageNames.size());
+
+        for (size_t frameIndex = 0; frameIndex < frames.size(); ++frameIndex)
+        {
+            const std::vector<SynchronizedImage>& frameImages =
+                frames[frameIndex].Images;
+
+            for (size_t i = 0; i < frameImages.size(); ++i)
+            {
+                const size_t imageIndex =
+                    firstImageIndices[frameIndex] + i;
+
+                const size_t cameraIndex =
+                    static_cast<size_t>(frameImages[i].Recording - recordings.data());
+
+                double worldToCamera[4][4];
+                double quaternion[4];
+
+                if (!GetWorldToCamera(*frameImages[i].Frame, worldToCamera))
+                {
+                    std::cerr << "Invalid pose for " << imageNames[imageIndex] << std::endl;
+
+                    return false;
+                }
+
+                GetQuaternion(
+                    worldToCamera,
+                    quaternion);
+
+                WriteBinary<uint32_t>(images, static_cast<uint32_t>(imageIndex + 1));
+
+                for (const double component : quaternion)
+                {
+                    WriteBinary<double>(images, component);
+                }
+
+                for (int row = 0; row < 3; ++row)
+                {
+                    WriteBinary<double>(images, worldToCamera[row][3]);
+                }
+
+                WriteBinary<uint32_t>(images, static_cast<uint32_t>(cameraIndex + 1));
+
+                images.append(
+                    imageNames[imageIndex].c_str(),
+                    imageNames[imageIndex].size() + 1 /* null terminator */);
+
+                //
+                // The points are triangulated by COLMAP.
+                //
+                WriteBinary<uint64_t>(images, 0);
+            }
+        }
+
+        std::string points;
+
+        WriteBinary<uint64_t>(points, 0);
+
+        return
+            WriteFile(modelFolder / "cameras.bin", cameras) &&
+            WriteFile(modelFolder / "images.bin", images) &&
+            WriteFile(modelFolder / "points3D.bin", points);
+    }
+
+    /* static */ bool ColmapExporter::ReadOrbFeatures(
+        _In_ const std::filesystem::path& fileName,
+        _Out_ OrbFeatures& features)
+    {
+        features = OrbFeatures();
+
+        Io::MappedFile file;
+
+        if (!file.Open(fileName.u8string()))
+        {
+            std::cerr << "Failed to open " << fileName.u8string() << std::endl;
+
+            return false;
+        }
+
+        const Io::ByteSpan data =
+            file.GetSpan();
+
+        const size_t headerSize =
+            sizeof(c_orbFeaturesMagic) + 2 * sizeof(uint32_t);
+
+        uint32_t numberOfKeypoints = 0;
+
+        if (data.Size >= headerSize &&
+            0 == std::memcmp(data.Data, c_orbFeaturesMagic, sizeof(c_orbFeaturesMagic)))
+        {
+            std::memcpy(&numberOfKeypoints, data.Data + sizeof(c_orbFeaturesMagic), sizeof(uint32_t));
+            std::memcpy(&features.DescriptorSize, data.Data + sizeof(c_orbFeaturesMagic) + sizeof(uint32_t), sizeof(uint32_t));
+        }
+
+        const uint64_t keypointsSize =
+            static_cast<uint64_t>(numberOfKeypoints) * sizeof(OrbKeypoint);
+
+        const uint64_t descriptorsSize =
+            static_cast<uint64_t>(numberOfKeypoints) * features.DescriptorSize;
+
+        if (data.Size < headerSize || data.Size != headerSize + keypointsSize + descriptorsSize)
+        {
+            std::cerr << fileName.u8string() << " is not a features file" << std::endl;
+
+            return false;
+        }
+
+        features.Keypoints.resize(
+            numberOfKeypoints);
+
+        std::memcpy(
+            features.Keypoints.data(),
+            data.Data + headerSize,
+            static_cast<size_t>(keypointsSize));
+
+        features.Descriptors.assign(
+            data.Data + headerSize + keypointsSize,
+            data.Data + data.Size);
+
+        return true;
+    }
+
+    void ColmapExporter::MatchOrbFeatures(
+        _In_ const OrbFeatures& features1,
+        _In_ const OrbFeatures& features2,
+        _Inout_ MatchingStorage& storage,
+        _Out_ std::vector<std::pair<uint32_t, uint32_t>>& matches) const
+    {
+        matches.clear();
+
+        const uint32_t descriptorSize = features1.DescriptorSize;
+
+        if (0 == descriptorSize || descriptorSize != features2.DescriptorSize)
+        {
+            return;
+        }
+
+        const size_t count1 = features1.Descriptors.size() / descriptorSize;
+        const size_t count2 = features2.Descriptors.size() / descriptorSize;
+
+        if (0 == count1 || 0 == count2)
+        {
+            return;
+        }
+
+        if (32 == descriptorSize)
+        {
+            FindBestMatches(
+                features1,
+                features2,
+                count1,
+                count2,
+                [](const uint8_t* descriptor1, const uint8_t* descriptor2)
+            {
+                return GetHammingDistance32(descriptor1, descriptor2);
+            },
+                storage);
+        }
+        else
+        {
+            FindBestMatches(
+                features1,
+                features2,
+                count1,
+                count2,
+                [descriptorSize](const uint8_t* descriptor1, const uint8_t* descriptor2)
+            {
+                return GetHammingDistance(descriptor1, descriptor2, descriptorSize);
+            },
+                storage);
+        }
+
+        for (size_t i = 0; i < count1; ++i)
+        {
+            const uint32_t bestMatch = storage.BestMatches1[i].first;
+            const uint32_t bestDistance = storage.BestMatches1[i].second;
+
+            //
+            // A single feature in the second image always passes the ratio test.
+            //
+            const bool passesRatioTest =
+                UINT32_MAX == storage.SecondBestDistances1[i] ||
+                bestDistance < _options.MaxRatio * storage.SecondBestDistances1[i];
+
+            if (i == storage.BestMatches2[bestMatch] &&
+                bestDistance <= _options.MaxDistance &&
+                passesRatioTest)
+            {
+                matches.emplace_back(
+                    static_cast<uint32_t>(i),
+                    bestMatch);
+            }
+        }
+    }
+
+    /* static */ std::string ColmapExporter::FormatFeatures(
+        _In_ const OrbFeatures& features)
+    {
+        //
+        // COLMAP only imports SIFT-like features; the binary descriptors are matched here
+        // and replaced by zeros. COLMAP places the center of the first pixel at (0.5, 0.5),
+        // and wants the scale relative to a 31 pixel patch and the orientation in radians.
+        //
+        static const double c_radiansPerDegree = 3.14159265358979323846 / 180.0;
+
+        std::string text;
+
+        text.reserve(
+            (features.Keypoints.size() + 1) * (4 * Io::MaximumNumberLength + 2 * 128));
+
+        Io::AppendNumber(features.Keypoints.size(), text);
+        text += " 128\n";
+
+        for (const OrbKeypoint& keypoint : features.Keypoints)
+        {
+            Io::AppendNumber(keypoint.X + 0.5, text);
+            text += ' ';
+            Io::AppendNumber(keypoint.Y + 0.5, text);
+            text += ' ';
+            Io::AppendNumber(keypoint.Size / 31.0, text);
+            text += ' ';
+            Io::AppendNumber(keypoint.Angle * c_radiansPerDegree, text);
+
+            for (int i = 0; i < 128; ++i)
+            {
+                text += " 0";
+            }
+
+            text += '\n';
+        }
+
+        return text;
+    }
+
+    std::string ColmapExporter::FormatFrameMatches(
+        _In_ const std::vector<SynchronizedFrame>& frames,
+        _In_ const std::vector<std::string>& imageNames,
+        _In_ const std::vector<OrbFeatures>& features,
+        _In_ const std::vector<size_t>& firstImageIndices,
+        _In_ size_t frameIndex) const
+    {
+        //
+        // Each image of the frame is matched with the images after it in the frame, and
+        // with those of the following frames, in the order recorder_console.py uses.
+        //
+        const size_t endFrameIndex =
+            0 == _options.FeatureMatchWindow ?
+                frames.size() :
+                std::min<size_t>(frames.size(), frameIndex + _options.FeatureMatchWindow + 1);
+
+        const size_t endImageIndex =
+            endFrameIndex < frames.size() ?
+                firstImageIndices[endFrameIndex] :
+                imageNames.size();
+
+        std::string text;
+        MatchingStorage storage;
+        std::vector<std::pair<uint32_t, uint32_t>> matches;
+
+        for (size_t image1 = firstImageIndices[frameIndex];
+            image1 < firstImageIndices[frameIndex] + frames[frameIndex].Images.size();
+            ++image1)
+        {
+            for (size_t image2 = image1 + 1; image2 < endImageIndex; ++image2)
+            {
+                MatchOrbFeatures(
+                    features[image1],
+                    features[image2],
+                    storage,
+                    matches);
+
+                text += imageNames[image1];
+                text += ' ';
+                text += imageNames[image2];
+                text += '\n';
+
+                for (const std::pair<uint32_t, uint32_t>& match : matches)
+                {
+                    Io::AppendNumber(match.first, text);
+                    text += ' ';
+                    Io::AppendNumber(match.second, text);
+                    text += '\n';
+                }
+
+                text += '\n';
+            }
+        }
+
+        return text;
+    }
+}
@@ -0,0 +1,152 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace RecordingConverter
+{
+    //
+    // A keypoint as SerializeImageFeatures writes it.
+    //
+    struct OrbKeypoint
+    {
+        float X;
+        float Y;
+        float Size;
+        float Angle;
+        float Response;
+        int32_t Octave;
+    };
+
+    //
+    // The recorded features of an image: "ORB1", the number of keypoints and the size of
+    // their descriptors, the keypoints, then their descriptors.
+    //
+    struct OrbFeatures
+    {
+        OrbFeatures();
+
+        std::vector<OrbKeypoint> Keypoints;
+
+        uint32_t DescriptorSize;
+        std::vector<uint8_t> Descriptors;
+    };
+
+    //
+    // Writes what COLMAP reconstructs a synchronized dataset from, in place of the text
+    // files recorder_console.py's reconstruct_recording writes:
+    //
+    //  - image_list.txt, with the images in the order COLMAP assigns their ids in.
+    //  - The recorded features in the format of COLMAP's feature_importer, and their
+    //    matches in the format of its matches_importer (raw).
+    //  - A binary model (cameras.bin, images.bin and an empty points3D.bin) with the poses
+    //    of the images composed from FrameToOrigin and CameraViewTransform.
+    //
+    // Camera ids follow the order the sensors were given in, and image ids that of the
+    // image list, both starting at 1; the feature database has to use the same ids.
+    //
+    class ColmapExporter
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            // Number of following frames the features of a frame are matched with; zero
+            // matches all the frames.
+            uint32_t FeatureMatchWindow;
+
+            // Ratio test between the best and second best match of a feature.
+            double MaxRatio;
+
+            // Hamming distance above which descriptors are not matched.
+            uint32_t MaxDistance;
+        };
+
+        ColmapExporter(
+            _In_ const Options& options,
+            _In_ uint32_t numberOfThreads);
+
+        bool WriteImageList(
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _In_ const std::filesystem::path& fileName) const;
+
+        //
+        // Whether the features of all images were recorded, i.e. are in the image folder.
+        //
+        bool HasFeatures(
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _In_ const std::filesystem::path& imageFolder) const;
+
+        //
+        // Converts the features of each sensor on its own thread, then matches them on
+        // all threads.
+        //
+        bool WriteFeatures(
+            _In_ const std::vector<SensorRecording>& recordings,
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _In_ const std::filesystem::path& imageFolder,
+            _In_ const std::filesystem::path& featuresFolder,
+            _In_ const std::filesystem::path& matchesFileName) const;
+
+        bool WriteModel(
+            _In_ const std::vector<SensorRecording>& recordings,
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _In_ const std::filesystem::path& modelFolder) const;
+
+        static bool ReadOrbFeatures(
+            _In_ const std::filesystem::path& fileName,
+            _Out_ OrbFeatures& features);
+
+        //
+        // Reused across calls to MatchOrbFeatures, to not allocate for each pair of images.
+        //
+        struct MatchingStorage
+        {
+            // Distances from a feature of the first image to those of the second.
+            std::vector<uint32_t> Distances;
+
+            // Per feature of the first image: its best match, the distance to it, and the
+            // distance to the second best match.
+            std::vector<std::pair<uint32_t, uint32_t>> BestMatches1;
+            std::vector<uint32_t> SecondBestDistances1;
+
+            // Per feature of the second image.
+            std::vector<uint32_t> BestMatches2;
+            std::vector<uint32_t> BestDistances2;
+        };
+
+        //
+        // Mutual nearest neighbors by Hamming distance that pass the ratio test, like
+        // recorder_console.py's match_orb_features.
+        //
+        void MatchOrbFeatures(
+            _In_ const OrbFeatures& features1,
+            _In_ const OrbFeatures& features2,
+            _Inout_ MatchingStorage& storage,
+            _Out_ std::vector<std::pair<uint32_t, uint32_t>>& matches) const;
+
+    private:
+        static std::string FormatFeatures(
+            _In_ const OrbFeatures& features);
+
+        std::string FormatFrameMatches(
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _In_ const std::vector<std::string>& imageNames,
+            _In_ const std::vector<OrbFeatures>& features,
+            _In_ const std::vector<size_t>& firstImageIndices,
+            _In_ size_t frameIndex) const;
+
+    private:
+        const Options _options;
+        const uint32_t _numberOfThreads;
+    };
+}
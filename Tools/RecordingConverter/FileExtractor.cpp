@@ -0,0 +1,221 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace RecordingConverter
+{
+    ExtractionJob::ExtractionJob()
+        : Recording(nullptr)
+        , ArchiveOffset(0)
+        , ArchiveSize(0)
+        , Link(false)
+    {
+    }
+
+    ExtractionStatistics::ExtractionStatistics()
+        : NumberOfFiles(0)
+        , NumberOfLinks(0)
+        , NumberOfBytes(0)
+        , NumberOfFailures(0)
+        , Seconds(0.0)
+    {
+    }
+
+    FileExtractor::FileExtractor(
+        _In_ uint32_t numberOfThreads)
+        : _numberOfThreads(std::max<uint32_t>(numberOfThreads, 1))
+    {
+    }
+
+    /* static */ uint32_t FileExtractor::GetDefaultNumberOfThreads()
+    {
+        //
+        // The work is bound by the file system rather than the CPU, so a few more threads
+        // than cores keep it busy.
+        //
+        return std::min<uint32_t>(
+            2 * std::max<uint32_t>(std::thread::hardware_concurrency(), 1),
+            16);
+    }
+
+    bool FileExtractor::Run(
+        _In_ const std::vector<ExtractionJob>& jobs,
+        _Out_ ExtractionStatistics& statistics) const
+    {
+        statistics = ExtractionStatistics();
+
+        const std::chrono::steady_clock::time_point startTime =
+            std::chrono::steady_clock::now();
+
+        //
+        // Create the folders up front, so that threads do not race to create them.
+        //
+        std::set<std::filesystem::path> folders;
+
+        for (const ExtractionJob& job : jobs)
+        {
+            folders.insert(
+                job.DestinationFileName.parent_path());
+        }
+
+        for (const std::filesystem::path& folder : folders)
+        {
+            std::error_code error;
+
+            if (!folder.empty())
+            {
+                std::filesystem::create_directories(
+                    folder,
+                    error);
+            }
+
+            if (error)
+            {
+                std::cerr << "Failed to create " << folder.u8string() << ": " << error.message() << std::endl;
+
+                return false;
+            }
+        }
+
+        const uint32_t numberOfThreads =
+            static_cast<uint32_t>(
+                std::min<size_t>(_numberOfThreads, std::max<size_t>(jobs.size(), 1)));
+
+        std::atomic<size_t> nextJob(0);
+
+        std::vector<ExtractionStatistics> threadStatistics(
+            numberOfThreads);
+
+        std::vector<std::thread> threads;
+
+        for (uint32_t i = 0; i < numberOfThreads; ++i)
+        {
+            threads.emplace_back(
+                [this, &jobs, &nextJob, &threadStatistics, i]()
+            {
+                std::vector<uint8_t> storage;
+
+                for (size_t job = nextJob++; job < jobs.size(); job = nextJob++)
+                {
+                    if (!RunJob(jobs[job], storage, threadStatistics[i]))
+                    {
+                        ++threadStatistics[i].NumberOfFailures;
+                    }
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const ExtractionStatistics& threadStatistic : threadStatistics)
+        {
+            statistics.NumberOfFiles += threadStatistic.NumberOfFiles;
+            statistics.NumberOfLinks += threadStatistic.NumberOfLinks;
+            statistics.NumberOfBytes += threadStatistic.NumberOfBytes;
+            statistics.NumberOfFailures += threadStatistic.NumberOfFailures;
+        }
+
+        statistics.Seconds =
+            std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - startTime).count();
+
+        return 0 == statistics.NumberOfFailures;
+    }
+
+    bool FileExtractor::RunJob(
+        _In_ const ExtractionJob& job,
+        _Inout_ std::vector<uint8_t>& storage,
+        _Inout_ ExtractionStatistics& statistics) const
+    {
+        std::error_code error;
+
+        if (nullptr == job.Recording)
+        {
+            if (job.Link)
+            {
+                std::filesystem::remove(
+                    job.DestinationFileName,
+                    error);
+
+                std::filesystem::create_hard_link(
+                    job.SourceFileName,
+                    job.DestinationFileName,
+                    error);
+
+                if (!error)
+                {
+                    ++statistics.NumberOfLinks;
+
+                    return true;
+                }
+
+                //
+                // E.g. across volumes, or on FAT32: fall back to copying.
+                //
+                error.clear();
+            }
+
+            std::filesystem::copy_file(
+                job.SourceFileName,
+                job.DestinationFileName,
+                std::filesystem::copy_options::overwrite_existing,
+                error);
+
+            if (error)
+            {
+                std::cerr << "Failed to copy " << job.SourceFileName.u8string() << ": " << error.message() << std::endl;
+
+                return false;
+            }
+
+            ++statistics.NumberOfFiles;
+            statistics.NumberOfBytes +=
+                std::filesystem::file_size(job.SourceFileName, error);
+
+            return true;
+        }
+
+        Io::ByteSpan data;
+
+        if (!job.Recording->ReadArchiveData(job.ArchiveOffset, job.ArchiveSize, storage, data))
+        {
+            std::cerr << "Failed to read " << job.DestinationFileName.filename().u8string() << " from the archive" << std::endl;
+
+            return false;
+        }
+
+        std::ofstream file(
+            job.DestinationFileName,
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+        file.write(
+            reinterpret_cast<const char*>(data.Data),
+            static_cast<std::streamsize>(data.Size));
+
+        file.close();
+
+        if (!file)
+        {
+            std::cerr << "Failed to write " << job.DestinationFileName.u8string() << std::endl;
+
+            return false;
+        }
+
+        ++statistics.NumberOfFiles;
+        statistics.NumberOfBytes += data.Size;
+
+        return true;
+    }
+}
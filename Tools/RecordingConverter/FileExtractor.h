@@ -0,0 +1,74 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace RecordingConverter
+{
+    //
+    // A file to write: either a file stored in a sensor archive, or one that already exists
+    // on disk (e.g. extracted by an earlier run).
+    //
+    struct ExtractionJob
+    {
+        ExtractionJob();
+
+        // Set for files stored in an archive.
+        const SensorRecording* Recording;
+        uint64_t ArchiveOffset;
+        uint64_t ArchiveSize;
+
+        // Set for files that already exist.
+        std::filesystem::path SourceFileName;
+
+        std::filesystem::path DestinationFileName;
+
+        // Hard-link the source file instead of copying it, where the file system allows.
+        bool Link;
+    };
+
+    struct ExtractionStatistics
+    {
+        ExtractionStatistics();
+
+        uint64_t NumberOfFiles;
+        uint64_t NumberOfLinks;
+        uint64_t NumberOfBytes;
+        uint64_t NumberOfFailures;
+        double Seconds;
+    };
+
+    //
+    // Writes files from several threads. Recordings are made of many small files, so the
+    // time goes into opening and closing them, which threads overlap.
+    //
+    class FileExtractor
+    {
+    public:
+        explicit FileExtractor(
+            _In_ uint32_t numberOfThreads);
+
+        bool Run(
+            _In_ const std::vector<ExtractionJob>& jobs,
+            _Out_ ExtractionStatistics& statistics) const;
+
+        static uint32_t GetDefaultNumberOfThreads();
+
+    private:
+        bool RunJob(
+            _In_ const ExtractionJob& job,
+            _Inout_ std::vector<uint8_t>& storage,
+            _Inout_ ExtractionStatistics& statistics) const;
+
+    private:
+        const uint32_t _numberOfThreads;
+    };
+}
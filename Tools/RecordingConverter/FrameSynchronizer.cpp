@@ -0,0 +1,386 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace RecordingConverter
+{
+    namespace
+    {
+        // Timestamps are in 100 ns units.
+        const double c_timestampsPerSecond = 1.0e7;
+    }
+
+    SynchronizedImage::SynchronizedImage()
+        : Recording(nullptr)
+        , Frame(nullptr)
+    {
+    }
+
+    SynchronizedFrame::SynchronizedFrame()
+        : ReferenceTimestamp(0)
+    {
+    }
+
+    FrameSynchronizer::Options::Options()
+        : ReferenceSensorName("vlc_ll")
+        , FrameRate(5.0)
+        , StartFrame(0)
+        , MaxFrames(0)
+        // A fifth of the 30 Hz frame period, as in recorder_console.py.
+        , MaxTimeDifference(static_cast<uint64_t>(std::ceil(c_timestampsPerSecond / 30.0 / 5.0)))
+    {
+    }
+
+    FrameSynchronizer::FrameSynchronizer(
+        _In_ const Options& options)
+        : _options(options)
+    {
+    }
+
+    bool FrameSynchronizer::Synchronize(
+        _In_ const std::vector<SensorRecording>& recordings,
+        _Out_ std::vector<SynchronizedFrame>& frames) const
+    {
+        frames.clear();
+
+        const auto referenceRecording =
+            std::find_if(
+                recordings.begin(),
+                recordings.end(),
+                [this](const SensorRecording& recording)
+        {
+            return recording.GetSensorName() == _options.ReferenceSensorName;
+        });
+
+        if (recordings.end() == referenceRecording)
+        {
+            std::cerr << "The reference sensor " << _options.ReferenceSensorName << " is not part of the recording" << std::endl;
+
+            return false;
+        }
+
+        //
+        // Sample the reference frames, skipping the first one like recorder_console.py does.
+        //
+        const double samplingPeriod =
+            c_timestampsPerSecond / std::max(_options.FrameRate, 1.0e-3);
+
+        std::vector<const SensorRecordingFrame*> referenceFrames;
+        const SensorRecordingFrame* previousFrame = nullptr;
+
+        for (const SensorRecordingFrame& frame : referenceRecording->GetFrames())
+        {
+            if (!frame.HasValidPose || !HasImage(*referenceRecording, frame))
+            {
+                continue;
+            }
+
+            if (nullptr == previousFrame)
+            {
+                previousFrame = &frame;
+            }
+            else if (static_cast<double>(frame.Timestamp - previousFrame->Timestamp) >= samplingPeriod)
+            {
+                referenceFrames.push_back(
+                    &frame);
+
+                previousFrame = &frame;
+            }
+        }
+
+        if (referenceFrames.empty())
+        {
+            std::cerr << "No frames of " << _options.ReferenceSensorName << " have both a pose and an image" << std::endl;
+
+            return false;
+        }
+
+        if (_options.StartFrame >= referenceFrames.size())
+        {
+            std::cerr << "The start frame is past the " << referenceFrames.size() << " sampled frames" << std::endl;
+
+            return false;
+        }
+
+        referenceFrames.erase(
+            referenceFrames.begin(),
+            referenceFrames.begin() + _options.StartFrame);
+
+        if (0 != _options.MaxFrames && referenceFrames.size() > _options.MaxFrames)
+        {
+            referenceFrames.resize(
+                _options.MaxFrames);
+        }
+
+        std::vector<uint64_t> referenceTimestamps;
+
+        for (const SensorRecordingFrame* frame : referenceFrames)
+        {
+            referenceTimestamps.push_back(
+                frame->Timestamp);
+        }
+
+        //
+        // Match the frames of the other sensors to their closest reference frame. For each
+        // reference frame, the closest frame of each sensor wins.
+        //
+        std::vector<SynchronizedFrame> synchronizedFrames(
+            referenceFrames.size());
+
+        std::vector<uint64_t> timeDifferences;
+
+        for (size_t i = 0; i < referenceFrames.size(); ++i)
+        {
+            SynchronizedImage image;
+
+            image.Recording = &*referenceRecording;
+            image.Frame = referenceFrames[i];
+
+            synchronizedFrames[i].ReferenceTimestamp = referenceFrames[i]->Timestamp;
+            synchronizedFrames[i].Images.push_back(
+                image);
+        }
+
+        for (const SensorRecording& recording : recordings)
+        {
+            if (&recording == &*referenceRecording)
+            {
+                continue;
+            }
+
+            timeDifferences.assign(
+                referenceFrames.size(),
+                UINT64_MAX);
+
+            for (SynchronizedFrame& synchronizedFrame : synchronizedFrames)
+            {
+                synchronizedFrame.Images.push_back(
+                    SynchronizedImage());
+            }
+
+            for (const SensorRecordingFrame& frame : recording.GetFrames())
+            {
+                const auto next =
+                    std::lower_bound(
+                        referenceTimestamps.begin(),
+                        referenceTimestamps.end(),
+                        frame.Timestamp);
+
+                size_t closest = SIZE_MAX;
+                uint64_t closestTimeDifference = UINT64_MAX;
+
+                if (referenceTimestamps.end() != next)
+                {
+                    closest = next - referenceTimestamps.begin();
+                    closestTimeDifference = *next - frame.Timestamp;
+                }
+
+                if (referenceTimestamps.begin() != next &&
+                    frame.Timestamp - *(next - 1) < closestTimeDifference)
+                {
+                    closest = next - 1 - referenceTimestamps.begin();
+                    closestTimeDifference = frame.Timestamp - *(next - 1);
+                }
+
+                if (SIZE_MAX == closest ||
+                    closestTimeDifference >= _options.MaxTimeDifference ||
+                    closestTimeDifference >= timeDifferences[closest] ||
+                    !frame.HasValidPose ||
+                    !HasImage(recording, frame))
+                {
+                    continue;
+                }
+
+                timeDifferences[closest] = closestTimeDifference;
+
+                SynchronizedImage& image =
+                    synchronizedFrames[closest].Images.back();
+
+                image.Recording = &recording;
+                image.Frame = &frame;
+            }
+        }
+
+        for (SynchronizedFrame& synchronizedFrame : synchronizedFrames)
+        {
+            const bool isComplete =
+                std::all_of(
+                    synchronizedFrame.Images.begin(),
+                    synchronizedFrame.Images.end(),
+                    [](const SynchronizedImage& image)
+            {
+                return nullptr != image.Frame;
+            });
+
+            if (isComplete)
+            {
+                frames.push_back(
+                    std::move(synchronizedFrame));
+            }
+        }
+
+        return true;
+    }
+
+    /* static */ bool FrameSynchronizer::WriteDataset(
+        _In_ const std::vector<SynchronizedFrame>& frames,
+        _In_ const std::filesystem::path& outputFolder,
+        _In_ const FileExtractor& fileExtractor,
+        _Out_ ExtractionStatistics& statistics)
+    {
+        std::vector<ExtractionJob> jobs;
+        std::string csv = "ReferenceTimestamp,SensorName,Timestamp,ImageName\n";
+
+        for (const SynchronizedFrame& frame : frames)
+        {
+            for (const SynchronizedImage& image : frame.Images)
+            {
+                const SensorRecording& recording = *image.Recording;
+
+                const std::string imageName =
+                    GetImageName(frame, image);
+
+                ExtractionJob job;
+
+                if (!GetExtractionJob(
+                        recording,
+                        image.Frame->ImageFileName,
+                        image.Frame->ImageArchiveOffset,
+                        image.Frame->ImageArchiveSize,
+                        outputFolder / std::filesystem::u8path(imageName),
+                        job))
+                {
+                    std::cerr << "Lost track of " << image.Frame->ImageFileName << std::endl;
+
+                    return false;
+                }
+
+                jobs.push_back(
+                    std::move(job));
+
+                //
+                // Features are only recorded if the recorder was asked to.
+                //
+                if (GetExtractionJob(
+                        recording,
+                        SensorRecording::GetFeaturesFileName(image.Frame->ImageFileName),
+                        image.Frame->FeaturesArchiveOffset,
+                        image.Frame->FeaturesArchiveSize,
+                        outputFolder / std::filesystem::u8path(SensorRecording::GetFeaturesFileName(imageName)),
+                        job))
+                {
+                    jobs.push_back(
+                        std::move(job));
+                }
+
+                Io::AppendNumber(frame.ReferenceTimestamp, csv);
+                csv += ',';
+                csv += recording.GetSensorName();
+                csv += ',';
+                Io::AppendNumber(image.Frame->Timestamp, csv);
+                csv += ',';
+                csv += imageName;
+                csv += '\n';
+            }
+        }
+
+        if (!fileExtractor.Run(jobs, statistics))
+        {
+            return false;
+        }
+
+        std::ofstream csvFile(
+            outputFolder / "synchronized_frames.csv",
+            std::ios::out | std::ios::binary | std::ios::trunc);
+
+        csvFile.write(
+            csv.data(),
+            static_cast<std::streamsize>(csv.size()));
+
+        csvFile.close();
+
+        return !!csvFile;
+    }
+
+    /* static */ std::string FrameSynchronizer::GetImageName(
+        _In_ const SynchronizedFrame& frame,
+        _In_ const SynchronizedImage& image)
+    {
+        std::string imageName =
+            image.Recording->GetSensorName() + "/";
+
+        Io::AppendNumber(
+            frame.ReferenceTimestamp,
+            imageName);
+
+        imageName += ".pgm";
+
+        return imageName;
+    }
+
+    /* static */ bool FrameSynchronizer::HasImage(
+        _In_ const SensorRecording& recording,
+        _In_ const SensorRecordingFrame& frame)
+    {
+        if (0 != frame.ImageArchiveSize)
+        {
+            return true;
+        }
+
+        std::error_code error;
+
+        return std::filesystem::exists(
+            SensorRecording::GetExtractedFileName(recording.GetRecordingFolder(), frame.ImageFileName),
+            error);
+    }
+
+    /* static */ bool FrameSynchronizer::GetExtractionJob(
+        _In_ const SensorRecording& recording,
+        _In_ const std::string& fileName,
+        _In_ uint64_t archiveOffset,
+        _In_ uint64_t archiveSize,
+        _In_ const std::filesystem::path& destinationFileName,
+        _Out_ ExtractionJob& job)
+    {
+        job = ExtractionJob();
+        job.DestinationFileName = destinationFileName;
+
+        //
+        // Link what was extracted before, so that the dataset takes no extra disk space.
+        //
+        const std::filesystem::path extractedFileName =
+            SensorRecording::GetExtractedFileName(
+                recording.GetRecordingFolder(),
+                fileName);
+
+        std::error_code error;
+
+        if (std::filesystem::exists(extractedFileName, error))
+        {
+            job.SourceFileName = extractedFileName;
+            job.Link = true;
+
+            return true;
+        }
+
+        if (0 == archiveSize)
+        {
+            return false;
+        }
+
+        job.Recording = &recording;
+        job.ArchiveOffset = archiveOffset;
+        job.ArchiveSize = archiveSize;
+
+        return true;
+    }
+}
@@ -0,0 +1,116 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace RecordingConverter
+{
+    struct SynchronizedImage
+    {
+        SynchronizedImage();
+
+        const SensorRecording* Recording;
+        const SensorRecordingFrame* Frame;
+    };
+
+    //
+    // A frame of the reference sensor and the closest frames of the other sensors, in the
+    // order the sensors were given in.
+    //
+    struct SynchronizedFrame
+    {
+        SynchronizedFrame();
+
+        uint64_t ReferenceTimestamp;
+
+        std::vector<SynchronizedImage> Images;
+    };
+
+    //
+    // Native version of synchronize_sensor_frames in Python/recorder_console.py: samples the
+    // frames of a reference sensor at the given rate, and matches the frames of the other
+    // sensors to them by timestamp. Only frames with a tracked pose and an image are used,
+    // and only reference frames that every sensor could be matched to are kept.
+    //
+    class FrameSynchronizer
+    {
+    public:
+        struct Options
+        {
+            Options();
+
+            std::string ReferenceSensorName;
+
+            // Frames per second sampled from the reference sensor.
+            double FrameRate;
+
+            // Range of the sampled frames kept; zero MaxFrames keeps them all.
+            uint32_t StartFrame;
+            uint32_t MaxFrames;
+
+            //
+            // Frames of other sensors further than this from the reference frame are not
+            // matched to it, in 100 ns units.
+            //
+            uint64_t MaxTimeDifference;
+        };
+
+        explicit FrameSynchronizer(
+            _In_ const Options& options);
+
+        bool Synchronize(
+            _In_ const std::vector<SensorRecording>& recordings,
+            _Out_ std::vector<SynchronizedFrame>& frames) const;
+
+        //
+        // Lays out the frames the way reconstruct_recording expects them, with the images
+        // (and recorded features, if any) of each sensor named after the reference frame:
+        // <outputFolder>/<sensor>/<reference timestamp>.pgm. Files already extracted from
+        // the archives are hard-linked, the others are extracted from the archives directly.
+        // The frames are listed in <outputFolder>/synchronized_frames.csv.
+        //
+        static bool WriteDataset(
+            _In_ const std::vector<SynchronizedFrame>& frames,
+            _In_ const std::filesystem::path& outputFolder,
+            _In_ const FileExtractor& fileExtractor,
+            _Out_ ExtractionStatistics& statistics);
+
+        //
+        // Name of the image in the dataset, relative to its folder, e.g.
+        // "vlc_lf/131571592387879649.pgm".
+        //
+        static std::string GetImageName(
+            _In_ const SynchronizedFrame& frame,
+            _In_ const SynchronizedImage& image);
+
+    private:
+        //
+        // Whether the image of the frame is in the archive or already extracted.
+        //
+        static bool HasImage(
+            _In_ const SensorRecording& recording,
+            _In_ const SensorRecordingFrame& frame);
+
+        //
+        // Sets up the job for a file of the frame, returning false if it has no such file.
+        //
+        static bool GetExtractionJob(
+            _In_ const SensorRecording& recording,
+            _In_ const std::string& fileName,
+            _In_ uint64_t archiveOffset,
+            _In_ uint64_t archiveSize,
+            _In_ const std::filesystem::path& destinationFileName,
+            _Out_ ExtractionJob& job);
+
+    private:
+        const Options _options;
+    };
+}
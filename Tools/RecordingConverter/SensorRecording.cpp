@@ -0,0 +1,372 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+namespace RecordingConverter
+{
+    namespace
+    {
+        //
+        // The columns of a sensor's CSV file: timestamp, image file name, and the
+        // FrameToOrigin, CameraViewTransform and CameraProjectionTransform matrices.
+        //
+        const size_t c_numberOfCsvColumns = 2 + 3 * 16;
+
+        const char c_csvHeaderPrefix[] = "Timestamp,ImageFileName,";
+
+        //
+        // Same test as Python/recorder_console.py: the upper 3x3 block of the frame-to-origin
+        // transform is a rotation for tracked frames, and zero otherwise.
+        //
+        bool IsRotation(
+            _In_reads_(16) const double* matrix)
+        {
+            const double determinant =
+                matrix[0] * (matrix[5] * matrix[10] - matrix[6] * matrix[9]) -
+                matrix[1] * (matrix[4] * matrix[10] - matrix[6] * matrix[8]) +
+                matrix[2] * (matrix[4] * matrix[9] - matrix[5] * matrix[8]);
+
+            return std::abs(determinant - 1.0) < 0.01;
+        }
+
+        std::string_view GetText(
+            _In_ const Io::ByteSpan& data)
+        {
+            return std::string_view(
+                reinterpret_cast<const char*>(data.Data),
+                data.Size);
+        }
+    }
+
+    SensorRecordingFrame::SensorRecordingFrame()
+        : Timestamp(0)
+        , HasValidPose(false)
+        , FrameToOrigin()
+        , CameraViewTransform()
+        , ImageArchiveOffset(0)
+        , ImageArchiveSize(0)
+        , FeaturesArchiveOffset(0)
+        , FeaturesArchiveSize(0)
+    {
+    }
+
+    SensorRecording::SensorRecording()
+    {
+    }
+
+    bool SensorRecording::Open(
+        _In_ const std::filesystem::path& recordingFolder,
+        _In_ const std::string& sensorName)
+    {
+        _recordingFolder = recordingFolder;
+        _sensorName = sensorName;
+        _frames.clear();
+        _archiveFileName.clear();
+        _archiveEntries.clear();
+        _archiveMapping.Close();
+
+        const bool hasFrames =
+            ReadFrames(recordingFolder / (sensorName + ".csv"));
+
+        const std::filesystem::path archiveFileName =
+            recordingFolder / (sensorName + ".tar");
+
+        std::ifstream archive(
+            archiveFileName,
+            std::ios::in | std::ios::binary);
+
+        if (archive && Io::ReadTarArchiveIndex(archive, _archiveEntries))
+        {
+            _archiveFileName = archiveFileName;
+
+            _archiveMapping.Open(
+                archiveFileName.u8string());
+
+            IndexArchive();
+        }
+
+        return hasFrames || HasArchive();
+    }
+
+    const std::string& SensorRecording::GetSensorName() const
+    {
+        return _sensorName;
+    }
+
+    const std::filesystem::path& SensorRecording::GetRecordingFolder() const
+    {
+        return _recordingFolder;
+    }
+
+    const std::vector<SensorRecordingFrame>& SensorRecording::GetFrames() const
+    {
+        return _frames;
+    }
+
+    bool SensorRecording::HasArchive() const
+    {
+        return !_archiveFileName.empty();
+    }
+
+    const std::vector<Io::TarArchiveEntry>& SensorRecording::GetArchiveEntries() const
+    {
+        return _archiveEntries;
+    }
+
+    bool SensorRecording::ReadArchiveData(
+        _In_ uint64_t offset,
+        _In_ uint64_t size,
+        _Inout_ std::vector<uint8_t>& storage,
+        _Out_ Io::ByteSpan& data) const
+    {
+        data = Io::ByteSpan();
+
+        if (_archiveMapping.IsOpen())
+        {
+            data =
+                _archiveMapping.GetSpan().Subspan(
+                    static_cast<size_t>(offset),
+                    static_cast<size_t>(size));
+
+            return data.Size == size;
+        }
+
+        //
+        // Each call opens its own stream, so that threads do not share a file position.
+        //
+        std::ifstream archive(
+            _archiveFileName,
+            std::ios::in | std::ios::binary);
+
+        storage.resize(
+            static_cast<size_t>(size));
+
+        archive.seekg(
+            static_cast<std::streamoff>(offset));
+
+        archive.read(
+            reinterpret_cast<char*>(storage.data()),
+            static_cast<std::streamsize>(storage.size()));
+
+        data = Io::ByteSpan(
+            storage.data(),
+            storage.size());
+
+        return !!archive;
+    }
+
+    /* static */ std::filesystem::path SensorRecording::GetExtractedFileName(
+        _In_ const std::filesystem::path& folder,
+        _In_ const std::string& archiveFileName)
+    {
+        //
+        // The recorder stores file names with backslashes.
+        //
+        std::string relativeFileName = archiveFileName;
+
+        std::replace(
+            relativeFileName.begin(),
+            relativeFileName.end(),
+            '\\',
+            '/');
+
+        return folder / std::filesystem::u8path(relativeFileName);
+    }
+
+    /* static */ std::string SensorRecording::GetFeaturesFileName(
+        _In_ const std::string& imageFileName)
+    {
+        const size_t extension =
+            imageFileName.find_last_of('.');
+
+        return imageFileName.substr(0, extension) + ".orb";
+    }
+
+    /* static */ bool SensorRecording::ParseTimestamp(
+        _In_ const std::string& fileName,
+        _Out_ uint64_t& timestamp)
+    {
+        timestamp = 0;
+
+        const size_t begin =
+            fileName.find_last_of("/\\");
+
+        const std::string_view stem =
+            std::string_view(fileName).substr(
+                std::string::npos == begin ? 0 : begin + 1);
+
+        return Io::ParseNumber(
+            stem.substr(0, stem.find('.')),
+            timestamp);
+    }
+
+    /* static */ std::vector<std::string> SensorRecording::FindSensorNames(
+        _In_ const std::filesystem::path& recordingFolder)
+    {
+        std::set<std::string> sensorNames;
+
+        std::error_code error;
+
+        for (const std::filesystem::directory_entry& entry :
+            std::filesystem::directory_iterator(recordingFolder, error))
+        {
+            if (!entry.is_regular_file())
+            {
+                continue;
+            }
+
+            if (".tar" == entry.path().extension())
+            {
+                sensorNames.insert(
+                    entry.path().stem().u8string());
+
+                continue;
+            }
+
+            if (".csv" != entry.path().extension())
+            {
+                continue;
+            }
+
+            //
+            // The recording also has other CSV files, e.g. recording_version_information.csv.
+            //
+            std::ifstream csvFile(
+                entry.path());
+
+            std::string header;
+
+            if (std::getline(csvFile, header) &&
+                0 == header.compare(0, sizeof(c_csvHeaderPrefix) - 1, c_csvHeaderPrefix))
+            {
+                sensorNames.insert(
+                    entry.path().stem().u8string());
+            }
+        }
+
+        return std::vector<std::string>(
+            sensorNames.begin(),
+            sensorNames.end());
+    }
+
+    bool SensorRecording::ReadFrames(
+        _In_ const std::filesystem::path& csvFileName)
+    {
+        Io::MappedFile csvFile;
+
+        if (!csvFile.Open(csvFileName.u8string()))
+        {
+            return false;
+        }
+
+        Io::StringTokenizer lines(
+            GetText(csvFile.GetSpan()),
+            "\r\n");
+
+        std::string_view line;
+
+        //
+        // Skip the header.
+        //
+        if (!lines.Next(line))
+        {
+            return false;
+        }
+
+        while (lines.Next(line))
+        {
+            Io::StringTokenizer row(
+                line,
+                ",",
+                false /* skipEmptyTokens */);
+
+            std::string_view cells[c_numberOfCsvColumns];
+            size_t numberOfCells = 0;
+
+            while (numberOfCells < c_numberOfCsvColumns && row.Next(cells[numberOfCells]))
+            {
+                ++numberOfCells;
+            }
+
+            SensorRecordingFrame frame;
+            bool isValid =
+                c_numberOfCsvColumns == numberOfCells &&
+                Io::ParseNumber(Io::TrimString(cells[0]), frame.Timestamp);
+
+            for (size_t i = 0; isValid && i < 16; ++i)
+            {
+                isValid =
+                    Io::ParseNumber(Io::TrimString(cells[2 + i]), frame.FrameToOrigin[i]) &&
+                    Io::ParseNumber(Io::TrimString(cells[18 + i]), frame.CameraViewTransform[i]);
+            }
+
+            if (!isValid)
+            {
+                std::cerr << "Skipping malformed row in " << csvFileName.u8string() << std::endl;
+
+                continue;
+            }
+
+            frame.ImageFileName = cells[1];
+            frame.HasValidPose = IsRotation(frame.FrameToOrigin);
+
+            _frames.push_back(
+                std::move(frame));
+        }
+
+        std::stable_sort(
+            _frames.begin(),
+            _frames.end(),
+            [](const SensorRecordingFrame& a, const SensorRecordingFrame& b)
+        {
+            return a.Timestamp < b.Timestamp;
+        });
+
+        return true;
+    }
+
+    void SensorRecording::IndexArchive()
+    {
+        std::map<std::string_view, const Io::TarArchiveEntry*> archiveEntries;
+
+        for (const Io::TarArchiveEntry& entry : _archiveEntries)
+        {
+            archiveEntries[entry.FileName] = &entry;
+        }
+
+        for (SensorRecordingFrame& frame : _frames)
+        {
+            const auto imageEntry =
+                archiveEntries.find(frame.ImageFileName);
+
+            if (archiveEntries.end() == imageEntry)
+            {
+                continue;
+            }
+
+            frame.ImageArchiveOffset = imageEntry->second->Offset;
+            frame.ImageArchiveSize = imageEntry->second->Size;
+
+            const std::string featuresFileName =
+                GetFeaturesFileName(frame.ImageFileName);
+
+            const auto featuresEntry =
+                archiveEntries.find(featuresFileName);
+
+            if (archiveEntries.end() != featuresEntry)
+            {
+                frame.FeaturesArchiveOffset = featuresEntry->second->Offset;
+                frame.FeaturesArchiveSize = featuresEntry->second->Size;
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+namespace RecordingConverter
+{
+    //
+    // A frame listed in a sensor's CSV file, and where its files are stored in the sensor's
+    // archive (zero sizes if they are not).
+    //
+    struct SensorRecordingFrame
+    {
+        SensorRecordingFrame();
+
+        uint64_t Timestamp;
+
+        // As recorded, e.g. "vlc_ll\00000131571592373545123.pgm".
+        std::string ImageFileName;
+
+        // Whether the frame-to-origin transform is a rotation, i.e. the pose was tracked.
+        bool HasValidPose;
+
+        // As recorded, i.e. transposed (row vectors multiplied from the left).
+        double FrameToOrigin[16];
+        double CameraViewTransform[16];
+
+        uint64_t ImageArchiveOffset;
+        uint64_t ImageArchiveSize;
+
+        uint64_t FeaturesArchiveOffset;
+        uint64_t FeaturesArchiveSize;
+    };
+
+    //
+    // The files of one sensor in a recording folder: the frames listed in <sensor>.csv, the
+    // files stored in <sensor>.tar, and the files already extracted from it, if any.
+    //
+    class SensorRecording
+    {
+    public:
+        SensorRecording();
+
+        //
+        // Returns false if the sensor has neither a CSV file nor an archive.
+        //
+        bool Open(
+            _In_ const std::filesystem::path& recordingFolder,
+            _In_ const std::string& sensorName);
+
+        const std::string& GetSensorName() const;
+
+        const std::filesystem::path& GetRecordingFolder() const;
+
+        // Sorted by timestamp.
+        const std::vector<SensorRecordingFrame>& GetFrames() const;
+
+        bool HasArchive() const;
+
+        const std::vector<Io::TarArchiveEntry>& GetArchiveEntries() const;
+
+        //
+        // Gets the data of a file in the archive, in place if the archive could be mapped,
+        // or read into the storage otherwise. Safe to call from several threads.
+        //
+        bool ReadArchiveData(
+            _In_ uint64_t offset,
+            _In_ uint64_t size,
+            _Inout_ std::vector<uint8_t>& storage,
+            _Out_ Io::ByteSpan& data) const;
+
+        //
+        // Where a file of the archive is, or would be, once extracted to the given folder.
+        //
+        static std::filesystem::path GetExtractedFileName(
+            _In_ const std::filesystem::path& folder,
+            _In_ const std::string& archiveFileName);
+
+        static std::string GetFeaturesFileName(
+            _In_ const std::string& imageFileName);
+
+        //
+        // Recording timestamps are file names too; returns false for other files.
+        //
+        static bool ParseTimestamp(
+            _In_ const std::string& fileName,
+            _Out_ uint64_t& timestamp);
+
+        //
+        // Names of the sensors that have a frame CSV file or an archive in the recording
+        // folder, sorted.
+        //
+        static std::vector<std::string> FindSensorNames(
+            _In_ const std::filesystem::path& recordingFolder);
+
+    private:
+        bool ReadFrames(
+            _In_ const std::filesystem::path& csvFileName);
+
+        void IndexArchive();
+
+    private:
+        std::filesystem::path _recordingFolder;
+        std::string _sensorName;
+
+        std::vector<SensorRecordingFrame> _frames;
+
+        std::filesystem::path _archiveFileName;
+        std::vector<Io::TarArchiveEntry> _archiveEntries;
+
+        // Closed if the archive could not be mapped (e.g. in a 32-bit build).
+        Io::MappedFile _archiveMapping;
+    };
+}
@@ -0,0 +1,556 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+using namespace RecordingConverter;
+
+namespace
+{
+    const double c_timestampsPerSecond = 1.0e7;
+
+    struct CommandLine
+    {
+        std::string Command;
+        std::vector<std::string> Positional;
+        std::map<std::string, std::string> Options;
+    };
+
+    void PrintUsage()
+    {
+        std::cout <<
+            "Usage:\n"
+            "  RecordingConverter extract <recording folder> [options]\n"
+            "      Extracts the sensor archives of a recording.\n"
+            "      --output <folder>       Where to extract to (default: the recording folder)\n"
+            "      --sensors <a,b,...>     Sensors to extract (default: all)\n"
+            "      --begin <seconds>       Skip frames before this time, from the first frame\n"
+            "      --end <seconds>         Skip frames after this time, from the first frame\n"
+            "      --threads <n>           Number of threads writing files\n"
+            "\n"
+            "  RecordingConverter synchronize <recording folder> <output folder> [options]\n"
+            "      Writes the frames of the sensors synchronized to a reference sensor.\n"
+            "      --sensors <a,b,...>     Sensors to synchronize (default: vlc_ll,vlc_lf,vlc_rf,vlc_rr)\n"
+            "      --reference <sensor>    Reference sensor (default: vlc_ll)\n"
+            "      --frame-rate <fps>      Frames sampled per second (default: 5)\n"
+            "      --start-frame <n>       First sampled frame kept (default: 0)\n"
+            "      --max-frames <n>        Number of sampled frames kept (default: all)\n"
+            "      --threads <n>           Number of threads writing files\n"
+            "\n"
+            "  RecordingConverter colmap <recording folder> <reconstruction folder> [options]\n"
+            "      Synchronizes the frames to <reconstruction folder>/images, and writes the\n"
+            "      image list, the recorded features and their matches, and the model with\n"
+            "      the recorded poses (sparse_hololens) that COLMAP reconstructs from.\n"
+            "      Takes the options of synchronize, and:\n"
+            "      --match-window <n>      Following frames matched with each frame, 0 for all\n"
+            "                              (default: 10)\n";
+    }
+
+    bool ParseCommandLine(
+        _In_ const std::vector<std::string>& arguments,
+        _Out_ CommandLine& commandLine)
+    {
+        commandLine = CommandLine();
+
+        if (arguments.empty())
+        {
+            return false;
+        }
+
+        commandLine.Command = arguments[0];
+
+        for (size_t i = 1; i < arguments.size(); ++i)
+        {
+            if (0 != arguments[i].compare(0, 2, "--"))
+            {
+                commandLine.Positional.push_back(
+                    arguments[i]);
+            }
+            else if (i + 1 < arguments.size())
+            {
+                commandLine.Options[arguments[i].substr(2)] = arguments[i + 1];
+
+                ++i;
+            }
+            else
+            {
+                std::cerr << "Missing value for " << arguments[i] << std::endl;
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    bool GetOption(
+        _In_ const CommandLine& commandLine,
+        _In_ const char* name,
+        _Inout_ T& value)
+    {
+        const auto option =
+            commandLine.Options.find(name);
+
+        if (commandLine.Options.end() == option)
+        {
+            return true;
+        }
+
+        if (!Io::ParseNumber(option->second, value))
+        {
+            std::cerr << "Invalid value for --" << name << ": " << option->second << std::endl;
+
+            return false;
+        }
+
+        return true;
+    }
+
+    std::vector<std::string> SplitSensorNames(
+        _In_ const std::string& text)
+    {
+        std::vector<std::string_view> tokens;
+
+        Io::TokenizeString(
+            text,
+            ",",
+            tokens);
+
+        std::vector<std::string> sensorNames;
+
+        for (const std::string_view token : tokens)
+        {
+            sensorNames.emplace_back(
+                Io::TrimString(token));
+        }
+
+        return sensorNames;
+    }
+
+    bool OpenRecordings(
+        _In_ const std::filesystem::path& recordingFolder,
+        _In_ const std::vector<std::string>& sensorNames,
+        _Out_ std::vector<SensorRecording>& recordings)
+    {
+        recordings = std::vector<SensorRecording>(
+            sensorNames.size());
+
+        for (size_t i = 0; i < sensorNames.size(); ++i)
+        {
+            if (!recordings[i].Open(recordingFolder, sensorNames[i]))
+            {
+                std::cerr << "No data for sensor " << sensorNames[i] << " in " << recordingFolder.u8string() << std::endl;
+
+                return false;
+            }
+
+            std::cout << sensorNames[i] << ": " << recordings[i].GetFrames().size() << " frames, "
+                << recordings[i].GetArchiveEntries().size() << " archived files" << std::endl;
+        }
+
+        return true;
+    }
+
+    void PrintStatistics(
+        _In_ const ExtractionStatistics& statistics)
+    {
+        const double megabytes =
+            statistics.NumberOfBytes / (1024.0 * 1024.0);
+
+        std::cout << "Wrote " << statistics.NumberOfFiles << " files (" << megabytes << " MB) and "
+            << statistics.NumberOfLinks << " links in " << statistics.Seconds << " s: "
+            << megabytes / std::max(statistics.Seconds, 1.0e-6) << " MB/s, "
+            << (statistics.NumberOfFiles + statistics.NumberOfLinks) / std::max(statistics.Seconds, 1.0e-6)
+            << " files/s" << std::endl;
+
+        if (0 != statistics.NumberOfFailures)
+        {
+            std::cerr << statistics.NumberOfFailures << " files failed" << std::endl;
+        }
+    }
+
+    int Extract(
+        _In_ const CommandLine& commandLine)
+    {
+        if (1 != commandLine.Positional.size())
+        {
+            PrintUsage();
+
+            return 1;
+        }
+
+        const std::filesystem::path recordingFolder =
+            std::filesystem::u8path(commandLine.Positional[0]);
+
+        const auto output =
+            commandLine.Options.find("output");
+
+        const std::filesystem::path outputFolder =
+            commandLine.Options.end() == output ?
+                recordingFolder :
+                std::filesystem::u8path(output->second);
+
+        std::vector<std::string> sensorNames;
+        const auto sensors = commandLine.Options.find("sensors");
+
+        if (commandLine.Options.end() != sensors)
+        {
+            sensorNames = SplitSensorNames(sensors->second);
+        }
+        else
+        {
+            sensorNames = SensorRecording::FindSensorNames(recordingFolder);
+        }
+
+        double beginTime = 0.0;
+        double endTime = std::numeric_limits<double>::infinity();
+        uint32_t numberOfThreads = FileExtractor::GetDefaultNumberOfThreads();
+
+        if (!GetOption(commandLine, "begin", beginTime) ||
+            !GetOption(commandLine, "end", endTime) ||
+            !GetOption(commandLine, "threads", numberOfThreads))
+        {
+            return 1;
+        }
+
+        std::vector<SensorRecording> recordings;
+
+        if (!OpenRecordings(recordingFolder, sensorNames, recordings))
+        {
+            return 1;
+        }
+
+        //
+        // Times are relative to the first frame of any of the sensors.
+        //
+        uint64_t firstTimestamp = UINT64_MAX;
+
+        for (const SensorRecording& recording : recordings)
+        {
+            for (const Io::TarArchiveEntry& entry : recording.GetArchiveEntries())
+            {
+                uint64_t timestamp;
+
+                if (SensorRecording::ParseTimestamp(entry.FileName, timestamp))
+                {
+                    firstTimestamp = std::min(firstTimestamp, timestamp);
+                }
+            }
+        }
+
+        std::vector<ExtractionJob> jobs;
+
+        for (const SensorRecording& recording : recordings)
+        {
+            for (const Io::TarArchiveEntry& entry : recording.GetArchiveEntries())
+            {
+                uint64_t timestamp;
+
+                //
+                // Files that are not frames are always extracted.
+                //
+                if (SensorRecording::ParseTimestamp(entry.FileName, timestamp))
+                {
+                    const double time =
+                        (timestamp - firstTimestamp) / c_timestampsPerSecond;
+
+                    if (time < beginTime || time > endTime)
+                    {
+                        continue;
+                    }
+                }
+
+                ExtractionJob job;
+
+                job.Recording = &recording;
+                job.ArchiveOffset = entry.Offset;
+                job.ArchiveSize = entry.Size;
+                job.DestinationFileName =
+                    SensorRecording::GetExtractedFileName(
+                        outputFolder,
+                        entry.FileName);
+
+                jobs.push_back(
+                    std::move(job));
+            }
+        }
+
+        std::cout << "Extracting " << jobs.size() << " files to " << outputFolder.u8string() << "..." << std::endl;
+
+        const FileExtractor fileExtractor(
+            numberOfThreads);
+
+        ExtractionStatistics statistics;
+
+        const bool succeeded =
+            fileExtractor.Run(
+                jobs,
+                statistics);
+
+        PrintStatistics(
+            statistics);
+
+        return succeeded ? 0 : 1;
+    }
+
+    //
+    // Synchronizes the frames of the sensors and writes them to the image folder, with the
+    // options "synchronize" and "colmap" share.
+    //
+    bool WriteSynchronizedFrames(
+        _In_ const CommandLine& commandLine,
+        _In_ const std::filesystem::path& recordingFolder,
+        _In_ const std::filesystem::path& imageFolder,
+        _Out_ std::vector<SensorRecording>& recordings,
+        _Out_ std::vector<SynchronizedFrame>& frames,
+        _Out_ uint32_t& numberOfThreads)
+    {
+        recordings.clear();
+        frames.clear();
+
+        std::vector<std::string> sensorNames =
+            { "vlc_ll", "vlc_lf", "vlc_rf", "vlc_rr" };
+
+        const auto sensors = commandLine.Options.find("sensors");
+
+        if (commandLine.Options.end() != sensors)
+        {
+            sensorNames = SplitSensorNames(sensors->second);
+        }
+
+        FrameSynchronizer::Options options;
+        numberOfThreads = FileExtractor::GetDefaultNumberOfThreads();
+
+        const auto reference = commandLine.Options.find("reference");
+
+        if (commandLine.Options.end() != reference)
+        {
+            options.ReferenceSensorName = reference->second;
+        }
+
+        if (!GetOption(commandLine, "frame-rate", options.FrameRate) ||
+            !GetOption(commandLine, "start-frame", options.StartFrame) ||
+            !GetOption(commandLine, "max-frames", options.MaxFrames) ||
+            !GetOption(commandLine, "threads", numberOfThreads))
+        {
+            return false;
+        }
+
+        if (!OpenRecordings(recordingFolder, sensorNames, recordings))
+        {
+            return false;
+        }
+
+        const FrameSynchronizer frameSynchronizer(
+            options);
+
+        if (!frameSynchronizer.Synchronize(recordings, frames))
+        {
+            return false;
+        }
+
+        std::cout << "Synchronized " << frames.size() << " frames, writing them to " << imageFolder.u8string() << "..." << std::endl;
+
+        const FileExtractor fileExtractor(
+            numberOfThreads);
+
+        ExtractionStatistics statistics;
+
+        const bool succeeded =
+            FrameSynchronizer::WriteDataset(
+                frames,
+                imageFolder,
+                fileExtractor,
+                statistics);
+
+        PrintStatistics(
+            statistics);
+
+        return succeeded;
+    }
+
+    int Synchronize(
+        _In_ const CommandLine& commandLine)
+    {
+        if (2 != commandLine.Positional.size())
+        {
+            PrintUsage();
+
+            return 1;
+        }
+
+        std::vector<SensorRecording> recordings;
+        std::vector<SynchronizedFrame> frames;
+        uint32_t numberOfThreads;
+
+        const bool succeeded =
+            WriteSynchronizedFrames(
+                commandLine,
+                std::filesystem::u8path(commandLine.Positional[0]),
+                std::filesystem::u8path(commandLine.Positional[1]),
+                recordings,
+                frames,
+                numberOfThreads);
+
+        return succeeded ? 0 : 1;
+    }
+
+    int ExportColmap(
+        _In_ const CommandLine& commandLine)
+    {
+        if (2 != commandLine.Positional.size())
+        {
+            PrintUsage();
+
+            return 1;
+        }
+
+        const std::filesystem::path recordingFolder =
+            std::filesystem::u8path(commandLine.Positional[0]);
+
+        const std::filesystem::path reconstructionFolder =
+            std::filesystem::u8path(commandLine.Positional[1]);
+
+        const std::filesystem::path imageFolder =
+            reconstructionFolder / "images";
+
+        const std::filesystem::path matchesFileName =
+            reconstructionFolder / "matches.txt";
+
+        ColmapExporter::Options options;
+
+        if (!GetOption(commandLine, "match-window", options.FeatureMatchWindow))
+        {
+            return 1;
+        }
+
+        std::vector<SensorRecording> recordings;
+        std::vector<SynchronizedFrame> frames;
+        uint32_t numberOfThreads;
+
+        if (!WriteSynchronizedFrames(commandLine, recordingFolder, imageFolder, recordings, frames, numberOfThreads))
+        {
+            return 1;
+        }
+
+        const ColmapExporter colmapExporter(
+            options,
+            numberOfThreads);
+
+        if (!colmapExporter.WriteImageList(frames, reconstructionFolder / "image_list.txt"))
+        {
+            return 1;
+        }
+
+        std::error_code error;
+
+        //
+        // COLMAP extracts and matches its own features when none were recorded; do not
+        // leave the matches of an earlier run behind in that case.
+        //
+        std::filesystem::remove(
+            matchesFileName,
+            error);
+
+        if (colmapExporter.HasFeatures(frames, imageFolder))
+        {
+            const std::chrono::steady_clock::time_point startTime =
+                std::chrono::steady_clock::now();
+
+            if (!colmapExporter.WriteFeatures(recordings, frames, imageFolder, reconstructionFolder / "features", matchesFileName))
+            {
+                return 1;
+            }
+
+            std::cout << "Converted and matched the recorded features in "
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << " s" << std::endl;
+        }
+        else
+        {
+            std::cout << "No recorded features to convert" << std::endl;
+        }
+
+        if (!colmapExporter.WriteModel(recordings, frames, reconstructionFolder / "sparse_hololens"))
+        {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int Run(
+        _In_ const std::vector<std::string>& arguments)
+    {
+        CommandLine commandLine;
+
+        if (!ParseCommandLine(arguments, commandLine))
+        {
+            PrintUsage();
+
+            return 1;
+        }
+
+        try
+        {
+            if ("extract" == commandLine.Command)
+            {
+                return Extract(commandLine);
+            }
+            else if ("synchronize" == commandLine.Command)
+            {
+                return Synchronize(commandLine);
+            }
+            else if ("colmap" == commandLine.Command)
+            {
+                return ExportColmap(commandLine);
+            }
+        }
+        catch (const std::exception& exception)
+        {
+            std::cerr << "Error: " << exception.what() << std::endl;
+
+            return 1;
+        }
+
+        PrintUsage();
+
+        return 1;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(
+    _In_ int argc,
+    _In_reads_(argc) wchar_t* argv[])
+{
+    //
+    // Work with UTF-8 internally, like the recording's own file names.
+    //
+    std::vector<std::string> arguments;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        arguments.push_back(
+            Utf16ToUtf8(argv[i]));
+    }
+
+    return Run(arguments);
+}
+#else
+int main(
+    _In_ int argc,
+    _In_reads_(argc) char* argv[])
+{
+    return Run(
+        std::vector<std::string>(argv + 1, argv + argc));
+}
+#endif /* defined(_WIN32) */
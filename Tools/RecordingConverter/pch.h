@@ -0,0 +1,83 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif /* !defined(WIN32_LEAN_AND_MEAN) */
+
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif /* !defined(NOMINMAX) */
+
+#include <Windows.h>
+#include <intrin.h>
+#else
+#include <Debugging/Sal.h>
+#endif /* defined(_WIN32) */
+
+//
+// The Visual Studio project does not use the Debugging library; fail code contracts the
+// same way it does, minus the trace.
+//
+#define ASSERT(expr) \
+    do { \
+        if (!(expr)) { \
+            throw std::logic_error("ASSERT(" #expr ") check failed"); \
+        } \
+    } while (0, 0)
+
+#define REQUIRES(expr) \
+    do { \
+        if (!(expr)) { \
+            throw std::logic_error("REQUIRES(" #expr ") check failed"); \
+        } \
+    } while (0, 0)
+
+//
+// Only the parts of the Io library that do not depend on the Windows Runtime are compiled
+// into this tool (see RecordingConverter.vcxproj), or linked from the Io library in the
+// CMake build (see CMakeLists.txt).
+//
+#include <Io/MappedFile.h>
+#include <Io/StringHelpers.h>
+#include <Io/TarReader.h>
+
+#include "SensorRecording.h"
+#include "FileExtractor.h"
+#include "FrameSynchronizer.h"
+#include "ColmapExporter.h"